@@ -464,6 +464,35 @@ svn_cache__set(svn_cache__t *cache,
                void *value,
                apr_pool_t *scratch_pool);
 
+/**
+ * Like svn_cache__get() but for all keys in @a keys (an array of
+ * <tt>const void *</tt>).  For each index @a i, set @a values[i] and
+ * @a found[i] the way svn_cache__get() sets @a *value and @a *found for
+ * the key at index @a i.  Both arrays must have @a keys->nelts elements.
+ *
+ * Cache implementations may use this to fetch the items in a single
+ * round trip (memcached) or with only one lock acquisition per segment
+ * (membuffer).  Elements of @a keys may be NULL and will not be found.
+ */
+svn_error_t *
+svn_cache__get_many(void **values,
+                    svn_boolean_t *found,
+                    svn_cache__t *cache,
+                    const apr_array_header_t *keys,
+                    apr_pool_t *result_pool);
+
+/**
+ * Like svn_cache__set() but for all keys in @a keys (an array of
+ * <tt>const void *</tt>) with the respective elements of @a values as
+ * their values.  @a values must have @a keys->nelts elements.  Uses
+ * @a scratch_pool for temporary allocations.
+ */
+svn_error_t *
+svn_cache__set_many(svn_cache__t *cache,
+                    const apr_array_header_t *keys,
+                    void **values,
+                    apr_pool_t *scratch_pool);
+
 /**
  * Iterates over the elements currently in @a cache, calling @a func
  * for each one until there are no more elements or @a func returns an
@@ -313,6 +313,12 @@ typedef struct svn_fs_fs__ioctl_get_stats_input_t
 {
   svn_fs_progress_notify_func_t progress_func;
   void *progress_baton;
+
+  /* Optional file to keep per-shard results in between runs. */
+  const char *cache_path;
+
+  /* Number of rev / pack files to read in parallel.  0 is the same as 1. */
+  int thread_count;
 } svn_fs_fs__ioctl_get_stats_input_t;
 
 typedef struct svn_fs_fs__ioctl_get_stats_output_t
@@ -364,6 +370,61 @@ typedef struct svn_fs_fs__ioctl_build_rep_cache_input_t
 /* See svn_fs_fs__build_rep_cache(). */
 SVN_FS_DECLARE_IOCTL_CODE(SVN_FS_FS__IOCTL_BUILD_REP_CACHE, SVN_FS_TYPE_FSFS, 1004);
 
+/* See svn_fs_fs__build_rep_cache_filter().  Neither input nor output. */
+SVN_FS_DECLARE_IOCTL_CODE(SVN_FS_FS__IOCTL_BUILD_REP_CACHE_FILTER, SVN_FS_TYPE_FSFS, 1005);
+
+typedef struct svn_fs_fs__ioctl_build_path_index_input_t
+{
+  svn_fs_progress_notify_func_t progress_func;
+  void *progress_baton;
+} svn_fs_fs__ioctl_build_path_index_input_t;
+
+/* See svn_fs_fs__build_path_index().  No output. */
+SVN_FS_DECLARE_IOCTL_CODE(SVN_FS_FS__IOCTL_BUILD_PATH_INDEX, SVN_FS_TYPE_FSFS, 1007);
+
+typedef struct svn_fs_fs__ioctl_redeltify_input_t
+{
+  svn_revnum_t start_rev;
+  svn_revnum_t end_rev;
+
+  /* Longest acceptable delta chain.  0 selects the default. */
+  int max_chain_length;
+
+  svn_fs_progress_notify_func_t progress_func;
+  void *progress_baton;
+} svn_fs_fs__ioctl_redeltify_input_t;
+
+typedef struct svn_fs_fs__ioctl_redeltify_output_t
+{
+  /* Number of representations written. */
+  apr_int64_t rep_count;
+
+  /* Number of node-revisions that now use them. */
+  apr_int64_t noderev_count;
+} svn_fs_fs__ioctl_redeltify_output_t;
+
+/* See svn_fs_fs__redeltify(). */
+SVN_FS_DECLARE_IOCTL_CODE(SVN_FS_FS__IOCTL_REDELTIFY, SVN_FS_TYPE_FSFS, 1008);
+
+typedef struct svn_fs_fs__ioctl_build_mergeinfo_index_input_t
+{
+  svn_fs_progress_notify_func_t progress_func;
+  void *progress_baton;
+} svn_fs_fs__ioctl_build_mergeinfo_index_input_t;
+
+/* See svn_fs_fs__build_mergeinfo_index().  No output. */
+SVN_FS_DECLARE_IOCTL_CODE(SVN_FS_FS__IOCTL_BUILD_MERGEINFO_INDEX, SVN_FS_TYPE_FSFS, 1009);
+
+typedef struct svn_fs_fs__ioctl_get_mmap_stats_output_t
+{
+  /* Number of items that this svn_fs_t instance parsed straight from
+   * memory mapped rev / pack file data. */
+  apr_int64_t mapped_item_count;
+} svn_fs_fs__ioctl_get_mmap_stats_output_t;
+
+/* Return memory mapping statistics.  No input. */
+SVN_FS_DECLARE_IOCTL_CODE(SVN_FS_FS__IOCTL_GET_MMAP_STATS, SVN_FS_TYPE_FSFS, 1011);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -68,6 +68,13 @@ svn_fs__access_get_lock_tokens(svn_fs_access_t *access_ctx);
 svn_error_t *
 svn_fs__path_valid(const char *path, apr_pool_t *pool);
 
+/* Pass ERR to the warning callback of FS (see svn_fs_set_warning_func())
+ * and clear it.  Do nothing if ERR is SVN_NO_ERROR.
+ */
+void
+svn_fs__warn(svn_fs_t *fs,
+             svn_error_t *err);
+
 
 
 /** Editors
@@ -211,6 +218,103 @@ svn_fs__get_deleted_node(svn_fs_root_t **node_root,
                          apr_pool_t *result_pool,
                          apr_pool_t *scratch_pool);
 
+/** Try to get the delta that turns the contents of @a source_root /
+ * @a source_path into those of @a target_root / @a target_path in the
+ * svndiff format, as stored by the filesystem, i.e. without recomputing
+ * it.  If @a source_root is @c NULL, the delta must be against the empty
+ * string.
+ *
+ * If the filesystem stores such a delta using svndiff version
+ * @a max_svndiff_version or lower, set @a *stream_p to a readable stream
+ * of the svndiff data and @a *len_p to its length in bytes.  Otherwise,
+ * set @a *stream_p to @c NULL and the caller should fall back to
+ * svn_fs_get_file_delta_stream().
+ *
+ * Allocate @a *stream_p in @a result_pool and use @a scratch_pool for
+ * temporaries.
+ */
+svn_error_t *
+svn_fs__try_get_stored_delta(svn_stream_t **stream_p,
+                             svn_filesize_t *len_p,
+                             svn_fs_root_t *source_root,
+                             const char *source_path,
+                             svn_fs_root_t *target_root,
+                             const char *target_path,
+                             int max_svndiff_version,
+                             apr_pool_t *result_pool,
+                             apr_pool_t *scratch_pool);
+
+/** Try to find the first revision after @a start and up to and including
+ * @a end in which @a path in @a fs got deleted or replaced, either directly
+ * or through one of its parents, without walking the history.  @a path
+ * must exist in @a start.
+ *
+ * If the filesystem can tell, set @a *available to @c TRUE and @a *deleted
+ * to that revision or to #SVN_INVALID_REVNUM if there is none.  Otherwise,
+ * set @a *available to @c FALSE, leave @a *deleted untouched and the caller
+ * should fall back to svn_repos_deleted_rev()'s history search.
+ *
+ * Use @a scratch_pool for temporary allocations.
+ */
+svn_error_t *
+svn_fs__try_get_deleted_rev(svn_boolean_t *available,
+                            svn_revnum_t *deleted,
+                            svn_fs_t *fs,
+                            const char *path,
+                            svn_revnum_t start,
+                            svn_revnum_t end,
+                            apr_pool_t *scratch_pool);
+
+/** A file and its new contents for svn_fs__apply_texts(). */
+typedef struct svn_fs__text_t
+{
+  /** The file to modify. */
+  const char *path;
+
+  /** Its new fulltext. */
+  const svn_string_t *contents;
+
+  /** MD5 checksum of @c contents to verify.  May be @c NULL. */
+  svn_checksum_t *result_checksum;
+} svn_fs__text_t;
+
+/** Set the contents of the files in the transaction @a root as given by
+ * @a texts, an array of #svn_fs__text_t *, in that order.  The effect is
+ * the same as calling svn_fs_apply_text() for each of them in turn, which
+ * is also what this does for backends that don't support batched updates.
+ * Other backends may use up to @a thread_count threads for checksumming
+ * and deltification.
+ *
+ * Every path must occur at most once in @a texts.  Backends may reject
+ * batches that contain the same path more than once with
+ * #SVN_ERR_FS_GENERAL; callers must apply the batch first and then start
+ * a new one for the repeated path.
+ *
+ * @a cancel_func, @a cancel_baton and @a scratch_pool are the usual things.
+ */
+svn_error_t *
+svn_fs__apply_texts(svn_fs_root_t *root,
+                    const apr_array_header_t *texts,
+                    int thread_count,
+                    svn_cancel_func_t cancel_func,
+                    void *cancel_baton,
+                    apr_pool_t *scratch_pool);
+
+/** If @a bulk is set, let this instance of @a fs trade durability for
+ * speed while filling an otherwise unused repository, e.g. by deferring
+ * bookkeeping work such as rep-sharing updates.  If @a bulk is not set,
+ * catch up on all deferred work, flush everything committed since bulk
+ * mode was entered to disk and return to normal operation.
+ *
+ * Set @a *supported to @c FALSE if the backend has no such mode and to
+ * @c TRUE otherwise.  Use @a scratch_pool for temporary allocations.
+ */
+svn_error_t *
+svn_fs__set_bulk_mode(svn_boolean_t *supported,
+                      svn_fs_t *fs,
+                      svn_boolean_t bulk,
+                      apr_pool_t *scratch_pool);
+
 
 /** @} */
 
@@ -0,0 +1,321 @@
+/**
+ * @copyright
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ * @endcopyright
+ *
+ * @file svn_fs_x_private.h
+ * @brief Private API for tools that access FSX internals and can't use
+ *        the svn_fs_t API for that.
+ */
+
+
+#ifndef SVN_FS_X_PRIVATE_H
+#define SVN_FS_X_PRIVATE_H
+
+#include <apr_pools.h>
+#include <apr_tables.h>
+
+#include "svn_types.h"
+#include "svn_error.h"
+#include "svn_fs.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+
+
+/* Change set is the umbrella term for transaction and revision in FSX.
+ * Revision numbers (>=0) map 1:1 onto change sets while txns are mapped
+ * onto the negative value range. */
+typedef apr_int64_t svn_fs_x__change_set_t;
+
+/* An ID in FSX consists of a creation CHANGE_SET number and some changeset-
+ * local counter value (NUMBER).
+ */
+typedef struct svn_fs_x__id_t
+{
+  svn_fs_x__change_set_t change_set;
+
+  apr_uint64_t number;
+} svn_fs_x__id_t;
+
+/* (user visible) entry in the phys-to-log index.  It describes a section
+ * of some packed / non-packed rev file as containing a specific item.
+ * There must be no overlapping / conflicting entries.
+ */
+typedef struct svn_fs_x__p2l_entry_t
+{
+  /* offset of the first byte that belongs to the item */
+  apr_off_t offset;
+
+  /* length of the item in bytes */
+  apr_off_t size;
+
+  /* type of the item (see SVN_FS_X__ITEM_TYPE_*) defines */
+  apr_uint32_t type;
+
+  /* modified FNV-1a checksum.  0 if unknown checksum */
+  apr_uint32_t fnv1_checksum;
+
+  /* Number of items in this block / container.  Their list can be found
+   * in *ITEMS.  0 for unused sections.  1 for non-container items,
+   * > 1 for containers. */
+  apr_uint32_t item_count;
+
+  /* List of items in that block / container */
+  svn_fs_x__id_t *items;
+} svn_fs_x__p2l_entry_t;
+
+/* Callback function type receiving a single P2L index ENTRY, a user
+ * provided BATON and a SCRATCH_POOL for temporary allocations.
+ * ENTRY's lifetime may end when the callback returns.
+ */
+typedef svn_error_t *
+(*svn_fs_x__dump_index_func_t)(const svn_fs_x__p2l_entry_t *entry,
+                               void *baton,
+                               apr_pool_t *scratch_pool);
+
+
+/* Statistics.  Unlike FSFS, most of the data in a packed FSX repository
+ * lives in containers, so most of the information here is about them.
+ */
+
+/* A single histogram line, i.e. the number of items and their total size
+ * within a certain size range.
+ */
+typedef struct svn_fs_x__histogram_line_t
+{
+  /* Number of items in this range. */
+  apr_uint64_t count;
+
+  /* Total size of those items. */
+  apr_uint64_t sum;
+} svn_fs_x__histogram_line_t;
+
+/* A histogram of 64 bins, where LINES[i] covers the sizes [2^(i-1), 2^i).
+ */
+typedef struct svn_fs_x__histogram_t
+{
+  /* Sum of all lines. */
+  svn_fs_x__histogram_line_t total;
+
+  /* The individual bins. */
+  svn_fs_x__histogram_line_t lines[64];
+} svn_fs_x__histogram_t;
+
+/* Number and total on-disk size of a group of items.
+ */
+typedef struct svn_fs_x__item_stats_t
+{
+  /* Number of items. */
+  apr_uint64_t count;
+
+  /* Total size of those items in the rev / pack files. */
+  apr_uint64_t size;
+} svn_fs_x__item_stats_t;
+
+/* Stand-alone (i.e. non-container) delta representations of one kind.
+ */
+typedef struct svn_fs_x__rep_stats_t
+{
+  /* Number and total on-disk size of these representations. */
+  svn_fs_x__item_stats_t total;
+
+  /* Total fulltext size of these representations.  Only reps referenced
+   * by any noderev will be counted. */
+  apr_uint64_t expanded_size;
+
+  /* Sum of the delta chain lengths of all these representations. */
+  apr_uint64_t chain_len;
+} svn_fs_x__rep_stats_t;
+
+/* Star-delta representation containers (see libsvn_fs_x/reps.c).
+ */
+typedef struct svn_fs_x__reps_container_stats_t
+{
+  /* Number and total on-disk size of the containers. */
+  svn_fs_x__item_stats_t total;
+
+  /* Number of fulltexts in all containers. */
+  apr_uint64_t rep_count;
+
+  /* Total size of those fulltexts. */
+  apr_uint64_t expanded_size;
+
+  /* Total size of the text corpora shared by the fulltexts. */
+  apr_uint64_t text_size;
+
+  /* Number of base representations outside the containers. */
+  apr_uint64_t base_count;
+
+  /* Number of instructions stored in all containers. */
+  apr_uint64_t instruction_count;
+
+  /* Number of copy operations it takes to extract each fulltext once. */
+  apr_uint64_t copy_count;
+
+  /* Deepest nesting of instruction sub-sequences in any container. */
+  apr_uint64_t max_nesting;
+
+  /* Distribution of the container sizes. */
+  svn_fs_x__histogram_t size_histogram;
+} svn_fs_x__reps_container_stats_t;
+
+/* Noderev containers (see libsvn_fs_x/noderevs.c).
+ */
+typedef struct svn_fs_x__noderevs_container_stats_t
+{
+  /* Number and total on-disk size of the containers. */
+  svn_fs_x__item_stats_t total;
+
+  /* Number of noderevs in all containers. */
+  apr_uint64_t noderev_count;
+
+  /* Number of distinct IDs stored in all containers. */
+  apr_uint64_t id_count;
+
+  /* Number of distinct representation descriptions in all containers. */
+  apr_uint64_t rep_count;
+
+  /* Distribution of the container sizes. */
+  svn_fs_x__histogram_t size_histogram;
+} svn_fs_x__noderevs_container_stats_t;
+
+/* Changed paths list containers (see libsvn_fs_x/changes.c).
+ */
+typedef struct svn_fs_x__changes_container_stats_t
+{
+  /* Number and total on-disk size of the containers. */
+  svn_fs_x__item_stats_t total;
+
+  /* Number of changed paths lists in all containers. */
+  apr_uint64_t list_count;
+
+  /* Number of changes in all containers. */
+  apr_uint64_t change_count;
+} svn_fs_x__changes_container_stats_t;
+
+/* Number of bins in svn_fs_x__stats_t.chain_lengths.
+ */
+#define SVN_FS_X__STATS_MAX_CHAIN_LEN 64
+
+/* Root data structure for all the FSX stats.
+ */
+typedef struct svn_fs_x__stats_t
+{
+  /* Number of revisions in the repository. */
+  apr_uint64_t revision_count;
+
+  /* Total size of all rev / pack file contents, excluding the indexes. */
+  apr_uint64_t total_size;
+
+  /* Total number of changed paths. */
+  apr_uint64_t change_count;
+
+  /* Number of directory and file noderevs, regardless of where they are
+   * stored. */
+  apr_uint64_t dir_node_count;
+  apr_uint64_t file_node_count;
+
+  /* Stand-alone noderevs and changed paths lists, i.e. items in
+   * non-packed revisions. */
+  svn_fs_x__item_stats_t noderevs;
+  svn_fs_x__item_stats_t changes;
+
+  /* Stand-alone representations by kind. */
+  svn_fs_x__rep_stats_t file_rep_stats;
+  svn_fs_x__rep_stats_t dir_rep_stats;
+  svn_fs_x__rep_stats_t file_prop_rep_stats;
+  svn_fs_x__rep_stats_t dir_prop_rep_stats;
+
+  /* Number of stand-alone representations by delta chain length.
+   * The last element also counts all longer chains. */
+  apr_uint64_t chain_lengths[SVN_FS_X__STATS_MAX_CHAIN_LEN];
+
+  /* Longest delta chain found. */
+  apr_uint64_t max_chain_len;
+
+  /* Number of representation references from noderevs. */
+  apr_uint64_t rep_references;
+
+  /* Number of those references that point into a reps container, i.e.
+   * can be served without applying any deltas. */
+  apr_uint64_t container_rep_references;
+
+  /* Sum of the delta chain lengths over all references. */
+  apr_uint64_t referenced_chain_len;
+
+  /* Container statistics. */
+  svn_fs_x__reps_container_stats_t reps_containers;
+  svn_fs_x__noderevs_container_stats_t noderevs_containers;
+  svn_fs_x__changes_container_stats_t changes_containers;
+
+  /* Distribution of the stand-alone representation sizes. */
+  svn_fs_x__histogram_t rep_size_histogram;
+
+  /* Distribution of the fulltext sizes referenced by file and directory
+   * noderevs. */
+  svn_fs_x__histogram_t file_histogram;
+  svn_fs_x__histogram_t dir_histogram;
+} svn_fs_x__stats_t;
+
+
+/* ioctls */
+
+typedef struct svn_fs_x__ioctl_get_stats_input_t
+{
+  svn_fs_progress_notify_func_t progress_func;
+  void *progress_baton;
+
+  /* Number of rev / pack files to read in parallel.  0 is the same as 1. */
+  int thread_count;
+} svn_fs_x__ioctl_get_stats_input_t;
+
+typedef struct svn_fs_x__ioctl_get_stats_output_t
+{
+  svn_fs_x__stats_t *stats;
+} svn_fs_x__ioctl_get_stats_output_t;
+
+SVN_FS_DECLARE_IOCTL_CODE(SVN_FS_X__IOCTL_GET_STATS, SVN_FS_TYPE_FSX, 1000);
+
+typedef struct svn_fs_x__ioctl_dump_index_input_t
+{
+  svn_revnum_t revision;
+  svn_fs_x__dump_index_func_t callback_func;
+  void *callback_baton;
+} svn_fs_x__ioctl_dump_index_input_t;
+
+SVN_FS_DECLARE_IOCTL_CODE(SVN_FS_X__IOCTL_DUMP_INDEX, SVN_FS_TYPE_FSX, 1001);
+
+typedef struct svn_fs_x__ioctl_load_index_input_t
+{
+  svn_revnum_t revision;
+  /* Array of svn_fs_x__p2l_entry_t * entries. */
+  apr_array_header_t *entries;
+} svn_fs_x__ioctl_load_index_input_t;
+
+SVN_FS_DECLARE_IOCTL_CODE(SVN_FS_X__IOCTL_LOAD_INDEX, SVN_FS_TYPE_FSX, 1002);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* SVN_FS_X_PRIVATE_H */
@@ -85,6 +85,21 @@ svn_io__file_lock_autocreate(const char *lock_file,
                              apr_pool_t *pool);
 
 
+/**
+ * Tell the operating system that the @a length bytes starting at
+ * @a offset in @a file will be read soon, so that it may fetch them
+ * into its page cache in the background.  This is only a hint; if the
+ * platform does not support it or refuses it, this is a no-op.
+ *
+ * Use @a scratch_pool for temporary allocations.
+ */
+svn_error_t *
+svn_io__file_readahead(apr_file_t *file,
+                       apr_off_t offset,
+                       apr_off_t length,
+                       apr_pool_t *scratch_pool);
+
+
 /** Return the underlying file, if any, associated with the stream, or
  * NULL if not available.  Accessing the file bypasses the stream.
  */
@@ -390,6 +390,107 @@ svn_repos__get_dump_editor(const svn_delta_editor_t **editor,
                            const char *update_anchor_relpath,
                            apr_pool_t *pool);
 
+/* Enable the cache of update editor drives for REPOS, which lets
+ * svn_repos_finish_report() replay the results of previous identical
+ * reports instead of recomputing them.  The cached drives take up to
+ * MAX_SIZE bytes in their serialized form, with the least recently used
+ * ones being removed to make room for new ones.  0 disables the cache,
+ * which is the default.
+ *
+ * The cache is kept in the repository's directory and is shared between
+ * all processes that enabled it.  Changes to svn:author and svn:date
+ * revision properties through libsvn_repos invalidate it.  Reports that carry lock tokens are
+ * never cached, and neither are reports that use an authz callback
+ * without an authz fingerprint (see
+ * svn_repos__report_set_authz_fingerprint()).
+ */
+void
+svn_repos__enable_report_cache(svn_repos_t *repos,
+                               apr_uint64_t max_size);
+
+/* Declare that the authz_read_func given to svn_repos_begin_report3()
+ * for REPORT_BATON grants access to paths as identified by the string
+ * FINGERPRINT.  Reports with different fingerprints never share their
+ * update report cache entries.  Without a fingerprint, reports that use
+ * an authz callback will not be cached.
+ */
+void
+svn_repos__report_set_authz_fingerprint(void *report_baton,
+                                        const char *fingerprint);
+
+/* Set *FINGERPRINT to a string that uniquely identifies the access rights
+ * of USER to REPOS_NAME in AUTHZ, as used by
+ * svn_repos_authz_check_access(), allocated in RESULT_POOL.  Set it to
+ * NULL if no such identification is available for AUTHZ.
+ */
+void
+svn_repos__authz_fingerprint(const char **fingerprint,
+                             svn_authz_t *authz,
+                             const char *repos_name,
+                             const char *user,
+                             apr_pool_t *result_pool);
+
+/* Baton for svn_repos__authz_read_func(). */
+typedef struct svn_repos__authz_read_baton_t
+{
+  /* The rules to check against. */
+  svn_authz_t *authz;
+
+  /* Repository name and user as passed to svn_repos_authz_check_access(). */
+  const char *repos_name;
+  const char *user;
+} svn_repos__authz_read_baton_t;
+
+/* Set *ALLOWED to TRUE if PATH is readable according to BATON, which is
+ * a svn_repos__authz_read_baton_t.  Relative paths are taken to be
+ * relative to the repository root.  ROOT is not used.  Use POOL for
+ * temporary allocations.  Implements svn_repos_authz_func_t.
+ *
+ * Code in libsvn_repos that checks many paths in a row recognizes this
+ * function and uses svn_repos_authz_check_access_many() instead of
+ * calling it once per path.
+ */
+svn_error_t *
+svn_repos__authz_read_func(svn_boolean_t *allowed,
+                           svn_fs_root_t *root,
+                           const char *path,
+                           void *baton,
+                           apr_pool_t *pool);
+
+/* Enable the cache of replayed revisions for REPOS, which lets
+ * svn_repos__replay_cached() replay previously recorded editor drives
+ * instead of recomputing them.  Only drives of up to MAX_ENTRY_SIZE bytes
+ * in their serialized form will be cached.  0 disables the cache, which
+ * is the default.
+ *
+ * Like the update report cache, the cache is kept in the repository's
+ * directory and is shared between all processes that enabled it.
+ */
+void
+svn_repos__enable_replay_cache(svn_repos_t *repos,
+                               apr_uint64_t max_entry_size);
+
+/* Like svn_repos_replay2() for REVISION in REPOS, but use the replay
+ * cache of REPOS if it has been enabled.
+ *
+ * AUTHZ_FINGERPRINT identifies the access rights granted by
+ * AUTHZ_READ_FUNC in the same way as for
+ * svn_repos__report_set_authz_fingerprint().  If AUTHZ_READ_FUNC is
+ * given but AUTHZ_FINGERPRINT is NULL, the cache will not be used.
+ */
+svn_error_t *
+svn_repos__replay_cached(svn_repos_t *repos,
+                         svn_revnum_t revision,
+                         const char *base_dir,
+                         svn_revnum_t low_water_mark,
+                         svn_boolean_t send_deltas,
+                         const svn_delta_editor_t *editor,
+                         void *edit_baton,
+                         svn_repos_authz_func_t authz_read_func,
+                         void *authz_read_baton,
+                         const char *authz_fingerprint,
+                         apr_pool_t *pool);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
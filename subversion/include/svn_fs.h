@@ -166,6 +166,15 @@ typedef struct svn_fs_t svn_fs_t;
  */
 #define SVN_FS_CONFIG_FSFS_LOG_ADDRESSING       "fsfs-log-addressing"
 
+/** Enable / disable the process-wide cache of path lookups in revision
+ * roots for a FSX repository.  All svn_fs_t instances opened for the
+ * same repository within the same process and with this option enabled
+ * will share the results of their DAG walks.
+ *
+ * @since New in 1.15.
+ */
+#define SVN_FS_CONFIG_FSX_SHARED_DAG_CACHE      "fsx-shared-dag-cache"
+
 /* Note to maintainers: if you add further SVN_FS_CONFIG_FSFS_CACHE_* knobs,
    update fs_fs.c:verify_as_revision_before_current_plus_plus(). */
 
@@ -543,11 +552,24 @@ typedef void (*svn_fs_hotcopy_notify_t)(void *baton,
  * incremental hotcopy is not implemented, raise
  * #SVN_ERR_UNSUPPORTED_FEATURE.
  *
+ * If @a compare_checksums is TRUE, an incremental hotcopy may use the
+ * checksums stored in the source and destination to decide that data is
+ * already present in the destination, even if the timestamps alone would
+ * suggest that it has to be copied again.  Currently, this is only
+ * implemented for packed shards in FSFS repositories with logical
+ * addressing.
+ *
+ * Use up to @a thread_count threads to copy independent parts of the
+ * filesystem in parallel.  A value of 1 copies sequentially.  Currently,
+ * only the FSFS backend copies packed shards in parallel; other backends
+ * ignore this parameter.
+ *
  * For each revision range copied, @a notify_func will be called with
  * staring and ending revision numbers (both inclusive and not necessarily
- * different) and with the @a notify_baton.  Currently, this notification
- * is not triggered by the BDB backend.  @a notify_func may be @c NULL
- * if this notification is not required.
+ * different) and with the @a notify_baton.  The notifications will be
+ * made in revision order from within the calling thread.  Currently, this
+ * notification is not triggered by the BDB backend.  @a notify_func may be
+ * @c NULL if this notification is not required.
  *
  * The optional @a cancel_func callback will be invoked with
  * @a cancel_baton as usual to allow the user to preempt this potentially
@@ -555,8 +577,29 @@ typedef void (*svn_fs_hotcopy_notify_t)(void *baton,
  *
  * Use @a scratch_pool for temporary allocations.
  *
+ * @since New in 1.15.
+ */
+svn_error_t *
+svn_fs_hotcopy4(const char *src_path,
+                const char *dest_path,
+                svn_boolean_t clean,
+                svn_boolean_t incremental,
+                svn_boolean_t compare_checksums,
+                int thread_count,
+                svn_fs_hotcopy_notify_t notify_func,
+                void *notify_baton,
+                svn_cancel_func_t cancel_func,
+                void *cancel_baton,
+                apr_pool_t *scratch_pool);
+
+/**
+ * Like svn_fs_hotcopy4(), but with @a compare_checksums always passed as
+ * @c FALSE and @a thread_count always passed as 1.
+ *
+ * @deprecated Provided for backward compatibility with the 1.14 API.
  * @since New in 1.9.
  */
+SVN_DEPRECATED
 svn_error_t *
 svn_fs_hotcopy3(const char *src_path,
                 const char *dest_path,
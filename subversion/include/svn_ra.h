@@ -37,6 +37,7 @@
 #include "svn_types.h"
 #include "svn_string.h"
 #include "svn_delta.h"
+#include "svn_diff.h"
 #include "svn_auth.h"
 #include "svn_mergeinfo.h"
 
@@ -1915,6 +1916,65 @@ svn_ra_get_file_revs(svn_ra_session_t *session,
                      void *handler_baton,
                      apr_pool_t *pool);
 
+/**
+ * Callback type to be used with svn_ra_blame().  It will be invoked for
+ * every line of the file, in order.
+ *
+ * @a line_no is the 0-based number of the line and @a line its contents,
+ * without the line ending.  @a revision is the revision that last changed
+ * the line and @a rev_props the revision properties of @a revision.  If
+ * the line has not been changed between the start and the end revision,
+ * @a revision will be #SVN_INVALID_REVNUM and @a rev_props will be
+ * @c NULL.
+ *
+ * @a baton is the user-provided receiver baton.  @a scratch_pool may be
+ * used for temporary allocations.
+ *
+ * @since New in 1.15.
+ */
+typedef svn_error_t *(*svn_ra_blame_receiver_t)(void *baton,
+                                                apr_int64_t line_no,
+                                                svn_revnum_t revision,
+                                                apr_hash_t *rev_props,
+                                                const svn_string_t *line,
+                                                apr_pool_t *scratch_pool);
+
+/**
+ * Let the server determine for each line of the file @a path as seen
+ * in revision @a end, which revision between @a start and @a end last
+ * changed it, and invoke @a receiver with @a receiver_baton for every
+ * line.  @a start must not be larger than @a end.  Lines are compared as
+ * specified by @a diff_options, which may be @c NULL.  Only its
+ * @c ignore_space and @c ignore_eol_style members are being used.
+ *
+ * This gives the same result as svn_ra_get_file_revs2() with
+ * @a include_merged_revisions set to @c FALSE followed by a client-side
+ * comparison of all revisions but only transmits the final annotation.
+ * Line endings are normalized to LF and are not part of the lines.
+ *
+ * If the file has a binary #SVN_PROP_MIME_TYPE in revision @a end,
+ * return #SVN_ERR_CLIENT_IS_BINARY_FILE.
+ *
+ * If the server doesn't support the 'blame' command or declines to
+ * compute the blame for this file, e.g. because it is too large, return
+ * #SVN_ERR_UNSUPPORTED_FEATURE in preference to any other error that
+ * might otherwise be returned.  In that case, @a receiver will not have
+ * been called.
+ *
+ * Use @a scratch_pool for temporary memory allocation.
+ *
+ * @since New in 1.15.
+ */
+svn_error_t *
+svn_ra_blame(svn_ra_session_t *session,
+             const char *path,
+             svn_revnum_t start,
+             svn_revnum_t end,
+             const svn_diff_file_options_t *diff_options,
+             svn_ra_blame_receiver_t receiver,
+             void *receiver_baton,
+             apr_pool_t *scratch_pool);
+
 /**
  * Lock each path in @a path_revs, which is a hash whose keys are the
  * paths to be locked, and whose values are the corresponding base
@@ -2288,6 +2348,13 @@ svn_ra_has_capability(svn_ra_session_t *session,
  */
 #define SVN_RA_CAPABILITY_LIST "list"
 
+/**
+ * The capability of a server to compute line annotations itself.
+ *
+ * @since New in 1.15.
+ */
+#define SVN_RA_CAPABILITY_BLAME "blame"
+
 
 /*       *** PLEASE READ THIS IF YOU ADD A NEW CAPABILITY ***
  *
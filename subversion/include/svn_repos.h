@@ -35,6 +35,7 @@
 #include "svn_types.h"
 #include "svn_string.h"
 #include "svn_delta.h"
+#include "svn_diff.h"
 #include "svn_fs.h"
 #include "svn_io.h"
 #include "svn_mergeinfo.h"
@@ -668,6 +669,9 @@ svn_repos_fs_type(svn_repos_t *repos,
  * already present in the destination. If incremental hotcopy is not
  * implemented by the filesystem backend, raise SVN_ERR_UNSUPPORTED_FEATURE.
  *
+ * @a compare_checksums and @a thread_count are passed through to
+ * svn_fs_hotcopy4(); see there for their semantics.
+ *
  * For each revision range copied, the @a notify_func function will be
  * called with the @a notify_baton and a notification structure containing
  * appropriate values in @c start_revision and @c end_revision (both
@@ -682,8 +686,29 @@ svn_repos_fs_type(svn_repos_t *repos,
  *
  * Use @a scratch_pool for temporary allocations.
  *
+ * @since New in 1.15.
+ */
+svn_error_t *
+svn_repos_hotcopy4(const char *src_path,
+                   const char *dst_path,
+                   svn_boolean_t clean_logs,
+                   svn_boolean_t incremental,
+                   svn_boolean_t compare_checksums,
+                   int thread_count,
+                   svn_repos_notify_func_t notify_func,
+                   void *notify_baton,
+                   svn_cancel_func_t cancel_func,
+                   void *cancel_baton,
+                   apr_pool_t *scratch_pool);
+
+/**
+ * Like svn_repos_hotcopy4(), but with @a compare_checksums always passed
+ * as @c FALSE and @a thread_count always passed as 1.
+ *
  * @since New in 1.9.
+ * @deprecated Provided for backward compatibility with the 1.14 API.
  */
+SVN_DEPRECATED
 svn_error_t *
 svn_repos_hotcopy3(const char *src_path,
                    const char *dst_path,
@@ -1000,6 +1025,110 @@ svn_repos_hooks_setenv(svn_repos_t *repos,
 
 /** @} */
 
+/** @defgroup svn_repos_hook_modules In-process hook modules
+ * @{
+ *
+ * Instead of a hook program, the hooks directory may contain a loadable
+ * module of the same name plus #SVN_REPOS_HOOK_MODULE_EXT, e.g.
+ * "pre-commit.so".  The module is loaded into the process that runs the
+ * commit and is being passed the open repository and transaction, so no
+ * new process has to be started and the repository does not have to be
+ * opened again.  If both a module and a hook program exist for the same
+ * hook, only the module will be run.  Only the hook implementation that
+ * matches the module's file name is being called, so the same module may
+ * be installed under several hook names.
+ *
+ * Modules are loaded once per process and never unloaded.  They must
+ * export a function named #SVN_REPOS_HOOK_MODULE_INIT_SYMBOL of type
+ * #svn_repos_hook_module_init_t.  Modules are currently supported for
+ * the start-commit, pre-commit and post-commit hooks only.
+ *
+ * @note Modules are loaded through svn_dso_load(), which caches its
+ * results for the lifetime of the process, including failures to load a
+ * file.  Replacing or removing a module file therefore has no effect on
+ * processes that already loaded it (or tried to), and a module that
+ * failed to load will not be retried.  Long-running servers such as
+ * httpd or svnserve must be restarted after installing, updating or
+ * fixing a hook module.
+ *
+ * @since New in 1.15.
+ */
+
+/** File name extension of in-process hook modules. */
+#ifdef WIN32
+#define SVN_REPOS_HOOK_MODULE_EXT ".dll"
+#else
+#define SVN_REPOS_HOOK_MODULE_EXT ".so"
+#endif
+
+/** Name of the function that every hook module must export. */
+#define SVN_REPOS_HOOK_MODULE_INIT_SYMBOL "svn_repos_hook_module_init"
+
+/** Version of the #svn_repos_hook_module_t ABI.  It will only change
+ * when existing members of that structure change.  New members will only
+ * be added at its end and be detected through its @c struct_size. */
+#define SVN_REPOS_HOOK_MODULE_ABI_VERSION 1
+
+/** The hook implementations provided by a hook module.  Any of the
+ * function pointers may be @c NULL, in which case the module does not
+ * implement that hook and no hook will be run for it.
+ *
+ * Hook implementations signal failure by returning an error, which will
+ * be reported in the same way as the output of a failing hook program.
+ * They must not change the contents of the transaction or the repository
+ * and must be thread-safe.  All functions use @a scratch_pool for
+ * temporary allocations.
+ */
+typedef struct svn_repos_hook_module_t
+{
+  /** Must be #SVN_REPOS_HOOK_MODULE_ABI_VERSION. */
+  int abi_version;
+
+  /** Must be @c sizeof(svn_repos_hook_module_t) as seen by the module
+   * when it was compiled.  Members that lie beyond that size are not
+   * read and treated as @c NULL, so modules built against older
+   * versions of this structure keep working. */
+  apr_size_t struct_size;
+
+  /** The start-commit hook for the commit of the freshly created
+   * transaction @a txn_name by @a user (may be @c NULL) into @a repos.
+   * @a capabilities are the client's capabilities (const char *); it
+   * may be @c NULL. */
+  svn_error_t *(*start_commit)(svn_repos_t *repos,
+                               const char *user,
+                               const apr_array_header_t *capabilities,
+                               const char *txn_name,
+                               apr_pool_t *scratch_pool);
+
+  /** The pre-commit hook for transaction @a txn in @a repos, whose root
+   * is @a txn_root.  @a lock_tokens maps the tokens of the locks that
+   * the committer holds (const char *) to the locked paths
+   * (const char *); it may be empty. */
+  svn_error_t *(*pre_commit)(svn_repos_t *repos,
+                             svn_fs_txn_t *txn,
+                             svn_fs_root_t *txn_root,
+                             apr_hash_t *lock_tokens,
+                             apr_pool_t *scratch_pool);
+
+  /** The post-commit hook for revision @a rev in @a repos, which has
+   * been created from transaction @a txn_name. */
+  svn_error_t *(*post_commit)(svn_repos_t *repos,
+                              svn_revnum_t rev,
+                              const char *txn_name,
+                              apr_pool_t *scratch_pool);
+} svn_repos_hook_module_t;
+
+/** The type of the #SVN_REPOS_HOOK_MODULE_INIT_SYMBOL function of hook
+ * modules.  Set @a *module to the module's hook implementations, which
+ * must remain valid until the process exits.  @a pool lives as long as
+ * the process and may be used for global allocations of the module.
+ */
+typedef svn_error_t *(*svn_repos_hook_module_init_t)(
+  const svn_repos_hook_module_t **module,
+  apr_pool_t *pool);
+
+/** @} */
+
 /* ---------------------------------------------------------------*/
 
 /* Reporting the state of a working copy, for updates. */
@@ -1759,8 +1888,10 @@ typedef svn_error_t *(* svn_repos_dirent_receiver_t)(const char *path,
  * @a depth.  For each directory entry found, @a receiver will be called
  * with @a receiver_baton.  The starting @a path will be reported as well.
  * Because retrieving all elements of a #svn_dirent_t can be expensive,
- * you may set @a path_info_only to receive only the path name and the node
- * kind.  The entries will be reported ordered by their path.
+ * only the fields given by @a dirent_fields will be filled in.  It is a
+ * combination of the @c SVN_DIRENT_* flags, e.g. #SVN_DIRENT_KIND to
+ * receive only the path name and the node kind; the kind is always
+ * available.  The entries will be reported ordered by their path.
  *
  * @a patterns is an optional array of <tt>const char *</tt>.  If it is
  * not @c NULL, only those directory entries will be reported whose last
@@ -1771,6 +1902,14 @@ typedef svn_error_t *(* svn_repos_dirent_receiver_t)(const char *path,
  * If @a authz_read_func is not @c NULL, this function will neither report
  * entries nor recurse into directories that the user has no access to.
  *
+ * With a @a thread_count larger than 1, sub-trees get walked concurrently
+ * by up to that many worker threads, each of which opens its own instance
+ * of the filesystem of @a root with the same configuration.  The entries
+ * will still be reported in the same order and both, @a receiver and
+ * @a authz_read_func, will only be called from within the calling thread.
+ * Sub-directories are handed to the workers only after @a authz_read_func
+ * granted access to them.
+ *
  * Cancellation support is provided in the usual way through the optional
  * @a cancel_func and @a cancel_baton.
  *
@@ -1779,8 +1918,32 @@ typedef svn_error_t *(* svn_repos_dirent_receiver_t)(const char *path,
  *
  * Use @a scratch_pool for temporary memory allocation.
  *
+ * @since New in 1.15.
+ */
+svn_error_t *
+svn_repos_list2(svn_fs_root_t *root,
+                const char *path,
+                const apr_array_header_t *patterns,
+                svn_depth_t depth,
+                apr_uint32_t dirent_fields,
+                int thread_count,
+                svn_repos_authz_func_t authz_read_func,
+                void *authz_read_baton,
+                svn_repos_dirent_receiver_t receiver,
+                void *receiver_baton,
+                svn_cancel_func_t cancel_func,
+                void *cancel_baton,
+                apr_pool_t *scratch_pool);
+
+/**
+ * Similar to svn_repos_list2(), but with @a thread_count always passed
+ * as 1.  If @a path_info_only is set, @a dirent_fields is
+ * #SVN_DIRENT_KIND, otherwise #SVN_DIRENT_ALL.
+ *
  * @since New in 1.10.
+ * @deprecated Provided for backward compatibility with the 1.14 API.
  */
+SVN_DEPRECATED
 svn_error_t *
 svn_repos_list(svn_fs_root_t *root,
                const char *path,
@@ -2465,6 +2628,78 @@ svn_repos_get_file_revs(svn_repos_t *repos,
                         apr_pool_t *pool);
 
 
+/**
+ * Callback type to be used with svn_repos_blame().  It will be invoked
+ * for every line of the file, in order.
+ *
+ * @a line_no is the 0-based number of the line and @a line its contents,
+ * without the line ending.  @a revision is the revision that last changed
+ * the line and @a rev_props the revision properties of @a revision.  If
+ * the line has not been changed between the start and the end revision
+ * of the blame operation, @a revision will be #SVN_INVALID_REVNUM and
+ * @a rev_props will be @c NULL.
+ *
+ * @a baton is the user-provided receiver baton.  @a scratch_pool may be
+ * used for temporary allocations.
+ *
+ * @since New in 1.15.
+ */
+typedef svn_error_t *(*svn_repos_blame_receiver_t)(void *baton,
+                                                   apr_int64_t line_no,
+                                                   svn_revnum_t revision,
+                                                   apr_hash_t *rev_props,
+                                                   const svn_string_t *line,
+                                                   apr_pool_t *scratch_pool);
+
+/**
+ * Determine for each line of the file @a path in @a repos as seen in
+ * revision @a end, which revision between @a start and @a end last
+ * changed it, and invoke @a receiver with @a receiver_baton for every
+ * line.  @a start must not be larger than @a end.
+ *
+ * This is the same computation a client performs on the data returned
+ * by svn_repos_get_file_revs2() with @a include_merged_revisions set to
+ * @c FALSE, but it does not have to transfer the file contents of each
+ * interesting revision.  Lines are compared as specified by
+ * @a diff_options, which may be @c NULL for the default options.  The
+ * contents of @a path are reported with all line endings normalized to
+ * LF, i.e. the line endings are not part of the lines passed to
+ * @a receiver.
+ *
+ * @a authz_read_func and @a authz_read_baton are used as in
+ * svn_repos_get_file_revs2().
+ *
+ * If @a path has a binary #SVN_PROP_MIME_TYPE in revision @a end, return
+ * #SVN_ERR_CLIENT_IS_BINARY_FILE.
+ *
+ * The contents of @a path are being held in memory in all revisions that
+ * get compared.  If @a max_size is not 0 and any of them is larger than
+ * @a max_size bytes, return #SVN_ERR_UNSUPPORTED_FEATURE, upon which
+ * callers may fall back to computing the blame from
+ * svn_repos_get_file_revs2().
+ *
+ * If @a cancel_func is not @c NULL, call it with @a cancel_baton as
+ * needed to check for cancellation.  Use @a scratch_pool for temporary
+ * allocations.
+ *
+ * @since New in 1.15.
+ */
+svn_error_t *
+svn_repos_blame(svn_repos_t *repos,
+                const char *path,
+                svn_revnum_t start,
+                svn_revnum_t end,
+                const svn_diff_file_options_t *diff_options,
+                svn_filesize_t max_size,
+                svn_repos_authz_func_t authz_read_func,
+                void *authz_read_baton,
+                svn_repos_blame_receiver_t receiver,
+                void *receiver_baton,
+                svn_cancel_func_t cancel_func,
+                void *cancel_baton,
+                apr_pool_t *scratch_pool);
+
+
 /* ---------------------------------------------------------------*/
 
 /**
@@ -3338,14 +3573,54 @@ svn_repos_verify_fs(svn_repos_t *repos,
  * If @a filter_func is not @c NULL, it is called for each node being
  * dumped, allowing the caller to exclude it from dump.
  *
+ * Use up to @a thread_count threads to dump disjoint revision ranges
+ * concurrently.  Each range gets written to a temporary file first and
+ * the files get appended to @a stream in revision order.  The output
+ * is the same as with a @a thread_count of 1, which dumps sequentially
+ * without temporary files.  The number of ranges kept in temporary files
+ * at any time is limited to a fixed number per thread.  That bounds the
+ * temporary disk space needed if @a stream accepts data more slowly than
+ * the dump gets produced.  With more than one thread, @a filter_func
+ * may be called from any of the worker threads.  The calls are
+ * serialized, so it need not be thread-safe, but it must not rely on
+ * thread-local state.  Notifications will be delivered from within the
+ * calling thread once all data for the respective range have been
+ * written.
+ *
  * If @a cancel_func is not @c NULL, it is called periodically with
  * @a cancel_baton as argument to see if the client wishes to cancel
  * the dump.
  *
  * Use @a scratch_pool for temporary allocation.
  *
+ * @since New in 1.15.
+ */
+svn_error_t *
+svn_repos_dump_fs5(svn_repos_t *repos,
+                   svn_stream_t *stream,
+                   svn_revnum_t start_rev,
+                   svn_revnum_t end_rev,
+                   svn_boolean_t incremental,
+                   svn_boolean_t use_deltas,
+                   svn_boolean_t include_revprops,
+                   svn_boolean_t include_changes,
+                   int thread_count,
+                   svn_repos_notify_func_t notify_func,
+                   void *notify_baton,
+                   svn_repos_dump_filter_func_t filter_func,
+                   void *filter_baton,
+                   svn_cancel_func_t cancel_func,
+                   void *cancel_baton,
+                   apr_pool_t *pool);
+
+/**
+ * Similar to svn_repos_dump_fs5(), but with @a thread_count always
+ * passed as 1.
+ *
  * @since New in 1.10.
+ * @deprecated Provided for backward compatibility with the 1.14 API.
  */
+SVN_DEPRECATED
 svn_error_t *
 svn_repos_dump_fs4(svn_repos_t *repos,
                    svn_stream_t *stream,
@@ -3479,12 +3754,55 @@ svn_repos_dump_fs(svn_repos_t *repos,
  * If non-NULL, use @a notify_func and @a notify_baton to send notification
  * of events to the caller.
  *
+ * Use up to @a thread_count threads to checksum and deltify the file
+ * contents of each loaded revision concurrently.  To that end, the
+ * contents of small to medium-sized files will be collected in memory
+ * until the end of the revision.  Revisions are still committed one at
+ * a time and in order.  If the filesystem backend does not support
+ * this, @a thread_count is ignored.
+ *
+ * If @a bulk is set, the filesystem backend may defer any bookkeeping
+ * that it can catch up on more efficiently at the end of the load,
+ * such as the updates to the FSFS rep-cache.  This is meant to be used
+ * when populating new repositories and typically combined with the
+ * #SVN_FS_CONFIG_NO_FLUSH_TO_DISK filesystem configuration option.
+ * At the end of the load, even a failed one, the backend catches up and
+ * flushes all revisions committed during the load to disk.
+ *
  * If @a cancel_func is not @c NULL, it is called periodically with
  * @a cancel_baton as argument to see if the client wishes to cancel
  * the load.
  *
+ * @since New in 1.15.
+ */
+svn_error_t *
+svn_repos_load_fs7(svn_repos_t *repos,
+                   svn_stream_t *dumpstream,
+                   svn_revnum_t start_rev,
+                   svn_revnum_t end_rev,
+                   enum svn_repos_load_uuid uuid_action,
+                   const char *parent_dir,
+                   svn_boolean_t use_pre_commit_hook,
+                   svn_boolean_t use_post_commit_hook,
+                   svn_boolean_t validate_props,
+                   svn_boolean_t ignore_dates,
+                   svn_boolean_t normalize_props,
+                   int thread_count,
+                   svn_boolean_t bulk,
+                   svn_repos_notify_func_t notify_func,
+                   void *notify_baton,
+                   svn_cancel_func_t cancel_func,
+                   void *cancel_baton,
+                   apr_pool_t *pool);
+
+/**
+ * Similar to svn_repos_load_fs7(), but with @a thread_count always
+ * passed as 1 and @a bulk always passed as @c FALSE.
+ *
  * @since New in 1.10.
+ * @deprecated Provided for backward compatibility with the 1.14 API.
  */
+SVN_DEPRECATED
 svn_error_t *
 svn_repos_load_fs6(svn_repos_t *repos,
                    svn_stream_t *dumpstream,
@@ -4310,6 +4628,31 @@ svn_repos_authz_check_access(svn_authz_t *authz,
                              svn_boolean_t *access_granted,
                              apr_pool_t *pool);
 
+/**
+ * Like svn_repos_authz_check_access() but check the @a required_access
+ * of @a user for all @a paths (const char *) at once.  Set
+ * @a *access_granted_p to an array of #svn_boolean_t, allocated in
+ * @a result_pool, whose elements correspond to those in @a paths.
+ * The elements of @a paths must not be NULL.
+ *
+ * This is considerably faster than checking the @a paths one by one,
+ * in particular if they share parent paths, as it processes them in
+ * tree order and reuses the rule lookups for their common parents.
+ *
+ * Use @a scratch_pool for temporary allocations.
+ *
+ * @since New in 1.15.
+ */
+svn_error_t *
+svn_repos_authz_check_access_many(apr_array_header_t **access_granted_p,
+                                  svn_authz_t *authz,
+                                  const char *repos_name,
+                                  const apr_array_header_t *paths,
+                                  const char *user,
+                                  svn_repos_authz_access_t required_access,
+                                  apr_pool_t *result_pool,
+                                  apr_pool_t *scratch_pool);
+
 
 
 /** Revision Access Levels
@@ -657,6 +657,35 @@ normalize_blames(struct blame_chain *chain,
     }
 }
 
+/* Baton for server_blame_receiver. */
+struct server_blame_baton
+{
+  svn_client_blame_receiver4_t receiver;
+  void *receiver_baton;
+  svn_client_ctx_t *ctx;
+};
+
+/* Implements svn_ra_blame_receiver_t, forwarding to the client's
+   svn_client_blame_receiver4_t. */
+static svn_error_t *
+server_blame_receiver(void *baton,
+                      apr_int64_t line_no,
+                      svn_revnum_t revision,
+                      apr_hash_t *rev_props,
+                      const svn_string_t *line,
+                      apr_pool_t *scratch_pool)
+{
+  struct server_blame_baton *sbb = baton;
+
+  if (sbb->ctx->cancel_func)
+    SVN_ERR(sbb->ctx->cancel_func(sbb->ctx->cancel_baton));
+
+  return svn_error_trace(sbb->receiver(sbb->receiver_baton, line_no,
+                                       revision, rev_props,
+                                       SVN_INVALID_REVNUM, NULL, NULL,
+                                       line, FALSE, scratch_pool));
+}
+
 svn_error_t *
 svn_client_blame6(svn_revnum_t *start_revnum_p,
                   svn_revnum_t *end_revnum_p,
@@ -774,6 +803,40 @@ svn_client_blame6(svn_revnum_t *start_revnum_p,
         }
     }
 
+  /* If the server can do the blame computation for us, let it.  This
+     saves transmitting every revision of the file.  We can't use that
+     for reverse blames, merge tracking or local modifications.  Servers
+     always refuse binary files, so we can't use it for those either. */
+  if (!include_merged_revisions
+      && !ignore_mime_type
+      && start_revnum <= end_revnum
+      && end->kind != svn_opt_revision_working)
+    {
+      svn_boolean_t server_blame;
+
+      SVN_ERR(svn_ra_has_capability(ra_session, &server_blame,
+                                    SVN_RA_CAPABILITY_BLAME, pool));
+      if (server_blame)
+        {
+          struct server_blame_baton sbb;
+          svn_error_t *err;
+
+          sbb.receiver = receiver;
+          sbb.receiver_baton = receiver_baton;
+          sbb.ctx = ctx;
+
+          /* The server may decline, e.g. if the file is too large for it.
+             It will do so before reporting any line. */
+          err = svn_ra_blame(ra_session, "", start_revnum, end_revnum,
+                             diff_options, server_blame_receiver, &sbb,
+                             pool);
+          if (!err || err->apr_err != SVN_ERR_UNSUPPORTED_FEATURE)
+            return svn_error_trace(err);
+
+          svn_error_clear(err);
+        }
+    }
+
   frb.start_rev = start_revnum;
   frb.end_rev = end_revnum;
   frb.target = target;
@@ -533,6 +533,17 @@ svn_fs_set_warning_func(svn_fs_t *fs, svn_fs_warning_callback_t warning,
   fs->warning_baton = warning_baton;
 }
 
+void
+svn_fs__warn(svn_fs_t *fs,
+             svn_error_t *err)
+{
+  if (err)
+    {
+      (fs->warning)(fs->warning_baton, err);
+      svn_error_clear(err);
+    }
+}
+
 svn_error_t *
 svn_fs_create2(svn_fs_t **fs_p,
                const char *path,
@@ -657,8 +668,10 @@ svn_fs_delete_fs(const char *path, apr_pool_t *pool)
 }
 
 svn_error_t *
-svn_fs_hotcopy3(const char *src_path, const char *dst_path,
+svn_fs_hotcopy4(const char *src_path, const char *dst_path,
                 svn_boolean_t clean, svn_boolean_t incremental,
+                svn_boolean_t compare_checksums,
+                int thread_count,
                 svn_fs_hotcopy_notify_t notify_func,
                 void *notify_baton,
                 svn_cancel_func_t cancel_func,
@@ -676,6 +689,11 @@ svn_fs_hotcopy3(const char *src_path, const char *dst_path,
     return svn_error_create(SVN_ERR_INCORRECT_PARAMS, NULL,
                              _("Hotcopy source and destination are equal"));
 
+  if (thread_count < 1)
+    return svn_error_createf(SVN_ERR_INCORRECT_PARAMS, NULL,
+                             _("Invalid number of hotcopy threads: %d"),
+                             thread_count);
+
   SVN_ERR(svn_fs_type(&src_fs_type, src_path, scratch_pool));
   SVN_ERR(get_library_vtable(&vtable, src_fs_type, scratch_pool));
   src_fs = fs_new(NULL, scratch_pool);
@@ -715,7 +733,8 @@ svn_fs_hotcopy3(const char *src_path, const char *dst_path,
     }
 
   SVN_ERR(vtable->hotcopy(src_fs, dst_fs, src_path, dst_path, clean,
-                          incremental, notify_func, notify_baton,
+                          incremental, compare_checksums, thread_count,
+                          notify_func, notify_baton,
                           cancel_func, cancel_baton, common_pool_lock,
                           scratch_pool, common_pool));
   return svn_error_trace(write_fs_type(dst_path, src_fs_type, scratch_pool));
@@ -828,9 +847,9 @@ svn_error_t *
 svn_fs_hotcopy_berkeley(const char *src_path, const char *dest_path,
                         svn_boolean_t clean_logs, apr_pool_t *pool)
 {
-  return svn_error_trace(svn_fs_hotcopy3(src_path, dest_path, clean_logs,
-                                         FALSE, NULL, NULL, NULL, NULL,
-                                         pool));
+  return svn_error_trace(svn_fs_hotcopy4(src_path, dest_path, clean_logs,
+                                         FALSE, FALSE, 1, NULL, NULL,
+                                         NULL, NULL, pool));
 }
 
 svn_error_t *
@@ -1740,6 +1759,110 @@ svn_fs_get_file_delta_stream(svn_txdelta_stream_t **stream_p,
                            target_root, target_path, pool));
 }
 
+svn_error_t *
+svn_fs__try_get_stored_delta(svn_stream_t **stream_p,
+                             svn_filesize_t *len_p,
+                             svn_fs_root_t *source_root,
+                             const char *source_path,
+                             svn_fs_root_t *target_root,
+                             const char *target_path,
+                             int max_svndiff_version,
+                             apr_pool_t *result_pool,
+                             apr_pool_t *scratch_pool)
+{
+  /* The backend may not store any deltas or may not be able to tell. */
+  if (target_root->vtable->try_get_stored_delta == NULL
+      || (source_root && source_root->fs != target_root->fs))
+    {
+      *stream_p = NULL;
+      return SVN_NO_ERROR;
+    }
+
+  return svn_error_trace(target_root->vtable->try_get_stored_delta(
+                           stream_p, len_p,
+                           source_root, source_path,
+                           target_root, target_path,
+                           max_svndiff_version,
+                           result_pool, scratch_pool));
+}
+
+svn_error_t *
+svn_fs__try_get_deleted_rev(svn_boolean_t *available,
+                            svn_revnum_t *deleted,
+                            svn_fs_t *fs,
+                            const char *path,
+                            svn_revnum_t start,
+                            svn_revnum_t end,
+                            apr_pool_t *scratch_pool)
+{
+  /* Only backends with some sort of change index can answer this. */
+  if (fs->vtable->try_get_deleted_rev == NULL)
+    {
+      *available = FALSE;
+      return SVN_NO_ERROR;
+    }
+
+  return svn_error_trace(fs->vtable->try_get_deleted_rev(
+                           available, deleted, fs,
+                           svn_fs__canonicalize_abspath(path, scratch_pool),
+                           start, end, scratch_pool));
+}
+
+svn_error_t *
+svn_fs__apply_texts(svn_fs_root_t *root,
+                    const apr_array_header_t *texts,
+                    int thread_count,
+                    svn_cancel_func_t cancel_func,
+                    void *cancel_baton,
+                    apr_pool_t *scratch_pool)
+{
+  apr_pool_t *iterpool;
+  int i;
+
+  if (root->vtable->apply_texts)
+    return svn_error_trace(root->vtable->apply_texts(root, texts,
+                                                     thread_count,
+                                                     cancel_func,
+                                                     cancel_baton,
+                                                     scratch_pool));
+
+  /* The backend does not support batched updates.  Apply the texts
+     one-by-one. */
+  iterpool = svn_pool_create(scratch_pool);
+  for (i = 0; i < texts->nelts; i++)
+    {
+      const svn_fs__text_t *text
+        = APR_ARRAY_IDX(texts, i, const svn_fs__text_t *);
+      apr_size_t len = text->contents->len;
+      svn_stream_t *stream;
+
+      svn_pool_clear(iterpool);
+      if (cancel_func)
+        SVN_ERR(cancel_func(cancel_baton));
+
+      SVN_ERR(root->vtable->apply_text(&stream, root, text->path,
+                                       text->result_checksum, iterpool));
+      SVN_ERR(svn_stream_write(stream, text->contents->data, &len));
+      SVN_ERR(svn_stream_close(stream));
+    }
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_fs__set_bulk_mode(svn_boolean_t *supported,
+                      svn_fs_t *fs,
+                      svn_boolean_t bulk,
+                      apr_pool_t *scratch_pool)
+{
+  *supported = fs->vtable->set_bulk_mode != NULL;
+  if (! *supported)
+    return SVN_NO_ERROR;
+
+  return svn_error_trace(fs->vtable->set_bulk_mode(fs, bulk, scratch_pool));
+}
+
 svn_error_t *
 svn_fs__get_deleted_node(svn_fs_root_t **node_root,
                          const char **node_path,
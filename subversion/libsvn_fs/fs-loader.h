@@ -118,6 +118,8 @@ typedef struct fs_library_vtable_t
                           const char *dst_path,
                           svn_boolean_t clean,
                           svn_boolean_t incremental,
+                          svn_boolean_t compare_checksums,
+                          int thread_count,
                           svn_fs_hotcopy_notify_t notify_func,
                           void *notify_baton,
                           svn_cancel_func_t cancel_func,
@@ -267,6 +269,16 @@ typedef struct fs_vtable_t
                         void *cancel_baton,
                         apr_pool_t *result_pool,
                         apr_pool_t *scratch_pool);
+  svn_error_t *(*try_get_deleted_rev)(svn_boolean_t *available,
+                                      svn_revnum_t *deleted,
+                                      svn_fs_t *fs,
+                                      const char *path,
+                                      svn_revnum_t start,
+                                      svn_revnum_t end,
+                                      apr_pool_t *scratch_pool);
+  svn_error_t *(*set_bulk_mode)(svn_fs_t *fs,
+                                svn_boolean_t bulk,
+                                apr_pool_t *scratch_pool);
 } fs_vtable_t;
 
 
@@ -409,6 +421,21 @@ typedef struct root_vtable_t
                                         svn_fs_root_t *target_root,
                                         const char *target_path,
                                         apr_pool_t *pool);
+  svn_error_t *(*try_get_stored_delta)(svn_stream_t **stream_p,
+                                      svn_filesize_t *len_p,
+                                      svn_fs_root_t *source_root,
+                                      const char *source_path,
+                                      svn_fs_root_t *target_root,
+                                      const char *target_path,
+                                      int max_svndiff_version,
+                                      apr_pool_t *result_pool,
+                                      apr_pool_t *scratch_pool);
+  svn_error_t *(*apply_texts)(svn_fs_root_t *root,
+                              const apr_array_header_t *texts,
+                              int thread_count,
+                              svn_cancel_func_t cancel_func,
+                              void *cancel_baton,
+                              apr_pool_t *scratch_pool);
 
   /* Merging. */
   svn_error_t *(*merge)(const char **conflict_p,
@@ -575,7 +575,9 @@ static fs_vtable_t fs_vtable = {
   base_bdb_verify_root,
   base_bdb_freeze,
   base_bdb_set_errcall,
-  NULL /* ioctl */
+  NULL /* ioctl */,
+  NULL /* try_get_deleted_rev */,
+  NULL /* set_bulk_mode */
 };
 
 /* Where the format number is stored. */
@@ -1303,6 +1305,8 @@ base_hotcopy(svn_fs_t *src_fs,
              const char *dest_path,
              svn_boolean_t clean_logs,
              svn_boolean_t incremental,
+             svn_boolean_t compare_checksums,
+             int thread_count,
              svn_fs_hotcopy_notify_t notify_func,
              void *notify_baton,
              svn_cancel_func_t cancel_func,
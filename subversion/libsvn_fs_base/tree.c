@@ -5541,6 +5541,8 @@ static root_vtable_t root_vtable = {
   base_apply_text,
   base_contents_changed,
   base_get_file_delta_stream,
+  NULL,
+  NULL,
   base_merge,
   base_get_mergeinfo,
 };
@@ -533,6 +533,64 @@ svn_fs_fs__get_node_revision(node_revision_t **noderev_p,
   return svn_error_trace(err);
 }
 
+svn_error_t *
+svn_fs_fs__get_node_revisions(node_revision_t **noderevs,
+                              svn_fs_t *fs,
+                              const apr_array_header_t *ids,
+                              apr_pool_t *result_pool,
+                              apr_pool_t *scratch_pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+  apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+  svn_boolean_t *found = apr_pcalloc(scratch_pool,
+                                     ids->nelts * sizeof(*found));
+  int i;
+
+  /* Fetch all cached noderevs in one go.  Transaction noderevs are never
+     cached, so we pass NULL keys for them. */
+  if (ffd->node_revision_cache)
+    {
+      apr_array_header_t *keys = apr_array_make(scratch_pool, ids->nelts,
+                                                sizeof(pair_cache_key_t *));
+      for (i = 0; i < ids->nelts; ++i)
+        {
+          const svn_fs_id_t *id = APR_ARRAY_IDX(ids, i, const svn_fs_id_t *);
+          pair_cache_key_t *key = NULL;
+
+          if (!svn_fs_fs__id_is_txn(id))
+            {
+              const svn_fs_fs__id_part_t *rev_item
+                = svn_fs_fs__id_rev_item(id);
+
+              key = apr_pcalloc(scratch_pool, sizeof(*key));
+              key->revision = rev_item->revision;
+              key->second = rev_item->number;
+            }
+
+          APR_ARRAY_PUSH(keys, pair_cache_key_t *) = key;
+        }
+
+      SVN_ERR(svn_cache__get_many((void **)noderevs, found,
+                                  ffd->node_revision_cache, keys,
+                                  result_pool));
+    }
+
+  /* Read the rest individually. */
+  for (i = 0; i < ids->nelts; ++i)
+    if (!found[i])
+      {
+        svn_pool_clear(iterpool);
+        SVN_ERR(svn_fs_fs__get_node_revision(&noderevs[i], fs,
+                                             APR_ARRAY_IDX(ids, i,
+                                                         const svn_fs_id_t *),
+                                             result_pool, iterpool));
+      }
+
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
 
 /* Given a revision file REV_FILE, opened to REV in FS, find the Node-ID
    of the header located at OFFSET and store it in *ID_P.  Allocate
@@ -2543,6 +2601,107 @@ svn_fs_fs__get_file_delta_stream(svn_txdelta_stream_t **stream_p,
   return SVN_NO_ERROR;
 }
 
+/* Implements svn_read_fn_t for the raw svndiff streams returned by
+   svn_fs_fs__try_get_stored_delta().  BATON is the rep_state_t. */
+static svn_error_t *
+read_stored_delta(void *baton,
+                  char *buffer,
+                  apr_size_t *len)
+{
+  rep_state_t *rs = baton;
+  apr_off_t remaining = rs->size - rs->current;
+
+  if ((apr_off_t)*len > remaining)
+    *len = (apr_size_t)remaining;
+
+  if (*len)
+    {
+      SVN_ERR(svn_io_file_read_full2(rs->sfile->rfile->file, buffer, *len,
+                                     NULL, NULL, rs->sfile->pool));
+      rs->current += *len;
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_close_fn_t for the raw svndiff streams returned by
+   svn_fs_fs__try_get_stored_delta().  BATON is the rep_state_t. */
+static svn_error_t *
+close_stored_delta(void *baton)
+{
+  rep_state_t *rs = baton;
+
+  if (rs->sfile->rfile)
+    {
+      SVN_ERR(svn_fs_fs__close_revision_file(rs->sfile->rfile));
+      rs->sfile->rfile = NULL;
+    }
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_fs_fs__try_get_stored_delta(svn_stream_t **stream_p,
+                                svn_filesize_t *len_p,
+                                svn_fs_t *fs,
+                                node_revision_t *source,
+                                node_revision_t *target,
+                                int max_svndiff_version,
+                                apr_pool_t *result_pool,
+                                apr_pool_t *scratch_pool)
+{
+  rep_state_t *rs;
+  svn_fs_fs__rep_header_t *rep_header;
+  representation_t *base_rep = source ? source->data_rep : NULL;
+  svn_boolean_t usable;
+
+  *stream_p = NULL;
+
+  /* Only committed reps have their final on-disk form. */
+  if (   !target->data_rep
+      || svn_fs_fs__id_txn_used(&target->data_rep->txn_id)
+      || (base_rep && svn_fs_fs__id_txn_used(&base_rep->txn_id)))
+    return SVN_NO_ERROR;
+
+  SVN_ERR(create_rep_state(&rs, &rep_header, NULL, target->data_rep, fs,
+                           result_pool, scratch_pool));
+
+  /* The stored delta must be against the requested base.  Files without
+     a data rep are empty, i.e. a self-delta is what we need for them. */
+  if (base_rep)
+    usable = rep_header->type == svn_fs_fs__rep_delta
+          && rep_header->base_revision == base_rep->revision
+          && rep_header->base_item_index == base_rep->item_index;
+  else
+    usable = rep_header->type == svn_fs_fs__rep_self_delta;
+
+  if (usable)
+    {
+      SVN_ERR(auto_open_shared_file(rs->sfile));
+      SVN_ERR(auto_set_start_offset(rs, scratch_pool));
+      SVN_ERR(auto_read_diff_version(rs, scratch_pool));
+      usable = rs->ver <= max_svndiff_version;
+    }
+
+  if (!usable)
+    {
+      /* Don't keep file handles open for longer than necessary. */
+      return svn_error_trace(close_stored_delta(rs));
+    }
+
+  /* Stream the data from the start, including the "SVNx" marker. */
+  rs->current = 0;
+  SVN_ERR(rs_aligned_seek(rs, NULL, rs->start, scratch_pool));
+
+  *len_p = rs->size;
+  *stream_p = svn_stream_create(rs, result_pool);
+  svn_stream_set_read2(*stream_p, NULL /* only full read support */,
+                       read_stored_delta);
+  svn_stream_set_close(*stream_p, close_stored_delta);
+
+  return SVN_NO_ERROR;
+}
+
 /* Return TRUE when all svn_fs_dirent_t* in ENTRIES are already sorted
    by their respective name. */
 static svn_boolean_t
@@ -3510,17 +3669,37 @@ read_item(svn_stream_t **stream,
   apr_uint32_t digest;
   svn_checksum_t *expected, *actual;
   apr_uint32_t plain_digest;
+  const char *mapped;
+
+  /* If the file has been mapped into memory, parse the item straight
+   * from the mapped pages instead of copying it first. */
+  SVN_ERR(svn_fs_fs__get_mapped_data(&mapped, rev_file, entry->offset,
+                                     entry->size));
+  if (mapped)
+    {
+      fs_fs_data_t *ffd = fs->fsap_data;
+      svn_string_t *text = apr_palloc(pool, sizeof(*text));
 
-  /* Read item into string buffer. */
-  svn_stringbuf_t *text = svn_stringbuf_create_ensure(entry->size, pool);
-  text->len = entry->size;
-  text->data[text->len] = 0;
-  SVN_ERR(svn_io_file_read_full2(rev_file->file, text->data, text->len,
-                                 NULL, NULL, pool));
+      ++ffd->mapped_item_count;
+      text->data = mapped;
+      text->len = (apr_size_t)entry->size;
 
-  /* Return (construct, calculate) stream and checksum. */
-  *stream = svn_stream_from_stringbuf(text, pool);
-  digest = svn__fnv1a_32x4(text->data, text->len);
+      *stream = svn_stream_from_string(text, pool);
+      digest = svn__fnv1a_32x4(text->data, text->len);
+    }
+  else
+    {
+      /* Read item into string buffer. */
+      svn_stringbuf_t *text = svn_stringbuf_create_ensure(entry->size, pool);
+      text->len = entry->size;
+      text->data[text->len] = 0;
+      SVN_ERR(svn_io_file_read_full2(rev_file->file, text->data, text->len,
+                                     NULL, NULL, pool));
+
+      /* Return (construct, calculate) stream and checksum. */
+      *stream = svn_stream_from_stringbuf(text, pool);
+      digest = svn__fnv1a_32x4(text->data, text->len);
+    }
 
   /* Checksums will match most of the time. */
   if (entry->fnv1_checksum == digest)
@@ -3658,6 +3837,110 @@ block_read_noderev(node_revision_t **noderev_p,
   return SVN_NO_ERROR;
 }
 
+/* Ask the OS to prefetch the section [START, END) of REVISION_FILE, which
+ * contains REVISION in FS.  END gets clipped to the end of the revision
+ * data, i.e. we never prefetch index data.
+ *
+ * If SEQUENTIAL is set, the section continues the current read-ahead
+ * window of REVISION_FILE, which gets moved accordingly.  The hint will
+ * be skipped if the section has already been covered to a large extent
+ * by the previous one.  Otherwise, this is a one-off hint that leaves the
+ * window alone and will be skipped if the section lies within it.
+ *
+ * Use SCRATCH_POOL for temporary allocations.
+ */
+static svn_error_t *
+read_ahead(svn_fs_t *fs,
+           svn_fs_fs__revision_file_t *revision_file,
+           svn_revnum_t revision,
+           apr_off_t start,
+           apr_off_t end,
+           svn_boolean_t sequential,
+           apr_pool_t *scratch_pool)
+{
+  apr_off_t max_offset;
+
+  /* Sequential reads would otherwise re-issue almost the same hint for
+   * every block.  Only extend the prefetched section once we got past
+   * its middle. */
+  if (   sequential
+      && start >= revision_file->readahead_start
+      && end <= revision_file->readahead_end
+                + (revision_file->readahead_end
+                   - revision_file->readahead_start) / 2)
+    return SVN_NO_ERROR;
+
+  if (   !sequential
+      && start >= revision_file->readahead_start
+      && end <= revision_file->readahead_end)
+    return SVN_NO_ERROR;
+
+  SVN_ERR(svn_fs_fs__p2l_get_max_offset(&max_offset, fs, revision_file,
+                                        revision, scratch_pool));
+  if (end > max_offset)
+    end = max_offset;
+  if (start >= end)
+    return SVN_NO_ERROR;
+
+  SVN_ERR(svn_io__file_readahead(revision_file->file, start, end - start,
+                                 scratch_pool));
+  if (sequential)
+    {
+      revision_file->readahead_start = start;
+      revision_file->readahead_end = end;
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* NODEREV has just been read from REVISION_FILE in FS, together with the
+ * items listed in the p2l ENTRIES.  If its data representation lives in
+ * the same rev / pack file, it will most likely be requested next.  Ask
+ * the OS to prefetch the block containing it.
+ * Use SCRATCH_POOL for temporary allocations.
+ */
+static svn_error_t *
+read_ahead_noderev_data(svn_fs_t *fs,
+                        svn_fs_fs__revision_file_t *revision_file,
+                        node_revision_t *noderev,
+                        const apr_array_header_t *entries,
+                        apr_pool_t *scratch_pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+  representation_t *rep = noderev->data_rep;
+  apr_off_t offset;
+  int i;
+
+  if (   !rep
+      || svn_fs_fs__id_txn_used(&rep->txn_id)
+      || svn_fs_fs__packed_base_rev(fs, rep->revision)
+           != revision_file->start_revision
+      || svn_fs_fs__is_packed_rev(fs, rep->revision)
+           != revision_file->is_packed)
+    return SVN_NO_ERROR;
+
+  /* Packing tends to put the representation right next to its noderev.
+   * In that case, we have just read it and don't need an index lookup to
+   * find out where it is. */
+  for (i = 0; i < entries->nelts; ++i)
+    {
+      const svn_fs_fs__p2l_entry_t *entry
+        = &APR_ARRAY_IDX(entries, i, svn_fs_fs__p2l_entry_t);
+
+      if (   entry->item.number == rep->item_index
+          && entry->item.revision == rep->revision)
+        return SVN_NO_ERROR;
+    }
+
+  SVN_ERR(svn_fs_fs__item_offset(&offset, fs, revision_file, rep->revision,
+                                 NULL, rep->item_index, scratch_pool));
+  offset -= offset % ffd->block_size;
+
+  return svn_error_trace(read_ahead(fs, revision_file, rep->revision,
+                                    offset, offset + ffd->block_size,
+                                    FALSE, scratch_pool));
+}
+
 /* Read the whole (e.g. 64kB) block containing ITEM_INDEX of REVISION in FS
  * and put all data into cache.  If necessary and depending on heuristics,
  * neighboring blocks may also get read.  The data is being read from
@@ -3682,6 +3965,7 @@ block_read(void **result,
   apr_array_header_t *entries;
   int run_count = 0;
   int i;
+  svn_boolean_t result_is_noderev = FALSE;
   apr_pool_t *iterpool;
 
   /* Block read is an optional feature. If the caller does not want anything
@@ -3701,6 +3985,19 @@ block_read(void **result,
 
   offset = wanted_offset;
 
+  /* Packing puts items into the order in which typical tree traversals
+   * will access them.  So, give the OS a chance to fetch the next blocks
+   * in the background while we are busy parsing this one. */
+  if (ffd->block_read_ahead)
+    {
+      block_start = offset - (offset % ffd->block_size);
+      SVN_ERR(read_ahead(fs, revision_file, revision,
+                         block_start + ffd->block_size,
+                         block_start
+                           + (1 + ffd->block_read_ahead) * ffd->block_size,
+                         TRUE, iterpool));
+    }
+
   /* Heuristics:
    *
    * Read this block.  If the last item crosses the block boundary, read
@@ -3784,7 +4081,11 @@ block_read(void **result,
                 }
 
               if (is_result)
-                *result = item;
+                {
+                  *result = item;
+                  result_is_noderev
+                    = entry->type == SVN_FS_FS__ITEM_TYPE_NODEREV;
+                }
 
               /* if we crossed a block boundary, read the remainder of
                * the last block as well */
@@ -3800,6 +4101,12 @@ block_read(void **result,
 
   /* if the caller requested a result, we must have provided one by now */
   assert(!result || *result);
+
+  /* The noderev's contents are usually the next thing to be read. */
+  if (ffd->block_read_ahead && result_is_noderev)
+    SVN_ERR(read_ahead_noderev_data(fs, revision_file, *result, entries,
+                                    iterpool));
+
   svn_pool_destroy(iterpool);
 
   return SVN_NO_ERROR;
@@ -51,6 +51,19 @@ svn_fs_fs__get_node_revision(node_revision_t **noderev_p,
                              apr_pool_t *result_pool,
                              apr_pool_t *scratch_pool);
 
+/* Like svn_fs_fs__get_node_revision but for all IDS (an array of
+   const svn_fs_id_t *).  Set NODEREVS[i] to the node-revision for the
+   i-th element of IDS.  NODEREVS must have IDS->NELTS elements.
+
+   Node-revisions already in the cache will be fetched in a single batch,
+   which is much cheaper than individual lookups with e.g. memcached. */
+svn_error_t *
+svn_fs_fs__get_node_revisions(node_revision_t **noderevs,
+                              svn_fs_t *fs,
+                              const apr_array_header_t *ids,
+                              apr_pool_t *result_pool,
+                              apr_pool_t *scratch_pool);
+
 /* Set *ROOT_ID to the node-id for the root of revision REV in
    filesystem FS.  Do any allocations in POOL. */
 svn_error_t *
@@ -129,6 +142,25 @@ svn_fs_fs__get_file_delta_stream(svn_txdelta_stream_t **stream_p,
                                  node_revision_t *target,
                                  apr_pool_t *pool);
 
+/* If the text of TARGET is stored in FS as a delta against the text of
+   SOURCE, set *STREAM_P to a stream that reads the raw svndiff data of
+   that delta as found on disk and *LEN_P to its length.  If SOURCE is
+   NULL or has no text, the delta must be a self-delta.  Don't use deltas
+   with an svndiff version higher than MAX_SVNDIFF_VERSION.  Otherwise,
+   set *STREAM_P to NULL.
+
+   Allocate the stream in RESULT_POOL and use SCRATCH_POOL for temporary
+   allocations. */
+svn_error_t *
+svn_fs_fs__try_get_stored_delta(svn_stream_t **stream_p,
+                                svn_filesize_t *len_p,
+                                svn_fs_t *fs,
+                                node_revision_t *source,
+                                node_revision_t *target,
+                                int max_svndiff_version,
+                                apr_pool_t *result_pool,
+                                apr_pool_t *scratch_pool);
+
 /* Set *ENTRIES to an apr_array_header_t of dirent structs that contain
    the directory entries of node-revision NODEREV in filesystem FS.  The
    returned table is allocated in RESULT_POOL and entries are sorted
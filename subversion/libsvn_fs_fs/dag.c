@@ -181,6 +181,21 @@ svn_boolean_t svn_fs_fs__dag_check_mutable(const dag_node_t *node)
 }
 
 
+/* Initialize the KIND, CREATED_PATH and FRESH_ROOT_PREDECESSOR_ID
+   attributes of NODE from its node-revision NODEREV.  */
+static void
+init_node_attributes(dag_node_t *node,
+                     node_revision_t *noderev)
+{
+  node->kind = noderev->kind;
+  node->created_path = apr_pstrdup(node->node_pool, noderev->created_path);
+
+  if (noderev->is_fresh_txn_root)
+    node->fresh_root_predecessor_id = noderev->predecessor_id;
+  else
+    node->fresh_root_predecessor_id = NULL;
+}
+
 svn_error_t *
 svn_fs_fs__dag_get_node(dag_node_t **node,
                         svn_fs_t *fs,
@@ -198,21 +213,53 @@ svn_fs_fs__dag_get_node(dag_node_t **node,
   /* Grab the contents so we can inspect the node's kind and created path. */
   new_node->node_pool = pool;
   SVN_ERR(get_node_revision(&noderev, new_node));
-
-  /* Initialize the KIND and CREATED_PATH attributes */
-  new_node->kind = noderev->kind;
-  new_node->created_path = apr_pstrdup(pool, noderev->created_path);
-
-  if (noderev->is_fresh_txn_root)
-    new_node->fresh_root_predecessor_id = noderev->predecessor_id;
-  else
-    new_node->fresh_root_predecessor_id = NULL;
+  init_node_attributes(new_node, noderev);
 
   /* Return a fresh new node */
   *node = new_node;
   return SVN_NO_ERROR;
 }
 
+svn_error_t *
+svn_fs_fs__dag_get_nodes(apr_array_header_t **nodes,
+                         svn_fs_t *fs,
+                         const apr_array_header_t *ids,
+                         apr_pool_t *pool)
+{
+  apr_pool_t *scratch_pool = svn_pool_create(pool);
+  node_revision_t **noderevs = apr_pcalloc(scratch_pool,
+                                           ids->nelts * sizeof(*noderevs));
+  svn_error_t *err;
+  int i;
+
+  err = svn_fs_fs__get_node_revisions(noderevs, fs, ids, pool,
+                                      scratch_pool);
+  if (err)
+    {
+      svn_pool_destroy(scratch_pool);
+      return svn_error_trace(err);
+    }
+
+  *nodes = apr_array_make(pool, ids->nelts, sizeof(dag_node_t *));
+  for (i = 0; i < ids->nelts; ++i)
+    {
+      const svn_fs_id_t *id = APR_ARRAY_IDX(ids, i, const svn_fs_id_t *);
+      dag_node_t *new_node = apr_pcalloc(pool, sizeof(*new_node));
+
+      new_node->fs = fs;
+      new_node->id = svn_fs_fs__id_copy(id, pool);
+      new_node->node_pool = pool;
+      new_node->node_revision = noderevs[i];
+      init_node_attributes(new_node, noderevs[i]);
+
+      APR_ARRAY_PUSH(*nodes, dag_node_t *) = new_node;
+    }
+
+  svn_pool_destroy(scratch_pool);
+
+  return SVN_NO_ERROR;
+}
+
 
 svn_error_t *
 svn_fs_fs__dag_get_revision(svn_revnum_t *rev,
@@ -1002,6 +1049,41 @@ svn_fs_fs__dag_get_file_delta_stream(svn_txdelta_stream_t **stream_p,
 }
 
 
+svn_error_t *
+svn_fs_fs__dag_try_get_stored_delta(svn_stream_t **stream_p,
+                                    svn_filesize_t *len_p,
+                                    dag_node_t *source,
+                                    dag_node_t *target,
+                                    int max_svndiff_version,
+                                    apr_pool_t *result_pool,
+                                    apr_pool_t *scratch_pool)
+{
+  node_revision_t *src_noderev;
+  node_revision_t *tgt_noderev;
+
+  /* Make sure our nodes are files. */
+  if ((source && source->kind != svn_node_file)
+      || target->kind != svn_node_file)
+    return svn_error_createf
+      (SVN_ERR_FS_NOT_FILE, NULL,
+       "Attempted to get textual contents of a *non*-file node");
+
+  if (source)
+    SVN_ERR(get_node_revision(&src_noderev, source));
+  else
+    src_noderev = NULL;
+  SVN_ERR(get_node_revision(&tgt_noderev, target));
+
+  return svn_error_trace(svn_fs_fs__try_get_stored_delta(stream_p, len_p,
+                                                         target->fs,
+                                                         src_noderev,
+                                                         tgt_noderev,
+                                                         max_svndiff_version,
+                                                         result_pool,
+                                                         scratch_pool));
+}
+
+
 svn_error_t *
 svn_fs_fs__dag_try_process_file_contents(svn_boolean_t *success,
                                          dag_node_t *node,
@@ -1091,6 +1173,49 @@ svn_fs_fs__dag_get_edit_stream(svn_stream_t **contents,
 
 
 
+svn_error_t *
+svn_fs_fs__dag_set_contents_many(const apr_array_header_t *files,
+                                 const apr_array_header_t *contents,
+                                 apr_int32_t thread_count,
+                                 svn_cancel_func_t cancel_func,
+                                 void *cancel_baton,
+                                 apr_pool_t *pool)
+{
+  apr_array_header_t *noderevs;
+  int i;
+
+  if (files->nelts == 0)
+    return SVN_NO_ERROR;
+
+  noderevs = apr_array_make(pool, files->nelts, sizeof(node_revision_t *));
+  for (i = 0; i < files->nelts; ++i)
+    {
+      dag_node_t *file = APR_ARRAY_IDX(files, i, dag_node_t *);
+      node_revision_t *noderev;
+
+      /* Same checks as in svn_fs_fs__dag_get_edit_stream. */
+      if (file->kind != svn_node_file)
+        return svn_error_createf
+          (SVN_ERR_FS_NOT_FILE, NULL,
+           "Attempted to set textual contents of a *non*-file node");
+
+      if (! svn_fs_fs__dag_check_mutable(file))
+        return svn_error_createf
+          (SVN_ERR_FS_NOT_MUTABLE, NULL,
+           "Attempted to set textual contents of an immutable node");
+
+      SVN_ERR(get_node_revision(&noderev, file));
+      APR_ARRAY_PUSH(noderevs, node_revision_t *) = noderev;
+    }
+
+  return svn_error_trace(
+           svn_fs_fs__set_contents_many(APR_ARRAY_IDX(files, 0,
+                                                      dag_node_t *)->fs,
+                                        noderevs, contents, thread_count,
+                                        cancel_func, cancel_baton, pool));
+}
+
+
 svn_error_t *
 svn_fs_fs__dag_finalize_edits(dag_node_t *file,
                               const svn_checksum_t *checksum,
@@ -71,6 +71,16 @@ svn_fs_fs__dag_get_node(dag_node_t **node,
                         const svn_fs_id_t *id,
                         apr_pool_t *pool);
 
+/* Like svn_fs_fs__dag_get_node but for all IDS (an array of
+   const svn_fs_id_t *), e.g. the entries of a directory.  Set *NODES to
+   an array of the respective dag_node_t *, allocated in POOL.  Cached
+   node-revisions will be fetched in a single batch. */
+svn_error_t *
+svn_fs_fs__dag_get_nodes(apr_array_header_t **nodes,
+                         svn_fs_t *fs,
+                         const apr_array_header_t *ids,
+                         apr_pool_t *pool);
+
 
 /* Return a new dag_node_t object referring to the same node as NODE,
    allocated in POOL.  If you're trying to build a structure in a
@@ -439,6 +449,24 @@ svn_fs_fs__dag_get_file_delta_stream(svn_txdelta_stream_t **stream_p,
                                      dag_node_t *target,
                                      apr_pool_t *pool);
 
+/* If the contents of TARGET are stored as a delta against those of
+   SOURCE (or the empty string, if SOURCE is null), return the raw svndiff
+   data of that delta in *STREAM_P and its length in *LEN_P.  Otherwise,
+   set *STREAM_P to NULL.  See svn_fs_fs__try_get_stored_delta() for
+   MAX_SVNDIFF_VERSION.
+
+   Allocate the result in RESULT_POOL and use SCRATCH_POOL for temporary
+   allocations.
+ */
+svn_error_t *
+svn_fs_fs__dag_try_get_stored_delta(svn_stream_t **stream_p,
+                                    svn_filesize_t *len_p,
+                                    dag_node_t *source,
+                                    dag_node_t *target,
+                                    int max_svndiff_version,
+                                    apr_pool_t *result_pool,
+                                    apr_pool_t *scratch_pool);
+
 /* Return a generic writable stream in *CONTENTS with which to set the
    contents of FILE.  Allocate the stream in POOL.
 
@@ -452,6 +480,22 @@ svn_error_t *svn_fs_fs__dag_get_edit_stream(svn_stream_t **contents,
                                             apr_pool_t *pool);
 
 
+/* Replace the contents of each file node in FILES (an array of
+   dag_node_t *) with the fulltext given by the respective element of
+   CONTENTS (an array of svn_string_t *).  All files must be mutable.
+   Use up to THREAD_COUNT threads to checksum and deltify the new texts;
+   see svn_fs_fs__set_contents_many.
+
+   Use POOL for all allocations.
+ */
+svn_error_t *svn_fs_fs__dag_set_contents_many(const apr_array_header_t *files,
+                                              const apr_array_header_t *contents,
+                                              apr_int32_t thread_count,
+                                              svn_cancel_func_t cancel_func,
+                                              void *cancel_baton,
+                                              apr_pool_t *pool);
+
+
 /* Signify the completion of edits to FILE made using the stream
    returned by svn_fs_fs__dag_get_edit_stream, allocating from POOL.
 
@@ -39,8 +39,11 @@
 #include "lock.h"
 #include "hotcopy.h"
 #include "id.h"
+#include "mergeinfo-index.h"
 #include "pack.h"
+#include "path-index.h"
 #include "recovery.h"
+#include "redeltify.h"
 #include "rep-cache.h"
 #include "revprops.h"
 #include "transaction.h"
@@ -273,6 +276,8 @@ fs_ioctl(svn_fs_t *fs, svn_fs_ioctl_code_t ctlcode,
 
           output = apr_pcalloc(result_pool, sizeof(*output));
           SVN_ERR(svn_fs_fs__get_stats(&output->stats, fs,
+                                       input->cache_path,
+                                       input->thread_count,
                                        input->progress_func,
                                        input->progress_baton,
                                        cancel_func, cancel_baton,
@@ -329,6 +334,68 @@ fs_ioctl(svn_fs_t *fs, svn_fs_ioctl_code_t ctlcode,
           *output_p = NULL;
           return SVN_NO_ERROR;
         }
+      else if (ctlcode.code == SVN_FS_FS__IOCTL_BUILD_REP_CACHE_FILTER.code)
+        {
+          SVN_ERR(svn_fs_fs__build_rep_cache_filter(fs, cancel_func,
+                                                    cancel_baton,
+                                                    scratch_pool));
+
+          *output_p = NULL;
+          return SVN_NO_ERROR;
+        }
+      else if (ctlcode.code == SVN_FS_FS__IOCTL_BUILD_PATH_INDEX.code)
+        {
+          svn_fs_fs__ioctl_build_path_index_input_t *input = input_void;
+
+          SVN_ERR(svn_fs_fs__build_path_index(fs,
+                                              input->progress_func,
+                                              input->progress_baton,
+                                              cancel_func, cancel_baton,
+                                              scratch_pool));
+
+          *output_p = NULL;
+          return SVN_NO_ERROR;
+        }
+      else if (ctlcode.code == SVN_FS_FS__IOCTL_REDELTIFY.code)
+        {
+          svn_fs_fs__ioctl_redeltify_input_t *input = input_void;
+          svn_fs_fs__ioctl_redeltify_output_t *output
+            = apr_pcalloc(result_pool, sizeof(*output));
+
+          SVN_ERR(svn_fs_fs__redeltify(fs, input->start_rev, input->end_rev,
+                                       input->max_chain_length,
+                                       &output->rep_count,
+                                       &output->noderev_count,
+                                       input->progress_func,
+                                       input->progress_baton,
+                                       cancel_func, cancel_baton,
+                                       scratch_pool));
+          *output_p = output;
+          return SVN_NO_ERROR;
+        }
+      else if (ctlcode.code == SVN_FS_FS__IOCTL_BUILD_MERGEINFO_INDEX.code)
+        {
+          svn_fs_fs__ioctl_build_mergeinfo_index_input_t *input = input_void;
+
+          SVN_ERR(svn_fs_fs__build_mergeinfo_index(fs,
+                                                   input->progress_func,
+                                                   input->progress_baton,
+                                                   cancel_func, cancel_baton,
+                                                   scratch_pool));
+
+          *output_p = NULL;
+          return SVN_NO_ERROR;
+        }
+      else if (ctlcode.code == SVN_FS_FS__IOCTL_GET_MMAP_STATS.code)
+        {
+          fs_fs_data_t *ffd = fs->fsap_data;
+          svn_fs_fs__ioctl_get_mmap_stats_output_t *output
+            = apr_pcalloc(result_pool, sizeof(*output));
+
+          output->mapped_item_count = ffd->mapped_item_count;
+          *output_p = output;
+          return SVN_NO_ERROR;
+        }
     }
 
   return svn_error_create(SVN_ERR_FS_UNRECOGNIZED_IOCTL_CODE, NULL, NULL);
@@ -359,7 +426,9 @@ static fs_vtable_t fs_vtable = {
   svn_fs_fs__verify_root,
   fs_freeze,
   fs_set_errcall,
-  fs_ioctl
+  fs_ioctl,
+  svn_fs_fs__path_index_deleted_rev,
+  svn_fs_fs__set_bulk_mode
 };
 
 
@@ -373,6 +442,7 @@ initialize_fs_struct(svn_fs_t *fs)
   ffd->use_log_addressing = FALSE;
   ffd->revprop_prefix = 0;
   ffd->flush_to_disk = TRUE;
+  ffd->bulk_start_rev = SVN_INVALID_REVNUM;
 
   fs->vtable = &fs_vtable;
   fs->fsap_data = ffd;
@@ -565,7 +635,8 @@ fs_pack(svn_fs_t *fs,
 /* This implements the fs_library_vtable_t.hotcopy() API.  Copy a
    possibly live Subversion filesystem SRC_FS from SRC_PATH to a
    DST_FS at DEST_PATH. If INCREMENTAL is TRUE, make an effort not to
-   re-copy data which already exists in DST_FS.
+   re-copy data which already exists in DST_FS; see svn_fs_fs__hotcopy()
+   for COMPARE_CHECKSUMS and THREAD_COUNT.
    The CLEAN_LOGS argument is ignored and included for Subversion
    1.0.x compatibility.  Indicate progress via the optional NOTIFY_FUNC
    callback using NOTIFY_BATON.  Perform all temporary allocations in POOL. */
@@ -576,6 +647,8 @@ fs_hotcopy(svn_fs_t *src_fs,
            const char *dst_path,
            svn_boolean_t clean_logs,
            svn_boolean_t incremental,
+           svn_boolean_t compare_checksums,
+           int thread_count,
            svn_fs_hotcopy_notify_t notify_func,
            void *notify_baton,
            svn_cancel_func_t cancel_func,
@@ -594,7 +667,8 @@ fs_hotcopy(svn_fs_t *src_fs,
      can't be opened.
    */
   return svn_fs_fs__hotcopy(src_fs, dst_fs, src_path, dst_path,
-                            incremental, notify_func, notify_baton,
+                            incremental, compare_checksums, thread_count,
+                            notify_func, notify_baton,
                             cancel_func, cancel_baton, common_pool_lock,
                             pool, common_pool);
 }
@@ -111,10 +111,13 @@ extern "C" {
 #define CONFIG_SECTION_PACKED_REVPROPS   "packed-revprops"
 #define CONFIG_OPTION_REVPROP_PACK_SIZE  "revprop-pack-size"
 #define CONFIG_OPTION_COMPRESS_PACKED_REVPROPS  "compress-packed-revprops"
+#define CONFIG_OPTION_ENABLE_REVPROP_INDEX  "enable-revprop-index"
 #define CONFIG_SECTION_IO                "io"
 #define CONFIG_OPTION_BLOCK_SIZE         "block-size"
 #define CONFIG_OPTION_L2P_PAGE_SIZE      "l2p-page-size"
 #define CONFIG_OPTION_P2L_PAGE_SIZE      "p2l-page-size"
+#define CONFIG_OPTION_BLOCK_READ_AHEAD   "block-read-ahead"
+#define CONFIG_OPTION_ENABLE_MMAP        "enable-mmap"
 #define CONFIG_SECTION_DEBUG             "debug"
 #define CONFIG_OPTION_PACK_AFTER_COMMIT  "pack-after-commit"
 #define CONFIG_OPTION_VERIFY_BEFORE_COMMIT "verify-before-commit"
@@ -283,6 +286,12 @@ typedef struct fs_fs_shared_data_t
 /* Data structure for the 1st level DAG node cache. */
 typedef struct fs_fs_dag_cache_t fs_fs_dag_cache_t;
 
+/* In-memory copy of the rep-cache filter. */
+typedef struct rep_cache_filter_t rep_cache_filter_t;
+
+/* Open files of the revprop index. */
+typedef struct revprop_index_t revprop_index_t;
+
 /* Key type for all caches that use revision + offset / counter as key.
 
    Note: Cache keys should be 16 bytes for best performance and there
@@ -347,6 +356,18 @@ typedef struct fs_fs_data_t
    * (not just the one bit that we need, atm). */
   svn_boolean_t use_block_read;
 
+  /* Number of blocks following the current one that block-read shall
+   * ask the OS to prefetch.  0 disables read-ahead hints. */
+  apr_int64_t block_read_ahead;
+
+  /* If set, map committed rev / pack files into memory when opening them
+   * for reading and parse meta data directly from the mapped pages. */
+  svn_boolean_t use_mmap;
+
+  /* Number of items that got parsed straight from mapped rev / pack file
+   * data.  For diagnostics only. */
+  apr_int64_t mapped_item_count;
+
   /* The revision that was youngest, last time we checked. */
   svn_revnum_t youngest_rev_cache;
 
@@ -429,7 +450,8 @@ typedef struct fs_fs_data_t
      if the node has mergeinfo, "0" if it doesn't. */
   svn_cache__t *mergeinfo_existence_cache;
 
-  /* Cache for l2p_header_t objects; the key is (revision, is-packed).
+  /* Cache for l2p_header_t objects; the key is (revision,
+     pack generation).
      Will be NULL for pre-format7 repos */
   svn_cache__t *l2p_header_cache;
 
@@ -437,7 +459,8 @@ typedef struct fs_fs_data_t
      Will be NULL for pre-format7 repos */
   svn_cache__t *l2p_page_cache;
 
-  /* Cache for p2l_header_t objects; the key is (revision, is-packed).
+  /* Cache for p2l_header_t objects; the key is (revision,
+     pack generation).
      Will be NULL for pre-format7 repos */
   svn_cache__t *p2l_header_cache;
 
@@ -465,6 +488,29 @@ typedef struct fs_fs_data_t
   /* Thread-safe boolean */
   svn_atomic_t rep_cache_db_opened;
 
+  /* Bloom filter over the rep-cache.db keys.  NULL until first used. */
+  rep_cache_filter_t *rep_cache_filter;
+
+  /* While rep-cache updates are being deferred, maps the SHA1 digests of
+     committed representations that have not been written to rep-cache.db,
+     yet, to their representation_t *.  NULL otherwise. */
+  apr_hash_t *deferred_reps;
+
+  /* Pool holding DEFERRED_REPS and its contents. */
+  apr_pool_t *deferred_reps_pool;
+
+  /* Youngest revision at the time this instance entered bulk mode, or
+     SVN_INVALID_REVNUM if not in bulk mode.  See svn_fs_fs__set_bulk_mode. */
+  svn_revnum_t bulk_start_rev;
+
+  /* The sqlite database used as per-path change index.  NULL while not
+     opened or if the repository has no such index. */
+  svn_sqlite__db_t *path_index_db;
+
+  /* The sqlite database used as index of paths with mergeinfo.  NULL
+     while not opened or if the repository has no such index. */
+  svn_sqlite__db_t *mergeinfo_index_db;
+
   /* The oldest revision not in a pack file.  It also applies to revprops
    * if revprop packing has been enabled by the FSFS format version. */
   svn_revnum_t min_unpacked_rev;
@@ -480,6 +526,12 @@ typedef struct fs_fs_data_t
   /* Whether packed revprop files shall be compressed. */
   svn_boolean_t compress_packed_revprops;
 
+  /* Whether the revprop index shall be used and be kept up-to-date. */
+  svn_boolean_t use_revprop_index;
+
+  /* The revprop index opened for reading.  NULL until first used. */
+  revprop_index_t *revprop_index;
+
   /* Whether directory nodes shall be deltified just like file nodes. */
   svn_boolean_t deltify_directories;
 
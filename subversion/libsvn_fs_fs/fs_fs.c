@@ -804,11 +804,17 @@ read_config(fs_fs_data_t *ffd,
                                        : 0x10));
 
       ffd->revprop_pack_size *= 1024;
+
+      SVN_ERR(svn_config_get_bool(config, &ffd->use_revprop_index,
+                                  CONFIG_SECTION_PACKED_REVPROPS,
+                                  CONFIG_OPTION_ENABLE_REVPROP_INDEX,
+                                  FALSE));
     }
   else
     {
       ffd->revprop_pack_size = 0x10000;
       ffd->compress_packed_revprops = FALSE;
+      ffd->use_revprop_index = FALSE;
     }
 
   if (ffd->format >= SVN_FS_FS__MIN_LOG_ADDRESSING_FORMAT)
@@ -825,6 +831,14 @@ read_config(fs_fs_data_t *ffd,
                                    CONFIG_SECTION_IO,
                                    CONFIG_OPTION_P2L_PAGE_SIZE,
                                    0x400));
+      SVN_ERR(svn_config_get_int64(config, &ffd->block_read_ahead,
+                                   CONFIG_SECTION_IO,
+                                   CONFIG_OPTION_BLOCK_READ_AHEAD,
+                                   4));
+      SVN_ERR(svn_config_get_bool(config, &ffd->use_mmap,
+                                  CONFIG_SECTION_IO,
+                                  CONFIG_OPTION_ENABLE_MMAP,
+                                  FALSE));
 
       /* Don't accept unreasonable or illegal values.
        * Block size and P2L page size are in kbytes;
@@ -835,6 +849,14 @@ read_config(fs_fs_data_t *ffd,
                                 CONFIG_OPTION_P2L_PAGE_SIZE, scratch_pool));
       SVN_ERR(verify_block_size(ffd->l2p_page_size, sizeof(apr_off_t),
                                 CONFIG_OPTION_L2P_PAGE_SIZE, scratch_pool));
+      if (ffd->block_read_ahead < 0 || ffd->block_read_ahead > 1024)
+        return svn_error_createf(SVN_ERR_BAD_CONFIG_VALUE, NULL,
+                                 _("%s is out of range for fsfs.conf "
+                                   "setting '%s'."),
+                                 apr_psprintf(scratch_pool,
+                                              "%" APR_INT64_T_FMT,
+                                              ffd->block_read_ahead),
+                                 CONFIG_OPTION_BLOCK_READ_AHEAD);
 
       /* convert kBytes to bytes */
       ffd->block_size *= 0x400;
@@ -847,6 +869,8 @@ read_config(fs_fs_data_t *ffd,
       ffd->block_size = 0x1000; /* Matches default APR file buffer size. */
       ffd->l2p_page_size = 0x2000;    /* Matches above default. */
       ffd->p2l_page_size = 0x100000;  /* Matches above default in bytes. */
+      ffd->block_read_ahead = 0;
+      ffd->use_mmap = FALSE;
     }
 
   if (ffd->format >= SVN_FS_FS__MIN_PACKED_FORMAT)
@@ -1101,6 +1125,19 @@ write_config(svn_fs_t *fs,
 "### even more so writing, become significantly more CPU intensive."         NL
 "### Compressing packed revprops is disabled by default."                    NL
 "# " CONFIG_OPTION_COMPRESS_PACKED_REVPROPS " = false"                       NL
+"###"                                                                        NL
+"### The revprop index keeps a copy of the standard revprops (author, date"  NL
+"### and log message) of each revision in a compact, memory-mappable form."  NL
+"### Reading those, e.g. for 'svn log', then takes a single lookup instead"  NL
+"### of reading and parsing (packed) revprop files.  When enabled,"          NL
+"### 'svnadmin pack' creates and completes the index while commits and"      NL
+"### revprop changes keep it up-to-date.  Older versions of Subversion do"   NL
+"### not update the index when changing revprops.  So, if you use them to"   NL
+"### change revprops, delete the 'revprop-index' file afterwards and run"    NL
+"### 'svnadmin pack' to recreate it.  Long-running server processes must"    NL
+"### be restarted to pick up a re-created index."                            NL
+"### The index is disabled by default."                                      NL
+"# " CONFIG_OPTION_ENABLE_REVPROP_INDEX " = false"                           NL
 ""                                                                           NL
 "[" CONFIG_SECTION_IO "]"                                                    NL
 "### Parameters in this section control the data access granularity in"      NL
@@ -1121,6 +1158,26 @@ write_config(svn_fs_t *fs,
 "### block-size is given in kBytes and with a default of 64 kBytes."         NL
 "# " CONFIG_OPTION_BLOCK_SIZE " = 64"                                        NL
 "###"                                                                        NL
+"### Whenever a block gets read from a rev or pack file, the OS may be told" NL
+"### to prefetch the following blocks in the background.  Since packing"     NL
+"### orders the data the way checkouts and updates will read it, this hides" NL
+"### much of the disk latency on cold caches.  The hint is only issued on"   NL
+"### platforms that support it (posix_fadvise) and never beyond the end of"  NL
+"### the revision data.  Set this to 0 to disable read-ahead."               NL
+"### block-read-ahead is given in blocks and defaults to 4."                 NL
+"# " CONFIG_OPTION_BLOCK_READ_AHEAD " = 4"                                   NL
+"###"                                                                        NL
+"### If enabled, the sections of rev and pack files that get read are"      NL
+"### mapped into memory, 64 MB at a time, and node revisions as well as"     NL
+"### changed path lists are parsed directly from the mapped pages."          NL
+"### Frequently read data then resides in"                                   NL
+"### the OS page cache only, instead of being copied into process memory"    NL
+"### for each access.  This is most useful for read-mostly servers with"     NL
+"### plenty of RAM on 64 bit systems.  If a file cannot be mapped, normal"   NL
+"### file access will be used instead.  Memory mapping is disabled by"       NL
+"### default."                                                               NL
+"# " CONFIG_OPTION_ENABLE_MMAP " = false"                                    NL
+"###"                                                                        NL
 "### The log-to-phys index maps data item numbers to offsets within the"     NL
 "### rev or pack file.  This index is organized in pages of a fixed maximum" NL
 "### capacity.  To access an item, the page table and the respective page"   NL
@@ -2495,6 +2552,10 @@ svn_fs_fs__build_rep_cache(svn_fs_t *fs,
   if (!ffd->rep_cache_db)
     SVN_ERR(svn_fs_fs__open_rep_cache(fs, pool));
 
+  /* The filter only learns about reps added by commits.  Drop it, so the
+   * entries that we are about to add can be found. */
+  SVN_ERR(svn_fs_fs__invalidate_rep_cache_filter(fs, pool));
+
   iterpool = svn_pool_create(pool);
   for (rev = start_rev; rev <= end_rev; rev++)
     {
@@ -2522,3 +2583,127 @@ svn_fs_fs__build_rep_cache(svn_fs_t *fs,
 
   return SVN_NO_ERROR;
 }
+
+/* Flush the file or directory at PATH to disk.  Use SCRATCH_POOL for
+ * temporary allocations. */
+static svn_error_t *
+flush_path_to_disk(const char *path,
+                   svn_boolean_t is_dir,
+                   apr_pool_t *scratch_pool)
+{
+  apr_file_t *file;
+
+#ifdef SVN_ON_POSIX
+  /* On POSIX, the file name is stored in the file's directory entry.
+     Hence, we need to fsync() that directory as well, which works with
+     read-only handles. */
+  SVN_ERR(svn_io_file_open(&file, path, APR_READ, APR_OS_DEFAULT,
+                           scratch_pool));
+#else
+  /* Don't try to open and fsync directories on other systems. */
+  if (is_dir)
+    return SVN_NO_ERROR;
+
+  SVN_ERR(svn_io_file_open(&file, path, APR_WRITE, APR_OS_DEFAULT,
+                           scratch_pool));
+#endif
+
+  SVN_ERR(svn_io_file_flush_to_disk(file, scratch_pool));
+  return svn_error_trace(svn_io_file_close(file, scratch_pool));
+}
+
+/* Flush the rev and revprop files of all non-packed revisions from
+ * START_REV up to the youngest revision in FS to disk, followed by the
+ * rep-cache and the 'current' file.  Use SCRATCH_POOL for temporary
+ * allocations. */
+static svn_error_t *
+sync_revisions(svn_fs_t *fs,
+               svn_revnum_t start_rev,
+               apr_pool_t *scratch_pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+  apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+  const char *rev_shard = NULL;
+  const char *revprops_shard = NULL;
+  svn_revnum_t youngest;
+  svn_revnum_t rev;
+  svn_node_kind_t kind;
+
+  SVN_ERR(svn_fs_fs__youngest_rev(&youngest, fs, scratch_pool));
+
+  /* Packed shards have been written by svn_fs_pack(), which flushes
+     them as configured. */
+  if (ffd->format >= SVN_FS_FS__MIN_PACKED_FORMAT)
+    {
+      SVN_ERR(svn_fs_fs__update_min_unpacked_rev(fs, scratch_pool));
+      start_rev = MAX(start_rev, ffd->min_unpacked_rev);
+    }
+
+  for (rev = start_rev; rev <= youngest; ++rev)
+    {
+      const char *path;
+
+      svn_pool_clear(iterpool);
+
+      path = svn_fs_fs__path_rev(fs, rev, iterpool);
+      SVN_ERR(flush_path_to_disk(path, FALSE, iterpool));
+      path = svn_dirent_dirname(path, iterpool);
+      if (!rev_shard || strcmp(path, rev_shard))
+        {
+          SVN_ERR(flush_path_to_disk(path, TRUE, iterpool));
+          rev_shard = apr_pstrdup(scratch_pool, path);
+        }
+
+      path = svn_fs_fs__path_revprops(fs, rev, iterpool);
+      SVN_ERR(flush_path_to_disk(path, FALSE, iterpool));
+      path = svn_dirent_dirname(path, iterpool);
+      if (!revprops_shard || strcmp(path, revprops_shard))
+        {
+          SVN_ERR(flush_path_to_disk(path, TRUE, iterpool));
+          revprops_shard = apr_pstrdup(scratch_pool, path);
+        }
+    }
+
+  svn_pool_destroy(iterpool);
+
+  if (ffd->format >= SVN_FS_FS__MIN_REP_SHARING_FORMAT)
+    {
+      const char *path = svn_dirent_join(fs->path, REP_CACHE_DB_NAME,
+                                         scratch_pool);
+
+      SVN_ERR(svn_io_check_path(path, &kind, scratch_pool));
+      if (kind == svn_node_file)
+        SVN_ERR(flush_path_to_disk(path, FALSE, scratch_pool));
+    }
+
+  SVN_ERR(flush_path_to_disk(svn_fs_fs__path_current(fs, scratch_pool),
+                             FALSE, scratch_pool));
+  SVN_ERR(flush_path_to_disk(fs->path, TRUE, scratch_pool));
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_fs_fs__set_bulk_mode(svn_fs_t *fs,
+                         svn_boolean_t bulk,
+                         apr_pool_t *scratch_pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+
+  if (bulk && !SVN_IS_VALID_REVNUM(ffd->bulk_start_rev))
+    {
+      SVN_ERR(svn_fs_fs__youngest_rev(&ffd->bulk_start_rev, fs,
+                                      scratch_pool));
+      SVN_ERR(svn_fs_fs__defer_rep_cache(fs, TRUE, scratch_pool));
+    }
+  else if (!bulk && SVN_IS_VALID_REVNUM(ffd->bulk_start_rev))
+    {
+      svn_revnum_t start_rev = ffd->bulk_start_rev + 1;
+
+      ffd->bulk_start_rev = SVN_INVALID_REVNUM;
+      SVN_ERR(svn_fs_fs__defer_rep_cache(fs, FALSE, scratch_pool));
+      SVN_ERR(sync_revisions(fs, start_rev, scratch_pool));
+    }
+
+  return SVN_NO_ERROR;
+}
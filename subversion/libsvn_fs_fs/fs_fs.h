@@ -307,11 +307,19 @@ svn_fs_fs__reset_txn_caches(svn_fs_t *fs);
 /* Scan all contents of the repository FS and return statistics in *STATS,
  * allocated in RESULT_POOL.  Report progress through PROGRESS_FUNC with
  * PROGRESS_BATON, if PROGRESS_FUNC is not NULL.
+ *
+ * If CACHE_PATH is not NULL, reuse the per-pack file results stored in
+ * that file by previous runs for all pack files that did not change and
+ * update the file afterwards.  Read up to THREAD_COUNT rev / pack files
+ * in parallel.
+ *
  * Use SCRATCH_POOL for temporary allocations.
  */
 svn_error_t *
 svn_fs_fs__get_stats(svn_fs_fs__stats_t **stats,
                      svn_fs_t *fs,
+                     const char *cache_path,
+                     int thread_count,
                      svn_fs_progress_notify_func_t progress_func,
                      void *progress_baton,
                      svn_cancel_func_t cancel_func,
@@ -356,6 +364,18 @@ svn_fs_fs__revision_size(apr_off_t *rev_size,
                          svn_revnum_t revision,
                          apr_pool_t *scratch_pool);
 
+/* If BULK is set, start deferring rep-cache updates in this instance of
+ * FS.  Otherwise, write all deferred rep-cache entries and flush all data
+ * committed since bulk mode was entered to disk.  The latter is necessary
+ * because bulk loads are usually run with SVN_FS_CONFIG_NO_FLUSH_TO_DISK.
+ * Use SCRATCH_POOL for temporary allocations.  Implements the
+ * set_bulk_mode FS vtable function.
+ */
+svn_error_t *
+svn_fs_fs__set_bulk_mode(svn_fs_t *fs,
+                         svn_boolean_t bulk,
+                         apr_pool_t *scratch_pool);
+
 /* Add missing entries to the rep-cache on the filesystem FS. Process data
  * in revisions START_REV through END_REV inclusive. If START_REV is
  * SVN_INVALID_REVNUM, start at revision 1; if END_REV is SVN_INVALID_REVNUM,
@@ -25,11 +25,16 @@
 
 #include "fs_fs.h"
 #include "hotcopy.h"
+#include "low_level.h"
 #include "util.h"
+#include "mergeinfo-index.h"
+#include "path-index.h"
 #include "recovery.h"
 #include "revprops.h"
+#include "revprop-index.h"
 #include "rep-cache.h"
 
+#include "private/svn_task.h"
 #include "../libsvn_fs/fs-loader.h"
 
 #include "svn_private_config.h"
@@ -277,21 +282,130 @@ hotcopy_copy_shard_file(svn_boolean_t *skipped_p,
 }
 
 
+/* Set *FOOTER_P to the footer of the format 7+ pack file at PATH, which
+ * is FILESIZE bytes long, including the trailing length byte.  Set it to
+ * NULL if the file does not end with a valid footer.  The first revision
+ * in the pack file, REV, is only used for error messages.
+ * Allocate *FOOTER_P in RESULT_POOL and use SCRATCH_POOL for temporaries. */
+static svn_error_t *
+read_pack_footer(svn_stringbuf_t **footer_p,
+                 const char *path,
+                 svn_filesize_t filesize,
+                 svn_revnum_t rev,
+                 apr_pool_t *result_pool,
+                 apr_pool_t *scratch_pool)
+{
+  apr_file_t *file;
+  apr_off_t offset;
+  unsigned char footer_length;
+  svn_stringbuf_t *footer;
+  apr_off_t l2p_offset, p2l_offset;
+  svn_checksum_t *l2p_checksum, *p2l_checksum;
+  svn_error_t *err;
+
+  *footer_p = NULL;
+  if (filesize < 2)
+    return SVN_NO_ERROR;
+
+  SVN_ERR(svn_io_file_open(&file, path, APR_READ, APR_OS_DEFAULT,
+                           scratch_pool));
+
+  /* Read last byte (containing the length of the footer). */
+  offset = filesize - 1;
+  SVN_ERR(svn_io_file_seek(file, APR_SET, &offset, scratch_pool));
+  SVN_ERR(svn_io_file_read_full2(file, &footer_length,
+                                 sizeof(footer_length), NULL, NULL,
+                                 scratch_pool));
+  if (footer_length + 1 >= filesize)
+    return svn_error_trace(svn_io_file_close(file, scratch_pool));
+
+  /* Read footer. */
+  footer = svn_stringbuf_create_ensure(footer_length, result_pool);
+  offset = filesize - 1 - footer_length;
+  SVN_ERR(svn_io_file_seek(file, APR_SET, &offset, scratch_pool));
+  SVN_ERR(svn_io_file_read_full2(file, footer->data, footer_length,
+                                 &footer->len, NULL, scratch_pool));
+  footer->data[footer->len] = '\0';
+  SVN_ERR(svn_io_file_close(file, scratch_pool));
+
+  /* Only accept what the FS would accept as well.  Parsing is destructive,
+   * so do that on a copy. */
+  err = svn_fs_fs__parse_footer(&l2p_offset, &l2p_checksum,
+                                &p2l_offset, &p2l_checksum,
+                                svn_stringbuf_dup(footer, scratch_pool),
+                                rev, offset, scratch_pool);
+  if (err)
+    svn_error_clear(err);
+  else
+    *footer_p = footer;
+
+  return SVN_NO_ERROR;
+}
+
+/* Set *MATCH_P to TRUE if the logically addressed pack files at SRC_PATH
+ * and DST_PATH have the same size and the same valid footer, and to FALSE
+ * otherwise.  The footer contains the MD5 checksums of the L2P and P2L
+ * index data, which in turn record offset, size and FNV-1a checksum of
+ * every item in the pack file.  Matching footers thus mean that both files
+ * contain the same data, independently of the files' timestamps.
+ *
+ * The first revision in the pack files, REV, is only used for error
+ * messages.  Use SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+pack_footers_match(svn_boolean_t *match_p,
+                   const char *src_path,
+                   const char *dst_path,
+                   svn_revnum_t rev,
+                   apr_pool_t *scratch_pool)
+{
+  const svn_io_dirent2_t *src_dirent;
+  const svn_io_dirent2_t *dst_dirent;
+  svn_stringbuf_t *src_footer;
+  svn_stringbuf_t *dst_footer;
+
+  *match_p = FALSE;
+
+  SVN_ERR(svn_io_stat_dirent2(&dst_dirent, dst_path, FALSE, TRUE,
+                              scratch_pool, scratch_pool));
+  if (dst_dirent->kind != svn_node_file)
+    return SVN_NO_ERROR;
+
+  SVN_ERR(svn_io_stat_dirent2(&src_dirent, src_path, FALSE, FALSE,
+                              scratch_pool, scratch_pool));
+  if (   src_dirent->kind != svn_node_file
+      || src_dirent->filesize != dst_dirent->filesize)
+    return SVN_NO_ERROR;
+
+  SVN_ERR(read_pack_footer(&src_footer, src_path, src_dirent->filesize,
+                           rev, scratch_pool, scratch_pool));
+  SVN_ERR(read_pack_footer(&dst_footer, dst_path, dst_dirent->filesize,
+                           rev, scratch_pool, scratch_pool));
+
+  *match_p = src_footer && dst_footer
+          && svn_stringbuf_compare(src_footer, dst_footer);
+
+  return SVN_NO_ERROR;
+}
+
 /* Copy a packed shard containing revision REV, and which contains
  * MAX_FILES_PER_DIR revisions, from SRC_FS to DST_FS.
- * Update *DST_MIN_UNPACKED_REV in case the shard is new in DST_FS.
- * Do not re-copy data which already exists in DST_FS.
+ * Do not re-copy data which already exists in DST_FS.  If COMPARE_CHECKSUMS
+ * is set and SRC_FS uses logical addressing, decide that based on the
+ * pack file footers instead of the file timestamps.
  * Set *SKIPPED_P to FALSE only if at least one part of the shard
  * was copied, do not change the value in *SKIPPED_P otherwise.
  * SKIPPED_P may be NULL if not required.
+ *
+ * This only accesses the file system paths and the format information
+ * of SRC_FS and DST_FS, so it may be called from any thread.
  * Use SCRATCH_POOL for temporary allocations. */
 static svn_error_t *
 hotcopy_copy_packed_shard(svn_boolean_t *skipped_p,
-                          svn_revnum_t *dst_min_unpacked_rev,
                           svn_fs_t *src_fs,
                           svn_fs_t *dst_fs,
                           svn_revnum_t rev,
                           int max_files_per_dir,
+                          svn_boolean_t compare_checksums,
                           apr_pool_t *scratch_pool)
 {
   const char *src_subdir;
@@ -301,6 +415,7 @@ hotcopy_copy_packed_shard(svn_boolean_t *skipped_p,
   svn_revnum_t revprop_rev;
   apr_pool_t *iterpool;
   fs_fs_data_t *src_ffd = src_fs->fsap_data;
+  svn_boolean_t pack_unchanged = FALSE;
 
   /* Copy the packed shard. */
   src_subdir = svn_dirent_join(src_fs->path, PATH_REVS_DIR, scratch_pool);
@@ -309,11 +424,29 @@ hotcopy_copy_packed_shard(svn_boolean_t *skipped_p,
                               rev / max_files_per_dir);
   src_subdir_packed_shard = svn_dirent_join(src_subdir, packed_shard,
                                             scratch_pool);
-  SVN_ERR(hotcopy_io_copy_dir_recursively(skipped_p, src_subdir_packed_shard,
-                                          dst_subdir, packed_shard,
-                                          TRUE /* copy_perms */,
-                                          NULL /* cancel_func */, NULL,
-                                          scratch_pool));
+
+  /* Logically addressed pack shards consist of the pack file only.
+   * Note that redeltification rewrites existing pack files and assigns new
+   * item indexes.  It always appends data, though, so the rewritten pack
+   * file differs from the old one in size and footer and gets re-copied
+   * either way. */
+  if (compare_checksums && src_ffd->use_log_addressing)
+    SVN_ERR(pack_footers_match(&pack_unchanged,
+                               svn_dirent_join(src_subdir_packed_shard,
+                                               PATH_PACKED, scratch_pool),
+                               svn_dirent_join_many(scratch_pool,
+                                                    dst_subdir, packed_shard,
+                                                    PATH_PACKED,
+                                                    SVN_VA_NULL),
+                               rev, scratch_pool));
+
+  if (!pack_unchanged)
+    SVN_ERR(hotcopy_io_copy_dir_recursively(skipped_p,
+                                            src_subdir_packed_shard,
+                                            dst_subdir, packed_shard,
+                                            TRUE /* copy_perms */,
+                                            NULL /* cancel_func */, NULL,
+                                            scratch_pool));
 
   /* Copy revprops belonging to revisions in this pack. */
   src_subdir = svn_dirent_join(src_fs->path, PATH_REVPROPS_DIR, scratch_pool);
@@ -357,15 +490,6 @@ hotcopy_copy_packed_shard(svn_boolean_t *skipped_p,
                                               scratch_pool));
     }
 
-  /* If necessary, update the min-unpacked rev file in the hotcopy. */
-  if (*dst_min_unpacked_rev < rev + max_files_per_dir)
-    {
-      *dst_min_unpacked_rev = rev + max_files_per_dir;
-      SVN_ERR(svn_fs_fs__write_min_unpacked_rev(dst_fs,
-                                                *dst_min_unpacked_rev,
-                                                scratch_pool));
-    }
-
   return SVN_NO_ERROR;
 }
 
@@ -532,13 +656,192 @@ remove_folder(const char *path,
   return svn_error_trace(err);
 }
 
+/* Baton for the packed shard copying tasks of hotcopy_revisions(). */
+typedef struct packed_shards_baton_t
+{
+  svn_fs_t *src_fs;
+  svn_fs_t *dst_fs;
+
+  /* All shards before this revision will be copied. */
+  svn_revnum_t src_min_unpacked_rev;
+
+  /* Current contents of the min-unpacked-rev file in DST_FS.  Only
+   * accessed by the output functions. */
+  svn_revnum_t dst_min_unpacked_rev;
+
+  /* Youngest revision in DST_FS before the hotcopy started. */
+  svn_revnum_t dst_youngest;
+
+  int max_files_per_dir;
+  svn_boolean_t incremental;
+  svn_boolean_t compare_checksums;
+  svn_fs_hotcopy_notify_t notify_func;
+  void *notify_baton;
+} packed_shards_baton_t;
+
+/* Process baton for a single packed shard copying task. */
+typedef struct packed_shard_t
+{
+  /* Shared information. */
+  packed_shards_baton_t *baton;
+
+  /* First revision in the shard. */
+  svn_revnum_t rev;
+
+  /* Result of the copy as reported by hotcopy_copy_packed_shard(). */
+  svn_boolean_t skipped;
+} packed_shard_t;
+
+/* Implements svn_task__process_func_t.
+ *
+ * Copy the packed shard given by the packed_shard_t in PROCESS_BATON.
+ * This may run in any thread and must not update DST_FS metadata. */
+static svn_error_t *
+copy_packed_shard_task(void **result,
+                       svn_task__t *task,
+                       void *thread_context,
+                       void *process_baton,
+                       svn_cancel_func_t cancel_func,
+                       void *cancel_baton,
+                       apr_pool_t *result_pool,
+                       apr_pool_t *scratch_pool)
+{
+  packed_shard_t *shard = process_baton;
+  packed_shards_baton_t *baton = shard->baton;
+
+  if (cancel_func)
+    SVN_ERR(cancel_func(cancel_baton));
+
+  shard->skipped = TRUE;
+  SVN_ERR(hotcopy_copy_packed_shard(&shard->skipped,
+                                    baton->src_fs, baton->dst_fs,
+                                    shard->rev, baton->max_files_per_dir,
+                                    baton->compare_checksums,
+                                    scratch_pool));
+
+  *result = shard;
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_task__output_func_t.
+ *
+ * Make the packed shard given by the packed_shard_t in RESULT visible in
+ * DST_FS of the packed_shards_baton_t in OUTPUT_BATON and remove the
+ * non-packed files that it replaces.  This runs in the main thread in
+ * shard order. */
+static svn_error_t *
+finish_packed_shard(svn_task__t *task,
+                    void *result,
+                    void *output_baton,
+                    svn_cancel_func_t cancel_func,
+                    void *cancel_baton,
+                    apr_pool_t *result_pool,
+                    apr_pool_t *scratch_pool)
+{
+  packed_shard_t *shard = result;
+  packed_shards_baton_t *baton = output_baton;
+  svn_fs_t *dst_fs = baton->dst_fs;
+  fs_fs_data_t *dst_ffd = dst_fs->fsap_data;
+  int max_files_per_dir = baton->max_files_per_dir;
+  svn_revnum_t rev = shard->rev;
+  svn_revnum_t pack_end_rev = rev + max_files_per_dir - 1;
+
+  /* If necessary, update the min-unpacked rev file in the hotcopy. */
+  if (baton->dst_min_unpacked_rev < rev + max_files_per_dir)
+    {
+      baton->dst_min_unpacked_rev = rev + max_files_per_dir;
+      SVN_ERR(svn_fs_fs__write_min_unpacked_rev(dst_fs,
+                                                baton->dst_min_unpacked_rev,
+                                                scratch_pool));
+    }
+
+  /* Whenever this pack did not previously exist in the destination,
+   * update 'current' to the most recent packed rev (so readers can see
+   * new revisions which arrived in this pack). */
+  if (pack_end_rev > baton->dst_youngest)
+    {
+      SVN_ERR(svn_fs_fs__write_current(dst_fs, pack_end_rev, 0, 0,
+                                       scratch_pool));
+    }
+
+  /* When notifying about packed shards, make things simpler by either
+   * reporting a full revision range, i.e [pack start, pack end] or
+   * reporting nothing. There is one case when this approach might not
+   * be exact (incremental hotcopy with a pack replacing last unpacked
+   * revisions), but generally this is good enough. */
+  if (baton->notify_func && !shard->skipped)
+    baton->notify_func(baton->notify_baton, rev, pack_end_rev, scratch_pool);
+
+  /* Remove revision files which are now packed. */
+  if (baton->incremental)
+    {
+      SVN_ERR(hotcopy_remove_rev_files(dst_fs, rev,
+                                       rev + max_files_per_dir,
+                                       max_files_per_dir, scratch_pool));
+      if (dst_ffd->format >= SVN_FS_FS__MIN_PACKED_REVPROP_FORMAT)
+        SVN_ERR(hotcopy_remove_revprop_files(dst_fs, rev,
+                                             rev + max_files_per_dir,
+                                             max_files_per_dir,
+                                             scratch_pool));
+    }
+
+  /* Now that all revisions have moved into the pack, the original
+   * rev dir can be removed. */
+  SVN_ERR(remove_folder(svn_fs_fs__path_rev_shard(dst_fs, rev, scratch_pool),
+                        cancel_func, cancel_baton, scratch_pool));
+  if (rev > 0 && dst_ffd->format >= SVN_FS_FS__MIN_PACKED_REVPROP_FORMAT)
+    SVN_ERR(remove_folder(svn_fs_fs__path_revprops_shard(dst_fs, rev,
+                                                         scratch_pool),
+                          cancel_func, cancel_baton, scratch_pool));
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_task__process_func_t.
+ *
+ * Add a copying sub-task for each packed shard described by the
+ * packed_shards_baton_t in PROCESS_BATON. */
+static svn_error_t *
+add_packed_shard_tasks(void **result,
+                       svn_task__t *task,
+                       void *thread_context,
+                       void *process_baton,
+                       svn_cancel_func_t cancel_func,
+                       void *cancel_baton,
+                       apr_pool_t *result_pool,
+                       apr_pool_t *scratch_pool)
+{
+  packed_shards_baton_t *baton = process_baton;
+  svn_revnum_t rev;
+
+  for (rev = 0;
+       rev < baton->src_min_unpacked_rev;
+       rev += baton->max_files_per_dir)
+    {
+      apr_pool_t *process_pool = svn_task__create_process_pool(task);
+      packed_shard_t *shard = apr_pcalloc(process_pool, sizeof(*shard));
+
+      shard->baton = baton;
+      shard->rev = rev;
+
+      SVN_ERR(svn_task__add(task, process_pool, NULL,
+                            copy_packed_shard_task, shard,
+                            finish_packed_shard, baton));
+    }
+
+  *result = NULL;
+  return SVN_NO_ERROR;
+}
+
 /* Copy the revision and revprop files (possibly sharded / packed) from
  * SRC_FS to DST_FS.  Do not re-copy data which already exists in DST_FS.
  * When copying packed or unpacked shards, checkpoint the result in DST_FS
  * for every shard by updating the 'current' file if necessary.  Assume
  * the >= SVN_FS_FS__MIN_NO_GLOBAL_IDS_FORMAT filesystem format without
- * global next-ID counters.  Indicate progress via the optional NOTIFY_FUNC
- * callback using NOTIFY_BATON.  Use POOL for temporary allocations.
+ * global next-ID counters.  Copy up to THREAD_COUNT packed shards in
+ * parallel; see hotcopy_copy_packed_shard() for COMPARE_CHECKSUMS.
+ * Indicate progress via the optional NOTIFY_FUNC callback using
+ * NOTIFY_BATON.  Use POOL for temporary allocations.
  */
 static svn_error_t *
 hotcopy_revisions(svn_fs_t *src_fs,
@@ -546,6 +849,8 @@ hotcopy_revisions(svn_fs_t *src_fs,
                   svn_revnum_t src_youngest,
                   svn_revnum_t dst_youngest,
                   svn_boolean_t incremental,
+                  svn_boolean_t compare_checksums,
+                  int thread_count,
                   const char *src_revs_dir,
                   const char *dst_revs_dir,
                   const char *src_revprops_dir,
@@ -557,12 +862,12 @@ hotcopy_revisions(svn_fs_t *src_fs,
                   apr_pool_t *pool)
 {
   fs_fs_data_t *src_ffd = src_fs->fsap_data;
-  fs_fs_data_t *dst_ffd = dst_fs->fsap_data;
   int max_files_per_dir = src_ffd->max_files_per_dir;
   svn_revnum_t src_min_unpacked_rev;
   svn_revnum_t dst_min_unpacked_rev;
   svn_revnum_t rev;
   apr_pool_t *iterpool;
+  packed_shards_baton_t shards_baton;
 
   /* Copy the min unpacked rev, and read its value. */
   if (src_ffd->format >= SVN_FS_FS__MIN_PACKED_FORMAT)
@@ -600,65 +905,24 @@ hotcopy_revisions(svn_fs_t *src_fs,
    * Copy the necessary rev files.
    */
 
-  iterpool = svn_pool_create(pool);
   /* First, copy packed shards. */
-  for (rev = 0; rev < src_min_unpacked_rev; rev += max_files_per_dir)
-    {
-      svn_boolean_t skipped = TRUE;
-      svn_revnum_t pack_end_rev;
-
-      svn_pool_clear(iterpool);
-
-      if (cancel_func)
-        SVN_ERR(cancel_func(cancel_baton));
-
-      /* Copy the packed shard. */
-      SVN_ERR(hotcopy_copy_packed_shard(&skipped, &dst_min_unpacked_rev,
-                                        src_fs, dst_fs,
-                                        rev, max_files_per_dir,
-                                        iterpool));
-
-      pack_end_rev = rev + max_files_per_dir - 1;
+  shards_baton.src_fs = src_fs;
+  shards_baton.dst_fs = dst_fs;
+  shards_baton.src_min_unpacked_rev = src_min_unpacked_rev;
+  shards_baton.dst_min_unpacked_rev = dst_min_unpacked_rev;
+  shards_baton.dst_youngest = dst_youngest;
+  shards_baton.max_files_per_dir = max_files_per_dir;
+  shards_baton.incremental = incremental;
+  shards_baton.compare_checksums = compare_checksums;
+  shards_baton.notify_func = notify_func;
+  shards_baton.notify_baton = notify_baton;
 
-      /* Whenever this pack did not previously exist in the destination,
-       * update 'current' to the most recent packed rev (so readers can see
-       * new revisions which arrived in this pack). */
-      if (pack_end_rev > dst_youngest)
-        {
-          SVN_ERR(svn_fs_fs__write_current(dst_fs, pack_end_rev, 0, 0,
-                                           iterpool));
-        }
-
-      /* When notifying about packed shards, make things simpler by either
-       * reporting a full revision range, i.e [pack start, pack end] or
-       * reporting nothing. There is one case when this approach might not
-       * be exact (incremental hotcopy with a pack replacing last unpacked
-       * revisions), but generally this is good enough. */
-      if (notify_func && !skipped)
-        notify_func(notify_baton, rev, pack_end_rev, iterpool);
-
-      /* Remove revision files which are now packed. */
-      if (incremental)
-        {
-          SVN_ERR(hotcopy_remove_rev_files(dst_fs, rev,
-                                           rev + max_files_per_dir,
-                                           max_files_per_dir, iterpool));
-          if (dst_ffd->format >= SVN_FS_FS__MIN_PACKED_REVPROP_FORMAT)
-            SVN_ERR(hotcopy_remove_revprop_files(dst_fs, rev,
-                                                 rev + max_files_per_dir,
-                                                 max_files_per_dir,
-                                                 iterpool));
-        }
-
-      /* Now that all revisions have moved into the pack, the original
-       * rev dir can be removed. */
-      SVN_ERR(remove_folder(svn_fs_fs__path_rev_shard(dst_fs, rev, iterpool),
-                            cancel_func, cancel_baton, iterpool));
-      if (rev > 0 && dst_ffd->format >= SVN_FS_FS__MIN_PACKED_REVPROP_FORMAT)
-        SVN_ERR(remove_folder(svn_fs_fs__path_revprops_shard(dst_fs, rev,
-                                                             iterpool),
-                              cancel_func, cancel_baton, iterpool));
-    }
+  iterpool = svn_pool_create(pool);
+  SVN_ERR(svn_task__run(thread_count, add_packed_shard_tasks, &shards_baton,
+                        NULL, NULL, NULL, NULL, cancel_func, cancel_baton,
+                        pool, iterpool));
+  dst_min_unpacked_rev = shards_baton.dst_min_unpacked_rev;
+  rev = src_min_unpacked_rev;
 
   if (cancel_func)
     SVN_ERR(cancel_func(cancel_baton));
@@ -780,6 +1044,8 @@ struct hotcopy_body_baton {
   svn_fs_t *src_fs;
   svn_fs_t *dst_fs;
   svn_boolean_t incremental;
+  svn_boolean_t compare_checksums;
+  int thread_count;
   svn_fs_hotcopy_notify_t notify_func;
   void *notify_baton;
   svn_cancel_func_t cancel_func;
@@ -928,7 +1194,9 @@ hotcopy_body(void *baton, apr_pool_t *pool)
   if (src_ffd->format >= SVN_FS_FS__MIN_NO_GLOBAL_IDS_FORMAT)
     {
       SVN_ERR(hotcopy_revisions(src_fs, dst_fs, src_youngest, dst_youngest,
-                                incremental, src_revs_dir, dst_revs_dir,
+                                incremental, hbb->compare_checksums,
+                                hbb->thread_count,
+                                src_revs_dir, dst_revs_dir,
                                 src_revprops_dir, dst_revprops_dir,
                                 notify_func, notify_baton,
                                 cancel_func, cancel_baton, pool));
@@ -988,8 +1256,73 @@ hotcopy_body(void *baton, apr_pool_t *pool)
           SVN_ERR(svn_io_set_file_read_write(dst_subdir, FALSE, pool));
           SVN_ERR(svn_fs_fs__del_rep_reference(dst_fs, src_youngest, pool));
         }
+
+      /* The rep cache filter may contain entries that we just removed
+       * from the destination's rep cache but false positives are o.k.
+       * Don't leave a previous copy of the filter around. */
+      src_subdir = svn_dirent_join(src_fs->path, REP_CACHE_FILTER_NAME, pool);
+      dst_subdir = svn_dirent_join(dst_fs->path, REP_CACHE_FILTER_NAME, pool);
+      SVN_ERR(svn_io_check_path(src_subdir, &kind, pool));
+      if (kind == svn_node_file)
+        SVN_ERR(svn_io_copy_file(src_subdir, dst_subdir, TRUE, pool));
+      else
+        SVN_ERR(svn_io_remove_file2(dst_subdir, TRUE, pool));
     }
 
+  /* Copy the path index.  It may contain data on a revision that has
+   * not been committed in the source, yet, but lookups never look beyond
+   * the youngest revision and the next commit will replace that data.
+   * Incremental hotcopies simply index the new revisions in the destination
+   * instead of copying the whole database again. */
+  src_subdir = svn_dirent_join(src_fs->path, PATH_INDEX_DB_NAME, pool);
+  dst_subdir = svn_dirent_join(dst_fs->path, PATH_INDEX_DB_NAME, pool);
+  SVN_ERR(svn_io_check_path(src_subdir, &kind, pool));
+  if (kind == svn_node_file)
+    {
+      svn_boolean_t updated = FALSE;
+
+      if (incremental)
+        SVN_ERR(svn_fs_fs__update_path_index(&updated, dst_fs,
+                                             dst_youngest + 1, src_youngest,
+                                             cancel_func, cancel_baton,
+                                             pool));
+
+      if (!updated)
+        {
+          SVN_ERR(svn_sqlite__hotcopy(src_subdir, dst_subdir, pool));
+          SVN_ERR(svn_io_set_file_read_write(dst_subdir, FALSE, pool));
+        }
+    }
+  else
+    {
+      SVN_ERR(svn_io_remove_file2(dst_subdir, TRUE, pool));
+    }
+
+  /* The same applies to the mergeinfo index. */
+  src_subdir = svn_dirent_join(src_fs->path, MERGEINFO_INDEX_DB_NAME, pool);
+  dst_subdir = svn_dirent_join(dst_fs->path, MERGEINFO_INDEX_DB_NAME, pool);
+  SVN_ERR(svn_io_check_path(src_subdir, &kind, pool));
+  if (kind == svn_node_file)
+    {
+      SVN_ERR(svn_sqlite__hotcopy(src_subdir, dst_subdir, pool));
+      SVN_ERR(svn_io_set_file_read_write(dst_subdir, FALSE, pool));
+    }
+  else
+    {
+      SVN_ERR(svn_io_remove_file2(dst_subdir, TRUE, pool));
+    }
+
+  /* Don't copy the revprop index.  Revprop changes in the source may have
+   * happened between copying the revprops and copying the index, leaving
+   * us with entries that don't match the revprops in the destination.
+   * The next 'svnadmin pack' will create a new index. */
+  SVN_ERR(svn_io_remove_file2(svn_dirent_join(dst_fs->path,
+                                              REVPROP_INDEX_NAME, pool),
+                              TRUE, pool));
+  SVN_ERR(svn_io_remove_file2(svn_dirent_join(dst_fs->path,
+                                              REVPROP_INDEX_DATA_NAME, pool),
+                              TRUE, pool));
+
   /* Copy the txn-current file. */
   if (dst_ffd->format >= SVN_FS_FS__MIN_TXN_CURRENT_FORMAT)
     SVN_ERR(svn_io_dir_file_copy(src_fs->path, dst_fs->path,
@@ -1007,6 +1340,8 @@ svn_fs_fs__hotcopy(svn_fs_t *src_fs,
                    const char *src_path,
                    const char *dst_path,
                    svn_boolean_t incremental,
+                   svn_boolean_t compare_checksums,
+                   int thread_count,
                    svn_fs_hotcopy_notify_t notify_func,
                    void *notify_baton,
                    svn_cancel_func_t cancel_func,
@@ -1082,6 +1417,8 @@ svn_fs_fs__hotcopy(svn_fs_t *src_fs,
   hbb.src_fs = src_fs;
   hbb.dst_fs = dst_fs;
   hbb.incremental = incremental;
+  hbb.compare_checksums = compare_checksums;
+  hbb.thread_count = thread_count;
   hbb.notify_func = notify_func;
   hbb.notify_baton = notify_baton;
   hbb.cancel_func = cancel_func;
@@ -981,7 +981,7 @@ get_l2p_header_body(l2p_header_t **header,
 
   pair_cache_key_t key;
   key.revision = rev_file->start_revision;
-  key.second = rev_file->is_packed;
+  key.second = rev_file->pack_generation;
 
   SVN_ERR(auto_open_l2p_index(rev_file, fs, revision));
   packed_stream_seek(rev_file->l2p_stream, 0);
@@ -1213,7 +1213,7 @@ get_l2p_page_info(l2p_page_info_baton_t *baton,
   /* try to find the info in the cache */
   pair_cache_key_t key;
   key.revision = rev_file->start_revision;
-  key.second = rev_file->is_packed;
+  key.second = rev_file->pack_generation;
   SVN_ERR(svn_cache__get_partial((void**)&dummy, &is_cached,
                                  ffd->l2p_header_cache, &key,
                                  l2p_page_info_access_func, baton,
@@ -1303,7 +1303,7 @@ get_l2p_page_table(apr_array_header_t *pages,
 
   pair_cache_key_t key;
   key.revision = rev_file->start_revision;
-  key.second = rev_file->is_packed;
+  key.second = rev_file->pack_generation;
 
   apr_array_clear(pages);
   baton.revision = revision;
@@ -1415,7 +1415,7 @@ prefetch_l2p_pages(svn_boolean_t *end,
   iterpool = svn_pool_create(scratch_pool);
   assert(revision <= APR_UINT32_MAX);
   key.revision = (apr_uint32_t)revision;
-  key.is_packed = rev_file->is_packed;
+  key.pack_generation = rev_file->pack_generation;
 
   for (i = 0; i < pages->nelts && !*end; ++i)
     {
@@ -1554,7 +1554,7 @@ l2p_index_lookup(apr_off_t *offset,
 
   assert(revision <= APR_UINT32_MAX);
   key.revision = (apr_uint32_t)revision;
-  key.is_packed = svn_fs_fs__is_packed_rev(fs, revision);
+  key.pack_generation = rev_file->pack_generation;
   key.page = info_baton.page_no;
 
   SVN_ERR(svn_cache__get_partial(&dummy, &is_cached,
@@ -1570,7 +1570,7 @@ l2p_index_lookup(apr_off_t *offset,
       svn_revnum_t prefetch_revision;
       svn_revnum_t last_revision
         = info_baton.first_revision
-          + (key.is_packed ? ffd->max_files_per_dir : 1);
+          + (rev_file->is_packed ? ffd->max_files_per_dir : 1);
       svn_boolean_t end;
       apr_off_t max_offset
         = APR_ALIGN(info_baton.entry.offset + info_baton.entry.size,
@@ -1693,7 +1693,7 @@ get_l2p_header(l2p_header_t **header,
   /* first, try cache lookop */
   pair_cache_key_t key;
   key.revision = rev_file->start_revision;
-  key.second = rev_file->is_packed;
+  key.second = rev_file->pack_generation;
   SVN_ERR(svn_cache__get((void**)header, &is_cached, ffd->l2p_header_cache,
                          &key, result_pool));
   if (is_cached)
@@ -2173,7 +2173,7 @@ get_p2l_header(p2l_header_t **header,
   /* look for the header data in our cache */
   pair_cache_key_t key;
   key.revision = rev_file->start_revision;
-  key.second = rev_file->is_packed;
+  key.second = rev_file->pack_generation;
 
   SVN_ERR(svn_cache__get((void**)header, &is_cached, ffd->p2l_header_cache,
                          &key, result_pool));
@@ -2348,7 +2348,7 @@ get_p2l_page_info(p2l_page_info_baton_t *baton,
   /* look for the header data in our cache */
   pair_cache_key_t key;
   key.revision = rev_file->start_revision;
-  key.second = rev_file->is_packed;
+  key.second = rev_file->pack_generation;
 
   SVN_ERR(svn_cache__get_partial(&dummy, &is_cached, ffd->p2l_header_cache,
                                  &key, p2l_page_info_func, baton,
@@ -2555,7 +2555,7 @@ prefetch_p2l_page(svn_boolean_t *end,
   /* do we have that page in our caches already? */
   assert(baton->first_revision <= APR_UINT32_MAX);
   key.revision = (apr_uint32_t)baton->first_revision;
-  key.is_packed = svn_fs_fs__is_packed_rev(fs, baton->first_revision);
+  key.pack_generation = rev_file->pack_generation;
   key.page = baton->page_no;
   SVN_ERR(svn_cache__has_key(&already_cached, ffd->p2l_page_cache,
                              &key, scratch_pool));
@@ -2626,7 +2626,7 @@ get_p2l_keys(p2l_page_info_baton_t *page_info_p,
       svn_fs_fs__page_cache_key_t key = { 0 };
       assert(page_info.first_revision <= APR_UINT32_MAX);
       key.revision = (apr_uint32_t)page_info.first_revision;
-      key.is_packed = rev_file->is_packed;
+      key.pack_generation = rev_file->pack_generation;
       key.page = page_info.page_no;
 
       *key_p = key;
@@ -3060,7 +3060,7 @@ p2l_get_max_offset(apr_off_t *offset,
   /* look for the header data in our cache */
   pair_cache_key_t key;
   key.revision = rev_file->start_revision;
-  key.second = rev_file->is_packed;
+  key.second = rev_file->pack_generation;
 
   SVN_ERR(svn_cache__get_partial((void **)&offset_p, &is_cached,
                                  ffd->p2l_header_cache, &key,
@@ -269,9 +269,10 @@ typedef struct svn_fs_fs__page_cache_key_t
      in p2l: this is the start revision identifying the pack / rev file */
   apr_uint32_t revision;
 
-  /* if TRUE, this is the index to a pack file
+  /* 0 for the index of a non-packed rev file.  For pack files, this is
+   * the PACK_GENERATION of the svn_fs_fs__revision_file_t.
    */
-  svn_boolean_t is_packed;
+  apr_uint32_t pack_generation;
 
   /* in l2p: page number within the revision
    * in p2l: page number with the rev / pack file
@@ -0,0 +1,87 @@
+/* mergeinfo-index-db.sql -- schema of the mergeinfo index
+ *   This is intended for use with SQLite 3
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+-- STMT_CREATE_SCHEMA
+/* Each row records that PATH got (HAS_MERGEINFO = 1) or lost
+   (HAS_MERGEINFO = 0) its svn:mergeinfo property in REVISION.  The latest
+   row at or before a given revision tells whether PATH carries mergeinfo
+   in that revision.  Paths that never had mergeinfo are not listed.
+
+   Besides property changes, copies add rows for all copied paths that
+   have mergeinfo and deletions add rows for all deleted paths that had
+   mergeinfo. */
+CREATE TABLE mergeinfo_changes (
+  path TEXT NOT NULL,
+  revision INTEGER NOT NULL,
+  has_mergeinfo INTEGER NOT NULL,
+  PRIMARY KEY (path, revision)
+  );
+
+/* Single row table.  All revisions up to and including REVISION have been
+   added to the index. */
+CREATE TABLE coverage (
+  revision INTEGER NOT NULL
+  );
+
+INSERT INTO coverage (revision) VALUES (-1);
+
+PRAGMA USER_VERSION = 1;
+
+-- STMT_GET_COVERAGE
+SELECT revision
+FROM coverage
+
+-- STMT_SET_COVERAGE
+UPDATE coverage
+SET revision = ?1
+
+-- STMT_SET_MERGEINFO
+INSERT OR REPLACE INTO mergeinfo_changes (path, revision, has_mergeinfo)
+VALUES (?1, ?2, ?3)
+
+-- STMT_GET_MERGEINFO
+SELECT has_mergeinfo
+FROM mergeinfo_changes
+WHERE path = ?1 AND revision <= ?2
+ORDER BY revision DESC
+LIMIT 1
+
+-- STMT_GET_DESCENDANTS
+/* The latest state at or before revision ?3 of all paths in the range
+   ?1 < path < ?2.  For the sub-paths of some directory "/dir", ?1 is
+   "/dir/" and ?2 is "/dir0" with '0' being the next character after '/'.
+   SQLite takes the bare HAS_MERGEINFO column from the row that also
+   provides the MAX(REVISION). */
+SELECT path, has_mergeinfo, MAX(revision)
+FROM mergeinfo_changes
+WHERE path > ?1 AND path < ?2 AND revision <= ?3
+GROUP BY path
+ORDER BY path
+
+-- STMT_DEL_MERGEINFO_FROM_REV
+DELETE FROM mergeinfo_changes
+WHERE revision >= ?1
+
+-- STMT_CLEAR
+DELETE FROM mergeinfo_changes;
+UPDATE coverage SET revision = -1;
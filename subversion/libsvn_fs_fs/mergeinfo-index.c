@@ -0,0 +1,519 @@
+/* mergeinfo-index.c --- index of paths with mergeinfo for fsfs
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+#include "svn_pools.h"
+#include "svn_sorts.h"
+
+#include "svn_private_config.h"
+
+#include "cached_data.h"
+#include "fs_fs.h"
+#include "fs.h"
+#include "mergeinfo-index.h"
+#include "transaction.h"
+#include "util.h"
+#include "../libsvn_fs/fs-loader.h"
+
+#include "svn_dirent_uri.h"
+
+#include "private/svn_fspath.h"
+#include "private/svn_sorts_private.h"
+#include "private/svn_sqlite.h"
+
+#include "mergeinfo-index-db.h"
+
+MERGEINFO_INDEX_DB_SQL_DECLARE_STATEMENTS(statements);
+
+
+
+/** Helper functions. **/
+static APR_INLINE const char *
+path_mergeinfo_index_db(const char *fs_path,
+                        apr_pool_t *result_pool)
+{
+  return svn_dirent_join(fs_path, MERGEINFO_INDEX_DB_NAME, result_pool);
+}
+
+/* Make sure FS->FSAP_DATA->MERGEINFO_INDEX_DB is open, if the mergeinfo
+   index of FS exists.  Create it if it does not exist and CREATE is set.
+   Use SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+open_mergeinfo_index(svn_fs_t *fs,
+                     svn_boolean_t create,
+                     apr_pool_t *scratch_pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+  svn_sqlite__db_t *sdb;
+  const char *db_path;
+  svn_node_kind_t kind;
+  int version;
+
+  if (ffd->mergeinfo_index_db)
+    return SVN_NO_ERROR;
+
+  /* The mergeinfo index is optional.  Don't create it as a side-effect of
+     simply trying to use it. */
+  db_path = path_mergeinfo_index_db(fs->path, scratch_pool);
+  SVN_ERR(svn_io_check_path(db_path, &kind, scratch_pool));
+  if (kind == svn_node_none && !create)
+    return SVN_NO_ERROR;
+
+#ifndef WIN32
+  if (kind == svn_node_none)
+    {
+      /* Extend the repository permissions to the new database, just like
+         we do for the rep-cache. */
+      svn_error_t *err = svn_io_file_create_empty(db_path, scratch_pool);
+
+      if (err && !APR_STATUS_IS_EEXIST(err->apr_err))
+        return svn_error_trace(err);
+      else if (err)
+        svn_error_clear(err);
+      else
+        SVN_ERR(svn_io_copy_perms(svn_fs_fs__path_current(fs, scratch_pool),
+                                  db_path, scratch_pool));
+    }
+#endif
+
+  SVN_ERR(svn_sqlite__open(&sdb, db_path,
+                           svn_sqlite__mode_rwcreate, statements,
+                           0, NULL, 0,
+                           fs->pool, scratch_pool));
+
+  SVN_SQLITE__ERR_CLOSE(svn_sqlite__read_schema_version(&version, sdb,
+                                                        scratch_pool),
+                        sdb);
+  if (version <= 0)
+    {
+      if (create)
+        {
+          SVN_SQLITE__ERR_CLOSE(svn_sqlite__exec_statements(
+                                  sdb, STMT_CREATE_SCHEMA),
+                                sdb);
+        }
+      else
+        {
+          /* Someone else is just creating it.  Ignore it for now. */
+          return svn_error_trace(svn_sqlite__close(sdb));
+        }
+    }
+
+  ffd->mergeinfo_index_db = sdb;
+
+  return SVN_NO_ERROR;
+}
+
+/* Set *REVISION to the youngest revision covered by the mergeinfo index
+   SDB. */
+static svn_error_t *
+get_coverage(svn_revnum_t *revision,
+             svn_sqlite__db_t *sdb)
+{
+  svn_sqlite__stmt_t *stmt;
+  svn_boolean_t have_row;
+
+  SVN_ERR(svn_sqlite__get_statement(&stmt, sdb, STMT_GET_COVERAGE));
+  SVN_ERR(svn_sqlite__step(&have_row, stmt));
+  *revision = have_row ? svn_sqlite__column_revnum(stmt, 0)
+                       : SVN_INVALID_REVNUM;
+
+  return svn_error_trace(svn_sqlite__reset(stmt));
+}
+
+/* Set the youngest revision covered by the mergeinfo index SDB to
+   REVISION. */
+static svn_error_t *
+set_coverage(svn_sqlite__db_t *sdb,
+             svn_revnum_t revision)
+{
+  svn_sqlite__stmt_t *stmt;
+
+  SVN_ERR(svn_sqlite__get_statement(&stmt, sdb, STMT_SET_COVERAGE));
+  SVN_ERR(svn_sqlite__bindf(stmt, "r", revision));
+
+  return svn_error_trace(svn_sqlite__update(NULL, stmt));
+}
+
+/* Set *HAS_MERGEINFO to TRUE, if PATH carries mergeinfo in REVISION
+   according to the mergeinfo index SDB. */
+static svn_error_t *
+get_mergeinfo_state(svn_boolean_t *has_mergeinfo,
+                    svn_sqlite__db_t *sdb,
+                    const char *path,
+                    svn_revnum_t revision)
+{
+  svn_sqlite__stmt_t *stmt;
+  svn_boolean_t have_row;
+
+  SVN_ERR(svn_sqlite__get_statement(&stmt, sdb, STMT_GET_MERGEINFO));
+  SVN_ERR(svn_sqlite__bindf(stmt, "sr", path, revision));
+  SVN_ERR(svn_sqlite__step(&have_row, stmt));
+  *has_mergeinfo = have_row && svn_sqlite__column_boolean(stmt, 0);
+
+  return svn_error_trace(svn_sqlite__reset(stmt));
+}
+
+/* Record in the mergeinfo index SDB that PATH does or does not carry
+   mergeinfo, depending on HAS_MERGEINFO, as of REVISION. */
+static svn_error_t *
+set_mergeinfo_state(svn_sqlite__db_t *sdb,
+                    const char *path,
+                    svn_revnum_t revision,
+                    svn_boolean_t has_mergeinfo)
+{
+  svn_sqlite__stmt_t *stmt;
+
+  SVN_ERR(svn_sqlite__get_statement(&stmt, sdb, STMT_SET_MERGEINFO));
+  SVN_ERR(svn_sqlite__bindf(stmt, "srd", path, revision,
+                            has_mergeinfo ? 1 : 0));
+
+  return svn_error_trace(svn_sqlite__insert(NULL, stmt));
+}
+
+/* Set *PATHS to the sorted list of all paths (const char *) below PATH
+   that carry mergeinfo in REVISION according to the mergeinfo index SDB.
+   Allocate *PATHS in RESULT_POOL and use SCRATCH_POOL for temporaries. */
+static svn_error_t *
+get_descendants(apr_array_header_t **paths,
+                svn_sqlite__db_t *sdb,
+                const char *path,
+                svn_revnum_t revision,
+                apr_pool_t *result_pool,
+                apr_pool_t *scratch_pool)
+{
+  apr_array_header_t *result = apr_array_make(result_pool, 0,
+                                              sizeof(const char *));
+  svn_sqlite__stmt_t *stmt;
+  svn_boolean_t have_row;
+  const char *lower;
+  char *upper;
+
+  /* All sub-paths of PATH start with PATH + "/" and sort before the
+     first string that has the '/' replaced by the next character.
+     The root is the only fspath ending with '/' already. */
+  lower = strcmp(path, "/") ? apr_pstrcat(scratch_pool, path, "/",
+                                          SVN_VA_NULL)
+                            : path;
+  upper = apr_pstrdup(scratch_pool, lower);
+  upper[strlen(upper) - 1] = '/' + 1;
+
+  SVN_ERR(svn_sqlite__get_statement(&stmt, sdb, STMT_GET_DESCENDANTS));
+  SVN_ERR(svn_sqlite__bindf(stmt, "ssr", lower, upper, revision));
+  SVN_ERR(svn_sqlite__step(&have_row, stmt));
+  while (have_row)
+    {
+      if (svn_sqlite__column_boolean(stmt, 1))
+        APR_ARRAY_PUSH(result, const char *)
+          = svn_sqlite__column_text(stmt, 0, result_pool);
+
+      SVN_ERR(svn_sqlite__step(&have_row, stmt));
+    }
+
+  *paths = result;
+
+  return svn_error_trace(svn_sqlite__reset(stmt));
+}
+
+/* Record in the mergeinfo index SDB that PATH and all paths below it got
+   deleted in REVISION, i.e. that none of them carries mergeinfo anymore.
+   Use SCRATCH_POOL for temporaries. */
+static svn_error_t *
+remove_subtree(svn_sqlite__db_t *sdb,
+               const char *path,
+               svn_revnum_t revision,
+               apr_pool_t *scratch_pool)
+{
+  apr_array_header_t *paths;
+  svn_boolean_t has_mergeinfo;
+  int i;
+
+  SVN_ERR(get_mergeinfo_state(&has_mergeinfo, sdb, path, revision));
+  if (has_mergeinfo)
+    SVN_ERR(set_mergeinfo_state(sdb, path, revision, FALSE));
+
+  SVN_ERR(get_descendants(&paths, sdb, path, revision, scratch_pool,
+                          scratch_pool));
+  for (i = 0; i < paths->nelts; ++i)
+    SVN_ERR(set_mergeinfo_state(sdb, APR_ARRAY_IDX(paths, i, const char *),
+                                revision, FALSE));
+
+  return SVN_NO_ERROR;
+}
+
+/* Record in the mergeinfo index SDB that FROM_PATH@FROM_REV got copied
+   to TO_PATH in REVISION, i.e. that all paths with mergeinfo in the
+   source tree have a counterpart with mergeinfo in the copy.  Use
+   SCRATCH_POOL for temporaries. */
+static svn_error_t *
+copy_subtree(svn_sqlite__db_t *sdb,
+             const char *from_path,
+             svn_revnum_t from_rev,
+             const char *to_path,
+             svn_revnum_t revision,
+             apr_pool_t *scratch_pool)
+{
+  apr_array_header_t *paths;
+  svn_boolean_t has_mergeinfo;
+  int i;
+
+  SVN_ERR(get_mergeinfo_state(&has_mergeinfo, sdb, from_path, from_rev));
+  if (has_mergeinfo)
+    SVN_ERR(set_mergeinfo_state(sdb, to_path, revision, TRUE));
+
+  SVN_ERR(get_descendants(&paths, sdb, from_path, from_rev, scratch_pool,
+                          scratch_pool));
+  for (i = 0; i < paths->nelts; ++i)
+    {
+      const char *path = APR_ARRAY_IDX(paths, i, const char *);
+      const char *relpath = svn_fspath__skip_ancestor(from_path, path);
+
+      SVN_ERR(set_mergeinfo_state(sdb,
+                                  svn_fspath__join(to_path, relpath,
+                                                   scratch_pool),
+                                  revision, TRUE));
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Add the mergeinfo changes caused by CHANGED_PATHS (mapping paths to
+   svn_fs_path_change2_t *) in REVISION of FS to the mergeinfo index SDB.
+   Use SCRATCH_POOL for temporaries. */
+static svn_error_t *
+add_changes(svn_sqlite__db_t *sdb,
+            svn_fs_t *fs,
+            svn_revnum_t revision,
+            apr_hash_t *changed_paths,
+            apr_pool_t *scratch_pool)
+{
+  apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+  apr_array_header_t *sorted;
+  int i;
+
+  /* Process parents before their sub-paths, such that e.g. property
+     changes within a copied tree override what we copied. */
+  sorted = svn_sort__hash(changed_paths, svn_sort_compare_items_as_paths,
+                          scratch_pool);
+  for (i = 0; i < sorted->nelts; ++i)
+    {
+      svn_sort__item_t *item = &APR_ARRAY_IDX(sorted, i, svn_sort__item_t);
+      const char *path = item->key;
+      svn_fs_path_change2_t *change = item->value;
+
+      svn_pool_clear(iterpool);
+
+      if (   change->change_kind == svn_fs_path_change_delete
+          || change->change_kind == svn_fs_path_change_replace)
+        SVN_ERR(remove_subtree(sdb, path, revision, iterpool));
+
+      if (   (   change->change_kind == svn_fs_path_change_add
+              || change->change_kind == svn_fs_path_change_replace)
+          && change->copyfrom_known
+          && change->copyfrom_path
+          && SVN_IS_VALID_REVNUM(change->copyfrom_rev))
+        SVN_ERR(copy_subtree(sdb, change->copyfrom_path, change->copyfrom_rev,
+                             path, revision, iterpool));
+
+      /* This is the same flag that increment_mergeinfo_up_tree() counts
+         in the parent directories. */
+      if (   change->change_kind != svn_fs_path_change_delete
+          && change->prop_mod
+          && change->mergeinfo_mod != svn_tristate_false
+          && change->node_rev_id)
+        {
+          node_revision_t *noderev;
+          svn_boolean_t had_mergeinfo;
+
+          SVN_ERR(svn_fs_fs__get_node_revision(&noderev, fs,
+                                               change->node_rev_id,
+                                               iterpool, iterpool));
+          SVN_ERR(get_mergeinfo_state(&had_mergeinfo, sdb, path, revision));
+          if (!had_mergeinfo != !noderev->has_mergeinfo)
+            SVN_ERR(set_mergeinfo_state(sdb, path, revision,
+                                        noderev->has_mergeinfo));
+        }
+    }
+
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
+
+/** Public API. **/
+
+svn_error_t *
+svn_fs_fs__mergeinfo_index_get_descendants(svn_boolean_t *available,
+                                           apr_array_header_t **paths,
+                                           svn_fs_t *fs,
+                                           const char *path,
+                                           svn_revnum_t revision,
+                                           apr_pool_t *result_pool,
+                                           apr_pool_t *scratch_pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+  svn_revnum_t covered;
+
+  *available = FALSE;
+
+  SVN_ERR(open_mergeinfo_index(fs, FALSE, scratch_pool));
+  if (!ffd->mergeinfo_index_db)
+    return SVN_NO_ERROR;
+
+  SVN_ERR(get_coverage(&covered, ffd->mergeinfo_index_db));
+  if (!SVN_IS_VALID_REVNUM(covered) || covered < revision)
+    return SVN_NO_ERROR;
+
+  SVN_ERR(get_descendants(paths, ffd->mergeinfo_index_db, path, revision,
+                          result_pool, scratch_pool));
+  *available = TRUE;
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_fs_fs__mergeinfo_index_add_revision(svn_fs_t *fs,
+                                        svn_revnum_t revision,
+                                        apr_hash_t *changed_paths,
+                                        apr_pool_t *scratch_pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+  svn_sqlite__db_t *sdb;
+  svn_sqlite__stmt_t *stmt;
+  svn_revnum_t covered;
+  svn_error_t *err;
+
+  SVN_ERR(open_mergeinfo_index(fs, FALSE, scratch_pool));
+  sdb = ffd->mergeinfo_index_db;
+  if (!sdb)
+    return SVN_NO_ERROR;
+
+  SVN_ERR(svn_sqlite__begin_transaction(sdb));
+
+  /* If some commit did not update the index, it is incomplete and remains
+     unused until it gets rebuilt.  If an earlier attempt to commit
+     REVISION failed, we may have to remove its changes. */
+  err = get_coverage(&covered, sdb);
+  if (!err && SVN_IS_VALID_REVNUM(covered) && covered >= revision - 1)
+    {
+      if (covered >= revision)
+        {
+          err = svn_sqlite__get_statement(&stmt, sdb,
+                                          STMT_DEL_MERGEINFO_FROM_REV);
+          if (!err)
+            err = svn_sqlite__bindf(stmt, "r", revision);
+          if (!err)
+            err = svn_sqlite__update(NULL, stmt);
+        }
+
+      if (!err)
+        err = add_changes(sdb, fs, revision, changed_paths, scratch_pool);
+      if (!err)
+        err = set_coverage(sdb, revision);
+    }
+
+  return svn_error_trace(svn_sqlite__finish_transaction(sdb, err));
+}
+
+/* Baton type used when building the mergeinfo index. */
+typedef struct build_mergeinfo_index_baton_t
+{
+  svn_fs_t *fs;
+  svn_fs_progress_notify_func_t progress_func;
+  void *progress_baton;
+  svn_cancel_func_t cancel_func;
+  void *cancel_baton;
+} build_mergeinfo_index_baton_t;
+
+/* Body of svn_fs_fs__build_mergeinfo_index, to be called with the write
+   lock held.  BATON is a build_mergeinfo_index_baton_t. */
+static svn_error_t *
+build_mergeinfo_index_body(void *baton,
+                           apr_pool_t *pool)
+{
+  build_mergeinfo_index_baton_t *b = baton;
+  fs_fs_data_t *ffd = b->fs->fsap_data;
+  apr_pool_t *iterpool = svn_pool_create(pool);
+  svn_revnum_t youngest;
+  svn_revnum_t rev;
+
+  SVN_ERR(svn_fs_fs__youngest_rev(&youngest, b->fs, pool));
+  SVN_ERR(open_mergeinfo_index(b->fs, TRUE, pool));
+
+  /* Start from scratch.  Readers will not use the index until we are
+     done. */
+  SVN_ERR(svn_sqlite__exec_statements(ffd->mergeinfo_index_db, STMT_CLEAR));
+
+  for (rev = 0; rev <= youngest; ++rev)
+    {
+      apr_hash_t *changed_paths;
+
+      svn_pool_clear(iterpool);
+
+      if (b->cancel_func)
+        SVN_ERR(b->cancel_func(b->cancel_baton));
+      if (b->progress_func)
+        b->progress_func(rev, b->progress_baton, iterpool);
+
+      SVN_ERR(svn_fs_fs__paths_changed(&changed_paths, b->fs, rev,
+                                       iterpool));
+      SVN_SQLITE__WITH_TXN(
+        add_changes(ffd->mergeinfo_index_db, b->fs, rev, changed_paths,
+                    iterpool),
+        ffd->mergeinfo_index_db);
+    }
+
+  /* Only now, the index becomes usable. */
+  SVN_ERR(set_coverage(ffd->mergeinfo_index_db, youngest));
+
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_fs_fs__build_mergeinfo_index(svn_fs_t *fs,
+                                 svn_fs_progress_notify_func_t progress_func,
+                                 void *progress_baton,
+                                 svn_cancel_func_t cancel_func,
+                                 void *cancel_baton,
+                                 apr_pool_t *pool)
+{
+  build_mergeinfo_index_baton_t baton;
+
+  /* Older formats don't track mergeinfo in the node-revisions. */
+  if (!svn_fs_fs__fs_supports_mergeinfo(fs))
+    return svn_error_createf(SVN_ERR_UNSUPPORTED_FEATURE, NULL,
+             _("FSFS format (%d) too old for a mergeinfo index; "
+               "please upgrade the filesystem."),
+             ((fs_fs_data_t *)fs->fsap_data)->format);
+
+  baton.fs = fs;
+  baton.progress_func = progress_func;
+  baton.progress_baton = progress_baton;
+  baton.cancel_func = cancel_func;
+  baton.cancel_baton = cancel_baton;
+
+  return svn_error_trace(svn_fs_fs__with_write_lock(fs,
+                                                    build_mergeinfo_index_body,
+                                                    &baton, pool));
+}
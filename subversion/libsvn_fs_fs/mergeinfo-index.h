@@ -0,0 +1,82 @@
+/* mergeinfo-index.h : interface to the FSFS mergeinfo index
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+#ifndef SVN_LIBSVN_FS_FS_MERGEINFO_INDEX_H
+#define SVN_LIBSVN_FS_FS_MERGEINFO_INDEX_H
+
+#include "svn_error.h"
+
+#include "fs.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+#define MERGEINFO_INDEX_DB_NAME   "mergeinfo-index.db"
+
+/* Set *PATHS to the sorted list of all paths (const char *) below PATH,
+   excluding PATH itself, that carry svn:mergeinfo in REVISION of FS.
+
+   If FS has no mergeinfo index or if that does not cover REVISION, set
+   *AVAILABLE to FALSE and leave *PATHS untouched.  Otherwise, set it
+   to TRUE.
+
+   Allocate *PATHS in RESULT_POOL and use SCRATCH_POOL for temporaries. */
+svn_error_t *
+svn_fs_fs__mergeinfo_index_get_descendants(svn_boolean_t *available,
+                                           apr_array_header_t **paths,
+                                           svn_fs_t *fs,
+                                           const char *path,
+                                           svn_revnum_t revision,
+                                           apr_pool_t *result_pool,
+                                           apr_pool_t *scratch_pool);
+
+/* If FS has a mergeinfo index that covers all revisions before REVISION,
+   add the mergeinfo changes caused by CHANGED_PATHS (mapping paths to
+   svn_fs_path_change2_t *) in REVISION to it.  Otherwise, this is a no-op.
+   The node-revisions referenced by CHANGED_PATHS must still be readable.
+
+   This must be called with the FS write lock held while committing
+   REVISION.  Use SCRATCH_POOL for temporary allocations. */
+svn_error_t *
+svn_fs_fs__mergeinfo_index_add_revision(svn_fs_t *fs,
+                                        svn_revnum_t revision,
+                                        apr_hash_t *changed_paths,
+                                        apr_pool_t *scratch_pool);
+
+/* Create or re-create the mergeinfo index of FS such that it covers all
+   revisions.  Takes out the FS write lock.  Call PROGRESS_FUNC with
+   PROGRESS_BATON for each revision, if not NULL.  Use POOL for
+   temporary allocations. */
+svn_error_t *
+svn_fs_fs__build_mergeinfo_index(svn_fs_t *fs,
+                                 svn_fs_progress_notify_func_t progress_func,
+                                 void *progress_baton,
+                                 svn_cancel_func_t cancel_func,
+                                 void *cancel_baton,
+                                 apr_pool_t *pool);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* SVN_LIBSVN_FS_FS_MERGEINFO_INDEX_H */
@@ -38,6 +38,7 @@
 #include "index.h"
 #include "low_level.h"
 #include "revprops.h"
+#include "revprop-index.h"
 #include "transaction.h"
 
 #include "../libsvn_fs/fs-loader.h"
@@ -2136,7 +2137,11 @@ svn_fs_fs__pack(svn_fs_t *fs,
                             ffd->min_unpacked_rev / ffd->max_files_per_dir,
                             svn_fs_pack_notify_noop, pool));
 
-      return SVN_NO_ERROR;
+      /* The revprop index may still need to be created or completed. */
+      return svn_error_trace(svn_fs_fs__revprop_index_update(fs,
+                                                             cancel_func,
+                                                             cancel_baton,
+                                                             pool));
     }
 
   /* Lock the repo and start the pack process. */
@@ -2163,6 +2168,12 @@ svn_fs_fs__pack(svn_fs_t *fs,
       /* Use the global write lock for older repos. */
       err = svn_fs_fs__with_write_lock(fs, pack_body, &pb, pool);
     }
-
-  return svn_error_trace(err);
+  SVN_ERR(err);
+
+  /* Creating the revprop index reads all revprops, so do it as part of
+     the pack process, after the revprops of all complete shards have
+     been packed. */
+  return svn_error_trace(svn_fs_fs__revprop_index_update(fs, cancel_func,
+                                                         cancel_baton,
+                                                         pool));
 }
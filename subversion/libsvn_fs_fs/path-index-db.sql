@@ -0,0 +1,116 @@
+/* path-index-db.sql -- schema of the per-path change index
+ *   This is intended for use with SQLite 3
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+-- STMT_CREATE_SCHEMA
+/* All paths changed in a given revision.  Besides the actual changes
+   (KIND being a svn_fs_path_change_kind_t), there is a "modify" entry for
+   each parent directory of a changed path, except for the root, as those
+   get a new node-revision in that revision as well.  COPYFROM_* are only
+   set for additions and replacements with history. */
+CREATE TABLE path_changes (
+  path TEXT NOT NULL,
+  revision INTEGER NOT NULL,
+  kind INTEGER NOT NULL,
+  copyfrom_path TEXT,
+  copyfrom_rev INTEGER,
+  PRIMARY KEY (path, revision)
+  );
+
+/* Subset of PATH_CHANGES containing only additions and replacements.
+   Used to quickly find the copy operations that affected a sub-path. */
+CREATE TABLE path_adds (
+  path TEXT NOT NULL,
+  revision INTEGER NOT NULL,
+  copyfrom_path TEXT,
+  copyfrom_rev INTEGER,
+  PRIMARY KEY (path, revision)
+  );
+
+/* Single row table.  All revisions up to and including REVISION have been
+   added to the index. */
+CREATE TABLE coverage (
+  revision INTEGER NOT NULL
+  );
+
+INSERT INTO coverage (revision) VALUES (-1);
+
+PRAGMA USER_VERSION = 1;
+
+-- STMT_GET_COVERAGE
+SELECT revision
+FROM coverage
+
+-- STMT_SET_COVERAGE
+UPDATE coverage
+SET revision = ?1
+
+-- STMT_SET_CHANGE
+INSERT OR REPLACE INTO path_changes (path, revision, kind, copyfrom_path,
+                                     copyfrom_rev)
+VALUES (?1, ?2, ?3, ?4, ?5)
+
+-- STMT_SET_PARENT_CHANGE
+/* Don't overwrite actual changes to the directory itself. */
+INSERT OR IGNORE INTO path_changes (path, revision, kind)
+VALUES (?1, ?2, 0)
+
+-- STMT_SET_ADD
+INSERT OR REPLACE INTO path_adds (path, revision, copyfrom_path,
+                                  copyfrom_rev)
+VALUES (?1, ?2, ?3, ?4)
+
+-- STMT_GET_LATEST_CHANGE
+SELECT revision, kind, copyfrom_path, copyfrom_rev
+FROM path_changes
+WHERE path = ?1 AND revision <= ?2
+ORDER BY revision DESC
+LIMIT 1
+
+-- STMT_GET_LATEST_ADD
+SELECT revision, copyfrom_path, copyfrom_rev
+FROM path_adds
+WHERE path = ?1 AND revision <= ?2
+ORDER BY revision DESC
+LIMIT 1
+
+-- STMT_GET_FIRST_DELETION
+/* KIND 2 is svn_fs_path_change_delete and 3 is svn_fs_path_change_replace. */
+SELECT revision
+FROM path_changes
+WHERE path = ?1 AND revision > ?2 AND revision <= ?3 AND kind IN (2, 3)
+ORDER BY revision
+LIMIT 1
+
+-- STMT_DEL_CHANGES_FROM_REV
+DELETE FROM path_changes
+WHERE revision >= ?1
+
+-- STMT_DEL_ADDS_FROM_REV
+DELETE FROM path_adds
+WHERE revision >= ?1
+
+-- STMT_CLEAR
+/* Invalidate the index before touching its contents. */
+UPDATE coverage SET revision = -1;
+DELETE FROM path_changes;
+DELETE FROM path_adds;
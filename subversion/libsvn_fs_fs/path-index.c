@@ -0,0 +1,648 @@
+/* path-index.c --- per-path change index for fsfs
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+#include "svn_pools.h"
+
+#include "svn_private_config.h"
+
+#include "fs_fs.h"
+#include "fs.h"
+#include "path-index.h"
+#include "transaction.h"
+#include "util.h"
+#include "../libsvn_fs/fs-loader.h"
+
+#include "svn_dirent_uri.h"
+#include "svn_hash.h"
+
+#include "private/svn_fspath.h"
+#include "private/svn_sqlite.h"
+
+#include "path-index-db.h"
+
+PATH_INDEX_DB_SQL_DECLARE_STATEMENTS(statements);
+
+
+
+/** Helper functions. **/
+static APR_INLINE const char *
+path_path_index_db(const char *fs_path,
+                   apr_pool_t *result_pool)
+{
+  return svn_dirent_join(fs_path, PATH_INDEX_DB_NAME, result_pool);
+}
+
+/* Make sure FS->FSAP_DATA->PATH_INDEX_DB is open, if the path index of FS
+   exists.  Create it if it does not exist and CREATE is set.  Use
+   SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+open_path_index(svn_fs_t *fs,
+                svn_boolean_t create,
+                apr_pool_t *scratch_pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+  svn_sqlite__db_t *sdb;
+  const char *db_path;
+  svn_node_kind_t kind;
+  int version;
+
+  if (ffd->path_index_db)
+    return SVN_NO_ERROR;
+
+  /* The path index is optional.  Don't create it as a side-effect of
+     simply trying to use it. */
+  db_path = path_path_index_db(fs->path, scratch_pool);
+  SVN_ERR(svn_io_check_path(db_path, &kind, scratch_pool));
+  if (kind == svn_node_none && !create)
+    return SVN_NO_ERROR;
+
+#ifndef WIN32
+  if (kind == svn_node_none)
+    {
+      /* Extend the repository permissions to the new database, just like
+         we do for the rep-cache. */
+      svn_error_t *err = svn_io_file_create_empty(db_path, scratch_pool);
+
+      if (err && !APR_STATUS_IS_EEXIST(err->apr_err))
+        return svn_error_trace(err);
+      else if (err)
+        svn_error_clear(err);
+      else
+        SVN_ERR(svn_io_copy_perms(svn_fs_fs__path_current(fs, scratch_pool),
+                                  db_path, scratch_pool));
+    }
+#endif
+
+  SVN_ERR(svn_sqlite__open(&sdb, db_path,
+                           svn_sqlite__mode_rwcreate, statements,
+                           0, NULL, 0,
+                           fs->pool, scratch_pool));
+
+  SVN_SQLITE__ERR_CLOSE(svn_sqlite__read_schema_version(&version, sdb,
+                                                        scratch_pool),
+                        sdb);
+  if (version <= 0)
+    {
+      if (create)
+        {
+          SVN_SQLITE__ERR_CLOSE(svn_sqlite__exec_statements(
+                                  sdb, STMT_CREATE_SCHEMA),
+                                sdb);
+        }
+      else
+        {
+          /* Someone else is just creating it.  Ignore it for now. */
+          return svn_error_trace(svn_sqlite__close(sdb));
+        }
+    }
+
+  ffd->path_index_db = sdb;
+
+  return SVN_NO_ERROR;
+}
+
+/* Set *REVISION to the youngest revision covered by the path index SDB. */
+static svn_error_t *
+get_coverage(svn_revnum_t *revision,
+             svn_sqlite__db_t *sdb)
+{
+  svn_sqlite__stmt_t *stmt;
+  svn_boolean_t have_row;
+
+  SVN_ERR(svn_sqlite__get_statement(&stmt, sdb, STMT_GET_COVERAGE));
+  SVN_ERR(svn_sqlite__step(&have_row, stmt));
+  *revision = have_row ? svn_sqlite__column_revnum(stmt, 0)
+                       : SVN_INVALID_REVNUM;
+
+  return svn_error_trace(svn_sqlite__reset(stmt));
+}
+
+/* Set the youngest revision covered by the path index SDB to REVISION. */
+static svn_error_t *
+set_coverage(svn_sqlite__db_t *sdb,
+             svn_revnum_t revision)
+{
+  svn_sqlite__stmt_t *stmt;
+
+  SVN_ERR(svn_sqlite__get_statement(&stmt, sdb, STMT_SET_COVERAGE));
+  SVN_ERR(svn_sqlite__bindf(stmt, "r", revision));
+
+  return svn_error_trace(svn_sqlite__update(NULL, stmt));
+}
+
+/* Add the CHANGED_PATHS (mapping paths to svn_fs_path_change2_t *) of
+   REVISION to the path index SDB.  Use SCRATCH_POOL for temporaries. */
+static svn_error_t *
+add_changes(svn_sqlite__db_t *sdb,
+            svn_revnum_t revision,
+            apr_hash_t *changed_paths,
+            apr_pool_t *scratch_pool)
+{
+  apr_hash_t *parents = apr_hash_make(scratch_pool);
+  apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+  apr_hash_index_t *hi;
+  svn_sqlite__stmt_t *stmt;
+
+  for (hi = apr_hash_first(scratch_pool, changed_paths);
+       hi;
+       hi = apr_hash_next(hi))
+    {
+      const char *path = apr_hash_this_key(hi);
+      svn_fs_path_change2_t *change = apr_hash_this_val(hi);
+      const char *copyfrom_path = NULL;
+      svn_revnum_t copyfrom_rev = SVN_INVALID_REVNUM;
+      const char *parent;
+
+      svn_pool_clear(iterpool);
+
+      if (   change->copyfrom_known
+          && change->copyfrom_path
+          && SVN_IS_VALID_REVNUM(change->copyfrom_rev))
+        {
+          copyfrom_path = change->copyfrom_path;
+          copyfrom_rev = change->copyfrom_rev;
+        }
+
+      SVN_ERR(svn_sqlite__get_statement(&stmt, sdb, STMT_SET_CHANGE));
+      SVN_ERR(svn_sqlite__bindf(stmt, "srdsr", path, revision,
+                                (int)change->change_kind,
+                                copyfrom_path, copyfrom_rev));
+      SVN_ERR(svn_sqlite__insert(NULL, stmt));
+
+      if (   change->change_kind == svn_fs_path_change_add
+          || change->change_kind == svn_fs_path_change_replace)
+        {
+          SVN_ERR(svn_sqlite__get_statement(&stmt, sdb, STMT_SET_ADD));
+          SVN_ERR(svn_sqlite__bindf(stmt, "srsr", path, revision,
+                                    copyfrom_path, copyfrom_rev));
+          SVN_ERR(svn_sqlite__insert(NULL, stmt));
+        }
+
+      /* All parents got modified as well.  The root gets modified in
+         every revision, so there is no point in recording it. */
+      for (parent = svn_fspath__dirname(path, iterpool);
+           strcmp(parent, "/") && !svn_hash_gets(parents, parent);
+           parent = svn_fspath__dirname(parent, iterpool))
+        {
+          svn_hash_sets(parents, apr_pstrdup(scratch_pool, parent), parent);
+
+          SVN_ERR(svn_sqlite__get_statement(&stmt, sdb,
+                                            STMT_SET_PARENT_CHANGE));
+          SVN_ERR(svn_sqlite__bindf(stmt, "sr", parent, revision));
+          SVN_ERR(svn_sqlite__insert(NULL, stmt));
+        }
+    }
+
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
+
+/** Public API. **/
+
+svn_error_t *
+svn_fs_fs__path_index_get_latest(svn_boolean_t *available,
+                                 svn_fs_fs__path_index_change_t **change,
+                                 svn_fs_t *fs,
+                                 const char *path,
+                                 svn_revnum_t revision,
+                                 apr_pool_t *result_pool,
+                                 apr_pool_t *scratch_pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+  svn_fs_fs__path_index_change_t *result;
+  svn_sqlite__stmt_t *stmt;
+  svn_boolean_t have_row;
+  svn_revnum_t covered;
+  svn_revnum_t own_rev = SVN_INVALID_REVNUM;
+  svn_fs_path_change_kind_t own_kind = svn_fs_path_change_modify;
+  const char *own_copyfrom_path = NULL;
+  svn_revnum_t own_copyfrom_rev = SVN_INVALID_REVNUM;
+  svn_revnum_t parent_rev = SVN_INVALID_REVNUM;
+  const char *parent_path = NULL;
+  const char *parent_copyfrom_path = NULL;
+  svn_revnum_t parent_copyfrom_rev = SVN_INVALID_REVNUM;
+  const char *parent;
+
+  *available = FALSE;
+
+  SVN_ERR(open_path_index(fs, FALSE, scratch_pool));
+  if (!ffd->path_index_db)
+    return SVN_NO_ERROR;
+
+  SVN_ERR(get_coverage(&covered, ffd->path_index_db));
+  if (!SVN_IS_VALID_REVNUM(covered) || covered < revision)
+    return SVN_NO_ERROR;
+
+  *available = TRUE;
+
+  /* Latest change to PATH itself or any of its sub-paths. */
+  SVN_ERR(svn_sqlite__get_statement(&stmt, ffd->path_index_db,
+                                    STMT_GET_LATEST_CHANGE));
+  SVN_ERR(svn_sqlite__bindf(stmt, "sr", path, revision));
+  SVN_ERR(svn_sqlite__step(&have_row, stmt));
+  if (have_row)
+    {
+      own_rev = svn_sqlite__column_revnum(stmt, 0);
+      own_kind = svn_sqlite__column_int(stmt, 1);
+      own_copyfrom_path = svn_sqlite__column_text(stmt, 2, scratch_pool);
+      own_copyfrom_rev = svn_sqlite__column_revnum(stmt, 3);
+    }
+  SVN_ERR(svn_sqlite__reset(stmt));
+
+  /* Latest addition or replacement of any parent.  On equal revisions,
+     the deepest parent wins. */
+  for (parent = svn_fspath__dirname(path, scratch_pool);
+       strcmp(parent, "/");
+       parent = svn_fspath__dirname(parent, scratch_pool))
+    {
+      SVN_ERR(svn_sqlite__get_statement(&stmt, ffd->path_index_db,
+                                        STMT_GET_LATEST_ADD));
+      SVN_ERR(svn_sqlite__bindf(stmt, "sr", parent, revision));
+      SVN_ERR(svn_sqlite__step(&have_row, stmt));
+      if (have_row && svn_sqlite__column_revnum(stmt, 0) > parent_rev)
+        {
+          parent_rev = svn_sqlite__column_revnum(stmt, 0);
+          parent_path = parent;
+          parent_copyfrom_path = svn_sqlite__column_text(stmt, 1,
+                                                         scratch_pool);
+          parent_copyfrom_rev = svn_sqlite__column_revnum(stmt, 2);
+        }
+      SVN_ERR(svn_sqlite__reset(stmt));
+    }
+
+  /* Not found or deleted? */
+  if (   (!SVN_IS_VALID_REVNUM(own_rev) && !SVN_IS_VALID_REVNUM(parent_rev))
+      || (own_rev >= parent_rev && own_kind == svn_fs_path_change_delete))
+    {
+      *change = NULL;
+      return SVN_NO_ERROR;
+    }
+
+  result = apr_pcalloc(result_pool, sizeof(*result));
+  result->copyfrom_rev = SVN_INVALID_REVNUM;
+
+  /* Changes to PATH itself take precedence over the parent's, e.g. for
+     a file that got replaced within a copied directory. */
+  if (   own_rev >= parent_rev
+      && (   own_kind == svn_fs_path_change_add
+          || own_kind == svn_fs_path_change_replace))
+    {
+      result->revision = own_rev;
+      if (own_copyfrom_path && SVN_IS_VALID_REVNUM(own_copyfrom_rev))
+        {
+          result->copyfrom_path = apr_pstrdup(result_pool,
+                                              own_copyfrom_path);
+          result->copyfrom_rev = own_copyfrom_rev;
+        }
+      else
+        {
+          result->is_origin = TRUE;
+        }
+    }
+  else if (parent_rev >= own_rev)
+    {
+      result->revision = parent_rev;
+      if (parent_copyfrom_path && SVN_IS_VALID_REVNUM(parent_copyfrom_rev))
+        {
+          result->copyfrom_path
+            = svn_fspath__join(parent_copyfrom_path,
+                               svn_fspath__skip_ancestor(parent_path, path),
+                               result_pool);
+          result->copyfrom_rev = parent_copyfrom_rev;
+        }
+      else
+        {
+          result->is_origin = TRUE;
+        }
+    }
+  else
+    {
+      /* Simple modification of PATH or its sub-tree. */
+      result->revision = own_rev;
+    }
+
+  *change = result;
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_fs_fs__path_index_deleted_rev(svn_boolean_t *available,
+                                  svn_revnum_t *deleted,
+                                  svn_fs_t *fs,
+                                  const char *path,
+                                  svn_revnum_t start,
+                                  svn_revnum_t end,
+                                  apr_pool_t *scratch_pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+  svn_sqlite__stmt_t *stmt;
+  svn_boolean_t have_row;
+  svn_revnum_t covered;
+  const char *parent;
+
+  *available = FALSE;
+
+  SVN_ERR(open_path_index(fs, FALSE, scratch_pool));
+  if (!ffd->path_index_db)
+    return SVN_NO_ERROR;
+
+  SVN_ERR(get_coverage(&covered, ffd->path_index_db));
+  if (!SVN_IS_VALID_REVNUM(covered) || covered < end)
+    return SVN_NO_ERROR;
+
+  *available = TRUE;
+  *deleted = SVN_INVALID_REVNUM;
+
+  /* PATH goes away with the first deletion or replacement of PATH itself
+     or any of its parents.  Narrow the search range as we go. */
+  for (parent = path;
+       strcmp(parent, "/");
+       parent = svn_fspath__dirname(parent, scratch_pool))
+    {
+      SVN_ERR(svn_sqlite__get_statement(&stmt, ffd->path_index_db,
+                                        STMT_GET_FIRST_DELETION));
+      SVN_ERR(svn_sqlite__bindf(stmt, "srr", parent, start, end));
+      SVN_ERR(svn_sqlite__step(&have_row, stmt));
+      if (have_row)
+        {
+          *deleted = svn_sqlite__column_revnum(stmt, 0);
+          end = *deleted - 1;
+        }
+      SVN_ERR(svn_sqlite__reset(stmt));
+    }
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_fs_fs__path_index_add_revision(svn_fs_t *fs,
+                                   svn_revnum_t revision,
+                                   apr_hash_t *changed_paths,
+                                   apr_pool_t *scratch_pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+  svn_sqlite__db_t *sdb;
+  svn_sqlite__stmt_t *stmt;
+  svn_revnum_t covered;
+  svn_error_t *err;
+
+  SVN_ERR(open_path_index(fs, FALSE, scratch_pool));
+  sdb = ffd->path_index_db;
+  if (!sdb)
+    return SVN_NO_ERROR;
+
+  SVN_ERR(svn_sqlite__begin_transaction(sdb));
+
+  /* If some commit did not update the index, it is incomplete and remains
+     unused until it gets rebuilt.  If an earlier attempt to commit
+     REVISION failed, we may have to remove its changes. */
+  err = get_coverage(&covered, sdb);
+  if (!err && SVN_IS_VALID_REVNUM(covered) && covered >= revision - 1)
+    {
+      if (covered >= revision)
+        {
+          err = svn_sqlite__get_statement(&stmt, sdb,
+                                          STMT_DEL_CHANGES_FROM_REV);
+          if (!err)
+            err = svn_sqlite__bindf(stmt, "r", revision);
+          if (!err)
+            err = svn_sqlite__update(NULL, stmt);
+          if (!err)
+            err = svn_sqlite__get_statement(&stmt, sdb,
+                                            STMT_DEL_ADDS_FROM_REV);
+          if (!err)
+            err = svn_sqlite__bindf(stmt, "r", revision);
+          if (!err)
+            err = svn_sqlite__update(NULL, stmt);
+        }
+
+      if (!err)
+        err = add_changes(sdb, revision, changed_paths, scratch_pool);
+      if (!err)
+        err = set_coverage(sdb, revision);
+    }
+
+  return svn_error_trace(svn_sqlite__finish_transaction(sdb, err));
+}
+
+/* Remove all data on revisions from REVISION onwards from the path index
+   SDB, add the CHANGED_PATHS of REVISION and mark it as covered.  Use
+   SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+replace_revision(svn_sqlite__db_t *sdb,
+                 svn_revnum_t revision,
+                 apr_hash_t *changed_paths,
+                 apr_pool_t *scratch_pool)
+{
+  svn_sqlite__stmt_t *stmt;
+
+  SVN_ERR(svn_sqlite__get_statement(&stmt, sdb, STMT_DEL_CHANGES_FROM_REV));
+  SVN_ERR(svn_sqlite__bindf(stmt, "r", revision));
+  SVN_ERR(svn_sqlite__update(NULL, stmt));
+  SVN_ERR(svn_sqlite__get_statement(&stmt, sdb, STMT_DEL_ADDS_FROM_REV));
+  SVN_ERR(svn_sqlite__bindf(stmt, "r", revision));
+  SVN_ERR(svn_sqlite__update(NULL, stmt));
+
+  SVN_ERR(add_changes(sdb, revision, changed_paths, scratch_pool));
+
+  return svn_error_trace(set_coverage(sdb, revision));
+}
+
+svn_error_t *
+svn_fs_fs__update_path_index(svn_boolean_t *updated,
+                             svn_fs_t *fs,
+                             svn_revnum_t start_rev,
+                             svn_revnum_t end_rev,
+                             svn_cancel_func_t cancel_func,
+                             void *cancel_baton,
+                             apr_pool_t *scratch_pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+  apr_pool_t *iterpool;
+  svn_revnum_t covered;
+  svn_revnum_t rev;
+
+  *updated = FALSE;
+
+  SVN_ERR(open_path_index(fs, FALSE, scratch_pool));
+  if (!ffd->path_index_db)
+    return SVN_NO_ERROR;
+
+  SVN_ERR(get_coverage(&covered, ffd->path_index_db));
+  if (!SVN_IS_VALID_REVNUM(covered) || covered < start_rev - 1)
+    {
+      /* Let the caller replace the database file. */
+      SVN_ERR(svn_sqlite__close(ffd->path_index_db));
+      ffd->path_index_db = NULL;
+
+      return SVN_NO_ERROR;
+    }
+
+  iterpool = svn_pool_create(scratch_pool);
+  for (rev = start_rev; rev <= end_rev; ++rev)
+    {
+      apr_hash_t *changed_paths;
+
+      svn_pool_clear(iterpool);
+
+      if (cancel_func)
+        SVN_ERR(cancel_func(cancel_baton));
+
+      SVN_ERR(svn_fs_fs__paths_changed(&changed_paths, fs, rev, iterpool));
+      SVN_SQLITE__WITH_TXN(
+        replace_revision(ffd->path_index_db, rev, changed_paths, iterpool),
+        ffd->path_index_db);
+    }
+
+  svn_pool_destroy(iterpool);
+  *updated = TRUE;
+
+  return SVN_NO_ERROR;
+}
+
+/* Number of revisions to add to the index while holding the write lock
+   once.  Releasing it in between allows for commits to proceed while the
+   index is being rebuilt. */
+#define BUILD_BATCH_SIZE 1000
+
+/* Baton type used when building the path index. */
+typedef struct build_path_index_baton_t
+{
+  svn_fs_t *fs;
+  svn_fs_progress_notify_func_t progress_func;
+  void *progress_baton;
+  svn_cancel_func_t cancel_func;
+  void *cancel_baton;
+
+  /* Set once the old index contents have been removed. */
+  svn_boolean_t cleared;
+
+  /* Set once the index covers all revisions. */
+  svn_boolean_t done;
+} build_path_index_baton_t;
+
+/* Add the CHANGED_PATHS of REVISION to the path index SDB and mark it as
+   covered.  Use SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+append_revision(svn_sqlite__db_t *sdb,
+                svn_revnum_t revision,
+                apr_hash_t *changed_paths,
+                apr_pool_t *scratch_pool)
+{
+  SVN_ERR(add_changes(sdb, revision, changed_paths, scratch_pool));
+
+  return svn_error_trace(set_coverage(sdb, revision));
+}
+
+/* Body of svn_fs_fs__build_path_index, to be called with the write lock
+   held.  Clear the index upon the first call and add up to
+   BUILD_BATCH_SIZE further revisions to it.  BATON is a
+   build_path_index_baton_t. */
+static svn_error_t *
+build_path_index_body(void *baton,
+                      apr_pool_t *pool)
+{
+  build_path_index_baton_t *b = baton;
+  fs_fs_data_t *ffd = b->fs->fsap_data;
+  apr_pool_t *iterpool;
+  svn_revnum_t youngest;
+  svn_revnum_t covered;
+  svn_revnum_t first_rev;
+  svn_revnum_t rev;
+
+  SVN_ERR(svn_fs_fs__youngest_rev(&youngest, b->fs, pool));
+  SVN_ERR(open_path_index(b->fs, TRUE, pool));
+
+  /* Start from scratch.  Readers will only use the index for revisions
+     that we have already covered. */
+  if (!b->cleared)
+    {
+      SVN_SQLITE__WITH_TXN(
+        svn_sqlite__exec_statements(ffd->path_index_db, STMT_CLEAR),
+        ffd->path_index_db);
+      b->cleared = TRUE;
+    }
+
+  /* Commits between our batches don't update the index, so simply
+     continue where the previous batch stopped. */
+  SVN_ERR(get_coverage(&covered, ffd->path_index_db));
+  first_rev = SVN_IS_VALID_REVNUM(covered) ? covered + 1 : 0;
+  if (youngest >= first_rev + BUILD_BATCH_SIZE)
+    youngest = first_rev + BUILD_BATCH_SIZE - 1;
+  else
+    b->done = TRUE;
+
+  iterpool = svn_pool_create(pool);
+  for (rev = first_rev; rev <= youngest; ++rev)
+    {
+      apr_hash_t *changed_paths;
+
+      svn_pool_clear(iterpool);
+
+      if (b->cancel_func)
+        SVN_ERR(b->cancel_func(b->cancel_baton));
+      if (b->progress_func)
+        b->progress_func(rev, b->progress_baton, iterpool);
+
+      SVN_ERR(svn_fs_fs__paths_changed(&changed_paths, b->fs, rev,
+                                       iterpool));
+      SVN_SQLITE__WITH_TXN(
+        append_revision(ffd->path_index_db, rev, changed_paths, iterpool),
+        ffd->path_index_db);
+    }
+
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_fs_fs__build_path_index(svn_fs_t *fs,
+                            svn_fs_progress_notify_func_t progress_func,
+                            void *progress_baton,
+                            svn_cancel_func_t cancel_func,
+                            void *cancel_baton,
+                            apr_pool_t *pool)
+{
+  build_path_index_baton_t baton = { 0 };
+  apr_pool_t *iterpool;
+
+  baton.fs = fs;
+  baton.progress_func = progress_func;
+  baton.progress_baton = progress_baton;
+  baton.cancel_func = cancel_func;
+  baton.cancel_baton = cancel_baton;
+
+  iterpool = svn_pool_create(pool);
+  while (!baton.done)
+    {
+      svn_pool_clear(iterpool);
+      SVN_ERR(svn_fs_fs__with_write_lock(fs, build_path_index_body, &baton,
+                                         iterpool));
+    }
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
@@ -0,0 +1,137 @@
+/* path-index.h : interface to the per-path change index
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+#ifndef SVN_LIBSVN_FS_FS_PATH_INDEX_H
+#define SVN_LIBSVN_FS_FS_PATH_INDEX_H
+
+#include "svn_error.h"
+
+#include "fs.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+#define PATH_INDEX_DB_NAME        "path-index.db"
+
+/* The latest change affecting a given path, as found in the path index. */
+typedef struct svn_fs_fs__path_index_change_t
+{
+  /* The revision in which the change happened. */
+  svn_revnum_t revision;
+
+  /* If the path got copied in REVISION, either directly or as part of a
+     parent directory, this is the location that it got copied from.
+     NULL and SVN_INVALID_REVNUM otherwise. */
+  const char *copyfrom_path;
+  svn_revnum_t copyfrom_rev;
+
+  /* TRUE if the path has been added without history in REVISION, i.e.
+     this is the start of its history. */
+  svn_boolean_t is_origin;
+} svn_fs_fs__path_index_change_t;
+
+/* Set *CHANGE to the latest change at or before REVISION that affected
+   PATH in FS, either directly, through a change to one of its sub-paths
+   or through a copy of one of its parents.  Set it to NULL if PATH did
+   not exist in REVISION.
+
+   If FS has no path index or if that does not cover REVISION, set
+   *AVAILABLE to FALSE and leave *CHANGE untouched.  Otherwise, set it
+   to TRUE.
+
+   Allocate *CHANGE in RESULT_POOL and use SCRATCH_POOL for temporaries. */
+svn_error_t *
+svn_fs_fs__path_index_get_latest(svn_boolean_t *available,
+                                 svn_fs_fs__path_index_change_t **change,
+                                 svn_fs_t *fs,
+                                 const char *path,
+                                 svn_revnum_t revision,
+                                 apr_pool_t *result_pool,
+                                 apr_pool_t *scratch_pool);
+
+/* Set *DELETED to the first revision after START and up to and including
+   END in which PATH in FS got deleted or replaced, either directly or
+   through one of its parents.  Set it to SVN_INVALID_REVNUM if there is
+   no such revision.  PATH must exist in START.
+
+   If FS has no path index or if that does not cover END, set *AVAILABLE
+   to FALSE and leave *DELETED untouched.  Otherwise, set it to TRUE.
+   Use SCRATCH_POOL for temporary allocations. */
+svn_error_t *
+svn_fs_fs__path_index_deleted_rev(svn_boolean_t *available,
+                                  svn_revnum_t *deleted,
+                                  svn_fs_t *fs,
+                                  const char *path,
+                                  svn_revnum_t start,
+                                  svn_revnum_t end,
+                                  apr_pool_t *scratch_pool);
+
+/* If FS has a path index that covers all revisions before REVISION, add
+   CHANGED_PATHS (mapping paths to svn_fs_path_change2_t *) as the
+   changes of REVISION to it.  Otherwise, this is a no-op.
+
+   This must be called with the FS write lock held while committing
+   REVISION.  Use SCRATCH_POOL for temporary allocations. */
+svn_error_t *
+svn_fs_fs__path_index_add_revision(svn_fs_t *fs,
+                                   svn_revnum_t revision,
+                                   apr_hash_t *changed_paths,
+                                   apr_pool_t *scratch_pool);
+
+/* If FS has a path index that covers all revisions before START_REV, add
+   the changes of revisions START_REV to END_REV to it, replacing any data
+   it may already have on those, and set *UPDATED to TRUE.  Otherwise, set
+   *UPDATED to FALSE and close the index database such that the caller may
+   replace it.
+
+   This is meant for incremental hotcopies, where START_REV to END_REV
+   have just been copied into FS.  The caller must hold the FS write lock.
+   Use SCRATCH_POOL for temporary allocations. */
+svn_error_t *
+svn_fs_fs__update_path_index(svn_boolean_t *updated,
+                             svn_fs_t *fs,
+                             svn_revnum_t start_rev,
+                             svn_revnum_t end_rev,
+                             svn_cancel_func_t cancel_func,
+                             void *cancel_baton,
+                             apr_pool_t *scratch_pool);
+
+/* Create or re-create the path index of FS such that it covers all
+   revisions.  Takes out the FS write lock for every batch of revisions
+   added, such that commits may proceed in between.  Readers may use the
+   index for the revisions covered so far.  Call PROGRESS_FUNC with
+   PROGRESS_BATON for each revision, if not NULL.  Use POOL for
+   temporary allocations. */
+svn_error_t *
+svn_fs_fs__build_path_index(svn_fs_t *fs,
+                            svn_fs_progress_notify_func_t progress_func,
+                            void *progress_baton,
+                            svn_cancel_func_t cancel_func,
+                            void *cancel_baton,
+                            apr_pool_t *pool);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* SVN_LIBSVN_FS_FS_PATH_INDEX_H */
@@ -0,0 +1,802 @@
+/* redeltify.c --- rebalancing of FSFS delta chains
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+#include "svn_pools.h"
+#include "svn_hash.h"
+#include "svn_dirent_uri.h"
+#include "svn_sorts.h"
+
+#include "svn_private_config.h"
+
+#include "fs_fs.h"
+#include "cached_data.h"
+#include "id.h"
+#include "index.h"
+#include "low_level.h"
+#include "redeltify.h"
+#include "rev_file.h"
+#include "transaction.h"
+#include "util.h"
+#include "../libsvn_fs/fs-loader.h"
+
+#include "private/svn_sorts_private.h"
+#include "private/svn_subr_private.h"
+
+/* Packed shards in a log-addressed repository cannot be modified in place
+ * because representation and noderev sizes are recorded in other items,
+ * possibly in other shards.  We therefore keep the existing pack contents
+ * as they are and append the new data to a copy of them:
+ *
+ * - Every file representation whose delta chain is too long gets a new
+ *   item index within the revision of the noderev referencing it.  Its
+ *   fulltext is the same but it is stored as a delta against a closer
+ *   base, i.e. with a bounded chain.
+ *
+ * - Noderevs that referenced the old reps are appended with the same
+ *   item index as before, i.e. they replace the old noderevs.  The old
+ *   noderev data stays where it was but gets assigned a new, unused item
+ *   index.  That keeps the index data consistent and all old items valid,
+ *   so that caches and readers that still see the old pack file will
+ *   continue to get the right contents.
+ *
+ * Since all new reps are placed in the same shard as their noderevs and
+ * all delta bases are older than the reps, processing the shards from
+ * the youngest to the oldest means that we only ever read from shards
+ * that have not been modified, yet.
+ */
+
+/* A new representation written by this code.
+ */
+typedef struct new_rep_t
+{
+  /* The representation as it will be referenced by the noderevs. */
+  representation_t *rep;
+
+  /* The length of its delta chain, including itself. */
+  int chain_length;
+} new_rep_t;
+
+/* State while rewriting a single pack file.
+ */
+typedef struct shard_context_t
+{
+  /* The repository. */
+  svn_fs_t *fs;
+
+  /* First revision in the shard. */
+  svn_revnum_t shard_rev;
+
+  /* Limit for the delta chain lengths. */
+  int max_chain_length;
+
+  /* The pack file as it is on disk now. */
+  svn_fs_fs__revision_file_t *rev_file;
+
+  /* Path of the pack file and of its modified copy. */
+  const char *pack_path;
+  const char *temp_path;
+
+  /* The modified copy being written.  NULL until we modify anything. */
+  apr_file_t *file;
+
+  /* P2L index entries of the modified copy, i.e. all entries of the
+   * original pack file followed by the entries that we appended, in
+   * offset order.  Elements are svn_fs_fs__p2l_entry_t *. */
+  apr_array_header_t *entries;
+
+  /* For each revision in the shard, the first unused item index. */
+  apr_uint64_t *next_item;
+
+  /* Maps the keys of reps with too long delta chains (see rep_key) to
+   * the new_rep_t * replacing them. */
+  apr_hash_t *new_reps;
+
+  /* Counters to report back to the caller. */
+  apr_int64_t rep_count;
+  apr_int64_t noderev_count;
+
+  /* Cancellation support. */
+  svn_cancel_func_t cancel_func;
+  void *cancel_baton;
+
+  /* Pool to allocate all of the above from. */
+  apr_pool_t *pool;
+} shard_context_t;
+
+/* Return a key identifying the on-disk location of REP.
+ * Allocate it in RESULT_POOL. */
+static const char *
+rep_key(const representation_t *rep,
+        apr_pool_t *result_pool)
+{
+  return apr_psprintf(result_pool, "%ld/%" APR_UINT64_T_FMT,
+                      rep->revision, rep->item_index);
+}
+
+/* Return the next unused item index in REVISION and reserve it. */
+static apr_uint64_t
+allocate_item(shard_context_t *context,
+              svn_revnum_t revision)
+{
+  return context->next_item[revision - context->shard_rev]++;
+}
+
+/* Read all P2L index entries of CONTEXT->REV_FILE into CONTEXT->ENTRIES
+ * and determine the first unused item index for each revision.
+ * Use SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+read_entries(shard_context_t *context,
+             apr_pool_t *scratch_pool)
+{
+  fs_fs_data_t *ffd = context->fs->fsap_data;
+  apr_off_t offset, max_offset;
+  apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+  int i;
+
+  SVN_ERR(svn_fs_fs__p2l_get_max_offset(&max_offset, context->fs,
+                                        context->rev_file,
+                                        context->shard_rev, scratch_pool));
+
+  for (offset = 0; offset < max_offset; )
+    {
+      apr_array_header_t *entries;
+
+      svn_pool_clear(iterpool);
+      SVN_ERR(svn_fs_fs__p2l_index_lookup(&entries, context->fs,
+                                          context->rev_file,
+                                          context->shard_rev, offset,
+                                          ffd->p2l_page_size,
+                                          iterpool, iterpool));
+
+      for (i = 0; i < entries->nelts && offset < max_offset; ++i)
+        {
+          const svn_fs_fs__p2l_entry_t *entry
+            = &APR_ARRAY_IDX(entries, i, const svn_fs_fs__p2l_entry_t);
+
+          /* Skip entries that we already got from the previous block. */
+          if (entry->offset < offset)
+            continue;
+
+          offset = entry->offset + entry->size;
+          APR_ARRAY_PUSH(context->entries, svn_fs_fs__p2l_entry_t *)
+            = apr_pmemdup(context->pool, entry, sizeof(*entry));
+
+          if (   entry->type != SVN_FS_FS__ITEM_TYPE_UNUSED
+              && entry->item.revision >= context->shard_rev
+              && entry->item.revision - context->shard_rev
+                   < ffd->max_files_per_dir)
+            {
+              apr_uint64_t *next
+                = &context->next_item[entry->item.revision
+                                      - context->shard_rev];
+              *next = MAX(*next, entry->item.number + 1);
+            }
+        }
+    }
+
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
+/* A svn_sort__array compatible comparator function, sorting the
+ * svn_fs_fs__p2l_entry_t** given in LHS, RHS by item. */
+static int
+compare_p2l_entry_item(const void *lhs,
+                       const void *rhs)
+{
+  const svn_fs_fs__p2l_entry_t *lhs_entry
+    =*(const svn_fs_fs__p2l_entry_t *const *)lhs;
+  const svn_fs_fs__p2l_entry_t *rhs_entry
+    =*(const svn_fs_fs__p2l_entry_t *const *)rhs;
+
+  if (lhs_entry->item.revision != rhs_entry->item.revision)
+    return lhs_entry->item.revision < rhs_entry->item.revision ? -1 : 1;
+
+  if (lhs_entry->item.number != rhs_entry->item.number)
+    return lhs_entry->item.number < rhs_entry->item.number ? -1 : 1;
+
+  return 0;
+}
+
+/* Read the noderev described by ENTRY from the original pack file in
+ * CONTEXT and return it in *NODEREV.  Allocate it in RESULT_POOL and use
+ * SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+read_noderev(node_revision_t **noderev,
+             shard_context_t *context,
+             const svn_fs_fs__p2l_entry_t *entry,
+             apr_pool_t *result_pool,
+             apr_pool_t *scratch_pool)
+{
+  svn_stringbuf_t *contents;
+  apr_off_t offset = entry->offset;
+
+  contents = svn_stringbuf_create_ensure(entry->size, scratch_pool);
+  contents->len = entry->size;
+  SVN_ERR(svn_io_file_seek(context->rev_file->file, APR_SET, &offset,
+                           scratch_pool));
+  SVN_ERR(svn_io_file_read_full2(context->rev_file->file, contents->data,
+                                 contents->len, NULL, NULL, scratch_pool));
+  contents->data[contents->len] = 0;
+
+  SVN_ERR(svn_fs_fs__read_noderev(noderev,
+                                  svn_stream_from_stringbuf(contents,
+                                                            scratch_pool),
+                                  result_pool, scratch_pool));
+
+  return SVN_NO_ERROR;
+}
+
+/* Make sure that CONTEXT->FILE is open and positioned at the end of the
+ * original pack data.  Use SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+auto_open_copy(shard_context_t *context,
+               apr_pool_t *scratch_pool)
+{
+  apr_off_t offset = context->rev_file->l2p_offset;
+
+  if (context->file)
+    return SVN_NO_ERROR;
+
+  /* The copy lives next to the pack file such that we can rename it. */
+  SVN_ERR(svn_io_open_unique_file3(NULL, &context->temp_path,
+                                   svn_dirent_dirname(context->pack_path,
+                                                      scratch_pool),
+                                   svn_io_file_del_on_pool_cleanup,
+                                   context->pool, scratch_pool));
+  SVN_ERR(svn_io_copy_file(context->pack_path, context->temp_path, FALSE,
+                           scratch_pool));
+  SVN_ERR(svn_io_file_open(&context->file, context->temp_path,
+                           APR_READ | APR_WRITE | APR_BUFFERED,
+                           APR_OS_DEFAULT, context->pool));
+
+  /* Strip the index data. */
+  SVN_ERR(svn_io_file_trunc(context->file, offset, scratch_pool));
+  SVN_ERR(svn_io_file_seek(context->file, APR_SET, &offset, scratch_pool));
+
+  return SVN_NO_ERROR;
+}
+
+/* Return a new P2L index entry in *ENTRY for an item to be appended to
+ * CONTEXT->FILE and a stream in *STREAM to write its contents to.
+ * Closing that stream will set the entry's checksum.  Allocate the entry
+ * in CONTEXT->POOL and the stream in SCRATCH_POOL. */
+static svn_error_t *
+begin_item(svn_fs_fs__p2l_entry_t **entry,
+           svn_stream_t **stream,
+           shard_context_t *context,
+           apr_pool_t *scratch_pool)
+{
+  *entry = apr_pcalloc(context->pool, sizeof(**entry));
+  SVN_ERR(svn_io_file_get_offset(&(*entry)->offset, context->file,
+                                 scratch_pool));
+
+  *stream = svn_checksum__wrap_write_stream_fnv1a_32x4(
+                &(*entry)->fnv1_checksum,
+                svn_stream_from_aprfile2(context->file, TRUE, scratch_pool),
+                scratch_pool);
+
+  return SVN_NO_ERROR;
+}
+
+/* Finalize ENTRY of TYPE for ITEM_NUMBER in REVISION after its contents
+ * have been written to STREAM and add it to CONTEXT.  Use SCRATCH_POOL
+ * for temporary allocations. */
+static svn_error_t *
+end_item(shard_context_t *context,
+         svn_fs_fs__p2l_entry_t *entry,
+         svn_stream_t *stream,
+         apr_uint32_t type,
+         svn_revnum_t revision,
+         apr_uint64_t item_number,
+         apr_pool_t *scratch_pool)
+{
+  apr_off_t end;
+
+  SVN_ERR(svn_stream_close(stream));
+  SVN_ERR(svn_io_file_get_offset(&end, context->file, scratch_pool));
+
+  entry->size = end - entry->offset;
+  entry->type = type;
+  entry->item.revision = revision;
+  entry->item.number = item_number;
+  APR_ARRAY_PUSH(context->entries, svn_fs_fs__p2l_entry_t *) = entry;
+
+  return SVN_NO_ERROR;
+}
+
+/* Find the closest predecessor of NODEREV in CONTEXT whose data rep can
+ * be used as a delta base without exceeding the maximum chain length.
+ * Return that base rep in *BASE_REP and, if it has been replaced by a new
+ * rep, that new rep in *NEW_BASE.  Set *CHAIN_LENGTH to the length that
+ * a delta chain on top of that base will have.  If there is no suitable
+ * base, set *BASE_REP and *NEW_BASE to NULL and *CHAIN_LENGTH to 1.
+ * Allocate the results in RESULT_POOL and use SCRATCH_POOL for temporary
+ * allocations.
+ *
+ * This is similar to choose_delta_base() but only ever considers the
+ * predecessors instead of using skip-deltas, as those typically got
+ * us into the current situation in the first place. */
+static svn_error_t *
+choose_base(representation_t **base_rep,
+            new_rep_t **new_base,
+            int *chain_length,
+            shard_context_t *context,
+            node_revision_t *noderev,
+            apr_pool_t *result_pool,
+            apr_pool_t *scratch_pool)
+{
+  node_revision_t *pred = noderev;
+  apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+  int i;
+
+  *base_rep = NULL;
+  *new_base = NULL;
+  *chain_length = 1;
+
+  for (i = 0; i < context->max_chain_length && pred->predecessor_id; ++i)
+    {
+      representation_t *rep;
+      new_rep_t *mapped;
+      int length, shard_count;
+
+      svn_pool_clear(iterpool);
+      SVN_ERR(svn_fs_fs__get_node_revision(&pred, context->fs,
+                                           pred->predecessor_id,
+                                           scratch_pool, iterpool));
+
+      /* Bases smaller than this are not worth it (same as in
+       * choose_delta_base()).  A rep can't be its own base either. */
+      rep = pred->data_rep;
+      if (   rep == NULL
+          || rep->expanded_size < 64
+          || (   rep->revision == noderev->data_rep->revision
+              && rep->item_index == noderev->data_rep->item_index))
+        continue;
+
+      mapped = svn_hash_gets(context->new_reps, rep_key(rep, iterpool));
+      if (mapped)
+        length = mapped->chain_length;
+      else
+        SVN_ERR(svn_fs_fs__rep_chain_length(&length, &shard_count, rep,
+                                            context->fs, iterpool));
+
+      if (length < context->max_chain_length)
+        {
+          *base_rep = apr_pmemdup(result_pool, rep, sizeof(*rep));
+          *new_base = mapped;
+          *chain_length = length + 1;
+          break;
+        }
+    }
+
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
+/* Append a new representation for the data rep of NODEREV to CONTEXT,
+ * using a delta base with a short enough chain.  Return the new rep in
+ * *NEW_REP, allocated in CONTEXT->POOL.  Use SCRATCH_POOL for temporary
+ * allocations. */
+static svn_error_t *
+write_rep(new_rep_t **new_rep,
+          shard_context_t *context,
+          node_revision_t *noderev,
+          apr_pool_t *scratch_pool)
+{
+  svn_fs_t *fs = context->fs;
+  svn_revnum_t revision = svn_fs_fs__id_rev(noderev->id);
+  representation_t *base_rep;
+  new_rep_t *new_base;
+  svn_fs_fs__rep_header_t header = { 0 };
+  svn_fs_fs__p2l_entry_t *entry;
+  svn_stream_t *stream, *source, *target;
+  svn_txdelta_window_handler_t diff_wh;
+  void *diff_whb;
+  apr_off_t delta_start, delta_end;
+  new_rep_t *result = apr_pcalloc(context->pool, sizeof(*result));
+
+  SVN_ERR(choose_base(&base_rep, &new_base, &result->chain_length, context,
+                      noderev, scratch_pool, scratch_pool));
+
+  /* Write out the rep header.  The delta is always calculated against
+   * the original base rep's contents but a base that got replaced itself
+   * will be referenced through its replacement. */
+  if (base_rep)
+    {
+      representation_t *header_rep = new_base ? new_base->rep : base_rep;
+
+      header.base_revision = header_rep->revision;
+      header.base_item_index = header_rep->item_index;
+      header.base_length = header_rep->size;
+      header.type = svn_fs_fs__rep_delta;
+    }
+  else
+    {
+      header.type = svn_fs_fs__rep_self_delta;
+    }
+
+  SVN_ERR(begin_item(&entry, &stream, context, scratch_pool));
+  SVN_ERR(svn_fs_fs__write_rep_header(&header, stream, scratch_pool));
+  SVN_ERR(svn_io_file_get_offset(&delta_start, context->file, scratch_pool));
+
+  /* The svndiff writer will close its output stream but we still need
+   * ours to add the end marker. */
+  svn_fs_fs__txdelta_to_svndiff(&diff_wh, &diff_whb,
+                                svn_stream_disown(stream, scratch_pool),
+                                fs, scratch_pool);
+  SVN_ERR(svn_fs_fs__get_contents(&source, fs, base_rep, FALSE,
+                                  scratch_pool));
+  SVN_ERR(svn_fs_fs__get_contents(&target, fs, noderev->data_rep, FALSE,
+                                  scratch_pool));
+  SVN_ERR(svn_stream_copy3(target,
+                           svn_txdelta_target_push(diff_wh, diff_whb, source,
+                                                   scratch_pool),
+                           context->cancel_func, context->cancel_baton,
+                           scratch_pool));
+
+  SVN_ERR(svn_io_file_get_offset(&delta_end, context->file, scratch_pool));
+  SVN_ERR(svn_stream_puts(stream, "ENDREP\n"));
+
+  /* Same contents, new location. */
+  result->rep = apr_pmemdup(context->pool, noderev->data_rep,
+                            sizeof(*noderev->data_rep));
+  result->rep->revision = revision;
+  result->rep->item_index = allocate_item(context, revision);
+  result->rep->size = delta_end - delta_start;
+
+  SVN_ERR(end_item(context, entry, stream, SVN_FS_FS__ITEM_TYPE_FILE_REP,
+                   revision, result->rep->item_index, scratch_pool));
+
+  *new_rep = result;
+  ++context->rep_count;
+
+  return SVN_NO_ERROR;
+}
+
+/* Append NODEREV to CONTEXT, replacing the item described by OLD_ENTRY.
+ * Use SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+write_noderev(shard_context_t *context,
+              node_revision_t *noderev,
+              svn_fs_fs__p2l_entry_t *old_entry,
+              apr_pool_t *scratch_pool)
+{
+  fs_fs_data_t *ffd = context->fs->fsap_data;
+  svn_fs_fs__p2l_entry_t *entry;
+  svn_stream_t *stream;
+
+  SVN_ERR(begin_item(&entry, &stream, context, scratch_pool));
+  SVN_ERR(svn_fs_fs__write_noderev(stream, noderev, ffd->format,
+                               svn_fs_fs__fs_supports_mergeinfo(context->fs),
+                                   scratch_pool));
+  SVN_ERR(end_item(context, entry, stream, SVN_FS_FS__ITEM_TYPE_NODEREV,
+                   old_entry->item.revision, old_entry->item.number,
+                   scratch_pool));
+
+  /* The old data remains valid but is no longer referenced. */
+  old_entry->item.number = allocate_item(context, old_entry->item.revision);
+  ++context->noderev_count;
+
+  return SVN_NO_ERROR;
+}
+
+/* Write the index data for CONTEXT->ENTRIES to the copy of the pack file
+ * and replace the original pack file with it.  Use SCRATCH_POOL for
+ * temporary allocations. */
+static svn_error_t *
+replace_pack_file(shard_context_t *context,
+                  apr_pool_t *scratch_pool)
+{
+  fs_fs_data_t *ffd = context->fs->fsap_data;
+  const char *l2p_proto_index;
+  const char *p2l_proto_index;
+  apr_file_t *proto_index;
+  apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+  int i;
+
+  /* We know all checksums, so we don't need to re-read the data as
+   * svn_fs_fs__p2l_index_from_p2l_entries() would. */
+  SVN_ERR(svn_io_open_unique_file3(NULL, &p2l_proto_index, NULL,
+                                   svn_io_file_del_on_pool_cleanup,
+                                   scratch_pool, scratch_pool));
+  SVN_ERR(svn_fs_fs__p2l_proto_index_open(&proto_index, p2l_proto_index,
+                                          scratch_pool));
+  for (i = 0; i < context->entries->nelts; ++i)
+    {
+      const svn_fs_fs__p2l_entry_t *entry
+        = APR_ARRAY_IDX(context->entries, i, const svn_fs_fs__p2l_entry_t *);
+
+      svn_pool_clear(iterpool);
+      SVN_ERR(svn_fs_fs__p2l_proto_index_add_entry(proto_index, entry,
+                                                   iterpool));
+    }
+  SVN_ERR(svn_io_file_close(proto_index, scratch_pool));
+
+  /* This reorders the entries, so it must come last. */
+  SVN_ERR(svn_fs_fs__l2p_index_from_p2l_entries(&l2p_proto_index,
+                                                context->fs,
+                                                context->entries,
+                                                scratch_pool, iterpool));
+
+  SVN_ERR(svn_fs_fs__add_index_data(context->fs, context->file,
+                                    l2p_proto_index, p2l_proto_index,
+                                    context->shard_rev, scratch_pool));
+  if (ffd->flush_to_disk)
+    SVN_ERR(svn_io_file_flush_to_disk(context->file, scratch_pool));
+  SVN_ERR(svn_io_file_close(context->file, scratch_pool));
+  context->file = NULL;
+
+  /* Atomically switch to the new pack file.  Readers that still have
+   * the old one open will continue to see consistent data. */
+  SVN_ERR(svn_fs_fs__move_into_place(context->temp_path, context->pack_path,
+                                     context->pack_path, ffd->flush_to_disk,
+                                     scratch_pool));
+
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
+/* Rewrite the pack file of the shard starting at SHARD_REV in FS such
+ * that no file noderev in it has a delta chain longer than
+ * MAX_CHAIN_LENGTH.  Add the number of reps and noderevs written to
+ * *REP_COUNT and *NODEREV_COUNT, respectively.  Use SCRATCH_POOL for
+ * temporary allocations. */
+static svn_error_t *
+redeltify_shard(svn_fs_t *fs,
+                svn_revnum_t shard_rev,
+                int max_chain_length,
+                apr_int64_t *rep_count,
+                apr_int64_t *noderev_count,
+                svn_cancel_func_t cancel_func,
+                void *cancel_baton,
+                apr_pool_t *scratch_pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+  shard_context_t context = { 0 };
+  apr_array_header_t *noderevs;
+  apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+  int i;
+
+  context.fs = fs;
+  context.shard_rev = shard_rev;
+  context.max_chain_length = max_chain_length;
+  context.pack_path = svn_fs_fs__path_rev_packed(fs, shard_rev, PATH_PACKED,
+                                                 scratch_pool);
+  context.entries = apr_array_make(scratch_pool, 1024,
+                                   sizeof(svn_fs_fs__p2l_entry_t *));
+  context.next_item = apr_pcalloc(scratch_pool,
+                                  ffd->max_files_per_dir
+                                    * sizeof(*context.next_item));
+  context.new_reps = apr_hash_make(scratch_pool);
+  context.cancel_func = cancel_func;
+  context.cancel_baton = cancel_baton;
+  context.pool = scratch_pool;
+
+  SVN_ERR(svn_fs_fs__open_pack_or_rev_file(&context.rev_file, fs, shard_rev,
+                                           scratch_pool, iterpool));
+  SVN_ERR(svn_fs_fs__auto_read_footer(context.rev_file));
+  SVN_ERR(read_entries(&context, iterpool));
+
+  /* Process the noderevs in revision order, such that predecessors
+   * within the same shard get their new reps before their successors. */
+  noderevs = apr_array_make(scratch_pool, 16,
+                            sizeof(svn_fs_fs__p2l_entry_t *));
+  for (i = 0; i < context.entries->nelts; ++i)
+    {
+      svn_fs_fs__p2l_entry_t *entry
+        = APR_ARRAY_IDX(context.entries, i, svn_fs_fs__p2l_entry_t *);
+      if (entry->type == SVN_FS_FS__ITEM_TYPE_NODEREV)
+        APR_ARRAY_PUSH(noderevs, svn_fs_fs__p2l_entry_t *) = entry;
+    }
+  svn_sort__array(noderevs, compare_p2l_entry_item);
+
+  for (i = 0; i < noderevs->nelts; ++i)
+    {
+      svn_fs_fs__p2l_entry_t *entry
+        = APR_ARRAY_IDX(noderevs, i, svn_fs_fs__p2l_entry_t *);
+      node_revision_t *noderev;
+      new_rep_t *new_rep;
+      const char *key;
+
+      svn_pool_clear(iterpool);
+      if (cancel_func)
+        SVN_ERR(cancel_func(cancel_baton));
+
+      SVN_ERR(read_noderev(&noderev, &context, entry, iterpool, iterpool));
+      if (noderev->kind != svn_node_file || noderev->data_rep == NULL)
+        continue;
+
+      key = rep_key(noderev->data_rep, iterpool);
+      new_rep = svn_hash_gets(context.new_reps, key);
+      if (new_rep == NULL)
+        {
+          int length, shard_count;
+          SVN_ERR(svn_fs_fs__rep_chain_length(&length, &shard_count,
+                                              noderev->data_rep, fs,
+                                              iterpool));
+          if (length <= max_chain_length)
+            continue;
+
+          SVN_ERR(auto_open_copy(&context, iterpool));
+          SVN_ERR(write_rep(&new_rep, &context, noderev, iterpool));
+          svn_hash_sets(context.new_reps, apr_pstrdup(scratch_pool, key),
+                        new_rep);
+        }
+
+      noderev->data_rep = new_rep->rep;
+      SVN_ERR(write_noderev(&context, noderev, entry, iterpool));
+    }
+
+  if (context.file)
+    SVN_ERR(replace_pack_file(&context, iterpool));
+
+  SVN_ERR(svn_fs_fs__close_revision_file(context.rev_file));
+  svn_pool_destroy(iterpool);
+
+  *rep_count += context.rep_count;
+  *noderev_count += context.noderev_count;
+
+  return SVN_NO_ERROR;
+}
+
+/* Baton for redeltify_body and bump_instance_id.
+ */
+typedef struct redeltify_baton_t
+{
+  svn_fs_t *fs;
+  svn_revnum_t start_rev;
+  svn_revnum_t end_rev;
+  int max_chain_length;
+  apr_int64_t rep_count;
+  apr_int64_t noderev_count;
+  svn_fs_progress_notify_func_t progress_func;
+  void *progress_baton;
+  svn_cancel_func_t cancel_func;
+  void *cancel_baton;
+} redeltify_baton_t;
+
+/* Give the repository in BATON a new instance ID, so that other
+ * processes opening it will not use cached index data of the old pack
+ * files.  Implements svn_fs_fs__with_write_lock() callback. */
+static svn_error_t *
+bump_instance_id(void *baton,
+                 apr_pool_t *pool)
+{
+  redeltify_baton_t *b = baton;
+  return svn_error_trace(svn_fs_fs__set_uuid(b->fs, b->fs->uuid, NULL,
+                                             pool));
+}
+
+/* The actual implementation of svn_fs_fs__redeltify.  BATON is a
+ * redeltify_baton_t *.  Must be called with the pack lock held.
+ * Implements svn_fs_fs__with_pack_lock() callback. */
+static svn_error_t *
+redeltify_body(void *baton,
+               apr_pool_t *pool)
+{
+  redeltify_baton_t *b = baton;
+  fs_fs_data_t *ffd = b->fs->fsap_data;
+  apr_pool_t *iterpool = svn_pool_create(pool);
+  svn_revnum_t shard_size = ffd->max_files_per_dir;
+  svn_revnum_t shard_rev;
+
+  /* Only packed shards are being processed. */
+  SVN_ERR(svn_fs_fs__update_min_unpacked_rev(b->fs, pool));
+  if (b->end_rev >= ffd->min_unpacked_rev)
+    b->end_rev = ffd->min_unpacked_rev - 1;
+  if (b->end_rev < b->start_rev)
+    return SVN_NO_ERROR;
+
+  for (shard_rev = b->end_rev - b->end_rev % shard_size;
+       shard_rev + shard_size > b->start_rev && shard_rev >= 0;
+       shard_rev -= shard_size)
+    {
+      svn_pool_clear(iterpool);
+
+      if (b->progress_func)
+        b->progress_func(shard_rev, b->progress_baton, iterpool);
+
+      SVN_ERR(redeltify_shard(b->fs, shard_rev, b->max_chain_length,
+                              &b->rep_count, &b->noderev_count,
+                              b->cancel_func, b->cancel_baton, iterpool));
+    }
+
+  if (b->rep_count)
+    SVN_ERR(svn_fs_fs__with_write_lock(b->fs, bump_instance_id, b,
+                                       iterpool));
+
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_fs_fs__redeltify(svn_fs_t *fs,
+                     svn_revnum_t start_rev,
+                     svn_revnum_t end_rev,
+                     int max_chain_length,
+                     apr_int64_t *rep_count,
+                     apr_int64_t *noderev_count,
+                     svn_fs_progress_notify_func_t progress_func,
+                     void *progress_baton,
+                     svn_cancel_func_t cancel_func,
+                     void *cancel_baton,
+                     apr_pool_t *scratch_pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+  redeltify_baton_t baton = { 0 };
+
+  /* Packed shards must be indexed such that we can add items to them. */
+  if (! svn_fs_fs__use_log_addressing(fs))
+    return svn_error_createf(SVN_ERR_FS_UNSUPPORTED_FORMAT, NULL,
+                             _("FSFS format (%d) too old to redeltify; "
+                               "please upgrade the filesystem."),
+                             ffd->format);
+
+  if (max_chain_length < 0)
+    return svn_error_createf(SVN_ERR_INCORRECT_PARAMS, NULL,
+                             _("Invalid maximum delta chain length %d"),
+                             max_chain_length);
+
+  /* Default to the longest chain that choose_delta_base() accepts. */
+  if (max_chain_length == 0)
+    max_chain_length = 2 * ffd->max_linear_deltification + 2;
+
+  if (start_rev == SVN_INVALID_REVNUM)
+    start_rev = 0;
+
+  if (end_rev == SVN_INVALID_REVNUM)
+    SVN_ERR(svn_fs_fs__youngest_rev(&end_rev, fs, scratch_pool));
+
+  if (start_rev > end_rev)
+    return svn_error_createf(SVN_ERR_FS_NO_SUCH_REVISION, NULL,
+                             _("Invalid revision range [%ld, %ld]"),
+                             start_rev, end_rev);
+
+  *rep_count = 0;
+  *noderev_count = 0;
+
+  /* Unsharded repositories can't be packed. */
+  if (ffd->max_files_per_dir == 0)
+    return SVN_NO_ERROR;
+
+  baton.fs = fs;
+  baton.start_rev = start_rev;
+  baton.end_rev = end_rev;
+  baton.max_chain_length = max_chain_length;
+  baton.progress_func = progress_func;
+  baton.progress_baton = progress_baton;
+  baton.cancel_func = cancel_func;
+  baton.cancel_baton = cancel_baton;
+
+  SVN_ERR(svn_fs_fs__with_pack_lock(fs, redeltify_body, &baton,
+                                    scratch_pool));
+
+  *rep_count = baton.rep_count;
+  *noderev_count = baton.noderev_count;
+
+  return SVN_NO_ERROR;
+}
@@ -0,0 +1,68 @@
+/* redeltify.h : interface to the FSFS delta chain rebalancing
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+#ifndef SVN_LIBSVN_FS_FS_REDELTIFY_H
+#define SVN_LIBSVN_FS_FS_REDELTIFY_H
+
+#include "svn_error.h"
+
+#include "fs.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/* Rewrite the file text representations in the packed shards of FS that
+   overlap the revision range START_REV to END_REV, such that no file
+   noderev in them references a delta chain longer than MAX_CHAIN_LENGTH.
+   A MAX_CHAIN_LENGTH of 0 selects the default, i.e. the longest chain
+   that the current deltification settings of FS would produce.
+
+   Only the reps that exceed the limit will be rewritten, each as a delta
+   against the closest predecessor that keeps the new chain within the
+   limit or as a self-delta if there is none.  The new reps and the
+   updated noderevs are appended to the pack files; the existing data
+   remains in place such that concurrent readers will still find valid
+   contents.  Requires log addressing.
+
+   Return the number of new reps in *REP_COUNT and the number of noderevs
+   that now use them in *NODEREV_COUNT.  Call PROGRESS_FUNC with
+   PROGRESS_BATON for the first revision of each shard processed, if not
+   NULL.  Use SCRATCH_POOL for temporary allocations. */
+svn_error_t *
+svn_fs_fs__redeltify(svn_fs_t *fs,
+                     svn_revnum_t start_rev,
+                     svn_revnum_t end_rev,
+                     int max_chain_length,
+                     apr_int64_t *rep_count,
+                     apr_int64_t *noderev_count,
+                     svn_fs_progress_notify_func_t progress_func,
+                     void *progress_baton,
+                     svn_cancel_func_t cancel_func,
+                     void *cancel_baton,
+                     apr_pool_t *scratch_pool);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* SVN_LIBSVN_FS_FS_REDELTIFY_H */
@@ -31,7 +31,10 @@
 #include "../libsvn_fs/fs-loader.h"
 
 #include "svn_path.h"
+#include "svn_sorts.h"
+#include "svn_string.h"
 
+#include "private/svn_sorts_private.h"
 #include "private/svn_sqlite.h"
 
 #include "rep-cache-db.h"
@@ -48,6 +51,670 @@ path_rep_cache_db(const char *fs_path,
   return svn_dirent_join(fs_path, REP_CACHE_DB_NAME, result_pool);
 }
 
+static APR_INLINE const char *
+path_rep_cache_filter(const char *fs_path,
+                      apr_pool_t *result_pool)
+{
+  return svn_dirent_join(fs_path, REP_CACHE_FILTER_NAME, result_pool);
+}
+
+
+/** The rep-cache filter. **/
+
+/* First token in the filter file header and the only format we support. */
+#define FILTER_MAGIC "SVN-REP-CACHE-FILTER"
+#define FILTER_FORMAT 1
+
+/* The header line gets padded to this length (including the newline). */
+#define FILTER_HEADER_SIZE 128
+
+/* Parameters for newly built filters.  With 10 bits per entry and 7 hash
+ * functions, the false positive rate is below 1%. */
+#define FILTER_BITS_PER_ENTRY 10
+#define FILTER_HASH_COUNT 7
+#define FILTER_MIN_CAPACITY 0x10000
+
+/* Upper limit to the number of hash functions that we accept. */
+#define FILTER_MAX_HASH_COUNT 16
+
+/* When updating the filter file in-place, we read and write it in blocks
+ * of this size. */
+#define FILTER_BLOCK_SIZE 0x1000
+
+struct rep_cache_filter_t
+{
+  /* All reps from revisions up to and including this one have been added
+   * to the filter. */
+  svn_revnum_t covered_rev;
+
+  /* Youngest revision when we last checked the filter file for changes. */
+  svn_revnum_t checked_rev;
+
+  /* Size and modification time of the filter file when we read it.
+   * FILE_SIZE is -1 if the file did not exist. */
+  apr_off_t file_size;
+  apr_time_t file_mtime;
+
+  /* Size of BITS in bits.  Always a multiple of 8. */
+  apr_uint64_t bit_count;
+
+  /* Number of bits to set / test per entry. */
+  int hash_count;
+
+  /* Number of entries added to the filter so far. */
+  apr_uint64_t entry_count;
+
+  /* The filter data.  NULL, if the filter file does not exist. */
+  unsigned char *bits;
+
+  /* Pool holding this structure and BITS. */
+  apr_pool_t *pool;
+};
+
+/* Return a "corrupt filter" error for the filter file at PATH.
+ * Use SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+filter_corrupt_error(const char *path,
+                     apr_pool_t *scratch_pool)
+{
+  return svn_error_createf(SVN_ERR_FS_CORRUPT, NULL,
+                           _("Corrupt rep-cache filter '%s'"),
+                           svn_dirent_local_style(path, scratch_pool));
+}
+
+/* Parse the FILTER_HEADER_SIZE bytes of HEADER read from the filter file
+ * at PATH and set the respective elements in FILTER.  Use SCRATCH_POOL
+ * for temporary allocations. */
+static svn_error_t *
+parse_filter_header(rep_cache_filter_t *filter,
+                    const char *header,
+                    const char *path,
+                    apr_pool_t *scratch_pool)
+{
+  apr_array_header_t *tokens;
+  const char *line = apr_pstrmemdup(scratch_pool, header,
+                                    FILTER_HEADER_SIZE);
+  apr_uint64_t value;
+  int format;
+  svn_error_t *err;
+
+  tokens = svn_cstring_split(line, " \n", TRUE, scratch_pool);
+  if (   tokens->nelts != 6
+      || strcmp(APR_ARRAY_IDX(tokens, 0, const char *), FILTER_MAGIC))
+    return svn_error_trace(filter_corrupt_error(path, scratch_pool));
+
+  SVN_ERR(svn_cstring_atoi(&format, APR_ARRAY_IDX(tokens, 1, const char *)));
+  if (format != FILTER_FORMAT)
+    return svn_error_createf(SVN_ERR_FS_UNSUPPORTED_FORMAT, NULL,
+                             _("Unsupported rep-cache filter format %d "
+                               "in '%s'"), format,
+                             svn_dirent_local_style(path, scratch_pool));
+
+  err = svn_revnum_parse(&filter->covered_rev,
+                         APR_ARRAY_IDX(tokens, 2, const char *), NULL);
+  if (!err)
+    err = svn_cstring_strtoui64(&filter->bit_count,
+                                APR_ARRAY_IDX(tokens, 3, const char *),
+                                8, APR_SIZE_MAX, 10);
+  if (!err)
+    err = svn_cstring_strtoui64(&value,
+                                APR_ARRAY_IDX(tokens, 4, const char *),
+                                1, FILTER_MAX_HASH_COUNT, 10);
+  if (!err)
+    err = svn_cstring_strtoui64(&filter->entry_count,
+                                APR_ARRAY_IDX(tokens, 5, const char *),
+                                0, APR_UINT64_MAX, 10);
+  if (err || filter->bit_count % 8)
+    return svn_error_compose_create(filter_corrupt_error(path, scratch_pool),
+                                    err);
+
+  filter->hash_count = (int)value;
+
+  return SVN_NO_ERROR;
+}
+
+/* Return the FILTER_HEADER_SIZE bytes long header line for FILTER.
+ * Allocate the result in RESULT_POOL. */
+static svn_stringbuf_t *
+unparse_filter_header(const rep_cache_filter_t *filter,
+                      apr_pool_t *result_pool)
+{
+  svn_stringbuf_t *header
+    = svn_stringbuf_createf(result_pool,
+                            "%s %d %ld %" APR_UINT64_T_FMT " %d %"
+                            APR_UINT64_T_FMT,
+                            FILTER_MAGIC, FILTER_FORMAT, filter->covered_rev,
+                            filter->bit_count, filter->hash_count,
+                            filter->entry_count);
+
+  /* All numbers are limited to far less than 20 digits each. */
+  SVN_ERR_ASSERT_NO_RETURN(header->len < FILTER_HEADER_SIZE);
+  while (header->len < FILTER_HEADER_SIZE - 1)
+    svn_stringbuf_appendbyte(header, ' ');
+  svn_stringbuf_appendbyte(header, '\n');
+
+  return header;
+}
+
+/* Set the FILTER->HASH_COUNT elements of POSITIONS to the bit positions
+ * in FILTER for the SHA1 DIGEST.  The digest is uniformly distributed
+ * already, so we simply use double hashing on two parts of it. */
+static void
+get_filter_positions(apr_uint64_t *positions,
+                     const rep_cache_filter_t *filter,
+                     const unsigned char *digest)
+{
+  apr_uint64_t h1 = 0;
+  apr_uint64_t h2 = 0;
+  int i;
+
+  for (i = 0; i < 8; ++i)
+    {
+      h1 = (h1 << 8) | digest[i];
+      h2 = (h2 << 8) | digest[i + 8];
+    }
+
+  /* An odd step size ensures distinct positions for power-of-2 sizes. */
+  h2 |= 1;
+  for (i = 0; i < filter->hash_count; ++i)
+    positions[i] = (h1 + i * h2) % filter->bit_count;
+}
+
+/* Add the SHA1 DIGEST to the in-memory FILTER. */
+static void
+filter_add(rep_cache_filter_t *filter,
+           const unsigned char *digest)
+{
+  apr_uint64_t positions[FILTER_MAX_HASH_COUNT];
+  int i;
+
+  get_filter_positions(positions, filter, digest);
+  for (i = 0; i < filter->hash_count; ++i)
+    filter->bits[positions[i] / 8] |= (unsigned char)(1 << (positions[i] % 8));
+
+  filter->entry_count++;
+}
+
+/* Return TRUE, if the SHA1 DIGEST may have been added to FILTER. */
+static svn_boolean_t
+filter_may_contain(const rep_cache_filter_t *filter,
+                   const unsigned char *digest)
+{
+  apr_uint64_t positions[FILTER_MAX_HASH_COUNT];
+  int i;
+
+  get_filter_positions(positions, filter, digest);
+  for (i = 0; i < filter->hash_count; ++i)
+    if ((filter->bits[positions[i] / 8] & (1 << (positions[i] % 8))) == 0)
+      return FALSE;
+
+  return TRUE;
+}
+
+/* Set *SIZE and *MTIME to the size and modification time of the filter
+ * file at PATH.  If it does not exist, set *SIZE to -1 and *MTIME to 0.
+ * Use SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+stat_filter(apr_off_t *size,
+            apr_time_t *mtime,
+            const char *path,
+            apr_pool_t *scratch_pool)
+{
+  apr_finfo_t finfo;
+  svn_error_t *err = svn_io_stat(&finfo, path,
+                                 APR_FINFO_SIZE | APR_FINFO_MTIME,
+                                 scratch_pool);
+  if (err && APR_STATUS_IS_ENOENT(err->apr_err))
+    {
+      svn_error_clear(err);
+      *size = -1;
+      *mtime = 0;
+      return SVN_NO_ERROR;
+    }
+  SVN_ERR(err);
+
+  *size = finfo.size;
+  *mtime = finfo.mtime;
+
+  return SVN_NO_ERROR;
+}
+
+/* Read the filter file at PATH into FILTER, allocating the data in
+ * FILTER->POOL.  Leave FILTER->BITS as NULL if there is no such file.
+ * Use SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+read_filter_file(rep_cache_filter_t *filter,
+                 const char *path,
+                 apr_pool_t *scratch_pool)
+{
+  svn_stringbuf_t *content;
+  svn_error_t *err;
+
+  SVN_ERR(stat_filter(&filter->file_size, &filter->file_mtime, path,
+                      scratch_pool));
+  if (filter->file_size < 0)
+    return SVN_NO_ERROR;
+
+  err = svn_stringbuf_from_file2(&content, path, filter->pool);
+  if (err && APR_STATUS_IS_ENOENT(err->apr_err))
+    {
+      svn_error_clear(err);
+      return SVN_NO_ERROR;
+    }
+  SVN_ERR(err);
+
+  if (content->len < FILTER_HEADER_SIZE)
+    return svn_error_trace(filter_corrupt_error(path, scratch_pool));
+
+  SVN_ERR(parse_filter_header(filter, content->data, path, scratch_pool));
+  if (content->len != FILTER_HEADER_SIZE + filter->bit_count / 8)
+    return svn_error_trace(filter_corrupt_error(path, scratch_pool));
+
+  filter->bits = (unsigned char *)content->data + FILTER_HEADER_SIZE;
+
+  return SVN_NO_ERROR;
+}
+
+/* (Re-)read the rep-cache filter of FS into FS->FSAP_DATA, replacing any
+ * previous in-memory copy.  If there is no filter file or it cannot be
+ * read, the in-memory copy will have no BITS.  The filter is optional,
+ * so problems with it are only reported through the FS warning callback.
+ * Use SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+read_filter(svn_fs_t *fs,
+            apr_pool_t *scratch_pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+  const char *path = path_rep_cache_filter(fs->path, scratch_pool);
+  apr_pool_t *pool = svn_pool_create(fs->pool);
+  rep_cache_filter_t *filter = apr_pcalloc(pool, sizeof(*filter));
+  svn_error_t *err;
+
+  filter->pool = pool;
+  filter->covered_rev = SVN_INVALID_REVNUM;
+  filter->file_size = -1;
+
+  /* Determine HEAD before reading the filter.  We must not consider the
+   * filter to be up-to-date w.r.t. a revision that we did not see. */
+  SVN_ERR(svn_fs_fs__youngest_rev(&filter->checked_rev, fs, scratch_pool));
+
+  /* Don't use a broken filter but keep its size and timestamp, so we
+   * will not try to read it again until it got replaced. */
+  err = read_filter_file(filter, path, scratch_pool);
+  if (err)
+    {
+      (fs->warning)(fs->warning_baton, err);
+      svn_error_clear(err);
+
+      filter->bits = NULL;
+      filter->covered_rev = SVN_INVALID_REVNUM;
+    }
+
+  if (ffd->rep_cache_filter)
+    svn_pool_destroy(ffd->rep_cache_filter->pool);
+  ffd->rep_cache_filter = filter;
+
+  return SVN_NO_ERROR;
+}
+
+/* Return TRUE if the filter file at PATH is still the one that FILTER
+ * has been read from, i.e. if its size and modification time did not
+ * change.  Use SCRATCH_POOL for temporary allocations. */
+static svn_boolean_t
+filter_file_unchanged(const rep_cache_filter_t *filter,
+                      const char *path,
+                      apr_pool_t *scratch_pool)
+{
+  apr_off_t size;
+  apr_time_t mtime;
+  svn_error_t *err = stat_filter(&size, &mtime, path, scratch_pool);
+
+  if (err)
+    {
+      svn_error_clear(err);
+      return FALSE;
+    }
+
+  return size == filter->file_size && mtime == filter->file_mtime;
+}
+
+/* Set *MAYBE_PRESENT to FALSE if the rep-cache filter of FS proves that
+ * the rep-cache does not contain the SHA1 DIGEST.  Otherwise, and in
+ * particular if there is no up-to-date filter, set it to TRUE.
+ * Use SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+check_filter(svn_boolean_t *maybe_present,
+             svn_fs_t *fs,
+             const unsigned char *digest,
+             apr_pool_t *scratch_pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+  rep_cache_filter_t *filter = ffd->rep_cache_filter;
+
+  /* Re-read the filter when we know that it is out-dated, but don't retry
+   * for the same HEAD again and again.  Commits update the file in-place
+   * while a rebuild replaces it, so unless its size or timestamp changed,
+   * there is nothing new to read. */
+  if (!filter)
+    {
+      SVN_ERR(read_filter(fs, scratch_pool));
+      filter = ffd->rep_cache_filter;
+    }
+  else if (   filter->covered_rev < ffd->youngest_rev_cache
+           && filter->checked_rev < ffd->youngest_rev_cache)
+    {
+      if (filter_file_unchanged(filter,
+                                path_rep_cache_filter(fs->path,
+                                                      scratch_pool),
+                                scratch_pool))
+        {
+          filter->checked_rev = ffd->youngest_rev_cache;
+        }
+      else
+        {
+          SVN_ERR(read_filter(fs, scratch_pool));
+          filter = ffd->rep_cache_filter;
+        }
+    }
+
+  /* Only trust the filter if it covers all revisions that we know of. */
+  *maybe_present = !filter->bits
+                || filter->covered_rev < ffd->youngest_rev_cache
+                || filter_may_contain(filter, digest);
+
+  return SVN_NO_ERROR;
+}
+
+/* Sort function for apr_uint64_t bit positions. */
+static int
+compare_bit_positions(const void *lhs,
+                      const void *rhs)
+{
+  apr_uint64_t lhs_value = *(const apr_uint64_t *)lhs;
+  apr_uint64_t rhs_value = *(const apr_uint64_t *)rhs;
+
+  if (lhs_value < rhs_value)
+    return -1;
+
+  return lhs_value > rhs_value ? 1 : 0;
+}
+
+svn_error_t *
+svn_fs_fs__add_rep_cache_filter_entries(svn_fs_t *fs,
+                                        const apr_array_header_t *reps,
+                                        svn_revnum_t revision,
+                                        apr_pool_t *scratch_pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+  const char *path = path_rep_cache_filter(fs->path, scratch_pool);
+  rep_cache_filter_t filter = { 0 };
+  rep_cache_filter_t *cached = ffd->rep_cache_filter;
+  svn_stringbuf_t *header;
+  apr_array_header_t *positions;
+  unsigned char *block;
+  apr_file_t *file;
+  apr_off_t offset;
+  svn_error_t *err;
+  int i, k;
+
+  err = svn_io_file_open(&file, path, APR_READ | APR_WRITE, APR_OS_DEFAULT,
+                         scratch_pool);
+  if (err && APR_STATUS_IS_ENOENT(err->apr_err))
+    {
+      svn_error_clear(err);
+      return SVN_NO_ERROR;
+    }
+  SVN_ERR(err);
+
+  header = svn_stringbuf_create_ensure(FILTER_HEADER_SIZE, scratch_pool);
+  SVN_ERR(svn_io_file_read_full2(file, header->data, FILTER_HEADER_SIZE,
+                                 NULL, NULL, scratch_pool));
+  SVN_ERR(parse_filter_header(&filter, header->data, path, scratch_pool));
+
+  /* If a previous commit did not update the filter, it does not cover
+   * all older revisions and is useless until rebuilt.  It may already
+   * cover REVISION if an earlier attempt to commit it failed. */
+  if (filter.covered_rev < revision - 1)
+    return svn_error_trace(svn_io_file_close(file, scratch_pool));
+
+  /* Keep our in-memory copy in sync, if it has been read before. */
+  if (   cached
+      && cached->bits
+      && cached->covered_rev >= revision - 1
+      && cached->bit_count == filter.bit_count
+      && cached->hash_count == filter.hash_count)
+    cached->covered_rev = revision;
+  else
+    cached = NULL;
+
+  /* Collect the bit positions for all new reps. */
+  positions = apr_array_make(scratch_pool,
+                             (reps ? reps->nelts : 0) * filter.hash_count,
+                             sizeof(apr_uint64_t));
+  for (i = 0; reps && i < reps->nelts; ++i)
+    {
+      const representation_t *rep
+        = APR_ARRAY_IDX(reps, i, const representation_t *);
+      apr_uint64_t rep_positions[FILTER_MAX_HASH_COUNT];
+
+      if (!rep->has_sha1)
+        continue;
+
+      get_filter_positions(rep_positions, &filter, rep->sha1_digest);
+      for (k = 0; k < filter.hash_count; ++k)
+        APR_ARRAY_PUSH(positions, apr_uint64_t) = rep_positions[k];
+
+      filter.entry_count++;
+      if (cached)
+        filter_add(cached, rep->sha1_digest);
+    }
+
+  /* Patch the file block by block, visiting each block at most once. */
+  svn_sort__array(positions, compare_bit_positions);
+  block = apr_palloc(scratch_pool, FILTER_BLOCK_SIZE);
+  for (i = 0; i < positions->nelts; i = k)
+    {
+      apr_uint64_t first = APR_ARRAY_IDX(positions, i, apr_uint64_t);
+      apr_uint64_t block_start = first / 8 / FILTER_BLOCK_SIZE
+                               * FILTER_BLOCK_SIZE;
+      apr_size_t block_len
+        = (apr_size_t)MIN(FILTER_BLOCK_SIZE,
+                          filter.bit_count / 8 - block_start);
+
+      offset = FILTER_HEADER_SIZE + (apr_off_t)block_start;
+      SVN_ERR(svn_io_file_seek(file, APR_SET, &offset, scratch_pool));
+      SVN_ERR(svn_io_file_read_full2(file, block, block_len, NULL, NULL,
+                                     scratch_pool));
+
+      for (k = i; k < positions->nelts; ++k)
+        {
+          apr_uint64_t position = APR_ARRAY_IDX(positions, k, apr_uint64_t);
+          if (position / 8 >= block_start + block_len)
+            break;
+
+          block[position / 8 - block_start]
+            |= (unsigned char)(1 << (position % 8));
+        }
+
+      SVN_ERR(svn_io_file_seek(file, APR_SET, &offset, scratch_pool));
+      SVN_ERR(svn_io_file_write_full(file, block, block_len, NULL,
+                                     scratch_pool));
+    }
+
+  /* Only now claim that REVISION has been covered. */
+  filter.covered_rev = revision;
+  header = unparse_filter_header(&filter, scratch_pool);
+  offset = 0;
+  SVN_ERR(svn_io_file_seek(file, APR_SET, &offset, scratch_pool));
+  SVN_ERR(svn_io_file_write_full(file, header->data, header->len, NULL,
+                                 scratch_pool));
+  SVN_ERR(svn_io_file_close(file, scratch_pool));
+
+  /* Our in-memory copy matches the file as we just wrote it. */
+  if (cached)
+    SVN_ERR(stat_filter(&cached->file_size, &cached->file_mtime, path,
+                        scratch_pool));
+
+  return SVN_NO_ERROR;
+}
+
+/* Baton type used when building a new rep-cache filter. */
+typedef struct build_filter_baton_t
+{
+  svn_fs_t *fs;
+  svn_cancel_func_t cancel_func;
+  void *cancel_baton;
+} build_filter_baton_t;
+
+/* Implements the walker callback of svn_fs_fs__walk_rep_reference.
+ * Count REP in the apr_uint64_t at BATON. */
+static svn_error_t *
+count_rep(representation_t *rep,
+          void *baton,
+          svn_fs_t *fs,
+          apr_pool_t *scratch_pool)
+{
+  apr_uint64_t *count = baton;
+  ++*count;
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements the walker callback of svn_fs_fs__walk_rep_reference.
+ * Add REP to the rep_cache_filter_t at BATON. */
+static svn_error_t *
+add_rep_to_filter(representation_t *rep,
+                  void *baton,
+                  svn_fs_t *fs,
+                  apr_pool_t *scratch_pool)
+{
+  rep_cache_filter_t *filter = baton;
+  filter_add(filter, rep->sha1_digest);
+
+  return SVN_NO_ERROR;
+}
+
+/* Body of svn_fs_fs__build_rep_cache_filter, to be called with the write
+ * lock held.  BATON is a build_filter_baton_t. */
+static svn_error_t *
+build_filter_body(void *baton,
+                  apr_pool_t *pool)
+{
+  build_filter_baton_t *b = baton;
+  fs_fs_data_t *ffd = b->fs->fsap_data;
+  rep_cache_filter_t filter = { 0 };
+  apr_uint64_t capacity = 0;
+  apr_size_t content_size;
+  char *content;
+  svn_stringbuf_t *header;
+  svn_revnum_t youngest;
+
+  SVN_ERR(svn_fs_fs__youngest_rev(&youngest, b->fs, pool));
+
+  /* Size the filter for twice the number of current entries.
+   * Round to full bytes. */
+  SVN_ERR(svn_fs_fs__walk_rep_reference(b->fs, 0, youngest, count_rep,
+                                        &capacity, b->cancel_func,
+                                        b->cancel_baton, pool));
+  capacity = MAX(2 * capacity, FILTER_MIN_CAPACITY);
+  capacity = APR_ALIGN(capacity, 8);
+
+  filter.covered_rev = youngest;
+  filter.bit_count = capacity * FILTER_BITS_PER_ENTRY;
+  filter.hash_count = FILTER_HASH_COUNT;
+
+  content_size = FILTER_HEADER_SIZE + (apr_size_t)(filter.bit_count / 8);
+  content = apr_pcalloc(pool, content_size);
+  filter.bits = (unsigned char *)content + FILTER_HEADER_SIZE;
+
+  SVN_ERR(svn_fs_fs__walk_rep_reference(b->fs, 0, youngest,
+                                        add_rep_to_filter, &filter,
+                                        b->cancel_func, b->cancel_baton,
+                                        pool));
+
+  header = unparse_filter_header(&filter, pool);
+  memcpy(content, header->data, header->len);
+
+  SVN_ERR(svn_io_write_atomic2(path_rep_cache_filter(b->fs->path, pool),
+                               content, content_size,
+                               svn_fs_fs__path_current(b->fs, pool),
+                               ffd->flush_to_disk, pool));
+
+  /* Make sure we pick up the new filter. */
+  if (ffd->rep_cache_filter)
+    {
+      svn_pool_destroy(ffd->rep_cache_filter->pool);
+      ffd->rep_cache_filter = NULL;
+    }
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_fs_fs__build_rep_cache_filter(svn_fs_t *fs,
+                                  svn_cancel_func_t cancel_func,
+                                  void *cancel_baton,
+                                  apr_pool_t *pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+  build_filter_baton_t baton;
+
+  if (ffd->format < SVN_FS_FS__MIN_REP_SHARING_FORMAT)
+    return svn_error_createf(SVN_ERR_FS_REP_SHARING_NOT_SUPPORTED, NULL,
+                             _("FSFS format (%d) too old for rep-sharing; "
+                               "please upgrade the filesystem."),
+                             ffd->format);
+
+  if (!ffd->rep_sharing_allowed)
+    return svn_error_create(SVN_ERR_FS_REP_SHARING_NOT_ALLOWED, NULL,
+                            _("Filesystem does not allow rep-sharing."));
+
+  baton.fs = fs;
+  baton.cancel_func = cancel_func;
+  baton.cancel_baton = cancel_baton;
+
+  return svn_error_trace(svn_fs_fs__with_write_lock(fs, build_filter_body,
+                                                    &baton, pool));
+}
+
+/* Body of svn_fs_fs__invalidate_rep_cache_filter, to be called with the
+ * write lock held.  BATON is the svn_fs_t. */
+static svn_error_t *
+invalidate_filter_body(void *baton,
+                       apr_pool_t *pool)
+{
+  svn_fs_t *fs = baton;
+  fs_fs_data_t *ffd = fs->fsap_data;
+
+  SVN_ERR(svn_io_remove_file2(path_rep_cache_filter(fs->path, pool), TRUE,
+                              pool));
+
+  if (ffd->rep_cache_filter)
+    {
+      svn_pool_destroy(ffd->rep_cache_filter->pool);
+      ffd->rep_cache_filter = NULL;
+    }
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_fs_fs__invalidate_rep_cache_filter(svn_fs_t *fs,
+                                       apr_pool_t *pool)
+{
+  svn_node_kind_t kind;
+
+  /* Don't bother taking out the write lock if there is nothing to do. */
+  SVN_ERR(svn_io_check_path(path_rep_cache_filter(fs->path, pool), &kind,
+                            pool));
+  if (kind == svn_node_none)
+    return SVN_NO_ERROR;
+
+  return svn_error_trace(svn_fs_fs__with_write_lock(fs,
+                                                    invalidate_filter_body,
+                                                    fs, pool));
+}
+
 
 /** Library-private API's. **/
 
@@ -269,6 +936,7 @@ svn_fs_fs__get_rep_reference(representation_t **rep_p,
   fs_fs_data_t *ffd = fs->fsap_data;
   svn_sqlite__stmt_t *stmt;
   svn_boolean_t have_row;
+  svn_boolean_t maybe_present;
   representation_t *rep;
 
   SVN_ERR_ASSERT(ffd->rep_sharing_allowed);
@@ -281,6 +949,27 @@ svn_fs_fs__get_rep_reference(representation_t **rep_p,
                             _("Only SHA1 checksums can be used as keys in the "
                               "rep_cache table.\n"));
 
+  /* Entries that we did not write to the database, yet. */
+  if (ffd->deferred_reps)
+    {
+      rep = apr_hash_get(ffd->deferred_reps, checksum->digest,
+                         APR_SHA1_DIGESTSIZE);
+      if (rep)
+        {
+          *rep_p = svn_fs_fs__rep_copy(rep, pool);
+          return SVN_NO_ERROR;
+        }
+    }
+
+  /* Most new representations have never been seen before.  Don't bother
+     the database with those, if the filter can tell. */
+  SVN_ERR(check_filter(&maybe_present, fs, checksum->digest, pool));
+  if (!maybe_present)
+    {
+      *rep_p = NULL;
+      return SVN_NO_ERROR;
+    }
+
   SVN_ERR(svn_sqlite__get_statement(&stmt, ffd->rep_cache_db, STMT_GET_REP));
   SVN_ERR(svn_sqlite__bindf(stmt, "s",
                             svn_checksum_to_cstring(checksum, pool)));
@@ -355,6 +1044,142 @@ svn_fs_fs__set_rep_reference(svn_fs_t *fs,
   return SVN_NO_ERROR;
 }
 
+/* Add the representations in REPS (an array of representation_t *) to
+ * the rep-cache database of FS within a single SQLite transaction.
+ * Use POOL for temporary allocations. */
+static svn_error_t *
+write_rep_references(svn_fs_t *fs,
+                     const apr_array_header_t *reps,
+                     apr_pool_t *pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+  apr_pool_t *iterpool;
+  svn_error_t *err = SVN_NO_ERROR;
+  int i;
+
+  SVN_ERR(svn_fs_fs__open_rep_cache(fs, pool));
+
+  /* We use an sqlite transaction to speed things up;
+   * see <http://www.sqlite.org/faq.html#q19>.
+   */
+  /* ### A commit that touches thousands of files will starve other
+         (reader/writer) commits for the duration of the below call.
+         Maybe write in batches? */
+  SVN_ERR(svn_sqlite__begin_transaction(ffd->rep_cache_db));
+
+  iterpool = svn_pool_create(pool);
+  for (i = 0; i < reps->nelts && !err; i++)
+    {
+      representation_t *rep = APR_ARRAY_IDX(reps, i, representation_t *);
+
+      svn_pool_clear(iterpool);
+      err = svn_fs_fs__set_rep_reference(fs, rep, iterpool);
+    }
+  svn_pool_destroy(iterpool);
+
+  err = svn_sqlite__finish_transaction(ffd->rep_cache_db, err);
+
+  if (svn_error_find_cause(err, SVN_ERR_SQLITE_ROLLBACK_FAILED))
+    {
+      /* Failed rollback means that our db connection is unusable, and
+         the only thing we can do is close it.  The connection will be
+         reopened during the next operation with rep-cache.db. */
+      return svn_error_trace(
+          svn_error_compose_create(err, svn_fs_fs__close_rep_cache(fs)));
+    }
+
+  return svn_error_trace(err);
+}
+
+/* Maximum number of entries to queue while rep-cache updates are being
+ * deferred.  Once reached, they will be written as a single batch.
+ * This limits the memory usage to a few MB. */
+#define MAX_DEFERRED_REPS 0x8000
+
+/* Write all entries queued in FS while deferring rep-cache updates to the
+ * database and empty the queue.  Use POOL for temporary allocations. */
+static svn_error_t *
+flush_deferred_reps(svn_fs_t *fs,
+                    apr_pool_t *pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+  apr_array_header_t *reps;
+  apr_hash_index_t *hi;
+
+  if (apr_hash_count(ffd->deferred_reps) == 0)
+    return SVN_NO_ERROR;
+
+  reps = apr_array_make(pool, apr_hash_count(ffd->deferred_reps),
+                        sizeof(representation_t *));
+  for (hi = apr_hash_first(pool, ffd->deferred_reps); hi;
+       hi = apr_hash_next(hi))
+    APR_ARRAY_PUSH(reps, representation_t *) = apr_hash_this_val(hi);
+
+  SVN_ERR(write_rep_references(fs, reps, pool));
+
+  /* Only drop the entries once they are in the database. */
+  svn_pool_clear(ffd->deferred_reps_pool);
+  ffd->deferred_reps = apr_hash_make(ffd->deferred_reps_pool);
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_fs_fs__add_rep_references(svn_fs_t *fs,
+                              const apr_array_header_t *reps,
+                              apr_pool_t *pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+  int i;
+
+  if (! ffd->deferred_reps)
+    return svn_error_trace(write_rep_references(fs, reps, pool));
+
+  for (i = 0; i < reps->nelts; i++)
+    {
+      representation_t *rep
+        = svn_fs_fs__rep_copy(APR_ARRAY_IDX(reps, i, representation_t *),
+                              ffd->deferred_reps_pool);
+
+      svn_fs_fs__id_txn_reset(&rep->txn_id);
+      apr_hash_set(ffd->deferred_reps, rep->sha1_digest,
+                   APR_SHA1_DIGESTSIZE, rep);
+    }
+
+  if (apr_hash_count(ffd->deferred_reps) >= MAX_DEFERRED_REPS)
+    SVN_ERR(flush_deferred_reps(fs, pool));
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_fs_fs__defer_rep_cache(svn_fs_t *fs,
+                           svn_boolean_t defer,
+                           apr_pool_t *pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+
+  if (defer && !ffd->deferred_reps)
+    {
+      /* Without rep-sharing, there is nothing to defer. */
+      if (ffd->rep_sharing_allowed)
+        {
+          ffd->deferred_reps_pool = svn_pool_create(fs->pool);
+          ffd->deferred_reps = apr_hash_make(ffd->deferred_reps_pool);
+        }
+    }
+  else if (!defer && ffd->deferred_reps)
+    {
+      SVN_ERR(flush_deferred_reps(fs, pool));
+
+      svn_pool_destroy(ffd->deferred_reps_pool);
+      ffd->deferred_reps_pool = NULL;
+      ffd->deferred_reps = NULL;
+    }
+
+  return SVN_NO_ERROR;
+}
+
 
 svn_error_t *
 svn_fs_fs__del_rep_reference(svn_fs_t *fs,
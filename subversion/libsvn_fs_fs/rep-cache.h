@@ -33,6 +33,7 @@ extern "C" {
 
 
 #define REP_CACHE_DB_NAME        "rep-cache.db"
+#define REP_CACHE_FILTER_NAME    "rep-cache.filter"
 
 /* Open and create, if needed, the rep cache database associated with FS.
    Use POOL for temporary allocations. */
@@ -77,12 +78,38 @@ svn_fs_fs__get_rep_reference(representation_t **rep_p,
    Use POOL for temporary allocations.  Returns SVN_ERR_FS_CORRUPT if
    an existing reference beyond HEAD is detected.
 
-   If the rep cache database has not been opened, this may be a no op. */
+   If the rep cache database has not been opened, this may be a no op.
+
+   This does not update the rep-cache filter.  Callers that add entries
+   outside the commit path must call svn_fs_fs__invalidate_rep_cache_filter()
+   or those entries will never be found. */
 svn_error_t *
 svn_fs_fs__set_rep_reference(svn_fs_t *fs,
                              representation_t *rep,
                              apr_pool_t *pool);
 
+/* Add the representations in REPS (an array of representation_t *) of a
+   freshly committed revision to the rep-cache of FS.  If rep-cache updates
+   are being deferred, only queue them in memory.  Use POOL for temporary
+   allocations. */
+svn_error_t *
+svn_fs_fs__add_rep_references(svn_fs_t *fs,
+                              const apr_array_header_t *reps,
+                              apr_pool_t *pool);
+
+/* If DEFER is set, start queueing new rep-cache entries of FS in memory
+   instead of writing them to rep-cache.db after each commit.  They will
+   still be found by svn_fs_fs__get_rep_reference() and are written in
+   large batches.  If DEFER is not set, write all queued entries to the
+   database and stop deferring.  Use POOL for temporary allocations.
+
+   Entries still queued when FS gets closed are lost, i.e. future commits
+   cannot share those representations. */
+svn_error_t *
+svn_fs_fs__defer_rep_cache(svn_fs_t *fs,
+                           svn_boolean_t defer,
+                           apr_pool_t *pool);
+
 /* Delete from the cache all reps corresponding to revisions younger
    than YOUNGEST. */
 svn_error_t *
@@ -90,6 +117,38 @@ svn_fs_fs__del_rep_reference(svn_fs_t *fs,
                              svn_revnum_t youngest,
                              apr_pool_t *pool);
 
+/* If FS has a rep-cache filter that covers all revisions before REVISION,
+   add the representations in REPS (an array of representation_t *, may be
+   NULL) to it and mark it as covering REVISION as well.  Otherwise, this
+   is a no-op.
+
+   This must be called with the FS write lock held while committing
+   REVISION.  Use SCRATCH_POOL for temporary allocations. */
+svn_error_t *
+svn_fs_fs__add_rep_cache_filter_entries(svn_fs_t *fs,
+                                        const apr_array_header_t *reps,
+                                        svn_revnum_t revision,
+                                        apr_pool_t *scratch_pool);
+
+/* Create or replace the rep-cache filter of FS such that it covers all
+   entries currently in the rep-cache database.  The filter will be sized
+   to allow for the number of entries to double before its false positive
+   rate degrades noticeably.  Takes out the FS write lock.  Use POOL for
+   temporary allocations. */
+svn_error_t *
+svn_fs_fs__build_rep_cache_filter(svn_fs_t *fs,
+                                  svn_cancel_func_t cancel_func,
+                                  void *cancel_baton,
+                                  apr_pool_t *pool);
+
+/* Remove the rep-cache filter of FS, if any, such that lookups go straight
+   to the rep-cache database again.  Other processes notice the change with
+   the next commit at the latest.  Takes out the FS write lock if there is
+   a filter.  Use POOL for temporary allocations. */
+svn_error_t *
+svn_fs_fs__invalidate_rep_cache_filter(svn_fs_t *fs,
+                                       apr_pool_t *pool);
+
 /* Start a transaction to take an SQLite reserved lock that prevents
    other writes, call BODY, end the transaction, and return what BODY returned.
  */
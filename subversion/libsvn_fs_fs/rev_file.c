@@ -28,6 +28,9 @@
 
 #include "../libsvn_fs/fs-loader.h"
 
+#include "svn_pools.h"
+#include "svn_sorts.h"
+
 #include "private/svn_io_private.h"
 #include "svn_private_config.h"
 
@@ -44,7 +47,12 @@ init_revision_file(svn_fs_fs__revision_file_t *file,
   file->is_packed = svn_fs_fs__is_packed_rev(fs, revision);
   file->start_revision = svn_fs_fs__packed_base_rev(fs, revision);
 
+  file->pack_generation = 0;
   file->file = NULL;
+  file->may_mmap = FALSE;
+  file->mmap = NULL;
+  file->mmap_offset = 0;
+  file->mmap_pool = NULL;
   file->stream = NULL;
   file->p2l_stream = NULL;
   file->l2p_stream = NULL;
@@ -54,6 +62,8 @@ init_revision_file(svn_fs_fs__revision_file_t *file,
   file->p2l_offset = -1;
   file->p2l_checksum = NULL;
   file->footer_offset = -1;
+  file->readahead_start = 0;
+  file->readahead_end = 0;
   file->pool = pool;
 }
 
@@ -120,6 +130,77 @@ auto_make_writable(const char *path,
   return SVN_NO_ERROR;
 }
 
+/* Replace the current mapping of FILE with one of the region containing
+ * OFFSET.  Memory mapping is an optimization only.  So, if that is not
+ * supported or fails for whatever reason (e.g. exhausted address space),
+ * leave FILE->MMAP as NULL and stop trying for this FILE.  Use
+ * SCRATCH_POOL for temporary allocations.
+ */
+static svn_error_t *
+map_region(svn_fs_fs__revision_file_t *file,
+           apr_off_t offset,
+           apr_pool_t *scratch_pool)
+{
+#if APR_HAS_MMAP
+  svn_filesize_t size;
+  apr_off_t region_offset = offset - offset % SVN_FS_FS__MMAP_REGION_SIZE;
+  apr_status_t status;
+
+  if (file->mmap)
+    {
+      status = apr_mmap_delete(file->mmap);
+      file->mmap = NULL;
+      if (status)
+        return svn_error_wrap_apr(status, _("Can't unmap rev file data"));
+    }
+
+  /* Don't let the mapping structs pile up in FILE->POOL. */
+  if (file->mmap_pool)
+    svn_pool_clear(file->mmap_pool);
+  else
+    file->mmap_pool = svn_pool_create(file->pool);
+
+  SVN_ERR(svn_io_file_size_get(&size, file->file, scratch_pool));
+  size = MIN(size - region_offset, SVN_FS_FS__MMAP_REGION_SIZE);
+  if (size <= 0)
+    return SVN_NO_ERROR;
+
+  status = apr_mmap_create(&file->mmap, file->file, region_offset,
+                           (apr_size_t)size, APR_MMAP_READ,
+                           file->mmap_pool);
+  if (status)
+    {
+      file->mmap = NULL;
+      file->may_mmap = FALSE;
+    }
+  else
+    {
+      file->mmap_offset = region_offset;
+    }
+#endif
+
+  return SVN_NO_ERROR;
+}
+
+/* Set *GENERATION to a non-zero value identifying the current version of
+ * the pack FILE.  Use SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+get_pack_generation(apr_uint32_t *generation,
+                    apr_file_t *file,
+                    apr_pool_t *scratch_pool)
+{
+  apr_off_t size;
+  apr_uint64_t value;
+
+  SVN_ERR(svn_io_file_size_get(&size, file, scratch_pool));
+  value = (apr_uint64_t)size;
+  *generation = (apr_uint32_t)(value ^ (value >> 32));
+  if (*generation == 0)
+    *generation = 1;
+
+  return SVN_NO_ERROR;
+}
+
 /* Core implementation of svn_fs_fs__open_pack_or_rev_file working on an
  * existing, initialized FILE structure.  If WRITABLE is TRUE, give write
  * access to the file - temporarily resetting the r/o state if necessary.
@@ -159,6 +240,14 @@ open_pack_or_rev_file(svn_fs_fs__revision_file_t *file,
           file->stream = svn_stream_from_aprfile2(apr_file, TRUE,
                                                   result_pool);
           file->is_packed = svn_fs_fs__is_packed_rev(fs, rev);
+          file->pack_generation = 0;
+          if (file->is_packed)
+            SVN_ERR(get_pack_generation(&file->pack_generation, apr_file,
+                                        scratch_pool));
+
+          /* Writers may modify the file in-place.  Only map r/o files.
+           * Nothing gets mapped until we actually read from the file. */
+          file->may_mmap = ffd->use_mmap && !writable;
 
           return SVN_NO_ERROR;
         }
@@ -290,15 +379,71 @@ svn_fs_fs__open_proto_rev_file(svn_fs_fs__revision_file_t **file,
   return SVN_NO_ERROR;
 }
 
+svn_error_t *
+svn_fs_fs__get_mapped_data(const char **data,
+                           svn_fs_fs__revision_file_t *file,
+                           apr_off_t offset,
+                           apr_off_t size)
+{
+  *data = NULL;
+
+#if APR_HAS_MMAP
+  if (   !file->may_mmap
+      || offset < 0
+      || size < 0
+      || offset / SVN_FS_FS__MMAP_REGION_SIZE
+           != (offset + MAX(size, 1) - 1) / SVN_FS_FS__MMAP_REGION_SIZE)
+    return SVN_NO_ERROR;
+
+  /* Map the region containing the section, unless we already did. */
+  if (   !file->mmap
+      || offset < file->mmap_offset
+      || offset >= file->mmap_offset + (apr_off_t)file->mmap->size)
+    SVN_ERR(map_region(file, offset, file->pool));
+
+  if (   file->mmap
+      && offset + size <= file->mmap_offset + (apr_off_t)file->mmap->size)
+    {
+      void *address;
+      apr_status_t status = apr_mmap_offset(&address, file->mmap,
+                                            offset - file->mmap_offset);
+      if (status)
+        return svn_error_wrap_apr(status,
+                                  _("Can't access mapped rev file data"));
+
+      *data = address;
+    }
+#endif
+
+  return SVN_NO_ERROR;
+}
+
 svn_error_t *
 svn_fs_fs__close_revision_file(svn_fs_fs__revision_file_t *file)
 {
+#if APR_HAS_MMAP
+  if (file->mmap)
+    {
+      apr_status_t status = apr_mmap_delete(file->mmap);
+      if (status)
+        return svn_error_wrap_apr(status,
+                                  _("Can't unmap rev file data"));
+    }
+
+  if (file->mmap_pool)
+    svn_pool_destroy(file->mmap_pool);
+#endif
+
   if (file->stream)
     SVN_ERR(svn_stream_close(file->stream));
   if (file->file)
     SVN_ERR(svn_io_file_close(file->file, file->pool));
 
+  file->pack_generation = 0;
   file->file = NULL;
+  file->may_mmap = FALSE;
+  file->mmap = NULL;
+  file->mmap_pool = NULL;
   file->stream = NULL;
   file->l2p_stream = NULL;
   file->p2l_stream = NULL;
@@ -23,9 +23,15 @@
 #ifndef SVN_LIBSVN_FS__REV_FILE_H
 #define SVN_LIBSVN_FS__REV_FILE_H
 
+#include <apr_mmap.h>
+
 #include "svn_fs.h"
 #include "id.h"
 
+/* Rev and pack files get memory mapped in regions of this size.  Must be
+ * a multiple of the page size. */
+#define SVN_FS_FS__MMAP_REGION_SIZE 0x4000000
+
 /* In format 7, index files must be read in sync with the respective
  * revision / pack file.  I.e. we must use packed index files for packed
  * rev files and unpacked ones for non-packed rev files.  So, the whole
@@ -51,9 +57,29 @@ typedef struct svn_fs_fs__revision_file_t
   /* the revision was packed when the first file / stream got opened */
   svn_boolean_t is_packed;
 
+  /* 0 for non-packed revisions.  For pack files, a non-zero value derived
+   * from the file size at the time it got opened.  Redeltifying a shard
+   * rewrites its pack file, always making it larger, and assigns new item
+   * indexes.  Index data cached under this generation can therefore not
+   * be confused with the data of a previous version of the pack file. */
+  apr_uint32_t pack_generation;
+
   /* rev / pack file */
   apr_file_t *file;
 
+  /* If set, sections of FILE may be mapped into memory on demand.  Only
+   * used for committed revisions and only if enabled in fsfs.conf. */
+  svn_boolean_t may_mmap;
+
+  /* Read-only memory mapping of the section of FILE starting at
+   * MMAP_OFFSET or NULL, if nothing has been mapped, yet. */
+  apr_mmap_t *mmap;
+  apr_off_t mmap_offset;
+
+  /* Sub-pool of POOL that MMAP is allocated in and that gets cleared
+   * whenever we map another region.  NULL until the first mapping. */
+  apr_pool_t *mmap_pool;
+
   /* stream based on FILE and not NULL exactly when FILE is not NULL */
   svn_stream_t *stream;
 
@@ -90,6 +116,11 @@ typedef struct svn_fs_fs__revision_file_t
    * been called, yet. */
   apr_off_t footer_offset;
 
+  /* Section of FILE that we most recently asked the OS to prefetch.
+   * Both are 0 if no read-ahead hints have been given, yet. */
+  apr_off_t readahead_start;
+  apr_off_t readahead_end;
+
   /* pool containing this object */
   apr_pool_t *pool;
 } svn_fs_fs__revision_file_t;
@@ -137,6 +168,20 @@ svn_fs_fs__open_proto_rev_file(svn_fs_fs__revision_file_t **file,
                                apr_pool_t* result_pool,
                                apr_pool_t *scratch_pool);
 
+/* If FILE may be mapped into memory, set *DATA to the SIZE bytes
+ * starting at OFFSET within the mapped rev / pack file.  Sections get
+ * mapped on demand, one region of SVN_FS_FS__MMAP_REGION_SIZE bytes at a
+ * time.  Hence, *DATA only remains valid until the next call for FILE.
+ *
+ * If FILE may not be mapped, mapping the section fails or it crosses a
+ * region boundary, set *DATA to NULL.
+ */
+svn_error_t *
+svn_fs_fs__get_mapped_data(const char **data,
+                           svn_fs_fs__revision_file_t *file,
+                           apr_off_t offset,
+                           apr_off_t size);
+
 /* Close all files and streams in FILE.
  */
 svn_error_t *
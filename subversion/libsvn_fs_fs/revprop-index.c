@@ -0,0 +1,808 @@
+/* revprop-index.c --- index of the standard revprops for fsfs
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+#include <string.h>
+
+#include <apr_mmap.h>
+
+#include "svn_pools.h"
+#include "svn_hash.h"
+#include "svn_props.h"
+#include "svn_dirent_uri.h"
+
+#include "fs_fs.h"
+#include "revprops.h"
+#include "revprop-index.h"
+
+#include "private/svn_subr_private.h"
+#include "../libsvn_fs/fs-loader.h"
+
+#include "svn_private_config.h"
+
+/* The revprop index consists of two files.  "revprop-index" starts with
+ * a header line padded to INDEX_HEADER_SIZE bytes, followed by one
+ * RECORD_SIZE bytes record per revision, starting at r0.  All numbers in
+ * a record are stored in big-endian order:
+ *
+ *   8 bytes  offset of the revprop values in "revprop-index.data"
+ *   4 bytes  length of svn:author
+ *   4 bytes  length of svn:date
+ *   4 bytes  length of svn:log
+ *   8 bytes  reserved, always 0
+ *   4 bytes  FNV-1a checksum over the first 28 bytes and the values
+ *
+ * The values of a revision follow each other directly in the data file
+ * and that file only ever gets appended to.  A length of NO_VALUE means
+ * that the revision does not have that property.  Records with an offset
+ * of NO_OFFSET don't describe their revision, e.g. because it has other
+ * revprops as well or because those are just being changed.
+ *
+ * Records get overwritten in-place.  Readers may therefore see partially
+ * written records, which the checksum will catch.
+ */
+
+/* First token in the index file header and the only format we support. */
+#define INDEX_MAGIC "SVN-REVPROP-INDEX"
+#define INDEX_FORMAT 1
+
+/* The header line gets padded to this length (including the newline). */
+#define INDEX_HEADER_SIZE 64
+
+/* Layout of a record as described above. */
+#define RECORD_SIZE 32
+#define RECORD_CHECKSUM_OFFSET 28
+#define NO_OFFSET APR_UINT64_MAX
+#define NO_VALUE 0xffffffff
+
+/* The revprops that may be stored in the index, in record order. */
+static const char *const standard_props[] = {
+  SVN_PROP_REVISION_AUTHOR,
+  SVN_PROP_REVISION_DATE,
+  SVN_PROP_REVISION_LOG
+};
+#define STANDARD_PROP_COUNT 3
+
+/* One of the index files, opened for reading. */
+typedef struct mapped_file_t
+{
+  /* The open file. */
+  apr_file_t *file;
+
+  /* Mapping of the whole file as it was when it got mapped the last time.
+   * NULL, if that failed or the file was empty. */
+  apr_mmap_t *mmap;
+
+  /* Holds MMAP.  NULL, if memory mapping has not been enabled. */
+  apr_pool_t *map_pool;
+} mapped_file_t;
+
+struct revprop_index_t
+{
+  /* The index and data files.  Both FILE members are NULL, if FS has no
+   * revprop index. */
+  mapped_file_t index;
+  mapped_file_t data;
+
+  /* Youngest revision when we last tried to open the index. */
+  svn_revnum_t checked_rev;
+
+  /* Pool holding this structure and the open files. */
+  apr_pool_t *pool;
+};
+
+/* An index opened for modification. */
+typedef struct index_writer_t
+{
+  apr_file_t *index_file;
+  apr_file_t *data_file;
+
+  /* Number of records in INDEX_FILE, i.e. the first revision that is not
+   * covered by the index. */
+  svn_revnum_t record_count;
+
+  /* Size of DATA_FILE in bytes. */
+  apr_off_t data_size;
+} index_writer_t;
+
+/* Return a "corrupt index" error for the index file at PATH.
+ * Use SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+index_corrupt_error(const char *path,
+                    apr_pool_t *scratch_pool)
+{
+  return svn_error_createf(SVN_ERR_FS_CORRUPT, NULL,
+                           _("Corrupt revprop index '%s'"),
+                           svn_dirent_local_style(path, scratch_pool));
+}
+
+/* Read the INDEX_HEADER_SIZE bytes of header from the beginning of FILE,
+ * the index file at PATH, and verify it.  Use SCRATCH_POOL for temporary
+ * allocations. */
+static svn_error_t *
+read_index_header(apr_file_t *file,
+                  const char *path,
+                  apr_pool_t *scratch_pool)
+{
+  char header[INDEX_HEADER_SIZE + 1];
+  apr_array_header_t *tokens;
+  apr_size_t bytes_read;
+  apr_off_t offset = 0;
+  int format;
+
+  SVN_ERR(svn_io_file_seek(file, APR_SET, &offset, scratch_pool));
+  SVN_ERR(svn_io_file_read_full2(file, header, INDEX_HEADER_SIZE,
+                                 &bytes_read, NULL, scratch_pool));
+  if (bytes_read != INDEX_HEADER_SIZE)
+    return svn_error_trace(index_corrupt_error(path, scratch_pool));
+
+  header[INDEX_HEADER_SIZE] = '\0';
+  tokens = svn_cstring_split(header, " \n", TRUE, scratch_pool);
+  if (   tokens->nelts != 2
+      || strcmp(APR_ARRAY_IDX(tokens, 0, const char *), INDEX_MAGIC))
+    return svn_error_trace(index_corrupt_error(path, scratch_pool));
+
+  SVN_ERR(svn_cstring_atoi(&format, APR_ARRAY_IDX(tokens, 1, const char *)));
+  if (format != INDEX_FORMAT)
+    return svn_error_createf(SVN_ERR_FS_UNSUPPORTED_FORMAT, NULL,
+                             _("Unsupported revprop index format %d "
+                               "in '%s'"), format,
+                             svn_dirent_local_style(path, scratch_pool));
+
+  return SVN_NO_ERROR;
+}
+
+/* Return the INDEX_HEADER_SIZE bytes long header line of a new index.
+ * Allocate the result in RESULT_POOL. */
+static svn_stringbuf_t *
+unparse_index_header(apr_pool_t *result_pool)
+{
+  svn_stringbuf_t *header
+    = svn_stringbuf_createf(result_pool, "%s %d", INDEX_MAGIC,
+                            INDEX_FORMAT);
+
+  while (header->len < INDEX_HEADER_SIZE - 1)
+    svn_stringbuf_appendbyte(header, ' ');
+  svn_stringbuf_appendbyte(header, '\n');
+
+  return header;
+}
+
+/* Big-endian encoding and decoding of record fields. */
+static void
+encode_uint32(unsigned char *p,
+              apr_uint32_t value)
+{
+  p[0] = (unsigned char)(value >> 24);
+  p[1] = (unsigned char)(value >> 16);
+  p[2] = (unsigned char)(value >> 8);
+  p[3] = (unsigned char)value;
+}
+
+static apr_uint32_t
+decode_uint32(const unsigned char *p)
+{
+  return ((apr_uint32_t)p[0] << 24) | ((apr_uint32_t)p[1] << 16)
+       | ((apr_uint32_t)p[2] << 8) | (apr_uint32_t)p[3];
+}
+
+static void
+encode_uint64(unsigned char *p,
+              apr_uint64_t value)
+{
+  encode_uint32(p, (apr_uint32_t)(value >> 32));
+  encode_uint32(p + 4, (apr_uint32_t)value);
+}
+
+static apr_uint64_t
+decode_uint64(const unsigned char *p)
+{
+  return ((apr_uint64_t)decode_uint32(p) << 32) | decode_uint32(p + 4);
+}
+
+/* Return the offset of the record for REV within the index file. */
+static apr_off_t
+record_offset(svn_revnum_t rev)
+{
+  return INDEX_HEADER_SIZE + (apr_off_t)rev * RECORD_SIZE;
+}
+
+/* Return the checksum to store in a record starting with RECORD for the
+ * revprop VALUES of DATA_SIZE bytes in total.  Use SCRATCH_POOL for
+ * temporary allocations. */
+static apr_uint32_t
+record_checksum(const unsigned char *record,
+                const void *values,
+                apr_size_t data_size,
+                apr_pool_t *scratch_pool)
+{
+  unsigned char *buffer = apr_palloc(scratch_pool,
+                                     RECORD_CHECKSUM_OFFSET + data_size);
+
+  memcpy(buffer, record, RECORD_CHECKSUM_OFFSET);
+  if (data_size)
+    memcpy(buffer + RECORD_CHECKSUM_OFFSET, values, data_size);
+
+  return svn__fnv1a_32(buffer, RECORD_CHECKSUM_OFFSET + data_size);
+}
+
+
+/*** Reading the index. ***/
+
+/* Map the whole contents of FILE->FILE into memory, replacing any
+ * previous mapping.  Memory mapping is an optimization only.  So, if that
+ * fails for whatever reason, silently fall back to normal file access.
+ * Use SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+map_file(mapped_file_t *file,
+         apr_pool_t *scratch_pool)
+{
+#if APR_HAS_MMAP
+  svn_filesize_t size;
+  apr_status_t status;
+
+  /* The pool cleanup removes the old mapping. */
+  svn_pool_clear(file->map_pool);
+  file->mmap = NULL;
+
+  SVN_ERR(svn_io_file_size_get(&size, file->file, scratch_pool));
+  if (size <= 0 || (apr_size_t)size != size)
+    return SVN_NO_ERROR;
+
+  status = apr_mmap_create(&file->mmap, file->file, 0, (apr_size_t)size,
+                           APR_MMAP_READ, file->map_pool);
+  if (status)
+    file->mmap = NULL;
+#endif
+
+  return SVN_NO_ERROR;
+}
+
+/* Copy the SIZE bytes at OFFSET in FILE to BUFFER.  Set *FOUND to FALSE,
+ * if FILE is too short to contain them.  Use SCRATCH_POOL for temporary
+ * allocations. */
+static svn_error_t *
+read_range(svn_boolean_t *found,
+           void *buffer,
+           mapped_file_t *file,
+           apr_uint64_t offset,
+           apr_size_t size,
+           apr_pool_t *scratch_pool)
+{
+  apr_off_t pos;
+  apr_size_t bytes_read;
+
+  *found = FALSE;
+  if (offset > APR_INT64_MAX - size)
+    return SVN_NO_ERROR;
+
+#if APR_HAS_MMAP
+  if (file->map_pool)
+    {
+      /* Re-map the file only if it actually grew since. */
+      if (!file->mmap || offset + size > file->mmap->size)
+        {
+          svn_filesize_t file_size;
+          SVN_ERR(svn_io_file_size_get(&file_size, file->file,
+                                       scratch_pool));
+          if (offset + size > (apr_uint64_t)file_size)
+            return SVN_NO_ERROR;
+
+          SVN_ERR(map_file(file, scratch_pool));
+        }
+
+      if (file->mmap && offset + size <= file->mmap->size)
+        {
+          void *address;
+          apr_status_t status = apr_mmap_offset(&address, file->mmap,
+                                                (apr_off_t)offset);
+          if (status)
+            return svn_error_wrap_apr(status,
+                                      _("Can't access mapped revprop "
+                                        "index data"));
+
+          memcpy(buffer, address, size);
+          *found = TRUE;
+          return SVN_NO_ERROR;
+        }
+    }
+#endif
+
+  pos = (apr_off_t)offset;
+  SVN_ERR(svn_io_file_seek(file->file, APR_SET, &pos, scratch_pool));
+  SVN_ERR(svn_io_file_read_full2(file->file, buffer, size, &bytes_read,
+                                 NULL, scratch_pool));
+  *found = bytes_read == size;
+
+  return SVN_NO_ERROR;
+}
+
+/* Open the index file at PATH in FILE for reading and map it into memory
+ * if USE_MMAP is set.  Allocate everything in RESULT_POOL.  Use
+ * SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+open_mapped_file(mapped_file_t *file,
+                 const char *path,
+                 svn_boolean_t use_mmap,
+                 apr_pool_t *result_pool,
+                 apr_pool_t *scratch_pool)
+{
+  SVN_ERR(svn_io_file_open(&file->file, path, APR_READ, APR_OS_DEFAULT,
+                           result_pool));
+
+#if APR_HAS_MMAP
+  if (use_mmap)
+    {
+      file->map_pool = svn_pool_create(result_pool);
+      SVN_ERR(map_file(file, scratch_pool));
+    }
+#endif
+
+  return SVN_NO_ERROR;
+}
+
+/* (Re-)open the revprop index of FS for reading and store it in
+ * FS->FSAP_DATA, replacing any previously opened one.  If there is no
+ * index, the FILE members will be NULL.  Use SCRATCH_POOL for temporary
+ * allocations. */
+static svn_error_t *
+open_index(svn_fs_t *fs,
+           apr_pool_t *scratch_pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+  const char *path = svn_dirent_join(fs->path, REVPROP_INDEX_NAME,
+                                     scratch_pool);
+  apr_pool_t *pool = svn_pool_create(fs->pool);
+  revprop_index_t *index = apr_pcalloc(pool, sizeof(*index));
+  svn_error_t *err;
+
+  index->pool = pool;
+  index->checked_rev = ffd->youngest_rev_cache;
+
+  /* We must not keep the old files open while replacing them. */
+  if (ffd->revprop_index)
+    {
+      svn_pool_destroy(ffd->revprop_index->pool);
+      ffd->revprop_index = NULL;
+    }
+
+  err = open_mapped_file(&index->index, path, ffd->use_mmap, pool,
+                         scratch_pool);
+  if (err && APR_STATUS_IS_ENOENT(err->apr_err))
+    {
+      svn_error_clear(err);
+      index->index.file = NULL;
+    }
+  else
+    {
+      SVN_ERR(err);
+      SVN_ERR(read_index_header(index->index.file, path, scratch_pool));
+      SVN_ERR(open_mapped_file(&index->data,
+                               svn_dirent_join(fs->path,
+                                               REVPROP_INDEX_DATA_NAME,
+                                               scratch_pool),
+                               ffd->use_mmap, pool, scratch_pool));
+    }
+
+  ffd->revprop_index = index;
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_fs_fs__revprop_index_get(apr_hash_t **proplist_p,
+                             svn_fs_t *fs,
+                             svn_revnum_t rev,
+                             apr_pool_t *result_pool,
+                             apr_pool_t *scratch_pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+  revprop_index_t *index = ffd->revprop_index;
+  unsigned char record[RECORD_SIZE];
+  apr_uint32_t lengths[STANDARD_PROP_COUNT];
+  apr_uint64_t offset;
+  apr_uint64_t data_size = 0;
+  char *data;
+  svn_boolean_t found;
+  apr_hash_t *proplist;
+  int i;
+
+  *proplist_p = NULL;
+  if (!ffd->use_revprop_index)
+    return SVN_NO_ERROR;
+
+  /* Look for a newly created index file whenever HEAD moved on, but
+   * don't retry for the same HEAD again and again. */
+  if (   !index
+      || (!index->index.file && index->checked_rev < ffd->youngest_rev_cache))
+    {
+      SVN_ERR(open_index(fs, scratch_pool));
+      index = ffd->revprop_index;
+    }
+
+  if (!index->index.file)
+    return SVN_NO_ERROR;
+
+  SVN_ERR(read_range(&found, record, &index->index, record_offset(rev),
+                     RECORD_SIZE, scratch_pool));
+  if (!found)
+    return SVN_NO_ERROR;
+
+  offset = decode_uint64(record);
+  if (offset == NO_OFFSET)
+    return SVN_NO_ERROR;
+
+  for (i = 0; i < STANDARD_PROP_COUNT; ++i)
+    {
+      lengths[i] = decode_uint32(record + 8 + 4 * i);
+      if (lengths[i] != NO_VALUE)
+        data_size += lengths[i];
+    }
+
+  if (data_size > APR_SIZE_MAX - RECORD_CHECKSUM_OFFSET)
+    return SVN_NO_ERROR;
+
+  data = apr_palloc(scratch_pool, (apr_size_t)data_size + 1);
+  SVN_ERR(read_range(&found, data, &index->data, offset,
+                     (apr_size_t)data_size, scratch_pool));
+  if (!found)
+    return SVN_NO_ERROR;
+
+  /* The record may be in the process of being replaced. */
+  if (  record_checksum(record, data, (apr_size_t)data_size, scratch_pool)
+      != decode_uint32(record + RECORD_CHECKSUM_OFFSET))
+    return SVN_NO_ERROR;
+
+  proplist = svn_hash__make(result_pool);
+  for (i = 0; i < STANDARD_PROP_COUNT; ++i)
+    if (lengths[i] != NO_VALUE)
+      {
+        svn_hash_sets(proplist, standard_props[i],
+                      svn_string_ncreate(data, lengths[i], result_pool));
+        data += lengths[i];
+      }
+
+  *proplist_p = proplist;
+
+  return SVN_NO_ERROR;
+}
+
+
+/*** Modifying the index. ***/
+
+/* Open the revprop index of FS for modification and return it in *WRITER.
+ * Set *WRITER to NULL, if FS has no revprop index.  Allocate the result
+ * in RESULT_POOL and use SCRATCH_POOL for temporaries. */
+static svn_error_t *
+open_writer(index_writer_t **writer,
+            svn_fs_t *fs,
+            apr_pool_t *result_pool,
+            apr_pool_t *scratch_pool)
+{
+  const char *path = svn_dirent_join(fs->path, REVPROP_INDEX_NAME,
+                                     scratch_pool);
+  index_writer_t *result = apr_pcalloc(result_pool, sizeof(*result));
+  svn_filesize_t size;
+  svn_error_t *err;
+
+  *writer = NULL;
+  err = svn_io_file_open(&result->index_file, path, APR_READ | APR_WRITE,
+                         APR_OS_DEFAULT, result_pool);
+  if (err && APR_STATUS_IS_ENOENT(err->apr_err))
+    {
+      svn_error_clear(err);
+      return SVN_NO_ERROR;
+    }
+  SVN_ERR(err);
+
+  SVN_ERR(read_index_header(result->index_file, path, scratch_pool));
+
+  /* A partially written last record, e.g. after a crash, does not count
+   * and will simply be overwritten. */
+  SVN_ERR(svn_io_file_size_get(&size, result->index_file, scratch_pool));
+  result->record_count
+    = (svn_revnum_t)((size - INDEX_HEADER_SIZE) / RECORD_SIZE);
+
+  SVN_ERR(svn_io_file_open(&result->data_file,
+                           svn_dirent_join(fs->path, REVPROP_INDEX_DATA_NAME,
+                                           scratch_pool),
+                           APR_READ | APR_WRITE, APR_OS_DEFAULT,
+                           result_pool));
+  SVN_ERR(svn_io_file_size_get(&size, result->data_file, scratch_pool));
+  result->data_size = (apr_off_t)size;
+
+  *writer = result;
+
+  return SVN_NO_ERROR;
+}
+
+/* Close both files in WRITER.  Use SCRATCH_POOL for temporary
+ * allocations. */
+static svn_error_t *
+close_writer(index_writer_t *writer,
+             apr_pool_t *scratch_pool)
+{
+  SVN_ERR(svn_io_file_close(writer->data_file, scratch_pool));
+  return svn_error_trace(svn_io_file_close(writer->index_file,
+                                           scratch_pool));
+}
+
+/* Write RECORD as the record for REV to WRITER.  If FLUSH_TO_DISK is
+ * set, make sure it has been persisted before returning.  Use
+ * SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+write_record(index_writer_t *writer,
+             svn_revnum_t rev,
+             const unsigned char *record,
+             svn_boolean_t flush_to_disk,
+             apr_pool_t *scratch_pool)
+{
+  apr_off_t offset = record_offset(rev);
+
+  SVN_ERR_ASSERT(rev <= writer->record_count);
+
+  SVN_ERR(svn_io_file_seek(writer->index_file, APR_SET, &offset,
+                           scratch_pool));
+  SVN_ERR(svn_io_file_write_full(writer->index_file, record, RECORD_SIZE,
+                                 NULL, scratch_pool));
+  if (flush_to_disk)
+    SVN_ERR(svn_io_file_flush_to_disk(writer->index_file, scratch_pool));
+
+  if (rev == writer->record_count)
+    writer->record_count++;
+
+  return SVN_NO_ERROR;
+}
+
+/* Add PROPLIST to the data file in WRITER and write the record for REV
+ * to the index file.  If PROPLIST cannot be represented in the index,
+ * write an invalid record instead.  Use SCRATCH_POOL for temporary
+ * allocations. */
+static svn_error_t *
+add_revprops(index_writer_t *writer,
+             svn_revnum_t rev,
+             apr_hash_t *proplist,
+             apr_pool_t *scratch_pool)
+{
+  unsigned char record[RECORD_SIZE];
+  svn_stringbuf_t *data = svn_stringbuf_create_empty(scratch_pool);
+  unsigned int found = 0;
+  svn_boolean_t indexable = TRUE;
+  int i;
+
+  memset(record, 0, sizeof(record));
+  encode_uint64(record, (apr_uint64_t)writer->data_size);
+
+  for (i = 0; i < STANDARD_PROP_COUNT; ++i)
+    {
+      const svn_string_t *value = svn_hash_gets(proplist, standard_props[i]);
+      if (value && value->len < NO_VALUE)
+        {
+          encode_uint32(record + 8 + 4 * i, (apr_uint32_t)value->len);
+          svn_stringbuf_appendbytes(data, value->data, value->len);
+          ++found;
+        }
+      else
+        {
+          encode_uint32(record + 8 + 4 * i, NO_VALUE);
+          if (value)
+            indexable = FALSE;
+        }
+    }
+
+  /* Only index revisions with nothing but standard revprops such that
+   * the index alone can provide all their revprops. */
+  if (!indexable || found != apr_hash_count(proplist))
+    {
+      memset(record, 0xff, sizeof(record));
+      return svn_error_trace(write_record(writer, rev, record, FALSE,
+                                          scratch_pool));
+    }
+
+  encode_uint32(record + RECORD_CHECKSUM_OFFSET,
+                record_checksum(record, data->data, data->len,
+                                scratch_pool));
+
+  /* The data file only ever grows.  Readers won't look at the new data
+   * before the record for REV has been written. */
+  if (data->len)
+    {
+      apr_off_t offset = writer->data_size;
+      SVN_ERR(svn_io_file_seek(writer->data_file, APR_SET, &offset,
+                               scratch_pool));
+      SVN_ERR(svn_io_file_write_full(writer->data_file, data->data,
+                                     data->len, NULL, scratch_pool));
+      writer->data_size += data->len;
+    }
+
+  return svn_error_trace(write_record(writer, rev, record, FALSE,
+                                      scratch_pool));
+}
+
+svn_error_t *
+svn_fs_fs__revprop_index_invalidate(svn_fs_t *fs,
+                                    svn_revnum_t rev,
+                                    apr_pool_t *scratch_pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+  index_writer_t *writer;
+
+  SVN_ERR(open_writer(&writer, fs, scratch_pool, scratch_pool));
+  if (!writer)
+    return SVN_NO_ERROR;
+
+  /* Make sure that the outdated entry is gone for good before the caller
+   * replaces the revprops - even if we should crash in between. */
+  if (rev < writer->record_count)
+    {
+      unsigned char record[RECORD_SIZE];
+      memset(record, 0xff, sizeof(record));
+      SVN_ERR(write_record(writer, rev, record, ffd->flush_to_disk,
+                           scratch_pool));
+    }
+
+  return svn_error_trace(close_writer(writer, scratch_pool));
+}
+
+svn_error_t *
+svn_fs_fs__revprop_index_set(svn_fs_t *fs,
+                             svn_revnum_t rev,
+                             apr_hash_t *proplist,
+                             apr_pool_t *scratch_pool)
+{
+  index_writer_t *writer;
+
+  SVN_ERR(open_writer(&writer, fs, scratch_pool, scratch_pool));
+  if (!writer)
+    return SVN_NO_ERROR;
+
+  /* If a previous commit did not update the index, it does not cover all
+   * older revisions and can only be completed by the next pack run. */
+  if (rev <= writer->record_count)
+    SVN_ERR(add_revprops(writer, rev, proplist, scratch_pool));
+
+  return svn_error_trace(close_writer(writer, scratch_pool));
+}
+
+/* Create an empty revprop index for FS.  Use SCRATCH_POOL for temporary
+ * allocations. */
+static svn_error_t *
+create_index(svn_fs_t *fs,
+             apr_pool_t *scratch_pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+  svn_stringbuf_t *header = unparse_index_header(scratch_pool);
+
+  /* The data file must exist before the index file does. */
+  SVN_ERR(svn_io_file_create_empty(svn_dirent_join(fs->path,
+                                                   REVPROP_INDEX_DATA_NAME,
+                                                   scratch_pool),
+                                   scratch_pool));
+  SVN_ERR(svn_io_write_atomic2(svn_dirent_join(fs->path, REVPROP_INDEX_NAME,
+                                               scratch_pool),
+                               header->data, header->len,
+                               svn_fs_fs__path_current(fs, scratch_pool),
+                               ffd->flush_to_disk, scratch_pool));
+
+  return SVN_NO_ERROR;
+}
+
+/* Number of revisions to add to the index while holding the write lock
+ * once.  Releasing it in between allows for commits to proceed while
+ * the index is being built. */
+#define UPDATE_BATCH_SIZE 1000
+
+/* Baton type used by update_body(). */
+typedef struct update_baton_t
+{
+  svn_fs_t *fs;
+  svn_cancel_func_t cancel_func;
+  void *cancel_baton;
+
+  /* Set once the index covers all revisions. */
+  svn_boolean_t done;
+} update_baton_t;
+
+/* Implements svn_fs_fs__with_write_lock() 'body' callback type for an
+ * update_baton_t *BATON.  Create the revprop index unless it exists and
+ * add entries for up to UPDATE_BATCH_SIZE further revisions to it.
+ */
+static svn_error_t *
+update_body(void *baton,
+            apr_pool_t *pool)
+{
+  update_baton_t *ub = baton;
+  fs_fs_data_t *ffd = ub->fs->fsap_data;
+  index_writer_t *writer;
+  svn_revnum_t youngest;
+  svn_revnum_t first_rev;
+  svn_revnum_t rev;
+  apr_pool_t *iterpool;
+
+  SVN_ERR(open_writer(&writer, ub->fs, pool, pool));
+  if (!writer)
+    {
+      SVN_ERR(create_index(ub->fs, pool));
+      SVN_ERR(open_writer(&writer, ub->fs, pool, pool));
+    }
+
+  SVN_ERR(svn_fs_fs__youngest_rev(&youngest, ub->fs, pool));
+
+  first_rev = writer->record_count;
+  if (youngest >= first_rev + UPDATE_BATCH_SIZE)
+    youngest = first_rev + UPDATE_BATCH_SIZE - 1;
+  else
+    ub->done = TRUE;
+
+  iterpool = svn_pool_create(pool);
+  for (rev = first_rev; rev <= youngest; ++rev)
+    {
+      apr_hash_t *proplist;
+
+      svn_pool_clear(iterpool);
+      if (ub->cancel_func)
+        SVN_ERR(ub->cancel_func(ub->cancel_baton));
+
+      /* Don't trust any revprops cached before we took the write lock. */
+      SVN_ERR(svn_fs_fs__get_revision_proplist(&proplist, ub->fs, rev,
+                                               rev == first_rev,
+                                               iterpool, iterpool));
+      SVN_ERR(add_revprops(writer, rev, proplist, iterpool));
+    }
+  svn_pool_destroy(iterpool);
+
+  if (ffd->flush_to_disk)
+    {
+      SVN_ERR(svn_io_file_flush_to_disk(writer->data_file, pool));
+      SVN_ERR(svn_io_file_flush_to_disk(writer->index_file, pool));
+    }
+
+  return svn_error_trace(close_writer(writer, pool));
+}
+
+svn_error_t *
+svn_fs_fs__revprop_index_update(svn_fs_t *fs,
+                                svn_cancel_func_t cancel_func,
+                                void *cancel_baton,
+                                apr_pool_t *scratch_pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+  update_baton_t baton = { 0 };
+  apr_pool_t *iterpool;
+
+  if (!ffd->use_revprop_index)
+    return SVN_NO_ERROR;
+
+  baton.fs = fs;
+  baton.cancel_func = cancel_func;
+  baton.cancel_baton = cancel_baton;
+
+  iterpool = svn_pool_create(scratch_pool);
+  while (!baton.done)
+    {
+      svn_pool_clear(iterpool);
+      SVN_ERR(svn_fs_fs__with_write_lock(fs, update_body, &baton,
+                                         iterpool));
+    }
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
@@ -0,0 +1,86 @@
+/* revprop-index.h : interface to the FSFS index of standard revprops
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+#ifndef SVN_LIBSVN_FS_FS_REVPROP_INDEX_H
+#define SVN_LIBSVN_FS_FS_REVPROP_INDEX_H
+
+#include "svn_error.h"
+
+#include "fs.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+#define REVPROP_INDEX_NAME       "revprop-index"
+#define REVPROP_INDEX_DATA_NAME  "revprop-index.data"
+
+/* If the revprop index of FS has been enabled and has a valid entry for
+   revision REV, set *PROPLIST_P to the revprops of REV read from that
+   index.  Otherwise, set it to NULL.  The index only has entries for
+   revisions that have no revprops other than svn:author, svn:date and
+   svn:log.
+
+   Allocate *PROPLIST_P in RESULT_POOL and use SCRATCH_POOL for
+   temporaries. */
+svn_error_t *
+svn_fs_fs__revprop_index_get(apr_hash_t **proplist_p,
+                             svn_fs_t *fs,
+                             svn_revnum_t rev,
+                             apr_pool_t *result_pool,
+                             apr_pool_t *scratch_pool);
+
+/* If FS has a revprop index that covers revision REV, mark the entry
+   for REV as invalid.  This must be called with the FS write lock held
+   before changing the revprops of REV.  Use SCRATCH_POOL for temporary
+   allocations. */
+svn_error_t *
+svn_fs_fs__revprop_index_invalidate(svn_fs_t *fs,
+                                    svn_revnum_t rev,
+                                    apr_pool_t *scratch_pool);
+
+/* If FS has a revprop index that covers all revisions before REV, record
+   PROPLIST as the revprops of REV in it.  Otherwise, this is a no-op.
+
+   This must be called with the FS write lock held after the revprops of
+   REV have been written.  Use SCRATCH_POOL for temporary allocations. */
+svn_error_t *
+svn_fs_fs__revprop_index_set(svn_fs_t *fs,
+                             svn_revnum_t rev,
+                             apr_hash_t *proplist,
+                             apr_pool_t *scratch_pool);
+
+/* If the revprop index has been enabled for FS, create it unless it
+   exists already and add entries for all revisions that it does not
+   cover, yet.  Takes out the FS write lock repeatedly for batches of
+   revisions.  Use SCRATCH_POOL for temporary allocations. */
+svn_error_t *
+svn_fs_fs__revprop_index_update(svn_fs_t *fs,
+                                svn_cancel_func_t cancel_func,
+                                void *cancel_baton,
+                                apr_pool_t *scratch_pool);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* SVN_LIBSVN_FS_FS_REVPROP_INDEX_H */
@@ -29,6 +29,7 @@
 
 #include "fs_fs.h"
 #include "revprops.h"
+#include "revprop-index.h"
 #include "temp_serializer.h"
 #include "util.h"
 
@@ -781,6 +782,12 @@ svn_fs_fs__get_revision_proplist(apr_hash_t **proplist_p,
         return SVN_NO_ERROR;
     }
 
+  /* The revprop index is always up-to-date, if it provides REV at all. */
+  SVN_ERR(svn_fs_fs__revprop_index_get(proplist_p, fs, rev, result_pool,
+                                       scratch_pool));
+  if (*proplist_p)
+    return SVN_NO_ERROR;
+
   /* if REV had not been packed when we began, try reading it from the
    * non-packed shard.  If that fails, we will fall through to packed
    * shard reads. */
@@ -1257,10 +1264,17 @@ svn_fs_fs__set_revision_proplist(svn_fs_t *fs,
    */
   perms_reference = svn_fs_fs__path_rev_absolute(fs, rev, pool);
 
+  /* Readers must not get the old revprops from the index anymore once
+   * the new ones have become visible. */
+  SVN_ERR(svn_fs_fs__revprop_index_invalidate(fs, rev, pool));
+
   /* Now, switch to the new revprop data. */
   SVN_ERR(switch_to_new_revprop(fs, final_path, tmp_path, perms_reference,
                                 files_to_delete, pool));
 
+  /* Revprops that can't be indexed will simply keep the invalid entry. */
+  SVN_ERR(svn_fs_fs__revprop_index_set(fs, rev, proplist, pool));
+
   return SVN_NO_ERROR;
 }
 
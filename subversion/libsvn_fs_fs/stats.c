@@ -26,8 +26,10 @@
 #include "svn_sorts.h"
 
 #include "private/svn_cache.h"
+#include "private/svn_packed_data.h"
 #include "private/svn_sorts_private.h"
 #include "private/svn_string_private.h"
+#include "private/svn_task.h"
 
 #include "index.h"
 #include "pack.h"
@@ -123,6 +125,16 @@ typedef struct rep_ref_t
 
 } rep_ref_t;
 
+/* Identifies a representation by its location. */
+typedef struct rep_key_t
+{
+  /* Revision that contains the representation. */
+  svn_revnum_t revision;
+
+  /* Item index of the rep within REVISION. */
+  apr_uint64_t item_index;
+} rep_key_t;
+
 /* Represents a single revision.
  * There will be only one instance per revision. */
 typedef struct revision_info_t
@@ -182,9 +194,19 @@ typedef struct query_t
   /* First non-packed revision. */
   svn_revnum_t min_unpacked_rev;
 
-  /* all revisions */
+  /* First revision in REVISIONS. */
+  svn_revnum_t first_rev;
+
+  /* all revisions, starting at FIRST_REV */
   apr_array_header_t *revisions;
 
+  /* Delta chain links (rep_ref_t *) that have not been resolved, yet. */
+  apr_array_header_t *rep_refs;
+
+  /* References (rep_key_t) from noderevs in REVISIONS to representations
+   * in revisions before FIRST_REV. */
+  apr_array_header_t *external_refs;
+
   /* empty representation.
    * Used as a dummy base for DELTA reps without base. */
   rep_stats_t *null_base;
@@ -205,6 +227,35 @@ typedef struct query_t
   void *cancel_baton;
 } query_t;
 
+/* Statistics gathered from a single rev / pack file, i.e. for revisions
+ * FIRST_REV to FIRST_REV + COUNT - 1.  This is what we cache per shard.
+ */
+typedef struct file_stats_t
+{
+  /* First revision covered. */
+  svn_revnum_t first_rev;
+
+  /* Number of revisions covered. */
+  int count;
+
+  /* Identifies the pack file contents that this info has been gathered
+   * from.  NULL for non-packed revisions, which we don't cache. */
+  const char *fingerprint;
+
+  /* revision_info_t * for all covered revisions. */
+  apr_array_header_t *revisions;
+
+  /* Unresolved delta chain links, see query_t. */
+  apr_array_header_t *rep_refs;
+
+  /* References to representations in older files, see query_t. */
+  apr_array_header_t *external_refs;
+
+  /* Histograms, largest changes and per-extension info for the
+   * representations in this file.  All other members are 0. */
+  svn_fs_fs__stats_t *stats;
+} file_stats_t;
+
 /* Initialize the LARGEST_CHANGES member in STATS with a capacity of COUNT
  * entries.  Allocate the result in RESULT_POOL.
  */
@@ -255,24 +306,36 @@ add_to_histogram(svn_fs_fs__histogram_t *histogram,
   histogram->lines[(apr_size_t)shift].sum += size;
 }
 
-/* Update data aggregators in STATS with this representation of type KIND,
- * on-disk REP_SIZE and expanded node size EXPANDED_SIZE for PATH in REVSION.
- * PLAIN_ADDED indicates whether the node has a deltification predecessor.
+/* Add HISTOGRAM to the TARGET histogram.
  */
 static void
-add_change(svn_fs_fs__stats_t *stats,
-           apr_uint64_t rep_size,
-           apr_uint64_t expanded_size,
-           svn_revnum_t revision,
-           const char *path,
-           rep_kind_t kind,
-           svn_boolean_t plain_added)
+merge_histogram(svn_fs_fs__histogram_t *target,
+                const svn_fs_fs__histogram_t *histogram)
 {
-  /* identify largest reps */
-  if (rep_size >= stats->largest_changes->min_size)
+  apr_size_t i;
+
+  target->total.count += histogram->total.count;
+  target->total.sum += histogram->total.sum;
+
+  for (i = 0; i < sizeof(target->lines) / sizeof(target->lines[0]); ++i)
+    {
+      target->lines[i].count += histogram->lines[i].count;
+      target->lines[i].sum += histogram->lines[i].sum;
+    }
+}
+
+/* Add a change of REP_SIZE bytes to PATH in REVISION to LARGEST_CHANGES
+ * if it is large enough.
+ */
+static void
+add_large_change(svn_fs_fs__largest_changes_t *largest_changes,
+                 apr_uint64_t rep_size,
+                 svn_revnum_t revision,
+                 const char *path)
+{
+  if (rep_size >= largest_changes->min_size)
     {
       apr_size_t i;
-      svn_fs_fs__largest_changes_t *largest_changes = stats->largest_changes;
       svn_fs_fs__large_change_info_t *info
         = largest_changes->changes[largest_changes->count - 1];
       info->size = rep_size;
@@ -291,6 +354,45 @@ add_change(svn_fs_fs__stats_t *stats,
       largest_changes->min_size
         = largest_changes->changes[largest_changes->count-1]->size;
     }
+}
+
+/* Return the info for EXTENSION in STATS.  Auto-create it if necessary.
+ */
+static svn_fs_fs__extension_info_t *
+get_extension_info(svn_fs_fs__stats_t *stats,
+                   const char *extension)
+{
+  svn_fs_fs__extension_info_t *info
+    = apr_hash_get(stats->by_extension, extension, APR_HASH_KEY_STRING);
+
+  if (info == NULL)
+    {
+      apr_pool_t *pool = apr_hash_pool_get(stats->by_extension);
+      info = apr_pcalloc(pool, sizeof(*info));
+      info->extension = apr_pstrdup(pool, extension);
+
+      apr_hash_set(stats->by_extension, info->extension,
+                   APR_HASH_KEY_STRING, info);
+    }
+
+  return info;
+}
+
+/* Update data aggregators in STATS with this representation of type KIND,
+ * on-disk REP_SIZE and expanded node size EXPANDED_SIZE for PATH in REVSION.
+ * PLAIN_ADDED indicates whether the node has a deltification predecessor.
+ */
+static void
+add_change(svn_fs_fs__stats_t *stats,
+           apr_uint64_t rep_size,
+           apr_uint64_t expanded_size,
+           svn_revnum_t revision,
+           const char *path,
+           rep_kind_t kind,
+           svn_boolean_t plain_added)
+{
+  /* identify largest reps */
+  add_large_change(stats->largest_changes, rep_size, revision, path);
 
   /* global histograms */
   add_to_histogram(&stats->rep_size_histogram, rep_size);
@@ -338,16 +440,7 @@ add_change(svn_fs_fs__stats_t *stats,
         extension = "(none)";
 
       /* get / auto-insert entry for this extension */
-      info = apr_hash_get(stats->by_extension, extension, APR_HASH_KEY_STRING);
-      if (info == NULL)
-        {
-          apr_pool_t *pool = apr_hash_pool_get(stats->by_extension);
-          info = apr_pcalloc(pool, sizeof(*info));
-          info->extension = apr_pstrdup(pool, extension);
-
-          apr_hash_set(stats->by_extension, info->extension,
-                       APR_HASH_KEY_STRING, info);
-        }
+      info = get_extension_info(stats, extension);
 
       /* update per-extension histogram */
       add_to_histogram(&info->node_histogram, expanded_size);
@@ -370,6 +463,21 @@ compare_representation_item_index(const void *data, const void *key)
   return (lhs > rhs ? 1 : 0);
 }
 
+/* Return the revision_info_t object for REVISION in QUERY or NULL if
+ * REVISION is not covered by QUERY.
+ */
+static revision_info_t *
+get_revision_info(query_t *query,
+                  svn_revnum_t revision)
+{
+  if (   revision < query->first_rev
+      || revision - query->first_rev >= query->revisions->nelts)
+    return NULL;
+
+  return APR_ARRAY_IDX(query->revisions, revision - query->first_rev,
+                       revision_info_t *);
+}
+
 /* Find the revision_info_t object to the given REVISION in QUERY and
  * return it in *REVISION_INFO. For performance reasons, we skip the
  * lookup if the info is already provided.
@@ -393,7 +501,7 @@ find_representation(int *idx,
   info = revision_info ? *revision_info : NULL;
   if (info == NULL || info->revision != revision)
     {
-      info = APR_ARRAY_IDX(query->revisions, revision, revision_info_t*);
+      info = get_revision_info(query, revision);
       if (revision_info)
         *revision_info = info;
     }
@@ -458,6 +566,7 @@ parse_representation(rep_stats_t **representation,
       if (!svn_fs_fs__use_log_addressing(query->fs))
         {
           svn_fs_fs__rep_header_t *header;
+          rep_ref_t *ref;
           apr_off_t offset = revision_info->offset
                            + (apr_off_t)rep->item_index;
 
@@ -470,22 +579,25 @@ parse_representation(rep_stats_t **representation,
 
           result->header_size = header->header_size;
 
-          /* Determine length of the delta chain. */
+          /* Remember the delta chain link.  The base may be in a rev / pack
+           * file that we did not read, so resolve it later. */
+          ref = apr_pcalloc(result_pool, sizeof(*ref));
+          ref->revision = rep->revision;
+          ref->item_index = rep->item_index;
+          ref->header_size = header->header_size;
+
           if (header->type == svn_fs_fs__rep_delta)
             {
-              int base_idx;
-              rep_stats_t *base_rep
-                = find_representation(&base_idx, query, NULL,
-                                      header->base_revision,
-                                      header->base_item_index);
-
-              result->chain_length = 1 + MIN(base_rep->chain_length,
-                                             (apr_byte_t)0xfe);
+              ref->base_revision = header->base_revision;
+              ref->base_item_index = header->base_item_index;
             }
           else
             {
-              result->chain_length = 1;
+              ref->base_revision = SVN_INVALID_REVNUM;
+              ref->base_item_index = SVN_FS_FS__ITEM_INDEX_UNUSED;
             }
+
+          APR_ARRAY_PUSH(query->rep_refs, rep_ref_t *) = ref;
         }
 
       SVN_ERR(svn_sort__array_insert2(revision_info->representations, &result, idx));
@@ -596,6 +708,29 @@ parse_dir(query_t *query,
   return SVN_NO_ERROR;
 }
 
+/* If REP is stored in a revision before QUERY->FIRST_REV, record the
+ * reference to it in QUERY and return TRUE.  Return FALSE otherwise.
+ *
+ * Such reps have already been referenced by the noderev that created
+ * them, i.e. this is just a shared use that will bump the rep's reference
+ * count when the results get merged.
+ */
+static svn_boolean_t
+add_external_ref(query_t *query,
+                 representation_t *rep)
+{
+  rep_key_t *key;
+
+  if (rep->revision >= query->first_rev)
+    return FALSE;
+
+  key = apr_array_push(query->external_refs);
+  key->revision = rep->revision;
+  key->item_index = rep->item_index;
+
+  return TRUE;
+}
+
 /* Parse the noderev given as NODEREV_STR and store the info in QUERY and
  * REVISION_INFO.  In phys. addressing mode, continue reading all DAG nodes,
  * directories and representations linked in that tree structure.
@@ -622,7 +757,7 @@ read_noderev(query_t *query,
   SVN_ERR(svn_fs_fs__fixup_expanded_size(query->fs, noderev->prop_rep,
                                          scratch_pool));
 
-  if (noderev->data_rep)
+  if (noderev->data_rep && !add_external_ref(query, noderev->data_rep))
     {
       SVN_ERR(parse_representation(&text, query,
                                    noderev->data_rep, revision_info,
@@ -633,7 +768,7 @@ read_noderev(query_t *query,
         text->kind = noderev->kind == svn_node_dir ? dir_rep : file_rep;
     }
 
-  if (noderev->prop_rep)
+  if (noderev->prop_rep && !add_external_ref(query, noderev->prop_rep))
     {
       SVN_ERR(parse_representation(&props, query,
                                    noderev->prop_rep, revision_info,
@@ -817,10 +952,6 @@ read_phys_pack_file(query_t *query,
   /* Done with this pack file. */
   SVN_ERR(svn_fs_fs__close_revision_file(rev_file));
 
-  /* one more pack file processed */
-  if (query->progress_func)
-    query->progress_func(base, query->progress_baton, scratch_pool);
-
   return SVN_NO_ERROR;
 }
 
@@ -866,15 +997,6 @@ read_phys_revision_file(query_t *query,
   /* put it into our container */
   APR_ARRAY_PUSH(query->revisions, revision_info_t*) = info;
 
-  /* show progress every 1000 revs or so */
-  if (query->progress_func)
-    {
-      if (query->shard_size && (revision % query->shard_size == 0))
-        query->progress_func(revision, query->progress_baton, scratch_pool);
-      if (!query->shard_size && (revision % 1000 == 0))
-        query->progress_func(revision, query->progress_baton, scratch_pool);
-    }
-
   return SVN_NO_ERROR;
 }
 
@@ -940,6 +1062,7 @@ compare_representation_refs(const void *lhs, const void *rhs)
 
 /* Given all the presentations found in a single rev / pack file as
  * rep_ref_t * in REP_REFS, update the delta chain lengths in QUERY.
+ * All older rev / pack files must already be in QUERY.
  * REP_REFS and its contents can then be discarded.
  */
 static svn_error_t *
@@ -1008,12 +1131,6 @@ read_log_rev_or_packfile(query_t *query,
   int i;
   svn_fs_fs__revision_file_t *rev_file;
 
-  /* We collect the delta chain links as we scan the file.  Afterwards,
-   * we determine the lengths of those delta chains and throw this
-   * temporary container away. */
-  apr_array_header_t *rep_refs = apr_array_make(scratch_pool, 64,
-                                                sizeof(rep_ref_t *));
-
   /* we will process every revision in the rev / pack file */
   for (i = 0; i < count; ++i)
     {
@@ -1034,7 +1151,7 @@ read_log_rev_or_packfile(query_t *query,
 
   /* record the whole pack size in the first rev so the total sum will
      still be correct */
-  APR_ARRAY_IDX(query->revisions, base, revision_info_t*)->end = max_offset;
+  get_revision_info(query, base)->end = max_offset;
 
   /* for all offsets in the file, get the P2L index entries and process
      the interesting items (change lists, noderevs) */
@@ -1070,8 +1187,7 @@ read_log_rev_or_packfile(query_t *query,
             continue;
 
           /* read and process interesting items */
-          info = APR_ARRAY_IDX(query->revisions, entry->item.revision,
-                               revision_info_t*);
+          info = get_revision_info(query, entry->item.revision);
 
           if (entry->type == SVN_FS_FS__ITEM_TYPE_NODEREV)
             {
@@ -1090,9 +1206,10 @@ read_log_rev_or_packfile(query_t *query,
                    || (entry->type == SVN_FS_FS__ITEM_TYPE_FILE_PROPS)
                    || (entry->type == SVN_FS_FS__ITEM_TYPE_DIR_PROPS))
             {
-              /* Collect the delta chain link. */
+              /* Collect the delta chain link.  We will determine the
+               * lengths of those delta chains when merging the results. */
               svn_fs_fs__rep_header_t *header;
-              rep_ref_t *ref = apr_pcalloc(scratch_pool, sizeof(*ref));
+              rep_ref_t *ref = apr_pcalloc(result_pool, sizeof(*ref));
 
               SVN_ERR(svn_io_file_aligned_seek(rev_file->file,
                                                rev_file->block_size,
@@ -1117,7 +1234,7 @@ read_log_rev_or_packfile(query_t *query,
                   ref->base_revision = SVN_INVALID_REVNUM;
                 }
 
-              APR_ARRAY_PUSH(rep_refs, rep_ref_t *) = ref;
+              APR_ARRAY_PUSH(query->rep_refs, rep_ref_t *) = ref;
             }
 
           /* advance offset */
@@ -1125,108 +1242,12 @@ read_log_rev_or_packfile(query_t *query,
         }
     }
 
-  /* Resolve the delta chain links. */
-  SVN_ERR(resolve_representation_refs(query, rep_refs));
-
   /* clean up and close file handles */
   svn_pool_destroy(iterpool);
 
   return SVN_NO_ERROR;
 }
 
-/* Read the content of the pack file staring at revision BASE logical
- * addressing mode and store it in QUERY.
- *
- * Use RESULT_POOL for persistent allocations and SCRATCH_POOL for
- * temporaries.
- */
-static svn_error_t *
-read_log_pack_file(query_t *query,
-                   svn_revnum_t base,
-                   apr_pool_t *result_pool,
-                   apr_pool_t *scratch_pool)
-{
-  SVN_ERR(read_log_rev_or_packfile(query, base, query->shard_size,
-                                   result_pool, scratch_pool));
-
-  /* one more pack file processed */
-  if (query->progress_func)
-    query->progress_func(base, query->progress_baton, scratch_pool);
-
-  return SVN_NO_ERROR;
-}
-
-/* Read the content of the file for REVISION in logical addressing mode
- * and store its contents in QUERY.
- *
- * Use RESULT_POOL for persistent allocations and SCRATCH_POOL for
- * temporaries.
- */
-static svn_error_t *
-read_log_revision_file(query_t *query,
-                       svn_revnum_t revision,
-                       apr_pool_t *result_pool,
-                       apr_pool_t *scratch_pool)
-{
-  SVN_ERR(read_log_rev_or_packfile(query, revision, 1,
-                                   result_pool, scratch_pool));
-
-  /* show progress every 1000 revs or so */
-  if (query->progress_func)
-    {
-      if (query->shard_size && (revision % query->shard_size == 0))
-        query->progress_func(revision, query->progress_baton, scratch_pool);
-      if (!query->shard_size && (revision % 1000 == 0))
-        query->progress_func(revision, query->progress_baton, scratch_pool);
-    }
-
-  return SVN_NO_ERROR;
-}
-
-/* Read the repository and collect the stats info in QUERY.
- *
- * Use RESULT_POOL for persistent allocations and SCRATCH_POOL for
- * temporaries.
- */
-static svn_error_t *
-read_revisions(query_t *query,
-               apr_pool_t *result_pool,
-               apr_pool_t *scratch_pool)
-{
-  apr_pool_t *iterpool = svn_pool_create(scratch_pool);
-  svn_revnum_t revision;
-
-  /* read all packed revs */
-  for ( revision = 0
-      ; revision < query->min_unpacked_rev
-      ; revision += query->shard_size)
-    {
-      svn_pool_clear(iterpool);
-
-      if (svn_fs_fs__use_log_addressing(query->fs))
-        SVN_ERR(read_log_pack_file(query, revision, result_pool, iterpool));
-      else
-        SVN_ERR(read_phys_pack_file(query, revision, result_pool, iterpool));
-    }
-
-  /* read non-packed revs */
-  for ( ; revision <= query->head; ++revision)
-    {
-      svn_pool_clear(iterpool);
-
-      if (svn_fs_fs__use_log_addressing(query->fs))
-        SVN_ERR(read_log_revision_file(query, revision, result_pool,
-                                       iterpool));
-      else
-        SVN_ERR(read_phys_revision_file(query, revision, result_pool,
-                                        iterpool));
-    }
-
-  svn_pool_destroy(iterpool);
-
-  return SVN_NO_ERROR;
-}
-
 /* Accumulate stats of REP in STATS.
  */
 static void
@@ -1360,8 +1381,12 @@ create_query(query_t **query,
    * of both the nelts field of the array and our revision numbers). This
    * means this code will fail on platforms where int is less than 32-bits
    * and the repository has more revisions than int can hold. */
+  (*query)->first_rev = 0;
   (*query)->revisions = apr_array_make(result_pool, (int) (*query)->head + 1,
                                        sizeof(revision_info_t *));
+  (*query)->rep_refs = apr_array_make(result_pool, 0, sizeof(rep_ref_t *));
+  (*query)->external_refs = apr_array_make(result_pool, 0,
+                                           sizeof(rep_key_t));
   (*query)->null_base = apr_pcalloc(result_pool,
                                     sizeof(*(*query)->null_base));
 
@@ -1376,9 +1401,897 @@ create_query(query_t **query,
   return SVN_NO_ERROR;
 }
 
+/* Create a *QUERY, allocated in RESULT_POOL, for reading the revisions
+ * FIRST_REV to FIRST_REV + COUNT - 1 from FS.  Take the repository
+ * dimensions from PARENT.  Results will be collected in a new stats
+ * object.  Store CANCEL_FUNC and CANCEL_BATON in *QUERY, too.
+ */
+static void
+create_file_query(query_t **query,
+                  const query_t *parent,
+                  svn_fs_t *fs,
+                  svn_revnum_t first_rev,
+                  int count,
+                  svn_cancel_func_t cancel_func,
+                  void *cancel_baton,
+                  apr_pool_t *result_pool)
+{
+  *query = apr_pcalloc(result_pool, sizeof(**query));
+
+  (*query)->fs = fs;
+  (*query)->head = parent->head;
+  (*query)->shard_size = parent->shard_size;
+  (*query)->min_unpacked_rev = parent->min_unpacked_rev;
+  (*query)->first_rev = first_rev;
+  (*query)->revisions = apr_array_make(result_pool, count,
+                                       sizeof(revision_info_t *));
+  (*query)->rep_refs = apr_array_make(result_pool, 64, sizeof(rep_ref_t *));
+  (*query)->external_refs = apr_array_make(result_pool, 16,
+                                           sizeof(rep_key_t));
+  (*query)->null_base = apr_pcalloc(result_pool,
+                                    sizeof(*(*query)->null_base));
+  (*query)->stats = create_stats(result_pool);
+  (*query)->cancel_func = cancel_func;
+  (*query)->cancel_baton = cancel_baton;
+}
+
+
+/*** Per-file results and their persistent cache. ***/
+
+/* Number of histograms in svn_fs_fs__stats_t that get filled by
+ * add_change() directly, i.e. not counting the per-extension ones.
+ */
+#define CHANGE_HISTOGRAM_COUNT 13
+
+/* Version number of the stats cache file format. */
+#define STATS_CACHE_FORMAT 1
+
+/* Set HISTOGRAMS[0 .. CHANGE_HISTOGRAM_COUNT-1] to the histograms in
+ * STATS that are being filled by add_change(), in a fixed order.
+ */
+static void
+get_change_histograms(svn_fs_fs__histogram_t **histograms,
+                      svn_fs_fs__stats_t *stats)
+{
+  histograms[0] = &stats->rep_size_histogram;
+  histograms[1] = &stats->node_size_histogram;
+  histograms[2] = &stats->added_rep_size_histogram;
+  histograms[3] = &stats->added_node_size_histogram;
+  histograms[4] = &stats->unused_rep_histogram;
+  histograms[5] = &stats->file_histogram;
+  histograms[6] = &stats->file_rep_histogram;
+  histograms[7] = &stats->file_prop_histogram;
+  histograms[8] = &stats->file_prop_rep_histogram;
+  histograms[9] = &stats->dir_histogram;
+  histograms[10] = &stats->dir_rep_histogram;
+  histograms[11] = &stats->dir_prop_histogram;
+  histograms[12] = &stats->dir_prop_rep_histogram;
+}
+
+/* Add the histograms, largest changes and per-extension info collected
+ * by add_change() in SOURCE to TARGET.
+ */
+static void
+merge_stats(svn_fs_fs__stats_t *target,
+            svn_fs_fs__stats_t *source)
+{
+  svn_fs_fs__histogram_t *target_histograms[CHANGE_HISTOGRAM_COUNT];
+  svn_fs_fs__histogram_t *source_histograms[CHANGE_HISTOGRAM_COUNT];
+  apr_hash_index_t *hi;
+  apr_size_t i;
+
+  get_change_histograms(target_histograms, target);
+  get_change_histograms(source_histograms, source);
+  for (i = 0; i < CHANGE_HISTOGRAM_COUNT; ++i)
+    merge_histogram(target_histograms[i], source_histograms[i]);
+
+  for (i = 0; i < source->largest_changes->count; ++i)
+    {
+      svn_fs_fs__large_change_info_t *info
+        = source->largest_changes->changes[i];
+      if (SVN_IS_VALID_REVNUM(info->revision))
+        add_large_change(target->largest_changes, info->size,
+                         info->revision, info->path->data);
+    }
+
+  for (hi = apr_hash_first(NULL, source->by_extension);
+       hi;
+       hi = apr_hash_next(hi))
+    {
+      svn_fs_fs__extension_info_t *info = apr_hash_this_val(hi);
+      svn_fs_fs__extension_info_t *target_info
+        = get_extension_info(target, info->extension);
+
+      merge_histogram(&target_info->rep_histogram, &info->rep_histogram);
+      merge_histogram(&target_info->node_histogram, &info->node_histogram);
+    }
+}
+
+/* Return a deep copy of INFO, allocated in RESULT_POOL.
+ */
+static revision_info_t *
+copy_revision_info(const revision_info_t *info,
+                   apr_pool_t *result_pool)
+{
+  int i;
+  int count = info->representations->nelts;
+  revision_info_t *copy = apr_pmemdup(result_pool, info, sizeof(*info));
+  rep_stats_t *reps = apr_palloc(result_pool, MAX(count, 1) * sizeof(*reps));
+
+  copy->rev_file = NULL;
+  copy->representations = apr_array_make(result_pool, count,
+                                         sizeof(rep_stats_t *));
+  for (i = 0; i < count; ++i)
+    {
+      reps[i] = *APR_ARRAY_IDX(info->representations, i, rep_stats_t *);
+      APR_ARRAY_PUSH(copy->representations, rep_stats_t *) = &reps[i];
+    }
+
+  return copy;
+}
+
+/* Set *FINGERPRINT to a string identifying the contents of the pack file
+ * starting at FIRST_REV in FS.  Allocate it in RESULT_POOL and use
+ * SCRATCH_POOL for temporary allocations.
+ *
+ * Checksumming the whole pack file would be almost as expensive as
+ * gathering the stats.  For logically addressed repositories, the index
+ * checksums are just as good because the P2L index contains checksums of
+ * every item.  For physical addressing, use size and timestamp instead.
+ */
+static svn_error_t *
+get_pack_fingerprint(const char **fingerprint,
+                     svn_fs_t *fs,
+                     svn_revnum_t first_rev,
+                     apr_pool_t *result_pool,
+                     apr_pool_t *scratch_pool)
+{
+  svn_fs_fs__revision_file_t *rev_file;
+  apr_finfo_t finfo;
+
+  SVN_ERR(svn_fs_fs__open_pack_or_rev_file(&rev_file, fs, first_rev,
+                                           scratch_pool, scratch_pool));
+  SVN_ERR(svn_io_file_info_get(&finfo, APR_FINFO_SIZE | APR_FINFO_MTIME,
+                               rev_file->file, scratch_pool));
+
+  if (svn_fs_fs__use_log_addressing(fs))
+    {
+      SVN_ERR(svn_fs_fs__auto_read_footer(rev_file));
+      *fingerprint
+        = apr_psprintf(result_pool, "%" APR_OFF_T_FMT " %s %s", finfo.size,
+                       svn_checksum_to_cstring(rev_file->l2p_checksum,
+                                               scratch_pool),
+                       svn_checksum_to_cstring(rev_file->p2l_checksum,
+                                               scratch_pool));
+    }
+  else
+    {
+      *fingerprint
+        = apr_psprintf(result_pool, "%" APR_OFF_T_FMT " %" APR_TIME_T_FMT,
+                       finfo.size, finfo.mtime);
+    }
+
+  return svn_error_trace(svn_fs_fs__close_revision_file(rev_file));
+}
+
+/* Append HISTOGRAM to STREAM.
+ */
+static void
+write_histogram(svn_packed__int_stream_t *stream,
+                const svn_fs_fs__histogram_t *histogram)
+{
+  apr_size_t i;
+
+  svn_packed__add_uint(stream, histogram->total.count);
+  svn_packed__add_uint(stream, histogram->total.sum);
+  for (i = 0; i < sizeof(histogram->lines) / sizeof(histogram->lines[0]); ++i)
+    {
+      svn_packed__add_uint(stream, histogram->lines[i].count);
+      svn_packed__add_uint(stream, histogram->lines[i].sum);
+    }
+}
+
+/* Read the next histogram from STREAM into HISTOGRAM.
+ */
+static void
+read_histogram(svn_fs_fs__histogram_t *histogram,
+               svn_packed__int_stream_t *stream)
+{
+  apr_size_t i;
+
+  histogram->total.count = svn_packed__get_uint(stream);
+  histogram->total.sum = svn_packed__get_uint(stream);
+  for (i = 0; i < sizeof(histogram->lines) / sizeof(histogram->lines[0]); ++i)
+    {
+      histogram->lines[i].count = svn_packed__get_uint(stream);
+      histogram->lines[i].sum = svn_packed__get_uint(stream);
+    }
+}
+
+/* Create a new int stream in ROOT with SUBSTREAMS sub-streams.  If DIFF
+ * is set, deltify the first sub-stream.
+ */
+static svn_packed__int_stream_t *
+create_table_stream(svn_packed__data_root_t *root,
+                    int substreams,
+                    svn_boolean_t diff)
+{
+  svn_packed__int_stream_t *stream
+    = svn_packed__create_int_stream(root, FALSE, FALSE);
+  int i;
+
+  for (i = 0; i < substreams; ++i)
+    svn_packed__create_int_substream(stream, diff && i == 0, FALSE);
+
+  return stream;
+}
+
+/* Serialize FSTATS as a single cache record and append it to STREAM.
+ * If FSTATS is NULL, write an end-of-file marker.  Use SCRATCH_POOL for
+ * temporary allocations.
+ */
+static svn_error_t *
+write_file_stats(svn_stream_t *stream,
+                 file_stats_t *fstats,
+                 apr_pool_t *scratch_pool)
+{
+  svn_packed__data_root_t *root = svn_packed__data_create_root(scratch_pool);
+  svn_packed__int_stream_t *header_stream
+    = svn_packed__create_int_stream(root, FALSE, TRUE);
+  svn_packed__int_stream_t *revs_stream = create_table_stream(root, 9, TRUE);
+  svn_packed__int_stream_t *reps_stream = create_table_stream(root, 6, TRUE);
+  svn_packed__int_stream_t *refs_stream = create_table_stream(root, 5, TRUE);
+  svn_packed__int_stream_t *external_stream
+    = create_table_stream(root, 2, FALSE);
+  svn_packed__int_stream_t *changes_stream
+    = create_table_stream(root, 2, FALSE);
+  svn_packed__int_stream_t *histogram_stream
+    = svn_packed__create_int_stream(root, FALSE, FALSE);
+  svn_packed__byte_stream_t *strings_stream
+    = svn_packed__create_bytes_stream(root);
+
+  svn_fs_fs__histogram_t *histograms[CHANGE_HISTOGRAM_COUNT];
+  svn_fs_fs__largest_changes_t *largest_changes;
+  apr_array_header_t *extensions;
+  apr_size_t change_count = 0;
+  apr_size_t j;
+  int i, k;
+
+  svn_packed__add_uint(header_stream, STATS_CACHE_FORMAT);
+  if (fstats == NULL)
+    {
+      svn_packed__add_int(header_stream, SVN_INVALID_REVNUM);
+      svn_packed__add_int(header_stream, 0);
+      return svn_error_trace(svn_packed__data_write(stream, root,
+                                                    scratch_pool));
+    }
+
+  largest_changes = fstats->stats->largest_changes;
+  for (j = 0; j < largest_changes->count; ++j)
+    if (SVN_IS_VALID_REVNUM(largest_changes->changes[j]->revision))
+      ++change_count;
+
+  extensions = svn_sort__hash(fstats->stats->by_extension,
+                              svn_sort_compare_items_lexically,
+                              scratch_pool);
+
+  svn_packed__add_int(header_stream, fstats->first_rev);
+  svn_packed__add_int(header_stream, fstats->count);
+  svn_packed__add_int(header_stream, fstats->rep_refs->nelts);
+  svn_packed__add_int(header_stream, fstats->external_refs->nelts);
+  svn_packed__add_int(header_stream, change_count);
+  svn_packed__add_int(header_stream, extensions->nelts);
+  svn_packed__add_bytes(strings_stream, fstats->fingerprint,
+                        strlen(fstats->fingerprint));
+
+  for (i = 0; i < fstats->revisions->nelts; ++i)
+    {
+      revision_info_t *info = APR_ARRAY_IDX(fstats->revisions, i,
+                                            revision_info_t *);
+
+      svn_packed__add_uint(revs_stream, info->offset);
+      svn_packed__add_uint(revs_stream, info->end);
+      svn_packed__add_uint(revs_stream, info->changes_len);
+      svn_packed__add_uint(revs_stream, info->change_count);
+      svn_packed__add_uint(revs_stream, info->dir_noderev_count);
+      svn_packed__add_uint(revs_stream, info->file_noderev_count);
+      svn_packed__add_uint(revs_stream, info->dir_noderev_size);
+      svn_packed__add_uint(revs_stream, info->file_noderev_size);
+      svn_packed__add_uint(revs_stream, info->representations->nelts);
+
+      for (k = 0; k < info->representations->nelts; ++k)
+        {
+          rep_stats_t *rep = APR_ARRAY_IDX(info->representations, k,
+                                           rep_stats_t *);
+
+          svn_packed__add_uint(reps_stream, rep->item_index);
+          svn_packed__add_uint(reps_stream, rep->size);
+          svn_packed__add_uint(reps_stream, rep->expanded_size);
+          svn_packed__add_uint(reps_stream, rep->ref_count);
+          svn_packed__add_uint(reps_stream, rep->header_size);
+          svn_packed__add_uint(reps_stream, (unsigned char)rep->kind);
+        }
+    }
+
+  for (i = 0; i < fstats->rep_refs->nelts; ++i)
+    {
+      rep_ref_t *ref = APR_ARRAY_IDX(fstats->rep_refs, i, rep_ref_t *);
+
+      svn_packed__add_uint(refs_stream, ref->revision);
+      svn_packed__add_uint(refs_stream, ref->item_index);
+      svn_packed__add_int(refs_stream, ref->base_revision);
+      svn_packed__add_uint(refs_stream, ref->base_item_index);
+      svn_packed__add_uint(refs_stream, ref->header_size);
+    }
+
+  for (i = 0; i < fstats->external_refs->nelts; ++i)
+    {
+      rep_key_t *key = &APR_ARRAY_IDX(fstats->external_refs, i, rep_key_t);
+
+      svn_packed__add_uint(external_stream, key->revision);
+      svn_packed__add_uint(external_stream, key->item_index);
+    }
+
+  for (j = 0; j < largest_changes->count; ++j)
+    {
+      svn_fs_fs__large_change_info_t *info = largest_changes->changes[j];
+      if (!SVN_IS_VALID_REVNUM(info->revision))
+        continue;
+
+      svn_packed__add_uint(changes_stream, info->size);
+      svn_packed__add_uint(changes_stream, info->revision);
+      svn_packed__add_bytes(strings_stream, info->path->data,
+                            info->path->len);
+    }
+
+  get_change_histograms(histograms, fstats->stats);
+  for (i = 0; i < CHANGE_HISTOGRAM_COUNT; ++i)
+    write_histogram(histogram_stream, histograms[i]);
+
+  for (i = 0; i < extensions->nelts; ++i)
+    {
+      svn_sort__item_t *item = &APR_ARRAY_IDX(extensions, i,
+                                              svn_sort__item_t);
+      svn_fs_fs__extension_info_t *info = item->value;
+
+      svn_packed__add_bytes(strings_stream, info->extension,
+                            strlen(info->extension));
+      write_histogram(histogram_stream, &info->rep_histogram);
+      write_histogram(histogram_stream, &info->node_histogram);
+    }
+
+  return svn_error_trace(svn_packed__data_write(stream, root, scratch_pool));
+}
+
+/* Read the next cache record from STREAM and return it in *FSTATS,
+ * allocated in RESULT_POOL.  Set *FSTATS to NULL at the end-of-file
+ * marker.  Use SCRATCH_POOL for temporary allocations.
+ */
+static svn_error_t *
+read_file_stats(file_stats_t **fstats,
+                svn_stream_t *stream,
+                apr_pool_t *result_pool,
+                apr_pool_t *scratch_pool)
+{
+  svn_packed__data_root_t *root;
+  svn_packed__int_stream_t *header_stream, *revs_stream, *reps_stream;
+  svn_packed__int_stream_t *refs_stream, *external_stream;
+  svn_packed__int_stream_t *changes_stream, *histogram_stream;
+  svn_packed__byte_stream_t *strings_stream;
+
+  svn_fs_fs__histogram_t *histograms[CHANGE_HISTOGRAM_COUNT];
+  svn_fs_fs__largest_changes_t *largest_changes;
+  file_stats_t *result;
+  apr_int64_t ref_count, external_count, change_count, extension_count;
+  const char *data;
+  apr_size_t len;
+  int i, k;
+
+  SVN_ERR(svn_packed__data_read(&root, stream, scratch_pool, scratch_pool));
+
+  header_stream = svn_packed__first_int_stream(root);
+  revs_stream = header_stream ? svn_packed__next_int_stream(header_stream)
+                              : NULL;
+  reps_stream = revs_stream ? svn_packed__next_int_stream(revs_stream)
+                            : NULL;
+  refs_stream = reps_stream ? svn_packed__next_int_stream(reps_stream)
+                            : NULL;
+  external_stream = refs_stream ? svn_packed__next_int_stream(refs_stream)
+                                : NULL;
+  changes_stream = external_stream
+                 ? svn_packed__next_int_stream(external_stream)
+                 : NULL;
+  histogram_stream = changes_stream
+                   ? svn_packed__next_int_stream(changes_stream)
+                   : NULL;
+  strings_stream = svn_packed__first_byte_stream(root);
+
+  if (   !histogram_stream || !strings_stream
+      || svn_packed__get_uint(header_stream) != STATS_CACHE_FORMAT)
+    return svn_error_create(SVN_ERR_FS_CORRUPT, NULL,
+                            _("Unsupported stats cache record"));
+
+  result = apr_pcalloc(result_pool, sizeof(*result));
+  result->first_rev = (svn_revnum_t)svn_packed__get_int(header_stream);
+  result->count = (int)svn_packed__get_int(header_stream);
+  if (result->count <= 0)
+    {
+      *fstats = NULL;
+      return SVN_NO_ERROR;
+    }
+
+  ref_count = svn_packed__get_int(header_stream);
+  external_count = svn_packed__get_int(header_stream);
+  change_count = svn_packed__get_int(header_stream);
+  extension_count = svn_packed__get_int(header_stream);
+  if (   ref_count < 0 || external_count < 0
+      || change_count < 0 || extension_count < 0
+      || svn_packed__byte_block_count(strings_stream)
+           != (apr_size_t)(1 + change_count + extension_count)
+      || svn_packed__int_count(revs_stream) != 9 * (apr_size_t)result->count
+      || svn_packed__int_count(refs_stream) != 5 * (apr_size_t)ref_count
+      || svn_packed__int_count(external_stream)
+           != 2 * (apr_size_t)external_count
+      || svn_packed__int_count(changes_stream) != 2 * (apr_size_t)change_count
+      || svn_packed__int_count(histogram_stream)
+           != (apr_size_t)(CHANGE_HISTOGRAM_COUNT + 2 * extension_count) * 130)
+    return svn_error_create(SVN_ERR_FS_CORRUPT, NULL,
+                            _("Corrupt stats cache record"));
+
+  data = svn_packed__get_bytes(strings_stream, &len);
+  result->fingerprint = apr_pstrmemdup(result_pool, data, len);
+
+  result->revisions = apr_array_make(result_pool, result->count,
+                                     sizeof(revision_info_t *));
+  for (i = 0; i < result->count; ++i)
+    {
+      revision_info_t *info = apr_pcalloc(result_pool, sizeof(*info));
+      int rep_count;
+      rep_stats_t *reps;
+
+      info->revision = result->first_rev + i;
+      info->offset = (apr_off_t)svn_packed__get_uint(revs_stream);
+      info->end = (apr_off_t)svn_packed__get_uint(revs_stream);
+      info->changes_len = svn_packed__get_uint(revs_stream);
+      info->change_count = svn_packed__get_uint(revs_stream);
+      info->dir_noderev_count = svn_packed__get_uint(revs_stream);
+      info->file_noderev_count = svn_packed__get_uint(revs_stream);
+      info->dir_noderev_size = svn_packed__get_uint(revs_stream);
+      info->file_noderev_size = svn_packed__get_uint(revs_stream);
+      rep_count = (int)svn_packed__get_uint(revs_stream);
+
+      if (   rep_count < 0
+          || svn_packed__int_count(reps_stream) < 6 * (apr_size_t)rep_count)
+        return svn_error_create(SVN_ERR_FS_CORRUPT, NULL,
+                                _("Corrupt stats cache record"));
+
+      reps = apr_pcalloc(result_pool, MAX(rep_count, 1) * sizeof(*reps));
+      info->representations = apr_array_make(result_pool, rep_count,
+                                             sizeof(rep_stats_t *));
+      for (k = 0; k < rep_count; ++k)
+        {
+          rep_stats_t *rep = &reps[k];
+
+          rep->revision = info->revision;
+          rep->item_index = svn_packed__get_uint(reps_stream);
+          rep->size = svn_packed__get_uint(reps_stream);
+          rep->expanded_size = svn_packed__get_uint(reps_stream);
+          rep->ref_count = (apr_uint32_t)svn_packed__get_uint(reps_stream);
+          rep->header_size = (apr_uint16_t)svn_packed__get_uint(reps_stream);
+          rep->kind = (char)svn_packed__get_uint(reps_stream);
+
+          APR_ARRAY_PUSH(info->representations, rep_stats_t *) = rep;
+        }
+
+      APR_ARRAY_PUSH(result->revisions, revision_info_t *) = info;
+    }
+
+  result->rep_refs = apr_array_make(result_pool, (int)ref_count,
+                                    sizeof(rep_ref_t *));
+  for (i = 0; i < ref_count; ++i)
+    {
+      rep_ref_t *ref = apr_pcalloc(result_pool, sizeof(*ref));
+
+      ref->revision = (svn_revnum_t)svn_packed__get_uint(refs_stream);
+      ref->item_index = svn_packed__get_uint(refs_stream);
+      ref->base_revision = (svn_revnum_t)svn_packed__get_int(refs_stream);
+      ref->base_item_index = svn_packed__get_uint(refs_stream);
+      ref->header_size = (apr_uint16_t)svn_packed__get_uint(refs_stream);
+
+      APR_ARRAY_PUSH(result->rep_refs, rep_ref_t *) = ref;
+    }
+
+  result->external_refs = apr_array_make(result_pool, (int)external_count,
+                                         sizeof(rep_key_t));
+  for (i = 0; i < external_count; ++i)
+    {
+      rep_key_t *key = apr_array_push(result->external_refs);
+
+      key->revision = (svn_revnum_t)svn_packed__get_uint(external_stream);
+      key->item_index = svn_packed__get_uint(external_stream);
+    }
+
+  /* Only allocate what we need.  There may be many of these. */
+  result->stats = apr_pcalloc(result_pool, sizeof(*result->stats));
+  result->stats->by_extension = apr_hash_make(result_pool);
+  largest_changes = apr_pcalloc(result_pool, sizeof(*largest_changes));
+  largest_changes->count = (apr_size_t)change_count;
+  largest_changes->changes
+    = apr_pcalloc(result_pool,
+                  MAX(change_count, 1) * sizeof(*largest_changes->changes));
+  result->stats->largest_changes = largest_changes;
+
+  for (i = 0; i < change_count; ++i)
+    {
+      svn_fs_fs__large_change_info_t *info
+        = apr_pcalloc(result_pool, sizeof(*info));
+
+      info->size = svn_packed__get_uint(changes_stream);
+      info->revision = (svn_revnum_t)svn_packed__get_uint(changes_stream);
+      data = svn_packed__get_bytes(strings_stream, &len);
+      info->path = svn_stringbuf_ncreate(data, len, result_pool);
+
+      largest_changes->changes[i] = info;
+    }
+
+  get_change_histograms(histograms, result->stats);
+  for (i = 0; i < CHANGE_HISTOGRAM_COUNT; ++i)
+    read_histogram(histograms[i], histogram_stream);
+
+  for (i = 0; i < extension_count; ++i)
+    {
+      svn_fs_fs__extension_info_t *info;
+
+      data = svn_packed__get_bytes(strings_stream, &len);
+      info = get_extension_info(result->stats,
+                                apr_pstrmemdup(scratch_pool, data, len));
+      read_histogram(&info->rep_histogram, histogram_stream);
+      read_histogram(&info->node_histogram, histogram_stream);
+    }
+
+  *fstats = result;
+
+  return SVN_NO_ERROR;
+}
+
+/* Read the stats cache file at PATH and return its contents in *CACHE,
+ * mapping the first revision (svn_revnum_t) to the file_stats_t * of that
+ * pack file.  A missing or unusable cache file results in an empty hash.
+ * Allocate the result in RESULT_POOL and use SCRATCH_POOL for temporaries.
+ */
+static svn_error_t *
+read_stats_cache(apr_hash_t **cache,
+                 const char *path,
+                 apr_pool_t *result_pool,
+                 apr_pool_t *scratch_pool)
+{
+  apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+  svn_stream_t *stream;
+  svn_error_t *err;
+
+  *cache = apr_hash_make(result_pool);
+
+  err = svn_stream_open_readonly(&stream, path, scratch_pool, scratch_pool);
+  if (err && APR_STATUS_IS_ENOENT(err->apr_err))
+    {
+      svn_error_clear(err);
+      return SVN_NO_ERROR;
+    }
+  SVN_ERR(err);
+
+  while (TRUE)
+    {
+      file_stats_t *fstats;
+
+      svn_pool_clear(iterpool);
+      err = read_file_stats(&fstats, stream, result_pool, iterpool);
+
+      /* The cache is just an optimization.  If it is broken, simply
+       * recreate it from scratch. */
+      if (err)
+        {
+          svn_error_clear(err);
+          *cache = apr_hash_make(result_pool);
+          break;
+        }
+
+      if (fstats == NULL)
+        break;
+
+      apr_hash_set(*cache, &fstats->first_rev, sizeof(fstats->first_rev),
+                   fstats);
+    }
+
+  svn_pool_destroy(iterpool);
+
+  return svn_error_trace(svn_stream_close(stream));
+}
+
+
+/*** Parallel execution. ***/
+
+/* Baton type for the tasks gathering the stats of the whole repository.
+ */
+typedef struct stats_baton_t
+{
+  /* Receives the merged results. */
+  query_t *query;
+
+  /* Results from previous runs, see read_stats_cache().
+   * NULL if caching has been disabled. */
+  apr_hash_t *cache;
+
+  /* New contents of the stats cache.  NULL if caching has been disabled. */
+  svn_stream_t *cache_stream;
+
+  /* Pool to allocate the merged revision info in. */
+  apr_pool_t *pool;
+} stats_baton_t;
+
+/* Parameters for gathering the stats of a single rev / pack file.
+ */
+typedef struct file_baton_t
+{
+  /* The repository-wide context. */
+  stats_baton_t *stats_baton;
+
+  /* First revision to read. */
+  svn_revnum_t first_rev;
+
+  /* Number of revisions to read. */
+  int count;
+
+  /* Whether this is a pack file. */
+  svn_boolean_t packed;
+} file_baton_t;
+
+/* Implements svn_task__thread_context_constructor_t.
+ *
+ * The svn_fs_t is not thread-safe, so give each worker its own instance
+ * of the svn_fs_t passed in as CONTEXT_BATON.
+ */
+static svn_error_t *
+open_thread_fs(void **thread_context,
+               void *context_baton,
+               apr_pool_t *result_pool,
+               apr_pool_t *scratch_pool)
+{
+  svn_fs_t *fs = context_baton;
+  fs_fs_data_t *ffd = fs->fsap_data;
+  svn_fs_t *thread_fs;
+
+  SVN_ERR_ASSERT(ffd->svn_fs_open_);
+  SVN_ERR(ffd->svn_fs_open_(&thread_fs, fs->path, fs->config, result_pool,
+                            scratch_pool));
+
+  *thread_context = thread_fs;
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_task__process_func_t.
+ *
+ * Gather the stats for the file_baton_t given as PROCESS_BATON and return
+ * them as a file_stats_t in *RESULT.  Take them from the cache if the pack
+ * file has not changed since.
+ */
+static svn_error_t *
+gather_file_stats(void **result,
+                  svn_task__t *task,
+                  void *thread_context,
+                  void *process_baton,
+                  svn_cancel_func_t cancel_func,
+                  void *cancel_baton,
+                  apr_pool_t *result_pool,
+                  apr_pool_t *scratch_pool)
+{
+  file_baton_t *baton = process_baton;
+  stats_baton_t *stats_baton = baton->stats_baton;
+  svn_fs_t *fs = thread_context ? thread_context : stats_baton->query->fs;
+  const char *fingerprint = NULL;
+  file_stats_t *fstats;
+  query_t *query;
+
+  if (baton->packed && stats_baton->cache)
+    {
+      SVN_ERR(get_pack_fingerprint(&fingerprint, fs, baton->first_rev,
+                                   result_pool, scratch_pool));
+
+      fstats = apr_hash_get(stats_baton->cache, &baton->first_rev,
+                            sizeof(baton->first_rev));
+      if (   fstats
+          && fstats->count == baton->count
+          && strcmp(fstats->fingerprint, fingerprint) == 0)
+        {
+          *result = fstats;
+          return SVN_NO_ERROR;
+        }
+    }
+
+  create_file_query(&query, stats_baton->query, fs, baton->first_rev,
+                    baton->count, cancel_func, cancel_baton, result_pool);
+
+  if (baton->packed)
+    {
+      if (svn_fs_fs__use_log_addressing(fs))
+        SVN_ERR(read_log_rev_or_packfile(query, baton->first_rev,
+                                         baton->count, result_pool,
+                                         scratch_pool));
+      else
+        SVN_ERR(read_phys_pack_file(query, baton->first_rev, result_pool,
+                                    scratch_pool));
+    }
+  else
+    {
+      apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+      svn_revnum_t revision;
+
+      for (revision = baton->first_rev;
+           revision < baton->first_rev + baton->count;
+           ++revision)
+        {
+          svn_pool_clear(iterpool);
+
+          if (svn_fs_fs__use_log_addressing(fs))
+            SVN_ERR(read_log_rev_or_packfile(query, revision, 1,
+                                             result_pool, iterpool));
+          else
+            SVN_ERR(read_phys_revision_file(query, revision, result_pool,
+                                            iterpool));
+        }
+
+      svn_pool_destroy(iterpool);
+    }
+
+  fstats = apr_pcalloc(result_pool, sizeof(*fstats));
+  fstats->first_rev = baton->first_rev;
+  fstats->count = baton->count;
+  fstats->fingerprint = fingerprint;
+  fstats->revisions = query->revisions;
+  fstats->rep_refs = query->rep_refs;
+  fstats->external_refs = query->external_refs;
+  fstats->stats = query->stats;
+
+  *result = fstats;
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_task__output_func_t.
+ *
+ * Merge the file_stats_t given as RESULT into the query_t of the
+ * stats_baton_t given as OUTPUT_BATON and update the stats cache.
+ * This runs in the main thread and in revision order.
+ */
+static svn_error_t *
+merge_file_stats(svn_task__t *task,
+                 void *result,
+                 void *output_baton,
+                 svn_cancel_func_t cancel_func,
+                 void *cancel_baton,
+                 apr_pool_t *result_pool,
+                 apr_pool_t *scratch_pool)
+{
+  file_stats_t *fstats = result;
+  stats_baton_t *baton = output_baton;
+  query_t *query = baton->query;
+  int i;
+
+  SVN_ERR_ASSERT(query->revisions->nelts == fstats->first_rev);
+  for (i = 0; i < fstats->revisions->nelts; ++i)
+    APR_ARRAY_PUSH(query->revisions, revision_info_t *)
+      = copy_revision_info(APR_ARRAY_IDX(fstats->revisions, i,
+                                         revision_info_t *),
+                           baton->pool);
+
+  /* Shared uses of representations from older files. */
+  for (i = 0; i < fstats->external_refs->nelts; ++i)
+    {
+      int idx;
+      rep_key_t *key = &APR_ARRAY_IDX(fstats->external_refs, i, rep_key_t);
+      rep_stats_t *rep = find_representation(&idx, query, NULL,
+                                             key->revision, key->item_index);
+      if (rep)
+        rep->ref_count++;
+    }
+
+  /* All delta bases are known by now. */
+  SVN_ERR(resolve_representation_refs(query, fstats->rep_refs));
+
+  merge_stats(query->stats, fstats->stats);
+
+  if (baton->cache_stream && fstats->fingerprint)
+    SVN_ERR(write_file_stats(baton->cache_stream, fstats, scratch_pool));
+
+  /* one more pack file processed or show progress every 1000 revs or so */
+  if (query->progress_func)
+    {
+      svn_revnum_t revision;
+
+      if (fstats->first_rev < query->min_unpacked_rev)
+        query->progress_func(fstats->first_rev, query->progress_baton,
+                             scratch_pool);
+      else
+        for (revision = fstats->first_rev;
+             revision < fstats->first_rev + fstats->count;
+             ++revision)
+          {
+            if (query->shard_size && (revision % query->shard_size == 0))
+              query->progress_func(revision, query->progress_baton,
+                                   scratch_pool);
+            if (!query->shard_size && (revision % 1000 == 0))
+              query->progress_func(revision, query->progress_baton,
+                                   scratch_pool);
+          }
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Add a sub-task to TASK that gathers the stats of COUNT revisions
+ * starting at FIRST_REV.  PACKED indicates whether they are in a pack
+ * file.  BATON is the repository-wide context.
+ */
+static svn_error_t *
+add_file_task(svn_task__t *task,
+              stats_baton_t *baton,
+              svn_revnum_t first_rev,
+              int count,
+              svn_boolean_t packed)
+{
+  apr_pool_t *process_pool = svn_task__create_process_pool(task);
+  file_baton_t *file_baton = apr_pcalloc(process_pool, sizeof(*file_baton));
+
+  file_baton->stats_baton = baton;
+  file_baton->first_rev = first_rev;
+  file_baton->count = count;
+  file_baton->packed = packed;
+
+  return svn_error_trace(svn_task__add(task, process_pool, NULL,
+                                       gather_file_stats, file_baton,
+                                       merge_file_stats, baton));
+}
+
+/* Implements svn_task__process_func_t.
+ *
+ * Add a sub-task for each pack file and for each shard's worth of
+ * non-packed revisions in the repository given by the stats_baton_t
+ * in PROCESS_BATON.
+ */
+static svn_error_t *
+add_file_tasks(void **result,
+               svn_task__t *task,
+               void *thread_context,
+               void *process_baton,
+               svn_cancel_func_t cancel_func,
+               void *cancel_baton,
+               apr_pool_t *result_pool,
+               apr_pool_t *scratch_pool)
+{
+  stats_baton_t *baton = process_baton;
+  query_t *query = baton->query;
+  int batch_size = query->shard_size ? query->shard_size : 1000;
+  svn_revnum_t revision;
+
+  /* packed revs */
+  for ( revision = 0
+      ; revision < query->min_unpacked_rev
+      ; revision += query->shard_size)
+    SVN_ERR(add_file_task(task, baton, revision, query->shard_size, TRUE));
+
+  /* non-packed revs */
+  for ( ; revision <= query->head; revision += batch_size)
+    SVN_ERR(add_file_task(task, baton, revision,
+                          (int)MIN(batch_size, query->head - revision + 1),
+                          FALSE));
+
+  *result = NULL;
+  return SVN_NO_ERROR;
+}
+
 svn_error_t *
 svn_fs_fs__get_stats(svn_fs_fs__stats_t **stats,
                      svn_fs_t *fs,
+                     const char *cache_path,
+                     int thread_count,
                      svn_fs_progress_notify_func_t progress_func,
                      void *progress_baton,
                      svn_cancel_func_t cancel_func,
@@ -1387,12 +2300,45 @@ svn_fs_fs__get_stats(svn_fs_fs__stats_t **stats,
                      apr_pool_t *scratch_pool)
 {
   query_t *query;
+  stats_baton_t baton = { 0 };
+  const char *temp_path = NULL;
 
   *stats = create_stats(result_pool);
   SVN_ERR(create_query(&query, fs, *stats, progress_func, progress_baton,
                        cancel_func, cancel_baton, scratch_pool,
                        scratch_pool));
-  SVN_ERR(read_revisions(query, scratch_pool, scratch_pool));
+
+  baton.query = query;
+  baton.pool = scratch_pool;
+
+  /* The new cache contents will replace the old one once we are done. */
+  if (cache_path)
+    {
+      SVN_ERR(read_stats_cache(&baton.cache, cache_path, scratch_pool,
+                               scratch_pool));
+      SVN_ERR(svn_stream_open_unique(&baton.cache_stream, &temp_path,
+                                     svn_dirent_dirname(cache_path,
+                                                        scratch_pool),
+                                     svn_io_file_del_on_pool_cleanup,
+                                     scratch_pool, scratch_pool));
+    }
+
+  /* Read all rev / pack files in parallel and merge the results in
+   * revision order. */
+  SVN_ERR(svn_task__run(MAX(thread_count, 1), add_file_tasks, &baton,
+                        NULL, NULL,
+                        thread_count > 1 ? open_thread_fs : NULL, fs,
+                        cancel_func, cancel_baton,
+                        scratch_pool, scratch_pool));
+
+  if (cache_path)
+    {
+      SVN_ERR(write_file_stats(baton.cache_stream, NULL, scratch_pool));
+      SVN_ERR(svn_stream_close(baton.cache_stream));
+      SVN_ERR(svn_io_file_rename2(temp_path, cache_path, FALSE,
+                                  scratch_pool));
+    }
+
   aggregate_stats(query->revisions, *stats);
 
   return SVN_NO_ERROR;
@@ -41,13 +41,17 @@
 #include "temp_serializer.h"
 #include "cached_data.h"
 #include "lock.h"
+#include "mergeinfo-index.h"
+#include "path-index.h"
 #include "rep-cache.h"
+#include "revprop-index.h"
 
 #include "private/svn_fs_util.h"
 #include "private/svn_fspath.h"
 #include "private/svn_sorts_private.h"
 #include "private/svn_subr_private.h"
 #include "private/svn_string_private.h"
+#include "private/svn_task.h"
 #include "../libsvn_fs/fs-loader.h"
 
 #include "svn_private_config.h"
@@ -2159,58 +2163,58 @@ rep_write_cleanup(void *data)
   return APR_SUCCESS;
 }
 
-static void
-txdelta_to_svndiff(svn_txdelta_window_handler_t *handler,
-                   void **handler_baton,
-                   svn_stream_t *output,
-                   svn_fs_t *fs,
-                   apr_pool_t *pool)
+/* Return the svndiff version to use for new representations in FS. */
+static int
+get_svndiff_version(svn_fs_t *fs)
 {
   fs_fs_data_t *ffd = fs->fsap_data;
-  int svndiff_version;
 
   if (ffd->delta_compression_type == compression_type_lz4)
     {
       SVN_ERR_ASSERT_NO_RETURN(ffd->format >= SVN_FS_FS__MIN_SVNDIFF2_FORMAT);
-      svndiff_version = 2;
+      return 2;
     }
   else if (ffd->delta_compression_type == compression_type_zlib)
     {
       SVN_ERR_ASSERT_NO_RETURN(ffd->format >= SVN_FS_FS__MIN_SVNDIFF1_FORMAT);
-      svndiff_version = 1;
-    }
-  else
-    {
-      svndiff_version = 0;
+      return 1;
     }
 
-  svn_txdelta_to_svndiff3(handler, handler_baton, output, svndiff_version,
+  return 0;
+}
+
+void
+svn_fs_fs__txdelta_to_svndiff(svn_txdelta_window_handler_t *handler,
+                              void **handler_baton,
+                              svn_stream_t *output,
+                              svn_fs_t *fs,
+                              apr_pool_t *pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+
+  svn_txdelta_to_svndiff3(handler, handler_baton, output,
+                          get_svndiff_version(fs),
                           ffd->delta_compression_level, pool);
 }
 
-/* Get a rep_write_baton and store it in *WB_P for the representation
-   indicated by NODEREV in filesystem FS.  Perform allocations in
-   POOL.  Only appropriate for file contents, not for props or
-   directory contents. */
+/* Start writing a new representation for NODEREV in filesystem FS to
+   the end of the proto-rev file and return the rep_write_baton in *WB_P.
+   The rep header declaring BASE_REP as delta base (may be NULL) will have
+   been written but no svndiff data, nor will there be checksum contexts
+   or a delta stream.  Perform allocations in POOL. */
 static svn_error_t *
-rep_write_get_baton(struct rep_write_baton **wb_p,
-                    svn_fs_t *fs,
-                    node_revision_t *noderev,
-                    apr_pool_t *pool)
+rep_write_start(struct rep_write_baton **wb_p,
+                svn_fs_t *fs,
+                node_revision_t *noderev,
+                representation_t *base_rep,
+                apr_pool_t *pool)
 {
   struct rep_write_baton *b;
   apr_file_t *file;
-  representation_t *base_rep;
-  svn_stream_t *source;
-  svn_txdelta_window_handler_t wh;
-  void *whb;
   svn_fs_fs__rep_header_t header = { 0 };
 
   b = apr_pcalloc(pool, sizeof(*b));
 
-  b->sha1_checksum_ctx = svn_checksum_ctx_create(svn_checksum_sha1, pool);
-  b->md5_checksum_ctx = svn_checksum_ctx_create(svn_checksum_md5, pool);
-
   b->fs = fs;
   b->result_pool = pool;
   b->scratch_pool = svn_pool_create(pool);
@@ -2230,11 +2234,6 @@ rep_write_get_baton(struct rep_write_baton **wb_p,
 
   SVN_ERR(svn_io_file_get_offset(&b->rep_offset, file, b->scratch_pool));
 
-  /* Get the base for this delta. */
-  SVN_ERR(choose_delta_base(&base_rep, fs, noderev, FALSE, b->scratch_pool));
-  SVN_ERR(svn_fs_fs__get_contents(&source, fs, base_rep, TRUE,
-                                  b->scratch_pool));
-
   /* Write out the rep header. */
   if (base_rep)
     {
@@ -2258,8 +2257,38 @@ rep_write_get_baton(struct rep_write_baton **wb_p,
   apr_pool_cleanup_register(b->scratch_pool, b, rep_write_cleanup,
                             apr_pool_cleanup_null);
 
+  *wb_p = b;
+
+  return SVN_NO_ERROR;
+}
+
+/* Get a rep_write_baton and store it in *WB_P for the representation
+   indicated by NODEREV in filesystem FS.  Perform allocations in
+   POOL.  Only appropriate for file contents, not for props or
+   directory contents. */
+static svn_error_t *
+rep_write_get_baton(struct rep_write_baton **wb_p,
+                    svn_fs_t *fs,
+                    node_revision_t *noderev,
+                    apr_pool_t *pool)
+{
+  struct rep_write_baton *b;
+  representation_t *base_rep;
+  svn_stream_t *source;
+  svn_txdelta_window_handler_t wh;
+  void *whb;
+
+  /* Get the base for this delta. */
+  SVN_ERR(choose_delta_base(&base_rep, fs, noderev, FALSE, pool));
+  SVN_ERR(rep_write_start(&b, fs, noderev, base_rep, pool));
+  SVN_ERR(svn_fs_fs__get_contents(&source, fs, base_rep, TRUE,
+                                  b->scratch_pool));
+
+  b->sha1_checksum_ctx = svn_checksum_ctx_create(svn_checksum_sha1, pool);
+  b->md5_checksum_ctx = svn_checksum_ctx_create(svn_checksum_md5, pool);
+
   /* Prepare to write the svndiff data. */
-  txdelta_to_svndiff(&wh, &whb, b->rep_stream, fs, pool);
+  svn_fs_fs__txdelta_to_svndiff(&wh, &whb, b->rep_stream, fs, pool);
 
   b->delta_stream = svn_txdelta_target_push(wh, whb, source,
                                             b->scratch_pool);
@@ -2640,6 +2669,228 @@ svn_fs_fs__set_contents(svn_stream_t **stream,
   return set_representation(stream, fs, noderev, pool);
 }
 
+/* Everything needed to encode one item in svn_fs_fs__set_contents_many(),
+ * prepared by the main thread.  Read-only once encoding has started. */
+typedef struct encode_baton_t
+{
+  /* The node to write the representation for. */
+  node_revision_t *noderev;
+
+  /* Its new fulltext. */
+  const svn_string_t *contents;
+
+  /* Delta base representation for CONTENTS.  NULL for self-delta. */
+  representation_t *base_rep;
+
+  /* Fulltext of BASE_REP.  Empty for self-delta. */
+  const svn_string_t *base;
+
+  /* svndiff format parameters. */
+  int svndiff_version;
+  int compression_level;
+} encode_baton_t;
+
+/* The result of encoding one item in svn_fs_fs__set_contents_many(). */
+typedef struct encode_result_t
+{
+  /* The item that got encoded. */
+  const encode_baton_t *item;
+
+  /* Checksum contexts with all of the fulltext added. */
+  svn_checksum_ctx_t *md5_checksum_ctx;
+  svn_checksum_ctx_t *sha1_checksum_ctx;
+
+  /* The svndiff data to write after the rep header. */
+  svn_stringbuf_t *svndiff;
+} encode_result_t;
+
+/* Baton type for the root task in svn_fs_fs__set_contents_many(). */
+typedef struct encode_root_baton_t
+{
+  /* All the encode_baton_t * to process, in output order. */
+  apr_array_header_t *items;
+
+  /* The FS to write to. */
+  svn_fs_t *fs;
+} encode_root_baton_t;
+
+/* Implements svn_task__process_func_t.
+ *
+ * Calculate checksums and svndiff for the encode_baton_t in PROCESS_BATON.
+ * This may run in any thread and must not access the FS. */
+static svn_error_t *
+encode_contents(void **result,
+                svn_task__t *task,
+                void *thread_context,
+                void *process_baton,
+                svn_cancel_func_t cancel_func,
+                void *cancel_baton,
+                apr_pool_t *result_pool,
+                apr_pool_t *scratch_pool)
+{
+  const encode_baton_t *item = process_baton;
+  encode_result_t *r = apr_pcalloc(result_pool, sizeof(*r));
+  svn_txdelta_stream_t *delta_stream;
+  svn_txdelta_window_handler_t wh;
+  void *whb;
+
+  r->item = item;
+  r->md5_checksum_ctx = svn_checksum_ctx_create(svn_checksum_md5,
+                                                result_pool);
+  r->sha1_checksum_ctx = svn_checksum_ctx_create(svn_checksum_sha1,
+                                                 result_pool);
+  SVN_ERR(svn_checksum_update(r->md5_checksum_ctx, item->contents->data,
+                              item->contents->len));
+  SVN_ERR(svn_checksum_update(r->sha1_checksum_ctx, item->contents->data,
+                              item->contents->len));
+
+  /* Compressed svndiff is usually much smaller than the fulltext. */
+  r->svndiff = svn_stringbuf_create_ensure(item->contents->len / 4 + 64,
+                                           result_pool);
+  svn_txdelta_to_svndiff3(&wh, &whb,
+                          svn_stream_from_stringbuf(r->svndiff, scratch_pool),
+                          item->svndiff_version, item->compression_level,
+                          scratch_pool);
+  svn_txdelta2(&delta_stream,
+               svn_stream_from_string(item->base, scratch_pool),
+               svn_stream_from_string(item->contents, scratch_pool),
+               FALSE, scratch_pool);
+  SVN_ERR(svn_txdelta_send_txstream(delta_stream, wh, whb, scratch_pool));
+
+  *result = r;
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_task__output_func_t.
+ *
+ * Append the encoded representation in RESULT (an encode_result_t) to the
+ * proto-rev file of the svn_fs_t in OUTPUT_BATON, unless it can be shared,
+ * and update the node-revision accordingly.  This runs in the main thread
+ * in the order in which the items have been given. */
+static svn_error_t *
+write_encoded_contents(svn_task__t *task,
+                       void *result,
+                       void *output_baton,
+                       svn_cancel_func_t cancel_func,
+                       void *cancel_baton,
+                       apr_pool_t *result_pool,
+                       apr_pool_t *scratch_pool)
+{
+  encode_result_t *r = result;
+  svn_fs_t *fs = output_baton;
+  struct rep_write_baton *b;
+  apr_size_t len = r->svndiff->len;
+
+  SVN_ERR(rep_write_start(&b, fs, r->item->noderev, r->item->base_rep,
+                          result_pool));
+  SVN_ERR(svn_stream_write(b->rep_stream, r->svndiff->data, &len));
+
+  b->rep_size = r->item->contents->len;
+  b->md5_checksum_ctx = r->md5_checksum_ctx;
+  b->sha1_checksum_ctx = r->sha1_checksum_ctx;
+
+  /* Rep-sharing and everything else is exactly as for streamy writes. */
+  return svn_error_trace(rep_write_contents_close(b));
+}
+
+/* Implements svn_task__process_func_t.
+ *
+ * Add an encoding sub-task for each item in the encode_root_baton_t in
+ * PROCESS_BATON. */
+static svn_error_t *
+add_encode_tasks(void **result,
+                 svn_task__t *task,
+                 void *thread_context,
+                 void *process_baton,
+                 svn_cancel_func_t cancel_func,
+                 void *cancel_baton,
+                 apr_pool_t *result_pool,
+                 apr_pool_t *scratch_pool)
+{
+  encode_root_baton_t *root_baton = process_baton;
+  int i;
+
+  for (i = 0; i < root_baton->items->nelts; ++i)
+    {
+      apr_pool_t *process_pool = svn_task__create_process_pool(task);
+      SVN_ERR(svn_task__add(task, process_pool, NULL, encode_contents,
+                            APR_ARRAY_IDX(root_baton->items, i,
+                                          encode_baton_t *),
+                            write_encoded_contents, root_baton->fs));
+    }
+
+  *result = NULL;
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_fs_fs__set_contents_many(svn_fs_t *fs,
+                             const apr_array_header_t *noderevs,
+                             const apr_array_header_t *contents,
+                             apr_int32_t thread_count,
+                             svn_cancel_func_t cancel_func,
+                             void *cancel_baton,
+                             apr_pool_t *pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+  apr_pool_t *scratch_pool = svn_pool_create(pool);
+  encode_root_baton_t root_baton;
+  int i;
+
+  SVN_ERR_ASSERT(noderevs->nelts == contents->nelts);
+
+  root_baton.fs = fs;
+  root_baton.items = apr_array_make(scratch_pool, noderevs->nelts,
+                                    sizeof(encode_baton_t *));
+
+  /* Everything that needs to access the repository must happen in this
+   * thread.  So, select the delta bases and read their contents now. */
+  for (i = 0; i < noderevs->nelts; ++i)
+    {
+      encode_baton_t *item = apr_pcalloc(scratch_pool, sizeof(*item));
+      svn_stringbuf_t *base;
+      svn_stream_t *stream;
+
+      item->noderev = APR_ARRAY_IDX(noderevs, i, node_revision_t *);
+      item->contents = APR_ARRAY_IDX(contents, i, const svn_string_t *);
+      item->svndiff_version = get_svndiff_version(fs);
+      item->compression_level = ffd->delta_compression_level;
+
+      if (item->noderev->kind != svn_node_file)
+        return svn_error_create(SVN_ERR_FS_NOT_FILE, NULL,
+                                _("Can't set text contents of a directory"));
+
+      if (! svn_fs_fs__id_is_txn(item->noderev->id))
+        return svn_error_createf(SVN_ERR_FS_CORRUPT, NULL,
+                                 _("Attempted to write to non-transaction "
+                                   "'%s'"),
+                                 svn_fs_fs__id_unparse(item->noderev->id,
+                                                       scratch_pool)->data);
+
+      SVN_ERR(choose_delta_base(&item->base_rep, fs, item->noderev, FALSE,
+                                scratch_pool));
+      SVN_ERR(svn_fs_fs__get_contents(&stream, fs, item->base_rep, TRUE,
+                                      scratch_pool));
+      SVN_ERR(svn_stringbuf_from_stream(&base, stream, 0, scratch_pool));
+      item->base = svn_stringbuf__morph_into_string(base);
+
+      APR_ARRAY_PUSH(root_baton.items, encode_baton_t *) = item;
+
+      if (cancel_func)
+        SVN_ERR(cancel_func(cancel_baton));
+    }
+
+  /* Let the workers do the checksumming and deltification.
+   * The results get written to the proto-rev file in order. */
+  SVN_ERR(svn_task__run(thread_count, add_encode_tasks, &root_baton,
+                        NULL, NULL, NULL, NULL, cancel_func, cancel_baton,
+                        pool, scratch_pool));
+
+  svn_pool_destroy(scratch_pool);
+
+  return SVN_NO_ERROR;
+}
+
 svn_error_t *
 svn_fs_fs__create_successor(const svn_fs_id_t **new_id_p,
                             svn_fs_t *fs,
@@ -2947,7 +3198,8 @@ write_container_delta_rep(representation_t *rep,
   SVN_ERR(svn_io_file_get_offset(&delta_start, file, scratch_pool));
 
   /* Prepare to write the svndiff data. */
-  txdelta_to_svndiff(&diff_wh, &diff_whb, file_stream, fs, scratch_pool);
+  svn_fs_fs__txdelta_to_svndiff(&diff_wh, &diff_whb, file_stream, fs,
+                                scratch_pool);
 
   whb = apr_pcalloc(scratch_pool, sizeof(*whb));
   whb->stream = svn_txdelta_target_push(diff_wh, diff_whb, source,
@@ -3594,9 +3846,11 @@ verify_locks(svn_fs_t *fs,
 
 /* Writes final revision properties to file PATH applying permissions
    from file PERMS_REFERENCE. This involves setting svn:date and
-   removing any temporary properties associated with the commit flags. */
+   removing any temporary properties associated with the commit flags.
+   Return the properties written in *REVPROPS_P, allocated in POOL. */
 static svn_error_t *
-write_final_revprop(const char *path,
+write_final_revprop(apr_hash_t **revprops_p,
+                    const char *path,
                     const char *perms_reference,
                     svn_fs_txn_t *txn,
                     svn_boolean_t flush_to_disk,
@@ -3645,6 +3899,8 @@ write_final_revprop(const char *path,
 
   SVN_ERR(svn_io_copy_perms(perms_reference, path, pool));
 
+  *revprops_p = txnprops;
+
   return SVN_NO_ERROR;
 }
 
@@ -3753,6 +4009,7 @@ commit_body(void *baton, apr_pool_t *pool)
   apr_off_t initial_offset, changed_path_offset;
   const svn_fs_fs__id_part_t *txn_id = svn_fs_fs__txn_get_id(cb->txn);
   apr_hash_t *changed_paths;
+  apr_hash_t *revprops;
   apr_array_header_t *directory_ids = apr_array_make(pool, 4,
                                                      sizeof(pair_cache_key_t));
 
@@ -3903,7 +4160,7 @@ commit_body(void *baton, apr_pool_t *pool)
   /* Write final revprops file. */
   SVN_ERR_ASSERT(! svn_fs_fs__is_packed_revprop(cb->fs, new_rev));
   revprop_filename = svn_fs_fs__path_revprops(cb->fs, new_rev, pool);
-  SVN_ERR(write_final_revprop(revprop_filename, old_rev_filename,
+  SVN_ERR(write_final_revprop(&revprops, revprop_filename, old_rev_filename,
                               cb->txn, ffd->flush_to_disk, pool));
 
   /* Run paranoia checks. */
@@ -3912,6 +4169,47 @@ commit_body(void *baton, apr_pool_t *pool)
       SVN_ERR(verify_before_commit(cb->fs, new_rev, pool));
     }
 
+  /* Keep the rep-cache filter current.  It must cover NEW_REV before that
+     becomes visible but as it is only an optimization, failing to update
+     it must not fail the commit.  The filter will simply be ignored until
+     it gets rebuilt. */
+  {
+    svn_error_t *err
+      = svn_fs_fs__add_rep_cache_filter_entries(cb->fs, cb->reps_to_cache,
+                                                new_rev, pool);
+    if (err)
+      {
+        (cb->fs->warning)(cb->fs->warning_baton, err);
+        svn_error_clear(err);
+      }
+  }
+
+  /* The same goes for the optional path index. */
+  {
+    svn_error_t *err
+      = svn_fs_fs__path_index_add_revision(cb->fs, new_rev, changed_paths,
+                                           pool);
+    if (err)
+      {
+        (cb->fs->warning)(cb->fs->warning_baton, err);
+        svn_error_clear(err);
+      }
+  }
+
+  /* And for the optional mergeinfo index.  It reads the has-mergeinfo
+     flags from the txn's node-revisions, i.e. this must happen before
+     the txn gets purged. */
+  {
+    svn_error_t *err
+      = svn_fs_fs__mergeinfo_index_add_revision(cb->fs, new_rev,
+                                                changed_paths, pool);
+    if (err)
+      {
+        (cb->fs->warning)(cb->fs->warning_baton, err);
+        svn_error_clear(err);
+      }
+  }
+
   /* Update the 'current' file. */
   SVN_ERR(write_final_current(cb->fs, txn_id, new_rev, start_node_id,
                               start_copy_id, pool));
@@ -3925,6 +4223,20 @@ commit_body(void *baton, apr_pool_t *pool)
 
   ffd->youngest_rev_cache = new_rev;
 
+  /* Add the new revision to the revprop index only now that it has become
+   * visible.  A failed commit will therefore never leave an entry for a
+   * revision that may later be committed by an older Subversion release.
+   * The index is optional, so don't fail the commit over it. */
+  {
+    svn_error_t *err
+      = svn_fs_fs__revprop_index_set(cb->fs, new_rev, revprops, pool);
+    if (err)
+      {
+        (cb->fs->warning)(cb->fs->warning_baton, err);
+        svn_error_clear(err);
+      }
+  }
+
   /* Make the directory contents alreday cached for the new revision
    * visible. */
   SVN_ERR(promote_cached_directories(cb->fs, directory_ids, pool));
@@ -3935,25 +4247,6 @@ commit_body(void *baton, apr_pool_t *pool)
   return SVN_NO_ERROR;
 }
 
-/* Add the representations in REPS_TO_CACHE (an array of representation_t *)
- * to the rep-cache database of FS. */
-static svn_error_t *
-write_reps_to_cache(svn_fs_t *fs,
-                    const apr_array_header_t *reps_to_cache,
-                    apr_pool_t *scratch_pool)
-{
-  int i;
-
-  for (i = 0; i < reps_to_cache->nelts; i++)
-    {
-      representation_t *rep = APR_ARRAY_IDX(reps_to_cache, i, representation_t *);
-
-      SVN_ERR(svn_fs_fs__set_rep_reference(fs, rep, scratch_pool));
-    }
-
-  return SVN_NO_ERROR;
-}
-
 svn_error_t *
 svn_fs_fs__commit(svn_revnum_t *new_rev_p,
                   svn_fs_t *fs,
@@ -3985,36 +4278,9 @@ svn_fs_fs__commit(svn_revnum_t *new_rev_p,
   /* At this point, *NEW_REV_P has been set, so errors below won't affect
      the success of the commit.  (See svn_fs_commit_txn().)  */
 
+  /* Write new entries to the rep-sharing database. */
   if (ffd->rep_sharing_allowed)
-    {
-      svn_error_t *err;
-
-      SVN_ERR(svn_fs_fs__open_rep_cache(fs, pool));
-
-      /* Write new entries to the rep-sharing database.
-       *
-       * We use an sqlite transaction to speed things up;
-       * see <http://www.sqlite.org/faq.html#q19>.
-       */
-      /* ### A commit that touches thousands of files will starve other
-             (reader/writer) commits for the duration of the below call.
-             Maybe write in batches? */
-      SVN_ERR(svn_sqlite__begin_transaction(ffd->rep_cache_db));
-      err = write_reps_to_cache(fs, cb.reps_to_cache, pool);
-      err = svn_sqlite__finish_transaction(ffd->rep_cache_db, err);
-
-      if (svn_error_find_cause(err, SVN_ERR_SQLITE_ROLLBACK_FAILED))
-        {
-          /* Failed rollback means that our db connection is unusable, and
-             the only thing we can do is close it.  The connection will be
-             reopened during the next operation with rep-cache.db. */
-          return svn_error_trace(
-              svn_error_compose_create(err,
-                                       svn_fs_fs__close_rep_cache(fs)));
-        }
-      else if (err)
-        return svn_error_trace(err);
-    }
+    SVN_ERR(svn_fs_fs__add_rep_references(fs, cb.reps_to_cache, pool));
 
   return SVN_NO_ERROR;
 }
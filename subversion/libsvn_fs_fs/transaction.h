@@ -167,6 +167,30 @@ svn_fs_fs__set_contents(svn_stream_t **stream,
                         node_revision_t *noderev,
                         apr_pool_t *pool);
 
+/* Set the text representations of the node-revisions in NODEREVS (an
+   array of node_revision_t *) in filesystem FS to the fulltexts given
+   in the respective elements of CONTENTS (an array of svn_string_t *).
+   The result is the same as writing them one by one through the streams
+   returned by svn_fs_fs__set_contents.
+
+   Checksumming, deltification and compression will be done using up to
+   THREAD_COUNT worker threads while the representations get appended to
+   the proto-rev file strictly in the order given.  Delta base selection,
+   rep-sharing and all other repository access happen in the calling
+   thread.  CANCEL_FUNC and CANCEL_BATON may be NULL.
+
+   All of CONTENTS as well as the delta base fulltexts will be kept in
+   memory, so callers should limit the size of each batch.
+   Allocations are from POOL. */
+svn_error_t *
+svn_fs_fs__set_contents_many(svn_fs_t *fs,
+                             const apr_array_header_t *noderevs,
+                             const apr_array_header_t *contents,
+                             apr_int32_t thread_count,
+                             svn_cancel_func_t cancel_func,
+                             void *cancel_baton,
+                             apr_pool_t *pool);
+
 /* Create a node revision in FS which is an immediate successor of
    OLD_ID, whose contents are NEW_NR.  Set *NEW_ID_P to the new node
    revision's ID.  Use POOL for any temporary allocation.
@@ -210,6 +234,16 @@ svn_fs_fs__add_index_data(svn_fs_t *fs,
                           svn_revnum_t revision,
                           apr_pool_t *pool);
 
+/* Set *HANDLER and *HANDLER_BATON to a txdelta window handler that writes
+ * svndiff data to OUTPUT, using the svndiff version and compression level
+ * configured for new representations in FS.  Allocate from POOL. */
+void
+svn_fs_fs__txdelta_to_svndiff(svn_txdelta_window_handler_t *handler,
+                              void **handler_baton,
+                              svn_stream_t *output,
+                              svn_fs_t *fs,
+                              apr_pool_t *pool);
+
 /* Commit the transaction TXN in filesystem FS and return its new
    revision number in *REV.  If the transaction is out of date, return
    the error SVN_ERR_FS_TXN_OUT_OF_DATE. Use POOL for temporary
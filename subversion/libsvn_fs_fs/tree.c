@@ -58,7 +58,9 @@
 #include "tree.h"
 #include "fs_fs.h"
 #include "id.h"
+#include "mergeinfo-index.h"
 #include "pack.h"
+#include "path-index.h"
 #include "temp_serializer.h"
 #include "transaction.h"
 #include "util.h"
@@ -66,6 +68,8 @@
 #include "private/svn_mergeinfo_private.h"
 #include "private/svn_subr_private.h"
 #include "private/svn_fs_util.h"
+#include "private/svn_fs_private.h"
+#include "private/svn_fs_fs_private.h"
 #include "private/svn_fspath.h"
 #include "../libsvn_fs/fs-loader.h"
 
@@ -3264,6 +3268,84 @@ fs_apply_text(svn_stream_t **contents_p,
   return SVN_NO_ERROR;
 }
 
+svn_error_t *
+svn_fs_fs__apply_texts(svn_fs_root_t *root,
+                       const apr_array_header_t *texts,
+                       int thread_count,
+                       svn_cancel_func_t cancel_func,
+                       void *cancel_baton,
+                       apr_pool_t *pool)
+{
+  const svn_fs_fs__id_part_t *txn_id;
+  apr_array_header_t *nodes;
+  apr_array_header_t *contents;
+  apr_hash_t *paths;
+  apr_pool_t *iterpool = svn_pool_create(pool);
+  int i;
+
+  if (! root->is_txn_root)
+    return SVN_FS__NOT_TXN(root);
+
+  txn_id = root_txn_id(root);
+  nodes = apr_array_make(pool, texts->nelts, sizeof(dag_node_t *));
+  contents = apr_array_make(pool, texts->nelts, sizeof(svn_string_t *));
+  paths = apr_hash_make(pool);
+
+  /* Do what apply_text() does, except for actually writing the data. */
+  for (i = 0; i < texts->nelts; ++i)
+    {
+      const svn_fs__text_t *text
+        = APR_ARRAY_IDX(texts, i, const svn_fs__text_t *);
+      const char *path = svn_fs__canonicalize_abspath(text->path, pool);
+      parent_path_t *parent_path;
+
+      svn_pool_clear(iterpool);
+
+      /* All texts get written before any of them gets verified, so the
+         same node must not appear twice in one batch. */
+      if (svn_hash_gets(paths, path))
+        return svn_error_createf(SVN_ERR_FS_GENERAL, NULL,
+                                 _("Path '%s' occurs more than once in a "
+                                   "batch of file contents"), path);
+      svn_hash_sets(paths, path, path);
+
+      SVN_ERR(open_path(&parent_path, root, path, 0, TRUE, pool));
+      if (root->txn_flags & SVN_FS_TXN_CHECK_LOCKS)
+        SVN_ERR(svn_fs_fs__allow_locked_operation(path, root->fs,
+                                                  FALSE, FALSE, iterpool));
+
+      SVN_ERR(make_path_mutable(root, parent_path, path, pool));
+      APR_ARRAY_PUSH(nodes, dag_node_t *) = parent_path->node;
+      APR_ARRAY_PUSH(contents, const svn_string_t *) = text->contents;
+
+      SVN_ERR(add_change(root->fs, txn_id, path,
+                         svn_fs_fs__dag_get_id(parent_path->node),
+                         svn_fs_path_change_modify, TRUE, FALSE, FALSE,
+                         svn_node_file, SVN_INVALID_REVNUM, NULL,
+                         iterpool));
+    }
+
+  SVN_ERR(svn_fs_fs__dag_set_contents_many(nodes, contents, thread_count,
+                                           cancel_func, cancel_baton, pool));
+
+  /* Verify the results. */
+  for (i = 0; i < texts->nelts; ++i)
+    {
+      const svn_fs__text_t *text
+        = APR_ARRAY_IDX(texts, i, const svn_fs__text_t *);
+
+      svn_pool_clear(iterpool);
+      SVN_ERR(svn_fs_fs__dag_finalize_edits(APR_ARRAY_IDX(nodes, i,
+                                                          dag_node_t *),
+                                            text->result_checksum,
+                                            iterpool));
+    }
+
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
 /* --- End machinery for svn_fs_apply_text() ---  */
 
 
@@ -3328,6 +3410,30 @@ fs_get_file_delta_stream(svn_txdelta_stream_t **stream_p,
                                               target_node, pool);
 }
 
+static svn_error_t *
+fs_try_get_stored_delta(svn_stream_t **stream_p,
+                        svn_filesize_t *len_p,
+                        svn_fs_root_t *source_root,
+                        const char *source_path,
+                        svn_fs_root_t *target_root,
+                        const char *target_path,
+                        int max_svndiff_version,
+                        apr_pool_t *result_pool,
+                        apr_pool_t *scratch_pool)
+{
+  dag_node_t *source_node, *target_node;
+
+  if (source_root && source_path)
+    SVN_ERR(get_dag(&source_node, source_root, source_path, scratch_pool));
+  else
+    source_node = NULL;
+  SVN_ERR(get_dag(&target_node, target_root, target_path, scratch_pool));
+
+  return svn_error_trace(svn_fs_fs__dag_try_get_stored_delta(
+                           stream_p, len_p, source_node, target_node,
+                           max_svndiff_version, result_pool, scratch_pool));
+}
+
 
 
 /* Finding Changes */
@@ -3556,6 +3662,10 @@ typedef struct fs_history_data_t
   /* If not NULL, this is the noderev ID of PATH@REVISION. */
   const svn_fs_id_t *current_id;
 
+  /* TRUE, if the path index told us that PATH@REVISION has been added
+     without history, i.e. there is no further history to report. */
+  svn_boolean_t is_origin;
+
 } fs_history_data_t;
 
 static svn_fs_history_t *
@@ -3877,6 +3987,80 @@ fs_node_origin_rev(svn_revnum_t *revision,
 }
 
 
+/* Like history_prev but use the path index of the repository instead
+   of walking the node and copy history.  Set *HANDLED to FALSE, if there
+   is no path index covering the relevant revisions, leaving
+   *PREV_HISTORY untouched.  Otherwise, set it to TRUE. */
+static svn_error_t *
+index_history_prev(svn_boolean_t *handled,
+                   svn_fs_history_t **prev_history,
+                   svn_fs_history_t *history,
+                   svn_boolean_t cross_copies,
+                   apr_pool_t *result_pool,
+                   apr_pool_t *scratch_pool)
+{
+  fs_history_data_t *fhd = history->fsap_data;
+  const char *path = fhd->path;
+  svn_revnum_t revision = fhd->revision;
+  svn_fs_fs__path_index_change_t *change;
+
+  *handled = TRUE;
+
+  /* We already reported the addition of PATH. */
+  if (fhd->is_origin)
+    {
+      *prev_history = NULL;
+      return SVN_NO_ERROR;
+    }
+
+  /* Continue at the copy source (see history_prev), at REVISION itself
+     if we did not report it yet or in the revisions before that. */
+  if (fhd->path_hint && SVN_IS_VALID_REVNUM(fhd->rev_hint))
+    {
+      if (! cross_copies)
+        {
+          *prev_history = NULL;
+          return SVN_NO_ERROR;
+        }
+
+      path = fhd->path_hint;
+      revision = fhd->rev_hint;
+    }
+  else if (fhd->is_interesting)
+    {
+      if (revision == 0)
+        {
+          *prev_history = NULL;
+          return SVN_NO_ERROR;
+        }
+
+      --revision;
+    }
+
+  SVN_ERR(svn_fs_fs__path_index_get_latest(handled, &change, fhd->fs, path,
+                                           revision, scratch_pool,
+                                           scratch_pool));
+  if (! *handled)
+    return SVN_NO_ERROR;
+
+  if (change)
+    {
+      *prev_history = assemble_history(fhd->fs, path, change->revision, TRUE,
+                                       change->copyfrom_path,
+                                       change->copyfrom_rev,
+                                       SVN_INVALID_REVNUM, NULL,
+                                       result_pool);
+      if (change->is_origin)
+        ((fs_history_data_t *)(*prev_history)->fsap_data)->is_origin = TRUE;
+    }
+  else
+    {
+      *prev_history = NULL;
+    }
+
+  return SVN_NO_ERROR;
+}
+
 static svn_error_t *
 history_prev(svn_fs_history_t **prev_history,
              svn_fs_history_t *history,
@@ -3896,6 +4080,13 @@ history_prev(svn_fs_history_t **prev_history,
   svn_revnum_t copyroot_rev;
   const char *copyroot_path;
   const svn_fs_id_t *pred_id = NULL;
+  svn_boolean_t handled;
+
+  /* If the repository has a path index, this is a simple lookup. */
+  SVN_ERR(index_history_prev(&handled, prev_history, history, cross_copies,
+                             result_pool, scratch_pool));
+  if (handled)
+    return SVN_NO_ERROR;
 
   /* Initialize our return value. */
   *prev_history = NULL;
@@ -4189,6 +4380,56 @@ assemble_history(svn_fs_t *fs,
 /* mergeinfo queries */
 
 
+/* NODE is the DAG node at PATH and claims to have mergeinfo.  Parse
+   that mergeinfo and call RECEIVER with it and BATON.
+
+   SCRATCH_POOL is used for temporary allocations, including the mergeinfo
+   hash passed to RECEIVER.
+ */
+static svn_error_t *
+report_node_mergeinfo(const char *path,
+                      dag_node_t *node,
+                      svn_fs_mergeinfo_receiver_t receiver,
+                      void *baton,
+                      apr_pool_t *scratch_pool)
+{
+  apr_hash_t *proplist;
+  svn_mergeinfo_t mergeinfo;
+  svn_string_t *mergeinfo_string;
+  svn_error_t *err;
+
+  SVN_ERR(svn_fs_fs__dag_get_proplist(&proplist, node, scratch_pool));
+  mergeinfo_string = svn_hash_gets(proplist, SVN_PROP_MERGEINFO);
+  if (!mergeinfo_string)
+    {
+      svn_string_t *idstr
+        = svn_fs_fs__id_unparse(svn_fs_fs__dag_get_id(node), scratch_pool);
+      return svn_error_createf
+        (SVN_ERR_FS_CORRUPT, NULL,
+         _("Node-revision #'%s' claims to have mergeinfo but doesn't"),
+         idstr->data);
+    }
+
+  /* Issue #3896: If a node has syntactically invalid mergeinfo, then
+     treat it as if no mergeinfo is present rather than raising a parse
+     error. */
+  err = svn_mergeinfo_parse(&mergeinfo, mergeinfo_string->data,
+                            scratch_pool);
+  if (err)
+    {
+      if (err->apr_err == SVN_ERR_MERGEINFO_PARSE_ERROR)
+        svn_error_clear(err);
+      else
+        return svn_error_trace(err);
+    }
+  else
+    {
+      SVN_ERR(receiver(path, mergeinfo, baton, scratch_pool));
+    }
+
+  return SVN_NO_ERROR;
+}
+
 /* DIR_DAG is a directory DAG node which has mergeinfo in its
    descendants.  This function iterates over its children.  For each
    child with immediate mergeinfo, call RECEIVER with it and BATON.
@@ -4207,62 +4448,38 @@ crawl_directory_dag_for_mergeinfo(svn_fs_root_t *root,
                                   apr_pool_t *scratch_pool)
 {
   apr_array_header_t *entries;
+  apr_array_header_t *ids;
+  apr_array_header_t *kids;
   int i;
   apr_pool_t *iterpool = svn_pool_create(scratch_pool);
 
   SVN_ERR(svn_fs_fs__dag_dir_entries(&entries, dir_dag, scratch_pool));
+
+  /* Fetch the node-revisions of all entries in one batch. */
+  ids = apr_array_make(scratch_pool, entries->nelts, sizeof(svn_fs_id_t *));
+  for (i = 0; i < entries->nelts; ++i)
+    APR_ARRAY_PUSH(ids, const svn_fs_id_t *)
+      = APR_ARRAY_IDX(entries, i, svn_fs_dirent_t *)->id;
+  SVN_ERR(svn_fs_fs__dag_get_nodes(&kids, root->fs, ids, scratch_pool));
+
   for (i = 0; i < entries->nelts; ++i)
     {
       svn_fs_dirent_t *dirent = APR_ARRAY_IDX(entries, i, svn_fs_dirent_t *);
       const char *kid_path;
-      dag_node_t *kid_dag;
+      dag_node_t *kid_dag = APR_ARRAY_IDX(kids, i, dag_node_t *);
       svn_boolean_t has_mergeinfo, go_down;
 
       svn_pool_clear(iterpool);
 
       kid_path = svn_fspath__join(this_path, dirent->name, iterpool);
-      SVN_ERR(get_dag(&kid_dag, root, kid_path, iterpool));
 
       SVN_ERR(svn_fs_fs__dag_has_mergeinfo(&has_mergeinfo, kid_dag));
       SVN_ERR(svn_fs_fs__dag_has_descendants_with_mergeinfo(&go_down, kid_dag));
 
+      /* Save this particular node's mergeinfo. */
       if (has_mergeinfo)
-        {
-          /* Save this particular node's mergeinfo. */
-          apr_hash_t *proplist;
-          svn_mergeinfo_t kid_mergeinfo;
-          svn_string_t *mergeinfo_string;
-          svn_error_t *err;
-
-          SVN_ERR(svn_fs_fs__dag_get_proplist(&proplist, kid_dag, iterpool));
-          mergeinfo_string = svn_hash_gets(proplist, SVN_PROP_MERGEINFO);
-          if (!mergeinfo_string)
-            {
-              svn_string_t *idstr = svn_fs_fs__id_unparse(dirent->id, iterpool);
-              return svn_error_createf
-                (SVN_ERR_FS_CORRUPT, NULL,
-                 _("Node-revision #'%s' claims to have mergeinfo but doesn't"),
-                 idstr->data);
-            }
-
-          /* Issue #3896: If a node has syntactically invalid mergeinfo, then
-             treat it as if no mergeinfo is present rather than raising a parse
-             error. */
-          err = svn_mergeinfo_parse(&kid_mergeinfo,
-                                    mergeinfo_string->data,
-                                    iterpool);
-          if (err)
-            {
-              if (err->apr_err == SVN_ERR_MERGEINFO_PARSE_ERROR)
-                svn_error_clear(err);
-              else
-                return svn_error_trace(err);
-              }
-          else
-            {
-              SVN_ERR(receiver(kid_path, kid_mergeinfo, baton, iterpool));
-            }
-        }
+        SVN_ERR(report_node_mergeinfo(kid_path, kid_dag, receiver, baton,
+                                      iterpool));
 
       if (go_down)
         SVN_ERR(crawl_directory_dag_for_mergeinfo(root,
@@ -4453,6 +4670,81 @@ get_mergeinfo_for_path(svn_mergeinfo_t *mergeinfo,
   return SVN_NO_ERROR;
 }
 
+/* Like crawl_directory_dag_for_mergeinfo for PATH in ROOT but use the
+   mergeinfo index of the repository to find the sub-paths with mergeinfo.
+   Set *HANDLED to FALSE, without calling RECEIVER, if there is no index
+   covering the revision of ROOT or if its data don't match the tree.
+   Otherwise, set it to TRUE.  Use SCRATCH_POOL for temporary values. */
+static svn_error_t *
+index_descendant_mergeinfo(svn_boolean_t *handled,
+                           svn_fs_root_t *root,
+                           const char *path,
+                           svn_fs_mergeinfo_receiver_t receiver,
+                           void *baton,
+                           apr_pool_t *scratch_pool)
+{
+  apr_pool_t *iterpool;
+  apr_array_header_t *paths;
+  apr_array_header_t *nodes;
+  int i;
+
+  if (root->is_txn_root)
+    {
+      *handled = FALSE;
+      return SVN_NO_ERROR;
+    }
+
+  SVN_ERR(svn_fs_fs__mergeinfo_index_get_descendants(handled, &paths,
+                                                     root->fs, path,
+                                                     root->rev,
+                                                     scratch_pool,
+                                                     scratch_pool));
+  if (!*handled)
+    return SVN_NO_ERROR;
+
+  /* Look up all nodes before reporting any of them, such that we can
+     still fall back to crawling the tree. */
+  nodes = apr_array_make(scratch_pool, paths->nelts, sizeof(dag_node_t *));
+  for (i = 0; i < paths->nelts; ++i)
+    {
+      const char *kid_path = APR_ARRAY_IDX(paths, i, const char *);
+      dag_node_t *kid_dag;
+      svn_boolean_t has_mergeinfo;
+      svn_error_t *err;
+
+      err = get_dag(&kid_dag, root, kid_path, scratch_pool);
+      if (err && err->apr_err == SVN_ERR_FS_NOT_FOUND)
+        {
+          svn_error_clear(err);
+          *handled = FALSE;
+          return SVN_NO_ERROR;
+        }
+
+      SVN_ERR(err);
+      SVN_ERR(svn_fs_fs__dag_has_mergeinfo(&has_mergeinfo, kid_dag));
+      if (!has_mergeinfo)
+        {
+          *handled = FALSE;
+          return SVN_NO_ERROR;
+        }
+
+      APR_ARRAY_PUSH(nodes, dag_node_t *) = kid_dag;
+    }
+
+  iterpool = svn_pool_create(scratch_pool);
+  for (i = 0; i < paths->nelts; ++i)
+    {
+      svn_pool_clear(iterpool);
+      SVN_ERR(report_node_mergeinfo(APR_ARRAY_IDX(paths, i, const char *),
+                                    APR_ARRAY_IDX(nodes, i, dag_node_t *),
+                                    receiver, baton, iterpool));
+    }
+
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
 /* Invoke RECEIVER with BATON for each mergeinfo found on descendants of
    PATH (but not PATH itself).  Use SCRATCH_POOL for temporary values. */
 static svn_error_t *
@@ -4464,11 +4756,19 @@ add_descendant_mergeinfo(svn_fs_root_t *root,
 {
   dag_node_t *this_dag;
   svn_boolean_t go_down;
+  svn_boolean_t handled;
 
   SVN_ERR(get_dag(&this_dag, root, path, scratch_pool));
   SVN_ERR(svn_fs_fs__dag_has_descendants_with_mergeinfo(&go_down,
                                                         this_dag));
-  if (go_down)
+  if (!go_down)
+    return SVN_NO_ERROR;
+
+  /* If the repository has a mergeinfo index, there is no need to crawl
+     the tree. */
+  SVN_ERR(index_descendant_mergeinfo(&handled, root, path, receiver, baton,
+                                     scratch_pool));
+  if (!handled)
     SVN_ERR(crawl_directory_dag_for_mergeinfo(root,
                                               path,
                                               this_dag,
@@ -4601,6 +4901,8 @@ static root_vtable_t root_vtable = {
   fs_apply_text,
   fs_contents_changed,
   fs_get_file_delta_stream,
+  fs_try_get_stored_delta,
+  svn_fs_fs__apply_texts,
   fs_merge,
   fs_get_mergeinfo,
 };
@@ -84,6 +84,20 @@ svn_fs_fs__node_created_rev(svn_revnum_t *revision,
                             const char *path,
                             apr_pool_t *pool);
 
+/* Set the contents of the files in transaction ROOT as given by TEXTS
+   (an array of svn_fs__text_t *).  This has the same effect as
+   calling svn_fs_apply_text for each of them in turn but uses up to
+   THREAD_COUNT threads for checksumming and deltification.
+   Use POOL for allocations.  Implements the apply_texts root vtable
+   function. */
+svn_error_t *
+svn_fs_fs__apply_texts(svn_fs_root_t *root,
+                       const apr_array_header_t *texts,
+                       int thread_count,
+                       svn_cancel_func_t cancel_func,
+                       void *cancel_baton,
+                       apr_pool_t *pool);
+
 /* Verify metadata for ROOT.
    ### Currently only implemented for revision roots. */
 svn_error_t *
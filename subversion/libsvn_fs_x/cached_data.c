@@ -385,6 +385,63 @@ svn_fs_x__get_node_revision(svn_fs_x__noderev_t **noderev_p,
   return svn_error_trace(err);
 }
 
+svn_error_t *
+svn_fs_x__get_node_revisions(svn_fs_x__noderev_t **noderevs,
+                             svn_fs_t *fs,
+                             const apr_array_header_t *ids,
+                             apr_pool_t *result_pool,
+                             apr_pool_t *scratch_pool)
+{
+  svn_fs_x__data_t *ffd = fs->fsap_data;
+  apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+  svn_boolean_t *found = apr_pcalloc(scratch_pool,
+                                     ids->nelts * sizeof(*found));
+  apr_array_header_t *keys = apr_array_make(scratch_pool, ids->nelts,
+                                            sizeof(void *));
+  int i;
+
+  /* Fetch all noderevs that may be in the node_revision_cache in one go.
+     Packed noderevs usually come from the containers cache instead and
+     transaction noderevs are not cached at all.  We pass NULL keys for
+     them. */
+  for (i = 0; i < ids->nelts; ++i)
+    {
+      const svn_fs_x__id_t *id = APR_ARRAY_IDX(ids, i, const svn_fs_x__id_t *);
+      svn_fs_x__pair_cache_key_t *key = NULL;
+
+      if (!svn_fs_x__is_txn(id->change_set))
+        {
+          svn_revnum_t revision = svn_fs_x__get_revnum(id->change_set);
+          if (!svn_fs_x__is_packed_rev(fs, revision))
+            {
+              key = apr_pcalloc(scratch_pool, sizeof(*key));
+              key->revision = revision;
+              key->second = id->number;
+            }
+        }
+
+      APR_ARRAY_PUSH(keys, svn_fs_x__pair_cache_key_t *) = key;
+    }
+
+  SVN_ERR(svn_cache__get_many((void **)noderevs, found,
+                              ffd->node_revision_cache, keys,
+                              result_pool));
+
+  /* Read the rest individually. */
+  for (i = 0; i < ids->nelts; ++i)
+    if (!found[i])
+      {
+        svn_pool_clear(iterpool);
+        SVN_ERR(svn_fs_x__get_node_revision(&noderevs[i], fs,
+                                            APR_ARRAY_IDX(ids, i,
+                                                    const svn_fs_x__id_t *),
+                                            result_pool, iterpool));
+      }
+
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
 
 svn_error_t *
 svn_fs_x__get_mergeinfo_count(apr_int64_t *count,
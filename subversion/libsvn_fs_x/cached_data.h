@@ -40,6 +40,20 @@ svn_fs_x__get_node_revision(svn_fs_x__noderev_t **noderev_p,
                             apr_pool_t *result_pool,
                             apr_pool_t *scratch_pool);
 
+/* Like svn_fs_x__get_node_revision but for all IDS (an array of
+   const svn_fs_x__id_t *).  Set NODEREVS[i] to the node-revision for the
+   i-th element of IDS.  NODEREVS must have IDS->NELTS elements.
+
+   Node-revisions from non-packed revisions that are already in the cache
+   will be fetched in a single batch, which is much cheaper than
+   individual lookups with e.g. memcached. */
+svn_error_t *
+svn_fs_x__get_node_revisions(svn_fs_x__noderev_t **noderevs,
+                             svn_fs_t *fs,
+                             const apr_array_header_t *ids,
+                             apr_pool_t *result_pool,
+                             apr_pool_t *scratch_pool);
+
 /* Set *COUNT to the value of the mergeinfo_count member of the node-
    revision for the node ID in FS.  Do temporary allocations in SCRATCH_POOL.
  */
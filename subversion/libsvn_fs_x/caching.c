@@ -433,6 +433,12 @@ svn_fs_x__initialize_caches(svn_fs_t *fs,
   /* 1st level DAG node cache */
   ffd->dag_node_cache = svn_fs_x__create_dag_cache(fs->pool);
 
+  /* The process-wide DAG cache is opt-in as it only pays off for servers
+   * with many concurrent sessions on the same repository. */
+  ffd->use_shared_dag_cache
+    = svn_hash__get_bool(fs->config, SVN_FS_CONFIG_FSX_SHARED_DAG_CACHE,
+                         FALSE);
+
   /* Very rough estimate: 1K per directory. */
   SVN_ERR(create_cache(&(ffd->dir_cache),
                        NULL,
@@ -208,6 +208,14 @@ svn_fs_x__changes_estimate_size(const svn_fs_x__changes_t *changes)
        + 100;
 }
 
+void
+svn_fs_x__changes_add_stats(svn_fs_x__changes_container_stats_t *stats,
+                            const svn_fs_x__changes_t *changes)
+{
+  stats->list_count += changes->offsets->nelts - 1;
+  stats->change_count += changes->changes->nelts;
+}
+
 svn_error_t *
 svn_fs_x__changes_get_list(apr_array_header_t **list,
                            const svn_fs_x__changes_t *changes,
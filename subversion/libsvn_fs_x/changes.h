@@ -71,6 +71,13 @@ svn_fs_x__changes_estimate_size(const svn_fs_x__changes_t *changes);
 
 /* Read changes containers. */
 
+/* Add the number of change lists and the total number of changes in
+ * CHANGES to the respective counters in STATS.
+ */
+void
+svn_fs_x__changes_add_stats(svn_fs_x__changes_container_stats_t *stats,
+                            const svn_fs_x__changes_t *changes);
+
 /* From CHANGES, access the change list with the given IDX and extract the
  * next entries according to CONTEXT.  Allocate the result in RESULT_POOL
  * and return it in *LIST.
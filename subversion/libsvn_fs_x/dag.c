@@ -100,26 +100,12 @@ svn_fs_x__dag_set_fs(dag_node_t *node,
 }
 
 
-/* Dup NODEREV and all associated data into RESULT_POOL.
-   Leaves the id and is_fresh_txn_root fields as zero bytes. */
+/* Dup NODEREV and all associated data into RESULT_POOL. */
 static svn_fs_x__noderev_t *
 copy_node_revision(svn_fs_x__noderev_t *noderev,
                    apr_pool_t *result_pool)
 {
-  svn_fs_x__noderev_t *nr = apr_pmemdup(result_pool, noderev,
-                                        sizeof(*noderev));
-
-  if (noderev->copyfrom_path)
-    nr->copyfrom_path = apr_pstrdup(result_pool, noderev->copyfrom_path);
-
-  nr->copyroot_path = apr_pstrdup(result_pool, noderev->copyroot_path);
-  nr->data_rep = svn_fs_x__rep_copy(noderev->data_rep, result_pool);
-  nr->prop_rep = svn_fs_x__rep_copy(noderev->prop_rep, result_pool);
-
-  if (noderev->created_path)
-    nr->created_path = apr_pstrdup(result_pool, noderev->created_path);
-
-  return nr;
+  return svn_fs_x__noderev_copy(noderev, result_pool);
 }
 
 
@@ -186,6 +172,35 @@ svn_fs_x__dag_get_node(dag_node_t **node,
   return SVN_NO_ERROR;
 }
 
+svn_error_t *
+svn_fs_x__dag_get_nodes(apr_array_header_t **nodes,
+                        svn_fs_t *fs,
+                        const apr_array_header_t *ids,
+                        apr_pool_t *result_pool,
+                        apr_pool_t *scratch_pool)
+{
+  svn_fs_x__noderev_t **noderevs
+    = apr_pcalloc(scratch_pool, ids->nelts * sizeof(*noderevs));
+  int i;
+
+  SVN_ERR(svn_fs_x__get_node_revisions(noderevs, fs, ids, result_pool,
+                                       scratch_pool));
+
+  *nodes = apr_array_make(result_pool, ids->nelts, sizeof(dag_node_t *));
+  for (i = 0; i < ids->nelts; ++i)
+    {
+      dag_node_t *new_node = apr_pcalloc(result_pool, sizeof(*new_node));
+      new_node->fs = fs;
+      new_node->hint = APR_SIZE_MAX;
+      new_node->node_pool = result_pool;
+      new_node->node_revision = noderevs[i];
+
+      APR_ARRAY_PUSH(*nodes, dag_node_t *) = new_node;
+    }
+
+  return SVN_NO_ERROR;
+}
+
 
 svn_revnum_t
 svn_fs_x__dag_get_revision(const dag_node_t *node)
@@ -926,6 +941,28 @@ svn_fs_x__dag_dup(const dag_node_t *node,
 }
 
 
+const svn_fs_x__noderev_t *
+svn_fs_x__dag_get_noderev(const dag_node_t *node)
+{
+  return node->node_revision;
+}
+
+dag_node_t *
+svn_fs_x__dag_from_noderev(svn_fs_t *fs,
+                           const svn_fs_x__noderev_t *noderev,
+                           apr_pool_t *result_pool)
+{
+  dag_node_t *new_node = apr_pcalloc(result_pool, sizeof(*new_node));
+  new_node->fs = fs;
+  new_node->hint = APR_SIZE_MAX;
+  new_node->node_pool = result_pool;
+  new_node->node_revision
+    = svn_fs_x__noderev_copy(noderev, result_pool);
+
+  return new_node;
+}
+
+
 svn_error_t *
 svn_fs_x__dag_open(dag_node_t **child_p,
                    dag_node_t *parent,
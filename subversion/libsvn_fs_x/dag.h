@@ -73,6 +73,18 @@ svn_fs_x__dag_get_node(dag_node_t **node,
                        apr_pool_t *result_pool,
                        apr_pool_t *scratch_pool);
 
+/* Like svn_fs_x__dag_get_node but for all IDS (an array of
+   const svn_fs_x__id_t *), e.g. the entries of a directory.  Set *NODES
+   to an array of the respective dag_node_t *, allocated in RESULT_POOL.
+   Cached node-revisions will be fetched in a single batch.  Use
+   SCRATCH_POOL for temporaries. */
+svn_error_t *
+svn_fs_x__dag_get_nodes(apr_array_header_t **nodes,
+                        svn_fs_t *fs,
+                        const apr_array_header_t *ids,
+                        apr_pool_t *result_pool,
+                        apr_pool_t *scratch_pool);
+
 
 /* Return a new dag_node_t object referring to the same node as NODE,
    allocated in RESULT_POOL.  If you're trying to build a structure in a
@@ -82,6 +94,17 @@ dag_node_t *
 svn_fs_x__dag_dup(const dag_node_t *node,
                   apr_pool_t *result_pool);
 
+/* Return NODE's node revision.  The result must not be modified. */
+const svn_fs_x__noderev_t *
+svn_fs_x__dag_get_noderev(const dag_node_t *node);
+
+/* Return a new dag_node_t object for a copy of NODEREV in FS, allocated
+   in RESULT_POOL. */
+dag_node_t *
+svn_fs_x__dag_from_noderev(svn_fs_t *fs,
+                           const svn_fs_x__noderev_t *noderev,
+                           apr_pool_t *result_pool);
+
 /* Return the filesystem containing NODE.  */
 svn_fs_t *
 svn_fs_x__dag_get_fs(dag_node_t *node);
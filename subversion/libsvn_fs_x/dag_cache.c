@@ -466,6 +466,225 @@ svn_fs_x__invalidate_dag_cache(svn_fs_root_t *root,
     }
 }
 
+
+/* Process-wide cache */
+
+/* Number of entries per generation in the shared cache.  Once the current
+   generation is full, the previous one gets dropped.  Popular paths will
+   have been promoted to the current generation by then.
+ */
+enum { SHARED_GENERATION_SIZE = 0x4000 };
+
+/* The process-wide cache of path lookups in revision roots.  Since
+   committed node revisions are immutable, the results of a DAG walk in
+   one session are valid for all other sessions of the same repository.
+
+   Sessions copy node revisions in and out of the cache while holding
+   MUTEX.  No references to cache contents ever escape, so dropping a
+   whole generation at once is safe.
+ */
+struct svn_fs_x__shared_dag_cache_t
+{
+  /* Serializes all access to the members below. */
+  svn_mutex__t *mutex;
+
+  /* Map the keys created by shared_cache_key() to svn_fs_x__noderev_t *
+     allocated in CURRENT_POOL and PREVIOUS_POOL, respectively. */
+  apr_hash_t *current;
+  apr_hash_t *previous;
+
+  /* Pools holding the respective generation. */
+  apr_pool_t *current_pool;
+  apr_pool_t *previous_pool;
+};
+
+svn_error_t *
+svn_fs_x__create_shared_dag_cache(svn_fs_x__shared_dag_cache_t **cache,
+                                  apr_pool_t *result_pool)
+{
+  svn_fs_x__shared_dag_cache_t *result = apr_pcalloc(result_pool,
+                                                     sizeof(*result));
+
+  SVN_ERR(svn_mutex__init(&result->mutex, TRUE, result_pool));
+  result->current_pool = svn_pool_create(result_pool);
+  result->previous_pool = svn_pool_create(result_pool);
+  result->current = apr_hash_make(result->current_pool);
+  result->previous = apr_hash_make(result->previous_pool);
+
+  *cache = result;
+  return SVN_NO_ERROR;
+}
+
+/* Return the process-wide DAG cache to use for lookups in ROOT or NULL if
+   there is none. */
+static svn_fs_x__shared_dag_cache_t *
+get_shared_cache(svn_fs_root_t *root)
+{
+  svn_fs_x__data_t *ffd = root->fs->fsap_data;
+
+  if (root->is_txn_root || !ffd->use_shared_dag_cache || !ffd->shared)
+    return NULL;
+
+  return ffd->shared->dag_node_cache;
+}
+
+/* Set *KEY to the cache key for PATH in REVISION and *KEY_LEN to its
+   length.  Allocate the key in RESULT_POOL. */
+static void
+shared_cache_key(const char **key,
+                 apr_size_t *key_len,
+                 svn_revnum_t revision,
+                 const svn_string_t *path,
+                 apr_pool_t *result_pool)
+{
+  char *result = apr_palloc(result_pool, sizeof(revision) + path->len);
+  memcpy(result, &revision, sizeof(revision));
+  memcpy(result + sizeof(revision), path->data, path->len);
+
+  *key = result;
+  *key_len = sizeof(revision) + path->len;
+}
+
+/* Add a copy of NODEREV under KEY with KEY_LEN to CACHE's current
+   generation.  Start a new generation if the current one is full.
+   Return the copy.  The caller must hold CACHE's mutex. */
+static const svn_fs_x__noderev_t *
+shared_cache_insert(svn_fs_x__shared_dag_cache_t *cache,
+                    const char *key,
+                    apr_size_t key_len,
+                    const svn_fs_x__noderev_t *noderev)
+{
+  svn_fs_x__noderev_t *copy;
+
+  if (apr_hash_count(cache->current) >= SHARED_GENERATION_SIZE)
+    {
+      apr_pool_t *pool = cache->previous_pool;
+
+      /* NODEREV may live in the generation that we are about to drop. */
+      copy = svn_fs_x__noderev_copy(noderev, cache->current_pool);
+      noderev = copy;
+
+      svn_pool_clear(pool);
+      cache->previous_pool = cache->current_pool;
+      cache->previous = cache->current;
+      cache->current_pool = pool;
+      cache->current = apr_hash_make(pool);
+    }
+
+  copy = svn_fs_x__noderev_copy(noderev, cache->current_pool);
+  apr_hash_set(cache->current,
+               apr_pmemdup(cache->current_pool, key, key_len), key_len,
+               copy);
+
+  return copy;
+}
+
+/* Body of shared_dag_cache_get(), to be called with CACHE's mutex held. */
+static svn_error_t *
+shared_cache_get_locked(dag_node_t **node_p,
+                        svn_fs_x__shared_dag_cache_t *cache,
+                        svn_fs_t *fs,
+                        const char *key,
+                        apr_size_t key_len,
+                        apr_pool_t *result_pool)
+{
+  const svn_fs_x__noderev_t *noderev
+    = apr_hash_get(cache->current, key, key_len);
+
+  /* Promote entries from the previous generation such that they survive
+     the next cleanup. */
+  if (noderev == NULL)
+    {
+      noderev = apr_hash_get(cache->previous, key, key_len);
+      if (noderev)
+        noderev = shared_cache_insert(cache, key, key_len, noderev);
+    }
+
+  *node_p = noderev
+          ? svn_fs_x__dag_from_noderev(fs, noderev, result_pool)
+          : NULL;
+
+  return SVN_NO_ERROR;
+}
+
+/* Look up PATH in ROOT in the process-wide DAG cache.  If found, put a
+   copy of the node into the session's cache and return a reference to it
+   in *NODE_P.  Otherwise, set *NODE_P to NULL.
+   Use SCRATCH_POOL for temporary allocations.
+
+   NOTE: *NODE_P will live within the DAG cache and we merely return a
+   reference to it.  Hence, it will invalid upon the next cache insertion.
+   Callers must create a copy if they want a non-temporary object.
+ */
+static svn_error_t *
+shared_dag_cache_get(dag_node_t **node_p,
+                     svn_fs_root_t *root,
+                     const svn_string_t *path,
+                     apr_pool_t *scratch_pool)
+{
+  svn_fs_x__data_t *ffd = root->fs->fsap_data;
+  svn_fs_x__shared_dag_cache_t *shared = get_shared_cache(root);
+  svn_fs_x__dag_cache_t *cache = ffd->dag_node_cache;
+  cache_entry_t *bucket;
+  const char *key;
+  apr_size_t key_len;
+
+  *node_p = NULL;
+  if (shared == NULL)
+    return SVN_NO_ERROR;
+
+  shared_cache_key(&key, &key_len, root->rev, path, scratch_pool);
+
+  auto_clear_dag_cache(cache);
+  bucket = cache_lookup(cache, svn_fs_x__root_change_set(root), path);
+  SVN_MUTEX__WITH_LOCK(shared->mutex,
+                       shared_cache_get_locked(&bucket->node, shared,
+                                               root->fs, key, key_len,
+                                               cache->pool));
+
+  *node_p = bucket->node;
+  return SVN_NO_ERROR;
+}
+
+/* Body of shared_dag_cache_set(), to be called with CACHE's mutex held. */
+static svn_error_t *
+shared_cache_set_locked(svn_fs_x__shared_dag_cache_t *cache,
+                        const char *key,
+                        apr_size_t key_len,
+                        const svn_fs_x__noderev_t *noderev)
+{
+  if (apr_hash_get(cache->current, key, key_len) == NULL)
+    shared_cache_insert(cache, key, key_len, noderev);
+
+  return SVN_NO_ERROR;
+}
+
+/* Store a copy of NODE, found at PATH in ROOT, in the process-wide DAG
+   cache, if that is enabled.  Use SCRATCH_POOL for temporary allocations.
+ */
+static svn_error_t *
+shared_dag_cache_set(svn_fs_root_t *root,
+                     const svn_string_t *path,
+                     dag_node_t *node,
+                     apr_pool_t *scratch_pool)
+{
+  svn_fs_x__shared_dag_cache_t *shared = get_shared_cache(root);
+  const svn_fs_x__noderev_t *noderev = svn_fs_x__dag_get_noderev(node);
+  const char *key;
+  apr_size_t key_len;
+
+  if (shared == NULL)
+    return SVN_NO_ERROR;
+
+  shared_cache_key(&key, &key_len, root->rev, path, scratch_pool);
+  SVN_MUTEX__WITH_LOCK(shared->mutex,
+                       shared_cache_set_locked(shared, key, key_len,
+                                               noderev));
+
+  return SVN_NO_ERROR;
+}
+
+
 
 /* Traversing directory paths.  */
 
@@ -1078,9 +1297,20 @@ svn_fs_x__get_temp_dag_node(dag_node_t **node_p,
   /* First we look for the DAG in our cache. */
   *node_p = dag_node_cache_get(root, normalize_path(&normalized, path));
 
-  /* If it is not there, walk the DAG and fill the cache. */
+  /* Then, try the cache shared with other sessions. */
   if (! *node_p)
-    SVN_ERR(walk_dag_path(node_p, root, &normalized, scratch_pool));
+    SVN_ERR(shared_dag_cache_get(node_p, root, &normalized, scratch_pool));
+
+  /* If it is not there, walk the DAG and fill the caches. */
+  if (! *node_p)
+    {
+      /* The walker modifies the path string. */
+      svn_string_t walk_path = normalized;
+
+      SVN_ERR(walk_dag_path(node_p, root, &walk_path, scratch_pool));
+      SVN_ERR(shared_dag_cache_set(root, &normalized, *node_p,
+                                   scratch_pool));
+    }
 
   return SVN_NO_ERROR;
 }
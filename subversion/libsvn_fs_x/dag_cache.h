@@ -33,6 +33,12 @@ extern "C" {
 svn_fs_x__dag_cache_t*
 svn_fs_x__create_dag_cache(apr_pool_t *result_pool);
 
+/* In RESULT_POOL, create an instance of a process-wide, thread-safe
+   cache for path lookups in revision roots and return it in *CACHE. */
+svn_error_t *
+svn_fs_x__create_shared_dag_cache(svn_fs_x__shared_dag_cache_t **cache,
+                                  apr_pool_t *result_pool);
+
 /* Invalidate cache entries for PATH within ROOT and any of its children. */
 void
 svn_fs_x__invalidate_dag_cache(svn_fs_root_t *root,
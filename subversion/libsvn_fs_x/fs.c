@@ -35,6 +35,7 @@
 #include "batch_fsync.h"
 #include "fs.h"
 #include "fs_x.h"
+#include "dag_cache.h"
 #include "fs_init.h"
 #include "pack.h"
 #include "recovery.h"
@@ -45,6 +46,8 @@
 #include "id.h"
 #include "revprops.h"
 #include "rep-cache.h"
+#include "index.h"
+#include "stats.h"
 #include "transaction.h"
 #include "util.h"
 #include "svn_private_config.h"
@@ -127,6 +130,11 @@ x_serialized_init(svn_fs_t *fs,
          transaction list and free transaction pointer. */
       SVN_ERR(svn_mutex__init(&ffsd->txn_list_lock, TRUE, common_pool));
 
+      /* The cache for path lookups in revision roots is cheap to create
+         and only gets filled if some session actually uses it. */
+      SVN_ERR(svn_fs_x__create_shared_dag_cache(&ffsd->dag_node_cache,
+                                                common_pool));
+
       key = apr_pstrdup(common_pool, key);
       status = apr_pool_userdata_set(ffsd, key, NULL, common_pool);
       if (status)
@@ -286,6 +294,58 @@ x_begin_txn(svn_fs_txn_t **txn_p,
 }
 
 
+static svn_error_t *
+x_ioctl(svn_fs_t *fs,
+        svn_fs_ioctl_code_t ctlcode,
+        void *input_void,
+        void **output_p,
+        svn_cancel_func_t cancel_func,
+        void *cancel_baton,
+        apr_pool_t *result_pool,
+        apr_pool_t *scratch_pool)
+{
+  if (strcmp(ctlcode.fs_type, SVN_FS_TYPE_FSX) == 0)
+    {
+      if (ctlcode.code == SVN_FS_X__IOCTL_GET_STATS.code)
+        {
+          svn_fs_x__ioctl_get_stats_input_t *input = input_void;
+          svn_fs_x__ioctl_get_stats_output_t *output;
+
+          output = apr_pcalloc(result_pool, sizeof(*output));
+          SVN_ERR(svn_fs_x__get_stats(&output->stats, fs,
+                                      input->thread_count,
+                                      input->progress_func,
+                                      input->progress_baton,
+                                      cancel_func, cancel_baton,
+                                      result_pool, scratch_pool));
+          *output_p = output;
+          return SVN_NO_ERROR;
+        }
+      else if (ctlcode.code == SVN_FS_X__IOCTL_DUMP_INDEX.code)
+        {
+          svn_fs_x__ioctl_dump_index_input_t *input = input_void;
+
+          SVN_ERR(svn_fs_x__dump_index(fs, input->revision,
+                                       input->callback_func,
+                                       input->callback_baton,
+                                       cancel_func, cancel_baton,
+                                       scratch_pool));
+          *output_p = NULL;
+          return SVN_NO_ERROR;
+        }
+      else if (ctlcode.code == SVN_FS_X__IOCTL_LOAD_INDEX.code)
+        {
+          svn_fs_x__ioctl_load_index_input_t *input = input_void;
+
+          SVN_ERR(svn_fs_x__load_index(fs, input->revision, input->entries,
+                                       scratch_pool));
+          *output_p = NULL;
+          return SVN_NO_ERROR;
+        }
+    }
+
+  return svn_error_create(SVN_ERR_FS_UNRECOGNIZED_IOCTL_CODE, NULL, NULL);
+}
 
 /* The vtable associated with a specific open filesystem. */
 static fs_vtable_t fs_vtable = {
@@ -312,7 +372,9 @@ static fs_vtable_t fs_vtable = {
   svn_fs_x__verify_root,
   x_freeze,
   x_set_errcall,
-  NULL /* ioctl */
+  x_ioctl,
+  NULL /* try_get_deleted_rev */,
+  NULL /* set_bulk_mode */
 };
 
 
@@ -522,8 +584,8 @@ x_pack(svn_fs_t *fs,
    DST_FS at DEST_PATH. If INCREMENTAL is TRUE, make an effort not to
    re-copy data which already exists in DST_FS.
    The CLEAN_LOGS argument is ignored and included for Subversion
-   1.0.x compatibility.  The NOTIFY_FUNC and NOTIFY_BATON arguments
-   are also currently ignored.
+   1.0.x compatibility.  The COMPARE_CHECKSUMS, THREAD_COUNT, NOTIFY_FUNC
+   and NOTIFY_BATON arguments are also currently ignored.
    Perform all temporary allocations in SCRATCH_POOL. */
 static svn_error_t *
 x_hotcopy(svn_fs_t *src_fs,
@@ -532,6 +594,8 @@ x_hotcopy(svn_fs_t *src_fs,
           const char *dst_path,
           svn_boolean_t clean_logs,
           svn_boolean_t incremental,
+          svn_boolean_t compare_checksums,
+          int thread_count,
           svn_fs_hotcopy_notify_t notify_func,
           void *notify_baton,
           svn_cancel_func_t cancel_func,
@@ -111,6 +111,8 @@ extern "C" {
 #define CONFIG_OPTION_BLOCK_SIZE         "block-size"
 #define CONFIG_OPTION_L2P_PAGE_SIZE      "l2p-page-size"
 #define CONFIG_OPTION_P2L_PAGE_SIZE      "p2l-page-size"
+#define CONFIG_SECTION_PACK              "pack"
+#define CONFIG_OPTION_PACK_THREADS       "threads"
 #define CONFIG_SECTION_DEBUG             "debug"
 #define CONFIG_OPTION_PACK_AFTER_COMMIT  "pack-after-commit"
 
@@ -166,6 +168,9 @@ typedef struct svn_fs_x__shared_txn_data_t
   apr_pool_t *pool;
 } svn_fs_x__shared_txn_data_t;
 
+/* Data structure for the process-wide DAG path lookup cache. */
+typedef struct svn_fs_x__shared_dag_cache_t svn_fs_x__shared_dag_cache_t;
+
 /* Private FSX-specific data shared between all svn_fs_t objects that
    relate to a particular filesystem, as identified by filesystem UUID.
    Objects of this type are allocated in the common pool. */
@@ -202,6 +207,10 @@ typedef struct svn_fs_x__shared_data_t
      repository pack operation lock. */
   svn_mutex__t *fs_pack_lock;
 
+  /* Path lookup results for revision roots, shared between all sessions
+     that enabled SVN_FS_CONFIG_FSX_SHARED_DAG_CACHE.  Thread-safe. */
+  svn_fs_x__shared_dag_cache_t *dag_node_cache;
+
   /* The common pool, under which this object is allocated, subpools
      of which are used to allocate the transaction objects. */
   apr_pool_t *common_pool;
@@ -290,6 +299,9 @@ typedef struct svn_fs_x__data_t
   /* Caches native dag_node_t* instances */
   svn_fs_x__dag_cache_t *dag_node_cache;
 
+  /* If TRUE, use and fill the process-wide DAG cache in SHARED. */
+  svn_boolean_t use_shared_dag_cache;
+
   /* A cache of the contents of immutable directories; maps from
      unparsed FS ID to a apr_hash_t * mapping (const char *) dirent
      names to (svn_fs_x__dirent_t *). */
@@ -394,6 +406,9 @@ typedef struct svn_fs_x__data_t
   /* Compression level to use with txdelta storage format in new revs. */
   int delta_compression_level;
 
+  /* Maximum number of threads to use when building containers in pack. */
+  apr_int32_t pack_threads;
+
   /* Pack after every commit. */
   svn_boolean_t pack_after_commit;
 
@@ -262,6 +262,7 @@ read_config(svn_fs_x__data_t *ffd,
 {
   svn_config_t *config;
   apr_int64_t compression_level;
+  apr_int64_t pack_threads;
 
   SVN_ERR(svn_config_read3(&config,
                            svn_dirent_join(fs_path, PATH_CONFIG, scratch_pool),
@@ -332,6 +333,13 @@ read_config(svn_fs_x__data_t *ffd,
   ffd->p2l_page_size *= 0x400;
   /* L2P pages are in entries - not in (k)Bytes */
 
+  /* Pack settings. */
+  SVN_ERR(svn_config_get_int64(config, &pack_threads,
+                               CONFIG_SECTION_PACK,
+                               CONFIG_OPTION_PACK_THREADS,
+                               4));
+  ffd->pack_threads = (apr_int32_t)MIN(MAX(1, pack_threads), 256);
+
   /* Debug options. */
   SVN_ERR(svn_config_get_bool(config, &ffd->pack_after_commit,
                               CONFIG_SECTION_DEBUG,
@@ -528,6 +536,14 @@ write_config(svn_fs_t *fs,
 "### Must be a power of 2."                                                  NL
 "### p2l-page-size is given in kBytes and with a default of 1024 kBytes."    NL
 "# " CONFIG_OPTION_P2L_PAGE_SIZE " = 1024"                                   NL
+""                                                                           NL
+"[" CONFIG_SECTION_PACK "]"                                                  NL
+"### Packing combines similar representations into containers.  Finding"     NL
+"### the common sub-strings is CPU intensive,  so the containers are built"  NL
+"### in parallel by up to this many threads.  The pack file contents does"   NL
+"### not depend on this setting.  Higher values require more memory."        NL
+"### threads defaults to 4."                                                 NL
+"# " CONFIG_OPTION_PACK_THREADS " = 4"                                       NL
 ;
 #undef NL
   return svn_io_file_create(svn_dirent_join(fs->path, PATH_CONFIG,
@@ -867,6 +883,26 @@ svn_fs_x__rep_copy(svn_fs_x__representation_t *rep,
   return apr_pmemdup(result_pool, rep, sizeof(*rep));
 }
 
+svn_fs_x__noderev_t *
+svn_fs_x__noderev_copy(const svn_fs_x__noderev_t *noderev,
+                       apr_pool_t *result_pool)
+{
+  svn_fs_x__noderev_t *nr = apr_pmemdup(result_pool, noderev,
+                                        sizeof(*noderev));
+
+  if (noderev->copyfrom_path)
+    nr->copyfrom_path = apr_pstrdup(result_pool, noderev->copyfrom_path);
+
+  nr->copyroot_path = apr_pstrdup(result_pool, noderev->copyroot_path);
+  nr->data_rep = svn_fs_x__rep_copy(noderev->data_rep, result_pool);
+  nr->prop_rep = svn_fs_x__rep_copy(noderev->prop_rep, result_pool);
+
+  if (noderev->created_path)
+    nr->created_path = apr_pstrdup(result_pool, noderev->created_path);
+
+  return nr;
+}
+
 
 /* Write out the zeroth revision for filesystem FS.
    Perform temporary allocations in SCRATCH_POOL. */
@@ -109,6 +109,11 @@ svn_fs_x__representation_t *
 svn_fs_x__rep_copy(svn_fs_x__representation_t *rep,
                    apr_pool_t *result_pool);
 
+/* Return a deep copy of NODEREV allocated from RESULT_POOL. */
+svn_fs_x__noderev_t *
+svn_fs_x__noderev_copy(const svn_fs_x__noderev_t *noderev,
+                       apr_pool_t *result_pool);
+
 
 /* Return the recorded checksum of type KIND for the text representation
    of NODREV into CHECKSUM, allocating from RESULT_POOL.  If no stored
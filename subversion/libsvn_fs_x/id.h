@@ -24,6 +24,7 @@
 #define SVN_LIBSVN_FS_X_ID_H
 
 #include "svn_fs.h"
+#include "private/svn_fs_x_private.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -35,11 +36,6 @@ typedef apr_int64_t svn_fs_x__txn_id_t;
 /* svn_fs_x__txn_id_t value for everything that is not a transaction. */
 #define SVN_FS_X__INVALID_TXN_ID ((svn_fs_x__txn_id_t)(-1))
 
-/* Change set is the umbrella term for transaction and revision in FSX.
- * Revision numbers (>=0) map 1:1 onto change sets while txns are mapped
- * onto the negative value range. */
-typedef apr_int64_t svn_fs_x__change_set_t;
-
 /* Invalid / unused change set number. */
 #define SVN_FS_X__INVALID_CHANGE_SET  ((svn_fs_x__change_set_t)(-1))
 
@@ -71,16 +67,6 @@ svn_fs_x__change_set_by_rev(svn_revnum_t revnum);
 svn_fs_x__change_set_t
 svn_fs_x__change_set_by_txn(svn_fs_x__txn_id_t txn_id);
 
-/* An ID in FSX consists of a creation CHANGE_SET number and some changeset-
- * local counter value (NUMBER).
- */
-typedef struct svn_fs_x__id_t
-{
-  svn_fs_x__change_set_t change_set;
-
-  apr_uint64_t number;
-} svn_fs_x__id_t;
-
 
 /*** Operations on ID parts. ***/
 
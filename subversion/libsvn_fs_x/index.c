@@ -3608,23 +3608,19 @@ svn_fs_x__l2p_index_from_p2l_entries(const char **protoname,
      order.  The ENTRY_COUNT member will point to the next item to read+1. */
   sub_item_orders = apr_array_make(scratch_pool, entries->nelts,
                                    sizeof(sub_item_ordered_t));
-  sub_item_orders->nelts = entries->nelts;
 
   for (i = 0; i < entries->nelts; ++i)
     {
       svn_fs_x__p2l_entry_t *entry
         = APR_ARRAY_IDX(entries, i, svn_fs_x__p2l_entry_t *);
-      sub_item_ordered_t *ordered
-        = &APR_ARRAY_IDX(sub_item_orders, i, sub_item_ordered_t);
+      sub_item_ordered_t *ordered;
 
       /* skip unused regions (e.g. padding) */
+      assert(entry);
       if (entry->item_count == 0)
-        {
-          --sub_item_orders->nelts;
-          continue;
-        }
+        continue;
 
-      assert(entry);
+      ordered = apr_array_push(sub_item_orders);
       ordered->entry = entry;
       count += entry->item_count;
 
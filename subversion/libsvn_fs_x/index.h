@@ -75,33 +75,6 @@ svn_fs_x__packed_stream_open(svn_fs_x__packed_number_stream_t **stream,
                              apr_pool_t *result_pool,
                              apr_pool_t *scratch_pool);
 
-/* (user visible) entry in the phys-to-log index.  It describes a section
- * of some packed / non-packed rev file as containing a specific item.
- * There must be no overlapping / conflicting entries.
- */
-typedef struct svn_fs_x__p2l_entry_t
-{
-  /* offset of the first byte that belongs to the item */
-  apr_off_t offset;
-
-  /* length of the item in bytes */
-  apr_off_t size;
-
-  /* type of the item (see SVN_FS_X__ITEM_TYPE_*) defines */
-  apr_uint32_t type;
-
-  /* modified FNV-1a checksum.  0 if unknown checksum */
-  apr_uint32_t fnv1_checksum;
-
-  /* Number of items in this block / container.  Their list can be found
-   * in *ITEMS.  0 for unused sections.  1 for non-container items,
-   * > 1 for containers. */
-  apr_uint32_t item_count;
-
-  /* List of items in that block / container */
-  svn_fs_x__id_t *items;
-} svn_fs_x__p2l_entry_t;
-
 /* Return a (deep) copy of ENTRY, allocated in RESULT_POOL.
  */
 svn_fs_x__p2l_entry_t *
@@ -335,6 +308,36 @@ svn_fs_x__p2l_index_from_p2l_entries(const char **protoname,
                                      apr_pool_t *result_pool,
                                      apr_pool_t *scratch_pool);
 
+/* Index dump / load for repository tools.
+ */
+
+/* Read the P2L index for the rev / pack file containing REVISION in FS.
+ * For each index entry, invoke CALLBACK_FUNC with CALLBACK_BATON.
+ * If not NULL, call CANCEL_FUNC with CANCEL_BATON from time to time.
+ * Use SCRATCH_POOL for temporary allocations.
+ */
+svn_error_t *
+svn_fs_x__dump_index(svn_fs_t *fs,
+                     svn_revnum_t revision,
+                     svn_fs_x__dump_index_func_t callback_func,
+                     void *callback_baton,
+                     svn_cancel_func_t cancel_func,
+                     void *cancel_baton,
+                     apr_pool_t *scratch_pool);
+
+/* Rewrite the respective index information of the rev / pack file in FS
+ * containing REVISION and use the svn_fs_x__p2l_entry_t * array ENTRIES
+ * as the new index contents.  Allocate temporaries from SCRATCH_POOL.
+ *
+ * Note that this becomes a no-op if ENTRIES is empty.  You may use a zero-
+ * sized empty entry instead.
+ */
+svn_error_t *
+svn_fs_x__load_index(svn_fs_t *fs,
+                     svn_revnum_t revision,
+                     apr_array_header_t *entries,
+                     apr_pool_t *scratch_pool);
+
 /* Serialization and caching interface
  */
 
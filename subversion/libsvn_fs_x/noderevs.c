@@ -300,6 +300,15 @@ svn_fs_x__noderevs_estimate_size(const svn_fs_x__noderevs_t *container)
        + 100;
 }
 
+void
+svn_fs_x__noderevs_add_stats(svn_fs_x__noderevs_container_stats_t *stats,
+                             const svn_fs_x__noderevs_t *container)
+{
+  stats->noderev_count += container->noderevs->nelts;
+  stats->id_count += container->ids->nelts;
+  stats->rep_count += container->reps->nelts;
+}
+
 /* Set *ID to the ID part stored at index IDX in IDS.
  */
 static svn_error_t *
@@ -69,6 +69,13 @@ svn_fs_x__noderevs_estimate_size(const svn_fs_x__noderevs_t *container);
 
 /* Read from noderev containers. */
 
+/* Add the number of noderevs, distinct IDs and distinct representation
+ * descriptions in CONTAINER to the respective counters in STATS.
+ */
+void
+svn_fs_x__noderevs_add_stats(svn_fs_x__noderevs_container_stats_t *stats,
+                             const svn_fs_x__noderevs_t *container);
+
 /* From CONTAINER, extract the noderev with the given IDX.  Allocate
  * the result in POOL and return it in *NODEREV_P.
  */
@@ -27,6 +27,7 @@
 #include "private/svn_sorts_private.h"
 #include "private/svn_subr_private.h"
 #include "private/svn_string_private.h"
+#include "private/svn_task.h"
 #include "private/svn_temp_serializer.h"
 
 #include "fs_x.h"
@@ -126,6 +127,18 @@ typedef struct reference_t
   svn_fs_x__id_t from;
 } reference_t;
 
+/* An item being copied through the reorder buffer in store_items().
+ */
+typedef struct copy_item_t
+{
+  /* Item to copy.  Its offset is the position in the temp file. */
+  svn_fs_x__p2l_entry_t *entry;
+
+  /* Position of the item within the reorder buffer and, relative to the
+   * buffer start, in the pack file. */
+  apr_size_t buffer_offset;
+} copy_item_t;
+
 /* This structure keeps track of all the temporary data and status that
  * needs to be kept around during the creation of one pack file.  After
  * each revision range (in case we can't process all revs at once due to
@@ -228,6 +241,10 @@ typedef struct pack_context_t
   /* pool used for temporary data structures that will be cleaned up when
    * the next range of revisions is being processed */
   apr_pool_t *info_pool;
+
+  /* size of the in-memory buffer used to reorder items when copying them
+   * from the temp files into the pack file */
+  apr_size_t reorder_buffer_size;
 } pack_context_t;
 
 /* Create and initialize a new pack context for packing shard SHARD_REV in
@@ -1164,41 +1181,139 @@ store_nodes(pack_context_t *context,
 }
 
 
-/* Finalize CONTAINER and write it to CONTEXT's pack file.
- * Append an P2L entry containing the given SUB_ITEMS to NEW_ENTRIES.
- * Use SCRATCH_POOL for temporary allocations.
+/* A group of representations that will be combined into a single reps
+ * container.  All of it gets prepared by the main thread such that the
+ * worker threads building the container don't need to access the FS.
+ */
+typedef struct reps_batch_t
+{
+  /* svn_fs_x__id_t of the representations, in container order. */
+  apr_array_header_t *sub_items;
+
+  /* The fulltexts of those representations, as const svn_string_t *. */
+  apr_array_header_t *contents;
+
+  /* Sum of the on-disk sizes of those representations in the temp file. */
+  apr_off_t size;
+} reps_batch_t;
+
+/* The serialized reps container built from a reps_batch_t.
+ */
+typedef struct reps_container_t
+{
+  /* The batch that the container has been built from. */
+  const reps_batch_t *batch;
+
+  /* Serialized container data, to be written to the pack file as-is. */
+  svn_stringbuf_t *data;
+
+  /* FNV-1a checksum over DATA. */
+  apr_uint32_t fnv1_checksum;
+} reps_container_t;
+
+/* Baton type for the root task in write_reps_containers().
+ */
+typedef struct reps_batches_baton_t
+{
+  /* The reps_batch_t * to process, in pack file order. */
+  apr_array_header_t *batches;
+
+  /* Pack context to write the containers to. */
+  pack_context_t *context;
+
+  /* Receives the P2L entries of the containers written. */
+  apr_array_header_t *new_entries;
+} reps_batches_baton_t;
+
+/* Implements svn_task__process_func_t.
+ *
+ * Build the reps container for the reps_batch_t given as PROCESS_BATON
+ * and serialize it.  This may run in any thread and does not access the FS.
+ * That is the expensive part as we search for common sub-strings across
+ * all fulltexts in the batch.
  */
 static svn_error_t *
-write_reps_container(pack_context_t *context,
-                     svn_fs_x__reps_builder_t *container,
-                     apr_array_header_t *sub_items,
-                     apr_array_header_t *new_entries,
+build_reps_container(void **result,
+                     svn_task__t *task,
+                     void *thread_context,
+                     void *process_baton,
+                     svn_cancel_func_t cancel_func,
+                     void *cancel_baton,
+                     apr_pool_t *result_pool,
                      apr_pool_t *scratch_pool)
 {
-  apr_off_t offset = 0;
+  const reps_batch_t *batch = process_baton;
+  reps_container_t *container = apr_pcalloc(result_pool, sizeof(*container));
+  svn_stream_t *stream;
+  int i;
+
+  /* The builder will only use the FS when adding base representations,
+   * which we don't. */
+  svn_fs_x__reps_builder_t *builder
+    = svn_fs_x__reps_builder_create(NULL, scratch_pool);
+
+  for (i = 0; i < batch->contents->nelts; ++i)
+    {
+      apr_size_t list_index;
+      SVN_ERR(svn_fs_x__reps_add(&list_index, builder,
+                                 APR_ARRAY_IDX(batch->contents, i,
+                                               const svn_string_t *)));
+      SVN_ERR_ASSERT(list_index == (apr_size_t)i);
+    }
+
+  container->batch = batch;
+  container->data = svn_stringbuf_create_ensure(batch->size + 100,
+                                                result_pool);
+  stream = svn_checksum__wrap_write_stream_fnv1a_32x4
+                        (&container->fnv1_checksum,
+                         svn_stream_from_stringbuf(container->data,
+                                                   scratch_pool),
+                         scratch_pool);
+  SVN_ERR(svn_fs_x__write_reps_container(stream, builder, scratch_pool));
+  SVN_ERR(svn_stream_close(stream));
+
+  *result = container;
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_task__output_func_t.
+ *
+ * Write the reps_container_t given as RESULT to the pack file of the
+ * reps_batches_baton_t OUTPUT_BATON and append a P2L entry for it to
+ * the NEW_ENTRIES in there.  This runs in the main thread in pack file
+ * order, so the pack file contents does not depend on the scheduling.
+ */
+static svn_error_t *
+write_reps_container(svn_task__t *task,
+                     void *result,
+                     void *output_baton,
+                     svn_cancel_func_t cancel_func,
+                     void *cancel_baton,
+                     apr_pool_t *result_pool,
+                     apr_pool_t *scratch_pool)
+{
+  reps_container_t *container = result;
+  reps_batches_baton_t *baton = output_baton;
+  pack_context_t *context = baton->context;
+  apr_array_header_t *sub_items = container->batch->sub_items;
   svn_fs_x__p2l_entry_t container_entry;
 
-  svn_stream_t *pack_stream
-    = svn_checksum__wrap_write_stream_fnv1a_32x4
-                                (&container_entry.fnv1_checksum,
-                                 svn_stream_from_aprfile2(context->pack_file,
-                                                          TRUE, scratch_pool),
-                                 scratch_pool);
+  /* Don't let the container needlessly cross a block boundary. */
+  if (container->data->len > get_block_left(context))
+    SVN_ERR(auto_pad_block(context, scratch_pool));
 
-  SVN_ERR(svn_fs_x__write_reps_container(pack_stream, container,
-                                         scratch_pool));
-  SVN_ERR(svn_stream_close(pack_stream));
-  SVN_ERR(svn_io_file_seek(context->pack_file, APR_CUR, &offset,
-                           scratch_pool));
+  SVN_ERR(svn_io_file_write_full(context->pack_file, container->data->data,
+                                 container->data->len, NULL, scratch_pool));
 
   container_entry.offset = context->pack_offset;
-  container_entry.size = offset - container_entry.offset;
+  container_entry.size = container->data->len;
   container_entry.type = SVN_FS_X__ITEM_TYPE_REPS_CONT;
+  container_entry.fnv1_checksum = container->fnv1_checksum;
   container_entry.item_count = sub_items->nelts;
   container_entry.items = (svn_fs_x__id_t *)sub_items->elts;
 
-  context->pack_offset = offset;
-  APR_ARRAY_PUSH(new_entries, svn_fs_x__p2l_entry_t *)
+  context->pack_offset += container_entry.size;
+  APR_ARRAY_PUSH(baton->new_entries, svn_fs_x__p2l_entry_t *)
     = svn_fs_x__p2l_entry_dup(&container_entry, context->info_pool);
 
   SVN_ERR(svn_fs_x__p2l_proto_index_add_entry
@@ -1207,9 +1322,69 @@ write_reps_container(pack_context_t *context,
   return SVN_NO_ERROR;
 }
 
+/* Implements svn_task__process_func_t.
+ *
+ * Add a container building sub-task for each reps_batch_t in the
+ * reps_batches_baton_t given as PROCESS_BATON.
+ */
+static svn_error_t *
+add_reps_container_tasks(void **result,
+                         svn_task__t *task,
+                         void *thread_context,
+                         void *process_baton,
+                         svn_cancel_func_t cancel_func,
+                         void *cancel_baton,
+                         apr_pool_t *result_pool,
+                         apr_pool_t *scratch_pool)
+{
+  reps_batches_baton_t *baton = process_baton;
+  int i;
+
+  for (i = 0; i < baton->batches->nelts; ++i)
+    {
+      apr_pool_t *process_pool = svn_task__create_process_pool(task);
+      SVN_ERR(svn_task__add(task, process_pool, NULL, build_reps_container,
+                            APR_ARRAY_IDX(baton->batches, i, reps_batch_t *),
+                            write_reps_container, baton));
+    }
+
+  *result = NULL;
+  return SVN_NO_ERROR;
+}
+
+/* Build the reps containers for all reps_batch_t * in BATCHES using up to
+ * the configured number of pack threads.  Write them to CONTEXT's pack
+ * file in order and append their P2L entries to NEW_ENTRIES.  Use
+ * SCRATCH_POOL for temporary allocations.
+ */
+static svn_error_t *
+write_reps_batches(pack_context_t *context,
+                   apr_array_header_t *batches,
+                   apr_array_header_t *new_entries,
+                   apr_pool_t *scratch_pool)
+{
+  svn_fs_x__data_t *ffd = context->fs->fsap_data;
+  reps_batches_baton_t baton;
+
+  baton.batches = batches;
+  baton.context = context;
+  baton.new_entries = new_entries;
+
+  SVN_ERR(svn_task__run(ffd->pack_threads, add_reps_container_tasks, &baton,
+                        NULL, NULL, NULL, NULL,
+                        context->cancel_func, context->cancel_baton,
+                        scratch_pool, scratch_pool));
+
+  return SVN_NO_ERROR;
+}
+
 /* Read the (property) representations identified by svn_fs_x__p2l_entry_t
  * elements in ENTRIES from TEMP_FILE, aggregate them and write them into
  * CONTEXT->PACK_FILE.  Use SCRATCH_POOL for temporary allocations.
+ *
+ * The split into containers depends on the on-disk sizes of the
+ * representations only.  Thus, the containers are independent of each
+ * other and may be built in parallel while the output stays deterministic.
  */
 static svn_error_t *
 write_reps_containers(pack_context_t *context,
@@ -1218,54 +1393,57 @@ write_reps_containers(pack_context_t *context,
                       apr_array_header_t *new_entries,
                       apr_pool_t *scratch_pool)
 {
+  svn_fs_x__data_t *ffd = context->fs->fsap_data;
   apr_pool_t *iterpool = svn_pool_create(scratch_pool);
-  apr_pool_t *container_pool = svn_pool_create(scratch_pool);
+  apr_pool_t *batches_pool = svn_pool_create(scratch_pool);
   int i;
 
-  apr_ssize_t block_left = get_block_left(context);
+  /* The first container shall fill the current block. */
+  apr_off_t block_left = get_block_left(context);
 
-  svn_fs_x__reps_builder_t *container
-    = svn_fs_x__reps_builder_create(context->fs, container_pool);
-  apr_array_header_t *sub_items
-    = apr_array_make(scratch_pool, 64, sizeof(svn_fs_x__id_t));
+  /* Limit the number of fulltexts we keep in memory at any given time. */
+  int max_batches = MAX(2 * ffd->pack_threads, 2);
+  apr_array_header_t *batches
+    = apr_array_make(batches_pool, max_batches, sizeof(reps_batch_t *));
+  reps_batch_t *batch = NULL;
   svn_fs_x__revision_file_t *file;
 
   SVN_ERR(svn_fs_x__rev_file_wrap_temp(&file, context->fs, temp_file,
                                        scratch_pool));
 
-  /* copy all items in strict order */
+  /* read all items in strict order */
   for (i = entries->nelts-1; i >= 0; --i)
     {
       svn_fs_x__representation_t representation = { 0 };
       svn_stringbuf_t *contents;
       svn_stream_t *stream;
-      apr_size_t list_index;
       svn_fs_x__p2l_entry_t *entry
         = APR_ARRAY_IDX(entries, i, svn_fs_x__p2l_entry_t *);
 
-      if ((block_left < entry->size) && sub_items->nelts)
-        {
-          block_left = get_block_left(context)
-                     - svn_fs_x__reps_estimate_size(container);
-        }
-
-      if ((block_left < entry->size) && sub_items->nelts)
+      /* Start a new container once the current one fills its block. */
+      if (batch && block_left < entry->size)
         {
-          SVN_ERR(write_reps_container(context, container, sub_items,
-                                       new_entries, iterpool));
+          batch = NULL;
+          block_left = ffd->block_size;
 
-          apr_array_clear(sub_items);
-          svn_pool_clear(container_pool);
-          container = svn_fs_x__reps_builder_create(context->fs,
-                                                    container_pool);
-          block_left = get_block_left(context);
+          if (batches->nelts == max_batches)
+            {
+              SVN_ERR(write_reps_batches(context, batches, new_entries,
+                                         iterpool));
+              svn_pool_clear(batches_pool);
+              batches = apr_array_make(batches_pool, max_batches,
+                                       sizeof(reps_batch_t *));
+            }
         }
 
-      /* still enough space in current block? */
-      if (block_left < entry->size)
+      if (batch == NULL)
         {
-          SVN_ERR(auto_pad_block(context, iterpool));
-          block_left = get_block_left(context);
+          batch = apr_pcalloc(batches_pool, sizeof(*batch));
+          batch->sub_items = apr_array_make(batches_pool, 64,
+                                            sizeof(svn_fs_x__id_t));
+          batch->contents = apr_array_make(batches_pool, 64,
+                                           sizeof(const svn_string_t *));
+          APR_ARRAY_PUSH(batches, reps_batch_t *) = batch;
         }
 
       assert(entry->item_count == 1);
@@ -1282,29 +1460,27 @@ write_reps_containers(pack_context_t *context,
       SVN_ERR(svn_fs_x__get_contents(&stream, context->fs, &representation,
                                      FALSE, iterpool));
       contents = svn_stringbuf_create_ensure(representation.expanded_size,
-                                             iterpool);
+                                             batches_pool);
       contents->len = representation.expanded_size;
 
       /* The representation is immutable.  Read it normally. */
       SVN_ERR(svn_stream_read_full(stream, contents->data, &contents->len));
       SVN_ERR(svn_stream_close(stream));
 
-      SVN_ERR(svn_fs_x__reps_add(&list_index, container,
-                                 svn_stringbuf__morph_into_string(contents)));
-      SVN_ERR_ASSERT(list_index == sub_items->nelts);
+      APR_ARRAY_PUSH(batch->contents, const svn_string_t *)
+        = svn_stringbuf__morph_into_string(contents);
+      APR_ARRAY_PUSH(batch->sub_items, svn_fs_x__id_t) = entry->items[0];
+      batch->size += entry->size;
       block_left -= entry->size;
 
-      APR_ARRAY_PUSH(sub_items, svn_fs_x__id_t) = entry->items[0];
-
       svn_pool_clear(iterpool);
     }
 
-  if (sub_items->nelts)
-    SVN_ERR(write_reps_container(context, container, sub_items,
-                                 new_entries, iterpool));
+  if (batches->nelts)
+    SVN_ERR(write_reps_batches(context, batches, new_entries, iterpool));
 
   svn_pool_destroy(iterpool);
-  svn_pool_destroy(container_pool);
+  svn_pool_destroy(batches_pool);
 
   return SVN_NO_ERROR;
 }
@@ -1334,9 +1510,96 @@ should_flush_nodes_container(pack_context_t *context,
   return block_left < rep_sum + container_size;
 }
 
+/* implements compare_fn_t.  Sort ascending by source offset.
+ */
+static int
+compare_copy_items(const copy_item_t *lhs,
+                   const copy_item_t *rhs)
+{
+  return lhs->entry->offset < rhs->entry->offset
+       ? -1
+       : (lhs->entry->offset > rhs->entry->offset ? 1 : 0);
+}
+
+/* Append ENTRY at CONTEXT's current pack file position to the P2L index
+ * as well as to CONTEXT->REPS and advance the current pack file position.
+ * Use SCRATCH_POOL for temporary allocations.
+ */
+static svn_error_t *
+add_stored_item(pack_context_t *context,
+                svn_fs_x__p2l_entry_t *entry,
+                apr_pool_t *scratch_pool)
+{
+  entry->offset = context->pack_offset;
+  context->pack_offset += entry->size;
+
+  SVN_ERR(svn_fs_x__p2l_proto_index_add_entry(context->proto_p2l_index,
+                                              entry, scratch_pool));
+  APR_ARRAY_PUSH(context->reps, svn_fs_x__p2l_entry_t *) = entry;
+
+  return SVN_NO_ERROR;
+}
+
+/* Copy the copy_item_t elements in ITEMS from TEMP_FILE to CONTEXT's pack
+ * file using BUFFER.  The items are read in ascending TEMP_FILE order,
+ * i.e. with few seeks and large reads, but written in the order given.
+ * BUFFER_USED is the total size of all ITEMS.  Clears ITEMS.
+ * Use SCRATCH_POOL for temporary allocations.
+ */
+static svn_error_t *
+flush_reorder_buffer(pack_context_t *context,
+                     apr_file_t *temp_file,
+                     apr_array_header_t *items,
+                     char *buffer,
+                     apr_size_t buffer_used,
+                     apr_pool_t *scratch_pool)
+{
+  apr_array_header_t *by_offset = apr_array_copy(scratch_pool, items);
+  apr_off_t file_offset = -1;
+  int i;
+
+  svn_sort__array(by_offset,
+                  (int (*)(const void *, const void *))compare_copy_items);
+
+  /* read in physical order.  Seek only where there are gaps. */
+  for (i = 0; i < by_offset->nelts; ++i)
+    {
+      const copy_item_t *item = &APR_ARRAY_IDX(by_offset, i, copy_item_t);
+      apr_off_t offset = item->entry->offset;
+
+      if (offset != file_offset)
+        SVN_ERR(svn_io_file_seek(temp_file, APR_SET, &offset, scratch_pool));
+
+      SVN_ERR(svn_io_file_read_full2(temp_file,
+                                     buffer + item->buffer_offset,
+                                     (apr_size_t)item->entry->size,
+                                     NULL, NULL, scratch_pool));
+      file_offset = offset + item->entry->size;
+    }
+
+  if (context->cancel_func)
+    SVN_ERR(context->cancel_func(context->cancel_baton));
+
+  /* write in final order, which is a single sequential write. */
+  SVN_ERR(svn_io_file_write_full(context->pack_file, buffer, buffer_used,
+                                 NULL, scratch_pool));
+  for (i = 0; i < items->nelts; ++i)
+    SVN_ERR(add_stored_item(context,
+                            APR_ARRAY_IDX(items, i, copy_item_t).entry,
+                            scratch_pool));
+
+  apr_array_clear(items);
+
+  return SVN_NO_ERROR;
+}
+
 /* Read the contents of the first COUNT non-NULL, non-empty items in ITEMS
  * from TEMP_FILE and write them to CONTEXT->PACK_FILE.
  * Use SCRATCH_POOL for temporary allocations.
+ *
+ * The items are copied in groups that fit into CONTEXT's reorder buffer.
+ * Within each group, TEMP_FILE will be read in physical order rather than
+ * in the final item order, which would cause quasi-random I/O.
  */
 static svn_error_t *
 store_items(pack_context_t *context,
@@ -1347,10 +1610,16 @@ store_items(pack_context_t *context,
 {
   int i;
   apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+  apr_size_t buffer_size = context->reorder_buffer_size;
+  apr_size_t buffer_used = 0;
+  apr_array_header_t *buffered
+    = apr_array_make(scratch_pool, 16, sizeof(copy_item_t));
+  char *buffer = NULL;
 
   /* copy all items in strict order */
   for (i = 0; i < count; ++i)
     {
+      copy_item_t item;
       svn_fs_x__p2l_entry_t *entry
         = APR_ARRAY_IDX(items, i, svn_fs_x__p2l_entry_t *);
       if (!entry
@@ -1358,24 +1627,41 @@ store_items(pack_context_t *context,
           || entry->item_count == 0)
         continue;
 
-      /* select the item in the source file and copy it into the target
-       * pack file */
-      SVN_ERR(svn_io_file_seek(temp_file, APR_SET, &entry->offset,
-                               iterpool));
-      SVN_ERR(copy_file_data(context, context->pack_file, temp_file,
-                             entry->size, iterpool));
+      /* flush the reorder buffer before it overflows */
+      if (buffer_used && buffer_size - buffer_used < entry->size)
+        {
+          SVN_ERR(flush_reorder_buffer(context, temp_file, buffered, buffer,
+                                       buffer_used, iterpool));
+          buffer_used = 0;
+          svn_pool_clear(iterpool);
+        }
 
-      /* write index entry and update current position */
-      entry->offset = context->pack_offset;
-      context->pack_offset += entry->size;
+      /* items larger than the buffer get streamed directly */
+      if (entry->size > buffer_size)
+        {
+          SVN_ERR(svn_io_file_seek(temp_file, APR_SET, &entry->offset,
+                                   iterpool));
+          SVN_ERR(copy_file_data(context, context->pack_file, temp_file,
+                                 entry->size, iterpool));
+          SVN_ERR(add_stored_item(context, entry, iterpool));
+          svn_pool_clear(iterpool);
+          continue;
+        }
 
-      SVN_ERR(svn_fs_x__p2l_proto_index_add_entry
-                  (context->proto_p2l_index, entry, iterpool));
+      /* allocate the buffer lazily as we might not need it at all */
+      if (buffer == NULL)
+        buffer = apr_palloc(scratch_pool, buffer_size);
 
-      APR_ARRAY_PUSH(context->reps, svn_fs_x__p2l_entry_t *) = entry;
-      svn_pool_clear(iterpool);
+      item.entry = entry;
+      item.buffer_offset = buffer_used;
+      APR_ARRAY_PUSH(buffered, copy_item_t) = item;
+      buffer_used += (apr_size_t)entry->size;
     }
 
+  if (buffer_used)
+    SVN_ERR(flush_reorder_buffer(context, temp_file, buffered, buffer,
+                                 buffer_used, iterpool));
+
   svn_pool_destroy(iterpool);
 
   return SVN_NO_ERROR;
@@ -1935,9 +2221,17 @@ pack_log_addressed(svn_fs_t *fs,
                    + 6 * sizeof(void*)
     };
 
-  int max_items = max_mem / PER_ITEM_MEM > INT_MAX
+  svn_fs_x__data_t *ffd = fs->fsap_data;
+
+  /* Use a quarter of the memory budget to reorder items during the final
+   * copy.  That should be large enough to make the I/O bandwidth-bound. */
+  apr_size_t reorder_buffer_size = MAX(max_mem / 4,
+                                       (apr_size_t)ffd->block_size);
+  apr_size_t items_mem = max_mem - max_mem / 4;
+
+  int max_items = items_mem / PER_ITEM_MEM > INT_MAX
                 ? INT_MAX
-                : (int)(max_mem / PER_ITEM_MEM);
+                : (int)(items_mem / PER_ITEM_MEM);
   apr_array_header_t *max_ids;
   pack_context_t context = { 0 };
   int i;
@@ -1948,6 +2242,7 @@ pack_log_addressed(svn_fs_t *fs,
   SVN_ERR(initialize_pack_context(&context, fs, pack_file_dir, shard_dir,
                                   shard_rev, max_items, batch, cancel_func,
                                   cancel_baton, scratch_pool));
+  context.reorder_buffer_size = reorder_buffer_size;
 
   /* phase 1: determine the size of the revisions to pack */
   SVN_ERR(svn_fs_x__l2p_get_max_ids(&max_ids, fs, shard_rev,
@@ -636,6 +636,62 @@ get_text(svn_fs_x__rep_extractor_t *extractor,
       }
 }
 
+/* Walk the COUNT instructions starting at INSTRUCTION_IDX in CONTAINER
+ * just like get_text() does but only add the number of bytes they produce
+ * to *SIZE and the number of copy operations to *COPY_COUNT.  DEPTH is the
+ * nesting level of this instruction sequence.  Update *MAX_DEPTH to the
+ * deepest nesting level found.
+ */
+static void
+get_text_info(apr_uint64_t *size,
+              apr_uint64_t *copy_count,
+              apr_uint64_t *max_depth,
+              const svn_fs_x__reps_t *container,
+              apr_size_t instruction_idx,
+              apr_size_t count,
+              apr_uint64_t depth)
+{
+  const instruction_t *instruction;
+
+  if (depth > *max_depth)
+    *max_depth = depth;
+
+  for (instruction = container->instructions + instruction_idx;
+       instruction < container->instructions + instruction_idx + count;
+       instruction++)
+    if (instruction->offset < 0)
+      {
+        get_text_info(size, copy_count, max_depth, container,
+                      -instruction->offset, instruction->count, depth + 1);
+      }
+    else
+      {
+        *size += instruction->count;
+        ++*copy_count;
+      }
+}
+
+void
+svn_fs_x__reps_add_stats(svn_fs_x__reps_container_stats_t *stats,
+                         const svn_fs_x__reps_t *container)
+{
+  apr_size_t i;
+
+  stats->rep_count += container->rep_count;
+  stats->base_count += container->base_count;
+  stats->instruction_count += container->instruction_count;
+  stats->text_size += container->text_len;
+
+  for (i = 0; i < container->rep_count; ++i)
+    {
+      apr_uint32_t first = container->first_instructions[i];
+      apr_uint32_t last = container->first_instructions[i + 1];
+
+      get_text_info(&stats->expanded_size, &stats->copy_count,
+                    &stats->max_nesting, container, first, last - first, 0);
+    }
+}
+
 svn_error_t *
 svn_fs_x__reps_get(svn_fs_x__rep_extractor_t **extractor,
                    svn_fs_t *fs,
@@ -111,6 +111,16 @@ svn_fs_x__reps_estimate_size(const svn_fs_x__reps_builder_t *builder);
 
 /* Read from representation containers. */
 
+/* Add the number of fulltexts, external bases and instructions as well as
+ * the size of the text corpus in CONTAINER to the respective counters in
+ * STATS.  Also, add the total size of all fulltexts and the number of copy
+ * operations it takes to extract each of them once and update the maximum
+ * instruction nesting level in STATS.
+ */
+void
+svn_fs_x__reps_add_stats(svn_fs_x__reps_container_stats_t *stats,
+                         const svn_fs_x__reps_t *container);
+
 /* For fulltext IDX in CONTAINER in filesystem FS, create an extract object
  * allocated in RESULT_POOL and return it in *EXTRACTOR.
  */
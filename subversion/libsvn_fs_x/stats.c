@@ -0,0 +1,909 @@
+/* stats.c -- implements the svn_fs_x__get_stats private API.
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+#include "svn_pools.h"
+#include "svn_sorts.h"
+
+#include "private/svn_task.h"
+
+#include "stats.h"
+#include "changes.h"
+#include "fs_x.h"
+#include "index.h"
+#include "low_level.h"
+#include "noderevs.h"
+#include "reps.h"
+#include "rev_file.h"
+#include "util.h"
+
+#include "../libsvn_fs/fs-loader.h"
+
+#include "svn_private_config.h"
+
+/* A representation as found in some rev / pack file.
+ */
+typedef struct rep_info_t
+{
+  /* Identifies the representation. */
+  svn_fs_x__id_t id;
+
+  /* Delta base of a stand-alone representation.  Only valid if HAS_BASE
+   * is set. */
+  svn_fs_x__id_t base;
+
+  /* Whether this rep has been deltified against BASE. */
+  svn_boolean_t has_base;
+
+  /* Whether this fulltext lives in a reps container. */
+  svn_boolean_t in_container;
+
+  /* Whether some noderev referenced this representation. */
+  svn_boolean_t referenced;
+
+  /* P2L item type of stand-alone representations; 0 for container reps. */
+  apr_uint32_t type;
+
+  /* Number of deltas to combine to reconstruct this fulltext.
+   * -1 if this has not been determined, yet. */
+  int chain_len;
+} rep_info_t;
+
+/* A reference to a representation from some noderev.
+ */
+typedef struct rep_ref_t
+{
+  /* The representation being referenced. */
+  svn_fs_x__id_t id;
+
+  /* Fulltext size of that representation as recorded in the noderev. */
+  svn_filesize_t expanded_size;
+} rep_ref_t;
+
+/* Everything we learned from a single rev / pack file.
+ */
+typedef struct file_stats_t
+{
+  /* First revision in the file. */
+  svn_revnum_t first_rev;
+
+  /* Number of revisions covered. */
+  int count;
+
+  /* All representations found in the file, rep_info_t elements. */
+  apr_array_header_t *reps;
+
+  /* All representation references found in the file, rep_ref_t elements.
+   * They may refer to representations in older files. */
+  apr_array_header_t *refs;
+
+  /* All information that can be determined from the file alone. */
+  svn_fs_x__stats_t *stats;
+} file_stats_t;
+
+/* Add entry for SIZE to HISTOGRAM.
+ */
+static void
+add_to_histogram(svn_fs_x__histogram_t *histogram,
+                 apr_int64_t size)
+{
+  apr_int64_t shift = 0;
+
+  while (((apr_int64_t)(1) << shift) <= size)
+    shift++;
+
+  histogram->total.count++;
+  histogram->total.sum += size;
+  histogram->lines[(apr_size_t)shift].count++;
+  histogram->lines[(apr_size_t)shift].sum += size;
+}
+
+/* Add HISTOGRAM to the TARGET histogram.
+ */
+static void
+merge_histogram(svn_fs_x__histogram_t *target,
+                const svn_fs_x__histogram_t *histogram)
+{
+  apr_size_t i;
+
+  target->total.count += histogram->total.count;
+  target->total.sum += histogram->total.sum;
+
+  for (i = 0; i < sizeof(target->lines) / sizeof(target->lines[0]); ++i)
+    {
+      target->lines[i].count += histogram->lines[i].count;
+      target->lines[i].sum += histogram->lines[i].sum;
+    }
+}
+
+/* Add an item of SIZE bytes to STATS.
+ */
+static void
+add_item(svn_fs_x__item_stats_t *stats,
+         apr_off_t size)
+{
+  stats->count++;
+  stats->size += size;
+}
+
+/* Add the item STATS to the TARGET stats.
+ */
+static void
+merge_item_stats(svn_fs_x__item_stats_t *target,
+                 const svn_fs_x__item_stats_t *stats)
+{
+  target->count += stats->count;
+  target->size += stats->size;
+}
+
+/* Add the representation STATS to the TARGET stats.
+ */
+static void
+merge_rep_stats(svn_fs_x__rep_stats_t *target,
+                const svn_fs_x__rep_stats_t *stats)
+{
+  merge_item_stats(&target->total, &stats->total);
+  target->expanded_size += stats->expanded_size;
+  target->chain_len += stats->chain_len;
+}
+
+/* Add all of STATS to the TARGET stats.
+ */
+static void
+merge_stats(svn_fs_x__stats_t *target,
+            const svn_fs_x__stats_t *stats)
+{
+  apr_size_t i;
+
+  target->total_size += stats->total_size;
+  target->change_count += stats->change_count;
+  target->dir_node_count += stats->dir_node_count;
+  target->file_node_count += stats->file_node_count;
+
+  merge_item_stats(&target->noderevs, &stats->noderevs);
+  merge_item_stats(&target->changes, &stats->changes);
+
+  merge_rep_stats(&target->file_rep_stats, &stats->file_rep_stats);
+  merge_rep_stats(&target->dir_rep_stats, &stats->dir_rep_stats);
+  merge_rep_stats(&target->file_prop_rep_stats, &stats->file_prop_rep_stats);
+  merge_rep_stats(&target->dir_prop_rep_stats, &stats->dir_prop_rep_stats);
+
+  for (i = 0; i < SVN_FS_X__STATS_MAX_CHAIN_LEN; ++i)
+    target->chain_lengths[i] += stats->chain_lengths[i];
+  target->max_chain_len = MAX(target->max_chain_len, stats->max_chain_len);
+
+  target->rep_references += stats->rep_references;
+  target->container_rep_references += stats->container_rep_references;
+  target->referenced_chain_len += stats->referenced_chain_len;
+
+  merge_item_stats(&target->reps_containers.total,
+                   &stats->reps_containers.total);
+  target->reps_containers.rep_count += stats->reps_containers.rep_count;
+  target->reps_containers.expanded_size
+    += stats->reps_containers.expanded_size;
+  target->reps_containers.text_size += stats->reps_containers.text_size;
+  target->reps_containers.base_count += stats->reps_containers.base_count;
+  target->reps_containers.instruction_count
+    += stats->reps_containers.instruction_count;
+  target->reps_containers.copy_count += stats->reps_containers.copy_count;
+  target->reps_containers.max_nesting
+    = MAX(target->reps_containers.max_nesting,
+          stats->reps_containers.max_nesting);
+  merge_histogram(&target->reps_containers.size_histogram,
+                  &stats->reps_containers.size_histogram);
+
+  merge_item_stats(&target->noderevs_containers.total,
+                   &stats->noderevs_containers.total);
+  target->noderevs_containers.noderev_count
+    += stats->noderevs_containers.noderev_count;
+  target->noderevs_containers.id_count
+    += stats->noderevs_containers.id_count;
+  target->noderevs_containers.rep_count
+    += stats->noderevs_containers.rep_count;
+  merge_histogram(&target->noderevs_containers.size_histogram,
+                  &stats->noderevs_containers.size_histogram);
+
+  merge_item_stats(&target->changes_containers.total,
+                   &stats->changes_containers.total);
+  target->changes_containers.list_count
+    += stats->changes_containers.list_count;
+  target->changes_containers.change_count
+    += stats->changes_containers.change_count;
+
+  merge_histogram(&target->rep_size_histogram, &stats->rep_size_histogram);
+  merge_histogram(&target->file_histogram, &stats->file_histogram);
+  merge_histogram(&target->dir_histogram, &stats->dir_histogram);
+}
+
+/* Return the stats in STATS for stand-alone representations of P2L item
+ * TYPE.
+ */
+static svn_fs_x__rep_stats_t *
+get_rep_stats(svn_fs_x__stats_t *stats,
+              apr_uint32_t type)
+{
+  switch (type)
+    {
+      case SVN_FS_X__ITEM_TYPE_DIR_REP:
+        return &stats->dir_rep_stats;
+      case SVN_FS_X__ITEM_TYPE_FILE_PROPS:
+        return &stats->file_prop_rep_stats;
+      case SVN_FS_X__ITEM_TYPE_DIR_PROPS:
+        return &stats->dir_prop_rep_stats;
+      default:
+        return &stats->file_rep_stats;
+    }
+}
+
+
+/*** Reading a single rev / pack file. ***/
+
+/* Read the item described by ENTRY from REV_FILE and return it as *STREAM.
+ * Allocate the result in RESULT_POOL.
+ */
+static svn_error_t *
+read_item(svn_stream_t **stream,
+          svn_fs_x__revision_file_t *rev_file,
+          const svn_fs_x__p2l_entry_t *entry,
+          apr_pool_t *result_pool)
+{
+  svn_stringbuf_t *text
+    = svn_stringbuf_create_ensure((apr_size_t)entry->size, result_pool);
+
+  text->len = (apr_size_t)entry->size;
+  text->data[text->len] = 0;
+
+  SVN_ERR(svn_fs_x__rev_file_seek(rev_file, NULL, entry->offset));
+  SVN_ERR(svn_fs_x__rev_file_read(rev_file, text->data, text->len));
+  *stream = svn_stream_from_stringbuf(text, result_pool);
+
+  return SVN_NO_ERROR;
+}
+
+/* Record the reference to REP in FSTATS, if REP is not NULL.
+ */
+static void
+add_rep_ref(file_stats_t *fstats,
+            const svn_fs_x__representation_t *rep)
+{
+  rep_ref_t *ref;
+  if (rep == NULL)
+    return;
+
+  ref = apr_array_push(fstats->refs);
+  ref->id = rep->id;
+  ref->expanded_size = rep->expanded_size ? rep->expanded_size : rep->size;
+}
+
+/* Add NODEREV to FSTATS.
+ */
+static void
+add_noderev(file_stats_t *fstats,
+            const svn_fs_x__noderev_t *noderev)
+{
+  svn_fs_x__stats_t *stats = fstats->stats;
+  svn_filesize_t size = 0;
+
+  if (noderev->data_rep)
+    size = noderev->data_rep->expanded_size
+         ? noderev->data_rep->expanded_size
+         : noderev->data_rep->size;
+
+  if (noderev->kind == svn_node_dir)
+    {
+      stats->dir_node_count++;
+      add_to_histogram(&stats->dir_histogram, size);
+    }
+  else
+    {
+      stats->file_node_count++;
+      add_to_histogram(&stats->file_histogram, size);
+    }
+
+  add_rep_ref(fstats, noderev->data_rep);
+  add_rep_ref(fstats, noderev->prop_rep);
+}
+
+/* Implements svn_fs_x__change_receiver_t, counting the changes in the
+ * apr_uint64_t given as BATON.
+ */
+static svn_error_t *
+count_change(void *baton,
+             svn_fs_x__change_t *change,
+             apr_pool_t *scratch_pool)
+{
+  apr_uint64_t *count = baton;
+  ++*count;
+
+  return SVN_NO_ERROR;
+}
+
+/* Read the item described by ENTRY from REV_FILE and add its information
+ * to FSTATS.  Allocate new entries in FSTATS in RESULT_POOL and use
+ * SCRATCH_POOL for temporary allocations.
+ */
+static svn_error_t *
+read_entry(file_stats_t *fstats,
+           svn_fs_x__revision_file_t *rev_file,
+           const svn_fs_x__p2l_entry_t *entry,
+           apr_pool_t *result_pool,
+           apr_pool_t *scratch_pool)
+{
+  svn_fs_x__stats_t *stats = fstats->stats;
+  svn_stream_t *stream;
+  apr_uint32_t i;
+
+  switch (entry->type)
+    {
+      case SVN_FS_X__ITEM_TYPE_FILE_REP:
+      case SVN_FS_X__ITEM_TYPE_DIR_REP:
+      case SVN_FS_X__ITEM_TYPE_FILE_PROPS:
+      case SVN_FS_X__ITEM_TYPE_DIR_PROPS:
+        {
+          svn_fs_x__rep_header_t *header;
+          rep_info_t *rep = apr_array_push(fstats->reps);
+
+          /* Only the header is of interest here. */
+          SVN_ERR(svn_fs_x__rev_file_seek(rev_file, NULL, entry->offset));
+          SVN_ERR(svn_fs_x__rev_file_stream(&stream, rev_file));
+          SVN_ERR(svn_fs_x__read_rep_header(&header, stream, scratch_pool,
+                                            scratch_pool));
+
+          rep->id = entry->items[0];
+          rep->type = entry->type;
+          rep->chain_len = -1;
+          if (header->type == svn_fs_x__rep_delta)
+            {
+              rep->has_base = TRUE;
+              rep->base.change_set
+                = svn_fs_x__change_set_by_rev(header->base_revision);
+              rep->base.number = (apr_uint64_t)header->base_item_index;
+            }
+
+          add_item(&get_rep_stats(stats, entry->type)->total, entry->size);
+          add_to_histogram(&stats->rep_size_histogram, entry->size);
+        }
+        break;
+
+      case SVN_FS_X__ITEM_TYPE_NODEREV:
+        {
+          svn_fs_x__noderev_t *noderev;
+
+          SVN_ERR(read_item(&stream, rev_file, entry, scratch_pool));
+          SVN_ERR(svn_fs_x__read_noderev(&noderev, stream, scratch_pool,
+                                         scratch_pool));
+
+          add_item(&stats->noderevs, entry->size);
+          add_noderev(fstats, noderev);
+        }
+        break;
+
+      case SVN_FS_X__ITEM_TYPE_CHANGES:
+        {
+          apr_uint64_t count = 0;
+
+          SVN_ERR(read_item(&stream, rev_file, entry, scratch_pool));
+          SVN_ERR(svn_fs_x__read_changes_incrementally(stream, count_change,
+                                                       &count,
+                                                       scratch_pool));
+
+          add_item(&stats->changes, entry->size);
+          stats->change_count += count;
+        }
+        break;
+
+      case SVN_FS_X__ITEM_TYPE_NODEREVS_CONT:
+        {
+          svn_fs_x__noderevs_t *container;
+          apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+
+          SVN_ERR(read_item(&stream, rev_file, entry, scratch_pool));
+          SVN_ERR(svn_fs_x__read_noderevs_container(&container, stream,
+                                                    scratch_pool,
+                                                    scratch_pool));
+
+          add_item(&stats->noderevs_containers.total, entry->size);
+          add_to_histogram(&stats->noderevs_containers.size_histogram,
+                           entry->size);
+          svn_fs_x__noderevs_add_stats(&stats->noderevs_containers,
+                                       container);
+
+          for (i = 0; i < entry->item_count; ++i)
+            {
+              svn_fs_x__noderev_t *noderev;
+
+              svn_pool_clear(iterpool);
+              SVN_ERR(svn_fs_x__noderevs_get(&noderev, container, i,
+                                             iterpool));
+              add_noderev(fstats, noderev);
+            }
+
+          svn_pool_destroy(iterpool);
+        }
+        break;
+
+      case SVN_FS_X__ITEM_TYPE_CHANGES_CONT:
+        {
+          svn_fs_x__changes_t *container;
+          apr_uint64_t count = stats->changes_containers.change_count;
+
+          SVN_ERR(read_item(&stream, rev_file, entry, scratch_pool));
+          SVN_ERR(svn_fs_x__read_changes_container(&container, stream,
+                                                   scratch_pool,
+                                                   scratch_pool));
+
+          add_item(&stats->changes_containers.total, entry->size);
+          svn_fs_x__changes_add_stats(&stats->changes_containers, container);
+          stats->change_count += stats->changes_containers.change_count
+                               - count;
+        }
+        break;
+
+      case SVN_FS_X__ITEM_TYPE_REPS_CONT:
+        {
+          svn_fs_x__reps_t *container;
+
+          SVN_ERR(read_item(&stream, rev_file, entry, scratch_pool));
+          SVN_ERR(svn_fs_x__read_reps_container(&container, stream,
+                                                scratch_pool, scratch_pool));
+
+          add_item(&stats->reps_containers.total, entry->size);
+          add_to_histogram(&stats->reps_containers.size_histogram,
+                           entry->size);
+          svn_fs_x__reps_add_stats(&stats->reps_containers, container);
+
+          /* Container contents never need any delta application. */
+          for (i = 0; i < entry->item_count; ++i)
+            {
+              rep_info_t *rep = apr_array_push(fstats->reps);
+              rep->id = entry->items[i];
+              rep->in_container = TRUE;
+            }
+        }
+        break;
+
+      default:
+        break;
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Read all items in the rev / pack file containing REVISION in FS and add
+ * them to FSTATS.  Allocate new entries in FSTATS in RESULT_POOL and use
+ * SCRATCH_POOL for temporary allocations.
+ */
+static svn_error_t *
+read_rev_or_pack_file(file_stats_t *fstats,
+                      svn_fs_t *fs,
+                      svn_revnum_t revision,
+                      svn_cancel_func_t cancel_func,
+                      void *cancel_baton,
+                      apr_pool_t *result_pool,
+                      apr_pool_t *scratch_pool)
+{
+  svn_fs_x__data_t *ffd = fs->fsap_data;
+  apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+  apr_pool_t *iterpool2 = svn_pool_create(scratch_pool);
+  svn_fs_x__revision_file_t *rev_file;
+  apr_off_t max_offset;
+  apr_off_t offset;
+
+  SVN_ERR(svn_fs_x__rev_file_init(&rev_file, fs, revision, scratch_pool));
+  SVN_ERR(svn_fs_x__p2l_get_max_offset(&max_offset, fs, rev_file, revision,
+                                       scratch_pool));
+  fstats->stats->total_size += max_offset;
+
+  /* Process the entries in offset order, one P2L page at a time. */
+  for (offset = 0; offset < max_offset; )
+    {
+      apr_array_header_t *entries;
+      apr_off_t block_start = offset;
+      int i;
+
+      svn_pool_clear(iterpool);
+      SVN_ERR(svn_fs_x__p2l_index_lookup(&entries, fs, rev_file, revision,
+                                         offset, ffd->p2l_page_size,
+                                         iterpool, iterpool));
+
+      for (i = 0; i < entries->nelts; ++i)
+        {
+          const svn_fs_x__p2l_entry_t *entry
+            = &APR_ARRAY_IDX(entries, i, svn_fs_x__p2l_entry_t);
+
+          /* Skip what we already processed with the previous block. */
+          if (entry->offset < offset)
+            continue;
+
+          svn_pool_clear(iterpool2);
+          SVN_ERR(read_entry(fstats, rev_file, entry, result_pool,
+                             iterpool2));
+          offset = entry->offset + entry->size;
+
+          if (cancel_func)
+            SVN_ERR(cancel_func(cancel_baton));
+        }
+
+      if (offset == block_start)
+        return svn_error_createf(SVN_ERR_FS_INDEX_CORRUPTION, NULL,
+                                 _("p2l does not cover offset %s"
+                                   " for revision %ld"),
+                                 apr_off_t_toa(scratch_pool, offset),
+                                 revision);
+    }
+
+  svn_pool_destroy(iterpool2);
+  svn_pool_destroy(iterpool);
+
+  return svn_error_trace(svn_fs_x__close_revision_file(rev_file));
+}
+
+
+/*** Parallel execution. ***/
+
+/* Baton type for the tasks gathering the stats of the whole repository.
+ */
+typedef struct stats_baton_t
+{
+  /* The repository to analyze. */
+  svn_fs_t *fs;
+
+  /* Receives the merged results. */
+  svn_fs_x__stats_t *stats;
+
+  /* All representations found so far, mapping svn_fs_x__id_t to
+   * rep_info_t *. */
+  apr_hash_t *reps;
+
+  /* Repository layout. */
+  svn_revnum_t head;
+  svn_revnum_t min_unpacked_rev;
+  int shard_size;
+
+  /* Progress notification. */
+  svn_fs_progress_notify_func_t progress_func;
+  void *progress_baton;
+
+  /* Pool to allocate REPS and its contents in. */
+  apr_pool_t *pool;
+} stats_baton_t;
+
+/* Parameters for gathering the stats of a single rev / pack file.
+ */
+typedef struct file_baton_t
+{
+  /* The repository-wide context. */
+  stats_baton_t *stats_baton;
+
+  /* First revision to read. */
+  svn_revnum_t first_rev;
+
+  /* Number of revisions to read. */
+  int count;
+
+  /* Whether this is a pack file. */
+  svn_boolean_t packed;
+} file_baton_t;
+
+/* Implements svn_task__thread_context_constructor_t.
+ *
+ * The svn_fs_t is not thread-safe, so give each worker its own instance
+ * of the svn_fs_t passed in as CONTEXT_BATON.
+ */
+static svn_error_t *
+open_thread_fs(void **thread_context,
+               void *context_baton,
+               apr_pool_t *result_pool,
+               apr_pool_t *scratch_pool)
+{
+  svn_fs_t *fs = context_baton;
+  svn_fs_x__data_t *ffd = fs->fsap_data;
+  svn_fs_t *thread_fs;
+
+  SVN_ERR_ASSERT(ffd->svn_fs_open_);
+  SVN_ERR(ffd->svn_fs_open_(&thread_fs, fs->path, fs->config, result_pool,
+                            scratch_pool));
+
+  *thread_context = thread_fs;
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_task__process_func_t.
+ *
+ * Gather the stats for the file_baton_t given as PROCESS_BATON and return
+ * them as a file_stats_t in *RESULT.
+ */
+static svn_error_t *
+gather_file_stats(void **result,
+                  svn_task__t *task,
+                  void *thread_context,
+                  void *process_baton,
+                  svn_cancel_func_t cancel_func,
+                  void *cancel_baton,
+                  apr_pool_t *result_pool,
+                  apr_pool_t *scratch_pool)
+{
+  file_baton_t *baton = process_baton;
+  svn_fs_t *fs = thread_context ? thread_context : baton->stats_baton->fs;
+  file_stats_t *fstats = apr_pcalloc(result_pool, sizeof(*fstats));
+
+  fstats->first_rev = baton->first_rev;
+  fstats->count = baton->count;
+  fstats->reps = apr_array_make(result_pool, 64, sizeof(rep_info_t));
+  fstats->refs = apr_array_make(result_pool, 64, sizeof(rep_ref_t));
+  fstats->stats = apr_pcalloc(result_pool, sizeof(*fstats->stats));
+
+  if (baton->packed)
+    {
+      SVN_ERR(read_rev_or_pack_file(fstats, fs, baton->first_rev,
+                                    cancel_func, cancel_baton,
+                                    result_pool, scratch_pool));
+    }
+  else
+    {
+      apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+      svn_revnum_t revision;
+
+      for (revision = baton->first_rev;
+           revision < baton->first_rev + baton->count;
+           ++revision)
+        {
+          svn_pool_clear(iterpool);
+          SVN_ERR(read_rev_or_pack_file(fstats, fs, revision,
+                                        cancel_func, cancel_baton,
+                                        result_pool, iterpool));
+        }
+
+      svn_pool_destroy(iterpool);
+    }
+
+  *result = fstats;
+  return SVN_NO_ERROR;
+}
+
+/* Return the delta chain length of REP.  Look up delta bases in REPS.
+ * Use SCRATCH_POOL for temporary allocations.
+ */
+static int
+get_chain_len(rep_info_t *rep,
+              apr_hash_t *reps,
+              apr_pool_t *scratch_pool)
+{
+  apr_array_header_t *stack = apr_array_make(scratch_pool, 16,
+                                             sizeof(rep_info_t *));
+  int chain_len;
+
+  /* Walk down the chain until we find a known length.  Mark the reps that
+   * we visit such that corrupted, cyclic chains will terminate. */
+  while (rep && rep->chain_len == -1)
+    {
+      APR_ARRAY_PUSH(stack, rep_info_t *) = rep;
+      rep->chain_len = -2;
+
+      rep = rep->has_base
+          ? apr_hash_get(reps, &rep->base, sizeof(rep->base))
+          : NULL;
+    }
+
+  chain_len = (rep && rep->chain_len >= 0) ? rep->chain_len : 0;
+
+  /* Each delta on the stack adds one link to the chain. */
+  while (stack->nelts)
+    {
+      rep = *(rep_info_t **)apr_array_pop(stack);
+      rep->chain_len = ++chain_len;
+    }
+
+  return chain_len;
+}
+
+/* Implements svn_task__output_func_t.
+ *
+ * Merge the file_stats_t given as RESULT into the stats_baton_t given as
+ * OUTPUT_BATON.  This runs in the main thread and in revision order.
+ */
+static svn_error_t *
+merge_file_stats(svn_task__t *task,
+                 void *result,
+                 void *output_baton,
+                 svn_cancel_func_t cancel_func,
+                 void *cancel_baton,
+                 apr_pool_t *result_pool,
+                 apr_pool_t *scratch_pool)
+{
+  file_stats_t *fstats = result;
+  stats_baton_t *baton = output_baton;
+  svn_fs_x__stats_t *stats = fstats->stats;
+  apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+  rep_info_t *reps;
+  int i;
+
+  /* Delta bases may follow their deltas within the same pack file.
+   * So, make all reps known before resolving any chains. */
+  reps = apr_pmemdup(baton->pool, fstats->reps->elts,
+                     MAX(fstats->reps->nelts, 1) * sizeof(*reps));
+  for (i = 0; i < fstats->reps->nelts; ++i)
+    apr_hash_set(baton->reps, &reps[i].id, sizeof(reps[i].id), &reps[i]);
+
+  for (i = 0; i < fstats->reps->nelts; ++i)
+    {
+      rep_info_t *rep = &reps[i];
+      int chain_len;
+
+      if (rep->in_container)
+        continue;
+
+      svn_pool_clear(iterpool);
+      chain_len = get_chain_len(rep, baton->reps, iterpool);
+
+      get_rep_stats(stats, rep->type)->chain_len += chain_len;
+      stats->chain_lengths[MIN(chain_len,
+                               SVN_FS_X__STATS_MAX_CHAIN_LEN - 1)]++;
+      stats->max_chain_len = MAX(stats->max_chain_len,
+                                 (apr_uint64_t)chain_len);
+    }
+
+  /* References may point to any older file. */
+  for (i = 0; i < fstats->refs->nelts; ++i)
+    {
+      rep_ref_t *ref = &APR_ARRAY_IDX(fstats->refs, i, rep_ref_t);
+      rep_info_t *rep = apr_hash_get(baton->reps, &ref->id, sizeof(ref->id));
+      if (rep == NULL)
+        continue;
+
+      stats->rep_references++;
+      if (rep->in_container)
+        {
+          stats->container_rep_references++;
+        }
+      else
+        {
+          stats->referenced_chain_len += MAX(rep->chain_len, 0);
+          if (!rep->referenced)
+            get_rep_stats(stats, rep->type)->expanded_size
+              += ref->expanded_size;
+        }
+
+      rep->referenced = TRUE;
+    }
+
+  merge_stats(baton->stats, stats);
+  svn_pool_destroy(iterpool);
+
+  /* one more pack file processed or show progress every 1000 revs or so */
+  if (baton->progress_func)
+    {
+      svn_revnum_t revision;
+
+      if (fstats->first_rev < baton->min_unpacked_rev)
+        baton->progress_func(fstats->first_rev, baton->progress_baton,
+                             scratch_pool);
+      else
+        for (revision = fstats->first_rev;
+             revision < fstats->first_rev + fstats->count;
+             ++revision)
+          if (revision % (baton->shard_size ? baton->shard_size : 1000) == 0)
+            baton->progress_func(revision, baton->progress_baton,
+                                 scratch_pool);
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Add a sub-task to TASK that gathers the stats of COUNT revisions
+ * starting at FIRST_REV.  PACKED indicates whether they are in a pack
+ * file.  BATON is the repository-wide context.
+ */
+static svn_error_t *
+add_file_task(svn_task__t *task,
+              stats_baton_t *baton,
+              svn_revnum_t first_rev,
+              int count,
+              svn_boolean_t packed)
+{
+  apr_pool_t *process_pool = svn_task__create_process_pool(task);
+  file_baton_t *file_baton = apr_pcalloc(process_pool, sizeof(*file_baton));
+
+  file_baton->stats_baton = baton;
+  file_baton->first_rev = first_rev;
+  file_baton->count = count;
+  file_baton->packed = packed;
+
+  return svn_error_trace(svn_task__add(task, process_pool, NULL,
+                                       gather_file_stats, file_baton,
+                                       merge_file_stats, baton));
+}
+
+/* Implements svn_task__process_func_t.
+ *
+ * Add a sub-task for each pack file and for each shard's worth of
+ * non-packed revisions in the repository given by the stats_baton_t
+ * in PROCESS_BATON.
+ */
+static svn_error_t *
+add_file_tasks(void **result,
+               svn_task__t *task,
+               void *thread_context,
+               void *process_baton,
+               svn_cancel_func_t cancel_func,
+               void *cancel_baton,
+               apr_pool_t *result_pool,
+               apr_pool_t *scratch_pool)
+{
+  stats_baton_t *baton = process_baton;
+  int batch_size = baton->shard_size ? baton->shard_size : 1000;
+  svn_revnum_t revision;
+
+  /* packed revs */
+  for ( revision = 0
+      ; revision < baton->min_unpacked_rev
+      ; revision += baton->shard_size)
+    SVN_ERR(add_file_task(task, baton, revision, baton->shard_size, TRUE));
+
+  /* non-packed revs */
+  for ( ; revision <= baton->head; revision += batch_size)
+    SVN_ERR(add_file_task(task, baton, revision,
+                          (int)MIN(batch_size, baton->head - revision + 1),
+                          FALSE));
+
+  *result = NULL;
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_fs_x__get_stats(svn_fs_x__stats_t **stats,
+                    svn_fs_t *fs,
+                    int thread_count,
+                    svn_fs_progress_notify_func_t progress_func,
+                    void *progress_baton,
+                    svn_cancel_func_t cancel_func,
+                    void *cancel_baton,
+                    apr_pool_t *result_pool,
+                    apr_pool_t *scratch_pool)
+{
+  svn_fs_x__data_t *ffd = fs->fsap_data;
+  stats_baton_t baton = { 0 };
+
+  baton.fs = fs;
+  baton.stats = apr_pcalloc(result_pool, sizeof(*baton.stats));
+  baton.reps = apr_hash_make(scratch_pool);
+  baton.shard_size = ffd->max_files_per_dir;
+  baton.progress_func = progress_func;
+  baton.progress_baton = progress_baton;
+  baton.pool = scratch_pool;
+
+  SVN_ERR(svn_fs_x__youngest_rev(&baton.head, fs, scratch_pool));
+  SVN_ERR(svn_fs_x__update_min_unpacked_rev(fs, scratch_pool));
+  baton.min_unpacked_rev = ffd->min_unpacked_rev;
+
+  /* Read all rev / pack files in parallel and merge the results in
+   * revision order. */
+  SVN_ERR(svn_task__run(MAX(thread_count, 1), add_file_tasks, &baton,
+                        NULL, NULL,
+                        thread_count > 1 ? open_thread_fs : NULL, fs,
+                        cancel_func, cancel_baton,
+                        scratch_pool, scratch_pool));
+
+  baton.stats->revision_count = baton.head + 1;
+  *stats = baton.stats;
+
+  return SVN_NO_ERROR;
+}
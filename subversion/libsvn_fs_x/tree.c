@@ -2946,23 +2946,33 @@ crawl_directory_dag_for_mergeinfo(svn_fs_root_t *root,
                                   apr_pool_t *scratch_pool)
 {
   apr_array_header_t *entries;
+  apr_array_header_t *ids;
+  apr_array_header_t *kids;
   int i;
   apr_pool_t *iterpool = svn_pool_create(scratch_pool);
 
   SVN_ERR(svn_fs_x__dag_dir_entries(&entries, dir_dag, scratch_pool,
                                     iterpool));
+
+  /* Fetch the node-revisions of all entries in one batch. */
+  ids = apr_array_make(scratch_pool, entries->nelts,
+                       sizeof(svn_fs_x__id_t *));
+  for (i = 0; i < entries->nelts; ++i)
+    APR_ARRAY_PUSH(ids, const svn_fs_x__id_t *)
+      = &APR_ARRAY_IDX(entries, i, svn_fs_x__dirent_t *)->id;
+  SVN_ERR(svn_fs_x__dag_get_nodes(&kids, root->fs, ids, scratch_pool,
+                                  iterpool));
+
   for (i = 0; i < entries->nelts; ++i)
     {
       svn_fs_x__dirent_t *dirent
         = APR_ARRAY_IDX(entries, i, svn_fs_x__dirent_t *);
       const char *kid_path;
-      dag_node_t *kid_dag;
+      dag_node_t *kid_dag = APR_ARRAY_IDX(kids, i, dag_node_t *);
 
       svn_pool_clear(iterpool);
 
       kid_path = svn_fspath__join(this_path, dirent->name, iterpool);
-      SVN_ERR(svn_fs_x__get_temp_dag_node(&kid_dag, root, kid_path,
-                                          iterpool));
 
       if (svn_fs_x__dag_has_mergeinfo(kid_dag))
         {
@@ -3253,6 +3263,8 @@ static root_vtable_t root_vtable = {
   x_apply_text,
   x_contents_changed,
   x_get_file_delta_stream,
+  NULL,
+  NULL,
   x_merge,
   x_get_mergeinfo,
 };
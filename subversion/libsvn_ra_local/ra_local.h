@@ -67,6 +67,9 @@ typedef struct svn_ra_local__session_baton_t
   svn_auth_baton_t *auth_baton;
 
   const char *useragent;
+
+  /* Number of threads to use for recursive lists. */
+  int list_thread_count;
 } svn_ra_local__session_baton_t;
 
 
@@ -168,6 +168,28 @@ cache_init(void *baton, apr_pool_t *pool)
   return SVN_NO_ERROR;
 }
 
+/* Set *THREAD_COUNT to the number of threads to use for recursive lists
+   as configured in CONFIG_HASH.  Default to 1. */
+static svn_error_t *
+get_list_thread_count(int *thread_count,
+                      apr_hash_t *config_hash)
+{
+  svn_config_t *config = NULL;
+  apr_int64_t value;
+
+  if (config_hash)
+    config = svn_hash_gets(config_hash, SVN_CONFIG_CATEGORY_CONFIG);
+  SVN_ERR(svn_config_get_int64(config, &value, SVN_CONFIG_SECTION_MISCELLANY,
+                               SVN_CONFIG_OPTION_LIST_THREADS, 1));
+  if (value < 1 || value > APR_INT32_MAX)
+    return svn_error_createf(SVN_ERR_BAD_CONFIG_VALUE, NULL,
+                             _("Invalid value for '%s'"),
+                             SVN_CONFIG_OPTION_LIST_THREADS);
+  *thread_count = (int)value;
+
+  return SVN_NO_ERROR;
+}
+
 /*----------------------------------------------------------------*/
 
 /*** The reporter vtable needed by do_update() and friends ***/
@@ -586,6 +608,7 @@ svn_ra_local__open(svn_ra_session_t *session,
   sess->callbacks = callbacks;
   sess->callback_baton = callback_baton;
   sess->auth_baton = auth_baton;
+  SVN_ERR(get_list_thread_count(&sess->list_thread_count, config));
 
   /* Look through the URL, figure out which part points to the
      repository, and which part is the path *within* the
@@ -668,6 +691,7 @@ svn_ra_local__dup_session(svn_ra_session_t *new_session,
                             : NULL;
 
   new_sess->useragent = apr_pstrdup(result_pool, old_sess->useragent);
+  new_sess->list_thread_count = old_sess->list_thread_count;
   new_session->priv = new_sess;
 
   return SVN_NO_ERROR;
@@ -1674,6 +1698,7 @@ svn_ra_local__has_capability(svn_ra_session_t *session,
       || strcmp(capability, SVN_RA_CAPABILITY_EPHEMERAL_TXNPROPS) == 0
       || strcmp(capability, SVN_RA_CAPABILITY_GET_FILE_REVS_REVERSE) == 0
       || strcmp(capability, SVN_RA_CAPABILITY_LIST) == 0
+      || strcmp(capability, SVN_RA_CAPABILITY_BLAME) == 0
       )
     {
       *has = TRUE;
@@ -1847,7 +1872,6 @@ svn_ra_local__list(svn_ra_session_t *session,
 {
   svn_ra_local__session_baton_t *sess = session->priv;
   svn_fs_root_t *root;
-  svn_boolean_t path_info_only = (dirent_fields & ~SVN_DIRENT_KIND) == 0;
 
   dirent_receiver_baton_t baton;
   baton.receiver = receiver;
@@ -1855,13 +1879,14 @@ svn_ra_local__list(svn_ra_session_t *session,
 
   SVN_ERR(svn_fs_revision_root(&root, sess->fs, revision, pool));
   path = svn_dirent_join(sess->fs_path->data, path, pool);
-  return svn_error_trace(svn_repos_list(root, path, patterns, depth,
-                                        path_info_only, NULL, NULL,
-                                        dirent_receiver, &baton,
-                                        sess->callbacks
-                                          ? sess->callbacks->cancel_func
-                                          : NULL,
-                                        sess->callback_baton, pool));
+  return svn_error_trace(svn_repos_list2(root, path, patterns, depth,
+                                         dirent_fields,
+                                         sess->list_thread_count, NULL, NULL,
+                                         dirent_receiver, &baton,
+                                         sess->callbacks
+                                           ? sess->callbacks->cancel_func
+                                           : NULL,
+                                         sess->callback_baton, pool));
 }
 
 static svn_error_t *
@@ -1896,6 +1921,30 @@ svn_ra_local__fetch_file_contents(svn_ra_session_t *session,
   return SVN_NO_ERROR;
 }
 
+static svn_error_t *
+svn_ra_local__blame(svn_ra_session_t *session,
+                    const char *path,
+                    svn_revnum_t start,
+                    svn_revnum_t end,
+                    const svn_diff_file_options_t *diff_options,
+                    svn_ra_blame_receiver_t receiver,
+                    void *receiver_baton,
+                    apr_pool_t *scratch_pool)
+{
+  svn_ra_local__session_baton_t *sess = session->priv;
+  const char *abs_path = svn_fspath__join(sess->fs_path->data, path,
+                                          scratch_pool);
+
+  return svn_error_trace(svn_repos_blame(sess->repos, abs_path, start, end,
+                                         diff_options, 0, NULL, NULL,
+                                         receiver, receiver_baton,
+                                         sess->callbacks
+                                           ? sess->callbacks->cancel_func
+                                           : NULL,
+                                         sess->callback_baton,
+                                         scratch_pool));
+}
+
 /*----------------------------------------------------------------*/
 
 static const svn_version_t *
@@ -1948,6 +1997,7 @@ static const svn_ra__vtable_t ra_local_vtable =
   NULL /* set_svn_ra_open */,
   svn_ra_local__list ,
   svn_ra_local__fetch_file_contents,
+  svn_ra_local__blame,
   svn_ra_local__register_editor_shim_callbacks,
   svn_ra_local__get_commit_ev2,
   NULL /* replay_range_ev2 */
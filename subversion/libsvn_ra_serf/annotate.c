@@ -0,0 +1,281 @@
+/*
+ * annotate.c :  entry point for server-side blame RA functions for ra_serf
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+#include <serf.h>
+
+#include "svn_hash.h"
+#include "svn_ra.h"
+#include "svn_xml.h"
+#include "svn_base64.h"
+
+#include "svn_private_config.h"
+
+#include "ra_serf.h"
+#include "../libsvn_ra/ra_loader.h"
+
+
+
+/*
+ * This enum represents the current state of our XML parsing for a REPORT.
+ */
+enum annotate_state_e {
+  INITIAL = XML_STATE_INITIAL,
+  REPORT,
+  REVISION,
+  REV_PROP,
+  LINE
+};
+
+typedef struct annotate_context_t {
+  apr_pool_t *pool;
+
+  /* parameters set by our caller */
+  const char *path;
+  svn_revnum_t start;
+  svn_revnum_t end;
+  const svn_diff_file_options_t *diff_options;
+
+  /* Map svn_revnum_t -> apr_hash_t * of revprops, for all REVISION
+     elements received so far.  REV_PROPS are the revprops of the
+     REVISION element currently being parsed. */
+  apr_hash_t *revs;
+  apr_hash_t *rev_props;
+
+  /* Number of the next line to report. */
+  apr_int64_t line_no;
+
+  /* blame receiver function and baton */
+  svn_ra_blame_receiver_t receiver;
+  void *receiver_baton;
+} annotate_context_t;
+
+#define D_ "DAV:"
+#define S_ SVN_XML_NAMESPACE
+static const svn_ra_serf__xml_transition_t annotate_ttable[] = {
+  { INITIAL, S_, "blame-report", REPORT,
+    FALSE, { NULL }, FALSE },
+
+  { REPORT, S_, "revision", REVISION,
+    FALSE, { "rev", NULL }, TRUE },
+
+  { REVISION, S_, "rev-prop", REV_PROP,
+    TRUE, { "name", "?encoding", NULL }, TRUE },
+
+  { REPORT, S_, "line", LINE,
+    TRUE, { "?rev", "?encoding", NULL }, TRUE },
+
+  { 0 }
+};
+
+/* Return the string in CDATA, decoded as specified by the "encoding"
+   value in ATTRS.  Allocate the result in RESULT_POOL. */
+static svn_error_t *
+decode_cdata(const svn_string_t **value,
+             const svn_string_t *cdata,
+             apr_hash_t *attrs,
+             apr_pool_t *result_pool)
+{
+  const char *encoding = svn_hash_gets(attrs, "encoding");
+
+  if (!encoding)
+    *value = svn_string_dup(cdata, result_pool);
+  else if (strcmp(encoding, "base64") == 0)
+    *value = svn_base64_decode_string(cdata, result_pool);
+  else
+    return svn_error_createf(SVN_ERR_RA_DAV_MALFORMED_DATA, NULL,
+                             _("Unsupported encoding '%s'"), encoding);
+
+  return SVN_NO_ERROR;
+}
+
+/* Conforms to svn_ra_serf__xml_opened_t  */
+static svn_error_t *
+annotate_opened(svn_ra_serf__xml_estate_t *xes,
+                void *baton,
+                int entered_state,
+                const svn_ra_serf__dav_props_t *tag,
+                apr_pool_t *scratch_pool)
+{
+  annotate_context_t *annotate_ctx = baton;
+
+  if (entered_state == REVISION)
+    annotate_ctx->rev_props = apr_hash_make(annotate_ctx->pool);
+
+  return SVN_NO_ERROR;
+}
+
+/* Conforms to svn_ra_serf__xml_closed_t  */
+static svn_error_t *
+annotate_closed(svn_ra_serf__xml_estate_t *xes,
+                void *baton,
+                int leaving_state,
+                const svn_string_t *cdata,
+                apr_hash_t *attrs,
+                apr_pool_t *scratch_pool)
+{
+  annotate_context_t *annotate_ctx = baton;
+
+  if (leaving_state == REV_PROP)
+    {
+      const char *name = apr_pstrdup(annotate_ctx->pool,
+                                     svn_hash_gets(attrs, "name"));
+      const svn_string_t *value;
+
+      SVN_ERR(decode_cdata(&value, cdata, attrs, annotate_ctx->pool));
+      svn_hash_sets(annotate_ctx->rev_props, name, value);
+    }
+  else if (leaving_state == REVISION)
+    {
+      svn_revnum_t *rev = apr_palloc(annotate_ctx->pool, sizeof(*rev));
+
+      SVN_ERR(svn_revnum_parse(rev, svn_hash_gets(attrs, "rev"), NULL));
+      apr_hash_set(annotate_ctx->revs, rev, sizeof(*rev),
+                   annotate_ctx->rev_props);
+    }
+  else if (leaving_state == LINE)
+    {
+      const char *rev_str = svn_hash_gets(attrs, "rev");
+      svn_revnum_t rev = SVN_INVALID_REVNUM;
+      apr_hash_t *rev_props = NULL;
+      const svn_string_t *line;
+
+      if (rev_str)
+        {
+          SVN_ERR(svn_revnum_parse(&rev, rev_str, NULL));
+          rev_props = apr_hash_get(annotate_ctx->revs, &rev, sizeof(rev));
+        }
+
+      SVN_ERR(decode_cdata(&line, cdata, attrs, scratch_pool));
+      SVN_ERR(annotate_ctx->receiver(annotate_ctx->receiver_baton,
+                                     annotate_ctx->line_no++, rev,
+                                     rev_props, line, scratch_pool));
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_ra_serf__request_body_delegate_t */
+static svn_error_t *
+create_annotate_body(serf_bucket_t **body_bkt,
+                     void *baton,
+                     serf_bucket_alloc_t *alloc,
+                     apr_pool_t *pool /* request pool */,
+                     apr_pool_t *scratch_pool)
+{
+  serf_bucket_t *buckets;
+  annotate_context_t *annotate_ctx = baton;
+  const svn_diff_file_options_t *diff_options = annotate_ctx->diff_options;
+
+  buckets = serf_bucket_aggregate_create(alloc);
+
+  svn_ra_serf__add_open_tag_buckets(buckets, alloc,
+                                    "S:blame-report",
+                                    "xmlns:S", SVN_XML_NAMESPACE,
+                                    SVN_VA_NULL);
+
+  svn_ra_serf__add_tag_buckets(buckets,
+                               "S:path", annotate_ctx->path,
+                               alloc);
+  svn_ra_serf__add_tag_buckets(buckets,
+                               "S:start-revision",
+                               apr_ltoa(pool, annotate_ctx->start),
+                               alloc);
+  svn_ra_serf__add_tag_buckets(buckets,
+                               "S:end-revision",
+                               apr_ltoa(pool, annotate_ctx->end),
+                               alloc);
+
+  if (diff_options)
+    {
+      if (diff_options->ignore_space == svn_diff_file_ignore_space_change)
+        svn_ra_serf__add_tag_buckets(buckets, "S:ignore-space", "change",
+                                     alloc);
+      else if (diff_options->ignore_space == svn_diff_file_ignore_space_all)
+        svn_ra_serf__add_tag_buckets(buckets, "S:ignore-space", "all",
+                                     alloc);
+
+      if (diff_options->ignore_eol_style)
+        svn_ra_serf__add_empty_tag_buckets(buckets, alloc,
+                                           "S:ignore-eol-style", SVN_VA_NULL);
+    }
+
+  svn_ra_serf__add_close_tag_buckets(buckets, alloc,
+                                     "S:blame-report");
+
+  *body_bkt = buckets;
+  return SVN_NO_ERROR;
+}
+
+
+svn_error_t *
+svn_ra_serf__blame(svn_ra_session_t *ra_session,
+                   const char *path,
+                   svn_revnum_t start,
+                   svn_revnum_t end,
+                   const svn_diff_file_options_t *diff_options,
+                   svn_ra_blame_receiver_t receiver,
+                   void *receiver_baton,
+                   apr_pool_t *scratch_pool)
+{
+  annotate_context_t *annotate_ctx;
+  svn_ra_serf__session_t *session = ra_session->priv;
+  svn_ra_serf__handler_t *handler;
+  svn_ra_serf__xml_context_t *xmlctx;
+  const char *req_url;
+
+  annotate_ctx = apr_pcalloc(scratch_pool, sizeof(*annotate_ctx));
+  annotate_ctx->pool = scratch_pool;
+  annotate_ctx->receiver = receiver;
+  annotate_ctx->receiver_baton = receiver_baton;
+  annotate_ctx->path = path;
+  annotate_ctx->start = start;
+  annotate_ctx->end = end;
+  annotate_ctx->diff_options = diff_options;
+  annotate_ctx->revs = apr_hash_make(scratch_pool);
+
+  SVN_ERR(svn_ra_serf__get_stable_url(&req_url, NULL /* latest_revnum */,
+                                      session,
+                                      NULL /* url */, end,
+                                      scratch_pool, scratch_pool));
+
+  xmlctx = svn_ra_serf__xml_context_create(annotate_ttable,
+                                           annotate_opened, annotate_closed,
+                                           NULL,
+                                           annotate_ctx,
+                                           scratch_pool);
+  handler = svn_ra_serf__create_expat_handler(session, xmlctx, NULL,
+                                              scratch_pool);
+
+  handler->method = "REPORT";
+  handler->path = req_url;
+  handler->body_delegate = create_annotate_body;
+  handler->body_delegate_baton = annotate_ctx;
+  handler->body_type = "text/xml";
+
+  SVN_ERR(svn_ra_serf__context_run_one(handler, scratch_pool));
+
+  if (handler->sline.code != 200)
+    SVN_ERR(svn_ra_serf__unexpected_status(handler));
+
+  return SVN_NO_ERROR;
+}
@@ -1070,6 +1070,7 @@ static const svn_ra__vtable_t serf_vtable = {
   NULL /* set_svn_ra_open */,
   svn_ra_serf__list,
   svn_ra_serf__fetch_file_contents,
+  svn_ra_serf__blame,
   svn_ra_serf__register_editor_shim_callbacks,
   NULL /* commit_ev2 */,
   NULL /* replay_range_ev2 */
@@ -3079,6 +3079,7 @@ ra_svn_has_capability(svn_ra_session_t *session,
       {SVN_RA_CAPABILITY_GET_FILE_REVS_REVERSE,
                                        SVN_RA_SVN_CAP_GET_FILE_REVS_REVERSE},
       {SVN_RA_CAPABILITY_LIST, SVN_RA_SVN_CAP_LIST},
+      {SVN_RA_CAPABILITY_BLAME, SVN_RA_SVN_CAP_BLAME},
 
       {NULL, NULL} /* End of list marker */
   };
@@ -3261,6 +3262,89 @@ ra_svn_list(svn_ra_session_t *session,
   return SVN_NO_ERROR;
 }
 
+static svn_error_t *
+ra_svn_blame(svn_ra_session_t *session,
+             const char *path,
+             svn_revnum_t start,
+             svn_revnum_t end,
+             const svn_diff_file_options_t *diff_options,
+             svn_ra_blame_receiver_t receiver,
+             void *receiver_baton,
+             apr_pool_t *scratch_pool)
+{
+  svn_ra_svn__session_baton_t *sess_baton = session->priv;
+  svn_ra_svn_conn_t *conn = sess_baton->conn;
+  const char *ignore_space = "none";
+  svn_boolean_t ignore_eol_style = FALSE;
+  apr_hash_t *revs = apr_hash_make(scratch_pool);
+  apr_int64_t line_no;
+  apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+
+  path = reparent_path(session, path, scratch_pool);
+
+  if (diff_options)
+    {
+      if (diff_options->ignore_space == svn_diff_file_ignore_space_change)
+        ignore_space = "change";
+      else if (diff_options->ignore_space == svn_diff_file_ignore_space_all)
+        ignore_space = "all";
+      ignore_eol_style = diff_options->ignore_eol_style;
+    }
+
+  /* Send the blame request. */
+  SVN_ERR(svn_ra_svn__write_tuple(conn, scratch_pool, "w(crrwb)", "blame",
+                                  path, start, end, ignore_space,
+                                  ignore_eol_style));
+
+  /* Handle auth request by server */
+  SVN_ERR(handle_auth_request(sess_baton, scratch_pool));
+
+  /* Read and process the annotated lines. */
+  for (line_no = 0; ; ++line_no)
+    {
+      svn_ra_svn__item_t *item;
+      svn_string_t *line;
+      svn_revnum_t revision;
+      svn_ra_svn__list_t *rev_proplist;
+      apr_hash_t *rev_props = NULL;
+
+      svn_pool_clear(iterpool);
+
+      /* Read the next line or bail out on "done", respectively */
+      SVN_ERR(svn_ra_svn__read_item(conn, iterpool, &item));
+      if (is_done_response(item))
+        break;
+      if (item->kind != SVN_RA_SVN_LIST)
+        return svn_error_create(SVN_ERR_RA_SVN_MALFORMED_DATA, NULL,
+                                _("Blame entry not a list"));
+      SVN_ERR(svn_ra_svn__parse_tuple(&item->u.list, "s(?r)(?l)",
+                                      &line, &revision, &rev_proplist));
+
+      /* The revprops are only being sent once per revision. */
+      if (SVN_IS_VALID_REVNUM(revision))
+        {
+          if (rev_proplist)
+            {
+              svn_revnum_t *key = apr_pmemdup(scratch_pool, &revision,
+                                              sizeof(revision));
+              SVN_ERR(svn_ra_svn__parse_proplist(rev_proplist, scratch_pool,
+                                                 &rev_props));
+              apr_hash_set(revs, key, sizeof(*key), rev_props);
+            }
+          else
+            rev_props = apr_hash_get(revs, &revision, sizeof(revision));
+        }
+
+      SVN_ERR(receiver(receiver_baton, line_no, revision, rev_props, line,
+                       iterpool));
+    }
+  svn_pool_destroy(iterpool);
+
+  /* Read the actual command response. */
+  SVN_ERR(svn_ra_svn__read_cmd_response(conn, scratch_pool, ""));
+  return SVN_NO_ERROR;
+}
+
 static svn_error_t *ra_svn_get_file(svn_ra_session_t *session, const char *path,
                                     svn_revnum_t rev, svn_stream_t *stream,
                                     svn_revnum_t *fetched_rev,
@@ -3330,6 +3414,7 @@ static const svn_ra__vtable_t ra_svn_vtable = {
   NULL /* ra_set_svn_ra_open */,
   ra_svn_list,
   ra_svn_fetch_file_contents,
+  ra_svn_blame,
   ra_svn_register_editor_shim_callbacks,
   NULL /* commit_ev2 */,
   NULL /* replay_range_ev2 */
@@ -1011,6 +1011,21 @@ create_user_authz(authz_full_t *authz,
 
 /*** Lookup. ***/
 
+/* The lookup result for one segment level of a previously looked up path.
+ * Keeping these around allows lookups of paths that share a parent with
+ * the previous one to skip the common part of the tree walk. */
+typedef struct lookup_level_t
+{
+  /* Nodes applying to the path up to and including this level. */
+  apr_array_header_t *nodes;
+
+  /* Rights that apply to the path up to and including this level. */
+  limited_rights_t rights;
+
+  /* Length of the lookup state's PARENT_PATH up to this level. */
+  apr_size_t path_len;
+} lookup_level_t;
+
 /* Reusable lookup state object. It is easy to pass to functions and
  * recycling it between lookups saves significant setup costs. */
 typedef struct lookup_state_t
@@ -1036,6 +1051,15 @@ typedef struct lookup_state_t
   /* Rights that apply at PARENT_PATH, if PARENT_PATH is not empty. */
   limited_rights_t parent_rights;
 
+  /* Results for each segment level of PARENT_PATH (lookup_level_t).
+   * Element I covers the first I+1 segments.  Only the first DEPTH
+   * elements are valid; the others are kept for their NODES arrays. */
+  apr_array_header_t *levels;
+  int depth;
+
+  /* Pool to allocate the LEVELS' NODES arrays in. */
+  apr_pool_t *pool;
+
 } lookup_state_t;
 
 /* Constructor for lookup_state_t. */
@@ -1059,9 +1083,37 @@ create_lookup_state(apr_pool_t *result_pool)
    * above applies. */
   state->parent_path = svn_stringbuf_create_ensure(200, result_pool);
 
+  state->levels = apr_array_make(result_pool, 8, sizeof(lookup_level_t));
+  state->pool = result_pool;
+
   return state;
 }
 
+/* Record the CURRENT nodes and PARENT_RIGHTS of STATE as the result for
+ * the next segment level of its PARENT_PATH. */
+static void
+push_lookup_level(lookup_state_t *state)
+{
+  lookup_level_t *level;
+
+  if (state->depth == state->levels->nelts)
+    {
+      level = apr_array_push(state->levels);
+      level->nodes = apr_array_make(state->pool, state->current->nelts,
+                                    sizeof(node_t *));
+    }
+  else
+    {
+      level = &APR_ARRAY_IDX(state->levels, state->depth, lookup_level_t);
+      apr_array_clear(level->nodes);
+    }
+
+  apr_array_cat(level->nodes, state->current);
+  level->rights = state->parent_rights;
+  level->path_len = state->parent_path->len;
+  ++state->depth;
+}
+
 /* Clear the current contents of STATE and re-initialize it for ROOT.
  * Check whether we can reuse a previous parent path lookup to shorten
  * the current PATH walk.  Return the full or remaining portion of
@@ -1086,6 +1138,43 @@ init_lockup_state(lookup_state_t *state,
       return path + state->parent_path->len;
     }
 
+  /* Maybe, some shorter parent path of the previous lookup is a parent
+   * of PATH as well.  This is the typical case when walking a tree or
+   * processing a sorted list of paths. */
+  if (state->depth > 1)
+    {
+      apr_size_t common = 0;
+      int i;
+
+      while (   common < len
+             && common < state->parent_path->len
+             && path[common] == state->parent_path->data[common])
+        ++common;
+
+      /* The deepest level still matching PATH.  The last level is the
+       * full PARENT_PATH and has already been handled above. */
+      for (i = state->depth - 2; i >= 0; --i)
+        {
+          const lookup_level_t *level
+            = &APR_ARRAY_IDX(state->levels, i, lookup_level_t);
+
+          if (   level->path_len <= common
+              && level->path_len < len
+              && path[level->path_len] == '/')
+            {
+              apr_array_clear(state->current);
+              apr_array_cat(state->current, level->nodes);
+              state->rights = level->rights;
+              state->parent_rights = level->rights;
+              svn_stringbuf_chop(state->parent_path,
+                                 state->parent_path->len - level->path_len);
+              state->depth = i + 1;
+
+              return path + level->path_len;
+            }
+        }
+    }
+
   /* Start lookup at ROOT for the full PATH. */
   state->rights = root->rights;
   state->parent_rights = root->rights;
@@ -1107,6 +1196,7 @@ init_lockup_state(lookup_state_t *state,
 
   svn_stringbuf_setempty(state->parent_path);
   svn_stringbuf_setempty(state->scratch_pad);
+  state->depth = 0;
 
   return path;
 }
@@ -1403,6 +1493,7 @@ lookup(lookup_state_t *state,
 
           /* In STATE, PARENT_PATH, PARENT_RIGHTS and CURRENT are now in sync. */
           state->parent_rights = state->rights;
+          push_lookup_level(state);
         }
     }
 
@@ -1718,23 +1809,22 @@ svn_repos_authz_parse2(svn_authz_t **authz_p,
   return SVN_NO_ERROR;
 }
 
-svn_error_t *
-svn_repos_authz_check_access(svn_authz_t *authz, const char *repos_name,
-                             const char *path, const char *user,
-                             svn_repos_authz_access_t required_access,
-                             svn_boolean_t *access_granted,
-                             apr_pool_t *pool)
+/* Convert the public REQUIRED_ACCESS flags into authz_access_t. */
+static authz_access_t
+required_rights(svn_repos_authz_access_t required_access)
 {
-  const authz_access_t required =
-    ((required_access & svn_authz_read ? authz_access_read_flag : 0)
-     | (required_access & svn_authz_write ? authz_access_write_flag : 0));
-
-  /* Pick or create the suitable pre-filtered path rule tree. */
-  authz_user_rules_t *rules = get_user_rules(
-      authz,
-      (repos_name ? repos_name : AUTHZ_ANY_REPOSITORY),
-      user);
+  return ((required_access & svn_authz_read ? authz_access_read_flag : 0)
+          | (required_access & svn_authz_write ? authz_access_write_flag : 0));
+}
 
+/* Set *ACCESS_GRANTED, if the RULES' global rights alone determine
+ * whether REQUIRED access is granted for any path.  Return TRUE in that
+ * case, otherwise return FALSE and leave *ACCESS_GRANTED untouched. */
+static svn_boolean_t
+check_global_rights(svn_boolean_t *access_granted,
+                    const authz_user_rules_t *rules,
+                    authz_access_t required)
+{
   /* In many scenarios, users have uniform access to a repository
    * (blanket access or no access at all).
    *
@@ -1743,15 +1833,62 @@ svn_repos_authz_check_access(svn_authz_t *authz, const char *repos_name,
   if ((rules->global_rights.min_access & required) == required)
     {
       *access_granted = TRUE;
-      return SVN_NO_ERROR;
+      return TRUE;
     }
 
   if ((rules->global_rights.max_access & required) != required)
     {
       *access_granted = FALSE;
-      return SVN_NO_ERROR;
+      return TRUE;
     }
 
+  return FALSE;
+}
+
+/* Determine in *ACCESS_GRANTED whether the user of AUTHZ's filtered
+ * rules has the REQUIRED access to PATH, walking the filtered tree.
+ * If RECURSIVE is set, check the whole sub-tree at PATH. */
+static svn_error_t *
+check_tree_access(svn_boolean_t *access_granted,
+                  svn_authz_t *authz,
+                  const char *path,
+                  authz_access_t required,
+                  svn_boolean_t recursive,
+                  apr_pool_t *scratch_pool)
+{
+  /* Re-use previous lookup results, if possible. */
+  path = init_lockup_state(authz->filtered->lookup_state,
+                           authz->filtered->root, path);
+
+  /* Sanity check. */
+  SVN_ERR_ASSERT(path[0] == '/');
+
+  /* Determine the granted access for the requested path.
+   * PATH does not need to be normalized for lockup(). */
+  *access_granted = lookup(authz->filtered->lookup_state, path, required,
+                           recursive, scratch_pool);
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_repos_authz_check_access(svn_authz_t *authz, const char *repos_name,
+                             const char *path, const char *user,
+                             svn_repos_authz_access_t required_access,
+                             svn_boolean_t *access_granted,
+                             apr_pool_t *pool)
+{
+  const authz_access_t required = required_rights(required_access);
+
+  /* Pick or create the suitable pre-filtered path rule tree. */
+  authz_user_rules_t *rules = get_user_rules(
+      authz,
+      (repos_name ? repos_name : AUTHZ_ANY_REPOSITORY),
+      user);
+
+  if (check_global_rights(access_granted, rules, required))
+    return SVN_NO_ERROR;
+
   /* No specific path given, i.e. looking for anywhere in the tree? */
   if (!path)
     {
@@ -1766,17 +1903,207 @@ svn_repos_authz_check_access(svn_authz_t *authz, const char *repos_name,
   if (!rules->root)
     SVN_ERR(filter_tree(authz, pool));
 
-  /* Re-use previous lookup results, if possible. */
-  path = init_lockup_state(authz->filtered->lookup_state,
-                           authz->filtered->root, path);
+  return svn_error_trace(check_tree_access(access_granted, authz, path,
+                                           required,
+                                           !!(required_access
+                                              & svn_authz_recursive),
+                                           pool));
+}
 
-  /* Sanity check. */
-  SVN_ERR_ASSERT(path[0] == '/');
+/* Element type of the sorted path list in
+ * svn_repos_authz_check_access_many. */
+typedef struct path_index_t
+{
+  /* The path to check. */
+  const char *path;
 
-  /* Determine the granted access for the requested path.
-   * PATH does not need to be normalized for lockup(). */
-  *access_granted = lookup(rules->lookup_state, path, required,
-                           !!(required_access & svn_authz_recursive), pool);
+  /* Its index in the caller's path list. */
+  int index;
+} path_index_t;
+
+/* Sort function for path_index_t *, ordering parents right before their
+ * sub-paths such that consecutive lookups share most of their tree walk. */
+static int
+compare_path_index(const void *lhs,
+                   const void *rhs)
+{
+  const path_index_t *lhs_path = lhs;
+  const path_index_t *rhs_path = rhs;
+
+  return svn_path_compare_paths(lhs_path->path, rhs_path->path);
+}
+
+svn_error_t *
+svn_repos_authz_check_access_many(apr_array_header_t **access_granted_p,
+                                  svn_authz_t *authz,
+                                  const char *repos_name,
+                                  const apr_array_header_t *paths,
+                                  const char *user,
+                                  svn_repos_authz_access_t required_access,
+                                  apr_pool_t *result_pool,
+                                  apr_pool_t *scratch_pool)
+{
+  const authz_access_t required = required_rights(required_access);
+  const svn_boolean_t recursive = !!(required_access & svn_authz_recursive);
+  apr_array_header_t *access_granted;
+  apr_array_header_t *sorted;
+  svn_boolean_t global_access;
+  int i;
+
+  /* Pick or create the suitable pre-filtered path rule tree. */
+  authz_user_rules_t *rules = get_user_rules(
+      authz,
+      (repos_name ? repos_name : AUTHZ_ANY_REPOSITORY),
+      user);
+
+  access_granted = apr_array_make(result_pool, paths->nelts,
+                                  sizeof(svn_boolean_t));
+  access_granted->nelts = paths->nelts;
+
+  /* All paths may be decided at once. */
+  if (check_global_rights(&global_access, rules, required))
+    {
+      for (i = 0; i < paths->nelts; ++i)
+        APR_ARRAY_IDX(access_granted, i, svn_boolean_t) = global_access;
+
+      *access_granted_p = access_granted;
+      return SVN_NO_ERROR;
+    }
+
+  /* Did we already filter the data model? */
+  if (!rules->root)
+    SVN_ERR(filter_tree(authz, scratch_pool));
+
+  /* Check the paths in tree order, such that each lookup can continue
+   * from the nodes found for its parent or sibling. */
+  sorted = apr_array_make(scratch_pool, paths->nelts, sizeof(path_index_t));
+  for (i = 0; i < paths->nelts; ++i)
+    {
+      path_index_t *entry = apr_array_push(sorted);
+      entry->path = APR_ARRAY_IDX(paths, i, const char *);
+      entry->index = i;
+    }
 
+  svn_sort__array(sorted, compare_path_index);
+
+  for (i = 0; i < sorted->nelts; ++i)
+    {
+      const path_index_t *entry = &APR_ARRAY_IDX(sorted, i, path_index_t);
+      SVN_ERR(check_tree_access(&APR_ARRAY_IDX(access_granted, entry->index,
+                                               svn_boolean_t),
+                                authz, entry->path, required, recursive,
+                                scratch_pool));
+    }
+
+  *access_granted_p = access_granted;
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_repos__authz_read_func(svn_boolean_t *allowed,
+                           svn_fs_root_t *root,
+                           const char *path,
+                           void *baton,
+                           apr_pool_t *pool)
+{
+  svn_repos__authz_read_baton_t *read_baton = baton;
+
+  if (path && *path != '/')
+    path = svn_fspath__canonicalize(path, pool);
+
+  return svn_error_trace(svn_repos_authz_check_access(read_baton->authz,
+                                                      read_baton->repos_name,
+                                                      path,
+                                                      read_baton->user,
+                                                      svn_authz_read,
+                                                      allowed, pool));
+}
+
+svn_error_t *
+svn_repos__authz_read_many(apr_array_header_t **readable_p,
+                           svn_repos_authz_func_t authz_read_func,
+                           void *authz_read_baton,
+                           svn_fs_root_t *root,
+                           const apr_array_header_t *paths,
+                           apr_pool_t *result_pool,
+                           apr_pool_t *scratch_pool)
+{
+  apr_array_header_t *readable;
+  apr_pool_t *iterpool;
+  int i;
+
+  if (authz_read_func == svn_repos__authz_read_func)
+    {
+      svn_repos__authz_read_baton_t *read_baton = authz_read_baton;
+      apr_array_header_t *fspaths = apr_array_make(scratch_pool,
+                                                   paths->nelts,
+                                                   sizeof(const char *));
+
+      for (i = 0; i < paths->nelts; ++i)
+        {
+          const char *path = APR_ARRAY_IDX(paths, i, const char *);
+          if (*path != '/')
+            path = svn_fspath__canonicalize(path, scratch_pool);
+
+          APR_ARRAY_PUSH(fspaths, const char *) = path;
+        }
+
+      return svn_error_trace(
+               svn_repos_authz_check_access_many(readable_p,
+                                                 read_baton->authz,
+                                                 read_baton->repos_name,
+                                                 fspaths, read_baton->user,
+                                                 svn_authz_read,
+                                                 result_pool, scratch_pool));
+    }
+
+  readable = apr_array_make(result_pool, paths->nelts, sizeof(svn_boolean_t));
+  iterpool = svn_pool_create(scratch_pool);
+  for (i = 0; i < paths->nelts; ++i)
+    {
+      svn_pool_clear(iterpool);
+      SVN_ERR(authz_read_func(apr_array_push(readable), root,
+                              APR_ARRAY_IDX(paths, i, const char *),
+                              authz_read_baton, iterpool));
+    }
+  svn_pool_destroy(iterpool);
+
+  *readable_p = readable;
   return SVN_NO_ERROR;
 }
+
+void
+svn_repos__authz_fingerprint(const char **fingerprint,
+                             svn_authz_t *authz,
+                             const char *repos_name,
+                             const char *user,
+                             apr_pool_t *result_pool)
+{
+  svn_stringbuf_t *result;
+  const unsigned char *id;
+  apr_size_t i;
+
+  /* Authz data parsed from streams has no identity. */
+  if (!authz->authz_id)
+    {
+      *fingerprint = NULL;
+      return;
+    }
+
+  /* The filtered rule tree is determined by these three. */
+  result = svn_stringbuf_create_ensure(2 * authz->authz_id->size + 64,
+                                       result_pool);
+  id = authz->authz_id->data;
+  for (i = 0; i < authz->authz_id->size; ++i)
+    svn_stringbuf_appendcstr(result, apr_psprintf(result_pool, "%02x",
+                                                  id[i]));
+
+  svn_stringbuf_appendbyte(result, ':');
+  svn_stringbuf_appendcstr(result,
+                           repos_name ? repos_name : AUTHZ_ANY_REPOSITORY);
+  svn_stringbuf_appendcstr(result, user ? ":+" : ":-");
+  if (user)
+    svn_stringbuf_appendcstr(result, user);
+
+  *fingerprint = result->data;
+}
@@ -0,0 +1,373 @@
+/* blame.c : server-side line annotation of files
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+#include <apr_pools.h>
+
+#include "svn_pools.h"
+#include "svn_error.h"
+#include "svn_diff.h"
+#include "svn_fs.h"
+#include "svn_props.h"
+#include "svn_repos.h"
+#include "svn_subst.h"
+#include "svn_string.h"
+
+#include "svn_private_config.h"
+
+#include "repos.h"
+
+
+
+/* The revision that is responsible for a line. */
+typedef struct blame_rev_t
+{
+  /* SVN_INVALID_REVNUM for lines older than the start revision. */
+  svn_revnum_t revision;
+
+  /* The revision properties.  NULL for lines older than the start rev. */
+  apr_hash_t *rev_props;
+} blame_rev_t;
+
+/* Baton used with file_rev_handler and friends.  Lives for the whole
+   blame operation. */
+typedef struct blame_baton_t
+{
+  /* Revisions older than this one will be reported as "unknown". */
+  svn_revnum_t start;
+
+  /* How to compare lines. */
+  const svn_diff_file_options_t *diff_options;
+
+  /* Contents of the last revision that had content changes and, for
+     every line in it, the blame_rev_t * that last changed the line. */
+  svn_stringbuf_t *text;
+  apr_array_header_t *lines;
+
+  /* The same for the revision that we are currently processing.  Will be
+     swapped with TEXT and LINES once the current delta has been applied. */
+  svn_stringbuf_t *next_text;
+  apr_array_header_t *next_lines;
+
+  /* The revision that we are currently processing. */
+  const blame_rev_t *rev;
+
+  /* Number of lines of TEXT processed so far by output_diff_modified. */
+  int orig_pos;
+
+  /* The file being annotated and, if not 0, the maximum size of any of
+     its texts that we are willing to hold in memory. */
+  const char *path;
+  svn_filesize_t max_size;
+
+  /* Cancellation support. */
+  svn_cancel_func_t cancel_func;
+  void *cancel_baton;
+
+  /* For temporaries of the per-revision diff. */
+  apr_pool_t *iterpool;
+
+  /* For BLAME_REV_T instances and everything that lives as long as this
+     baton. */
+  apr_pool_t *pool;
+
+  /* The wrapped txdelta window handler for the current revision. */
+  svn_txdelta_window_handler_t apply_handler;
+  void *apply_baton;
+} blame_baton_t;
+
+/* Implements svn_diff_output_fns_t.output_diff_modified.  Append the
+   blame info for all lines of B->NEXT_TEXT up to and including the
+   modified range to B->NEXT_LINES. */
+static svn_error_t *
+output_diff_modified(void *baton,
+                     apr_off_t original_start,
+                     apr_off_t original_length,
+                     apr_off_t modified_start,
+                     apr_off_t modified_length,
+                     apr_off_t latest_start,
+                     apr_off_t latest_length)
+{
+  blame_baton_t *b = baton;
+  apr_off_t i;
+
+  /* The lines between the previous change and this one are unchanged. */
+  while (b->orig_pos < original_start && b->orig_pos < b->lines->nelts)
+    APR_ARRAY_PUSH(b->next_lines, const blame_rev_t *)
+      = APR_ARRAY_IDX(b->lines, b->orig_pos++, const blame_rev_t *);
+
+  for (i = 0; i < modified_length; ++i)
+    APR_ARRAY_PUSH(b->next_lines, const blame_rev_t *) = b->rev;
+
+  b->orig_pos = (int)(original_start + original_length);
+
+  return SVN_NO_ERROR;
+}
+
+static const svn_diff_output_fns_t output_fns = {
+  NULL,
+  output_diff_modified
+};
+
+/* Compare B->TEXT with B->NEXT_TEXT, derive the blame info for the
+   latter from that and make it the current text. */
+static svn_error_t *
+update_blame(blame_baton_t *b)
+{
+  svn_diff_t *diff;
+  svn_string_t original, modified;
+  svn_stringbuf_t *text;
+  apr_array_header_t *lines;
+
+  svn_pool_clear(b->iterpool);
+
+  original.data = b->text->data;
+  original.len = b->text->len;
+  modified.data = b->next_text->data;
+  modified.len = b->next_text->len;
+
+  SVN_ERR(svn_diff_mem_string_diff(&diff, &original, &modified,
+                                   b->diff_options, b->iterpool));
+
+  apr_array_clear(b->next_lines);
+  b->orig_pos = 0;
+  SVN_ERR(svn_diff_output2(diff, b, &output_fns,
+                           b->cancel_func, b->cancel_baton));
+
+  /* Everything after the last change is unchanged. */
+  while (b->orig_pos < b->lines->nelts)
+    APR_ARRAY_PUSH(b->next_lines, const blame_rev_t *)
+      = APR_ARRAY_IDX(b->lines, b->orig_pos++, const blame_rev_t *);
+
+  /* Swap current and next. */
+  text = b->text;
+  b->text = b->next_text;
+  b->next_text = text;
+
+  lines = b->lines;
+  b->lines = b->next_lines;
+  b->next_lines = lines;
+
+  return SVN_NO_ERROR;
+}
+
+/* Return SVN_ERR_UNSUPPORTED_FEATURE if a text of SIZE bytes exceeds
+   the limit set in B. */
+static svn_error_t *
+check_size(const blame_baton_t *b,
+           svn_filesize_t size)
+{
+  if (b->max_size && size > b->max_size)
+    return svn_error_createf(SVN_ERR_UNSUPPORTED_FEATURE, NULL,
+                             _("File '%s' is too large for server-side "
+                               "blame (limit is %s bytes)"),
+                             b->path,
+                             apr_psprintf(b->iterpool, "%" SVN_FILESIZE_T_FMT,
+                                          b->max_size));
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_txdelta_window_handler_t.  Forward WINDOW to the
+   delta applicator and update the blame info once the delta is
+   complete.  BATON is a blame_baton_t. */
+static svn_error_t *
+window_handler(svn_txdelta_window_t *window,
+               void *baton)
+{
+  blame_baton_t *b = baton;
+
+  SVN_ERR(b->apply_handler(window, b->apply_baton));
+  if (window)
+    return svn_error_trace(check_size(b, b->next_text->len));
+
+  return svn_error_trace(update_blame(b));
+}
+
+/* Implements svn_file_rev_handler_t.  BATON is a blame_baton_t. */
+static svn_error_t *
+file_rev_handler(void *baton,
+                 const char *path,
+                 svn_revnum_t revision,
+                 apr_hash_t *rev_props,
+                 svn_boolean_t result_of_merge,
+                 svn_txdelta_window_handler_t *delta_handler,
+                 void **delta_baton,
+                 apr_array_header_t *prop_diffs,
+                 apr_pool_t *pool)
+{
+  blame_baton_t *b = baton;
+  blame_rev_t *rev;
+
+  if (b->cancel_func)
+    SVN_ERR(b->cancel_func(b->cancel_baton));
+
+  /* Property-only changes don't affect the blame. */
+  if (!delta_handler)
+    return SVN_NO_ERROR;
+
+  rev = apr_pcalloc(b->pool, sizeof(*rev));
+  if (revision >= b->start)
+    {
+      rev->revision = revision;
+      rev->rev_props = svn_prop_hash_dup(rev_props, b->pool);
+    }
+  else
+    {
+      /* This is the state of PATH just before START. */
+      rev->revision = SVN_INVALID_REVNUM;
+    }
+
+  b->rev = rev;
+
+  svn_stringbuf_setempty(b->next_text);
+  svn_txdelta_apply2(svn_stream_from_stringbuf(b->text, pool),
+                     svn_stream_from_stringbuf(b->next_text, pool),
+                     NULL, NULL, pool,
+                     &b->apply_handler, &b->apply_baton);
+
+  *delta_handler = window_handler;
+  *delta_baton = b;
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_repos_blame(svn_repos_t *repos,
+                const char *path,
+                svn_revnum_t start,
+                svn_revnum_t end,
+                const svn_diff_file_options_t *diff_options,
+                svn_filesize_t max_size,
+                svn_repos_authz_func_t authz_read_func,
+                void *authz_read_baton,
+                svn_repos_blame_receiver_t receiver,
+                void *receiver_baton,
+                svn_cancel_func_t cancel_func,
+                void *cancel_baton,
+                apr_pool_t *scratch_pool)
+{
+  blame_baton_t b = { 0 };
+  svn_stream_t *stream;
+  apr_pool_t *iterpool;
+  apr_int64_t line_no;
+  const blame_rev_t *last_rev = NULL;
+  svn_fs_root_t *root;
+  svn_boolean_t readable = TRUE;
+
+  if (start > end)
+    return svn_error_createf(SVN_ERR_INCORRECT_PARAMS, NULL,
+                             _("Start revision %ld is greater than "
+                               "end revision %ld"), start, end);
+
+  b.path = path;
+  b.max_size = max_size;
+  b.iterpool = svn_pool_create(scratch_pool);
+
+  /* Refuse binary files, just like the client-side blame does, and files
+     that are already too large in END.  If PATH is not readable, leave
+     reporting that to svn_repos_get_file_revs2(). */
+  SVN_ERR(svn_fs_revision_root(&root, repos->fs, end, scratch_pool));
+  if (authz_read_func)
+    SVN_ERR(authz_read_func(&readable, root, path, authz_read_baton,
+                            scratch_pool));
+  if (readable)
+    {
+      svn_node_kind_t kind;
+
+      SVN_ERR(svn_fs_check_path(&kind, root, path, scratch_pool));
+      if (kind == svn_node_file)
+        {
+          svn_string_t *mime_type;
+          svn_filesize_t length;
+
+          SVN_ERR(svn_fs_node_prop(&mime_type, root, path,
+                                   SVN_PROP_MIME_TYPE, scratch_pool));
+          if (mime_type && svn_mime_type_is_binary(mime_type->data))
+            return svn_error_createf(SVN_ERR_CLIENT_IS_BINARY_FILE, NULL,
+                                     _("Cannot calculate blame information "
+                                       "for binary file '%s'"), path);
+
+          SVN_ERR(svn_fs_file_length(&length, root, path, scratch_pool));
+          SVN_ERR(check_size(&b, length));
+        }
+    }
+
+  b.start = start;
+  b.diff_options = diff_options ? diff_options
+                                : svn_diff_file_options_create(scratch_pool);
+  b.text = svn_stringbuf_create_empty(scratch_pool);
+  b.next_text = svn_stringbuf_create_empty(scratch_pool);
+  b.lines = apr_array_make(scratch_pool, 0, sizeof(const blame_rev_t *));
+  b.next_lines = apr_array_make(scratch_pool, 0, sizeof(const blame_rev_t *));
+  b.cancel_func = cancel_func;
+  b.cancel_baton = cancel_baton;
+  b.pool = scratch_pool;
+
+  /* Start one revision early, such that we know the state of PATH right
+     before START and can tell which lines have been changed since. */
+  SVN_ERR(svn_repos_get_file_revs2(repos, path,
+                                   start > 0 ? start - 1 : start, end,
+                                   FALSE, authz_read_func, authz_read_baton,
+                                   file_rev_handler, &b, scratch_pool));
+
+  /* Report the blame info, normalizing line endings in the same way as
+     the client-side blame does. */
+  stream = svn_subst_stream_translated(svn_stream_from_stringbuf(b.text,
+                                                                 scratch_pool),
+                                       "\n", TRUE, NULL, FALSE, scratch_pool);
+  iterpool = svn_pool_create(scratch_pool);
+  for (line_no = 0; ; ++line_no)
+    {
+      svn_boolean_t eof;
+      svn_stringbuf_t *sb;
+      svn_string_t line;
+
+      svn_pool_clear(iterpool);
+      SVN_ERR(svn_stream_readline(stream, &sb, "\n", &eof, iterpool));
+      if (cancel_func)
+        SVN_ERR(cancel_func(cancel_baton));
+
+      if (eof && !sb->len)
+        break;
+
+      /* The line count reported by the diff and by the line reader may
+         only ever differ for the last line. */
+      if (line_no < b.lines->nelts)
+        last_rev = APR_ARRAY_IDX(b.lines, line_no, const blame_rev_t *);
+
+      line.data = sb->data;
+      line.len = sb->len;
+      SVN_ERR(receiver(receiver_baton, line_no,
+                       last_rev ? last_rev->revision : SVN_INVALID_REVNUM,
+                       last_rev ? last_rev->rev_props : NULL,
+                       &line, iterpool));
+
+      if (eof)
+        break;
+    }
+
+  SVN_ERR(svn_stream_close(stream));
+  svn_pool_destroy(iterpool);
+  svn_pool_destroy(b.iterpool);
+
+  return SVN_NO_ERROR;
+}
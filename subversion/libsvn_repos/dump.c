@@ -45,9 +45,17 @@
 #include "private/svn_utf_private.h"
 #include "private/svn_cache.h"
 #include "private/svn_fspath.h"
+#include "private/svn_mutex.h"
+#include "private/svn_task.h"
 
 #define ARE_VALID_COPY_ARGS(p,r) ((p) && SVN_IS_VALID_REVNUM(r))
 
+/* Text deltas stored by the filesystem may be copied into delta dumps as
+   they are if they use this svndiff version or lower.  Version 1 (zlib)
+   can be read by all releases that support delta dumps, while version 2
+   (lz4) requires Subversion 1.10+ on the loading side. */
+#define MAX_PASS_THROUGH_SVNDIFF_VERSION 1
+
 /*----------------------------------------------------------------------*/
 
 
@@ -1132,6 +1140,7 @@ dump_node(struct edit_baton *eb,
   svn_revnum_t compare_rev = eb->current_rev - 1;
   svn_fs_root_t *compare_root = NULL;
   apr_file_t *delta_file = NULL;
+  svn_stream_t *stored_delta = NULL;
   svn_repos__dumpfile_headers_t *headers
     = svn_repos__dumpfile_headers_create(pool);
   svn_filesize_t textlen;
@@ -1462,11 +1471,17 @@ dump_node(struct edit_baton *eb,
 
       if (eb->use_deltas)
         {
-          /* Compute the text delta now and write it into a temporary
-             file, so that we can find its length.  Output a header
-             saying our text contents are a delta. */
-          SVN_ERR(store_delta(&delta_file, &textlen, compare_root,
-                              compare_path, eb->fs_root, path, pool));
+          /* Use the text delta as stored in the repository, if
+             possible.  Otherwise, compute it now and write it into a
+             temporary file, so that we can find its length.  Output a
+             header saying our text contents are a delta. */
+          SVN_ERR(svn_fs__try_get_stored_delta(
+                    &stored_delta, &textlen, compare_root, compare_path,
+                    eb->fs_root, path, MAX_PASS_THROUGH_SVNDIFF_VERSION,
+                    pool, pool));
+          if (!stored_delta)
+            SVN_ERR(store_delta(&delta_file, &textlen, compare_root,
+                                compare_path, eb->fs_root, path, pool));
           svn_repos__dumpfile_header_push(
             headers, SVN_REPOS_DUMPFILE_TEXT_DELTA, "true");
 
@@ -1525,7 +1540,11 @@ dump_node(struct edit_baton *eb,
     {
       svn_stream_t *contents;
 
-      if (delta_file)
+      if (stored_delta)
+        {
+          contents = stored_delta;
+        }
+      else if (delta_file)
         {
           /* Make sure to close the underlying file when the stream is
              closed. */
@@ -1998,6 +2017,9 @@ typedef struct dump_filter_baton_t
 {
   svn_repos_dump_filter_func_t filter_func;
   void *filter_baton;
+
+  /* Serializes the FILTER_FUNC calls of a parallel dump.  May be NULL. */
+  svn_mutex__t *mutex;
 } dump_filter_baton_t;
 
 /* Implements svn_repos_authz_func_t. */
@@ -2015,15 +2037,363 @@ dump_filter_authz_func(svn_boolean_t *allowed,
    * passing it to FILTER_FUNC. */
   path = svn_fspath__canonicalize(path, pool);
 
-  return svn_error_trace(b->filter_func(allowed, root, path, b->filter_baton,
-                                        pool));
+  SVN_MUTEX__WITH_LOCK(b->mutex,
+                       b->filter_func(allowed, root, path, b->filter_baton,
+                                      pool));
+
+  return SVN_NO_ERROR;
+}
+
+/* Dump revision REV of REPOS to STREAM as part of a dump that started
+   at revision START_REV.  INCREMENTAL, USE_DELTAS, INCLUDE_REVPROPS,
+   INCLUDE_CHANGES, NOTIFY_FUNC and NOTIFY_BATON are the same as for
+   svn_repos_dump_fs5.  AUTHZ_FUNC and AUTHZ_BATON are passed directly to
+   the repos layer.  Set *FOUND_OLD_REFERENCE and *FOUND_OLD_MERGEINFO to
+   TRUE if the respective warnings have been issued, leave them untouched
+   otherwise.  Use SCRATCH_POOL for temporary allocations.
+ */
+static svn_error_t *
+dump_revision(svn_stream_t *stream,
+              svn_repos_t *repos,
+              svn_revnum_t rev,
+              svn_revnum_t start_rev,
+              svn_boolean_t incremental,
+              svn_boolean_t use_deltas,
+              svn_boolean_t include_revprops,
+              svn_boolean_t include_changes,
+              svn_boolean_t *found_old_reference,
+              svn_boolean_t *found_old_mergeinfo,
+              svn_repos_notify_func_t notify_func,
+              void *notify_baton,
+              svn_repos_authz_func_t authz_func,
+              void *authz_baton,
+              apr_pool_t *scratch_pool)
+{
+  const svn_delta_editor_t *dump_editor;
+  void *dump_edit_baton = NULL;
+  svn_fs_t *fs = svn_repos_fs(repos);
+  svn_fs_root_t *to_root;
+  svn_boolean_t use_deltas_for_rev;
+
+  /* Write the revision record. */
+  SVN_ERR(write_revision_record(stream, repos, rev, include_revprops,
+                                authz_func, authz_baton, scratch_pool));
+
+  /* When dumping revision 0, we just write out the revision record.
+     The parser might want to use its properties.
+     If we don't want revision changes at all, skip in any case. */
+  if (rev == 0 || !include_changes)
+    return SVN_NO_ERROR;
+
+  /* Fetch the editor which dumps nodes to a file.  Regardless of
+     what we've been told, don't use deltas for the first rev of a
+     non-incremental dump. */
+  use_deltas_for_rev = use_deltas && (incremental || rev != start_rev);
+  SVN_ERR(get_dump_editor(&dump_editor, &dump_edit_baton, fs, rev,
+                          "", stream, found_old_reference,
+                          found_old_mergeinfo, NULL,
+                          notify_func, notify_baton,
+                          start_rev, use_deltas_for_rev, FALSE, FALSE,
+                          scratch_pool));
+
+  /* Drive the editor in one way or another. */
+  SVN_ERR(svn_fs_revision_root(&to_root, fs, rev, scratch_pool));
+
+  /* If this is the first revision of a non-incremental dump,
+     we're in for a full tree dump.  Otherwise, we want to simply
+     replay the revision.  */
+  if ((rev == start_rev) && (! incremental))
+    {
+      /* Compare against revision 0, so everything appears to be added. */
+      svn_fs_root_t *from_root;
+      SVN_ERR(svn_fs_revision_root(&from_root, fs, 0, scratch_pool));
+      SVN_ERR(svn_repos_dir_delta2(from_root, "", "",
+                                   to_root, "",
+                                   dump_editor, dump_edit_baton,
+                                   authz_func, authz_baton,
+                                   FALSE, /* don't send text-deltas */
+                                   svn_depth_infinity,
+                                   FALSE, /* don't send entry props */
+                                   FALSE, /* don't ignore ancestry */
+                                   scratch_pool));
+    }
+  else
+    {
+      /* The normal case: compare consecutive revs. */
+      SVN_ERR(svn_repos_replay2(to_root, "", SVN_INVALID_REVNUM, FALSE,
+                                dump_editor, dump_edit_baton,
+                                authz_func, authz_baton, scratch_pool));
+
+      /* While our editor close_edit implementation is a no-op, we still
+         do this for completeness. */
+      SVN_ERR(dump_editor->close_edit(dump_edit_baton, scratch_pool));
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Maximum number of revisions to dump into a single temporary segment
+   in a parallel dump.  Smaller segments spread the work more evenly but
+   each one comes with a temporary file. */
+#define MAX_DUMP_RANGE_SIZE 1000
+
+/* Number of segments per thread that we aim for, such that a few
+   extraordinarily large revisions won't leave the other threads idle.
+   This is also the maximum number of segments per thread that may be
+   in flight, i.e. kept in temporary files, at any given time. */
+#define DUMP_RANGES_PER_THREAD 16
+
+/* Parameters of a parallel dump, shared by all its tasks. */
+typedef struct dump_params_t
+{
+  /* The repository being dumped.  The worker threads open their own
+     instances of it, using the same FS_CONFIG. */
+  const char *repos_path;
+  apr_hash_t *fs_config;
+
+  /* Range of revisions to dump and the number of revisions per task. */
+  svn_revnum_t start_rev;
+  svn_revnum_t end_rev;
+  svn_revnum_t range_size;
+
+  /* Sub-range of START_REV to END_REV to split into tasks in the current
+     batch. */
+  svn_revnum_t batch_start_rev;
+  svn_revnum_t batch_end_rev;
+
+  /* As passed to svn_repos_dump_fs5. */
+  svn_boolean_t incremental;
+  svn_boolean_t use_deltas;
+  svn_boolean_t include_revprops;
+  svn_boolean_t include_changes;
+  svn_repos_dump_filter_func_t filter_func;
+  void *filter_baton;
+  svn_mutex__t *filter_mutex;
+
+  /* The remainder is only being used by the output functions, i.e. in
+     the calling thread. */
+  svn_stream_t *stream;
+  svn_repos_notify_func_t notify_func;
+  void *notify_baton;
+  svn_boolean_t found_old_reference;
+  svn_boolean_t found_old_mergeinfo;
+} dump_params_t;
+
+/* Process baton of a task dumping revisions START_REV to END_REV. */
+typedef struct dump_range_t
+{
+  dump_params_t *params;
+  svn_revnum_t start_rev;
+  svn_revnum_t end_rev;
+} dump_range_t;
+
+/* Result of a task dumping a range of revisions. */
+typedef struct dump_range_result_t
+{
+  /* Temporary file containing the dump data. */
+  apr_file_t *file;
+
+  /* The svn_repos_notify_t * to send to the caller, in order. */
+  apr_array_header_t *notifications;
+
+  /* Pool to allocate the NOTIFICATIONS in. */
+  apr_pool_t *pool;
+
+  /* Warning flags collected while dumping the range. */
+  svn_boolean_t found_old_reference;
+  svn_boolean_t found_old_mergeinfo;
+} dump_range_result_t;
+
+/* Implements svn_repos_notify_func_t.  Store a copy of NOTIFY in the
+   dump_range_result_t BATON for later delivery by the output function. */
+static void
+record_notification(void *baton,
+                    const svn_repos_notify_t *notify,
+                    apr_pool_t *scratch_pool)
+{
+  dump_range_result_t *result = baton;
+  svn_repos_notify_t *copy = apr_pmemdup(result->pool, notify,
+                                         sizeof(*notify));
+
+  copy->warning_str = apr_pstrdup(result->pool, notify->warning_str);
+  copy->path = apr_pstrdup(result->pool, notify->path);
+  APR_ARRAY_PUSH(result->notifications, svn_repos_notify_t *) = copy;
+}
+
+/* Implements svn_task__thread_context_constructor_t.  Open the repository
+   given by the dump_params_t CONTEXT_BATON and return it in
+   *THREAD_CONTEXT. */
+static svn_error_t *
+open_dump_context(void **thread_context,
+                  void *context_baton,
+                  apr_pool_t *result_pool,
+                  apr_pool_t *scratch_pool)
+{
+  dump_params_t *params = context_baton;
+  svn_repos_t *repos;
+
+  SVN_ERR(svn_repos_open3(&repos, params->repos_path, params->fs_config,
+                          result_pool, scratch_pool));
+  *thread_context = repos;
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_task__process_func_t.  Dump the dump_range_t
+   PROCESS_BATON from the svn_repos_t THREAD_CONTEXT into a temporary
+   file and return it in a dump_range_result_t *RESULT. */
+static svn_error_t *
+dump_range_process(void **result,
+                   svn_task__t *task,
+                   void *thread_context,
+                   void *process_baton,
+                   svn_cancel_func_t cancel_func,
+                   void *cancel_baton,
+                   apr_pool_t *result_pool,
+                   apr_pool_t *scratch_pool)
+{
+  svn_repos_t *repos = thread_context;
+  dump_range_t *range = process_baton;
+  dump_params_t *params = range->params;
+  dump_range_result_t *range_result = apr_pcalloc(result_pool,
+                                                  sizeof(*range_result));
+  svn_repos_notify_func_t notify_func = params->notify_func
+                                      ? record_notification
+                                      : NULL;
+  svn_repos_authz_func_t authz_func = NULL;
+  dump_filter_baton_t authz_baton = {0};
+  apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+  svn_stream_t *stream;
+  svn_revnum_t rev;
+
+  if (params->filter_func)
+    {
+      authz_func = dump_filter_authz_func;
+      authz_baton.filter_func = params->filter_func;
+      authz_baton.filter_baton = params->filter_baton;
+      authz_baton.mutex = params->filter_mutex;
+    }
+
+  range_result->pool = result_pool;
+  range_result->notifications = apr_array_make(result_pool, 0,
+                                               sizeof(svn_repos_notify_t *));
+  SVN_ERR(svn_io_open_unique_file3(&range_result->file, NULL, NULL,
+                                   svn_io_file_del_on_pool_cleanup,
+                                   result_pool, scratch_pool));
+  stream = svn_stream_from_aprfile2(range_result->file, TRUE, scratch_pool);
+
+  for (rev = range->start_rev; rev <= range->end_rev; ++rev)
+    {
+      svn_pool_clear(iterpool);
+
+      if (cancel_func)
+        SVN_ERR(cancel_func(cancel_baton));
+
+      SVN_ERR(dump_revision(stream, repos, rev, params->start_rev,
+                            params->incremental, params->use_deltas,
+                            params->include_revprops,
+                            params->include_changes,
+                            &range_result->found_old_reference,
+                            &range_result->found_old_mergeinfo,
+                            notify_func, range_result,
+                            authz_func, &authz_baton, iterpool));
+
+      if (notify_func)
+        {
+          svn_repos_notify_t *notify
+            = svn_repos_notify_create(svn_repos_notify_dump_rev_end,
+                                      iterpool);
+          notify->revision = rev;
+          notify_func(range_result, notify, iterpool);
+        }
+    }
+
+  SVN_ERR(svn_stream_close(stream));
+  svn_pool_destroy(iterpool);
+
+  *result = range_result;
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_task__output_func_t.  Append the dump_range_result_t
+   RESULT to the output stream given by the dump_params_t OUTPUT_BATON
+   and deliver the notifications collected for it. */
+static svn_error_t *
+dump_range_output(svn_task__t *task,
+                  void *result,
+                  void *output_baton,
+                  svn_cancel_func_t cancel_func,
+                  void *cancel_baton,
+                  apr_pool_t *result_pool,
+                  apr_pool_t *scratch_pool)
+{
+  dump_range_result_t *range_result = result;
+  dump_params_t *params = output_baton;
+  apr_off_t offset = 0;
+  int i;
+
+  SVN_ERR(svn_io_file_seek(range_result->file, APR_SET, &offset,
+                           scratch_pool));
+  SVN_ERR(svn_stream_copy3(svn_stream_from_aprfile2(range_result->file,
+                                                    TRUE, scratch_pool),
+                           svn_stream_disown(params->stream, scratch_pool),
+                           cancel_func, cancel_baton, scratch_pool));
+
+  if (params->notify_func)
+    for (i = 0; i < range_result->notifications->nelts; ++i)
+      params->notify_func(params->notify_baton,
+                          APR_ARRAY_IDX(range_result->notifications, i,
+                                        svn_repos_notify_t *),
+                          scratch_pool);
+
+  params->found_old_reference |= range_result->found_old_reference;
+  params->found_old_mergeinfo |= range_result->found_old_mergeinfo;
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_task__process_func_t.  Root task of a parallel dump;
+   split the current batch of revisions given by the dump_params_t
+   PROCESS_BATON into sub-tasks. */
+static svn_error_t *
+dump_ranges_process(void **result,
+                    svn_task__t *task,
+                    void *thread_context,
+                    void *process_baton,
+                    svn_cancel_func_t cancel_func,
+                    void *cancel_baton,
+                    apr_pool_t *result_pool,
+                    apr_pool_t *scratch_pool)
+{
+  dump_params_t *params = process_baton;
+  svn_revnum_t rev;
+
+  for (rev = params->batch_start_rev;
+       rev <= params->batch_end_rev;
+       rev += params->range_size)
+    {
+      apr_pool_t *sub_task_pool = svn_task__create_process_pool(task);
+      dump_range_t *range = apr_pcalloc(sub_task_pool, sizeof(*range));
+
+      range->params = params;
+      range->start_rev = rev;
+      range->end_rev = MIN(rev + params->range_size - 1,
+                           params->batch_end_rev);
+
+      SVN_ERR(svn_task__add(task, sub_task_pool, NULL,
+                            dump_range_process, range,
+                            dump_range_output, params));
+    }
+
+  *result = NULL;
+  return SVN_NO_ERROR;
 }
 
 
 
 /* The main dumper. */
 svn_error_t *
-svn_repos_dump_fs4(svn_repos_t *repos,
+svn_repos_dump_fs5(svn_repos_t *repos,
                    svn_stream_t *stream,
                    svn_revnum_t start_rev,
                    svn_revnum_t end_rev,
@@ -2031,6 +2401,7 @@ svn_repos_dump_fs4(svn_repos_t *repos,
                    svn_boolean_t use_deltas,
                    svn_boolean_t include_revprops,
                    svn_boolean_t include_changes,
+                   int thread_count,
                    svn_repos_notify_func_t notify_func,
                    void *notify_baton,
                    svn_repos_dump_filter_func_t filter_func,
@@ -2039,8 +2410,6 @@ svn_repos_dump_fs4(svn_repos_t *repos,
                    void *cancel_baton,
                    apr_pool_t *pool)
 {
-  const svn_delta_editor_t *dump_editor;
-  void *dump_edit_baton = NULL;
   svn_revnum_t rev;
   svn_fs_t *fs = svn_repos_fs(repos);
   apr_pool_t *iterpool = svn_pool_create(pool);
@@ -2079,6 +2448,10 @@ svn_repos_dump_fs4(svn_repos_t *repos,
                              _("End revision %ld is invalid "
                                "(youngest revision is %ld)"),
                              end_rev, youngest);
+  if (thread_count < 1)
+    return svn_error_createf(SVN_ERR_INCORRECT_PARAMS, NULL,
+                             _("Invalid number of threads (%d)"),
+                             thread_count);
 
   /* We use read authz callback to implement dump filtering. If there is no
    * read access for some node, it will be excluded from dump as well as
@@ -2108,82 +2481,82 @@ svn_repos_dump_fs4(svn_repos_t *repos,
   SVN_ERR(svn_repos__dump_magic_header_record(stream, version, pool));
   SVN_ERR(svn_repos__dump_uuid_header_record(stream, uuid, pool));
 
-  /* Create a notify object that we can reuse in the loop. */
-  if (notify_func)
-    notify = svn_repos_notify_create(svn_repos_notify_dump_rev_end,
-                                     pool);
-
-  /* Main loop:  we're going to dump revision REV.  */
-  for (rev = start_rev; rev <= end_rev; rev++)
+  if (thread_count > 1 && end_rev > start_rev)
     {
-      svn_fs_root_t *to_root;
-      svn_boolean_t use_deltas_for_rev;
-
-      svn_pool_clear(iterpool);
-
-      /* Check for cancellation. */
-      if (cancel_func)
-        SVN_ERR(cancel_func(cancel_baton));
-
-      /* Write the revision record. */
-      SVN_ERR(write_revision_record(stream, repos, rev, include_revprops,
-                                    authz_func, &authz_baton, iterpool));
-
-      /* When dumping revision 0, we just write out the revision record.
-         The parser might want to use its properties.
-         If we don't want revision changes at all, skip in any case. */
-      if (rev == 0 || !include_changes)
-        goto loop_end;
-
-      /* Fetch the editor which dumps nodes to a file.  Regardless of
-         what we've been told, don't use deltas for the first rev of a
-         non-incremental dump. */
-      use_deltas_for_rev = use_deltas && (incremental || rev != start_rev);
-      SVN_ERR(get_dump_editor(&dump_editor, &dump_edit_baton, fs, rev,
-                              "", stream, &found_old_reference,
-                              &found_old_mergeinfo, NULL,
-                              notify_func, notify_baton,
-                              start_rev, use_deltas_for_rev, FALSE, FALSE,
-                              iterpool));
-
-      /* Drive the editor in one way or another. */
-      SVN_ERR(svn_fs_revision_root(&to_root, fs, rev, iterpool));
-
-      /* If this is the first revision of a non-incremental dump,
-         we're in for a full tree dump.  Otherwise, we want to simply
-         replay the revision.  */
-      if ((rev == start_rev) && (! incremental))
+      /* Apart from the warnings about references to revisions before
+       * START_REV, dumping a revision does not depend on what has been
+       * dumped before.  So, we can dump revision ranges independently
+       * and simply concatenate the results. */
+      dump_params_t params = { 0 };
+      svn_revnum_t range_size = (end_rev - start_rev + 1)
+                              / (thread_count * DUMP_RANGES_PER_THREAD);
+      svn_revnum_t batch_size;
+
+      params.repos_path = svn_repos_path(repos, pool);
+      params.fs_config = svn_fs_config(fs, pool);
+      params.start_rev = start_rev;
+      params.end_rev = end_rev;
+      params.range_size = MAX(1, MIN(range_size, MAX_DUMP_RANGE_SIZE));
+      params.incremental = incremental;
+      params.use_deltas = use_deltas;
+      params.include_revprops = include_revprops;
+      params.include_changes = include_changes;
+      params.filter_func = filter_func;
+      params.filter_baton = filter_baton;
+      params.stream = stream;
+      params.notify_func = notify_func;
+      params.notify_baton = notify_baton;
+      SVN_ERR(svn_mutex__init(&params.filter_mutex, TRUE, pool));
+
+      /* Limit the number of temporary files in flight and thus the disk
+       * space needed if STREAM is slower than the dump.  Each batch only
+       * starts after the previous one has been fully written to STREAM. */
+      batch_size = params.range_size * thread_count * DUMP_RANGES_PER_THREAD;
+      for (params.batch_start_rev = start_rev;
+           params.batch_start_rev <= end_rev;
+           params.batch_start_rev += batch_size)
         {
-          /* Compare against revision 0, so everything appears to be added. */
-          svn_fs_root_t *from_root;
-          SVN_ERR(svn_fs_revision_root(&from_root, fs, 0, iterpool));
-          SVN_ERR(svn_repos_dir_delta2(from_root, "", "",
-                                       to_root, "",
-                                       dump_editor, dump_edit_baton,
-                                       authz_func, &authz_baton,
-                                       FALSE, /* don't send text-deltas */
-                                       svn_depth_infinity,
-                                       FALSE, /* don't send entry props */
-                                       FALSE, /* don't ignore ancestry */
-                                       iterpool));
-        }
-      else
-        {
-          /* The normal case: compare consecutive revs. */
-          SVN_ERR(svn_repos_replay2(to_root, "", SVN_INVALID_REVNUM, FALSE,
-                                    dump_editor, dump_edit_baton,
-                                    authz_func, &authz_baton, iterpool));
-
-          /* While our editor close_edit implementation is a no-op, we still
-             do this for completeness. */
-          SVN_ERR(dump_editor->close_edit(dump_edit_baton, iterpool));
+          svn_pool_clear(iterpool);
+          params.batch_end_rev = MIN(params.batch_start_rev + batch_size - 1,
+                                     end_rev);
+
+          SVN_ERR(svn_task__run(thread_count,
+                                dump_ranges_process, &params, NULL, NULL,
+                                open_dump_context, &params,
+                                cancel_func, cancel_baton, pool, iterpool));
         }
 
-    loop_end:
+      found_old_reference = params.found_old_reference;
+      found_old_mergeinfo = params.found_old_mergeinfo;
+    }
+  else
+    {
+      /* Create a notify object that we can reuse in the loop. */
       if (notify_func)
+        notify = svn_repos_notify_create(svn_repos_notify_dump_rev_end,
+                                         pool);
+
+      /* Main loop:  we're going to dump revision REV.  */
+      for (rev = start_rev; rev <= end_rev; rev++)
         {
-          notify->revision = rev;
-          notify_func(notify_baton, notify, iterpool);
+          svn_pool_clear(iterpool);
+
+          /* Check for cancellation. */
+          if (cancel_func)
+            SVN_ERR(cancel_func(cancel_baton));
+
+          SVN_ERR(dump_revision(stream, repos, rev, start_rev, incremental,
+                                use_deltas, include_revprops,
+                                include_changes, &found_old_reference,
+                                &found_old_mergeinfo, notify_func,
+                                notify_baton, authz_func, &authz_baton,
+                                iterpool));
+
+          if (notify_func)
+            {
+              notify->revision = rev;
+              notify_func(notify_baton, notify, iterpool);
+            }
         }
     }
 
@@ -2225,7 +2598,6 @@ svn_repos_dump_fs4(svn_repos_t *repos,
   return SVN_NO_ERROR;
 }
 
-
 /*----------------------------------------------------------------------*/
 
 /* verify, based on dump */
@@ -439,6 +439,8 @@ svn_repos_fs_change_rev_prop4(svn_repos_t *repos,
       SVN_ERR(svn_fs_change_rev_prop2(repos->fs, rev, name,
                                       &old_value, new_value, pool));
 
+      svn_repos__report_cache_revprop_changed(repos, name, pool);
+
       if (use_post_revprop_change_hook)
         SVN_ERR(svn_repos__hooks_post_revprop_change(repos, hooks_env, rev,
                                                      author, name, old_value,
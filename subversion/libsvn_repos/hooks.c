@@ -28,6 +28,7 @@
 #include <apr_file_io.h>
 
 #include "svn_config.h"
+#include "svn_dso.h"
 #include "svn_hash.h"
 #include "svn_error.h"
 #include "svn_dirent_uri.h"
@@ -37,7 +38,9 @@
 #include "svn_utf.h"
 #include "repos.h"
 #include "svn_private_config.h"
+#include "private/svn_atomic.h"
 #include "private/svn_fs_private.h"
+#include "private/svn_mutex.h"
 #include "private/svn_repos_private.h"
 #include "private/svn_string_private.h"
 
@@ -445,6 +448,140 @@ svn_repos__parse_hooks_env(apr_hash_t **hooks_env_p,
   return SVN_NO_ERROR;
 }
 
+
+/*** In-process hook modules. ***/
+
+/* Evaluate to TRUE if the hook module structure MODULE is large enough
+   to contain MEMBER, i.e. if the module has been built against a version
+   of svn_repos_hook_module_t that has MEMBER. */
+#define HOOK_MODULE_HAS(module, member) \
+  ((module)->struct_size >= APR_OFFSETOF(svn_repos_hook_module_t, member) \
+                            + sizeof((module)->member))
+
+#if APR_HAS_DSO
+
+/* Map of module file name (const char *) to the svn_repos_hook_module_t
+   that it provides.  Like the modules themselves, this lives in the
+   global HOOK_MODULE_POOL and is serialized by HOOK_MODULE_MUTEX. */
+static apr_hash_t *hook_modules;
+static apr_pool_t *hook_module_pool;
+static svn_mutex__t *hook_module_mutex;
+static volatile svn_atomic_t hook_modules_initialized = 0;
+
+/* Implements svn_atomic__err_init_func_t. */
+static svn_error_t *
+init_hook_modules(void *baton,
+                  apr_pool_t *pool)
+{
+  hook_module_pool = svn_pool_create(NULL);
+  SVN_ERR(svn_mutex__init(&hook_module_mutex, TRUE, hook_module_pool));
+  hook_modules = apr_hash_make(hook_module_pool);
+
+  return SVN_NO_ERROR;
+}
+
+/* Set *MODULE to the hook module loaded from MODULE_PATH, loading and
+   initializing it, if this has not been done before.  Use POOL for
+   temporary allocations.  The caller must hold HOOK_MODULE_MUTEX. */
+static svn_error_t *
+get_hook_module(const svn_repos_hook_module_t **module,
+                const char *module_path,
+                apr_pool_t *pool)
+{
+  apr_dso_handle_t *dso;
+  apr_dso_handle_sym_t symbol;
+  apr_status_t status;
+  svn_repos_hook_module_init_t init_func;
+
+  *module = svn_hash_gets(hook_modules, module_path);
+  if (*module)
+    return SVN_NO_ERROR;
+
+  SVN_ERR(svn_dso_load(&dso, module_path));
+  if (!dso)
+    return svn_error_createf(SVN_ERR_REPOS_HOOK_FAILURE, NULL,
+                             _("Failed to load hook module '%s'"),
+                             svn_dirent_local_style(module_path, pool));
+
+  status = apr_dso_sym(&symbol, dso, SVN_REPOS_HOOK_MODULE_INIT_SYMBOL);
+  if (status)
+    return svn_error_wrap_apr(status, _("'%s' does not define '%s()'"),
+                              svn_dirent_local_style(module_path, pool),
+                              SVN_REPOS_HOOK_MODULE_INIT_SYMBOL);
+
+  init_func = (svn_repos_hook_module_init_t) symbol;
+  SVN_ERR(init_func(module, hook_module_pool));
+  if (!*module || (*module)->abi_version != SVN_REPOS_HOOK_MODULE_ABI_VERSION)
+    return svn_error_createf(SVN_ERR_REPOS_HOOK_FAILURE, NULL,
+                             _("Hook module '%s' does not support ABI "
+                               "version %d"),
+                             svn_dirent_local_style(module_path, pool),
+                             SVN_REPOS_HOOK_MODULE_ABI_VERSION);
+  if (!HOOK_MODULE_HAS(*module, struct_size))
+    return svn_error_createf(SVN_ERR_REPOS_HOOK_FAILURE, NULL,
+                             _("Hook module '%s' reports an invalid "
+                               "structure size of %" APR_SIZE_T_FMT),
+                             svn_dirent_local_style(module_path, pool),
+                             (*module)->struct_size);
+
+  svn_hash_sets(hook_modules, apr_pstrdup(hook_module_pool, module_path),
+                *module);
+
+  return SVN_NO_ERROR;
+}
+
+#endif /* APR_HAS_DSO */
+
+/* Set *MODULE to the in-process hook module that replaces the hook
+   program HOOK, i.e. the loadable module at HOOK plus
+   SVN_REPOS_HOOK_MODULE_EXT.  If there is no such module, set *MODULE
+   to NULL.  Use POOL for temporary allocations. */
+static svn_error_t *
+find_hook_module(const svn_repos_hook_module_t **module,
+                 const char *hook,
+                 apr_pool_t *pool)
+{
+  *module = NULL;
+
+#if APR_HAS_DSO
+  {
+    const char *module_path = apr_pstrcat(pool, hook,
+                                          SVN_REPOS_HOOK_MODULE_EXT,
+                                          SVN_VA_NULL);
+    svn_node_kind_t kind;
+
+    SVN_ERR(svn_io_check_resolved_path(module_path, &kind, pool));
+    if (kind != svn_node_file)
+      return SVN_NO_ERROR;
+
+    SVN_ERR(svn_atomic__init_once(&hook_modules_initialized,
+                                  init_hook_modules, NULL, pool));
+    SVN_MUTEX__WITH_LOCK(hook_module_mutex,
+                         get_hook_module(module, module_path, pool));
+  }
+#endif /* APR_HAS_DSO */
+
+  return SVN_NO_ERROR;
+}
+
+/* Return ERR, the result of running the hook NAME from a hook module,
+   wrapped such that it reads like a failure of a hook program.  If
+   ERR is SVN_NO_ERROR, return that. */
+static svn_error_t *
+hook_module_result(const char *name,
+                   svn_error_t *err)
+{
+  if (!err)
+    return SVN_NO_ERROR;
+
+  if (strcmp(name, SVN_REPOS__HOOK_POST_COMMIT) == 0)
+    return svn_error_createf(SVN_ERR_REPOS_HOOK_FAILURE, err,
+                             _("%s hook module failed"), name);
+
+  return svn_error_createf(SVN_ERR_REPOS_HOOK_FAILURE, err,
+                           _("Commit blocked by %s hook module"), name);
+}
+
 /* Return an error for the failure of HOOK due to a broken symlink. */
 static svn_error_t *
 hook_symlink_error(const char *hook)
@@ -463,9 +600,19 @@ svn_repos__hooks_start_commit(svn_repos_t *repos,
                               apr_pool_t *pool)
 {
   const char *hook = svn_repos_start_commit_hook(repos, pool);
+  const svn_repos_hook_module_t *module;
   svn_boolean_t broken_link;
 
-  if ((hook = check_hook_cmd(hook, &broken_link, pool)) && broken_link)
+  SVN_ERR(find_hook_module(&module, hook, pool));
+  if (module)
+    {
+      if (HOOK_MODULE_HAS(module, start_commit) && module->start_commit)
+        SVN_ERR(hook_module_result(SVN_REPOS__HOOK_START_COMMIT,
+                                   module->start_commit(repos, user,
+                                                        capabilities,
+                                                        txn_name, pool)));
+    }
+  else if ((hook = check_hook_cmd(hook, &broken_link, pool)) && broken_link)
     {
       return hook_symlink_error(hook);
     }
@@ -548,9 +695,33 @@ svn_repos__hooks_pre_commit(svn_repos_t *repos,
                             apr_pool_t *pool)
 {
   const char *hook = svn_repos_pre_commit_hook(repos, pool);
+  const svn_repos_hook_module_t *module;
   svn_boolean_t broken_link;
 
-  if ((hook = check_hook_cmd(hook, &broken_link, pool)) && broken_link)
+  SVN_ERR(find_hook_module(&module, hook, pool));
+  if (module)
+    {
+      if (HOOK_MODULE_HAS(module, pre_commit) && module->pre_commit)
+        {
+          svn_fs_txn_t *txn;
+          svn_fs_root_t *txn_root;
+          svn_fs_access_t *access_ctx;
+          apr_hash_t *lock_tokens;
+
+          SVN_ERR(svn_fs_open_txn(&txn, repos->fs, txn_name, pool));
+          SVN_ERR(svn_fs_txn_root(&txn_root, txn, pool));
+
+          SVN_ERR(svn_fs_get_access(&access_ctx, repos->fs));
+          lock_tokens = access_ctx
+                      ? svn_fs__access_get_lock_tokens(access_ctx)
+                      : apr_hash_make(pool);
+
+          SVN_ERR(hook_module_result(SVN_REPOS__HOOK_PRE_COMMIT,
+                                     module->pre_commit(repos, txn, txn_root,
+                                                        lock_tokens, pool)));
+        }
+    }
+  else if ((hook = check_hook_cmd(hook, &broken_link, pool)) && broken_link)
     {
       return hook_symlink_error(hook);
     }
@@ -594,9 +765,18 @@ svn_repos__hooks_post_commit(svn_repos_t *repos,
                              apr_pool_t *pool)
 {
   const char *hook = svn_repos_post_commit_hook(repos, pool);
+  const svn_repos_hook_module_t *module;
   svn_boolean_t broken_link;
 
-  if ((hook = check_hook_cmd(hook, &broken_link, pool)) && broken_link)
+  SVN_ERR(find_hook_module(&module, hook, pool));
+  if (module)
+    {
+      if (HOOK_MODULE_HAS(module, post_commit) && module->post_commit)
+        SVN_ERR(hook_module_result(SVN_REPOS__HOOK_POST_COMMIT,
+                                   module->post_commit(repos, rev, txn_name,
+                                                       pool)));
+    }
+  else if ((hook = check_hook_cmd(hook, &broken_link, pool)) && broken_link)
     {
       return hook_symlink_error(hook);
     }
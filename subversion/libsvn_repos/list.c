@@ -30,6 +30,7 @@
 
 #include "private/svn_repos_private.h"
 #include "private/svn_sorts_private.h"
+#include "private/svn_task.h"
 #include "private/svn_utf_private.h"
 #include "svn_private_config.h" /* for SVN_TEMPLATE_ROOT_DIR */
 
@@ -37,33 +38,49 @@
 
 
 
-/* Utility function.  Given DIRENT->KIND, set all other elements of *DIRENT
- * with the values retrieved for PATH under ROOT.  Allocate them in POOL.
+/* Utility function.  Given DIRENT->KIND, set those other elements of
+ * *DIRENT that are selected by DIRENT_FIELDS with the values retrieved
+ * for PATH under ROOT.  Allocate them in POOL.
  */
 static svn_error_t *
 fill_dirent(svn_dirent_t *dirent,
             svn_fs_root_t *root,
             const char *path,
+            apr_uint32_t dirent_fields,
             apr_pool_t *scratch_pool)
 {
   const char *datestring;
 
-  if (dirent->kind == svn_node_file)
-    SVN_ERR(svn_fs_file_length(&(dirent->size), root, path, scratch_pool));
-  else
-    dirent->size = SVN_INVALID_FILESIZE;
-
-  SVN_ERR(svn_fs_node_has_props(&dirent->has_props, root, path,
-                                scratch_pool));
+  if (dirent_fields & SVN_DIRENT_SIZE)
+    {
+      if (dirent->kind == svn_node_file)
+        SVN_ERR(svn_fs_file_length(&(dirent->size), root, path,
+                                   scratch_pool));
+      else
+        dirent->size = SVN_INVALID_FILESIZE;
+    }
 
-  SVN_ERR(svn_repos_get_committed_info(&(dirent->created_rev),
-                                       &datestring,
-                                       &(dirent->last_author),
-                                       root, path, scratch_pool));
-  if (datestring)
-    SVN_ERR(svn_time_from_cstring(&(dirent->time), datestring,
+  if (dirent_fields & SVN_DIRENT_HAS_PROPS)
+    SVN_ERR(svn_fs_node_has_props(&dirent->has_props, root, path,
                                   scratch_pool));
 
+  /* Only author and date require the revprops to be read. */
+  if (dirent_fields & (SVN_DIRENT_TIME | SVN_DIRENT_LAST_AUTHOR))
+    {
+      SVN_ERR(svn_repos_get_committed_info(&(dirent->created_rev),
+                                           &datestring,
+                                           &(dirent->last_author),
+                                           root, path, scratch_pool));
+      if (datestring)
+        SVN_ERR(svn_time_from_cstring(&(dirent->time), datestring,
+                                      scratch_pool));
+    }
+  else if (dirent_fields & SVN_DIRENT_CREATED_REV)
+    {
+      SVN_ERR(svn_fs_node_created_rev(&(dirent->created_rev), root, path,
+                                      scratch_pool));
+    }
+
   return SVN_NO_ERROR;
 }
 
@@ -87,7 +104,7 @@ svn_repos_stat(svn_dirent_t **dirent,
   ent = svn_dirent_create(pool);
   ent->kind = kind;
 
-  SVN_ERR(fill_dirent(ent, root, path, pool));
+  SVN_ERR(fill_dirent(ent, root, path, SVN_DIRENT_ALL, pool));
 
   *dirent = ent;
   return SVN_NO_ERROR;
@@ -108,8 +125,8 @@ matches_any(const char *dirname,
 
 /* Utility to prevent code duplication.
  *
- * Construct a svn_dirent_t for PATH of type KIND under ROOT and, if
- * PATH_INFO_ONLY is not set, fill it.  Call RECEIVER with the result
+ * Construct a svn_dirent_t for PATH of type KIND under ROOT and fill
+ * the elements selected by DIRENT_FIELDS.  Call RECEIVER with the result
  * and RECEIVER_BATON.
  *
  * Use SCRATCH_POOL for temporary allocations.
@@ -118,7 +135,7 @@ static svn_error_t *
 report_dirent(svn_fs_root_t *root,
               const char *path,
               svn_node_kind_t kind,
-              svn_boolean_t path_info_only,
+              apr_uint32_t dirent_fields,
               svn_repos_dirent_receiver_t receiver,
               void *receiver_baton,
               apr_pool_t *scratch_pool)
@@ -127,8 +144,7 @@ report_dirent(svn_fs_root_t *root,
 
   /* Fetch the details to report - if required. */
   dirent.kind = kind;
-  if (!path_info_only)
-    SVN_ERR(fill_dirent(&dirent, root, path, scratch_pool));
+  SVN_ERR(fill_dirent(&dirent, root, path, dirent_fields, scratch_pool));
 
   /* Report the entry. */
   SVN_ERR(receiver(path, &dirent, receiver_baton, scratch_pool));
@@ -158,49 +174,38 @@ compare_filtered_dirent(const void *lhs,
   return strcmp(lhs_dirent->dirent->name, rhs_dirent->dirent->name);
 }
 
-/* Core of svn_repos_list with the same parameter list.
+/* Fetch all directory entries of PATH under ROOT, filter them according
+ * to DEPTH and PATTERNS and return them sorted by name as an array of
+ * filtered_dirent_t in *SORTED.  Entries that need to be recursed into
+ * but that don't match PATTERNS themselves are included as well.
  *
- * However, DEPTH is not svn_depth_empty and PATH has already been reported.
- * Therefore, we can call this recursively.
+ * Performance trade-off:
+ * Constructing a full path vs. faster sort due to authz filtering.
+ * We filter according to DEPTH and PATTERNS only because constructing
+ * the full path required for authz is somewhat expensive and we don't
+ * want to do this twice while authz will rarely filter paths out.
  *
- * Uses SCRATCH_BUFFER for temporary string contents.
+ * Uses SCRATCH_BUFFER for temporary string contents.  Allocate the
+ * result in RESULT_POOL.
  */
 static svn_error_t *
-do_list(svn_fs_root_t *root,
-        const char *path,
-        const apr_array_header_t *patterns,
-        svn_depth_t depth,
-        svn_boolean_t path_info_only,
-        svn_repos_authz_func_t authz_read_func,
-        void *authz_read_baton,
-        svn_repos_dirent_receiver_t receiver,
-        void *receiver_baton,
-        svn_cancel_func_t cancel_func,
-        void *cancel_baton,
-        svn_membuf_t *scratch_buffer,
-        apr_pool_t *scratch_pool)
+get_filtered_entries(apr_array_header_t **sorted,
+                     svn_fs_root_t *root,
+                     const char *path,
+                     const apr_array_header_t *patterns,
+                     svn_depth_t depth,
+                     svn_membuf_t *scratch_buffer,
+                     apr_pool_t *result_pool)
 {
   apr_hash_t *entries;
-  apr_pool_t *iterpool = svn_pool_create(scratch_pool);
   apr_hash_index_t *hi;
-  apr_array_header_t *sorted;
-  int i;
 
-  /* Fetch all directory entries, filter and sort them.
-   *
-   * Performance trade-off:
-   * Constructing a full path vs. faster sort due to authz filtering.
-   * We filter according to DEPTH and PATTERNS only because constructing
-   * the full path required for authz is somewhat expensive and we don't
-   * want to do this twice while authz will rarely filter paths out.
-   */
-  SVN_ERR(svn_fs_dir_entries(&entries, root, path, scratch_pool));
-  sorted = apr_array_make(scratch_pool, apr_hash_count(entries),
-                          sizeof(filtered_dirent_t));
-  for (hi = apr_hash_first(scratch_pool, entries); hi; hi = apr_hash_next(hi))
+  SVN_ERR(svn_fs_dir_entries(&entries, root, path, result_pool));
+  *sorted = apr_array_make(result_pool, apr_hash_count(entries),
+                           sizeof(filtered_dirent_t));
+  for (hi = apr_hash_first(result_pool, entries); hi; hi = apr_hash_next(hi))
     {
       filtered_dirent_t filtered;
-      svn_pool_clear(iterpool);
 
       filtered.dirent = apr_hash_this_val(hi);
 
@@ -214,10 +219,43 @@ do_list(svn_fs_root_t *root,
       if (!filtered.is_match && filtered.dirent->kind == svn_node_file)
         continue;
 
-      APR_ARRAY_PUSH(sorted, filtered_dirent_t) = filtered;
+      APR_ARRAY_PUSH(*sorted, filtered_dirent_t) = filtered;
     }
 
-  svn_sort__array(sorted, compare_filtered_dirent);
+  svn_sort__array(*sorted, compare_filtered_dirent);
+
+  return SVN_NO_ERROR;
+}
+
+/* Core of svn_repos_list2 with the same parameter list, except for
+ * THREAD_COUNT.
+ *
+ * However, DEPTH is not svn_depth_empty and PATH has already been reported.
+ * Therefore, we can call this recursively.
+ *
+ * Uses SCRATCH_BUFFER for temporary string contents.
+ */
+static svn_error_t *
+do_list(svn_fs_root_t *root,
+        const char *path,
+        const apr_array_header_t *patterns,
+        svn_depth_t depth,
+        apr_uint32_t dirent_fields,
+        svn_repos_authz_func_t authz_read_func,
+        void *authz_read_baton,
+        svn_repos_dirent_receiver_t receiver,
+        void *receiver_baton,
+        svn_cancel_func_t cancel_func,
+        void *cancel_baton,
+        svn_membuf_t *scratch_buffer,
+        apr_pool_t *scratch_pool)
+{
+  apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+  apr_array_header_t *sorted;
+  int i;
+
+  SVN_ERR(get_filtered_entries(&sorted, root, path, patterns, depth,
+                               scratch_buffer, scratch_pool));
 
   /* Iterate over all remaining directory entries and report them.
    * Recurse into sub-directories if requested. */
@@ -245,7 +283,7 @@ do_list(svn_fs_root_t *root,
 
       /* Report entry, if it passed the filter. */
       if (filtered->is_match)
-        SVN_ERR(report_dirent(root, sub_path, dirent->kind, path_info_only,
+        SVN_ERR(report_dirent(root, sub_path, dirent->kind, dirent_fields,
                               receiver, receiver_baton, iterpool));
 
       /* Check for cancellation before recursing down.  This should be
@@ -256,7 +294,7 @@ do_list(svn_fs_root_t *root,
       /* Recurse on directories. */
       if (depth == svn_depth_infinity && dirent->kind == svn_node_dir)
         SVN_ERR(do_list(root, sub_path, patterns, svn_depth_infinity,
-                        path_info_only, authz_read_func, authz_read_baton,
+                        dirent_fields, authz_read_func, authz_read_baton,
                         receiver, receiver_baton, cancel_func,
                         cancel_baton, scratch_buffer, iterpool));
     }
@@ -266,19 +304,324 @@ do_list(svn_fs_root_t *root,
   return SVN_NO_ERROR;
 }
 
+/* Parameters shared by all tasks of a concurrent svn_repos_list2 run. */
+typedef struct list_params_t
+{
+  /* To open the filesystem root in each worker thread. */
+  const char *fs_path;
+  apr_hash_t *fs_config;
+  svn_revnum_t revision;
+  const char *txn_name;
+
+  /* As passed to svn_repos_list2. */
+  svn_fs_root_t *root;
+  const apr_array_header_t *patterns;
+  apr_uint32_t dirent_fields;
+  svn_repos_authz_func_t authz_read_func;
+  void *authz_read_baton;
+  svn_repos_dirent_receiver_t receiver;
+  void *receiver_baton;
+} list_params_t;
+
+/* A directory being listed by a list_dir_process task. */
+typedef struct list_dir_t
+{
+  /* Full path of the directory. */
+  const char *path;
+
+  list_params_t *params;
+} list_dir_t;
+
+/* A directory entry found by list_dir_process. */
+typedef struct list_entry_t
+{
+  /* Full path of the entry. */
+  const char *path;
+
+  /* The filled-in dirent to report.  NULL if the entry does not match
+   * the patterns and is only listed here to recurse into it. */
+  svn_dirent_t *dirent;
+
+  /* TRUE for directories to recurse into. */
+  svn_boolean_t is_dir;
+
+  /* Set by list_dir_output, i.e. in the calling thread. */
+  svn_boolean_t has_access;
+
+  /* For directories: the baton of the sub-task listing it.  Lives with
+   * the parent's result until the sub-task has been output. */
+  list_dir_t sub_dir;
+} list_entry_t;
+
+/* The result of a list_dir_process task. */
+typedef struct list_dir_result_t
+{
+  /* All entries of the directory as list_entry_t, in reporting order. */
+  apr_array_header_t *entries;
+
+  /* Index of the first entry not reported yet. */
+  int next;
+
+  /* TRUE once the authz checks have been run and the sub-tasks for the
+   * accessible sub-directories have been added. */
+  svn_boolean_t checked;
+} list_dir_result_t;
+
+/* Implements svn_task__thread_context_constructor_t.  Open the root
+ * given by the list_params_t CONTEXT_BATON in a new filesystem instance
+ * and return it in *THREAD_CONTEXT. */
+static svn_error_t *
+open_list_context(void **thread_context,
+                  void *context_baton,
+                  apr_pool_t *result_pool,
+                  apr_pool_t *scratch_pool)
+{
+  list_params_t *params = context_baton;
+  svn_fs_t *fs;
+  svn_fs_root_t *root;
+
+  SVN_ERR(svn_fs_open2(&fs, params->fs_path, params->fs_config, result_pool,
+                       scratch_pool));
+  if (params->txn_name)
+    {
+      svn_fs_txn_t *txn;
+      SVN_ERR(svn_fs_open_txn(&txn, fs, params->txn_name, result_pool));
+      SVN_ERR(svn_fs_txn_root(&root, txn, result_pool));
+    }
+  else
+    {
+      SVN_ERR(svn_fs_revision_root(&root, fs, params->revision,
+                                   result_pool));
+    }
+
+  *thread_context = root;
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+list_dir_process(void **result,
+                 svn_task__t *task,
+                 void *thread_context,
+                 void *process_baton,
+                 svn_cancel_func_t cancel_func,
+                 void *cancel_baton,
+                 apr_pool_t *result_pool,
+                 apr_pool_t *scratch_pool);
+
+/* Implements svn_task__output_func_t.  Report the entries of the
+ * list_dir_result_t RESULT of the list_dir_t OUTPUT_BATON.
+ *
+ * The first call checks read access for all entries and adds a sub-task
+ * for each accessible sub-directory, with RESULT as partial output.  So,
+ * denied sub-trees never get queued.  Each call then reports the entries
+ * up to and including the next sub-directory that got queued, i.e. this
+ * gets called again before each sub-task's output and once more after
+ * the last one. */
+static svn_error_t *
+list_dir_output(svn_task__t *task,
+                void *result,
+                void *output_baton,
+                svn_cancel_func_t cancel_func,
+                void *cancel_baton,
+                apr_pool_t *result_pool,
+                apr_pool_t *scratch_pool)
+{
+  list_dir_result_t *dir_result = result;
+  apr_array_header_t *entries = dir_result->entries;
+  list_dir_t *dir = output_baton;
+  list_params_t *params = dir->params;
+  apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+  svn_boolean_t queued = FALSE;
+  int i;
+
+  if (!dir_result->checked)
+    {
+      dir_result->checked = TRUE;
+      for (i = 0; i < entries->nelts; ++i)
+        {
+          list_entry_t *entry = &APR_ARRAY_IDX(entries, i, list_entry_t);
+
+          svn_pool_clear(iterpool);
+
+          entry->has_access = TRUE;
+          if (params->authz_read_func)
+            SVN_ERR(params->authz_read_func(&entry->has_access,
+                                            params->root, entry->path,
+                                            params->authz_read_baton,
+                                            iterpool));
+
+          if (entry->is_dir && entry->has_access)
+            {
+              apr_pool_t *sub_task_pool
+                = svn_task__create_process_pool(task);
+
+              entry->sub_dir.path = entry->path;
+              entry->sub_dir.params = params;
+
+              SVN_ERR(svn_task__add(task, sub_task_pool, dir_result,
+                                    list_dir_process, &entry->sub_dir,
+                                    list_dir_output, &entry->sub_dir));
+              queued = TRUE;
+            }
+        }
+
+      /* Report everything before the first sub-task's output. */
+      if (queued)
+        {
+          svn_pool_destroy(iterpool);
+          return SVN_NO_ERROR;
+        }
+    }
+
+  for (i = dir_result->next; i < entries->nelts; ++i)
+    {
+      list_entry_t *entry = &APR_ARRAY_IDX(entries, i, list_entry_t);
+
+      svn_pool_clear(iterpool);
+
+      if (entry->has_access && entry->dirent)
+        SVN_ERR(params->receiver(entry->path, entry->dirent,
+                                 params->receiver_baton, iterpool));
+
+      /* The sub-directory's contents must be reported right after the
+       * sub-directory itself. */
+      if (entry->is_dir && entry->has_access)
+        {
+          ++i;
+          break;
+        }
+    }
+
+  dir_result->next = i;
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_task__process_func_t.  List the list_dir_t PROCESS_BATON
+ * under the svn_fs_root_t THREAD_CONTEXT and return the entries as a
+ * list_dir_result_t in *RESULT.
+ *
+ * All the FS access happens here but no authz checks, which are left to
+ * list_dir_output in the calling thread.  That is also where sub-tasks
+ * for the sub-directories get added, once we know they may be read. */
+static svn_error_t *
+list_dir_process(void **result,
+                 svn_task__t *task,
+                 void *thread_context,
+                 void *process_baton,
+                 svn_cancel_func_t cancel_func,
+                 void *cancel_baton,
+                 apr_pool_t *result_pool,
+                 apr_pool_t *scratch_pool)
+{
+  svn_fs_root_t *root = thread_context;
+  list_dir_t *dir = process_baton;
+  list_params_t *params = dir->params;
+  apr_array_header_t *sorted;
+  list_dir_result_t *dir_result;
+  svn_membuf_t scratch_buffer;
+  int i;
+
+  svn_membuf__create(&scratch_buffer, 256, scratch_pool);
+  SVN_ERR(get_filtered_entries(&sorted, root, dir->path, params->patterns,
+                               svn_depth_infinity, &scratch_buffer,
+                               scratch_pool));
+
+  dir_result = apr_pcalloc(result_pool, sizeof(*dir_result));
+  dir_result->entries = apr_array_make(result_pool, sorted->nelts,
+                                       sizeof(list_entry_t));
+  for (i = 0; i < sorted->nelts; ++i)
+    {
+      filtered_dirent_t *filtered;
+      list_entry_t *entry;
+
+      if (cancel_func)
+        SVN_ERR(cancel_func(cancel_baton));
+
+      filtered = &APR_ARRAY_IDX(sorted, i, filtered_dirent_t);
+      entry = apr_array_push(dir_result->entries);
+      entry->path = svn_dirent_join(dir->path, filtered->dirent->name,
+                                    result_pool);
+      entry->dirent = NULL;
+      entry->is_dir = (filtered->dirent->kind == svn_node_dir);
+      entry->has_access = FALSE;
+      entry->sub_dir.path = NULL;
+      entry->sub_dir.params = NULL;
+
+      if (filtered->is_match)
+        {
+          entry->dirent = apr_pcalloc(result_pool, sizeof(*entry->dirent));
+          entry->dirent->kind = filtered->dirent->kind;
+          SVN_ERR(fill_dirent(entry->dirent, root, entry->path,
+                              params->dirent_fields, result_pool));
+        }
+    }
+
+  *result = dir_result->entries->nelts ? dir_result : NULL;
+  return SVN_NO_ERROR;
+}
+
+/* Like do_list but walk the sub-trees with up to THREAD_COUNT worker
+ * threads.  DEPTH is svn_depth_infinity. */
+static svn_error_t *
+do_list_concurrently(svn_fs_root_t *root,
+                     const char *path,
+                     const apr_array_header_t *patterns,
+                     apr_uint32_t dirent_fields,
+                     int thread_count,
+                     svn_repos_authz_func_t authz_read_func,
+                     void *authz_read_baton,
+                     svn_repos_dirent_receiver_t receiver,
+                     void *receiver_baton,
+                     svn_cancel_func_t cancel_func,
+                     void *cancel_baton,
+                     apr_pool_t *scratch_pool)
+{
+  list_params_t params = { 0 };
+  list_dir_t dir = { 0 };
+  svn_fs_t *fs = svn_fs_root_fs(root);
+
+  params.fs_path = svn_fs_path(fs, scratch_pool);
+  params.fs_config = svn_fs_config(fs, scratch_pool);
+  if (svn_fs_is_txn_root(root))
+    params.txn_name = svn_fs_txn_root_name(root, scratch_pool);
+  else
+    params.revision = svn_fs_revision_root_revision(root);
+
+  params.root = root;
+  params.patterns = patterns;
+  params.dirent_fields = dirent_fields;
+  params.authz_read_func = authz_read_func;
+  params.authz_read_baton = authz_read_baton;
+  params.receiver = receiver;
+  params.receiver_baton = receiver_baton;
+
+  dir.path = path;
+  dir.params = &params;
+
+  return svn_error_trace(svn_task__run(thread_count,
+                                       list_dir_process, &dir,
+                                       list_dir_output, &dir,
+                                       open_list_context, &params,
+                                       cancel_func, cancel_baton,
+                                       scratch_pool, scratch_pool));
+}
+
 svn_error_t *
-svn_repos_list(svn_fs_root_t *root,
-               const char *path,
-               const apr_array_header_t *patterns,
-               svn_depth_t depth,
-               svn_boolean_t path_info_only,
-               svn_repos_authz_func_t authz_read_func,
-               void *authz_read_baton,
-               svn_repos_dirent_receiver_t receiver,
-               void *receiver_baton,
-               svn_cancel_func_t cancel_func,
-               void *cancel_baton,
-               apr_pool_t *scratch_pool)
+svn_repos_list2(svn_fs_root_t *root,
+                const char *path,
+                const apr_array_header_t *patterns,
+                svn_depth_t depth,
+                apr_uint32_t dirent_fields,
+                int thread_count,
+                svn_repos_authz_func_t authz_read_func,
+                void *authz_read_baton,
+                svn_repos_dirent_receiver_t receiver,
+                void *receiver_baton,
+                svn_cancel_func_t cancel_func,
+                void *cancel_baton,
+                apr_pool_t *scratch_pool)
 {
   svn_membuf_t scratch_buffer;
 
@@ -287,6 +630,15 @@ svn_repos_list(svn_fs_root_t *root,
   if (depth < svn_depth_empty)
     return svn_error_createf(SVN_ERR_REPOS_BAD_ARGS, NULL,
                              "Invalid depth '%d' in svn_repos_list", depth);
+  if (thread_count < 1)
+    return svn_error_createf(SVN_ERR_INCORRECT_PARAMS, NULL,
+                             _("Invalid number of threads (%d)"),
+                             thread_count);
+
+  /* Special case: Empty pattern list.
+   * We don't want the server to waste time here, not even on FS lookups. */
+  if (patterns && patterns->nelts == 0)
+    return SVN_NO_ERROR;
 
   /* Do we have access this sub-tree? */
   if (authz_read_func)
@@ -314,11 +666,6 @@ svn_repos_list(svn_fs_root_t *root,
                                _("Path '%s' not found"), path);
     }
 
-  /* Special case: Empty pattern list.
-   * We don't want the server to waste time here. */
-  if (patterns && patterns->nelts == 0)
-    return SVN_NO_ERROR;
-
   /* We need a scratch buffer for temporary string data.
    * Create one with a reasonable initial size. */
   svn_membuf__create(&scratch_buffer, 256, scratch_pool);
@@ -326,13 +673,19 @@ svn_repos_list(svn_fs_root_t *root,
   /* Actually report PATH, if it passes the filters. */
   if (matches_any(svn_dirent_basename(path, scratch_pool), patterns,
                   &scratch_buffer))
-    SVN_ERR(report_dirent(root, path, kind, path_info_only,
+    SVN_ERR(report_dirent(root, path, kind, dirent_fields,
                           receiver, receiver_baton, scratch_pool));
 
-  /* Report directory contents if requested. */
-  if (depth > svn_depth_empty)
+  /* Report directory contents if requested.  Only full recursion has
+   * enough sub-trees to be worth distributing over multiple threads. */
+  if (depth == svn_depth_infinity && thread_count > 1)
+    SVN_ERR(do_list_concurrently(root, path, patterns, dirent_fields,
+                                 thread_count, authz_read_func,
+                                 authz_read_baton, receiver, receiver_baton,
+                                 cancel_func, cancel_baton, scratch_pool));
+  else if (depth > svn_depth_empty)
     SVN_ERR(do_list(root, path, patterns, depth,
-                    path_info_only, authz_read_func, authz_read_baton,
+                    dirent_fields, authz_read_func, authz_read_baton,
                     receiver, receiver_baton, cancel_func, cancel_baton,
                     &scratch_buffer, scratch_pool));
 
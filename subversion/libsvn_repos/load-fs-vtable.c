@@ -34,16 +34,27 @@
 #include "svn_mergeinfo.h"
 #include "svn_checksum.h"
 #include "svn_subst.h"
+#include "svn_sorts.h"
 #include "svn_dirent_uri.h"
 
 #include <apr_lib.h>
 
 #include "private/svn_fspath.h"
 #include "private/svn_dep_compat.h"
+#include "private/svn_fs_private.h"
 #include "private/svn_mergeinfo_private.h"
 #include "private/svn_repos_private.h"
+#include "private/svn_string_private.h"
 #include "private/svn_subr_private.h"
 
+/* Files larger than this will not be collected in memory for a batched
+   update but get streamed into the txn directly. */
+#define MAX_BATCHED_TEXT_SIZE  0x400000
+
+/* Apply the batched file contents of a revision once their total size
+   exceeds this. */
+#define MAX_TEXT_BATCH_SIZE    0x4000000
+
 /*----------------------------------------------------------------------*/
 
 /** Batons used herein **/
@@ -66,6 +77,13 @@ struct parse_baton
   apr_pool_t *notify_pool; /* scratch pool for notifications */
   apr_pool_t *pool;
 
+  /* Maximum number of threads to use when applying file contents.
+     If this is 1, file contents will not be batched. */
+  int thread_count;
+
+  svn_cancel_func_t cancel_func;
+  void *cancel_baton;
+
   /* Start and end (inclusive) of revision range we'll pay attention
      to, or a pair of SVN_INVALID_REVNUMs if we're not filtering by
      revisions. */
@@ -108,6 +126,14 @@ struct revision_baton
   /* Array of svn_prop_t with revision properties. */
   apr_array_header_t *revprops;
 
+  /* File contents (svn_fs__text_t *) yet to be applied to
+     TXN_ROOT in one batch, their paths (mapped to themselves) and their
+     total size.  All allocated in TEXTS_POOL.  NULL until first used. */
+  apr_array_header_t *texts;
+  apr_hash_t *text_paths;
+  apr_size_t texts_size;
+  apr_pool_t *texts_pool;
+
   struct parse_baton *pb;
   apr_pool_t *pool;
 };
@@ -179,9 +205,12 @@ change_rev_prop(svn_repos_t *repos,
     return svn_repos_fs_change_rev_prop4(repos, revision, NULL, name,
                                          NULL, value, FALSE, FALSE,
                                          NULL, NULL, pool);
-  else
-    return svn_fs_change_rev_prop2(svn_repos_fs(repos), revision, name,
-                                   NULL, value, pool);
+
+  SVN_ERR(svn_fs_change_rev_prop2(svn_repos_fs(repos), revision, name,
+                                  NULL, value, pool));
+  svn_repos__report_cache_revprop_changed(repos, name, pool);
+
+  return SVN_NO_ERROR;
 }
 
 /* Change property NAME to VALUE for PATH in TXN_ROOT.
@@ -665,6 +694,128 @@ uuid_record(const char *uuid,
   return svn_fs_set_uuid(pb->fs, uuid, pool);
 }
 
+/* Apply all file contents batched in RB to its txn and empty the batch.
+ * Use SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+flush_texts(struct revision_baton *rb,
+            apr_pool_t *scratch_pool)
+{
+  struct parse_baton *pb = rb->pb;
+
+  if (!rb->texts || rb->texts->nelts == 0)
+    return SVN_NO_ERROR;
+
+  SVN_ERR(svn_fs__apply_texts(rb->txn_root, rb->texts, pb->thread_count,
+                              pb->cancel_func, pb->cancel_baton,
+                              scratch_pool));
+
+  svn_pool_clear(rb->texts_pool);
+  rb->texts = apr_array_make(rb->texts_pool, 16,
+                             sizeof(svn_fs__text_t *));
+  rb->text_paths = apr_hash_make(rb->texts_pool);
+  rb->texts_size = 0;
+
+  return SVN_NO_ERROR;
+}
+
+/* Baton for the streams returned by make_batched_text_stream(). */
+struct batched_text_baton
+{
+  struct node_baton *nb;
+
+  /* Contents collected so far. */
+  svn_stringbuf_t *buffer;
+
+  /* Once the contents turn out to be too large to be batched, this is
+     where they will be written to instead of BUFFER. */
+  svn_stream_t *direct;
+};
+
+/* Implements svn_write_fn_t for batched_text_baton. */
+static svn_error_t *
+batched_text_write(void *baton,
+                   const char *data,
+                   apr_size_t *len)
+{
+  struct batched_text_baton *tb = baton;
+  struct node_baton *nb = tb->nb;
+
+  if (!tb->direct && tb->buffer->len + *len > MAX_BATCHED_TEXT_SIZE)
+    {
+      /* Too large.  The path is not part of the current batch, so we can
+         simply stream the contents into the txn as usual. */
+      apr_size_t buffered = tb->buffer->len;
+
+      SVN_ERR(svn_fs_apply_text(&tb->direct, nb->rb->txn_root, nb->path,
+                                svn_checksum_to_cstring(nb->result_checksum,
+                                                        nb->pool),
+                                nb->pool));
+      SVN_ERR(svn_stream_write(tb->direct, tb->buffer->data, &buffered));
+    }
+
+  if (tb->direct)
+    return svn_error_trace(svn_stream_write(tb->direct, data, len));
+
+  svn_stringbuf_appendbytes(tb->buffer, data, *len);
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_close_fn_t for batched_text_baton. */
+static svn_error_t *
+batched_text_close(void *baton)
+{
+  struct batched_text_baton *tb = baton;
+  struct node_baton *nb = tb->nb;
+  struct revision_baton *rb = nb->rb;
+  svn_fs__text_t *text;
+
+  if (tb->direct)
+    return svn_error_trace(svn_stream_close(tb->direct));
+
+  text = apr_pcalloc(rb->texts_pool, sizeof(*text));
+  text->path = apr_pstrdup(rb->texts_pool, nb->path);
+  text->contents = svn_stringbuf__morph_into_string(tb->buffer);
+  text->result_checksum = svn_checksum_dup(nb->result_checksum,
+                                           rb->texts_pool);
+
+  APR_ARRAY_PUSH(rb->texts, svn_fs__text_t *) = text;
+  svn_hash_sets(rb->text_paths, text->path, text->path);
+  rb->texts_size += text->contents->len;
+
+  if (rb->texts_size > MAX_TEXT_BATCH_SIZE)
+    SVN_ERR(flush_texts(rb, nb->pool));
+
+  return SVN_NO_ERROR;
+}
+
+/* Return a stream that collects the new contents of the file in NB and
+ * adds them to the batch of its revision upon close.  Allocate it in
+ * NB->pool. */
+static svn_stream_t *
+make_batched_text_stream(struct node_baton *nb)
+{
+  struct revision_baton *rb = nb->rb;
+  struct batched_text_baton *tb = apr_pcalloc(nb->pool, sizeof(*tb));
+  svn_stream_t *stream;
+
+  if (!rb->texts)
+    {
+      rb->texts_pool = svn_pool_create(rb->pool);
+      rb->texts = apr_array_make(rb->texts_pool, 16,
+                                 sizeof(svn_fs__text_t *));
+      rb->text_paths = apr_hash_make(rb->texts_pool);
+    }
+
+  tb->nb = nb;
+  tb->buffer = svn_stringbuf_create_empty(rb->texts_pool);
+
+  stream = svn_stream_create(tb, nb->pool);
+  svn_stream_set_write(stream, batched_text_write);
+  svn_stream_set_close(stream, batched_text_close);
+
+  return stream;
+}
+
 static svn_error_t *
 new_node_record(void **node_baton,
                 apr_hash_t *headers,
@@ -708,6 +859,14 @@ new_node_record(void **node_baton,
       svn_pool_clear(pb->notify_pool);
     }
 
+  /* Batched file contents must be in the txn before we delete anything
+     or touch the same path again. */
+  if (rb->texts
+      && (nb->action == svn_node_action_delete
+          || nb->action == svn_node_action_replace
+          || svn_hash_gets(rb->text_paths, nb->path)))
+    SVN_ERR(flush_texts(rb, pool));
+
   switch (nb->action)
     {
     case svn_node_action_change:
@@ -950,6 +1109,40 @@ apply_textdelta(svn_txdelta_window_handler_t *handler,
       return SVN_NO_ERROR;
     }
 
+  /* Batch the resulting fulltext, unless the delta base is large. */
+  if (rb->pb->thread_count > 1)
+    {
+      svn_filesize_t base_size;
+
+      SVN_ERR(svn_fs_file_length(&base_size, rb->txn_root, nb->path,
+                                 nb->pool));
+      if (base_size <= MAX_BATCHED_TEXT_SIZE)
+        {
+          svn_stream_t *source;
+
+          if (nb->base_checksum)
+            {
+              svn_checksum_t *checksum;
+
+              SVN_ERR(svn_fs_file_checksum(&checksum, svn_checksum_md5,
+                                           rb->txn_root, nb->path, TRUE,
+                                           nb->pool));
+              if (!svn_checksum_match(nb->base_checksum, checksum))
+                return svn_checksum_mismatch_err(
+                                  nb->base_checksum, checksum, nb->pool,
+                                  _("Base checksum mismatch on '%s'"),
+                                  nb->path);
+            }
+
+          SVN_ERR(svn_fs_file_contents(&source, rb->txn_root, nb->path,
+                                       nb->pool));
+          svn_txdelta_apply2(source, make_batched_text_stream(nb),
+                             NULL, nb->path, nb->pool,
+                             handler, handler_baton);
+          return SVN_NO_ERROR;
+        }
+    }
+
   return svn_fs_apply_textdelta(handler, handler_baton,
                                 rb->txn_root, nb->path,
                                 svn_checksum_to_cstring(nb->base_checksum,
@@ -974,6 +1167,12 @@ set_fulltext(svn_stream_t **stream,
       return SVN_NO_ERROR;
     }
 
+  if (rb->pb->thread_count > 1)
+    {
+      *stream = make_batched_text_stream(nb);
+      return SVN_NO_ERROR;
+    }
+
   return svn_fs_apply_text(stream,
                            rb->txn_root, nb->path,
                            svn_checksum_to_cstring(nb->result_checksum,
@@ -1056,6 +1255,9 @@ close_revision(void *baton)
       return SVN_NO_ERROR;
     }
 
+  /* All file contents must be in place before we commit. */
+  SVN_ERR(flush_texts(rb, rb->pool));
+
   /* If the dumpstream doesn't have an 'svn:date' property and we
      aren't ignoring the dates in the dumpstream altogether, remove
      any 'svn:date' revision property that was set by FS layer when
@@ -1199,23 +1401,29 @@ close_revision(void *baton)
 /** The public routines **/
 
 
-svn_error_t *
-svn_repos_get_fs_build_parser6(const svn_repos_parse_fns3_t **callbacks,
-                               void **parse_baton,
-                               svn_repos_t *repos,
-                               svn_revnum_t start_rev,
-                               svn_revnum_t end_rev,
-                               svn_boolean_t use_history,
-                               svn_boolean_t validate_props,
-                               enum svn_repos_load_uuid uuid_action,
-                               const char *parent_dir,
-                               svn_boolean_t use_pre_commit_hook,
-                               svn_boolean_t use_post_commit_hook,
-                               svn_boolean_t ignore_dates,
-                               svn_boolean_t normalize_props,
-                               svn_repos_notify_func_t notify_func,
-                               void *notify_baton,
-                               apr_pool_t *pool)
+/* Implement svn_repos_get_fs_build_parser6() with the additional
+   THREAD_COUNT, CANCEL_FUNC and CANCEL_BATON options for applying file
+   contents in batches; see svn_repos_load_fs7(). */
+static svn_error_t *
+get_fs_build_parser(const svn_repos_parse_fns3_t **callbacks,
+                    void **parse_baton,
+                    svn_repos_t *repos,
+                    svn_revnum_t start_rev,
+                    svn_revnum_t end_rev,
+                    svn_boolean_t use_history,
+                    svn_boolean_t validate_props,
+                    enum svn_repos_load_uuid uuid_action,
+                    const char *parent_dir,
+                    svn_boolean_t use_pre_commit_hook,
+                    svn_boolean_t use_post_commit_hook,
+                    svn_boolean_t ignore_dates,
+                    svn_boolean_t normalize_props,
+                    int thread_count,
+                    svn_repos_notify_func_t notify_func,
+                    void *notify_baton,
+                    svn_cancel_func_t cancel_func,
+                    void *cancel_baton,
+                    apr_pool_t *pool)
 {
   svn_repos_parse_fns3_t *parser = apr_pcalloc(pool, sizeof(*parser));
   struct parse_baton *pb = apr_pcalloc(pool, sizeof(*pb));
@@ -1267,15 +1475,47 @@ svn_repos_get_fs_build_parser6(const svn_repos_parse_fns3_t **callbacks,
   pb->use_post_commit_hook = use_post_commit_hook;
   pb->ignore_dates = ignore_dates;
   pb->normalize_props = normalize_props;
+  pb->thread_count = MAX(thread_count, 1);
+  pb->cancel_func = cancel_func;
+  pb->cancel_baton = cancel_baton;
 
   *callbacks = parser;
   *parse_baton = pb;
   return SVN_NO_ERROR;
 }
 
+svn_error_t *
+svn_repos_get_fs_build_parser6(const svn_repos_parse_fns3_t **callbacks,
+                               void **parse_baton,
+                               svn_repos_t *repos,
+                               svn_revnum_t start_rev,
+                               svn_revnum_t end_rev,
+                               svn_boolean_t use_history,
+                               svn_boolean_t validate_props,
+                               enum svn_repos_load_uuid uuid_action,
+                               const char *parent_dir,
+                               svn_boolean_t use_pre_commit_hook,
+                               svn_boolean_t use_post_commit_hook,
+                               svn_boolean_t ignore_dates,
+                               svn_boolean_t normalize_props,
+                               svn_repos_notify_func_t notify_func,
+                               void *notify_baton,
+                               apr_pool_t *pool)
+{
+  return svn_error_trace(get_fs_build_parser(callbacks, parse_baton, repos,
+                                             start_rev, end_rev,
+                                             use_history, validate_props,
+                                             uuid_action, parent_dir,
+                                             use_pre_commit_hook,
+                                             use_post_commit_hook,
+                                             ignore_dates, normalize_props,
+                                             1, notify_func, notify_baton,
+                                             NULL, NULL, pool));
+}
+
 
 svn_error_t *
-svn_repos_load_fs6(svn_repos_t *repos,
+svn_repos_load_fs7(svn_repos_t *repos,
                    svn_stream_t *dumpstream,
                    svn_revnum_t start_rev,
                    svn_revnum_t end_rev,
@@ -1286,6 +1526,8 @@ svn_repos_load_fs6(svn_repos_t *repos,
                    svn_boolean_t validate_props,
                    svn_boolean_t ignore_dates,
                    svn_boolean_t normalize_props,
+                   int thread_count,
+                   svn_boolean_t bulk,
                    svn_repos_notify_func_t notify_func,
                    void *notify_baton,
                    svn_cancel_func_t cancel_func,
@@ -1294,26 +1536,41 @@ svn_repos_load_fs6(svn_repos_t *repos,
 {
   const svn_repos_parse_fns3_t *parser;
   void *parse_baton;
+  svn_error_t *err;
 
-  /* This is really simple. */
-
-  SVN_ERR(svn_repos_get_fs_build_parser6(&parser, &parse_baton,
-                                         repos,
-                                         start_rev, end_rev,
-                                         TRUE, /* look for copyfrom revs */
-                                         validate_props,
-                                         uuid_action,
-                                         parent_dir,
-                                         use_pre_commit_hook,
-                                         use_post_commit_hook,
-                                         ignore_dates,
-                                         normalize_props,
-                                         notify_func,
-                                         notify_baton,
-                                         pool));
-
-  return svn_repos_parse_dumpstream3(dumpstream, parser, parse_baton, FALSE,
-                                     cancel_func, cancel_baton, pool);
+  SVN_ERR(get_fs_build_parser(&parser, &parse_baton,
+                              repos,
+                              start_rev, end_rev,
+                              TRUE, /* look for copyfrom revs */
+                              validate_props,
+                              uuid_action,
+                              parent_dir,
+                              use_pre_commit_hook,
+                              use_post_commit_hook,
+                              ignore_dates,
+                              normalize_props,
+                              thread_count,
+                              notify_func,
+                              notify_baton,
+                              cancel_func,
+                              cancel_baton,
+                              pool));
+
+  if (bulk)
+    SVN_ERR(svn_fs__set_bulk_mode(&bulk, svn_repos_fs(repos), TRUE, pool));
+
+  err = svn_repos_parse_dumpstream3(dumpstream, parser, parse_baton, FALSE,
+                                    cancel_func, cancel_baton, pool);
+
+  /* Catch up and flush everything to disk even if the load failed.
+     Everything committed so far is there to stay. */
+  if (bulk)
+    err = svn_error_compose_create(err,
+                                   svn_fs__set_bulk_mode(&bulk,
+                                                         svn_repos_fs(repos),
+                                                         FALSE, pool));
+
+  return svn_error_trace(err);
 }
 
 /*----------------------------------------------------------------------*/
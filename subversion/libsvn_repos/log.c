@@ -221,6 +221,60 @@ svn_repos_check_revision_access(svn_repos_revision_access_level_t *access_level,
 }
 
 
+/* Number of changed paths that detect_changed() passes to the authz
+ * callback at once. */
+#define DETECT_CHANGED_BATCH_SIZE 1024
+
+/* Replace the contents of BATCH with copies of up to
+ * DETECT_CHANGED_BATCH_SIZE changes (svn_fs_path_change3_t *), starting
+ * with *NEXT_CHANGE and continuing with those returned by ITERATOR.
+ * Update *NEXT_CHANGE to the first change not in BATCH.
+ *
+ * If CALLBACKS->AUTHZ_READ_FUNC is not NULL, set *READABLE to an array
+ * of svn_boolean_t telling whether the respective path in BATCH is
+ * readable in ROOT.  Otherwise, set it to NULL.
+ *
+ * Clear BATCH_POOL and allocate the changes as well as *READABLE in it.
+ * Use SCRATCH_POOL for temporaries.
+ */
+static svn_error_t *
+fetch_change_batch(apr_array_header_t *batch,
+                   apr_array_header_t **readable,
+                   svn_fs_path_change3_t **next_change,
+                   svn_fs_path_change_iterator_t *iterator,
+                   svn_fs_root_t *root,
+                   const log_callbacks_t *callbacks,
+                   apr_pool_t *batch_pool,
+                   apr_pool_t *scratch_pool)
+{
+  apr_array_header_t *paths = apr_array_make(scratch_pool,
+                                             DETECT_CHANGED_BATCH_SIZE,
+                                             sizeof(const char *));
+
+  svn_pool_clear(batch_pool);
+  apr_array_clear(batch);
+
+  while (*next_change && batch->nelts < DETECT_CHANGED_BATCH_SIZE)
+    {
+      svn_fs_path_change3_t *change
+        = svn_fs_path_change3_dup(*next_change, batch_pool);
+
+      APR_ARRAY_PUSH(batch, svn_fs_path_change3_t *) = change;
+      APR_ARRAY_PUSH(paths, const char *) = change->path.data;
+      SVN_ERR(svn_fs_path_change_get(next_change, iterator));
+    }
+
+  *readable = NULL;
+  if (callbacks->authz_read_func)
+    SVN_ERR(svn_repos__authz_read_many(readable,
+                                       callbacks->authz_read_func,
+                                       callbacks->authz_read_baton,
+                                       root, paths, batch_pool,
+                                       scratch_pool));
+
+  return SVN_NO_ERROR;
+}
+
 /* Find all significant changes under ROOT and, if not NULL, report them
  * to the CALLBACKS->PATH_CHANGE_RECEIVER.  "Significant" means that the
  * text or properties of the node were changed, or that the node was added
@@ -253,15 +307,20 @@ detect_changed(svn_repos_revision_access_level_t *access_level,
 {
   svn_fs_path_change_iterator_t *iterator;
   svn_fs_path_change3_t *change;
+  svn_fs_path_change3_t *next_change;
+  apr_array_header_t *batch;
+  apr_array_header_t *readable_paths = NULL;
+  int batch_idx = 0;
   apr_pool_t *iterpool;
+  apr_pool_t *batch_pool;
   svn_boolean_t found_readable = FALSE;
   svn_boolean_t found_unreadable = FALSE;
 
   /* Retrieve the first change in the list. */
   SVN_ERR(svn_fs_paths_changed3(&iterator, root, scratch_pool, scratch_pool));
-  SVN_ERR(svn_fs_path_change_get(&change, iterator));
+  SVN_ERR(svn_fs_path_change_get(&next_change, iterator));
 
-  if (!change)
+  if (!next_change)
     {
       /* No paths changed in this revision?  Uh, sure, I guess the
          revision is readable, then.  */
@@ -270,27 +329,40 @@ detect_changed(svn_repos_revision_access_level_t *access_level,
     }
 
   iterpool = svn_pool_create(scratch_pool);
-  while (change)
+  batch_pool = svn_pool_create(scratch_pool);
+  batch = apr_array_make(scratch_pool, DETECT_CHANGED_BATCH_SIZE,
+                         sizeof(svn_fs_path_change3_t *));
+  while (next_change || batch_idx < batch->nelts)
     {
       /* NOTE:  Much of this loop is going to look quite similar to
          svn_repos_check_revision_access(), but we have to do more things
          here, so we'll live with the duplication. */
-      const char *path = change->path.data;
+      const char *path;
+      svn_boolean_t path_readable;
       svn_pool_clear(iterpool);
 
+      /* Fetch the changes in batches, so that the authz callback can
+         check their paths all at once. */
+      if (batch_idx == batch->nelts)
+        {
+          SVN_ERR(fetch_change_batch(batch, &readable_paths, &next_change,
+                                     iterator, root, callbacks,
+                                     batch_pool, iterpool));
+          batch_idx = 0;
+        }
+
+      change = APR_ARRAY_IDX(batch, batch_idx, svn_fs_path_change3_t *);
+      path_readable = !readable_paths
+                   || APR_ARRAY_IDX(readable_paths, batch_idx,
+                                    svn_boolean_t);
+      path = change->path.data;
+      ++batch_idx;
+
       /* Skip path if unreadable. */
-      if (callbacks->authz_read_func)
+      if (! path_readable)
         {
-          svn_boolean_t readable;
-          SVN_ERR(callbacks->authz_read_func(&readable, root, path,
-                                             callbacks->authz_read_baton,
-                                             iterpool));
-          if (! readable)
-            {
-              found_unreadable = TRUE;
-              SVN_ERR(svn_fs_path_change_get(&change, iterator));
-              continue;
-            }
+          found_unreadable = TRUE;
+          continue;
         }
 
       /* At least one changed-path was readable. */
@@ -376,11 +448,9 @@ detect_changed(svn_repos_revision_access_level_t *access_level,
                                      callbacks->path_change_receiver_baton,
                                      change,
                                      iterpool));
-
-      /* Next changed path. */
-      SVN_ERR(svn_fs_path_change_get(&change, iterator));
     }
 
+  svn_pool_destroy(batch_pool);
   svn_pool_destroy(iterpool);
 
   if (! found_readable)
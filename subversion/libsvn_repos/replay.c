@@ -41,6 +41,8 @@
 #include "private/svn_delta_private.h"
 #include "private/svn_sorts_private.h"
 
+#include "repos.h"
+
 
 /*** Backstory ***/
 
@@ -1046,6 +1048,82 @@ svn_repos_replay2(svn_fs_root_t *root,
 #endif
 }
 
+/* Set *KEY to the replay cache key for the svn_repos__replay_cached()
+   parameters REVISION, BASE_DIR, LOW_WATER_MARK, SEND_DELTAS and
+   AUTHZ_FINGERPRINT, allocated in RESULT_POOL. */
+static svn_error_t *
+get_replay_cache_key(svn_checksum_t **key,
+                     svn_revnum_t revision,
+                     const char *base_dir,
+                     svn_revnum_t low_water_mark,
+                     svn_boolean_t send_deltas,
+                     const char *authz_fingerprint,
+                     apr_pool_t *result_pool)
+{
+  const char *params;
+
+  params = apr_psprintf(result_pool,
+                        "replay %ld %" APR_SIZE_T_FMT ":%s %ld %d %s",
+                        revision, strlen(base_dir), base_dir,
+                        low_water_mark, send_deltas,
+                        authz_fingerprint ? authz_fingerprint : "-");
+
+  return svn_error_trace(svn_checksum(key, svn_checksum_sha1, params,
+                                      strlen(params), result_pool));
+}
+
+svn_error_t *
+svn_repos__replay_cached(svn_repos_t *repos,
+                         svn_revnum_t revision,
+                         const char *base_dir,
+                         svn_revnum_t low_water_mark,
+                         svn_boolean_t send_deltas,
+                         const svn_delta_editor_t *editor,
+                         void *edit_baton,
+                         svn_repos_authz_func_t authz_read_func,
+                         void *authz_read_baton,
+                         const char *authz_fingerprint,
+                         apr_pool_t *pool)
+{
+  svn_fs_root_t *root;
+  svn_checksum_t *cache_key;
+  svn_boolean_t found;
+  void *record_baton;
+
+  /* Without a way to tell access rights apart, we can't share the
+     recordings between users. */
+  if (   !repos->replay_cache_max_size
+      || (authz_read_func && !authz_fingerprint))
+    {
+      SVN_ERR(svn_fs_revision_root(&root, repos->fs, revision, pool));
+      return svn_error_trace(svn_repos_replay2(root, base_dir,
+                                               low_water_mark, send_deltas,
+                                               editor, edit_baton,
+                                               authz_read_func,
+                                               authz_read_baton, pool));
+    }
+
+  /* Revisions are immutable, so any recording of the same replay
+     is still valid. */
+  SVN_ERR(get_replay_cache_key(&cache_key, revision, base_dir,
+                               low_water_mark, send_deltas,
+                               authz_fingerprint, pool));
+  SVN_ERR(svn_repos__replay_cache_replay(&found, repos, cache_key,
+                                         editor, edit_baton, pool));
+  if (found)
+    return SVN_NO_ERROR;
+
+  SVN_ERR(svn_fs_revision_root(&root, repos->fs, revision, pool));
+  SVN_ERR(svn_repos__replay_cache_record(&editor, &record_baton, repos,
+                                         cache_key, editor, edit_baton,
+                                         pool));
+  SVN_ERR(svn_repos_replay2(root, base_dir, low_water_mark, send_deltas,
+                            editor, record_baton,
+                            authz_read_func, authz_read_baton, pool));
+
+  return svn_error_trace(svn_repos__replay_cache_store(record_baton, pool));
+}
+
 
 /*****************************************************************
  *                      Ev2 Implementation                       *
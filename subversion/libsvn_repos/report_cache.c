@@ -0,0 +1,1439 @@
+/* report_cache.c --- caching the editor drives of update reports and replays
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+#include <apr_pools.h>
+#include <apr_file_io.h>
+
+#include "svn_checksum.h"
+#include "svn_delta.h"
+#include "svn_dirent_uri.h"
+#include "svn_error.h"
+#include "svn_hash.h"
+#include "svn_io.h"
+#include "svn_pools.h"
+#include "svn_props.h"
+#include "svn_private_config.h"
+
+#include "private/svn_fs_private.h"
+#include "private/svn_repos_private.h"
+#include "private/svn_sorts_private.h"
+
+#include "repos.h"
+
+/* The report cache keeps one file per cached editor drive in the
+ * SVN_REPOS__REPORT_CACHE_DIR of the repository, named after the hex
+ * digest of the cache key.  The replay cache does the same in the
+ * SVN_REPOS__REPLAY_CACHE_DIR.  A file is a sequence of records, each being
+ * a single op character followed by its arguments.  Strings and numbers
+ * are encoded like in the reporter's spill buffer, i.e. as "+<len>:<data>"
+ * and "+<number>:" respectively, or "-" for NULL / invalid values.
+ * Directory and file batons are represented by the order in which they
+ * got opened, starting at 0 for the root directory.
+ *
+ * Ops and their arguments are:
+ *
+ *   G <generation>                 first record: the cache generation
+ *                                  that the entry has been recorded in
+ *   T <rev>                        set_target_revision
+ *   R <base-rev>                   open_root
+ *   D <parent> <path> <rev>        delete_entry
+ *   a <parent> <path> <cf-path> <cf-rev>   add_directory
+ *   o <parent> <path> <base-rev>   open_directory
+ *   p <dir> <name> <value>         change_dir_prop
+ *   c <dir>                        close_directory
+ *   x <parent> <path>              absent_directory
+ *   A <parent> <path> <cf-path> <cf-rev>   add_file
+ *   O <parent> <path> <base-rev>   open_file
+ *   d <file> <base-checksum>       apply_textdelta
+ *   w <file> <svndiff-data>        one chunk of the text delta
+ *   e <file>                       end of the text delta
+ *   P <file> <name> <value>        change_file_prop
+ *   C <file> <text-checksum>       close_file
+ *   X <parent> <path>              absent_file
+ *   E                              close_edit
+ *   .                              end of a replay, i.e. a drive that
+ *                                  does not get closed
+ *
+ * Clearing a cache writes a new random token to its GENERATION_FILE.
+ * Entries recorded in a different generation are ignored and removed
+ * upon lookup, which covers drives that were still being recorded while
+ * the cache got cleared.  If the cache has a total size limit, storing a
+ * new entry removes the least recently used ones, i.e. the ones with the
+ * oldest timestamps, until everything fits.
+ */
+
+/* Name of the file holding the current generation of a cache directory.
+   Missing files are equivalent to a NULL generation. */
+#define GENERATION_FILE "generation"
+
+/* Return the path of the cache file for KEY in the cache directory
+   CACHE_DIR of REPOS. */
+static const char *
+cache_file_path(svn_repos_t *repos,
+                const char *cache_dir,
+                const svn_checksum_t *key,
+                apr_pool_t *result_pool)
+{
+  return svn_dirent_join_many(result_pool, repos->path, cache_dir,
+                              svn_checksum_to_cstring(key, result_pool),
+                              SVN_VA_NULL);
+}
+
+/* Set *GENERATION to the current generation of the cache directory
+   CACHE_ABSPATH, allocated in RESULT_POOL.  Use SCRATCH_POOL for
+   temporary allocations. */
+static svn_error_t *
+read_generation(const char **generation,
+                const char *cache_abspath,
+                apr_pool_t *result_pool,
+                apr_pool_t *scratch_pool)
+{
+  svn_stringbuf_t *content;
+  svn_error_t *err;
+
+  err = svn_stringbuf_from_file2(&content,
+                                 svn_dirent_join(cache_abspath,
+                                                 GENERATION_FILE,
+                                                 scratch_pool),
+                                 result_pool);
+  if (err && APR_STATUS_IS_ENOENT(err->apr_err))
+    {
+      svn_error_clear(err);
+      *generation = NULL;
+
+      return SVN_NO_ERROR;
+    }
+  SVN_ERR(err);
+
+  *generation = content->data;
+
+  return SVN_NO_ERROR;
+}
+
+/* Return TRUE if the file NAME in a cache directory is a cache entry,
+   i.e. neither the GENERATION_FILE nor a temporary file. */
+static svn_boolean_t
+is_cache_entry(const char *name)
+{
+  apr_size_t len = strlen(name);
+
+  return strcmp(name, GENERATION_FILE) != 0
+      && (len < 4 || strcmp(name + len - 4, ".tmp") != 0);
+}
+
+/* Sort svn_io_dirent2_t items by ascending modification time. */
+static int
+compare_dirent_mtime(const svn_sort__item_t *a,
+                     const svn_sort__item_t *b)
+{
+  const svn_io_dirent2_t *lhs = a->value;
+  const svn_io_dirent2_t *rhs = b->value;
+
+  if (lhs->mtime == rhs->mtime)
+    return 0;
+
+  return lhs->mtime < rhs->mtime ? -1 : 1;
+}
+
+/* Remove the least recently used entries from the cache directory
+   CACHE_ABSPATH until adding NEEDED bytes keeps its total size within
+   MAX_TOTAL_SIZE.  Use SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+prune_cache(const char *cache_abspath,
+            apr_uint64_t needed,
+            apr_uint64_t max_total_size,
+            apr_pool_t *scratch_pool)
+{
+  apr_hash_t *dirents;
+  apr_array_header_t *sorted;
+  apr_uint64_t total = needed;
+  apr_pool_t *iterpool;
+  int i;
+
+  SVN_ERR(svn_io_get_dirents3(&dirents, cache_abspath, FALSE,
+                              scratch_pool, scratch_pool));
+
+  sorted = svn_sort__hash(dirents, compare_dirent_mtime, scratch_pool);
+  for (i = 0; i < sorted->nelts; ++i)
+    {
+      const svn_sort__item_t *item = &APR_ARRAY_IDX(sorted, i,
+                                                    svn_sort__item_t);
+      const svn_io_dirent2_t *dirent = item->value;
+
+      if (dirent->kind == svn_node_file && is_cache_entry(item->key))
+        total += dirent->filesize;
+    }
+
+  iterpool = svn_pool_create(scratch_pool);
+  for (i = 0; i < sorted->nelts && total > max_total_size; ++i)
+    {
+      const svn_sort__item_t *item = &APR_ARRAY_IDX(sorted, i,
+                                                    svn_sort__item_t);
+      const svn_io_dirent2_t *dirent = item->value;
+
+      if (dirent->kind != svn_node_file || !is_cache_entry(item->key))
+        continue;
+
+      svn_pool_clear(iterpool);
+      SVN_ERR(svn_io_remove_file2(svn_dirent_join(cache_abspath, item->key,
+                                                  iterpool),
+                                  TRUE, iterpool));
+      total -= dirent->filesize;
+    }
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
+
+/*** Recording. ***/
+
+/* Edit baton of the recording editor. */
+typedef struct record_edit_baton_t
+{
+  /* The editor that we forward all calls to. */
+  const svn_delta_editor_t *editor;
+  void *edit_baton;
+
+  svn_repos_t *repos;
+
+  /* Where the cache entry shall be stored eventually. */
+  const char *cache_path;
+
+  /* The temporary file that we are recording to.  NULL after we gave up
+     on recording this drive. */
+  apr_file_t *file;
+  const char *temp_path;
+
+  /* Number of bytes written to FILE so far and the limit for it. */
+  apr_uint64_t size;
+  apr_uint64_t max_size;
+
+  /* Limit for the total size of all entries in the cache directory.
+     0 means unlimited. */
+  apr_uint64_t max_total_size;
+
+  /* The number of the next baton created. */
+  apr_uint64_t next_id;
+
+  apr_pool_t *pool;
+} record_edit_baton_t;
+
+/* Directory and file baton of the recording editor. */
+typedef struct record_node_baton_t
+{
+  record_edit_baton_t *eb;
+  void *wrapped_baton;
+  apr_uint64_t id;
+
+  /* For file batons: the svndiff generator feeding 'w' records and the
+     wrapped editor's window handler. */
+  svn_txdelta_window_handler_t svndiff_handler;
+  void *svndiff_baton;
+  svn_txdelta_window_handler_t apply_handler;
+  void *apply_baton;
+} record_node_baton_t;
+
+/* Stop recording the drive of EB and remove the temporary file. */
+static svn_error_t *
+abandon_recording(record_edit_baton_t *eb,
+                  apr_pool_t *scratch_pool)
+{
+  if (eb->file)
+    {
+      apr_file_t *file = eb->file;
+      eb->file = NULL;
+
+      SVN_ERR(svn_io_file_close(file, scratch_pool));
+      SVN_ERR(svn_io_remove_file2(eb->temp_path, TRUE, scratch_pool));
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Append DATA of length LEN to the recording of EB.  Give up on the
+   recording if it becomes too large. */
+static svn_error_t *
+record_bytes(record_edit_baton_t *eb,
+             const char *data,
+             apr_size_t len,
+             apr_pool_t *scratch_pool)
+{
+  if (!eb->file)
+    return SVN_NO_ERROR;
+
+  eb->size += len;
+  if (eb->size > eb->max_size)
+    return svn_error_trace(abandon_recording(eb, scratch_pool));
+
+  return svn_error_trace(svn_io_file_write_full(eb->file, data, len, NULL,
+                                                scratch_pool));
+}
+
+/* Record the number NUMBER, or "invalid" if IS_VALID is FALSE. */
+static svn_error_t *
+record_number(record_edit_baton_t *eb,
+              apr_uint64_t number,
+              svn_boolean_t is_valid,
+              apr_pool_t *scratch_pool)
+{
+  const char *rep = is_valid
+                  ? apr_psprintf(scratch_pool, "+%" APR_UINT64_T_FMT ":",
+                                 number)
+                  : "-";
+
+  return svn_error_trace(record_bytes(eb, rep, strlen(rep), scratch_pool));
+}
+
+/* Record the revision REV. */
+static svn_error_t *
+record_rev(record_edit_baton_t *eb,
+           svn_revnum_t rev,
+           apr_pool_t *scratch_pool)
+{
+  return svn_error_trace(record_number(eb, (apr_uint64_t)rev,
+                                       SVN_IS_VALID_REVNUM(rev),
+                                       scratch_pool));
+}
+
+/* Record the LEN bytes at DATA, which may be NULL. */
+static svn_error_t *
+record_data(record_edit_baton_t *eb,
+            const char *data,
+            apr_size_t len,
+            apr_pool_t *scratch_pool)
+{
+  SVN_ERR(record_number(eb, len, data != NULL, scratch_pool));
+  if (data)
+    SVN_ERR(record_bytes(eb, data, len, scratch_pool));
+
+  return SVN_NO_ERROR;
+}
+
+/* Record the C string STR, which may be NULL. */
+static svn_error_t *
+record_cstring(record_edit_baton_t *eb,
+               const char *str,
+               apr_pool_t *scratch_pool)
+{
+  return svn_error_trace(record_data(eb, str, str ? strlen(str) : 0,
+                                     scratch_pool));
+}
+
+/* Record the start of a record for operation OP on the node NB. */
+static svn_error_t *
+record_op(record_edit_baton_t *eb,
+          char op,
+          const record_node_baton_t *nb,
+          apr_pool_t *scratch_pool)
+{
+  SVN_ERR(record_bytes(eb, &op, 1, scratch_pool));
+  if (nb)
+    SVN_ERR(record_number(eb, nb->id, TRUE, scratch_pool));
+
+  return SVN_NO_ERROR;
+}
+
+/* Return a new node baton for WRAPPED_BATON, allocated in RESULT_POOL. */
+static record_node_baton_t *
+make_node_baton(record_edit_baton_t *eb,
+                void *wrapped_baton,
+                apr_pool_t *result_pool)
+{
+  record_node_baton_t *nb = apr_pcalloc(result_pool, sizeof(*nb));
+  nb->eb = eb;
+  nb->wrapped_baton = wrapped_baton;
+  nb->id = eb->next_id++;
+
+  return nb;
+}
+
+static svn_error_t *
+record_set_target_revision(void *edit_baton,
+                           svn_revnum_t target_revision,
+                           apr_pool_t *pool)
+{
+  record_edit_baton_t *eb = edit_baton;
+
+  SVN_ERR(record_op(eb, 'T', NULL, pool));
+  SVN_ERR(record_rev(eb, target_revision, pool));
+
+  return svn_error_trace(eb->editor->set_target_revision(eb->edit_baton,
+                                                         target_revision,
+                                                         pool));
+}
+
+static svn_error_t *
+record_open_root(void *edit_baton,
+                 svn_revnum_t base_revision,
+                 apr_pool_t *result_pool,
+                 void **root_baton)
+{
+  record_edit_baton_t *eb = edit_baton;
+  void *wrapped_baton;
+
+  SVN_ERR(record_op(eb, 'R', NULL, result_pool));
+  SVN_ERR(record_rev(eb, base_revision, result_pool));
+
+  SVN_ERR(eb->editor->open_root(eb->edit_baton, base_revision, result_pool,
+                                &wrapped_baton));
+  *root_baton = make_node_baton(eb, wrapped_baton, result_pool);
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+record_delete_entry(const char *path,
+                    svn_revnum_t revision,
+                    void *parent_baton,
+                    apr_pool_t *pool)
+{
+  record_node_baton_t *pb = parent_baton;
+  record_edit_baton_t *eb = pb->eb;
+
+  SVN_ERR(record_op(eb, 'D', pb, pool));
+  SVN_ERR(record_cstring(eb, path, pool));
+  SVN_ERR(record_rev(eb, revision, pool));
+
+  return svn_error_trace(eb->editor->delete_entry(path, revision,
+                                                  pb->wrapped_baton, pool));
+}
+
+static svn_error_t *
+record_add_directory(const char *path,
+                     void *parent_baton,
+                     const char *copyfrom_path,
+                     svn_revnum_t copyfrom_revision,
+                     apr_pool_t *result_pool,
+                     void **child_baton)
+{
+  record_node_baton_t *pb = parent_baton;
+  record_edit_baton_t *eb = pb->eb;
+  void *wrapped_baton;
+
+  SVN_ERR(record_op(eb, 'a', pb, result_pool));
+  SVN_ERR(record_cstring(eb, path, result_pool));
+  SVN_ERR(record_cstring(eb, copyfrom_path, result_pool));
+  SVN_ERR(record_rev(eb, copyfrom_revision, result_pool));
+
+  SVN_ERR(eb->editor->add_directory(path, pb->wrapped_baton, copyfrom_path,
+                                    copyfrom_revision, result_pool,
+                                    &wrapped_baton));
+  *child_baton = make_node_baton(eb, wrapped_baton, result_pool);
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+record_open_directory(const char *path,
+                      void *parent_baton,
+                      svn_revnum_t base_revision,
+                      apr_pool_t *result_pool,
+                      void **child_baton)
+{
+  record_node_baton_t *pb = parent_baton;
+  record_edit_baton_t *eb = pb->eb;
+  void *wrapped_baton;
+
+  SVN_ERR(record_op(eb, 'o', pb, result_pool));
+  SVN_ERR(record_cstring(eb, path, result_pool));
+  SVN_ERR(record_rev(eb, base_revision, result_pool));
+
+  SVN_ERR(eb->editor->open_directory(path, pb->wrapped_baton, base_revision,
+                                     result_pool, &wrapped_baton));
+  *child_baton = make_node_baton(eb, wrapped_baton, result_pool);
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+record_change_dir_prop(void *dir_baton,
+                       const char *name,
+                       const svn_string_t *value,
+                       apr_pool_t *pool)
+{
+  record_node_baton_t *db = dir_baton;
+  record_edit_baton_t *eb = db->eb;
+
+  SVN_ERR(record_op(eb, 'p', db, pool));
+  SVN_ERR(record_cstring(eb, name, pool));
+  SVN_ERR(record_data(eb, value ? value->data : NULL, value ? value->len : 0,
+                      pool));
+
+  return svn_error_trace(eb->editor->change_dir_prop(db->wrapped_baton,
+                                                     name, value, pool));
+}
+
+static svn_error_t *
+record_close_directory(void *dir_baton,
+                       apr_pool_t *pool)
+{
+  record_node_baton_t *db = dir_baton;
+  record_edit_baton_t *eb = db->eb;
+
+  SVN_ERR(record_op(eb, 'c', db, pool));
+
+  return svn_error_trace(eb->editor->close_directory(db->wrapped_baton,
+                                                     pool));
+}
+
+static svn_error_t *
+record_absent_directory(const char *path,
+                        void *parent_baton,
+                        apr_pool_t *pool)
+{
+  record_node_baton_t *pb = parent_baton;
+  record_edit_baton_t *eb = pb->eb;
+
+  SVN_ERR(record_op(eb, 'x', pb, pool));
+  SVN_ERR(record_cstring(eb, path, pool));
+
+  return svn_error_trace(eb->editor->absent_directory(path,
+                                                      pb->wrapped_baton,
+                                                      pool));
+}
+
+static svn_error_t *
+record_add_file(const char *path,
+                void *parent_baton,
+                const char *copyfrom_path,
+                svn_revnum_t copyfrom_revision,
+                apr_pool_t *result_pool,
+                void **file_baton)
+{
+  record_node_baton_t *pb = parent_baton;
+  record_edit_baton_t *eb = pb->eb;
+  void *wrapped_baton;
+
+  SVN_ERR(record_op(eb, 'A', pb, result_pool));
+  SVN_ERR(record_cstring(eb, path, result_pool));
+  SVN_ERR(record_cstring(eb, copyfrom_path, result_pool));
+  SVN_ERR(record_rev(eb, copyfrom_revision, result_pool));
+
+  SVN_ERR(eb->editor->add_file(path, pb->wrapped_baton, copyfrom_path,
+                               copyfrom_revision, result_pool,
+                               &wrapped_baton));
+  *file_baton = make_node_baton(eb, wrapped_baton, result_pool);
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+record_open_file(const char *path,
+                 void *parent_baton,
+                 svn_revnum_t base_revision,
+                 apr_pool_t *result_pool,
+                 void **file_baton)
+{
+  record_node_baton_t *pb = parent_baton;
+  record_edit_baton_t *eb = pb->eb;
+  void *wrapped_baton;
+
+  SVN_ERR(record_op(eb, 'O', pb, result_pool));
+  SVN_ERR(record_cstring(eb, path, result_pool));
+  SVN_ERR(record_rev(eb, base_revision, result_pool));
+
+  SVN_ERR(eb->editor->open_file(path, pb->wrapped_baton, base_revision,
+                                result_pool, &wrapped_baton));
+  *file_baton = make_node_baton(eb, wrapped_baton, result_pool);
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_write_fn_t.  Record the svndiff data for the file
+   baton BATON. */
+static svn_error_t *
+record_svndiff_write(void *baton,
+                     const char *data,
+                     apr_size_t *len)
+{
+  record_node_baton_t *fb = baton;
+  record_edit_baton_t *eb = fb->eb;
+  apr_pool_t *scratch_pool = svn_pool_create(eb->pool);
+
+  SVN_ERR(record_op(eb, 'w', fb, scratch_pool));
+  SVN_ERR(record_data(eb, data, *len, scratch_pool));
+  svn_pool_destroy(scratch_pool);
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_txdelta_window_handler_t.  Forward WINDOW to the
+   wrapped editor and record it for the file baton BATON. */
+static svn_error_t *
+record_window_handler(svn_txdelta_window_t *window,
+                      void *baton)
+{
+  record_node_baton_t *fb = baton;
+  record_edit_baton_t *eb = fb->eb;
+
+  if (eb->file)
+    SVN_ERR(fb->svndiff_handler(window, fb->svndiff_baton));
+
+  if (!window)
+    {
+      apr_pool_t *scratch_pool = svn_pool_create(eb->pool);
+      SVN_ERR(record_op(eb, 'e', fb, scratch_pool));
+      svn_pool_destroy(scratch_pool);
+    }
+
+  return svn_error_trace(fb->apply_handler(window, fb->apply_baton));
+}
+
+static svn_error_t *
+record_apply_textdelta(void *file_baton,
+                       const char *base_checksum,
+                       apr_pool_t *result_pool,
+                       svn_txdelta_window_handler_t *handler,
+                       void **handler_baton)
+{
+  record_node_baton_t *fb = file_baton;
+  record_edit_baton_t *eb = fb->eb;
+  svn_stream_t *svndiff_stream;
+
+  SVN_ERR(eb->editor->apply_textdelta(fb->wrapped_baton, base_checksum,
+                                      result_pool, &fb->apply_handler,
+                                      &fb->apply_baton));
+
+  /* If the receiver does not care about the contents, the reporter might
+     skip the delta computation.  The recording would then be incomplete
+     for other receivers. */
+  if (fb->apply_handler == svn_delta_noop_window_handler)
+    {
+      SVN_ERR(abandon_recording(eb, result_pool));
+      *handler = fb->apply_handler;
+      *handler_baton = fb->apply_baton;
+
+      return SVN_NO_ERROR;
+    }
+
+  SVN_ERR(record_op(eb, 'd', fb, result_pool));
+  SVN_ERR(record_cstring(eb, base_checksum, result_pool));
+
+  svndiff_stream = svn_stream_create(fb, result_pool);
+  svn_stream_set_write(svndiff_stream, record_svndiff_write);
+  svn_txdelta_to_svndiff3(&fb->svndiff_handler, &fb->svndiff_baton,
+                          svndiff_stream, 2,
+                          SVN_DELTA_COMPRESSION_LEVEL_DEFAULT, result_pool);
+
+  *handler = record_window_handler;
+  *handler_baton = fb;
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+record_change_file_prop(void *file_baton,
+                        const char *name,
+                        const svn_string_t *value,
+                        apr_pool_t *pool)
+{
+  record_node_baton_t *fb = file_baton;
+  record_edit_baton_t *eb = fb->eb;
+
+  SVN_ERR(record_op(eb, 'P', fb, pool));
+  SVN_ERR(record_cstring(eb, name, pool));
+  SVN_ERR(record_data(eb, value ? value->data : NULL, value ? value->len : 0,
+                      pool));
+
+  return svn_error_trace(eb->editor->change_file_prop(fb->wrapped_baton,
+                                                      name, value, pool));
+}
+
+static svn_error_t *
+record_close_file(void *file_baton,
+                  const char *text_checksum,
+                  apr_pool_t *pool)
+{
+  record_node_baton_t *fb = file_baton;
+  record_edit_baton_t *eb = fb->eb;
+
+  SVN_ERR(record_op(eb, 'C', fb, pool));
+  SVN_ERR(record_cstring(eb, text_checksum, pool));
+
+  return svn_error_trace(eb->editor->close_file(fb->wrapped_baton,
+                                                text_checksum, pool));
+}
+
+static svn_error_t *
+record_absent_file(const char *path,
+                   void *parent_baton,
+                   apr_pool_t *pool)
+{
+  record_node_baton_t *pb = parent_baton;
+  record_edit_baton_t *eb = pb->eb;
+
+  SVN_ERR(record_op(eb, 'X', pb, pool));
+  SVN_ERR(record_cstring(eb, path, pool));
+
+  return svn_error_trace(eb->editor->absent_file(path, pb->wrapped_baton,
+                                                 pool));
+}
+
+/* Terminate the recording of EB with OP and move it into place.
+   Failing to do so is not an error for the actual edit, which has
+   already been completed. */
+static svn_error_t *
+store_recording(record_edit_baton_t *eb,
+                char op,
+                apr_pool_t *pool)
+{
+  SVN_ERR(record_op(eb, op, NULL, pool));
+  if (eb->file)
+    {
+      svn_error_t *err;
+
+      err = svn_io_file_close(eb->file, pool);
+      eb->file = NULL;
+      if (!err && eb->max_total_size)
+        err = prune_cache(svn_dirent_dirname(eb->cache_path, pool),
+                          eb->size, eb->max_total_size, pool);
+      if (!err)
+        err = svn_io_file_rename2(eb->temp_path, eb->cache_path, FALSE,
+                                  pool);
+      if (err)
+        {
+          svn_error_clear(err);
+          svn_error_clear(svn_io_remove_file2(eb->temp_path, TRUE, pool));
+        }
+    }
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+record_close_edit(void *edit_baton,
+                  apr_pool_t *pool)
+{
+  record_edit_baton_t *eb = edit_baton;
+
+  SVN_ERR(eb->editor->close_edit(eb->edit_baton, pool));
+
+  /* Only complete drives get cached. */
+  return svn_error_trace(store_recording(eb, 'E', pool));
+}
+
+static svn_error_t *
+record_abort_edit(void *edit_baton,
+                  apr_pool_t *pool)
+{
+  record_edit_baton_t *eb = edit_baton;
+
+  svn_error_clear(abandon_recording(eb, pool));
+
+  return svn_error_trace(eb->editor->abort_edit(eb->edit_baton, pool));
+}
+
+/* Pool cleanup handler removing the temporary file of the
+   record_edit_baton_t DATA, if the edit got neither closed nor
+   aborted. */
+static apr_status_t
+cleanup_recording(void *data)
+{
+  record_edit_baton_t *eb = data;
+
+  if (eb->file)
+    {
+      apr_file_close(eb->file);
+      eb->file = NULL;
+      apr_file_remove(eb->temp_path, eb->pool);
+    }
+
+  return APR_SUCCESS;
+}
+
+/* Return a recording editor for EDITOR / EDIT_BATON in *RECORD_EDITOR
+   and its baton in *RECORD_BATON.  Record at most MAX_SIZE bytes to be
+   stored under KEY in the cache directory CACHE_DIR of REPOS.  Unless
+   MAX_TOTAL_SIZE is 0, limit the size of all entries in CACHE_DIR to it.
+   If the recording cannot be started, return an editor that just
+   forwards all calls.  Allocate the result in RESULT_POOL. */
+static svn_error_t *
+start_recording(const svn_delta_editor_t **record_editor,
+                record_edit_baton_t **record_baton,
+                svn_repos_t *repos,
+                const char *cache_dir,
+                apr_uint64_t max_size,
+                apr_uint64_t max_total_size,
+                const svn_checksum_t *key,
+                const svn_delta_editor_t *editor,
+                void *edit_baton,
+                apr_pool_t *result_pool)
+{
+  svn_delta_editor_t *e;
+  record_edit_baton_t *eb;
+  const char *cache_abspath;
+  const char *generation;
+  svn_error_t *err;
+
+  eb = apr_pcalloc(result_pool, sizeof(*eb));
+  eb->editor = editor;
+  eb->edit_baton = edit_baton;
+  eb->repos = repos;
+  eb->cache_path = cache_file_path(repos, cache_dir, key, result_pool);
+  eb->max_size = max_size;
+  eb->max_total_size = max_total_size;
+  eb->pool = result_pool;
+
+  /* Not being able to cache is not a reason to fail the edit.  We
+     simply won't record anything in that case. */
+  cache_abspath = svn_dirent_dirname(eb->cache_path, result_pool);
+  err = svn_io_make_dir_recursively(cache_abspath, result_pool);
+  if (!err)
+    err = read_generation(&generation, cache_abspath, result_pool,
+                          result_pool);
+  if (!err)
+    err = svn_io_open_unique_file3(&eb->file, &eb->temp_path,
+                                   cache_abspath, svn_io_file_del_none,
+                                   result_pool, result_pool);
+  if (err)
+    {
+      svn_error_clear(err);
+      eb->file = NULL;
+    }
+  else
+    {
+      apr_pool_cleanup_register(result_pool, eb, cleanup_recording,
+                                apr_pool_cleanup_null);
+
+      /* Read the generation before anything that goes into the entry,
+         such that a concurrent clear will invalidate it. */
+      err = record_op(eb, 'G', NULL, result_pool);
+      if (!err)
+        err = record_cstring(eb, generation, result_pool);
+      if (err)
+        svn_error_clear(abandon_recording(eb, result_pool));
+      svn_error_clear(err);
+    }
+
+  e = svn_delta_default_editor(result_pool);
+  e->set_target_revision = record_set_target_revision;
+  e->open_root = record_open_root;
+  e->delete_entry = record_delete_entry;
+  e->add_directory = record_add_directory;
+  e->open_directory = record_open_directory;
+  e->change_dir_prop = record_change_dir_prop;
+  e->close_directory = record_close_directory;
+  e->absent_directory = record_absent_directory;
+  e->add_file = record_add_file;
+  e->open_file = record_open_file;
+  e->apply_textdelta = record_apply_textdelta;
+  e->change_file_prop = record_change_file_prop;
+  e->close_file = record_close_file;
+  e->absent_file = record_absent_file;
+  e->close_edit = record_close_edit;
+  e->abort_edit = record_abort_edit;
+
+  *record_editor = e;
+  *record_baton = eb;
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_repos__report_cache_record(const svn_delta_editor_t **record_editor,
+                               void **record_baton,
+                               svn_repos_t *repos,
+                               const svn_checksum_t *key,
+                               const svn_delta_editor_t *editor,
+                               void *edit_baton,
+                               apr_pool_t *result_pool)
+{
+  record_edit_baton_t *eb;
+
+  SVN_ERR(start_recording(record_editor, &eb, repos,
+                          SVN_REPOS__REPORT_CACHE_DIR,
+                          repos->report_cache_max_size,
+                          repos->report_cache_max_size, key,
+                          editor, edit_baton, result_pool));
+
+  /* Don't bother forwarding the calls if there is nothing to record. */
+  if (eb->file)
+    {
+      *record_baton = eb;
+    }
+  else
+    {
+      *record_editor = editor;
+      *record_baton = edit_baton;
+    }
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_repos__replay_cache_record(const svn_delta_editor_t **record_editor,
+                               void **record_baton,
+                               svn_repos_t *repos,
+                               const svn_checksum_t *key,
+                               const svn_delta_editor_t *editor,
+                               void *edit_baton,
+                               apr_pool_t *result_pool)
+{
+  record_edit_baton_t *eb;
+
+  SVN_ERR(start_recording(record_editor, &eb, repos,
+                          SVN_REPOS__REPLAY_CACHE_DIR,
+                          repos->replay_cache_max_size, 0, key,
+                          editor, edit_baton, result_pool));
+  *record_baton = eb;
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_repos__replay_cache_store(void *record_baton,
+                              apr_pool_t *scratch_pool)
+{
+  return svn_error_trace(store_recording(record_baton, '.', scratch_pool));
+}
+
+
+/*** Replaying. ***/
+
+/* A directory or file opened during replay. */
+typedef struct replay_node_t
+{
+  apr_uint64_t id;
+  void *baton;
+  apr_pool_t *pool;
+
+  /* For files with an active text delta: the svndiff parser feeding
+     the editor's window handler. */
+  svn_stream_t *svndiff_stream;
+} replay_node_t;
+
+/* Return the error for a corrupt cache entry. */
+static svn_error_t *
+corrupt_entry(void)
+{
+  return svn_error_create(SVN_ERR_MALFORMED_FILE, NULL,
+                          _("Corrupt update report cache entry"));
+}
+
+/* Read a number or invalid value from FILE into *NUMBER and *IS_VALID. */
+static svn_error_t *
+read_number(apr_uint64_t *number,
+            svn_boolean_t *is_valid,
+            apr_file_t *file,
+            apr_pool_t *scratch_pool)
+{
+  char c;
+
+  SVN_ERR(svn_io_file_getc(&c, file, scratch_pool));
+  *number = 0;
+  *is_valid = (c == '+');
+  if (c == '-')
+    return SVN_NO_ERROR;
+  else if (c != '+')
+    return corrupt_entry();
+
+  while (1)
+    {
+      SVN_ERR(svn_io_file_getc(&c, file, scratch_pool));
+      if (c == ':')
+        break;
+      if (c < '0' || c > '9')
+        return corrupt_entry();
+
+      *number = *number * 10 + (c - '0');
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Read a revision number from FILE into *REV. */
+static svn_error_t *
+read_rev(svn_revnum_t *rev,
+         apr_file_t *file,
+         apr_pool_t *scratch_pool)
+{
+  apr_uint64_t number;
+  svn_boolean_t is_valid;
+
+  SVN_ERR(read_number(&number, &is_valid, file, scratch_pool));
+  *rev = is_valid ? (svn_revnum_t)number : SVN_INVALID_REVNUM;
+
+  return SVN_NO_ERROR;
+}
+
+/* Read a string, which may be NULL, from FILE into *STR. */
+static svn_error_t *
+read_string(svn_string_t **str,
+            apr_file_t *file,
+            apr_pool_t *result_pool)
+{
+  apr_uint64_t len;
+  svn_boolean_t is_valid;
+  char *buf;
+
+  SVN_ERR(read_number(&len, &is_valid, file, result_pool));
+  if (!is_valid)
+    {
+      *str = NULL;
+      return SVN_NO_ERROR;
+    }
+
+  if (len >= APR_SIZE_MAX)
+    return corrupt_entry();
+
+  buf = apr_palloc(result_pool, (apr_size_t)len + 1);
+  SVN_ERR(svn_io_file_read_full2(file, buf, (apr_size_t)len, NULL, NULL,
+                                 result_pool));
+  buf[len] = '\0';
+
+  *str = apr_palloc(result_pool, sizeof(**str));
+  (*str)->data = buf;
+  (*str)->len = (apr_size_t)len;
+
+  return SVN_NO_ERROR;
+}
+
+/* Read a C string, which may be NULL, from FILE into *STR. */
+static svn_error_t *
+read_cstring(const char **str,
+             apr_file_t *file,
+             apr_pool_t *result_pool)
+{
+  svn_string_t *value;
+
+  SVN_ERR(read_string(&value, file, result_pool));
+  *str = value ? value->data : NULL;
+
+  return SVN_NO_ERROR;
+}
+
+/* Read a node reference from FILE and return the respective open node
+   from NODES in *NODE. */
+static svn_error_t *
+read_node(replay_node_t **node,
+          apr_hash_t *nodes,
+          apr_file_t *file,
+          apr_pool_t *scratch_pool)
+{
+  apr_uint64_t id;
+  svn_boolean_t is_valid;
+
+  SVN_ERR(read_number(&id, &is_valid, file, scratch_pool));
+  *node = is_valid ? apr_hash_get(nodes, &id, sizeof(id)) : NULL;
+  if (!*node)
+    return corrupt_entry();
+
+  return SVN_NO_ERROR;
+}
+
+/* Register the new node with BATON and POOL as *NEXT_ID in NODES. */
+static void
+add_node(apr_hash_t *nodes,
+         apr_uint64_t *next_id,
+         void *baton,
+         apr_pool_t *pool)
+{
+  replay_node_t *node = apr_pcalloc(pool, sizeof(*node));
+
+  node->id = (*next_id)++;
+  node->baton = baton;
+  node->pool = pool;
+  apr_hash_set(nodes, &node->id, sizeof(node->id), node);
+}
+
+/* Remove NODE from NODES and release its memory. */
+static void
+remove_node(apr_hash_t *nodes,
+            replay_node_t *node)
+{
+  apr_hash_set(nodes, &node->id, sizeof(node->id), NULL);
+  svn_pool_destroy(node->pool);
+}
+
+/* Drive EDITOR / EDIT_BATON with the recording in FILE.  That includes
+   the final close_edit() call, unless the recording is from a replay. */
+static svn_error_t *
+replay_file(apr_file_t *file,
+            const svn_delta_editor_t *editor,
+            void *edit_baton,
+            apr_pool_t *scratch_pool)
+{
+  apr_hash_t *nodes = apr_hash_make(scratch_pool);
+  apr_uint64_t next_id = 0;
+  apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+
+  while (TRUE)
+    {
+      char op;
+      replay_node_t *node;
+      const char *path, *copyfrom_path, *name, *checksum;
+      svn_string_t *value;
+      svn_revnum_t rev;
+      apr_pool_t *node_pool;
+      void *baton;
+
+      svn_pool_clear(iterpool);
+      SVN_ERR(svn_io_file_getc(&op, file, iterpool));
+      switch (op)
+        {
+          case 'T':
+            SVN_ERR(read_rev(&rev, file, iterpool));
+            SVN_ERR(editor->set_target_revision(edit_baton, rev, iterpool));
+            break;
+
+          case 'R':
+            SVN_ERR(read_rev(&rev, file, iterpool));
+            node_pool = svn_pool_create(scratch_pool);
+            SVN_ERR(editor->open_root(edit_baton, rev, node_pool, &baton));
+            add_node(nodes, &next_id, baton, node_pool);
+            break;
+
+          case 'D':
+            SVN_ERR(read_node(&node, nodes, file, iterpool));
+            SVN_ERR(read_cstring(&path, file, iterpool));
+            SVN_ERR(read_rev(&rev, file, iterpool));
+            SVN_ERR(editor->delete_entry(path, rev, node->baton, iterpool));
+            break;
+
+          case 'a':
+          case 'A':
+            SVN_ERR(read_node(&node, nodes, file, iterpool));
+            node_pool = svn_pool_create(node->pool);
+            SVN_ERR(read_cstring(&path, file, node_pool));
+            SVN_ERR(read_cstring(&copyfrom_path, file, node_pool));
+            SVN_ERR(read_rev(&rev, file, iterpool));
+            if (op == 'a')
+              SVN_ERR(editor->add_directory(path, node->baton, copyfrom_path,
+                                            rev, node_pool, &baton));
+            else
+              SVN_ERR(editor->add_file(path, node->baton, copyfrom_path,
+                                       rev, node_pool, &baton));
+            add_node(nodes, &next_id, baton, node_pool);
+            break;
+
+          case 'o':
+          case 'O':
+            SVN_ERR(read_node(&node, nodes, file, iterpool));
+            node_pool = svn_pool_create(node->pool);
+            SVN_ERR(read_cstring(&path, file, node_pool));
+            SVN_ERR(read_rev(&rev, file, iterpool));
+            if (op == 'o')
+              SVN_ERR(editor->open_directory(path, node->baton, rev,
+                                             node_pool, &baton));
+            else
+              SVN_ERR(editor->open_file(path, node->baton, rev, node_pool,
+                                        &baton));
+            add_node(nodes, &next_id, baton, node_pool);
+            break;
+
+          case 'p':
+          case 'P':
+            SVN_ERR(read_node(&node, nodes, file, iterpool));
+            SVN_ERR(read_cstring(&name, file, iterpool));
+            SVN_ERR(read_string(&value, file, iterpool));
+            if (op == 'p')
+              SVN_ERR(editor->change_dir_prop(node->baton, name, value,
+                                              iterpool));
+            else
+              SVN_ERR(editor->change_file_prop(node->baton, name, value,
+                                               iterpool));
+            break;
+
+          case 'c':
+            SVN_ERR(read_node(&node, nodes, file, iterpool));
+            SVN_ERR(editor->close_directory(node->baton, iterpool));
+            remove_node(nodes, node);
+            break;
+
+          case 'x':
+          case 'X':
+            SVN_ERR(read_node(&node, nodes, file, iterpool));
+            SVN_ERR(read_cstring(&path, file, iterpool));
+            if (op == 'x')
+              SVN_ERR(editor->absent_directory(path, node->baton, iterpool));
+            else
+              SVN_ERR(editor->absent_file(path, node->baton, iterpool));
+            break;
+
+          case 'd':
+            {
+              svn_txdelta_window_handler_t handler;
+              void *handler_baton;
+
+              SVN_ERR(read_node(&node, nodes, file, iterpool));
+              SVN_ERR(read_cstring(&checksum, file, iterpool));
+              SVN_ERR(editor->apply_textdelta(node->baton, checksum,
+                                              node->pool, &handler,
+                                              &handler_baton));
+              node->svndiff_stream = svn_txdelta_parse_svndiff(handler,
+                                                               handler_baton,
+                                                               TRUE,
+                                                               node->pool);
+            }
+            break;
+
+          case 'w':
+            SVN_ERR(read_node(&node, nodes, file, iterpool));
+            SVN_ERR(read_string(&value, file, iterpool));
+            if (!node->svndiff_stream || !value)
+              return corrupt_entry();
+            SVN_ERR(svn_stream_write(node->svndiff_stream, value->data,
+                                     &value->len));
+            break;
+
+          case 'e':
+            SVN_ERR(read_node(&node, nodes, file, iterpool));
+            if (!node->svndiff_stream)
+              return corrupt_entry();
+            SVN_ERR(svn_stream_close(node->svndiff_stream));
+            node->svndiff_stream = NULL;
+            break;
+
+          case 'C':
+            SVN_ERR(read_node(&node, nodes, file, iterpool));
+            SVN_ERR(read_cstring(&checksum, file, iterpool));
+            SVN_ERR(editor->close_file(node->baton, checksum, iterpool));
+            remove_node(nodes, node);
+            break;
+
+          case 'E':
+            svn_pool_destroy(iterpool);
+            return svn_error_trace(editor->close_edit(edit_baton,
+                                                      scratch_pool));
+
+          case '.':
+            svn_pool_destroy(iterpool);
+            return SVN_NO_ERROR;
+
+          default:
+            return corrupt_entry();
+        }
+    }
+}
+
+/* Set *CURRENT to TRUE if the entry in FILE has been recorded in the
+   current generation of the cache directory CACHE_ABSPATH and FALSE if
+   it is outdated or unusable.  Position FILE at the first editor op.
+   Use SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+check_generation(svn_boolean_t *current,
+                 apr_file_t *file,
+                 const char *cache_abspath,
+                 apr_pool_t *scratch_pool)
+{
+  const char *generation, *entry_generation;
+  char op;
+  svn_error_t *err;
+
+  SVN_ERR(read_generation(&generation, cache_abspath, scratch_pool,
+                          scratch_pool));
+
+  err = svn_io_file_getc(&op, file, scratch_pool);
+  if (!err && op != 'G')
+    err = corrupt_entry();
+  if (!err)
+    err = read_cstring(&entry_generation, file, scratch_pool);
+
+  if (err)
+    {
+      if (err->apr_err != SVN_ERR_MALFORMED_FILE
+          && !APR_STATUS_IS_EOF(err->apr_err))
+        return svn_error_trace(err);
+
+      svn_error_clear(err);
+      *current = FALSE;
+    }
+  else if (generation && entry_generation)
+    *current = strcmp(generation, entry_generation) == 0;
+  else
+    *current = (generation == entry_generation);
+
+  return SVN_NO_ERROR;
+}
+
+/* Set *FOUND to TRUE and replay the editor drive stored under KEY in the
+   cache directory CACHE_DIR of REPOS to EDITOR / EDIT_BATON.  If there
+   is no such entry or it is outdated, set *FOUND to FALSE and don't
+   touch EDITOR.  If ABORT_ON_ERROR is set, abort the edit if the replay
+   fails.  Use SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+replay_cache_entry(svn_boolean_t *found,
+                   svn_repos_t *repos,
+                   const char *cache_dir,
+                   const svn_checksum_t *key,
+                   const svn_delta_editor_t *editor,
+                   void *edit_baton,
+                   svn_boolean_t abort_on_error,
+                   apr_pool_t *scratch_pool)
+{
+  const char *path = cache_file_path(repos, cache_dir, key, scratch_pool);
+  apr_file_t *file;
+  svn_boolean_t current;
+  svn_error_t *err;
+
+  err = svn_io_file_open(&file, path, APR_READ | APR_BUFFERED,
+                         APR_OS_DEFAULT, scratch_pool);
+  if (err && APR_STATUS_IS_ENOENT(err->apr_err))
+    {
+      svn_error_clear(err);
+      *found = FALSE;
+
+      return SVN_NO_ERROR;
+    }
+  SVN_ERR(err);
+
+  err = check_generation(&current, file, svn_dirent_dirname(path,
+                                                            scratch_pool),
+                         scratch_pool);
+  if (err || !current)
+    {
+      err = svn_error_compose_create(err, svn_io_file_close(file,
+                                                            scratch_pool));
+      if (!err)
+        err = svn_io_remove_file2(path, TRUE, scratch_pool);
+      *found = FALSE;
+
+      return svn_error_trace(err);
+    }
+
+  /* Mark the entry as recently used.  This is just a hint for pruning. */
+  svn_error_clear(svn_io_set_file_affected_time(apr_time_now(), path,
+                                                scratch_pool));
+
+  *found = TRUE;
+  err = replay_file(file, editor, edit_baton, scratch_pool);
+  if (err)
+    {
+      /* The editor drive is incomplete and can't be resumed.  Make sure
+         that the broken entry will not be used again. */
+      if (err->apr_err == SVN_ERR_MALFORMED_FILE
+          || APR_STATUS_IS_EOF(err->apr_err))
+        svn_error_clear(svn_io_remove_file2(path, TRUE, scratch_pool));
+
+      if (abort_on_error)
+        err = svn_error_compose_create(err,
+                                       editor->abort_edit(edit_baton,
+                                                          scratch_pool));
+    }
+
+  return svn_error_compose_create(err,
+                                  svn_io_file_close(file, scratch_pool));
+}
+
+svn_error_t *
+svn_repos__report_cache_replay(svn_boolean_t *found,
+                               svn_repos_t *repos,
+                               const svn_checksum_t *key,
+                               const svn_delta_editor_t *editor,
+                               void *edit_baton,
+                               apr_pool_t *scratch_pool)
+{
+  return svn_error_trace(replay_cache_entry(found, repos,
+                                            SVN_REPOS__REPORT_CACHE_DIR,
+                                            key, editor, edit_baton, TRUE,
+                                            scratch_pool));
+}
+
+svn_error_t *
+svn_repos__replay_cache_replay(svn_boolean_t *found,
+                               svn_repos_t *repos,
+                               const svn_checksum_t *key,
+                               const svn_delta_editor_t *editor,
+                               void *edit_baton,
+                               apr_pool_t *scratch_pool)
+{
+  return svn_error_trace(replay_cache_entry(found, repos,
+                                            SVN_REPOS__REPLAY_CACHE_DIR,
+                                            key, editor, edit_baton, FALSE,
+                                            scratch_pool));
+}
+
+svn_error_t *
+svn_repos__report_cache_clear(svn_repos_t *repos,
+                              apr_pool_t *scratch_pool)
+{
+  const char *cache_dir = svn_dirent_join(repos->path,
+                                          SVN_REPOS__REPORT_CACHE_DIR,
+                                          scratch_pool);
+  const char *generation;
+  svn_node_kind_t kind;
+  apr_hash_t *dirents;
+  apr_hash_index_t *hi;
+  apr_pool_t *iterpool;
+
+  /* Recordings create the directory before they read anything from the
+     repository.  So, if it does not exist, there is nothing to clear. */
+  SVN_ERR(svn_io_check_path(cache_dir, &kind, scratch_pool));
+  if (kind == svn_node_none)
+    return SVN_NO_ERROR;
+
+  /* Invalidate all entries, including those still being recorded.
+     A random token stays unique even with concurrent clears. */
+  generation = svn_uuid_generate(scratch_pool);
+  SVN_ERR(svn_io_write_atomic2(svn_dirent_join(cache_dir, GENERATION_FILE,
+                                               scratch_pool),
+                               generation, strlen(generation), NULL, FALSE,
+                               scratch_pool));
+
+  /* Reclaim the disk space. */
+  SVN_ERR(svn_io_get_dirents3(&dirents, cache_dir, TRUE, scratch_pool,
+                              scratch_pool));
+  iterpool = svn_pool_create(scratch_pool);
+  for (hi = apr_hash_first(scratch_pool, dirents); hi; hi = apr_hash_next(hi))
+    {
+      const char *name = apr_hash_this_key(hi);
+      const svn_io_dirent2_t *dirent = apr_hash_this_val(hi);
+
+      if (dirent->kind != svn_node_file || !is_cache_entry(name))
+        continue;
+
+      svn_pool_clear(iterpool);
+      SVN_ERR(svn_io_remove_file2(svn_dirent_join(cache_dir, name, iterpool),
+                                  TRUE, iterpool));
+    }
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
+void
+svn_repos__report_cache_revprop_changed(svn_repos_t *repos,
+                                        const char *name,
+                                        apr_pool_t *scratch_pool)
+{
+  /* Cached update reports contain the author and date of every
+     revision they mention. */
+  if (   strcmp(name, SVN_PROP_REVISION_AUTHOR) == 0
+      || strcmp(name, SVN_PROP_REVISION_DATE) == 0)
+    svn_fs__warn(repos->fs,
+                 svn_repos__report_cache_clear(repos, scratch_pool));
+}
+
+void
+svn_repos__enable_report_cache(svn_repos_t *repos,
+                               apr_uint64_t max_size)
+{
+  repos->report_cache_max_size = max_size;
+}
+
+void
+svn_repos__enable_replay_cache(svn_repos_t *repos,
+                               apr_uint64_t max_entry_size)
+{
+  repos->replay_cache_max_size = max_entry_size;
+}
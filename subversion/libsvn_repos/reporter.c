@@ -36,11 +36,16 @@
 
 #include "private/svn_dep_compat.h"
 #include "private/svn_fspath.h"
+#include "private/svn_repos_private.h"
 #include "private/svn_subr_private.h"
 #include "private/svn_string_private.h"
 
 #define NUM_CACHED_SOURCE_ROOTS 4
 
+/* Reports larger than this describe working copies too individual to be
+   worth caching their editor drives. */
+#define MAX_CACHEABLE_REPORT_SIZE 0x10000
+
 /* Theory of operation: we write report operations out to a spill-buffer
    as we receive them.  When the report is finished, we read the
    operations back out again, using them to guide the progression of
@@ -131,6 +136,16 @@ typedef struct report_baton_t
   /* The spill-buffer holding the report. */
   svn_spillbuf_reader_t *reader;
 
+  /* Digest and size of the report written to READER so far, and whether
+     the report still qualifies for the update report cache. */
+  svn_checksum_ctx_t *report_digest;
+  apr_size_t report_size;
+  svn_boolean_t cacheable;
+
+  /* Identifies the access rights granted by AUTHZ_READ_FUNC.  May be
+     NULL. */
+  const char *authz_fingerprint;
+
   /* For the actual editor drive, we'll need a lookahead path info
      entry, a cache of FS roots, and a pool to store them. */
   path_info_t *lookahead;
@@ -1420,6 +1435,50 @@ drive(report_baton_t *b, svn_revnum_t s_rev, path_info_t *info,
   return svn_error_trace(b->editor->close_directory(root_baton, pool));
 }
 
+/* Set *KEY to the update report cache key for the report in B,
+   allocated in RESULT_POOL.  Set it to NULL if the report shall not be
+   cached. */
+static svn_error_t *
+get_cache_key(svn_checksum_t **key,
+              report_baton_t *b,
+              apr_pool_t *result_pool)
+{
+  svn_checksum_ctx_t *ctx;
+  svn_checksum_t *report_digest;
+  const char *params;
+
+  *key = NULL;
+  if (   !b->repos->report_cache_max_size
+      || !b->cacheable
+      || (b->authz_read_func && !b->authz_fingerprint))
+    return SVN_NO_ERROR;
+
+  /* Everything that determines the editor drive besides the repository
+     contents and the report itself. */
+  params = apr_psprintf(result_pool,
+                        "%ld %" APR_SIZE_T_FMT ":%s %" APR_SIZE_T_FMT ":%s "
+                        "%" APR_SIZE_T_FMT ":%s %d %d %d %d %d %s",
+                        b->t_rev,
+                        strlen(b->fs_base), b->fs_base,
+                        strlen(b->s_operand), b->s_operand,
+                        strlen(b->t_path), b->t_path,
+                        b->text_deltas, b->requested_depth,
+                        b->ignore_ancestry, b->send_copyfrom_args,
+                        b->is_switch,
+                        b->authz_fingerprint ? b->authz_fingerprint : "-");
+
+  SVN_ERR(svn_checksum_final(&report_digest, b->report_digest,
+                             result_pool));
+
+  ctx = svn_checksum_ctx_create(svn_checksum_sha1, result_pool);
+  SVN_ERR(svn_checksum_update(ctx, params, strlen(params)));
+  SVN_ERR(svn_checksum_update(ctx, report_digest->digest,
+                              svn_checksum_size(report_digest)));
+  SVN_ERR(svn_checksum_final(key, ctx, result_pool));
+
+  return SVN_NO_ERROR;
+}
+
 /* Initialize the baton fields for editor-driving, and drive the editor. */
 static svn_error_t *
 finish_report(report_baton_t *b, apr_pool_t *pool)
@@ -1427,11 +1486,26 @@ finish_report(report_baton_t *b, apr_pool_t *pool)
   path_info_t *info;
   apr_pool_t *subpool;
   svn_revnum_t s_rev;
+  svn_checksum_t *cache_key;
   int i;
 
   /* Save our pool to manage the lookahead and fs_root cache with. */
   b->pool = pool;
 
+  /* Identical reports produce identical editor drives.  Try to replay
+     a previous one before doing any actual work. */
+  SVN_ERR(get_cache_key(&cache_key, b, pool));
+  if (cache_key)
+    {
+      svn_boolean_t found;
+
+      SVN_ERR(svn_repos__report_cache_replay(&found, b->repos, cache_key,
+                                             b->editor, b->edit_baton,
+                                             pool));
+      if (found)
+        return SVN_NO_ERROR;
+    }
+
   /* Add the end marker. */
   SVN_ERR(svn_spillbuf__reader_write(b->reader, "-", 1, pool));
 
@@ -1473,8 +1547,16 @@ finish_report(report_baton_t *b, apr_pool_t *pool)
     b->s_roots[i] = NULL;
 
   {
-    svn_error_t *err = svn_error_trace(drive(b, s_rev, info, pool));
+    svn_error_t *err;
 
+    /* Record the drive for future identical reports. */
+    if (cache_key)
+      SVN_ERR(svn_repos__report_cache_record(&b->editor, &b->edit_baton,
+                                             b->repos, cache_key,
+                                             b->editor, b->edit_baton,
+                                             pool));
+
+    err = svn_error_trace(drive(b, s_rev, info, pool));
     if (err == SVN_NO_ERROR)
       return svn_error_trace(b->editor->close_edit(b->edit_baton, pool));
 
@@ -1496,6 +1578,7 @@ write_path_info(report_baton_t *b, const char *path, const char *lpath,
                 const char *lock_token, apr_pool_t *pool)
 {
   const char *lrep, *rrep, *drep, *ltrep, *rep;
+  apr_size_t len;
 
   /* Munge the path to be anchor-relative, so that we can use edit paths
      as report paths. */
@@ -1526,8 +1609,17 @@ write_path_info(report_baton_t *b, const char *path, const char *lpath,
   rep = apr_psprintf(pool, "+%" APR_SIZE_T_FMT ":%s%s%s%s%c%s",
                      strlen(path), path, lrep, rrep, drep,
                      start_empty ? '+' : '-', ltrep);
+  len = strlen(rep);
+
+  /* Lock tokens make the editor drive depend on the current locks. */
+  b->report_size += len;
+  if (lock_token || b->report_size > MAX_CACHEABLE_REPORT_SIZE)
+    b->cacheable = FALSE;
+  if (b->cacheable)
+    SVN_ERR(svn_checksum_update(b->report_digest, rep, len));
+
   return svn_error_trace(
-            svn_spillbuf__reader_write(b->reader, rep, strlen(rep), pool));
+            svn_spillbuf__reader_write(b->reader, rep, len, pool));
 }
 
 svn_error_t *
@@ -1574,6 +1666,16 @@ svn_repos_finish_report(void *baton, apr_pool_t *pool)
   return svn_error_trace(finish_report(b, pool));
 }
 
+void
+svn_repos__report_set_authz_fingerprint(void *report_baton,
+                                        const char *fingerprint)
+{
+  report_baton_t *b = report_baton;
+
+  b->authz_fingerprint = fingerprint ? apr_pstrdup(b->pool, fingerprint)
+                                     : NULL;
+}
+
 svn_error_t *
 svn_repos_abort_report(void *baton, apr_pool_t *pool)
 {
@@ -1635,6 +1737,10 @@ svn_repos_begin_report3(void **report_baton,
                                           1000000 /* maxsize */,
                                           pool);
   b->repos_uuid = svn_string_create(uuid, pool);
+  b->report_digest = svn_checksum_ctx_create(svn_checksum_sha1, pool);
+  b->report_size = 0;
+  b->cacheable = TRUE;
+  b->authz_fingerprint = NULL;
 
   /* Hand reporter back to client. */
   *report_baton = b;
@@ -1892,6 +1892,19 @@ static svn_error_t *hotcopy_structure(void *baton,
           (svn_dirent_get_longest_ancestor(SVN_REPOS__FORMAT, sub_path, pool),
            SVN_REPOS__FORMAT) == 0)
         return SVN_NO_ERROR;
+
+      /* The update report and replay caches are not worth copying. */
+      if (svn_path_compare_paths
+          (svn_dirent_get_longest_ancestor(SVN_REPOS__REPORT_CACHE_DIR,
+                                           sub_path, pool),
+           SVN_REPOS__REPORT_CACHE_DIR) == 0)
+        return SVN_NO_ERROR;
+
+      if (svn_path_compare_paths
+          (svn_dirent_get_longest_ancestor(SVN_REPOS__REPLAY_CACHE_DIR,
+                                           sub_path, pool),
+           SVN_REPOS__REPLAY_CACHE_DIR) == 0)
+        return SVN_NO_ERROR;
     }
 
   target = svn_dirent_join(ctx->dest, sub_path, pool);
@@ -1964,10 +1977,12 @@ fs_hotcopy_notify(void *baton,
 
 /* Make a copy of a repository with hot backup of fs. */
 svn_error_t *
-svn_repos_hotcopy3(const char *src_path,
+svn_repos_hotcopy4(const char *src_path,
                    const char *dst_path,
                    svn_boolean_t clean_logs,
                    svn_boolean_t incremental,
+                   svn_boolean_t compare_checksums,
+                   int thread_count,
                    svn_repos_notify_func_t notify_func,
                    void *notify_baton,
                    svn_cancel_func_t cancel_func,
@@ -2052,8 +2067,9 @@ svn_repos_hotcopy3(const char *src_path,
   fs_notify_baton.notify_func = notify_func;
   fs_notify_baton.notify_baton = notify_baton;
 
-  SVN_ERR(svn_fs_hotcopy3(src_repos->db_path, dst_repos->db_path,
-                          clean_logs, incremental,
+  SVN_ERR(svn_fs_hotcopy4(src_repos->db_path, dst_repos->db_path,
+                          clean_logs, incremental, compare_checksums,
+                          thread_count,
                           fs_notify_func, &fs_notify_baton,
                           cancel_func, cancel_baton, scratch_pool));
 
@@ -26,6 +26,8 @@
 #include <apr_pools.h>
 #include <apr_hash.h>
 
+#include "svn_checksum.h"
+#include "svn_delta.h"
 #include "svn_fs.h"
 #include "svn_config.h"
 
@@ -65,6 +67,9 @@ extern "C" {
 #define SVN_REPOS__LOCK_DIR    "locks"      /* Lock files live here. */
 #define SVN_REPOS__HOOK_DIR    "hooks"      /* Hook programs. */
 #define SVN_REPOS__CONF_DIR    "conf"       /* Configuration files. */
+#define SVN_REPOS__REPORT_CACHE_DIR "report-cache" /* Cached update
+                                                      editor drives. */
+#define SVN_REPOS__REPLAY_CACHE_DIR "replay-cache" /* Cached replays. */
 
 /* Things for which we keep lockfiles. */
 #define SVN_REPOS__DB_LOCKFILE "db.lock" /* Our Berkeley lockfile. */
@@ -153,6 +158,14 @@ struct svn_repos_t
      those constants' addresses, therefore). */
   apr_hash_t *repository_capabilities;
 
+  /* Maximum total size of the update report cache, which also limits
+     the size of any single entry.  0 disables that cache. */
+  apr_uint64_t report_cache_max_size;
+
+  /* Maximum size of a single entry in the replay cache.
+     0 disables that cache. */
+  apr_uint64_t replay_cache_max_size;
+
   /* Pool from which this structure was allocated.  Also used for
      auxiliary repository-related data that requires a matching
      lifespan.  (As the svn_repos_t structure tends to be relatively
@@ -161,6 +174,93 @@ struct svn_repos_t
 };
 
 
+/*** Update Report Cache ***/
+
+/* Set *FOUND to TRUE and replay the editor drive stored under KEY in the
+   update report cache of REPOS to EDITOR / EDIT_BATON, including the
+   final close_edit() call.  If there is no such entry, set *FOUND to
+   FALSE and don't touch EDITOR.  Use SCRATCH_POOL for temporary
+   allocations. */
+svn_error_t *
+svn_repos__report_cache_replay(svn_boolean_t *found,
+                               svn_repos_t *repos,
+                               const svn_checksum_t *key,
+                               const svn_delta_editor_t *editor,
+                               void *edit_baton,
+                               apr_pool_t *scratch_pool);
+
+/* Set *RECORD_EDITOR / *RECORD_BATON to an editor that forwards all
+   calls to EDITOR / EDIT_BATON and records them.  Once the drive has
+   been completed successfully, store the recording under KEY in the
+   update report cache of REPOS, unless it exceeds the maximum entry
+   size.  Allocate the result in RESULT_POOL. */
+svn_error_t *
+svn_repos__report_cache_record(const svn_delta_editor_t **record_editor,
+                               void **record_baton,
+                               svn_repos_t *repos,
+                               const svn_checksum_t *key,
+                               const svn_delta_editor_t *editor,
+                               void *edit_baton,
+                               apr_pool_t *result_pool);
+
+/* Remove all entries from the update report cache of REPOS, including
+   those that are still being recorded.  Use SCRATCH_POOL for temporary
+   allocations. */
+svn_error_t *
+svn_repos__report_cache_clear(svn_repos_t *repos,
+                              apr_pool_t *scratch_pool);
+
+/* Invalidate the update report cache of REPOS after the revision
+   property NAME has been changed, if cached reports may contain it.
+   This must be called by everything that changes revision properties
+   of existing revisions.  Failures are only reported as warnings through
+   the FS of REPOS.  Use SCRATCH_POOL for temporary allocations. */
+void
+svn_repos__report_cache_revprop_changed(svn_repos_t *repos,
+                                        const char *name,
+                                        apr_pool_t *scratch_pool);
+
+
+/*** Replay Cache ***/
+
+/* Set *FOUND to TRUE and replay the editor drive stored under KEY in the
+   replay cache of REPOS to EDITOR / EDIT_BATON.  As with
+   svn_repos_replay2(), the edit will neither be closed nor aborted.
+   If there is no such entry, set *FOUND to FALSE and don't touch EDITOR.
+   Use SCRATCH_POOL for temporary allocations. */
+svn_error_t *
+svn_repos__replay_cache_replay(svn_boolean_t *found,
+                               svn_repos_t *repos,
+                               const svn_checksum_t *key,
+                               const svn_delta_editor_t *editor,
+                               void *edit_baton,
+                               apr_pool_t *scratch_pool);
+
+/* Set *RECORD_EDITOR / *RECORD_BATON to an editor that forwards all
+   calls to EDITOR / EDIT_BATON and records them for the replay cache
+   of REPOS.  Allocate the result in RESULT_POOL.
+
+   Once the replay has been completed successfully, the caller should
+   call svn_repos__replay_cache_store() to store the recording under KEY.
+   A recording that exceeds the maximum entry size will silently be
+   dropped. */
+svn_error_t *
+svn_repos__replay_cache_record(const svn_delta_editor_t **record_editor,
+                               void **record_baton,
+                               svn_repos_t *repos,
+                               const svn_checksum_t *key,
+                               const svn_delta_editor_t *editor,
+                               void *edit_baton,
+                               apr_pool_t *result_pool);
+
+/* Store the recording in RECORD_BATON, as returned by
+   svn_repos__replay_cache_record(), in the replay cache.
+   Use SCRATCH_POOL for temporary allocations. */
+svn_error_t *
+svn_repos__replay_cache_store(void *record_baton,
+                              apr_pool_t *scratch_pool);
+
+
 /*** Hook-running Functions ***/
 
 /* Set *HOOKS_ENV_P to the parsed contents of the hooks-env file
@@ -387,6 +487,22 @@ svn_repos__prev_location(svn_revnum_t *appeared_rev,
                          const char *path,
                          apr_pool_t *pool);
 
+/* Set *READABLE_P to an array of svn_boolean_t, allocated in RESULT_POOL,
+   telling for each element of PATHS (const char *) in ROOT whether
+   AUTHZ_READ_FUNC with AUTHZ_READ_BATON grants read access to it.
+
+   If AUTHZ_READ_FUNC is svn_repos__authz_read_func(), check all PATHS
+   in a single svn_repos_authz_check_access_many() call.  Otherwise, call
+   AUTHZ_READ_FUNC for each path.  Use SCRATCH_POOL for temporaries. */
+svn_error_t *
+svn_repos__authz_read_many(apr_array_header_t **readable_p,
+                           svn_repos_authz_func_t authz_read_func,
+                           void *authz_read_baton,
+                           svn_fs_root_t *root,
+                           const apr_array_header_t *paths,
+                           apr_pool_t *result_pool,
+                           apr_pool_t *scratch_pool);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
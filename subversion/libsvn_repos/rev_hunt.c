@@ -317,6 +317,7 @@ svn_repos_deleted_rev(svn_fs_t *fs,
   svn_revnum_t mid_rev;
   svn_node_kind_t kind;
   svn_fs_node_relation_t node_relation;
+  svn_boolean_t available;
 
   /* Validate the revision range. */
   if (! SVN_IS_VALID_REVNUM(start))
@@ -346,6 +347,12 @@ svn_repos_deleted_rev(svn_fs_t *fs,
       return SVN_NO_ERROR;
     }
 
+  /* The backend may have an index that answers the question directly. */
+  SVN_ERR(svn_fs__try_get_deleted_rev(&available, deleted, fs, path,
+                                      start, end, pool));
+  if (available)
+    return SVN_NO_ERROR;
+
   /* Ensure path was deleted at or before end revision. */
   SVN_ERR(svn_fs_revision_root(&root, fs, end, pool));
   SVN_ERR(svn_fs_check_path(&kind, root, path, pool));
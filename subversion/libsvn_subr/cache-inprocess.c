@@ -584,6 +584,98 @@ inprocess_cache_set_partial(void *cache_void,
   return SVN_NO_ERROR;
 }
 
+static svn_error_t *
+inprocess_cache_get_many_internal(char **buffers,
+                                  apr_size_t *sizes,
+                                  inprocess_cache_t *cache,
+                                  const apr_array_header_t *keys,
+                                  apr_pool_t *result_pool)
+{
+  int i;
+
+  for (i = 0; i < keys->nelts; ++i)
+    {
+      const void *key = APR_ARRAY_IDX(keys, i, const void *);
+      if (key)
+        SVN_ERR(inprocess_cache_get_internal(&buffers[i], &sizes[i], cache,
+                                             key, result_pool));
+    }
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+inprocess_cache_get_many(void **values,
+                         svn_boolean_t *found,
+                         void *cache_void,
+                         const apr_array_header_t *keys,
+                         apr_pool_t *result_pool)
+{
+  inprocess_cache_t *cache = cache_void;
+  char **buffers = apr_pcalloc(result_pool,
+                               keys->nelts * sizeof(*buffers));
+  apr_size_t *sizes = apr_pcalloc(result_pool,
+                                  keys->nelts * sizeof(*sizes));
+  int i;
+
+  /* Fetch all buffers while holding the lock only once. */
+  SVN_MUTEX__WITH_LOCK(cache->mutex,
+                       inprocess_cache_get_many_internal(buffers,
+                                                         sizes,
+                                                         cache,
+                                                         keys,
+                                                         result_pool));
+
+  /* Deserialize outside the lock. */
+  for (i = 0; i < keys->nelts; ++i)
+    {
+      found[i] = (buffers[i] != NULL);
+      if (!buffers[i] || !sizes[i])
+        values[i] = NULL;
+      else
+        SVN_ERR(cache->deserialize_func(&values[i], buffers[i], sizes[i],
+                                        result_pool));
+    }
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+inprocess_cache_set_many_internal(inprocess_cache_t *cache,
+                                  const apr_array_header_t *keys,
+                                  void **values,
+                                  apr_pool_t *scratch_pool)
+{
+  int i;
+
+  for (i = 0; i < keys->nelts; ++i)
+    {
+      const void *key = APR_ARRAY_IDX(keys, i, const void *);
+      if (key)
+        SVN_ERR(inprocess_cache_set_internal(cache, key, values[i],
+                                             scratch_pool));
+    }
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+inprocess_cache_set_many(void *cache_void,
+                         const apr_array_header_t *keys,
+                         void **values,
+                         apr_pool_t *scratch_pool)
+{
+  inprocess_cache_t *cache = cache_void;
+
+  SVN_MUTEX__WITH_LOCK(cache->mutex,
+                       inprocess_cache_set_many_internal(cache,
+                                                         keys,
+                                                         values,
+                                                         scratch_pool));
+
+  return SVN_NO_ERROR;
+}
+
 static svn_boolean_t
 inprocess_cache_is_cachable(void *cache_void, apr_size_t size)
 {
@@ -640,7 +732,9 @@ static svn_cache__vtable_t inprocess_cache_vtable = {
   inprocess_cache_is_cachable,
   inprocess_cache_get_partial,
   inprocess_cache_set_partial,
-  inprocess_cache_get_info
+  inprocess_cache_get_info,
+  inprocess_cache_get_many,
+  inprocess_cache_set_many
 };
 
 svn_error_t *
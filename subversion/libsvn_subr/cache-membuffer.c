@@ -22,6 +22,7 @@
  */
 
 #include <assert.h>
+#include <stdlib.h>
 #include <apr_md5.h>
 #include <apr_thread_rwlock.h>
 
@@ -3098,6 +3099,309 @@ svn_membuffer_cache_set_partial(void *cache_void,
   return SVN_NO_ERROR;
 }
 
+#ifndef SVN_DEBUG_CACHE_MEMBUFFER
+
+/* One key of a batch access, see svn_membuffer_cache_get_many and
+ * svn_membuffer_cache_set_many.
+ */
+typedef struct batch_entry_t
+{
+  /* the full, i.e. globally unique, key
+   */
+  full_key_t key;
+
+  /* the cache segment and group that hold the entry for KEY
+   */
+  svn_membuffer_t *segment;
+  apr_uint32_t group_index;
+
+  /* position of KEY in the caller's arrays
+   */
+  int idx;
+
+  /* serialized item to store (set_many only).  NULL to remove the entry.
+   */
+  void *buffer;
+  apr_size_t size;
+} batch_entry_t;
+
+/* Order batch_entry_t elements by segment first, then by the position
+ * within the original request.  Implements the qsort() interface.
+ */
+static int
+compare_batch_entries(const void *lhs, const void *rhs)
+{
+  const batch_entry_t *lhs_entry = lhs;
+  const batch_entry_t *rhs_entry = rhs;
+
+  if (lhs_entry->segment != rhs_entry->segment)
+    return lhs_entry->segment < rhs_entry->segment ? -1 : 1;
+
+  return lhs_entry->idx - rhs_entry->idx;
+}
+
+/* Construct the full keys for all non-NULL elements of KEYS and map them
+ * to segments and groups in CACHE.  Return them in *ENTRIES, sorted by
+ * segment, and their number in *COUNT.  Allocate them in RESULT_POOL.
+ */
+static void
+prepare_batch(batch_entry_t **entries,
+              int *count,
+              svn_membuffer_cache_t *cache,
+              const apr_array_header_t *keys,
+              apr_pool_t *result_pool)
+{
+  batch_entry_t *result = apr_pcalloc(result_pool,
+                                      (keys->nelts + 1) * sizeof(*result));
+  int i;
+  int n = 0;
+
+  for (i = 0; i < keys->nelts; ++i)
+    {
+      const void *key = APR_ARRAY_IDX(keys, i, const void *);
+      batch_entry_t *entry;
+
+      if (key == NULL)
+        continue;
+
+      /* COMBINED_KEY gets overwritten by the next key, so copy it. */
+      combine_key(cache, key, cache->key_len);
+
+      entry = &result[n++];
+      entry->key.entry_key = cache->combined_key.entry_key;
+      if (entry->key.entry_key.key_len)
+        {
+          svn_membuf__create(&entry->key.full_key,
+                             entry->key.entry_key.key_len, result_pool);
+          memcpy(entry->key.full_key.data,
+                 cache->combined_key.full_key.data,
+                 entry->key.entry_key.key_len);
+        }
+
+      entry->segment = cache->membuffer;
+      entry->group_index = get_group_index(&entry->segment,
+                                           &entry->key.entry_key);
+      entry->idx = i;
+    }
+
+  qsort(result, n, sizeof(*result), compare_batch_entries);
+
+  *entries = result;
+  *count = n;
+}
+
+/* Look up all COUNT ENTRIES, which all map to SEGMENT, and return copies
+ * of the serialized data found in BUFFERS and SIZES at the respective
+ * entry's IDX.  Allocate those in RESULT_POOL.
+ *
+ * Note: This function requires the caller to serialization access.
+ */
+static svn_error_t *
+membuffer_cache_get_batch_internal(svn_membuffer_t *segment,
+                                   const batch_entry_t *entries,
+                                   int count,
+                                   char **buffers,
+                                   apr_size_t *sizes,
+                                   apr_pool_t *result_pool)
+{
+  int i;
+
+  for (i = 0; i < count; ++i)
+    SVN_ERR(membuffer_cache_get_internal(segment,
+                                         entries[i].group_index,
+                                         &entries[i].key,
+                                         &buffers[entries[i].idx],
+                                         &sizes[entries[i].idx],
+                                         result_pool));
+
+  return SVN_NO_ERROR;
+}
+
+/* Store the serialized data of all COUNT ENTRIES, which all map to
+ * SEGMENT, under their respective keys using the given PRIORITY.  Acquire
+ * the write lock of SEGMENT only once.
+ */
+static svn_error_t *
+membuffer_cache_set_batch(svn_membuffer_t *segment,
+                          const batch_entry_t *entries,
+                          int count,
+                          apr_uint32_t priority,
+                          apr_pool_t *scratch_pool)
+{
+  svn_boolean_t got_lock = TRUE;
+  svn_error_t *err = SVN_NO_ERROR;
+  int i;
+
+  /* Same logic as in WITH_WRITE_LOCK: If we can't get the lock without
+   * waiting, we only need to wait if stale entries must be removed. */
+  SVN_ERR(write_lock_cache(segment, &got_lock));
+  if (!got_lock)
+    {
+      svn_boolean_t exists = FALSE;
+      for (i = 0; i < count && !exists; ++i)
+        SVN_ERR(entry_exists(segment, entries[i].group_index,
+                             &entries[i].key, &exists));
+
+      if (!exists)
+        return SVN_NO_ERROR;
+
+      SVN_ERR(force_write_lock_cache(segment));
+    }
+
+  for (i = 0; i < count && !err; ++i)
+    err = membuffer_cache_set_internal(segment,
+                                       &entries[i].key,
+                                       entries[i].group_index,
+                                       entries[i].buffer,
+                                       entries[i].size,
+                                       priority,
+                                       scratch_pool);
+
+  return svn_error_trace(unlock_cache(segment, err));
+}
+
+#endif /* SVN_DEBUG_CACHE_MEMBUFFER */
+
+#ifndef SVN_DEBUG_CACHE_MEMBUFFER
+
+/* Look up all KEYS in CACHE and return the deserialized VALUES and FOUND
+ * flags.  Allocate the results in RESULT_POOL and temporary copies of the
+ * serialized data in SCRATCH_POOL.
+ */
+static svn_error_t *
+membuffer_cache_get_many_internal(void **values,
+                                  svn_boolean_t *found,
+                                  svn_membuffer_cache_t *cache,
+                                  const apr_array_header_t *keys,
+                                  apr_pool_t *result_pool,
+                                  apr_pool_t *scratch_pool)
+{
+  char **buffers = apr_pcalloc(scratch_pool,
+                               keys->nelts * sizeof(*buffers));
+  apr_size_t *sizes = apr_pcalloc(scratch_pool,
+                                  keys->nelts * sizeof(*sizes));
+  batch_entry_t *entries;
+  int count, first, last, i;
+
+  /* Look up all keys of the same segment while holding its lock. */
+  prepare_batch(&entries, &count, cache, keys, scratch_pool);
+  for (first = 0; first < count; first = last)
+    {
+      svn_membuffer_t *segment = entries[first].segment;
+      for (last = first + 1;
+           last < count && entries[last].segment == segment;
+           ++last)
+        ;
+
+      WITH_READ_LOCK(segment,
+                     membuffer_cache_get_batch_internal(segment,
+                                                        entries + first,
+                                                        last - first,
+                                                        buffers,
+                                                        sizes,
+                                                        scratch_pool));
+    }
+
+  /* re-construct the original data objects from their serialized form.
+   */
+  for (i = 0; i < keys->nelts; ++i)
+    {
+      values[i] = NULL;
+      if (buffers[i])
+        SVN_ERR(cache->deserializer(&values[i], buffers[i], sizes[i],
+                                    result_pool));
+
+      found[i] = values[i] != NULL;
+    }
+
+  return SVN_NO_ERROR;
+}
+
+#endif /* SVN_DEBUG_CACHE_MEMBUFFER */
+
+/* Implement svn_cache__vtable_t.get_many (not thread-safe)
+ */
+static svn_error_t *
+svn_membuffer_cache_get_many(void **values,
+                             svn_boolean_t *found,
+                             void *cache_void,
+                             const apr_array_header_t *keys,
+                             apr_pool_t *result_pool)
+{
+#ifdef SVN_DEBUG_CACHE_MEMBUFFER
+
+  /* Keep the consistency checks simple and look up one key at a time. */
+  int i;
+  for (i = 0; i < keys->nelts; ++i)
+    SVN_ERR(svn_membuffer_cache_get(&values[i], &found[i], cache_void,
+                                    APR_ARRAY_IDX(keys, i, const void *),
+                                    result_pool));
+
+  return SVN_NO_ERROR;
+
+#else
+
+  apr_pool_t *scratch_pool = svn_pool_create(result_pool);
+  svn_error_t *err = membuffer_cache_get_many_internal(values, found,
+                                                       cache_void, keys,
+                                                       result_pool,
+                                                       scratch_pool);
+  svn_pool_destroy(scratch_pool);
+
+  return svn_error_trace(err);
+
+#endif
+}
+
+/* Implement svn_cache__vtable_t.set_many (not thread-safe)
+ */
+static svn_error_t *
+svn_membuffer_cache_set_many(void *cache_void,
+                             const apr_array_header_t *keys,
+                             void **values,
+                             apr_pool_t *scratch_pool)
+{
+#ifdef SVN_DEBUG_CACHE_MEMBUFFER
+
+  /* Keep the consistency checks simple and store one key at a time. */
+  int i;
+  for (i = 0; i < keys->nelts; ++i)
+    SVN_ERR(svn_membuffer_cache_set(cache_void,
+                                    APR_ARRAY_IDX(keys, i, const void *),
+                                    values[i], scratch_pool));
+
+#else
+
+  svn_membuffer_cache_t *cache = cache_void;
+  batch_entry_t *entries;
+  int count, first, last, i;
+
+  /* Serialize all items before we acquire any lock. */
+  prepare_batch(&entries, &count, cache, keys, scratch_pool);
+  for (i = 0; i < count; ++i)
+    if (values[entries[i].idx])
+      SVN_ERR(cache->serializer(&entries[i].buffer, &entries[i].size,
+                                values[entries[i].idx], scratch_pool));
+
+  /* (probably) add the items to the cache, one segment at a time. */
+  for (first = 0; first < count; first = last)
+    {
+      svn_membuffer_t *segment = entries[first].segment;
+      for (last = first + 1;
+           last < count && entries[last].segment == segment;
+           ++last)
+        ;
+
+      SVN_ERR(membuffer_cache_set_batch(segment, entries + first,
+                                        last - first, cache->priority,
+                                        scratch_pool));
+    }
+
+#endif
+
+  return SVN_NO_ERROR;
+}
+
 /* Implement svn_cache__vtable_t.is_cachable
  * (thread-safe even without mutex)
  */
@@ -3186,7 +3490,9 @@ static svn_cache__vtable_t membuffer_cache_vtable = {
   svn_membuffer_cache_is_cachable,
   svn_membuffer_cache_get_partial,
   svn_membuffer_cache_set_partial,
-  svn_membuffer_cache_get_info
+  svn_membuffer_cache_get_info,
+  svn_membuffer_cache_get_many,
+  svn_membuffer_cache_set_many
 };
 
 /* Implement svn_cache__vtable_t.get and serialize all cache access.
@@ -3289,6 +3595,44 @@ svn_membuffer_cache_set_partial_synced(void *cache_void,
   return SVN_NO_ERROR;
 }
 
+/* Implement svn_cache__vtable_t.get_many and serialize all cache access.
+ */
+static svn_error_t *
+svn_membuffer_cache_get_many_synced(void **values,
+                                    svn_boolean_t *found,
+                                    void *cache_void,
+                                    const apr_array_header_t *keys,
+                                    apr_pool_t *result_pool)
+{
+  svn_membuffer_cache_t *cache = cache_void;
+  SVN_MUTEX__WITH_LOCK(cache->mutex,
+                       svn_membuffer_cache_get_many(values,
+                                                    found,
+                                                    cache_void,
+                                                    keys,
+                                                    result_pool));
+
+  return SVN_NO_ERROR;
+}
+
+/* Implement svn_cache__vtable_t.set_many and serialize all cache access.
+ */
+static svn_error_t *
+svn_membuffer_cache_set_many_synced(void *cache_void,
+                                    const apr_array_header_t *keys,
+                                    void **values,
+                                    apr_pool_t *scratch_pool)
+{
+  svn_membuffer_cache_t *cache = cache_void;
+  SVN_MUTEX__WITH_LOCK(cache->mutex,
+                       svn_membuffer_cache_set_many(cache_void,
+                                                    keys,
+                                                    values,
+                                                    scratch_pool));
+
+  return SVN_NO_ERROR;
+}
+
 /* the v-table for membuffer-based caches with multi-threading support)
  */
 static svn_cache__vtable_t membuffer_cache_synced_vtable = {
@@ -3299,7 +3643,9 @@ static svn_cache__vtable_t membuffer_cache_synced_vtable = {
   svn_membuffer_cache_is_cachable,        /* no sync required */
   svn_membuffer_cache_get_partial_synced,
   svn_membuffer_cache_set_partial_synced,
-  svn_membuffer_cache_get_info            /* no sync required */
+  svn_membuffer_cache_get_info,           /* no sync required */
+  svn_membuffer_cache_get_many_synced,
+  svn_membuffer_cache_set_many_synced
 };
 
 /* standard serialization function for svn_stringbuf_t items.
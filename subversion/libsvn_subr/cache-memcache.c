@@ -23,6 +23,7 @@
 
 #include <apr_md5.h>
 
+#include "svn_hash.h"
 #include "svn_pools.h"
 #include "svn_base64.h"
 #include "svn_path.h"
@@ -364,6 +365,120 @@ memcache_iter(svn_boolean_t *completed,
                           _("Can't iterate a memcached cache"));
 }
 
+/* Send a single multi-get request for all KEYS of CACHE to the memcached
+ * servers and return the results in VALUES and FOUND.  Allocate those in
+ * RESULT_POOL and use SCRATCH_POOL for temporaries.
+ */
+static svn_error_t *
+memcache_get_many_internal(void **values,
+                           svn_boolean_t *found,
+                           memcache_t *cache,
+                           const apr_array_header_t *keys,
+                           apr_pool_t *result_pool,
+                           apr_pool_t *scratch_pool)
+{
+  apr_hash_t *mc_values = NULL;
+  const char **mc_keys = apr_pcalloc(scratch_pool,
+                                     keys->nelts * sizeof(*mc_keys));
+  apr_status_t apr_err;
+  int i;
+
+  for (i = 0; i < keys->nelts; ++i)
+    {
+      const void *key = APR_ARRAY_IDX(keys, i, const void *);
+
+      values[i] = NULL;
+      found[i] = FALSE;
+
+      if (key == NULL)
+        continue;
+
+      SVN_ERR(build_key(&mc_keys[i], cache, key, scratch_pool));
+      apr_memcache_add_multget_key(scratch_pool, mc_keys[i], &mc_values);
+    }
+
+  if (mc_values == NULL)
+    return SVN_NO_ERROR;
+
+  /* The data returned will be allocated in RESULT_POOL such that the
+   * deserialized items may reference it. */
+  apr_err = apr_memcache_multgetp(cache->memcache, scratch_pool, result_pool,
+                                  mc_values);
+  if (apr_err != APR_SUCCESS && apr_err != APR_NOTFOUND)
+    return svn_error_wrap_apr(apr_err,
+                              _("Unknown memcached error while reading"));
+
+  for (i = 0; i < keys->nelts; ++i)
+    {
+      apr_memcache_value_t *value;
+
+      if (mc_keys[i] == NULL)
+        continue;
+
+      value = svn_hash_gets(mc_values, mc_keys[i]);
+      if (value == NULL || value->status != APR_SUCCESS || !value->data)
+        continue;
+
+      found[i] = TRUE;
+      if (cache->deserialize_func)
+        {
+          SVN_ERR((cache->deserialize_func)(&values[i], value->data,
+                                            value->len, result_pool));
+        }
+      else
+        {
+          svn_stringbuf_t *str = svn_stringbuf_create_empty(result_pool);
+          str->data = value->data;
+          str->blocksize = value->len;
+          str->len = value->len - 1; /* account for trailing NUL */
+          values[i] = str;
+        }
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Implement vtable.get_many by sending a single multi-get request to the
+ * memcached servers instead of one request per key.
+ */
+static svn_error_t *
+memcache_get_many(void **values,
+                  svn_boolean_t *found,
+                  void *cache_void,
+                  const apr_array_header_t *keys,
+                  apr_pool_t *result_pool)
+{
+  apr_pool_t *subpool = svn_pool_create(result_pool);
+  svn_error_t *err = memcache_get_many_internal(values, found, cache_void,
+                                                keys, result_pool, subpool);
+  svn_pool_destroy(subpool);
+
+  return svn_error_trace(err);
+}
+
+/* Implement vtable.set_many.  APR's memcache client has no multi-set
+ * operation, so we simply store one item after the other.
+ */
+static svn_error_t *
+memcache_set_many(void *cache_void,
+                  const apr_array_header_t *keys,
+                  void **values,
+                  apr_pool_t *scratch_pool)
+{
+  apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+  int i;
+
+  for (i = 0; i < keys->nelts; ++i)
+    {
+      svn_pool_clear(iterpool);
+      SVN_ERR(memcache_set(cache_void, APR_ARRAY_IDX(keys, i, const void *),
+                           values[i], iterpool));
+    }
+
+  svn_pool_destroy(iterpool);
+  return SVN_NO_ERROR;
+}
+
 static svn_boolean_t
 memcache_is_cachable(void *unused, apr_size_t size)
 {
@@ -398,7 +513,9 @@ static svn_cache__vtable_t memcache_vtable = {
   memcache_is_cachable,
   memcache_get_partial,
   memcache_set_partial,
-  memcache_get_info
+  memcache_get_info,
+  memcache_get_many,
+  memcache_set_many
 };
 
 svn_error_t *
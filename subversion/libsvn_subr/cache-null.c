@@ -130,6 +130,35 @@ null_cache_get_info(void *cache_void,
   return SVN_NO_ERROR;
 }
 
+static svn_error_t *
+null_cache_get_many(void **values,
+                    svn_boolean_t *found,
+                    void *cache_void,
+                    const apr_array_header_t *keys,
+                    apr_pool_t *result_pool)
+{
+  int i;
+
+  /* We know there is nothing to be found in this cache. */
+  for (i = 0; i < keys->nelts; ++i)
+    {
+      values[i] = NULL;
+      found[i] = FALSE;
+    }
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+null_cache_set_many(void *cache_void,
+                    const apr_array_header_t *keys,
+                    void **values,
+                    apr_pool_t *scratch_pool)
+{
+  /* We won't cache anything. */
+  return SVN_NO_ERROR;
+}
+
 static svn_cache__vtable_t null_cache_vtable = {
   null_cache_get,
   null_cache_has_key,
@@ -138,7 +167,9 @@ static svn_cache__vtable_t null_cache_vtable = {
   null_cache_is_cachable,
   null_cache_get_partial,
   null_cache_set_partial,
-  null_cache_get_info
+  null_cache_get_info,
+  null_cache_get_many,
+  null_cache_set_many
 };
 
 svn_error_t *
@@ -130,6 +130,60 @@ svn_cache__set(svn_cache__t *cache,
                       scratch_pool);
 }
 
+svn_error_t *
+svn_cache__get_many(void **values,
+                    svn_boolean_t *found,
+                    svn_cache__t *cache,
+                    const apr_array_header_t *keys,
+                    apr_pool_t *result_pool)
+{
+  svn_error_t *err;
+  int i;
+
+  /* In case any errors happen and are quelched, make sure we start
+     out with nothing being found. */
+  for (i = 0; i < keys->nelts; ++i)
+    {
+      values[i] = NULL;
+      found[i] = FALSE;
+    }
+
+#ifdef SVN_DEBUG
+  if (cache->pretend_empty)
+    return SVN_NO_ERROR;
+#endif
+
+  cache->reads += keys->nelts;
+  err = handle_error(cache,
+                     (cache->vtable->get_many)(values,
+                                               found,
+                                               cache->cache_internal,
+                                               keys,
+                                               result_pool),
+                     result_pool);
+
+  for (i = 0; i < keys->nelts; ++i)
+    if (found[i])
+      cache->hits++;
+
+  return err;
+}
+
+svn_error_t *
+svn_cache__set_many(svn_cache__t *cache,
+                    const apr_array_header_t *keys,
+                    void **values,
+                    apr_pool_t *scratch_pool)
+{
+  cache->writes += keys->nelts;
+  return handle_error(cache,
+                      (cache->vtable->set_many)(cache->cache_internal,
+                                                keys,
+                                                values,
+                                                scratch_pool),
+                      scratch_pool);
+}
+
 
 svn_error_t *
 svn_cache__iter(svn_boolean_t *completed,
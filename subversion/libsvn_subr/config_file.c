@@ -1502,6 +1502,11 @@ svn_config_ensure(const char *config_dir, apr_pool_t *pool)
         "### ra_local (the file:// scheme). The value represents the number" NL
         "### of MB used by the cache."                                       NL
         "# memory-cache-size = 16"                                           NL
+        "### Set list-threads to the number of threads used to walk the"     NL
+        "### repository tree for recursive 'svn list' requests when"         NL
+        "### accessing a repository via ra_local (the file:// scheme)."      NL
+        "### It defaults to 1, i.e. no additional threads."                  NL
+        "# list-threads = 4"                                                 NL
         "### Set diff-ignore-content-type to 'yes' to cause 'svn diff' to"   NL
         "### attempt to show differences of all modified files regardless"   NL
         "### of their MIME content type.  By default, Subversion will only"  NL
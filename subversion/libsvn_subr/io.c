@@ -69,6 +69,15 @@
 #include "private/svn_utf_private.h"
 #include "private/svn_dep_compat.h"
 
+#ifdef HAVE_COPY_FILE_RANGE
+#include <errno.h>
+#endif
+
+#if defined(HAVE_LINUX_FS_H)
+#include <sys/ioctl.h>
+#include <linux/fs.h>
+#endif
+
 #define SVN_SLEEP_ENV_VAR "SVN_I_LOVE_CORRUPTED_WORKING_COPIES_SO_DISABLE_SLEEP_FOR_TIMESTAMPS"
 
 /*
@@ -880,8 +889,89 @@ svn_io_temp_dir(const char **dir,
 
 /*** Creating, copying and appending files. ***/
 
+/* Try to have the OS kernel transfer the contents of FROM_FILE to TO_FILE
+ * without passing the data through user space.  If both files reside on
+ * the same file system and it supports reflinks, the copy will share the
+ * data blocks with the source.  Both files must be positioned at offset 0
+ * and TO_FILE must be empty.
+ *
+ * Set *DONE_P to TRUE if the contents have been copied.  Set it to FALSE
+ * if this platform, the file system or the file system pair does not
+ * support in-kernel copies; nothing has been written to TO_FILE then and
+ * the caller should fall back to copying the data itself.
+ */
+static apr_status_t
+copy_contents_in_kernel(svn_boolean_t *done_p,
+                        apr_file_t *from_file,
+                        apr_file_t *to_file)
+{
+#if (defined(HAVE_LINUX_FS_H) && defined(FICLONE)) \
+    || defined(HAVE_COPY_FILE_RANGE)
+  apr_os_file_t from_fd;
+  apr_os_file_t to_fd;
+
+  *done_p = FALSE;
+  if (   apr_os_file_get(&from_fd, from_file)
+      || apr_os_file_get(&to_fd, to_file))
+    return APR_SUCCESS;
+
+#if defined(HAVE_LINUX_FS_H) && defined(FICLONE)
+  /* Share all data blocks with the source. */
+  if (ioctl(to_fd, FICLONE, from_fd) == 0)
+    {
+      *done_p = TRUE;
+      return APR_SUCCESS;
+    }
+#endif
+
+#ifdef HAVE_COPY_FILE_RANGE
+  {
+    svn_boolean_t first_chunk = TRUE;
+
+    /* Copy in chunks that are large but safely fit into a ssize_t. */
+    while (1)
+      {
+        ssize_t copied = copy_file_range(from_fd, NULL, to_fd, NULL,
+                                         0x40000000, 0);
+        if (copied > 0)
+          {
+            first_chunk = FALSE;
+          }
+        else if (copied == 0)
+          {
+            /* Some pseudo file systems report EOF right away.  Let the
+             * caller handle empty files, then. */
+            *done_p = !first_chunk;
+            return APR_SUCCESS;
+          }
+        else if (errno == EINTR)
+          {
+            continue;
+          }
+        else if (first_chunk
+                 && (   errno == EXDEV || errno == ENOSYS || errno == EINVAL
+                     || errno == EOPNOTSUPP || errno == EBADF
+                     || errno == EPERM))
+          {
+            return APR_SUCCESS;
+          }
+        else
+          {
+            return apr_get_os_error();
+          }
+      }
+  }
+#endif
+
+  return APR_SUCCESS;
+#else
+  *done_p = FALSE;
+  return APR_SUCCESS;
+#endif
+}
+
 /* Transfer the contents of FROM_FILE to TO_FILE, using POOL for temporary
- * allocations.
+ * allocations.  FROM_FILE must be at offset 0 and TO_FILE must be empty.
  *
  * NOTE: We don't use apr_copy_file() for this, since it takes filenames
  * as parameters.  Since we want to copy to a temporary file
@@ -894,6 +984,11 @@ copy_contents(apr_file_t *from_file,
               apr_file_t *to_file,
               apr_pool_t *pool)
 {
+  svn_boolean_t done;
+  apr_status_t status = copy_contents_in_kernel(&done, from_file, to_file);
+  if (status || done)
+    return status;
+
   /* Copy bytes till the cows come home. */
   while (1)
     {
@@ -4190,6 +4285,25 @@ svn_io_file_aligned_seek(apr_file_t *file,
 }
 
 
+svn_error_t *
+svn_io__file_readahead(apr_file_t *file,
+                       apr_off_t offset,
+                       apr_off_t length,
+                       apr_pool_t *scratch_pool)
+{
+#if defined(HAVE_POSIX_FADVISE) && defined(POSIX_FADV_WILLNEED)
+  apr_os_file_t fd;
+
+  /* This is advisory only.  Failures such as EINVAL on pipes or on file
+     systems that don't support read-ahead are not worth reporting. */
+  if (length > 0 && apr_os_file_get(&fd, file) == APR_SUCCESS)
+    (void)posix_fadvise(fd, offset, length, POSIX_FADV_WILLNEED);
+#endif
+
+  return SVN_NO_ERROR;
+}
+
+
 svn_error_t *
 svn_io_file_write(apr_file_t *file, const void *buf,
                   apr_size_t *nbytes, apr_pool_t *pool)
@@ -431,6 +431,21 @@ int dav_svn__get_compression_level(request_rec *r);
 /* Return the hook script environment parsed from the configuration. */
 const char *dav_svn__get_hooks_env(request_rec *r);
 
+/* Return the maximum size of a cached update report for the repository
+   referred to by this request.  0 means that caching is disabled. */
+apr_uint64_t dav_svn__get_report_cache_size(request_rec *r);
+
+/* Return the maximum size of a cached replay for the repository
+   referred to by this request.  0 means that caching is disabled. */
+apr_uint64_t dav_svn__get_replay_cache_size(request_rec *r);
+
+/* Return the number of threads to use for recursive list requests. */
+int dav_svn__get_list_thread_count(request_rec *r);
+
+/* Return the maximum size of files to compute blames for in this
+   request.  0 means that there is no limit. */
+svn_filesize_t dav_svn__get_blame_max_size(request_rec *r);
+
 /** For HTTP protocol v2, these are the new URIs and URI stubs
     returned to the client in our OPTIONS response.  They all depend
     on the 'special uri', which is configurable in httpd.conf.  **/
@@ -705,6 +720,7 @@ static const dav_report_elem dav_svn__reports_list[] = {
   { SVN_XML_NAMESPACE, SVN_DAV__MERGEINFO_REPORT },
   { SVN_XML_NAMESPACE, SVN_DAV__INHERITED_PROPS_REPORT },
   { SVN_XML_NAMESPACE, "list-report" },
+  { SVN_XML_NAMESPACE, "blame-report" },
   { NULL, NULL },
 };
 
@@ -762,6 +778,11 @@ dav_svn__list_report(const dav_resource *resource,
                      const apr_xml_doc *doc,
                      dav_svn__output *output);
 
+dav_error *
+dav_svn__blame_report(const dav_resource *resource,
+                      const apr_xml_doc *doc,
+                      dav_svn__output *output);
+
 /*** posts/ ***/
 
 /* The various POST handlers, defined in posts/, and used by repos.c.  */
@@ -57,6 +57,10 @@
  * subreq mechanism and make a call directly to mod_authz_svn. */
 #define PATHAUTHZ_BYPASS_ARG "short_circuit"
 
+/* Default limit to the size of files that we compute blames for.  The
+   server holds two revisions of the file in memory while doing so. */
+#define DEFAULT_BLAME_MAX_SIZE (64 * 0x100000)
+
 /* per-server configuration */
 typedef struct server_conf_t {
   const char *special_uri;
@@ -108,6 +112,10 @@ typedef struct dir_conf_t {
   enum conf_flag nodeprop_cache;     /* whether to enable nodeprop caching */
   enum conf_flag block_read;         /* whether to enable block read mode */
   const char *hooks_env;             /* path to hook script env config file */
+  apr_uint64_t report_cache_size;    /* max. total size of cached reports */
+  apr_uint64_t replay_cache_size;    /* max. size of cached replays */
+  int list_thread_count;             /* threads for recursive lists */
+  svn_filesize_t blame_max_size;     /* largest file to blame, -1 = any */
 } dir_conf_t;
 
 
@@ -288,6 +296,13 @@ merge_dir_config(apr_pool_t *p, void *base, void *overrides)
   newconf->block_read = INHERIT_VALUE(parent, child, block_read);
   newconf->root_dir = INHERIT_VALUE(parent, child, root_dir);
   newconf->hooks_env = INHERIT_VALUE(parent, child, hooks_env);
+  newconf->report_cache_size = INHERIT_VALUE(parent, child,
+                                             report_cache_size);
+  newconf->replay_cache_size = INHERIT_VALUE(parent, child,
+                                             replay_cache_size);
+  newconf->list_thread_count = INHERIT_VALUE(parent, child,
+                                             list_thread_count);
+  newconf->blame_max_size = INHERIT_VALUE(parent, child, blame_max_size);
 
   if (parent->fs_path)
     ap_log_error(APLOG_MARK, APLOG_WARNING, 0, NULL,
@@ -681,6 +696,76 @@ SVNHooksEnv_cmd(cmd_parms *cmd, void *config, const char *arg1)
   return NULL;
 }
 
+static const char *
+SVNCacheUpdateReports_cmd(cmd_parms *cmd, void *config, const char *arg1)
+{
+  dir_conf_t *conf = config;
+  apr_uint64_t value = 0;
+  svn_error_t *err = svn_cstring_atoui64(&value, arg1);
+  if (err)
+    {
+      svn_error_clear(err);
+      return "Invalid decimal number for the SVN update report cache size.";
+    }
+
+  conf->report_cache_size = value * 0x100000;
+
+  return NULL;
+}
+
+static const char *
+SVNCacheReplays_cmd(cmd_parms *cmd, void *config, const char *arg1)
+{
+  dir_conf_t *conf = config;
+  apr_uint64_t value = 0;
+  svn_error_t *err = svn_cstring_atoui64(&value, arg1);
+  if (err)
+    {
+      svn_error_clear(err);
+      return "Invalid decimal number for the SVN replay cache size.";
+    }
+
+  conf->replay_cache_size = value * 0x100000;
+
+  return NULL;
+}
+
+static const char *
+SVNListThreads_cmd(cmd_parms *cmd, void *config, const char *arg1)
+{
+  dir_conf_t *conf = config;
+  apr_int64_t value = 0;
+  svn_error_t *err = svn_cstring_strtoi64(&value, arg1, 1, APR_INT32_MAX,
+                                          10);
+  if (err)
+    {
+      svn_error_clear(err);
+      return "Invalid number of threads for SVNListThreads.";
+    }
+
+  conf->list_thread_count = (int)value;
+
+  return NULL;
+}
+
+static const char *
+SVNMaxBlameSize_cmd(cmd_parms *cmd, void *config, const char *arg1)
+{
+  dir_conf_t *conf = config;
+  apr_uint64_t value = 0;
+  svn_error_t *err = svn_cstring_atoui64(&value, arg1);
+  if (err)
+    {
+      svn_error_clear(err);
+      return "Invalid decimal number for the SVN blame size limit.";
+    }
+
+  /* 0 would be indistinguishable from "not set" when merging configs. */
+  conf->blame_max_size = value ? (svn_filesize_t)value * 0x100000 : -1;
+
+  return NULL;
+}
+
 static svn_boolean_t
 get_conf_flag(enum conf_flag flag, svn_boolean_t default_value)
 {
@@ -1061,6 +1146,45 @@ dav_svn__get_hooks_env(request_rec *r)
   return conf->hooks_env;
 }
 
+apr_uint64_t
+dav_svn__get_report_cache_size(request_rec *r)
+{
+  dir_conf_t *conf;
+
+  conf = ap_get_module_config(r->per_dir_config, &dav_svn_module);
+  return conf->report_cache_size;
+}
+
+apr_uint64_t
+dav_svn__get_replay_cache_size(request_rec *r)
+{
+  dir_conf_t *conf;
+
+  conf = ap_get_module_config(r->per_dir_config, &dav_svn_module);
+  return conf->replay_cache_size;
+}
+
+int
+dav_svn__get_list_thread_count(request_rec *r)
+{
+  dir_conf_t *conf;
+
+  conf = ap_get_module_config(r->per_dir_config, &dav_svn_module);
+  return conf->list_thread_count ? conf->list_thread_count : 1;
+}
+
+svn_filesize_t
+dav_svn__get_blame_max_size(request_rec *r)
+{
+  dir_conf_t *conf;
+
+  conf = ap_get_module_config(r->per_dir_config, &dav_svn_module);
+  if (conf->blame_max_size == 0)
+    return DEFAULT_BLAME_MAX_SIZE;
+
+  return conf->blame_max_size < 0 ? 0 : conf->blame_max_size;
+}
+
 static void
 merge_xml_filter_insert(request_rec *r)
 {
@@ -1415,6 +1539,40 @@ static const command_rec cmds[] =
                 "of hook scripts. If not absolute, the path is relative to "
                 "the repository's conf directory (by default the hooks-env "
                 "file in the repository is used)."),
+
+  /* per directory/location */
+  AP_INIT_TAKE1("SVNCacheUpdateReports", SVNCacheUpdateReports_cmd, NULL,
+                ACCESS_CONF|RSRC_CONF,
+                "specifies the maximum total size in MB of update and "
+                "checkout responses to keep in the repository's "
+                "report-cache directory for identical requests; the least "
+                "recently used ones are removed first (default is 0, which "
+                "disables the cache).  Only responses for requests without "
+                "path-based authorization are cached."),
+
+  /* per directory/location */
+  AP_INIT_TAKE1("SVNCacheReplays", SVNCacheReplays_cmd, NULL,
+                ACCESS_CONF|RSRC_CONF,
+                "specifies the maximum size in MB of replayed revisions, "
+                "as requested by svnsync, to keep in the repository's "
+                "replay-cache directory (default is 0, which disables the "
+                "cache).  Only replays without path-based authorization "
+                "are cached."),
+
+  /* per directory/location */
+  AP_INIT_TAKE1("SVNListThreads", SVNListThreads_cmd, NULL,
+                ACCESS_CONF|RSRC_CONF,
+                "specifies the number of threads used to walk the "
+                "repository tree for recursive list requests (default "
+                "is 1, i.e. no additional threads)."),
+
+  /* per directory/location */
+  AP_INIT_TAKE1("SVNMaxBlameSize", SVNMaxBlameSize_cmd, NULL,
+                ACCESS_CONF|RSRC_CONF,
+                "specifies the maximum size in MB of files to compute "
+                "blames for on the server; clients fall back to their own "
+                "blame computation for larger files (default is 64, 0 "
+                "disables the limit)."),
   { NULL }
 };
 
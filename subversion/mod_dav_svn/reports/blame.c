@@ -0,0 +1,292 @@
+/*
+ * blame.c: mod_dav_svn REPORT handler for server-side line annotation
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+#include <apr_pools.h>
+#include <apr_strings.h>
+#include <apr_xml.h>
+
+#include <mod_dav.h>
+
+#include "svn_repos.h"
+#include "svn_string.h"
+#include "svn_types.h"
+#include "svn_base64.h"
+#include "svn_xml.h"
+#include "svn_path.h"
+#include "svn_dav.h"
+#include "svn_pools.h"
+#include "svn_diff.h"
+
+#include "private/svn_log.h"
+#include "private/svn_fspath.h"
+
+#include "../dav_svn.h"
+
+/* Baton type to be used with blame_receiver. */
+typedef struct blame_receiver_baton_t
+{
+  /* this buffers the output for a bit and is automatically flushed,
+     at appropriate times, by the Apache filter system. */
+  apr_bucket_brigade *bb;
+
+  /* where to deliver the output */
+  dav_svn__output *output;
+
+  /* Whether we've written the <S:blame-report> header.  Allows for lazy
+     writes to support mod_dav-based error handling. */
+  svn_boolean_t needs_header;
+
+  /* The revisions (svn_revnum_t) whose revprops have already been sent. */
+  apr_hash_t *sent_revs;
+} blame_receiver_baton_t;
+
+
+/* If BRB->needs_header is true, send the "<S:blame-report>" start
+   element and set BRB->needs_header to zero.  Else do nothing. */
+static svn_error_t *
+maybe_send_header(blame_receiver_baton_t *brb)
+{
+  if (brb->needs_header)
+    {
+      SVN_ERR(dav_svn__brigade_puts(brb->bb, brb->output,
+                                    DAV_XML_HEADER DEBUG_CR
+                                    "<S:blame-report xmlns:S=\""
+                                    SVN_XML_NAMESPACE "\" "
+                                    "xmlns:D=\"DAV:\">" DEBUG_CR));
+      brb->needs_header = FALSE;
+    }
+
+  return SVN_NO_ERROR;
+}
+
+
+/* Send VAL as contents of the element ELEM_OPEN ... ELEM_NAME, where
+   ELEM_OPEN is the already quoted start tag without its closing '>'.
+   Base64-encode VAL if necessary. */
+static svn_error_t *
+send_element(blame_receiver_baton_t *brb,
+             const char *elem_open,
+             const char *elem_name,
+             const svn_string_t *val,
+             apr_pool_t *pool)
+{
+  if (svn_xml_is_xml_safe(val->data, val->len))
+    {
+      svn_stringbuf_t *tmp = NULL;
+      svn_xml_escape_cdata_string(&tmp, val, pool);
+      SVN_ERR(dav_svn__brigade_printf(brb->bb, brb->output,
+                                      "%s>%s</S:%s>" DEBUG_CR,
+                                      elem_open, tmp ? tmp->data : "",
+                                      elem_name));
+    }
+  else
+    {
+      val = svn_base64_encode_string2(val, TRUE, pool);
+      SVN_ERR(dav_svn__brigade_printf(brb->bb, brb->output,
+                                      "%s encoding=\"base64\">%s</S:%s>"
+                                      DEBUG_CR,
+                                      elem_open, val->data, elem_name));
+    }
+
+  return SVN_NO_ERROR;
+}
+
+
+/* Implements svn_repos_blame_receiver_t, sending LINE and REVISION to
+ * the client.  The REV_PROPS are sent in a separate element before the
+ * first line attributed to REVISION.  BATON must be a
+ * blame_receiver_baton_t. */
+static svn_error_t *
+blame_receiver(void *baton,
+               apr_int64_t line_no,
+               svn_revnum_t revision,
+               apr_hash_t *rev_props,
+               const svn_string_t *line,
+               apr_pool_t *pool)
+{
+  blame_receiver_baton_t *brb = baton;
+  const char *elem_open;
+
+  SVN_ERR(maybe_send_header(brb));
+
+  if (SVN_IS_VALID_REVNUM(revision)
+      && !apr_hash_get(brb->sent_revs, &revision, sizeof(revision)))
+    {
+      svn_revnum_t *key = apr_pmemdup(apr_hash_pool_get(brb->sent_revs),
+                                      &revision, sizeof(revision));
+      apr_hash_index_t *hi;
+
+      apr_hash_set(brb->sent_revs, key, sizeof(*key), key);
+
+      SVN_ERR(dav_svn__brigade_printf(brb->bb, brb->output,
+                                      "<S:revision rev=\"%ld\">" DEBUG_CR,
+                                      revision));
+      for (hi = apr_hash_first(pool, rev_props); hi; hi = apr_hash_next(hi))
+        {
+          const char *name = apr_hash_this_key(hi);
+          const svn_string_t *value = apr_hash_this_val(hi);
+
+          elem_open = apr_psprintf(pool, "<S:rev-prop name=\"%s\"",
+                                   apr_xml_quote_string(pool, name, 1));
+          SVN_ERR(send_element(brb, elem_open, "rev-prop", value, pool));
+        }
+      SVN_ERR(dav_svn__brigade_puts(brb->bb, brb->output,
+                                    "</S:revision>" DEBUG_CR));
+    }
+
+  if (SVN_IS_VALID_REVNUM(revision))
+    elem_open = apr_psprintf(pool, "<S:line rev=\"%ld\"", revision);
+  else
+    elem_open = "<S:line";
+
+  return svn_error_trace(send_element(brb, elem_open, "line", line, pool));
+}
+
+dav_error *
+dav_svn__blame_report(const dav_resource *resource,
+                      const apr_xml_doc *doc,
+                      dav_svn__output *output)
+{
+  svn_error_t *serr;
+  dav_error *derr = NULL;
+  apr_xml_elem *child;
+  blame_receiver_baton_t brb = { 0 };
+  dav_svn__authz_read_baton arb;
+  int ns;
+  const char *abs_path = NULL;
+  svn_diff_file_options_t *diff_options;
+
+  /* These get determined from the request document. */
+  svn_revnum_t start = SVN_INVALID_REVNUM;
+  svn_revnum_t end = SVN_INVALID_REVNUM;
+
+  /* Sanity check. */
+  if (!resource->info->repos_path)
+    return dav_svn__new_error(resource->pool, HTTP_BAD_REQUEST, 0, 0,
+                              "The request does not specify a repository path");
+  ns = dav_svn__find_ns(doc->namespaces, SVN_XML_NAMESPACE);
+  if (ns == -1)
+    {
+      return dav_svn__new_error_svn(resource->pool, HTTP_BAD_REQUEST, 0, 0,
+                                    "The request does not contain the 'svn:' "
+                                    "namespace, so it is not going to have "
+                                    "certain required elements");
+    }
+
+  diff_options = svn_diff_file_options_create(resource->pool);
+  for (child = doc->root->first_child; child != NULL; child = child->next)
+    {
+      /* if this element isn't one of ours, then skip it */
+      if (child->ns != ns)
+        continue;
+
+      if (strcmp(child->name, "start-revision") == 0)
+        start = SVN_STR_TO_REV(dav_xml_get_cdata(child, resource->pool, 1));
+      else if (strcmp(child->name, "end-revision") == 0)
+        end = SVN_STR_TO_REV(dav_xml_get_cdata(child, resource->pool, 1));
+      else if (strcmp(child->name, "ignore-space") == 0)
+        {
+          const char *value = dav_xml_get_cdata(child, resource->pool, 1);
+          if (strcmp(value, "change") == 0)
+            diff_options->ignore_space = svn_diff_file_ignore_space_change;
+          else if (strcmp(value, "all") == 0)
+            diff_options->ignore_space = svn_diff_file_ignore_space_all;
+        }
+      else if (strcmp(child->name, "ignore-eol-style") == 0)
+        diff_options->ignore_eol_style = TRUE; /* presence indicates
+                                                  positivity */
+      else if (strcmp(child->name, "path") == 0)
+        {
+          const char *rel_path = dav_xml_get_cdata(child, resource->pool, 0);
+          if ((derr = dav_svn__test_canonical(rel_path, resource->pool)))
+            return derr;
+
+          /* Force REL_PATH to be a relative path, not an fspath. */
+          rel_path = svn_relpath_canonicalize(rel_path, resource->pool);
+
+          /* Append the REL_PATH to the base FS path to get an
+             absolute repository path. */
+          abs_path = svn_fspath__join(resource->info->repos_path, rel_path,
+                                      resource->pool);
+        }
+      /* else unknown element; skip it */
+    }
+
+  /* Check that all parameters are present and valid. */
+  if (! abs_path || ! SVN_IS_VALID_REVNUM(start)
+      || ! SVN_IS_VALID_REVNUM(end))
+    return dav_svn__new_error_svn(resource->pool, HTTP_BAD_REQUEST, 0, 0,
+                                  "Not all parameters passed");
+
+  /* Build authz read baton */
+  arb.r = resource->info->r;
+  arb.repos = resource->info->repos;
+
+  /* Build blame receiver baton */
+  brb.bb = apr_brigade_create(resource->pool,
+                              dav_svn__output_get_bucket_alloc(output));
+  brb.output = output;
+  brb.needs_header = TRUE;
+  brb.sent_revs = apr_hash_make(resource->pool);
+
+  /* All the work happens before the first line gets reported, so any
+     error will be detected before we start sending the response. */
+  serr = svn_repos_blame(resource->info->repos->repos, abs_path, start, end,
+                         diff_options,
+                         dav_svn__get_blame_max_size(resource->info->r),
+                         dav_svn__authz_read_func(&arb), &arb,
+                         blame_receiver, &brb, NULL, NULL, resource->pool);
+  if (serr)
+    {
+      derr = dav_svn__convert_err(serr, HTTP_BAD_REQUEST, NULL,
+                                  resource->pool);
+      goto cleanup;
+    }
+
+  if ((serr = maybe_send_header(&brb)))
+    {
+      derr = dav_svn__convert_err(serr, HTTP_INTERNAL_SERVER_ERROR,
+                                  "Error beginning REPORT response.",
+                                  resource->pool);
+      goto cleanup;
+    }
+
+  if ((serr = dav_svn__brigade_puts(brb.bb, brb.output,
+                                    "</S:blame-report>" DEBUG_CR)))
+    {
+      derr = dav_svn__convert_err(serr, HTTP_INTERNAL_SERVER_ERROR,
+                                  "Error ending REPORT response.",
+                                  resource->pool);
+      goto cleanup;
+    }
+
+ cleanup:
+
+  /* We've detected a 'high level' svn action to log. */
+  dav_svn__operational_log(resource->info,
+                           svn_log__blame(abs_path, start, end,
+                                          resource->pool));
+
+  return dav_svn__final_flush_or_error(resource->info->r, brb.bb, output,
+                                       derr, resource->pool);
+}
@@ -202,7 +202,6 @@ dav_svn__list_report(const dav_resource *resource,
   const dav_svn_repos *repos = resource->info->repos;
   int ns;
   const char *full_path = NULL;
-  svn_boolean_t path_info_only;
   svn_fs_root_t *root;
   svn_depth_t depth = svn_depth_unknown;
 
@@ -303,10 +302,12 @@ dav_svn__list_report(const dav_resource *resource,
   if (!serr)
     {
       /* Fetch the directory entries if requested and send them immediately. */
-      path_info_only = (lrb.dirent_fields & ~SVN_DIRENT_KIND) == 0;
-      serr = svn_repos_list(root, full_path, patterns, depth, path_info_only,
-                            dav_svn__authz_read_func(&arb), &arb,
-                            list_receiver, &lrb, NULL, NULL, resource->pool);
+      serr = svn_repos_list2(root, full_path, patterns, depth,
+                             lrb.dirent_fields,
+                             dav_svn__get_list_thread_count(arb.r),
+                             dav_svn__authz_read_func(&arb), &arb,
+                             list_receiver, &lrb, NULL, NULL,
+                             resource->pool);
     }
 
   if (serr)
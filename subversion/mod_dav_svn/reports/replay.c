@@ -38,6 +38,7 @@
 #include "svn_dav.h"
 #include "svn_props.h"
 #include "private/svn_log.h"
+#include "private/svn_repos_private.h"
 
 #include "../dav_svn.h"
 
@@ -550,10 +551,13 @@ dav_svn__replay_report(const dav_resource *resource,
               resource->info->svndiff_version,
               resource->pool);
 
-  if ((err = svn_repos_replay2(root, base_dir, low_water_mark,
-                               send_deltas, editor, edit_baton,
-                               dav_svn__authz_read_func(&arb), &arb,
-                               resource->pool)))
+  /* Without a fingerprint for the path-based authz, the replay cache
+     will only be used if there is no such authz. */
+  if ((err = svn_repos__replay_cached(resource->info->repos->repos, rev,
+                                      base_dir, low_water_mark,
+                                      send_deltas, editor, edit_baton,
+                                      dav_svn__authz_read_func(&arb), &arb,
+                                      NULL, resource->pool)))
     {
       derr = dav_svn__convert_err(err, HTTP_INTERNAL_SERVER_ERROR,
                                   "Problem replaying revision",
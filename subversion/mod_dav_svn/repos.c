@@ -2487,6 +2487,13 @@ get_resource(request_rec *r,
                 HTTP_INTERNAL_SERVER_ERROR, r);
         }
 
+      if (dav_svn__get_report_cache_size(r))
+        svn_repos__enable_report_cache(repos->repos,
+                                       dav_svn__get_report_cache_size(r));
+      if (dav_svn__get_replay_cache_size(r))
+        svn_repos__enable_replay_cache(repos->repos,
+                                       dav_svn__get_replay_cache_size(r));
+
       /* Cache the open repos for the next request on this connection */
       apr_pool_userdata_set(repos->repos, repos_key,
                             NULL, r->connection->pool);
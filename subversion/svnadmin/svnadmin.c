@@ -97,7 +97,10 @@ check_lib_versions(void)
 /** Subcommands. **/
 
 static svn_opt_subcommand_t
+  subcommand_build_mergeinfo_index,
+  subcommand_build_path_index,
   subcommand_build_repcache,
+  subcommand_build_repcache_filter,
   subcommand_crashtest,
   subcommand_create,
   subcommand_delrevprop,
@@ -117,6 +120,7 @@ static svn_opt_subcommand_t
   subcommand_lstxns,
   subcommand_pack,
   subcommand_recover,
+  subcommand_redeltify,
   subcommand_rev_size,
   subcommand_rmlocks,
   subcommand_rmtxns,
@@ -159,7 +163,11 @@ enum svnadmin__cmdline_options_t
     svnadmin__normalize_props,
     svnadmin__exclude,
     svnadmin__include,
-    svnadmin__glob
+    svnadmin__glob,
+    svnadmin__max_chain_length,
+    svnadmin__threads,
+    svnadmin__compare_checksums,
+    svnadmin__bulk
   };
 
 /* Option codes and descriptions.
@@ -298,6 +306,27 @@ static const apr_getopt_option_t options_table[] =
         "                             Character '/' is not treated specially, so\n"
         "                             pattern /*/foo matches paths /a/foo and /a/b/foo.") },
 
+    {"max-chain-length", svnadmin__max_chain_length, 1,
+     N_("rewrite representations with delta chains longer\n"
+        "                             than ARG (default: the longest chain that\n"
+        "                             new commits would create)")},
+
+    {"threads",       svnadmin__threads, 1,
+     N_("copy up to ARG packed shards in parallel.\n"
+        "                             Default: 1.  [used for FSFS repositories only]")},
+
+    {"compare-checksums", svnadmin__compare_checksums, 0,
+     N_("in incremental mode, skip packed shards whose\n"
+        "                             index checksums match those at the destination\n"
+        "                             [used for FSFS repositories only]")},
+
+    {"bulk", svnadmin__bulk, 0,
+     N_("optimize for loading into a new repository:\n"
+        "                             implies --no-flush-to-disk, writes rep-cache\n"
+        "                             entries in batches of 32768 and flushes\n"
+        "                             everything to disk at the end only\n"
+        "                             (faster, but unsafe on power off)")},
+
     {NULL}
   };
 
@@ -307,6 +336,26 @@ static const apr_getopt_option_t options_table[] =
  */
 static const svn_opt_subcommand_desc3_t cmd_table[] =
 {
+  {"build-mergeinfo-index", subcommand_build_mergeinfo_index, {0}, {N_(
+    "usage: svnadmin build-mergeinfo-index REPOS_PATH\n"
+    "\n"), N_(
+    "Create or rebuild the index of paths with mergeinfo that speeds up\n"
+    "'svn mergeinfo' and merges for the repository at REPOS_PATH. Once\n"
+    "created, the index will be kept current by all commits. Run this\n"
+    "again after committing with an older Subversion version.\n"
+   )},
+   {'q', 'M'} },
+
+  {"build-path-index", subcommand_build_path_index, {0}, {N_(
+    "usage: svnadmin build-path-index REPOS_PATH\n"
+    "\n"), N_(
+    "Create or rebuild the index of changed paths that speeds up 'svn log'\n"
+    "and 'svn blame' for the repository at REPOS_PATH. Once created, the\n"
+    "index will be kept current by all commits. Run this again after\n"
+    "committing with an older Subversion version.\n"
+   )},
+   {'q', 'M'} },
+
   {"build-repcache", subcommand_build_repcache, {0}, {N_(
     "usage: svnadmin build-repcache REPOS_PATH [-r LOWER[:UPPER]]\n"
     "\n"), N_(
@@ -317,6 +366,16 @@ static const svn_opt_subcommand_desc3_t cmd_table[] =
    )},
    {'r', 'q', 'M'} },
 
+  {"build-repcache-filter", subcommand_build_repcache_filter, {0}, {N_(
+    "usage: svnadmin build-repcache-filter REPOS_PATH\n"
+    "\n"), N_(
+    "Create or rebuild the filter that allows commits to the repository\n"
+    "at REPOS_PATH to skip most representation cache lookups. Run this\n"
+    "again after committing with an older Subversion version or after\n"
+    "running 'svnadmin build-repcache', which removes the filter.\n"
+   )},
+   {'M'} },
+
   {"crashtest", subcommand_crashtest, {0}, {N_(
     "usage: svnadmin crashtest REPOS_PATH\n"
     "\n"), N_(
@@ -384,8 +443,10 @@ static const svn_opt_subcommand_desc3_t cmd_table[] =
     "excluded, the copy is transformed into an add (unlike in 'svndumpfilter').\n"
    )},
   {'r', svnadmin__incremental, svnadmin__deltas, 'q', 'M', 'F',
-   svnadmin__exclude, svnadmin__include, svnadmin__glob },
-  {{'F', N_("write to file ARG instead of stdout")}} },
+   svnadmin__exclude, svnadmin__include, svnadmin__glob, svnadmin__threads },
+  {{'F', N_("write to file ARG instead of stdout")},
+   {svnadmin__threads, N_("dump up to ARG revision ranges in parallel,\n"
+                          "                             using temporary files.  Default: 1.")}} },
 
   {"dump-revprops", subcommand_dump_revprops, {0}, {N_(
     "usage: svnadmin dump-revprops REPOS_PATH [-r LOWER[:UPPER]]\n"
@@ -429,8 +490,11 @@ static const svn_opt_subcommand_desc3_t cmd_table[] =
     "Make a hot copy of a repository.\n"
     "If --incremental is passed, data which already exists at the destination\n"
     "is not copied again.  Incremental mode is implemented for FSFS repositories.\n"
+    "With --compare-checksums, packed shards of FSFS repositories are compared\n"
+    "by their stored index checksums instead of their timestamps.\n"
    )},
-   {svnadmin__clean_logs, svnadmin__incremental, 'q'} },
+   {svnadmin__clean_logs, svnadmin__incremental, 'q', svnadmin__threads,
+    svnadmin__compare_checksums} },
 
   {"info", subcommand_info, {0}, {N_(
     "usage: svnadmin info REPOS_PATH\n"
@@ -471,8 +535,11 @@ static const svn_opt_subcommand_desc3_t cmd_table[] =
     svnadmin__use_pre_commit_hook, svnadmin__use_post_commit_hook,
     svnadmin__parent_dir, svnadmin__normalize_props,
     svnadmin__bypass_prop_validation, 'M',
-    svnadmin__no_flush_to_disk, 'F'},
-   {{'F', N_("read from file ARG instead of stdin")}} },
+    svnadmin__no_flush_to_disk, svnadmin__bulk, svnadmin__threads, 'F'},
+   {{'F', N_("read from file ARG instead of stdin")},
+    {svnadmin__threads, N_("checksum and deltify the file contents of each\n"
+                           "                             revision using up to ARG threads.  Default: 1.\n"
+                           "                             [used for FSFS repositories only]")}} },
 
   {"load-revprops", subcommand_load_revprops, {0}, {N_(
     "usage: svnadmin load-revprops REPOS_PATH\n"
@@ -533,6 +600,22 @@ static const svn_opt_subcommand_desc3_t cmd_table[] =
    )},
    {svnadmin__wait} },
 
+  {"redeltify", subcommand_redeltify, {0}, {N_(
+    "usage: svnadmin redeltify REPOS_PATH [-r LOWER[:UPPER]]\n"
+    "                          [--max-chain-length N]\n"
+    "\n"), N_(
+    "Shorten overly long delta chains in the packed shards of the repository\n"
+    "at REPOS_PATH that contain revisions LOWER through UPPER. If no\n"
+    "revision arguments are given, process all packed shards.\n"
+    "\n"), N_(
+    "File contents whose delta chains are longer than N get stored again\n"
+    "as deltas against a closer predecessor. The existing data is not\n"
+    "removed, so the repository will grow. Only applies to FSFS\n"
+    "repositories with logical addressing. Other processes that have the\n"
+    "repository open will continue to use the old data until reopened.\n"
+   )},
+   {'r', 'q', 'M', svnadmin__max_chain_length} },
+
   {"rev-size", subcommand_rev_size, {0}, {N_(
     "usage: svnadmin rev-size REPOS_PATH -r REVISION\n"
     "\n"), N_(
@@ -677,6 +760,10 @@ struct svnadmin_opt_state
   apr_array_header_t *exclude;                      /* --exclude */
   apr_array_header_t *include;                      /* --include */
   svn_boolean_t glob;                               /* --pattern */
+  int max_chain_length;                             /* --max-chain-length */
+  int threads;                                      /* --threads */
+  svn_boolean_t compare_checksums;                  /* --compare-checksums */
+  svn_boolean_t bulk;                               /* --bulk */
 
   const char *config_dir;    /* Overriding Configuration Directory */
 };
@@ -1062,7 +1149,7 @@ repos_verify_callback(void *baton,
 
 /* Implementation of svn_repos_notify_func_t to wrap the output to a
    response stream for svn_repos_dump_fs2(), svn_repos_verify_fs(),
-   svn_repos_hotcopy3() and others. */
+   svn_repos_hotcopy4() and others. */
 static void
 repos_notify_handler(void *baton,
                      const svn_repos_notify_t *notify,
@@ -1480,9 +1567,9 @@ subcommand_dump(apr_getopt_t *os, void *baton, apr_pool_t *pool)
                                  "cannot be used simultaneously"));
     }
 
-  SVN_ERR(svn_repos_dump_fs4(repos, out_stream, lower, upper,
+  SVN_ERR(svn_repos_dump_fs5(repos, out_stream, lower, upper,
                              opt_state->incremental, opt_state->use_deltas,
-                             TRUE, TRUE,
+                             TRUE, TRUE, opt_state->threads,
                              !opt_state->quiet ? repos_notify_handler : NULL,
                              feedback_stream,
                              filter_baton.prefixes ? dump_filter_func : NULL,
@@ -1526,8 +1613,8 @@ subcommand_dump_revprops(apr_getopt_t *os, void *baton, apr_pool_t *pool)
   if (! opt_state->quiet)
     feedback_stream = recode_stream_create(stderr, pool);
 
-  SVN_ERR(svn_repos_dump_fs4(repos, out_stream, lower, upper,
-                             FALSE, FALSE, TRUE, FALSE,
+  SVN_ERR(svn_repos_dump_fs5(repos, out_stream, lower, upper,
+                             FALSE, FALSE, TRUE, FALSE, 1,
                              !opt_state->quiet ? repos_notify_handler : NULL,
                              feedback_stream, NULL, NULL,
                              check_cancel, NULL, pool));
@@ -1736,13 +1823,14 @@ subcommand_load(apr_getopt_t *os, void *baton, apr_pool_t *pool)
   if (! opt_state->quiet)
     feedback_stream = recode_stream_create(stdout, pool);
 
-  err = svn_repos_load_fs6(repos, in_stream, lower, upper,
+  err = svn_repos_load_fs7(repos, in_stream, lower, upper,
                            opt_state->uuid_action, opt_state->parent_dir,
                            opt_state->use_pre_commit_hook,
                            opt_state->use_post_commit_hook,
                            !opt_state->bypass_prop_validation,
                            opt_state->ignore_dates,
                            opt_state->normalize_props,
+                           opt_state->threads, opt_state->bulk,
                            opt_state->quiet ? NULL : repos_notify_handler,
                            feedback_stream, check_cancel, NULL, pool);
 
@@ -2376,8 +2464,9 @@ subcommand_hotcopy(apr_getopt_t *os, void *baton, apr_pool_t *pool)
   if (! opt_state->quiet)
     feedback_stream = recode_stream_create(stdout, pool);
 
-  return svn_repos_hotcopy3(opt_state->repository_path, new_repos_path,
+  return svn_repos_hotcopy4(opt_state->repository_path, new_repos_path,
                             opt_state->clean_logs, opt_state->incremental,
+                            opt_state->compare_checksums, opt_state->threads,
                             !opt_state->quiet ? repos_notify_handler : NULL,
                             feedback_stream, check_cancel, NULL, pool);
 }
@@ -3001,6 +3090,75 @@ build_rep_cache(svn_fs_t *fs,
     }
 }
 
+/* This implements `svn_opt_subcommand_t'. */
+static svn_error_t *
+subcommand_build_mergeinfo_index(apr_getopt_t *os, void *baton,
+                                 apr_pool_t *pool)
+{
+  struct svnadmin_opt_state *opt_state = baton;
+  svn_fs_fs__ioctl_build_mergeinfo_index_input_t input = {0};
+  svn_repos_t *repos;
+  svn_fs_t *fs;
+  svn_error_t *err;
+
+  /* Expect no more arguments. */
+  SVN_ERR(parse_args(NULL, os, 0, 0, pool));
+
+  SVN_ERR(open_repos(&repos, opt_state->repository_path, opt_state, pool));
+  fs = svn_repos_fs(repos);
+
+  if (! opt_state->quiet)
+    input.progress_func = build_rep_cache_progress_func;
+
+  err = svn_fs_ioctl(fs, SVN_FS_FS__IOCTL_BUILD_MERGEINFO_INDEX,
+                     &input, NULL,
+                     check_cancel, NULL, pool, pool);
+  if (err && err->apr_err == SVN_ERR_FS_UNRECOGNIZED_IOCTL_CODE)
+    {
+      return svn_error_quick_wrapf(err,
+                                   _("Building a mergeinfo index is not "
+                                     "implemented for the filesystem type "
+                                     "found in '%s'"),
+                                   svn_fs_path(fs, pool));
+    }
+
+  return svn_error_trace(err);
+}
+
+/* This implements `svn_opt_subcommand_t'. */
+static svn_error_t *
+subcommand_build_path_index(apr_getopt_t *os, void *baton, apr_pool_t *pool)
+{
+  struct svnadmin_opt_state *opt_state = baton;
+  svn_fs_fs__ioctl_build_path_index_input_t input = {0};
+  svn_repos_t *repos;
+  svn_fs_t *fs;
+  svn_error_t *err;
+
+  /* Expect no more arguments. */
+  SVN_ERR(parse_args(NULL, os, 0, 0, pool));
+
+  SVN_ERR(open_repos(&repos, opt_state->repository_path, opt_state, pool));
+  fs = svn_repos_fs(repos);
+
+  if (! opt_state->quiet)
+    input.progress_func = build_rep_cache_progress_func;
+
+  err = svn_fs_ioctl(fs, SVN_FS_FS__IOCTL_BUILD_PATH_INDEX,
+                     &input, NULL,
+                     check_cancel, NULL, pool, pool);
+  if (err && err->apr_err == SVN_ERR_FS_UNRECOGNIZED_IOCTL_CODE)
+    {
+      return svn_error_quick_wrapf(err,
+                                   _("Building a path index is not "
+                                     "implemented for the filesystem type "
+                                     "found in '%s'"),
+                                   svn_fs_path(fs, pool));
+    }
+
+  return svn_error_trace(err);
+}
+
 /* This implements `svn_opt_subcommand_t'. */
 static svn_error_t *
 subcommand_build_repcache(apr_getopt_t *os, void *baton, apr_pool_t *pool)
@@ -3044,6 +3202,121 @@ subcommand_build_repcache(apr_getopt_t *os, void *baton, apr_pool_t *pool)
   return SVN_NO_ERROR;
 }
 
+/* This implements `svn_opt_subcommand_t'. */
+static svn_error_t *
+subcommand_build_repcache_filter(apr_getopt_t *os, void *baton,
+                                 apr_pool_t *pool)
+{
+  struct svnadmin_opt_state *opt_state = baton;
+  svn_repos_t *repos;
+  svn_fs_t *fs;
+  svn_error_t *err;
+
+  /* Expect no more arguments. */
+  SVN_ERR(parse_args(NULL, os, 0, 0, pool));
+
+  SVN_ERR(open_repos(&repos, opt_state->repository_path, opt_state, pool));
+  fs = svn_repos_fs(repos);
+
+  err = svn_fs_ioctl(fs, SVN_FS_FS__IOCTL_BUILD_REP_CACHE_FILTER,
+                     NULL, NULL,
+                     check_cancel, NULL, pool, pool);
+  if (err && err->apr_err == SVN_ERR_FS_UNRECOGNIZED_IOCTL_CODE)
+    {
+      return svn_error_quick_wrapf(err,
+                                   _("Building a rep-cache filter is not "
+                                     "implemented for the filesystem type "
+                                     "found in '%s'"),
+                                   svn_fs_path(fs, pool));
+    }
+  else if (err && err->apr_err == SVN_ERR_FS_REP_SHARING_NOT_ALLOWED)
+    {
+      svn_error_clear(err);
+      SVN_ERR(svn_cmdline_printf(pool,
+                                 _("svnadmin: Warning - this repository has rep-sharing disabled."
+                                   " Building a rep-cache filter has no effect.\n")));
+      return SVN_NO_ERROR;
+    }
+
+  return svn_error_trace(err);
+}
+
+/* Implements svn_fs_progress_notify_func_t for 'svnadmin redeltify'. */
+static void
+redeltify_progress_func(svn_revnum_t revision,
+                        void *baton,
+                        apr_pool_t *pool)
+{
+  svn_error_clear(svn_cmdline_printf(pool,
+                                     _("* Processing shard starting at "
+                                       "revision %ld.\n"),
+                                     revision));
+}
+
+/* This implements `svn_opt_subcommand_t'. */
+static svn_error_t *
+subcommand_redeltify(apr_getopt_t *os, void *baton, apr_pool_t *pool)
+{
+  struct svnadmin_opt_state *opt_state = baton;
+  svn_fs_fs__ioctl_redeltify_input_t input = {0};
+  svn_fs_fs__ioctl_redeltify_output_t *output;
+  svn_repos_t *repos;
+  svn_fs_t *fs;
+  svn_revnum_t youngest;
+  svn_error_t *err;
+
+  /* Expect no more arguments. */
+  SVN_ERR(parse_args(NULL, os, 0, 0, pool));
+
+  SVN_ERR(open_repos(&repos, opt_state->repository_path, opt_state, pool));
+  fs = svn_repos_fs(repos);
+  SVN_ERR(svn_fs_youngest_rev(&youngest, fs, pool));
+
+  SVN_ERR(get_revnum(&input.start_rev, &opt_state->start_revision,
+                     youngest, repos, pool));
+  SVN_ERR(get_revnum(&input.end_rev, &opt_state->end_revision,
+                     youngest, repos, pool));
+
+  if (SVN_IS_VALID_REVNUM(input.start_rev)
+      && SVN_IS_VALID_REVNUM(input.end_rev))
+    {
+      if (input.start_rev > input.end_rev)
+        return svn_error_create(SVN_ERR_CL_ARG_PARSING_ERROR, NULL,
+                                _("First revision cannot be higher than second"));
+    }
+  else if (SVN_IS_VALID_REVNUM(input.start_rev))
+    {
+      input.end_rev = input.start_rev;
+    }
+
+  input.max_chain_length = opt_state->max_chain_length;
+  if (! opt_state->quiet)
+    input.progress_func = redeltify_progress_func;
+
+  err = svn_fs_ioctl(fs, SVN_FS_FS__IOCTL_REDELTIFY,
+                     &input, (void **)&output,
+                     check_cancel, NULL, pool, pool);
+  if (err && err->apr_err == SVN_ERR_FS_UNRECOGNIZED_IOCTL_CODE)
+    {
+      return svn_error_quick_wrapf(err,
+                                   _("Redeltification is not implemented "
+                                     "for the filesystem type found in '%s'"),
+                                   svn_fs_path(fs, pool));
+    }
+  SVN_ERR(err);
+
+  if (! opt_state->quiet)
+    SVN_ERR(svn_cmdline_printf(pool,
+                               _("Wrote %s representations for %s "
+                                 "node revisions.\n"),
+                               apr_psprintf(pool, "%" APR_INT64_T_FMT,
+                                            output->rep_count),
+                               apr_psprintf(pool, "%" APR_INT64_T_FMT,
+                                            output->noderev_count)));
+
+  return SVN_NO_ERROR;
+}
+
 
 /** Main. **/
 
@@ -3091,6 +3364,7 @@ sub_main(int *exit_code,
   opt_state.start_revision.kind = svn_opt_revision_unspecified;
   opt_state.end_revision.kind = svn_opt_revision_unspecified;
   opt_state.memory_cache_size = svn_cache_config_get()->cache_size;
+  opt_state.threads = 1;
 
   /* Parse options. */
   SVN_ERR(svn_cmdline__getopt_init(&os, argc, argv, pool));
@@ -3305,6 +3579,27 @@ sub_main(int *exit_code,
       case svnadmin__glob:
         opt_state.glob = TRUE;
         break;
+      case svnadmin__max_chain_length:
+        SVN_ERR(svn_cstring_atoi(&opt_state.max_chain_length, opt_arg));
+        if (opt_state.max_chain_length < 1)
+          return svn_error_createf(SVN_ERR_CL_ARG_PARSING_ERROR, NULL,
+                                   _("Invalid maximum delta chain length "
+                                     "'%s'"), opt_arg);
+        break;
+      case svnadmin__threads:
+        SVN_ERR(svn_cstring_atoi(&opt_state.threads, opt_arg));
+        if (opt_state.threads < 1)
+          return svn_error_createf(SVN_ERR_CL_ARG_PARSING_ERROR, NULL,
+                                   _("Invalid number of threads '%s'"),
+                                   opt_arg);
+        break;
+      case svnadmin__compare_checksums:
+        opt_state.compare_checksums = TRUE;
+        break;
+      case svnadmin__bulk:
+        opt_state.bulk = TRUE;
+        opt_state.no_flush_to_disk = TRUE;
+        break;
       default:
         {
           SVN_ERR(subcommand_help(NULL, NULL, pool));
@@ -48,6 +48,7 @@
 #include "private/svn_mergeinfo_private.h"
 #include "private/svn_cmdline_private.h"
 #include "private/svn_sorts_private.h"
+#include "private/svn_string_private.h"
 
 /*** Code. ***/
 
@@ -194,7 +195,18 @@ struct parse_baton_t
 
   /* State for the filtering process. */
   apr_int32_t rev_drop_count;
-  apr_hash_t *dropped_nodes;
+
+  /* The paths of the dropped nodes, for the final report.  Only tracked
+     if we are not QUIET.  To keep the memory usage low for large dump
+     files, the paths are stored in DROPPED_PATHS with DROPPED_NODES
+     referencing them (svn_prefix_string__t *).  The latter may contain
+     duplicates; see add_dropped_node().  DROPPED_NODES_UNIQUE is the
+     number of elements in DROPPED_NODES after the last removal of
+     duplicates. */
+  svn_prefix_tree__t *dropped_paths;
+  apr_array_header_t *dropped_nodes;
+  int dropped_nodes_unique;
+
   apr_hash_t *renumber_history;  /* svn_revnum_t -> struct revmap_t */
   svn_revnum_t last_live_revision;
   /* The oldest original revision, greater than r0, in the input
@@ -278,6 +290,56 @@ magic_header_record(int version, void *parse_baton, apr_pool_t *pool)
 }
 
 
+/* Implements the comparison function for svn_sort__array() on
+   arrays of svn_prefix_string__t * from the same prefix tree. */
+static int
+compare_prefix_strings(const void *lhs,
+                       const void *rhs)
+{
+  return svn_prefix_string__compare(
+                        *(const svn_prefix_string__t * const *)lhs,
+                        *(const svn_prefix_string__t * const *)rhs);
+}
+
+/* Remove all duplicates from PB->DROPPED_NODES, leaving it sorted. */
+static void
+compact_dropped_nodes(struct parse_baton_t *pb)
+{
+  apr_array_header_t *nodes = pb->dropped_nodes;
+  int i, count;
+
+  svn_sort__array(nodes, compare_prefix_strings);
+
+  /* Equal strings are equal pointers within the same prefix tree. */
+  for (i = 1, count = nodes->nelts ? 1 : 0; i < nodes->nelts; ++i)
+    if (APR_ARRAY_IDX(nodes, i, svn_prefix_string__t *)
+        != APR_ARRAY_IDX(nodes, count - 1, svn_prefix_string__t *))
+      APR_ARRAY_IDX(nodes, count++, svn_prefix_string__t *)
+        = APR_ARRAY_IDX(nodes, i, svn_prefix_string__t *);
+
+  nodes->nelts = count;
+  pb->dropped_nodes_unique = count;
+}
+
+/* Take note of PATH having been dropped in PB. */
+static void
+add_dropped_node(struct parse_baton_t *pb,
+                 const char *path)
+{
+  apr_array_header_t *nodes = pb->dropped_nodes;
+  svn_prefix_string__t *node = svn_prefix_string__create(pb->dropped_paths,
+                                                         path);
+
+  /* Nodes tend to get dropped repeatedly over the course of many
+     revisions.  Weed out the duplicates before the array grows, unless
+     there haven't been enough new entries since the last time we did. */
+  if (   nodes->nelts == nodes->nalloc
+      && nodes->nelts >= 2 * pb->dropped_nodes_unique)
+    compact_dropped_nodes(pb);
+
+  APR_ARRAY_PUSH(nodes, svn_prefix_string__t *) = node;
+}
+
 /* Return a deep copy of a (char * -> char *) hash. */
 static apr_hash_t *
 headers_dup(apr_hash_t *headers,
@@ -486,10 +548,8 @@ new_node_record(void **node_baton,
      rest.  */
   if (nb->do_skip)
     {
-      svn_hash_sets(pb->dropped_nodes,
-                    apr_pstrdup(apr_hash_pool_get(pb->dropped_nodes),
-                                node_path),
-                    (void *)1);
+      if (! pb->quiet)
+        add_dropped_node(pb, node_path);
       nb->rb->had_dropped_nodes = TRUE;
     }
   else
@@ -1060,7 +1120,10 @@ parse_baton_initialize(struct parse_baton_t **pb,
   baton->prefixes = opt_state->prefixes;
   baton->skip_missing_merge_sources = opt_state->skip_missing_merge_sources;
   baton->rev_drop_count = 0; /* used to shift revnums while filtering */
-  baton->dropped_nodes = apr_hash_make(pool);
+  baton->dropped_paths = svn_prefix_tree__create(pool);
+  baton->dropped_nodes = apr_array_make(pool, 16,
+                                        sizeof(svn_prefix_string__t *));
+  baton->dropped_nodes_unique = 0;
   baton->renumber_history = apr_hash_make(pool);
   baton->last_live_revision = SVN_INVALID_REVNUM;
   baton->oldest_original_rev = SVN_INVALID_REVNUM;
@@ -1231,7 +1294,8 @@ do_filter(apr_getopt_t *os,
       svn_pool_destroy(subpool);
     }
 
-  if ((num_keys = apr_hash_count(pb->dropped_nodes)))
+  compact_dropped_nodes(pb);
+  if ((num_keys = pb->dropped_nodes->nelts))
     {
       apr_pool_t *subpool = svn_pool_create(pool);
       SVN_ERR(svn_cmdline_fprintf(stderr, subpool,
@@ -1240,16 +1304,15 @@ do_filter(apr_getopt_t *os,
                                      num_keys),
                                   num_keys));
 
-      /* Get the keys of the hash, sort them, then print the hash keys
-         and values, sorted by keys. */
+      /* Expand the paths and print them in path order. */
       keys = apr_array_make(pool, num_keys + 1, sizeof(const char *));
-      for (hi = apr_hash_first(pool, pb->dropped_nodes);
-           hi;
-           hi = apr_hash_next(hi))
+      for (i = 0; i < num_keys; i++)
         {
-          const char *path = apr_hash_this_key(hi);
+          const svn_prefix_string__t *node
+            = APR_ARRAY_IDX(pb->dropped_nodes, i, svn_prefix_string__t *);
 
-          APR_ARRAY_PUSH(keys, const char *) = path;
+          APR_ARRAY_PUSH(keys, const char *)
+            = svn_prefix_string__expand(node, pool)->data;
         }
       svn_sort__array(keys, svn_sort_compare_paths);
       for (i = 0; i < keys->nelts; i++)
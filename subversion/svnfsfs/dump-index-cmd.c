@@ -25,6 +25,7 @@
 #include "svn_dirent_uri.h"
 #include "svn_pools.h"
 #include "private/svn_fs_fs_private.h"
+#include "private/svn_fs_x_private.h"
 
 #include "svnfsfs.h"
 
@@ -69,6 +70,52 @@ dump_index_entry(const svn_fs_fs__p2l_entry_t *entry,
   return SVN_NO_ERROR;
 }
 
+/* Map svn_fs_x__p2l_entry_t.type to C string. */
+static const char *x_item_type_str[]
+  = {"none ", "frep ", "drep ", "fprop", "dprop", "node ", "chgs ", "rep  ",
+     "cchgs", "cnode", "creps"};
+
+/* Implements svn_fs_x__dump_index_func_t as printing the table rows
+ * for ENTRY to the console.  Containers get one extra line per item
+ * beyond the first one, showing only the revision and item number.
+ */
+static svn_error_t *
+dump_x_index_entry(const svn_fs_x__p2l_entry_t *entry,
+                   void *baton,
+                   apr_pool_t *scratch_pool)
+{
+  apr_uint32_t i;
+  const char *type_str
+    = entry->type < (sizeof(x_item_type_str) / sizeof(x_item_type_str[0]))
+    ? x_item_type_str[entry->type]
+    : "???";
+
+  /* Unused sections don't contain any items. */
+  if (entry->item_count == 0)
+    {
+      printf("%12" APR_UINT64_T_HEX_FMT " %12" APR_UINT64_T_HEX_FMT
+             " %s %9s %8s %s\n",
+             (apr_uint64_t)entry->offset, (apr_uint64_t)entry->size,
+             type_str, "-", "-",
+             fnv1_to_string(entry->fnv1_checksum, scratch_pool));
+      return SVN_NO_ERROR;
+    }
+
+  printf("%12" APR_UINT64_T_HEX_FMT " %12" APR_UINT64_T_HEX_FMT
+         " %s %9ld %8" APR_UINT64_T_FMT " %s\n",
+         (apr_uint64_t)entry->offset, (apr_uint64_t)entry->size,
+         type_str, (svn_revnum_t)entry->items[0].change_set,
+         entry->items[0].number,
+         fnv1_to_string(entry->fnv1_checksum, scratch_pool));
+
+  for (i = 1; i < entry->item_count; ++i)
+    printf("%12s %12s %5s %9ld %8" APR_UINT64_T_FMT "\n", "", "", "",
+           (svn_revnum_t)entry->items[i].change_set,
+           entry->items[i].number);
+
+  return SVN_NO_ERROR;
+}
+
 /* Read the repository at PATH beginning with revision START_REVISION and
  * return the result in *FS.  Allocate caches with MEMSIZE bytes total
  * capacity.  Use POOL for non-cache allocations.
@@ -79,19 +126,33 @@ dump_index(const char *path,
            apr_pool_t *pool)
 {
   svn_fs_t *fs;
-  svn_fs_fs__ioctl_dump_index_input_t input = {0};
+  svn_boolean_t is_fsx;
 
   /* Check repository type and open it. */
-  SVN_ERR(open_fs(&fs, path, pool));
+  SVN_ERR(open_fs(&fs, &is_fsx, path, pool));
 
   /* Write header line. */
   printf("       Start       Length Type   Revision     Item Checksum\n");
 
   /* Dump the whole index contents */
-  input.revision = revision;
-  input.callback_func = dump_index_entry;
-  SVN_ERR(svn_fs_ioctl(fs, SVN_FS_FS__IOCTL_DUMP_INDEX, &input, NULL,
-                       check_cancel, NULL, pool, pool));
+  if (is_fsx)
+    {
+      svn_fs_x__ioctl_dump_index_input_t input = {0};
+
+      input.revision = revision;
+      input.callback_func = dump_x_index_entry;
+      SVN_ERR(svn_fs_ioctl(fs, SVN_FS_X__IOCTL_DUMP_INDEX, &input, NULL,
+                           check_cancel, NULL, pool, pool));
+    }
+  else
+    {
+      svn_fs_fs__ioctl_dump_index_input_t input = {0};
+
+      input.revision = revision;
+      input.callback_func = dump_index_entry;
+      SVN_ERR(svn_fs_ioctl(fs, SVN_FS_FS__IOCTL_DUMP_INDEX, &input, NULL,
+                           check_cancel, NULL, pool, pool));
+    }
 
   return SVN_NO_ERROR;
 }
@@ -26,6 +26,7 @@
 #include "svn_pools.h"
 
 #include "private/svn_fs_fs_private.h"
+#include "private/svn_fs_x_private.h"
 #include "private/svn_sorts_private.h"
 
 #include "svn_private_config.h"
@@ -124,6 +125,181 @@ parse_index_line(svn_fs_fs__p2l_entry_t **entry,
   return SVN_NO_ERROR;
 }
 
+/* Map svn_fs_x__p2l_entry_t.type to C string. */
+static const char *x_item_type_str[]
+  = {"none", "frep", "drep", "fprop", "dprop", "node", "chgs", "rep",
+     "cchgs", "cnode", "creps"};
+
+/* Like str_to_item_type but for FSX item types. */
+static svn_error_t *
+str_to_x_item_type(apr_uint32_t *type,
+                   const char *str)
+{
+  unsigned i;
+  for (i = 0; i < sizeof(x_item_type_str) / sizeof(x_item_type_str[0]); ++i)
+    if (strcmp(x_item_type_str[i], str) == 0)
+      {
+        *type = i;
+        return SVN_NO_ERROR;
+      }
+
+  return svn_error_createf(SVN_ERR_BAD_TOKEN, NULL,
+                           _("Unknown item type '%s'"), str);
+}
+
+/* Parse the FSX item ID given as revision and item number in the const
+ * char * at IDX and IDX+1 in TOKENS and append it to ITEMS.  "-" for both
+ * values means that there is no item.
+ */
+static svn_error_t *
+parse_x_item(apr_array_header_t *items,
+             apr_array_header_t *tokens,
+             int idx)
+{
+  svn_fs_x__id_t *id;
+  svn_revnum_t revision;
+  apr_int64_t value;
+
+  SVN_ERR(token_to_i64(&value, tokens, idx + 1, 10));
+  SVN_ERR(svn_revnum_parse(&revision,
+                           APR_ARRAY_IDX(tokens, idx, const char *), NULL));
+
+  id = apr_array_push(items);
+  id->change_set = revision;
+  id->number = (apr_uint64_t)value;
+
+  return SVN_NO_ERROR;
+}
+
+/* Parse the FSX P2L entry given as the const char * TOKENS of a table line
+ * and return it in *ENTRY, allocated in RESULT_POOL.  Append its first item,
+ * if any, to ITEMS.  Ignore extra columns.
+ */
+static svn_error_t *
+parse_x_index_line(svn_fs_x__p2l_entry_t **entry,
+                   apr_array_header_t *items,
+                   apr_array_header_t *tokens,
+                   apr_pool_t *result_pool)
+{
+  svn_fs_x__p2l_entry_t *result = apr_pcalloc(result_pool, sizeof(*result));
+  apr_int64_t value;
+
+  /* Parse the hex columns. */
+  SVN_ERR(token_to_i64(&value, tokens, 0, 16));
+  result->offset = (apr_off_t)value;
+  SVN_ERR(token_to_i64(&value, tokens, 1, 16));
+  result->size = (apr_off_t)value;
+
+  /* Make sure that there are at least 5 columns. */
+  if (tokens->nelts < 5)
+    return svn_error_createf(SVN_ERR_INVALID_INPUT, NULL,
+                             _("%i columns needed, %i provided"),
+                             5, tokens->nelts);
+
+  SVN_ERR(str_to_x_item_type(&result->type,
+                             APR_ARRAY_IDX(tokens, 2, const char *)));
+
+  /* Unused sections don't list any item. */
+  if (strcmp(APR_ARRAY_IDX(tokens, 3, const char *), "-"))
+    SVN_ERR(parse_x_item(items, tokens, 3));
+
+  *entry = result;
+  return SVN_NO_ERROR;
+}
+
+/* Attach a copy of ITEMS to ENTRY, allocated in RESULT_POOL, and clear
+ * ITEMS.  Do nothing if ENTRY is NULL.
+ */
+static svn_error_t *
+finalize_x_entry(svn_fs_x__p2l_entry_t *entry,
+                 apr_array_header_t *items,
+                 apr_pool_t *result_pool)
+{
+  if (entry == NULL)
+    return SVN_NO_ERROR;
+
+  entry->item_count = items->nelts;
+  entry->items = apr_pmemdup(result_pool, items->elts,
+                             items->nelts * items->elt_size);
+  apr_array_clear(items);
+
+  return SVN_NO_ERROR;
+}
+
+/* Same as load_index but for the FSX repository FS. */
+static svn_error_t *
+load_x_index(svn_fs_t *fs,
+             svn_stream_t *input,
+             apr_pool_t *pool)
+{
+  svn_revnum_t revision = SVN_INVALID_REVNUM;
+  apr_array_header_t *entries = apr_array_make(pool, 16, sizeof(void*));
+  apr_array_header_t *items = apr_array_make(pool, 16,
+                                             sizeof(svn_fs_x__id_t));
+  svn_fs_x__p2l_entry_t *current = NULL;
+  apr_pool_t *iterpool = svn_pool_create(pool);
+  svn_fs_x__ioctl_load_index_input_t ioctl_input = {0};
+
+  while (TRUE)
+    {
+      svn_stringbuf_t *line;
+      apr_array_header_t *tokens;
+      svn_boolean_t eol;
+
+      /* Get the next line from the input and stop if there is none. */
+      svn_pool_clear(iterpool);
+      SVN_ERR(svn_stream_readline(input, &line, "\n", &eol, iterpool));
+      if (eol)
+        break;
+
+      /* Skip header line(s).  They contain the sub-string [Ss]tart. */
+      if (strstr(line->data, "tart"))
+        continue;
+
+      /* Ignore empty lines (mostly trailing ones but we don't really care).
+       */
+      svn_stringbuf_strip_whitespace(line);
+      if (line->len == 0)
+        continue;
+
+      /* Lines with only 2 columns list further items of a container. */
+      tokens = svn_cstring_split(line->data, " ", TRUE, iterpool);
+      if (tokens->nelts == 2)
+        {
+          if (current == NULL)
+            return svn_error_create(SVN_ERR_INVALID_INPUT, NULL,
+                                    _("Item list without an index entry"));
+
+          SVN_ERR(parse_x_item(items, tokens, 0));
+        }
+      else
+        {
+          /* A new entry completes the item list of the previous one.
+           * Parse the new entry and append it to ENTRIES. */
+          SVN_ERR(finalize_x_entry(current, items, pool));
+          SVN_ERR(parse_x_index_line(&current, items, tokens, pool));
+          APR_ARRAY_PUSH(entries, svn_fs_x__p2l_entry_t *) = current;
+        }
+
+      /* There should be at least one item that is not empty.
+       * Get a revision from (probably inside) the respective shard. */
+      if (revision == SVN_INVALID_REVNUM && items->nelts)
+        revision = (svn_revnum_t)APR_ARRAY_IDX(items, 0, svn_fs_x__id_t)
+                                   .change_set;
+    }
+
+  SVN_ERR(finalize_x_entry(current, items, pool));
+
+  /* Rewrite the indexes. */
+  ioctl_input.revision = revision;
+  ioctl_input.entries = entries;
+  SVN_ERR(svn_fs_ioctl(fs, SVN_FS_X__IOCTL_LOAD_INDEX, &ioctl_input, NULL,
+                       NULL, NULL, pool, pool));
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
 /* Parse the space separated P2L index table from INPUT, one entry per line.
  * Rewrite the respective index files in PATH.  Allocate from POOL. */
 static svn_error_t *
@@ -132,13 +308,18 @@ load_index(const char *path,
            apr_pool_t *pool)
 {
   svn_fs_t *fs;
+  svn_boolean_t is_fsx;
   svn_revnum_t revision = SVN_INVALID_REVNUM;
   apr_array_header_t *entries = apr_array_make(pool, 16, sizeof(void*));
-  apr_pool_t *iterpool = svn_pool_create(pool);
+  apr_pool_t *iterpool;
   svn_fs_fs__ioctl_load_index_input_t ioctl_input = {0};
 
   /* Check repository type and open it. */
-  SVN_ERR(open_fs(&fs, path, pool));
+  SVN_ERR(open_fs(&fs, &is_fsx, path, pool));
+  if (is_fsx)
+    return svn_error_trace(load_x_index(fs, input, pool));
+
+  iterpool = svn_pool_create(pool);
 
   while (TRUE)
     {
@@ -29,6 +29,7 @@
 #include "private/svn_sorts_private.h"
 #include "private/svn_string_private.h"
 #include "private/svn_fs_fs_private.h"
+#include "private/svn_fs_x_private.h"
 
 #include "svn_private_config.h"
 #include "svnfsfs.h"
@@ -483,6 +484,167 @@ print_stats(svn_fs_fs__stats_t *stats,
   print_histograms_by_extension(stats, pool);
 }
 
+/* Like print_histogram but for the FSX HISTOGRAM.
+ */
+static void
+print_x_histogram(svn_fs_x__histogram_t *histogram,
+                  apr_pool_t *pool)
+{
+  int first = 0;
+  int last = 63;
+  int i;
+
+  /* identify non-zero range */
+  while (last > 0 && histogram->lines[last].count == 0)
+    --last;
+
+  while (first <= last && histogram->lines[first].count == 0)
+    ++first;
+
+  /* display histogram lines */
+  for (i = last; i >= first; --i)
+    printf(_("  %4s .. < %-4s %19s (%2d%%) bytes in %12s (%2d%%) items\n"),
+           print_two_power(i-1, pool), print_two_power(i, pool),
+           svn__ui64toa_sep(histogram->lines[i].sum, ',', pool),
+           get_percentage(histogram->lines[i].sum, histogram->total.sum),
+           svn__ui64toa_sep(histogram->lines[i].count, ',', pool),
+           get_percentage(histogram->lines[i].count,
+                          histogram->total.count));
+}
+
+/* Print the FSX stand-alone representation STATS to console.
+ * Use POOL for allocations.
+ */
+static void
+print_x_rep_stats(svn_fs_x__rep_stats_t *stats,
+                  apr_pool_t *pool)
+{
+  printf(_("%20s bytes in %12s reps\n"
+           "%20s bytes expanded size\n"
+           "%20.3f average delta chain length\n"),
+         svn__ui64toa_sep(stats->total.size, ',', pool),
+         svn__ui64toa_sep(stats->total.count, ',', pool),
+         svn__ui64toa_sep(stats->expanded_size, ',', pool),
+         stats->chain_len / MAX(1.0, (double)stats->total.count));
+}
+
+/* Print the contents of the FSX STATS to the console.
+ * Use POOL for allocations.
+ */
+static void
+print_x_stats(svn_fs_x__stats_t *stats,
+              apr_pool_t *pool)
+{
+  svn_fs_x__reps_container_stats_t *reps = &stats->reps_containers;
+  svn_fs_x__noderevs_container_stats_t *noderevs
+    = &stats->noderevs_containers;
+  svn_fs_x__changes_container_stats_t *changes = &stats->changes_containers;
+  apr_uint64_t rep_count = stats->file_rep_stats.total.count
+                         + stats->dir_rep_stats.total.count
+                         + stats->file_prop_rep_stats.total.count
+                         + stats->dir_prop_rep_stats.total.count;
+  int i;
+
+  printf("\n\nGlobal statistics:\n");
+  printf(_("%20s bytes in %12s revisions\n"
+           "%20s changes\n"
+           "%20s directory noderevs\n"
+           "%20s file noderevs\n"
+           "%20s bytes in %12s stand-alone noderevs\n"
+           "%20s bytes in %12s stand-alone changes lists\n"
+           "%20s bytes in %12s stand-alone representations\n"),
+         svn__ui64toa_sep(stats->total_size, ',', pool),
+         svn__ui64toa_sep(stats->revision_count, ',', pool),
+         svn__ui64toa_sep(stats->change_count, ',', pool),
+         svn__ui64toa_sep(stats->dir_node_count, ',', pool),
+         svn__ui64toa_sep(stats->file_node_count, ',', pool),
+         svn__ui64toa_sep(stats->noderevs.size, ',', pool),
+         svn__ui64toa_sep(stats->noderevs.count, ',', pool),
+         svn__ui64toa_sep(stats->changes.size, ',', pool),
+         svn__ui64toa_sep(stats->changes.count, ',', pool),
+         svn__ui64toa_sep(stats->rep_size_histogram.total.sum, ',', pool),
+         svn__ui64toa_sep(rep_count, ',', pool));
+
+  printf("\nRepresentation container statistics:\n");
+  printf(_("%20s bytes in %12s containers\n"
+           "%20s bytes in %12s fulltexts\n"
+           "%20s bytes of shared text\n"
+           "%20s external base representations\n"
+           "%20s instructions\n"
+           "%20.3f average copies per fulltext\n"
+           "%20s maximum instruction nesting\n"),
+         svn__ui64toa_sep(reps->total.size, ',', pool),
+         svn__ui64toa_sep(reps->total.count, ',', pool),
+         svn__ui64toa_sep(reps->expanded_size, ',', pool),
+         svn__ui64toa_sep(reps->rep_count, ',', pool),
+         svn__ui64toa_sep(reps->text_size, ',', pool),
+         svn__ui64toa_sep(reps->base_count, ',', pool),
+         svn__ui64toa_sep(reps->instruction_count, ',', pool),
+         reps->copy_count / MAX(1.0, (double)reps->rep_count),
+         svn__ui64toa_sep(reps->max_nesting, ',', pool));
+
+  printf("\nNoderev container statistics:\n");
+  printf(_("%20s bytes in %12s containers\n"
+           "%20s noderevs\n"
+           "%20s distinct IDs\n"
+           "%20s distinct representations\n"),
+         svn__ui64toa_sep(noderevs->total.size, ',', pool),
+         svn__ui64toa_sep(noderevs->total.count, ',', pool),
+         svn__ui64toa_sep(noderevs->noderev_count, ',', pool),
+         svn__ui64toa_sep(noderevs->id_count, ',', pool),
+         svn__ui64toa_sep(noderevs->rep_count, ',', pool));
+
+  printf("\nChanged paths container statistics:\n");
+  printf(_("%20s bytes in %12s containers\n"
+           "%20s changes lists\n"
+           "%20s changes\n"),
+         svn__ui64toa_sep(changes->total.size, ',', pool),
+         svn__ui64toa_sep(changes->total.count, ',', pool),
+         svn__ui64toa_sep(changes->list_count, ',', pool),
+         svn__ui64toa_sep(changes->change_count, ',', pool));
+
+  printf("\nDirectory representation statistics:\n");
+  print_x_rep_stats(&stats->dir_rep_stats, pool);
+  printf("\nFile representation statistics:\n");
+  print_x_rep_stats(&stats->file_rep_stats, pool);
+  printf("\nDirectory property representation statistics:\n");
+  print_x_rep_stats(&stats->dir_prop_rep_stats, pool);
+  printf("\nFile property representation statistics:\n");
+  print_x_rep_stats(&stats->file_prop_rep_stats, pool);
+
+  printf("\nRepresentation references:\n");
+  printf(_("%20s references from noderevs\n"
+           "%20s (%2d%%) of them into containers\n"
+           "%20.3f average delta chain length per reference\n"),
+         svn__ui64toa_sep(stats->rep_references, ',', pool),
+         svn__ui64toa_sep(stats->container_rep_references, ',', pool),
+         get_percentage(stats->container_rep_references,
+                        stats->rep_references),
+         stats->referenced_chain_len
+            / MAX(1.0, (double)stats->rep_references));
+
+  printf("\nDelta chain lengths of stand-alone representations:\n");
+  for (i = 0; i < SVN_FS_X__STATS_MAX_CHAIN_LEN; ++i)
+    if (stats->chain_lengths[i])
+      printf(_("  %4d%s %20s (%2d%%) representations\n"),
+             i, i + 1 == SVN_FS_X__STATS_MAX_CHAIN_LEN ? "+" : " ",
+             svn__ui64toa_sep(stats->chain_lengths[i], ',', pool),
+             get_percentage(stats->chain_lengths[i], rep_count));
+  printf(_("%20s longest delta chain\n"),
+         svn__ui64toa_sep(stats->max_chain_len, ',', pool));
+
+  printf("\nHistogram of stand-alone representation sizes:\n");
+  print_x_histogram(&stats->rep_size_histogram, pool);
+  printf("\nHistogram of representation container sizes:\n");
+  print_x_histogram(&reps->size_histogram, pool);
+  printf("\nHistogram of noderev container sizes:\n");
+  print_x_histogram(&noderevs->size_histogram, pool);
+  printf("\nHistogram of file sizes:\n");
+  print_x_histogram(&stats->file_histogram, pool);
+  printf("\nHistogram of directory sizes:\n");
+  print_x_histogram(&stats->dir_histogram, pool);
+}
+
 /* Our progress function simply prints the REVISION number and makes it
  * appear immediately.
  */
@@ -501,13 +663,37 @@ subcommand__stats(apr_getopt_t *os, void *baton, apr_pool_t *pool)
 {
   svnfsfs__opt_state *opt_state = baton;
   svn_fs_t *fs;
+  svn_boolean_t is_fsx;
   svn_fs_fs__ioctl_get_stats_input_t input = {0};
   svn_fs_fs__ioctl_get_stats_output_t *output;
 
+  SVN_ERR(open_fs(&fs, &is_fsx, opt_state->repository_path, pool));
+  if (is_fsx)
+    {
+      svn_fs_x__ioctl_get_stats_input_t x_input = {0};
+      svn_fs_x__ioctl_get_stats_output_t *x_output;
+
+      if (opt_state->cache_file)
+        return svn_error_create(SVN_ERR_CL_ARG_PARSING_ERROR, NULL,
+                                _("--cache-file is not supported for FSX "
+                                  "repositories"));
+
+      printf("Reading revisions\n");
+      x_input.progress_func = print_progress;
+      x_input.thread_count = opt_state->threads;
+      SVN_ERR(svn_fs_ioctl(fs, SVN_FS_X__IOCTL_GET_STATS, &x_input,
+                           (void **)&x_output, check_cancel, NULL,
+                           pool, pool));
+      print_x_stats(x_output->stats, pool);
+
+      return SVN_NO_ERROR;
+    }
+
   printf("Reading revisions\n");
-  SVN_ERR(open_fs(&fs, opt_state->repository_path, pool));
 
   input.progress_func = print_progress;
+  input.cache_path = opt_state->cache_file;
+  input.thread_count = opt_state->threads;
   SVN_ERR(svn_fs_ioctl(fs, SVN_FS_FS__IOCTL_GET_STATS, &input, (void **)&output,
                        check_cancel, NULL, pool, pool));
   print_stats(output->stats, pool);
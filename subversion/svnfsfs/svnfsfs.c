@@ -1,5 +1,5 @@
 /*
- * svnfsfs.c: FSFS repository manipulation tool main file.
+ * svnfsfs.c: FSFS / FSX repository manipulation tool main file.
  *
  * ====================================================================
  *    Licensed to the Apache Software Foundation (ASF) under one
@@ -76,7 +76,9 @@ check_lib_versions(void)
 
 enum svnfsfs__cmdline_options_t
   {
-    svnfsfs__version = SVN_OPT_FIRST_LONGOPT_ID
+    svnfsfs__version = SVN_OPT_FIRST_LONGOPT_ID,
+    svnfsfs__cache_file,
+    svnfsfs__threads
   };
 
 /* Option codes and descriptions.
@@ -104,6 +106,14 @@ static const apr_getopt_option_t options_table[] =
      N_("size of the extra in-memory cache in MB used to\n"
         "                             minimize redundant operations. Default: 16.")},
 
+    {"cache-file",    svnfsfs__cache_file, 1,
+     N_("keep per-shard results in file ARG and only\n"
+        "                             re-read pack files that changed since")},
+
+    {"threads",       svnfsfs__threads, 1,
+     N_("read up to ARG rev / pack files in parallel.\n"
+        "                             Default: 1.")},
+
     {NULL}
   };
 
@@ -124,7 +134,8 @@ static const svn_opt_subcommand_desc3_t cmd_table[] =
     "usage: svnfsfs dump-index REPOS_PATH -r REV\n"
     "\n"), N_(
     "Dump the index contents for the revision / pack file containing revision REV\n"
-    "to console.  This is only available for FSFS format 7 (SVN 1.9+) repositories.\n"
+    "to console.  This is only available for FSFS format 7 (SVN 1.9+) and FSX\n"
+    "repositories.\n"
     "The table produced contains a header in the first line followed by one line\n"
     "per index entry, ordered by location in the revision / pack file.  Columns:\n"
     "\n"), N_(
@@ -140,6 +151,9 @@ static const svn_opt_subcommand_desc3_t cmd_table[] =
     "        node ... Node revision.\n"
     "        chgs ... Changed paths list.\n"
     "        rep .... Representation of unknown type.  Should not be used.\n"
+    "        cchgs .. Container of changed paths lists (FSX only).\n"
+    "        cnode .. Container of node revisions (FSX only).\n"
+    "        creps .. Container of representations (FSX only).\n"
     "        ??? .... Invalid.  Index data is corrupt.\n"
     "\n"), N_(
     "        The distinction between frep, drep, fprop and dprop is a mere internal\n"
@@ -149,6 +163,9 @@ static const svn_opt_subcommand_desc3_t cmd_table[] =
     "   * Revision that the item belongs to (decimal)\n"
     "   * Item number (decimal) within that revision\n"
     "   * Modified FNV1a checksum (8 hex digits)\n"
+    "\n"), N_(
+    "For FSX containers, each further item in the container is listed in a line\n"
+    "of its own that contains only the revision and item number columns.\n"
    )},
    {'r', 'M'} },
 
@@ -166,8 +183,15 @@ static const svn_opt_subcommand_desc3_t cmd_table[] =
     "usage: svnfsfs stats REPOS_PATH\n"
     "\n"), N_(
     "Write object size statistics to console.\n"
+    "\n"), N_(
+    "With --cache-file, the results for each pack file are being stored in the\n"
+    "given file and subsequent runs will only re-read pack files that changed.\n"
+    "This is not supported for FSX repositories.\n"
+    "\n"), N_(
+    "For FSX repositories, the statistics focus on the representation, node\n"
+    "revision and changed paths containers as well as on delta chain lengths.\n"
    )},
-   {'M'} },
+   {'M', svnfsfs__cache_file, svnfsfs__threads} },
 
   { NULL, NULL, {0}, {NULL}, {0} }
 };
@@ -175,6 +199,7 @@ static const svn_opt_subcommand_desc3_t cmd_table[] =
 
 svn_error_t *
 open_fs(svn_fs_t **fs,
+        svn_boolean_t *is_fsx,
         const char *path,
         apr_pool_t *pool)
 {
@@ -183,7 +208,14 @@ open_fs(svn_fs_t **fs,
   /* Verify that we can handle the repository type. */
   path = svn_dirent_join(path, "db", pool);
   SVN_ERR(svn_fs_type(&fs_type, path, pool));
-  if (strcmp(fs_type, SVN_FS_TYPE_FSFS))
+  if (is_fsx && strcmp(fs_type, SVN_FS_TYPE_FSX) == 0)
+    *is_fsx = TRUE;
+  else if (strcmp(fs_type, SVN_FS_TYPE_FSFS) == 0)
+    {
+      if (is_fsx)
+        *is_fsx = FALSE;
+    }
+  else
     return svn_error_createf(SVN_ERR_FS_UNSUPPORTED_TYPE, NULL,
                              _("%s repositories are not supported"),
                              fs_type);
@@ -202,7 +234,7 @@ subcommand__help(apr_getopt_t *os, void *baton, apr_pool_t *pool)
   svnfsfs__opt_state *opt_state = baton;
   const char *header =
     _("general usage: svnfsfs SUBCOMMAND REPOS_PATH  [ARGS & OPTIONS ...]\n"
-      "Subversion FSFS repository manipulation tool.\n"
+      "Subversion FSFS / FSX repository manipulation tool.\n"
       "Type 'svnfsfs help <subcommand>' for help on a specific subcommand.\n"
       "Type 'svnfsfs --version' to see the program version.\n"
       "\n"
@@ -329,6 +361,18 @@ sub_main(int *exit_code,
       case svnfsfs__version:
         opt_state.version = TRUE;
         break;
+      case svnfsfs__cache_file:
+        SVN_ERR(svn_utf_cstring_to_utf8(&utf8_opt_arg, opt_arg, pool));
+        SVN_ERR(svn_dirent_get_absolute(&opt_state.cache_file,
+                                        utf8_opt_arg, pool));
+        break;
+      case svnfsfs__threads:
+        SVN_ERR(svn_cstring_atoi(&opt_state.threads, opt_arg));
+        if (opt_state.threads < 1)
+          return svn_error_createf(SVN_ERR_CL_ARG_PARSING_ERROR, NULL,
+                                   _("Invalid number of threads '%s'"),
+                                   opt_arg);
+        break;
       default:
         {
           SVN_ERR(subcommand__help(NULL, NULL, pool));
@@ -455,7 +499,7 @@ sub_main(int *exit_code,
     svn_cache_config_t settings = *svn_cache_config_get();
 
     settings.cache_size = opt_state.memory_cache_size;
-    settings.single_threaded = TRUE;
+    settings.single_threaded = opt_state.threads <= 1;
 
     svn_cache_config_set(&settings);
   }
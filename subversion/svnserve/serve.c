@@ -433,6 +433,25 @@ static void convert_case(char *text, svn_boolean_t to_uppercase)
     }
 }
 
+/* If we have a username, and we've not yet used it + any username
+   case normalization that might be requested to determine "the
+   username we used for authz purposes", do so now. */
+static void set_authz_user(server_baton_t *b)
+{
+  client_info_t *client_info = b->client_info;
+
+  if (client_info->user && (! client_info->authz_user))
+    {
+      char *authz_user = apr_pstrdup(b->pool, client_info->user);
+      if (b->repository->username_case == CASE_FORCE_UPPER)
+        convert_case(authz_user, TRUE);
+      else if (b->repository->username_case == CASE_FORCE_LOWER)
+        convert_case(authz_user, FALSE);
+
+      client_info->authz_user = authz_user;
+    }
+}
+
 /* Set *ALLOWED to TRUE if PATH is accessible in the REQUIRED mode to
    the user described in BATON according to the authz rules in BATON.
    Use POOL for temporary allocations only.  If no authz rules are
@@ -465,19 +484,7 @@ static svn_error_t *authz_check_access(svn_boolean_t *allowed,
   if (path && *path != '/')
     path = svn_fspath__canonicalize(path, pool);
 
-  /* If we have a username, and we've not yet used it + any username
-     case normalization that might be requested to determine "the
-     username we used for authz purposes", do so now. */
-  if (client_info->user && (! client_info->authz_user))
-    {
-      char *authz_user = apr_pstrdup(b->pool, client_info->user);
-      if (repository->username_case == CASE_FORCE_UPPER)
-        convert_case(authz_user, TRUE);
-      else if (repository->username_case == CASE_FORCE_LOWER)
-        convert_case(authz_user, FALSE);
-
-      client_info->authz_user = authz_user;
-    }
+  set_authz_user(b);
 
   SVN_ERR(svn_repos_authz_check_access(repository->authzdb,
                                        repository->authz_repos_name,
@@ -514,6 +521,26 @@ static svn_repos_authz_func_t authz_check_access_cb_func(server_baton_t *baton)
   return NULL;
 }
 
+/* If authz is enabled in the specified BATON, return a string that
+   identifies the access rights granted by authz_check_access_cb(),
+   allocated in POOL.  Otherwise, or if no such identification is
+   available, return NULL. */
+static const char *authz_fingerprint(server_baton_t *baton,
+                                     apr_pool_t *pool)
+{
+  const char *fingerprint;
+
+  if (!baton->repository->authzdb)
+    return NULL;
+
+  set_authz_user(baton);
+  svn_repos__authz_fingerprint(&fingerprint, baton->repository->authzdb,
+                               baton->repository->authz_repos_name,
+                               baton->client_info->authz_user, pool);
+
+  return fingerprint;
+}
+
 /* Set *ALLOWED to TRUE if the REQUIRED access to PATH is granted,
  * according to the state in BATON.  Use POOL for temporary
  * allocations only.  ROOT is not used.  Implements the
@@ -1015,6 +1042,12 @@ static svn_error_t *accept_report(svn_boolean_t *only_empty_entry,
                                       &ab, svn_ra_svn_zero_copy_limit(conn),
                                       pool));
 
+  /* Allow the report to be answered from the update report cache by
+     telling it what the authz callback grants. */
+  if (b->repository->authzdb)
+    svn_repos__report_set_authz_fingerprint(report_baton,
+                                            authz_fingerprint(b, pool));
+
   rb.sb = b;
   rb.repos_url = svn_path_uri_decode(b->repository->repos_url, pool);
   rb.report_baton = report_baton;
@@ -2443,6 +2476,9 @@ log_cmd(svn_ra_svn_conn_t *conn,
   apr_uint64_t limit, include_merged_revs_param;
   log_baton_t lb;
   authz_baton_t ab;
+  svn_repos__authz_read_baton_t read_baton;
+  svn_repos_authz_func_t authz_read_func;
+  void *authz_read_baton;
 
   ab.server = b;
   ab.conn = conn;
@@ -2511,6 +2547,23 @@ log_cmd(svn_ra_svn_conn_t *conn,
                                    strict_node, include_merged_revisions,
                                    revprops, pool)));
 
+  /* Unless we have to log each denied path, let libsvn_repos check all
+     changed paths of a revision at once. */
+  if (b->repository->authzdb && !b->logger)
+    {
+      set_authz_user(b);
+      read_baton.authz = b->repository->authzdb;
+      read_baton.repos_name = b->repository->authz_repos_name;
+      read_baton.user = b->client_info->authz_user;
+      authz_read_func = svn_repos__authz_read_func;
+      authz_read_baton = &read_baton;
+    }
+  else
+    {
+      authz_read_func = authz_check_access_cb_func(b);
+      authz_read_baton = &ab;
+    }
+
   /* Get logs.  (Can't report errors back to the client at this point.) */
   lb.fs_path = b->repository->fs_path->data;
   lb.conn = conn;
@@ -2519,7 +2572,7 @@ log_cmd(svn_ra_svn_conn_t *conn,
   err = svn_repos_get_logs5(b->repository->repos, full_paths, start_rev,
                             end_rev, (int) limit,
                             strict_node, include_merged_revisions,
-                            revprops, authz_check_access_cb_func(b), &ab,
+                            revprops, authz_read_func, authz_read_baton,
                             send_changed_paths ? path_change_receiver : NULL,
                             send_changed_paths ? &lb : NULL,
                             revision_receiver, &lb, pool);
@@ -3465,7 +3518,6 @@ static svn_error_t *replay_one_revision(svn_ra_svn_conn_t *conn,
 {
   const svn_delta_editor_t *editor;
   void *edit_baton;
-  svn_fs_root_t *root;
   svn_error_t *err;
   authz_baton_t ab;
 
@@ -3478,12 +3530,14 @@ static svn_error_t *replay_one_revision(svn_ra_svn_conn_t *conn,
 
   svn_ra_svn_get_editor(&editor, &edit_baton, conn, pool, NULL, NULL);
 
-  err = svn_fs_revision_root(&root, b->repository->fs, rev, pool);
-
-  if (! err)
-    err = svn_repos_replay2(root, b->repository->fs_path->data,
-                            low_water_mark, send_deltas, editor, edit_baton,
-                            authz_check_access_cb_func(b), &ab, pool);
+  /* Mirrors tend to replay the same revisions over and over again.
+     Let the replay cache answer that, if enabled. */
+  err = svn_repos__replay_cached(b->repository->repos, rev,
+                                 b->repository->fs_path->data,
+                                 low_water_mark, send_deltas,
+                                 editor, edit_baton,
+                                 authz_check_access_cb_func(b), &ab,
+                                 authz_fingerprint(b, pool), pool);
 
   if (err)
     svn_error_clear(editor->abort_edit(edit_baton, pool));
@@ -3706,7 +3760,6 @@ list(svn_ra_svn_conn_t *conn,
   apr_array_header_t *patterns = NULL;
   svn_fs_root_t *root;
   const char *depth_word;
-  svn_boolean_t path_info_only;
   svn_ra_svn__list_t *dirent_fields_list = NULL;
   svn_ra_svn__list_t *patterns_list = NULL;
   int i;
@@ -3762,11 +3815,108 @@ list(svn_ra_svn_conn_t *conn,
   SVN_CMD_ERR(svn_fs_revision_root(&root, b->repository->fs, rev, pool));
 
   /* Fetch the directory entries if requested and send them immediately. */
-  path_info_only = (rb.dirent_fields & ~SVN_DIRENT_KIND) == 0;
-  err = svn_repos_list(root, full_path, patterns, depth, path_info_only,
-                       authz_check_access_cb_func(b), &ab, list_receiver,
-                       &rb, NULL, NULL, pool);
+  err = svn_repos_list2(root, full_path, patterns, depth, rb.dirent_fields,
+                        b->list_thread_count, authz_check_access_cb_func(b),
+                        &ab, list_receiver, &rb, NULL, NULL, pool);
+
+
+  /* Finish response. */
+  write_err = svn_ra_svn__write_word(conn, pool, "done");
+  if (write_err)
+    {
+      svn_error_clear(err);
+      return write_err;
+    }
+  SVN_CMD_ERR(err);
+
+  return svn_error_trace(svn_ra_svn__write_cmd_response(conn, pool, ""));
+}
+
+/* Baton type to be used with blame_receiver. */
+typedef struct blame_receiver_baton_t
+{
+  svn_ra_svn_conn_t *conn;
+
+  /* The revisions (svn_revnum_t) whose revprops have already been sent. */
+  apr_hash_t *sent_revs;
+} blame_receiver_baton_t;
+
+/* Implements svn_repos_blame_receiver_t, sending LINE to the client
+   along with REVISION.  The REV_PROPS are only sent with the first line
+   attributed to REVISION.  BATON must be a blame_receiver_baton_t. */
+static svn_error_t *
+blame_receiver(void *baton,
+               apr_int64_t line_no,
+               svn_revnum_t revision,
+               apr_hash_t *rev_props,
+               const svn_string_t *line,
+               apr_pool_t *pool)
+{
+  blame_receiver_baton_t *b = baton;
+
+  SVN_ERR(svn_ra_svn__write_tuple(b->conn, pool, "s(?r)(!", line, revision));
+
+  if (SVN_IS_VALID_REVNUM(revision)
+      && !apr_hash_get(b->sent_revs, &revision, sizeof(revision)))
+    {
+      svn_revnum_t *key = apr_pmemdup(apr_hash_pool_get(b->sent_revs),
+                                      &revision, sizeof(revision));
+      apr_hash_set(b->sent_revs, key, sizeof(*key), key);
+
+      SVN_ERR(svn_ra_svn__write_tuple(b->conn, pool, "!(!"));
+      SVN_ERR(svn_ra_svn__write_proplist(b->conn, pool, rev_props));
+      return svn_error_trace(svn_ra_svn__write_tuple(b->conn, pool, "!))"));
+    }
+
+  return svn_error_trace(svn_ra_svn__write_tuple(b->conn, pool, "!)"));
+}
+
+static svn_error_t *
+blame(svn_ra_svn_conn_t *conn,
+      apr_pool_t *pool,
+      svn_ra_svn__list_t *params,
+      void *baton)
+{
+  server_baton_t *b = baton;
+  const char *path, *full_path, *canonical_path;
+  svn_revnum_t start_rev, end_rev;
+  const char *ignore_space;
+  svn_boolean_t ignore_eol_style;
+  svn_diff_file_options_t *diff_options;
+  blame_receiver_baton_t rb;
+  svn_error_t *err, *write_err;
+
+  authz_baton_t ab;
+  ab.server = b;
+  ab.conn = conn;
+
+  /* Read the command parameters. */
+  SVN_ERR(svn_ra_svn__parse_tuple(params, "crrwb", &path, &start_rev,
+                                  &end_rev, &ignore_space,
+                                  &ignore_eol_style));
+  SVN_ERR(svn_relpath_canonicalize_safe(&canonical_path, NULL, path,
+                                        pool, pool));
+  full_path = svn_fspath__join(b->repository->fs_path->data,
+                               canonical_path, pool);
+
+  diff_options = svn_diff_file_options_create(pool);
+  if (strcmp(ignore_space, "change") == 0)
+    diff_options->ignore_space = svn_diff_file_ignore_space_change;
+  else if (strcmp(ignore_space, "all") == 0)
+    diff_options->ignore_space = svn_diff_file_ignore_space_all;
+  diff_options->ignore_eol_style = ignore_eol_style;
+
+  SVN_ERR(trivial_auth_request(conn, pool, b));
+  SVN_ERR(log_command(b, conn, pool, "%s",
+                      svn_log__blame(full_path, start_rev, end_rev, pool)));
+
+  rb.conn = conn;
+  rb.sent_revs = apr_hash_make(pool);
 
+  err = svn_repos_blame(b->repository->repos, full_path, start_rev, end_rev,
+                        diff_options, b->blame_max_size,
+                        authz_check_access_cb_func(b), &ab,
+                        blame_receiver, &rb, NULL, NULL, pool);
 
   /* Finish response. */
   write_err = svn_ra_svn__write_word(conn, pool, "done");
@@ -3813,6 +3963,7 @@ static const svn_ra_svn__cmd_entry_t main_commands[] = {
   { "get-deleted-rev", get_deleted_rev },
   { "get-iprops",      get_inherited_props },
   { "list",            list },
+  { "blame",           blame },
   { NULL }
 };
 
@@ -4231,6 +4382,8 @@ construct_server_baton(server_baton_t **baton,
   b->read_only = params->read_only;
   b->pool = conn_pool;
   b->vhost = params->vhost;
+  b->list_thread_count = params->list_thread_count;
+  b->blame_max_size = params->blame_max_size;
 
   b->logger = params->logger;
   b->client_info = get_client_info(conn, params, conn_pool);
@@ -4239,7 +4392,7 @@ construct_server_baton(server_baton_t **baton,
    * send an empty mechlist. */
   if (params->compression_level > 0)
     SVN_ERR(svn_ra_svn__write_cmd_response(conn, scratch_pool,
-                                           "nn()(wwwwwwwwwwwww)",
+                                           "nn()(wwwwwwwwwwwwww)",
                                            (apr_uint64_t) 2, (apr_uint64_t) 2,
                                            SVN_RA_SVN_CAP_EDIT_PIPELINE,
                                            SVN_RA_SVN_CAP_SVNDIFF1,
@@ -4253,11 +4406,12 @@ construct_server_baton(server_baton_t **baton,
                                            SVN_RA_SVN_CAP_INHERITED_PROPS,
                                            SVN_RA_SVN_CAP_EPHEMERAL_TXNPROPS,
                                            SVN_RA_SVN_CAP_GET_FILE_REVS_REVERSE,
-                                           SVN_RA_SVN_CAP_LIST
+                                           SVN_RA_SVN_CAP_LIST,
+                                           SVN_RA_SVN_CAP_BLAME
                                            ));
   else
     SVN_ERR(svn_ra_svn__write_cmd_response(conn, scratch_pool,
-                                           "nn()(wwwwwwwwwww)",
+                                           "nn()(wwwwwwwwwwww)",
                                            (apr_uint64_t) 2, (apr_uint64_t) 2,
                                            SVN_RA_SVN_CAP_EDIT_PIPELINE,
                                            SVN_RA_SVN_CAP_ABSENT_ENTRIES,
@@ -4269,7 +4423,8 @@ construct_server_baton(server_baton_t **baton,
                                            SVN_RA_SVN_CAP_INHERITED_PROPS,
                                            SVN_RA_SVN_CAP_EPHEMERAL_TXNPROPS,
                                            SVN_RA_SVN_CAP_GET_FILE_REVS_REVERSE,
-                                           SVN_RA_SVN_CAP_LIST
+                                           SVN_RA_SVN_CAP_LIST,
+                                           SVN_RA_SVN_CAP_BLAME
                                            ));
 
   /* Read client response, which we assume to be in version 2 format:
@@ -4340,6 +4495,12 @@ construct_server_baton(server_baton_t **baton,
                                        handle_authz_warning, b,
                                        conn_pool, scratch_pool),
                             b);
+  if (!err && params->report_cache_max_size)
+    svn_repos__enable_report_cache(b->repository->repos,
+                                   params->report_cache_max_size);
+  if (!err && params->replay_cache_max_size)
+    svn_repos__enable_replay_cache(b->repository->repos,
+                                   params->replay_cache_max_size);
   if (!err)
     {
       if (b->repository->anon_access == NO_ACCESS
@@ -90,6 +90,8 @@ typedef struct server_baton_t {
                               May be NULL even if log_file is not. */
   svn_boolean_t read_only; /* Disallow write access (global flag) */
   svn_boolean_t vhost;     /* Use virtual-host-based path to repo. */
+  int list_thread_count;   /* Threads to use for recursive lists. */
+  svn_filesize_t blame_max_size; /* Largest file to blame, 0 = no limit. */
   apr_pool_t *pool;
 } server_baton_t;
 
@@ -157,6 +159,20 @@ typedef struct serve_params_t {
   /* If not 0, stop sending a response once it exceeds this value. */
   apr_uint64_t max_response_size;
 
+  /* If not 0, cache the editor drives of update reports on disk, up to
+     this size in total. */
+  apr_uint64_t report_cache_max_size;
+
+  /* If not 0, cache replayed revisions on disk, up to this size per
+     revision. */
+  apr_uint64_t replay_cache_max_size;
+
+  /* Number of threads to use for recursive list requests. */
+  int list_thread_count;
+
+  /* If not 0, refuse to compute blames for files larger than this. */
+  svn_filesize_t blame_max_size;
+
   /* Use virtual-host-based path to repo. */
   svn_boolean_t vhost;
 } serve_params_t;
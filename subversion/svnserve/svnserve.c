@@ -164,6 +164,12 @@ enum run_mode {
  */
 #define MAX_REQUEST_SIZE 16
 
+/* Default limit in MBytes to the size of files that we compute blames
+ * for.  The server holds two revisions of the file in memory while
+ * doing so.
+ */
+#define MAX_BLAME_SIZE 64
+
 #ifdef WIN32
 static apr_os_sock_t winservice_svnserve_accept_socket = INVALID_SOCKET;
 
@@ -222,6 +228,11 @@ void winservice_notify_stop(void)
 #define SVNSERVE_OPT_MAX_REQUEST     274
 #define SVNSERVE_OPT_MAX_RESPONSE    275
 #define SVNSERVE_OPT_CACHE_NODEPROPS 276
+#define SVNSERVE_OPT_SHARED_DAG_CACHE 277
+#define SVNSERVE_OPT_CACHE_UPDATE_REPORTS 278
+#define SVNSERVE_OPT_CACHE_REPLAYS   279
+#define SVNSERVE_OPT_LIST_THREADS    280
+#define SVNSERVE_OPT_MAX_BLAME       281
 
 /* Text macro because we can't use #ifdef sections inside a N_("...")
    macro expansion. */
@@ -325,6 +336,49 @@ static const apr_getopt_option_t svnserve__options[] =
         "Default is yes.\n"
         "                             "
         "[used for FSFS repositories only]")},
+    {"shared-dag-cache", SVNSERVE_OPT_SHARED_DAG_CACHE, 1,
+     N_("enable or disable sharing path lookup results\n"
+        "                             "
+        "between all connections to the same repository.\n"
+        "                             "
+        "Default is no.\n"
+        "                             "
+        "[used for FSX repositories only]")},
+    {"cache-update-reports", SVNSERVE_OPT_CACHE_UPDATE_REPORTS, 1,
+     N_("Cache responses to identical update and checkout\n"
+        "                             "
+        "reports in the repository's report-cache directory,\n"
+        "                             "
+        "removing the least recently used ones once they\n"
+        "                             "
+        "take up more than ARG MB in total.\n"
+        "                             "
+        "Default is 0 (disabled).")},
+    {"cache-replays", SVNSERVE_OPT_CACHE_REPLAYS, 1,
+     N_("Cache replayed revisions of up to ARG MB each,\n"
+        "                             "
+        "as requested by svnsync and other mirrors, in the\n"
+        "                             "
+        "repository's replay-cache directory.  Remove that\n"
+        "                             "
+        "directory to reclaim the disk space.\n"
+        "                             "
+        "Default is 0 (disabled).")},
+    {"list-threads", SVNSERVE_OPT_LIST_THREADS, 1,
+     N_("Use up to ARG threads to walk the repository tree\n"
+        "                             "
+        "for recursive list requests.\n"
+        "                             "
+        "Default is 1 (no additional threads).")},
+    {"max-blame-size", SVNSERVE_OPT_MAX_BLAME, 1,
+     N_("Maximum size in MB of files that the server will\n"
+        "                             "
+        "compute blames for.  Clients fall back to their\n"
+        "                             "
+        "own blame computation for larger files.\n"
+        "                             "
+        "0 disables the size check; default is "
+        APR_STRINGIFY(MAX_BLAME_SIZE) ".")},
     {"client-speed", SVNSERVE_OPT_CLIENT_SPEED, 1,
      N_("Optimize network handling based on the assumption\n"
         "                             "
@@ -746,6 +800,7 @@ sub_main(int *exit_code,
   svn_boolean_t cache_txdeltas = TRUE;
   svn_boolean_t cache_revprops = FALSE;
   svn_boolean_t use_block_read = FALSE;
+  svn_boolean_t use_shared_dag_cache = FALSE;
   apr_uint16_t port = SVN_RA_SVN_PORT;
   const char *host = NULL;
   int family = APR_INET;
@@ -799,6 +854,10 @@ sub_main(int *exit_code,
   params.error_check_interval = 4096;
   params.max_request_size = MAX_REQUEST_SIZE * 0x100000;
   params.max_response_size = 0;
+  params.report_cache_max_size = 0;
+  params.replay_cache_max_size = 0;
+  params.list_thread_count = 1;
+  params.blame_max_size = MAX_BLAME_SIZE * 0x100000;
 
   while (1)
     {
@@ -954,6 +1013,11 @@ sub_main(int *exit_code,
           use_block_read = svn_tristate__from_word(arg) == svn_tristate_true;
           break;
 
+        case SVNSERVE_OPT_SHARED_DAG_CACHE:
+          use_shared_dag_cache
+            = svn_tristate__from_word(arg) == svn_tristate_true;
+          break;
+
         case SVNSERVE_OPT_CLIENT_SPEED:
           {
             apr_size_t bandwidth = (apr_size_t)apr_strtoi64(arg, NULL, 0);
@@ -979,6 +1043,26 @@ sub_main(int *exit_code,
           params.max_response_size = 0x100000 * apr_strtoi64(arg, NULL, 0);
           break;
 
+        case SVNSERVE_OPT_CACHE_UPDATE_REPORTS:
+          params.report_cache_max_size
+            = 0x100000 * apr_strtoi64(arg, NULL, 0);
+          break;
+
+        case SVNSERVE_OPT_CACHE_REPLAYS:
+          params.replay_cache_max_size
+            = 0x100000 * apr_strtoi64(arg, NULL, 0);
+          break;
+
+        case SVNSERVE_OPT_LIST_THREADS:
+          params.list_thread_count = (int)apr_strtoi64(arg, NULL, 0);
+          if (params.list_thread_count < 1)
+            params.list_thread_count = 1;
+          break;
+
+        case SVNSERVE_OPT_MAX_BLAME:
+          params.blame_max_size = 0x100000 * apr_strtoi64(arg, NULL, 0);
+          break;
+
         case SVNSERVE_OPT_MIN_THREADS:
           min_thread_count = (apr_size_t)apr_strtoi64(arg, NULL, 0);
           break;
@@ -1074,6 +1158,8 @@ sub_main(int *exit_code,
                 cache_revprops ? "2" :"0");
   svn_hash_sets(params.fs_config, SVN_FS_CONFIG_FSFS_BLOCK_READ,
                 use_block_read ? "1" :"0");
+  svn_hash_sets(params.fs_config, SVN_FS_CONFIG_FSX_SHARED_DAG_CACHE,
+                use_shared_dag_cache ? "1" :"0");
 
   SVN_ERR(svn_repos__config_pool_create(&params.config_pool,
                                         is_multi_threaded,
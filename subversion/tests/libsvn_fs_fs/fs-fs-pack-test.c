@@ -26,16 +26,20 @@
 
 #include "../svn_test.h"
 #include "../../libsvn_fs/fs-loader.h"
+#include "../../libsvn_fs_fs/cached_data.h"
 #include "../../libsvn_fs_fs/fs.h"
 #include "../../libsvn_fs_fs/fs_fs.h"
 #include "../../libsvn_fs_fs/low_level.h"
 #include "../../libsvn_fs_fs/pack.h"
+#include "../../libsvn_fs_fs/revprop-index.h"
+#include "../../libsvn_fs_fs/revprops.h"
 #include "../../libsvn_fs_fs/util.h"
 
 #include "svn_hash.h"
 #include "svn_pools.h"
 #include "svn_props.h"
 #include "svn_fs.h"
+#include "private/svn_fs_fs_private.h"
 #include "private/svn_string_private.h"
 
 #include "../svn_test_fs.h"
@@ -417,6 +421,87 @@ read_packed_fs(const svn_test_opts_t *opts,
 #undef SHARD_SIZE
 #undef MAX_REV
 
+/* ------------------------------------------------------------------------ */
+#define REPO_NAME "test-repo-read-packed-fs-mmap"
+#define SHARD_SIZE 5
+#define MAX_REV 11
+static svn_error_t *
+read_packed_fs_mmap(const svn_test_opts_t *opts,
+                    apr_pool_t *pool)
+{
+  svn_fs_t *fs;
+  svn_stream_t *rstream;
+  svn_stringbuf_t *rstring;
+  svn_stringbuf_t *config;
+  apr_hash_t *fs_config;
+  const char *config_path;
+  svn_revnum_t i;
+
+  if (opts->server_minor_version && (opts->server_minor_version < 9))
+    return svn_error_create(SVN_ERR_TEST_SKIPPED, NULL,
+                            "pre-1.9 SVN doesn't have block-read");
+
+  SVN_ERR(create_packed_filesystem(REPO_NAME, opts, MAX_REV, SHARD_SIZE, pool));
+
+  /* Enable memory mapped access to rev and pack files. */
+  config_path = svn_dirent_join(REPO_NAME, PATH_CONFIG, pool);
+  SVN_ERR(svn_stringbuf_from_file2(&config, config_path, pool));
+  svn_stringbuf_appendcstr(config, "\n[" CONFIG_SECTION_IO "]\n"
+                                   CONFIG_OPTION_ENABLE_MMAP " = true\n");
+  SVN_ERR(svn_io_write_atomic2(config_path, config->data, config->len,
+                               NULL, FALSE, pool));
+
+  /* Noderevs and changed paths lists are only parsed from the mapped data
+   * in block-read mode.  Use a separate cache namespace to make sure we
+   * actually read from disk. */
+  fs_config = apr_hash_make(pool);
+  svn_hash_sets(fs_config, SVN_FS_CONFIG_FSFS_CACHE_NS,
+                           svn_uuid_generate(pool));
+  svn_hash_sets(fs_config, SVN_FS_CONFIG_FSFS_BLOCK_READ, "1");
+  SVN_ERR(svn_fs_open2(&fs, REPO_NAME, fs_config, pool, pool));
+
+  for (i = 1; i < (MAX_REV + 1); i++)
+    {
+      svn_fs_root_t *rev_root;
+      svn_stringbuf_t *sb;
+      svn_fs_path_change_iterator_t *iterator;
+      svn_fs_path_change3_t *change;
+
+      SVN_ERR(svn_fs_revision_root(&rev_root, fs, i, pool));
+      SVN_ERR(svn_fs_file_contents(&rstream, rev_root, "iota", pool));
+      SVN_ERR(svn_test__stream_to_string(&rstring, rstream, pool));
+
+      if (i == 1)
+        sb = svn_stringbuf_create("This is the file 'iota'.\n", pool);
+      else
+        sb = svn_stringbuf_create(get_rev_contents(i, pool), pool);
+
+      if (! svn_stringbuf_compare(rstring, sb))
+        return svn_error_createf(SVN_ERR_FS_GENERAL, NULL,
+                                 "Bad data in revision %ld.", i);
+
+      SVN_ERR(svn_fs_paths_changed3(&iterator, rev_root, pool, pool));
+      SVN_ERR(svn_fs_path_change_get(&change, iterator));
+      SVN_TEST_ASSERT(change != NULL);
+    }
+
+  /* Make sure that the data actually came from the mapped files. */
+#if APR_HAS_MMAP
+  {
+    svn_fs_fs__ioctl_get_mmap_stats_output_t *output;
+
+    SVN_ERR(svn_fs_ioctl(fs, SVN_FS_FS__IOCTL_GET_MMAP_STATS, NULL,
+                         (void **)&output, NULL, NULL, pool, pool));
+    SVN_TEST_ASSERT(output->mapped_item_count > 0);
+  }
+#endif
+
+  return SVN_NO_ERROR;
+}
+#undef REPO_NAME
+#undef SHARD_SIZE
+#undef MAX_REV
+
 /* ------------------------------------------------------------------------ */
 #define REPO_NAME "test-repo-commit-packed-fs"
 #define SHARD_SIZE 5
@@ -1888,6 +1973,531 @@ large_delta_against_plain(const svn_test_opts_t *opts,
 
 #undef REPO_NAME
 
+/* ------------------------------------------------------------------------ */
+
+#define REPO_NAME "test-repo-redeltify_packed_fs"
+#define SHARD_SIZE 8
+#define MAX_REV 20
+
+/* Return the expected contents of "foo" in revision REV. */
+static const char *
+get_foo_contents(svn_revnum_t rev,
+                 apr_pool_t *pool)
+{
+  svn_stringbuf_t *contents = svn_stringbuf_create_empty(pool);
+  svn_revnum_t i;
+
+  for (i = 1; i <= rev; ++i)
+    svn_stringbuf_appendcstr(contents,
+                             apr_psprintf(pool,
+                                          "This is line %ld of file foo. It "
+                                          "is long enough for deltification.\n",
+                                          i));
+
+  return contents->data;
+}
+
+/* Create a packed FSFS with the given SHARD_SIZE at REPO_NAME that
+ * contains a single file "foo" with one long delta chain spanning
+ * revisions 1 to MAX_REV.  Set *SKIP if the repository format does not
+ * support redeltification.  Use POOL for allocations. */
+static svn_error_t *
+create_long_chain_fs(svn_boolean_t *skip,
+                     const char *repo_name,
+                     const svn_test_opts_t *opts,
+                     int shard_size,
+                     svn_revnum_t max_rev,
+                     apr_pool_t *pool)
+{
+  svn_fs_t *fs;
+  fs_fs_data_t *ffd;
+  svn_fs_txn_t *txn;
+  svn_fs_root_t *root;
+  svn_revnum_t rev;
+  apr_hash_t *fs_config;
+  apr_pool_t *iterpool;
+
+  *skip = TRUE;
+  if (strcmp(opts->fs_type, "fsfs") != 0)
+    return SVN_NO_ERROR;
+
+  fs_config = apr_hash_make(pool);
+  svn_hash_sets(fs_config, SVN_FS_CONFIG_FSFS_SHARD_SIZE,
+                apr_itoa(pool, shard_size));
+  SVN_ERR(svn_test__create_fs2(&fs, repo_name, opts, fs_config, pool));
+
+  ffd = fs->fsap_data;
+  if (! svn_fs_fs__use_log_addressing(fs))
+    return SVN_NO_ERROR;
+
+  /* Produce one long, linear delta chain. */
+  ffd->max_linear_deltification = 100;
+  ffd->max_deltification_walk = 1000;
+
+  iterpool = svn_pool_create(pool);
+  for (rev = 0; rev < max_rev; )
+    {
+      svn_pool_clear(iterpool);
+      SVN_ERR(svn_fs_begin_txn(&txn, fs, rev, iterpool));
+      SVN_ERR(svn_fs_txn_root(&root, txn, iterpool));
+      if (rev == 0)
+        SVN_ERR(svn_fs_make_file(root, "foo", iterpool));
+      SVN_ERR(svn_test__set_file_contents(root, "foo",
+                                          get_foo_contents(rev + 1, iterpool),
+                                          iterpool));
+      SVN_ERR(svn_fs_commit_txn(NULL, &rev, txn, iterpool));
+    }
+  svn_pool_destroy(iterpool);
+
+  SVN_ERR(svn_fs_pack(repo_name, NULL, NULL, NULL, NULL, pool));
+  *skip = FALSE;
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+redeltify_packed_fs(const svn_test_opts_t *opts,
+                    apr_pool_t *pool)
+{
+  svn_fs_t *fs;
+  svn_fs_root_t *root;
+  svn_revnum_t rev;
+  apr_hash_t *fs_config;
+  svn_fs_fs__ioctl_redeltify_input_t input = { 0 };
+  svn_fs_fs__ioctl_redeltify_output_t *output;
+  svn_boolean_t skip;
+  apr_pool_t *iterpool = svn_pool_create(pool);
+
+  SVN_ERR(create_long_chain_fs(&skip, REPO_NAME, opts, SHARD_SIZE, MAX_REV,
+                               pool));
+  if (skip)
+    return svn_error_create(SVN_ERR_TEST_SKIPPED, NULL, NULL);
+
+  /* Limit the chains in all packed shards. */
+  SVN_ERR(svn_fs_open2(&fs, REPO_NAME, NULL, pool, pool));
+  input.start_rev = SVN_INVALID_REVNUM;
+  input.end_rev = SVN_INVALID_REVNUM;
+  input.max_chain_length = 4;
+  SVN_ERR(svn_fs_ioctl(fs, SVN_FS_FS__IOCTL_REDELTIFY, &input,
+                       (void **)&output, NULL, NULL, pool, pool));
+  SVN_TEST_ASSERT(output->rep_count > 0);
+  SVN_TEST_ASSERT(output->noderev_count >= output->rep_count);
+
+  /* Contents must not change.  To make sure we actually read from disk,
+   * use a new FS instance with disjoint caches. */
+  fs_config = apr_hash_make(pool);
+  svn_hash_sets(fs_config, SVN_FS_CONFIG_FSFS_CACHE_NS,
+                           svn_uuid_generate(pool));
+  SVN_ERR(svn_fs_open2(&fs, REPO_NAME, fs_config, pool, pool));
+
+  for (rev = 1; rev <= MAX_REV; ++rev)
+    {
+      svn_stringbuf_t *contents;
+      const svn_fs_id_t *id;
+      node_revision_t *noderev;
+      int chain_length, shard_count;
+
+      svn_pool_clear(iterpool);
+      SVN_ERR(svn_fs_revision_root(&root, fs, rev, iterpool));
+      SVN_ERR(svn_test__get_file_contents(root, "foo", &contents, iterpool));
+      SVN_TEST_STRING_ASSERT(contents->data,
+                             get_foo_contents(rev, iterpool));
+
+      /* Only the packed shards have been processed. */
+      if (rev >= (MAX_REV / SHARD_SIZE) * SHARD_SIZE)
+        continue;
+
+      SVN_ERR(svn_fs_node_id(&id, root, "foo", iterpool));
+      SVN_ERR(svn_fs_fs__get_node_revision(&noderev, fs, id, iterpool,
+                                           iterpool));
+      SVN_ERR(svn_fs_fs__rep_chain_length(&chain_length, &shard_count,
+                                          noderev->data_rep, fs, iterpool));
+      SVN_TEST_ASSERT(chain_length <= 4);
+    }
+
+  svn_pool_destroy(iterpool);
+
+  /* The index data must be consistent. */
+  SVN_ERR(svn_fs_verify(REPO_NAME, NULL, 0, MAX_REV, NULL, NULL, NULL, NULL,
+                        pool));
+
+  return SVN_NO_ERROR;
+}
+
+#undef REPO_NAME
+#undef SHARD_SIZE
+#undef MAX_REV
+
+/* ------------------------------------------------------------------------ */
+
+#define REPO_NAME "test-repo-revprop_index_packed_fs"
+#define SHARD_SIZE 4
+#define MAX_REV 10
+static svn_error_t *
+revprop_index_packed_fs(const svn_test_opts_t *opts,
+                        apr_pool_t *pool)
+{
+  svn_fs_t *fs;
+  fs_fs_data_t *ffd;
+  svn_fs_txn_t *txn;
+  svn_fs_root_t *root;
+  svn_stringbuf_t *config;
+  const char *config_path;
+  apr_hash_t *fs_config;
+  apr_hash_t *proplist;
+  apr_hash_t *indexed = NULL;
+  svn_revnum_t rev;
+  svn_node_kind_t kind;
+  apr_pool_t *iterpool = svn_pool_create(pool);
+
+  SVN_ERR(prepare_revprop_repo(&fs, REPO_NAME, MAX_REV, SHARD_SIZE, opts,
+                               pool));
+  ffd = fs->fsap_data;
+  if (ffd->format < SVN_FS_FS__MIN_PACKED_REVPROP_FORMAT)
+    return svn_error_create(SVN_ERR_TEST_SKIPPED, NULL,
+                            "revprop index requires packed revprops");
+
+  /* The index has to be enabled explicitly. */
+  SVN_ERR(svn_io_check_path(svn_dirent_join(REPO_NAME, REVPROP_INDEX_NAME,
+                                            pool),
+                            &kind, pool));
+  SVN_TEST_ASSERT(kind == svn_node_none);
+
+  config_path = svn_dirent_join(REPO_NAME, PATH_CONFIG, pool);
+  SVN_ERR(svn_stringbuf_from_file2(&config, config_path, pool));
+  svn_stringbuf_appendcstr(config, "\n[" CONFIG_SECTION_PACKED_REVPROPS "]\n"
+                                   CONFIG_OPTION_ENABLE_REVPROP_INDEX
+                                   " = true\n");
+  SVN_ERR(svn_io_write_atomic2(config_path, config->data, config->len,
+                               NULL, FALSE, pool));
+
+  /* Packing creates the index even if there is no new shard to pack. */
+  SVN_ERR(svn_fs_pack(REPO_NAME, NULL, NULL, NULL, NULL, pool));
+  SVN_ERR(svn_io_check_path(svn_dirent_join(REPO_NAME, REVPROP_INDEX_NAME,
+                                            pool),
+                            &kind, pool));
+  SVN_TEST_ASSERT(kind == svn_node_file);
+
+  /* Change revprops and commit a new revision with the index in place. */
+  SVN_ERR(svn_fs_open2(&fs, REPO_NAME, NULL, pool, pool));
+  SVN_ERR(svn_fs_change_rev_prop2(fs, 2, SVN_PROP_REVISION_LOG, NULL,
+                                  svn_string_create("changed log", pool),
+                                  pool));
+  SVN_ERR(svn_fs_change_rev_prop2(fs, 3, "custom", NULL,
+                                  svn_string_create("value", pool), pool));
+
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, MAX_REV + 1, pool));
+  SVN_ERR(svn_fs_txn_root(&root, txn, pool));
+  SVN_ERR(svn_test__set_file_contents(root, "iota", "newer-iota", pool));
+  SVN_ERR(svn_fs_change_txn_prop(txn, SVN_PROP_REVISION_AUTHOR,
+                                 svn_string_create("someone", pool), pool));
+  SVN_ERR(svn_fs_commit_txn(NULL, &rev, txn, pool));
+  SVN_TEST_ASSERT(rev == MAX_REV + 2);
+
+  /* Use a separate cache namespace to make sure we actually read the
+   * revprops from disk. */
+  fs_config = apr_hash_make(pool);
+  svn_hash_sets(fs_config, SVN_FS_CONFIG_FSFS_CACHE_NS,
+                           svn_uuid_generate(pool));
+  SVN_ERR(svn_fs_open2(&fs, REPO_NAME, fs_config, pool, pool));
+  ffd = fs->fsap_data;
+
+  /* The index must provide the same revprops as the revprop files. */
+  for (rev = 0; rev <= MAX_REV + 2; ++rev)
+    {
+      svn_pool_clear(iterpool);
+      SVN_ERR(svn_fs_fs__revprop_index_get(&indexed, fs, rev, iterpool,
+                                           iterpool));
+
+      ffd->use_revprop_index = FALSE;
+      SVN_ERR(svn_fs_fs__get_revision_proplist(&proplist, fs, rev, TRUE,
+                                               iterpool, iterpool));
+      ffd->use_revprop_index = TRUE;
+
+      /* Revisions with custom revprops are not in the index. */
+      if (rev == 3)
+        {
+          SVN_TEST_ASSERT(indexed == NULL);
+          continue;
+        }
+
+      SVN_TEST_ASSERT(indexed != NULL);
+      SVN_TEST_ASSERT(apr_hash_count(indexed) == apr_hash_count(proplist));
+      SVN_TEST_STRING_ASSERT(svn_prop_get_value(indexed,
+                                                SVN_PROP_REVISION_DATE),
+                             svn_prop_get_value(proplist,
+                                                SVN_PROP_REVISION_DATE));
+      SVN_TEST_STRING_ASSERT(svn_prop_get_value(indexed,
+                                                SVN_PROP_REVISION_LOG),
+                             svn_prop_get_value(proplist,
+                                                SVN_PROP_REVISION_LOG));
+      SVN_TEST_STRING_ASSERT(svn_prop_get_value(indexed,
+                                                SVN_PROP_REVISION_AUTHOR),
+                             svn_prop_get_value(proplist,
+                                                SVN_PROP_REVISION_AUTHOR));
+    }
+
+  svn_pool_destroy(iterpool);
+
+  SVN_ERR(svn_fs_fs__revprop_index_get(&indexed, fs, MAX_REV + 2, pool,
+                                       pool));
+  SVN_TEST_STRING_ASSERT(svn_prop_get_value(indexed,
+                                            SVN_PROP_REVISION_AUTHOR),
+                         "someone");
+  SVN_ERR(svn_fs_fs__revprop_index_get(&indexed, fs, 2, pool, pool));
+  SVN_TEST_STRING_ASSERT(svn_prop_get_value(indexed, SVN_PROP_REVISION_LOG),
+                         "changed log");
+
+  /* The custom revprop must still be visible through the FS API. */
+  SVN_ERR(svn_fs_revision_proplist2(&proplist, fs, 3, FALSE, pool, pool));
+  SVN_TEST_STRING_ASSERT(svn_prop_get_value(proplist, "custom"), "value");
+
+  return SVN_NO_ERROR;
+}
+
+#undef REPO_NAME
+#undef SHARD_SIZE
+#undef MAX_REV
+
+/* ------------------------------------------------------------------------ */
+
+/* Baton for hotcopy_notify(). */
+struct hotcopy_notify_baton
+{
+  /* Number of notifications received. */
+  int count;
+
+  /* Revision after the end of the last notified range. */
+  svn_revnum_t next_rev;
+};
+
+/* Implements svn_fs_hotcopy_notify_t.  Count the notifications and check
+   that they arrive in revision order. */
+static void
+hotcopy_notify(void *baton,
+               svn_revnum_t start_revision,
+               svn_revnum_t end_revision,
+               apr_pool_t *pool)
+{
+  struct hotcopy_notify_baton *hnb = baton;
+
+  SVN_ERR_ASSERT_NO_RETURN(start_revision >= hnb->next_rev);
+  SVN_ERR_ASSERT_NO_RETURN(end_revision >= start_revision);
+
+  hnb->count++;
+  hnb->next_rev = end_revision + 1;
+}
+
+/* Set the timestamp of the pack files in the first SHARD_COUNT shards of
+   the FSFS at PATH to some time in the future.  Use POOL for temporary
+   allocations. */
+static svn_error_t *
+touch_pack_files(const char *path,
+                 int shard_count,
+                 apr_pool_t *pool)
+{
+  int shard;
+  apr_time_t future = apr_time_now() + apr_time_from_sec(3600);
+
+  for (shard = 0; shard < shard_count; ++shard)
+    {
+      const char *pack_dir = apr_psprintf(pool, "%d" PATH_EXT_PACKED_SHARD,
+                                          shard);
+      SVN_ERR(svn_io_set_file_affected_time(future,
+                                            svn_dirent_join_many(pool, path,
+                                                                 PATH_REVS_DIR,
+                                                                 pack_dir,
+                                                                 PATH_PACKED,
+                                                                 SVN_VA_NULL),
+                                            pool));
+    }
+
+  return SVN_NO_ERROR;
+}
+
+#define REPO_NAME "test-repo-hotcopy_packed_fs_parallel"
+#define SHARD_SIZE 4
+#define MAX_REV 13
+static svn_error_t *
+hotcopy_packed_fs_parallel(const svn_test_opts_t *opts,
+                           apr_pool_t *pool)
+{
+  const char *dst_path = REPO_NAME "-copy";
+  struct hotcopy_notify_baton hnb = { 0 };
+  svn_fs_t *fs;
+  fs_fs_data_t *ffd;
+  svn_revnum_t youngest;
+  svn_revnum_t rev;
+  apr_pool_t *iterpool = svn_pool_create(pool);
+
+  SVN_ERR(create_packed_filesystem(REPO_NAME, opts, MAX_REV, SHARD_SIZE,
+                                   pool));
+  SVN_ERR(svn_io_remove_dir2(dst_path, TRUE, NULL, NULL, pool));
+  svn_test_add_dir_cleanup(dst_path);
+
+  /* Full hotcopy, using more threads than there are shards. */
+  SVN_ERR(svn_fs_hotcopy4(REPO_NAME, dst_path, FALSE, FALSE, FALSE, 8,
+                          hotcopy_notify, &hnb, NULL, NULL, pool));
+  SVN_TEST_INT_ASSERT(hnb.next_rev, MAX_REV + 1);
+
+  SVN_ERR(svn_fs_open2(&fs, dst_path, NULL, pool, pool));
+  SVN_ERR(svn_fs_youngest_rev(&youngest, fs, pool));
+  SVN_TEST_INT_ASSERT(youngest, MAX_REV);
+
+  for (rev = 2; rev <= MAX_REV; ++rev)
+    {
+      svn_fs_root_t *rev_root;
+      svn_stream_t *stream;
+      svn_stringbuf_t *contents;
+
+      svn_pool_clear(iterpool);
+      SVN_ERR(svn_fs_revision_root(&rev_root, fs, rev, iterpool));
+      SVN_ERR(svn_fs_file_contents(&stream, rev_root, "iota", iterpool));
+      SVN_ERR(svn_test__stream_to_string(&contents, stream, iterpool));
+      SVN_TEST_STRING_ASSERT(contents->data, get_rev_contents(rev, iterpool));
+    }
+
+  /* Nothing changed, so an incremental hotcopy won't copy anything. */
+  memset(&hnb, 0, sizeof(hnb));
+  SVN_ERR(svn_fs_hotcopy4(REPO_NAME, dst_path, FALSE, TRUE, TRUE, 3,
+                          hotcopy_notify, &hnb, NULL, NULL, pool));
+  SVN_TEST_INT_ASSERT(hnb.count, 0);
+
+  /* Newer timestamps on the source pack files don't matter if we compare
+     their checksums.  That requires logical addressing, though. */
+  SVN_ERR(touch_pack_files(REPO_NAME, MAX_REV / SHARD_SIZE, pool));
+  ffd = fs->fsap_data;
+  if (ffd->use_log_addressing)
+    {
+      SVN_ERR(svn_fs_hotcopy4(REPO_NAME, dst_path, FALSE, TRUE, TRUE, 3,
+                              hotcopy_notify, &hnb, NULL, NULL, pool));
+      SVN_TEST_INT_ASSERT(hnb.count, 0);
+    }
+
+  /* Without comparing checksums, all packed shards get copied again. */
+  SVN_ERR(svn_fs_hotcopy4(REPO_NAME, dst_path, FALSE, TRUE, FALSE, 3,
+                          hotcopy_notify, &hnb, NULL, NULL, pool));
+  SVN_TEST_INT_ASSERT(hnb.count, MAX_REV / SHARD_SIZE);
+
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
+#undef REPO_NAME
+#undef SHARD_SIZE
+#undef MAX_REV
+
+/* ------------------------------------------------------------------------ */
+
+#define REPO_NAME "test-repo-redeltify_and_hotcopy"
+#define SHARD_SIZE 8
+#define MAX_REV 20
+static svn_error_t *
+redeltify_and_hotcopy(const svn_test_opts_t *opts,
+                      apr_pool_t *pool)
+{
+  const char *dst_path = REPO_NAME "-copy";
+  svn_fs_t *fs;
+  svn_fs_t *old_fs;
+  svn_fs_txn_t *txn;
+  svn_fs_root_t *root;
+  svn_revnum_t rev;
+  apr_hash_t *fs_config;
+  svn_fs_fs__ioctl_redeltify_input_t input = { 0 };
+  svn_fs_fs__ioctl_redeltify_output_t *output;
+  svn_boolean_t skip;
+  apr_pool_t *iterpool = svn_pool_create(pool);
+
+  SVN_ERR(create_long_chain_fs(&skip, REPO_NAME, opts, SHARD_SIZE, MAX_REV,
+                               pool));
+  if (skip)
+    return svn_error_create(SVN_ERR_TEST_SKIPPED, NULL, NULL);
+
+  SVN_ERR(svn_io_remove_dir2(dst_path, TRUE, NULL, NULL, pool));
+  svn_test_add_dir_cleanup(dst_path);
+  SVN_ERR(svn_fs_hotcopy4(REPO_NAME, dst_path, FALSE, FALSE, FALSE, 1,
+                          NULL, NULL, NULL, NULL, pool));
+
+  /* Warm the caches of an FS instance that stays open across the
+   * redeltification. */
+  SVN_ERR(svn_fs_open2(&old_fs, REPO_NAME, NULL, pool, pool));
+  for (rev = 1; rev <= MAX_REV; ++rev)
+    {
+      svn_stringbuf_t *contents;
+
+      svn_pool_clear(iterpool);
+      SVN_ERR(svn_fs_revision_root(&root, old_fs, rev, iterpool));
+      SVN_ERR(svn_test__get_file_contents(root, "foo", &contents, iterpool));
+    }
+
+  /* Rewrite the packed shards. */
+  SVN_ERR(svn_fs_open2(&fs, REPO_NAME, NULL, pool, pool));
+  input.start_rev = SVN_INVALID_REVNUM;
+  input.end_rev = SVN_INVALID_REVNUM;
+  input.max_chain_length = 4;
+  SVN_ERR(svn_fs_ioctl(fs, SVN_FS_FS__IOCTL_REDELTIFY, &input,
+                       (void **)&output, NULL, NULL, pool, pool));
+  SVN_TEST_ASSERT(output->rep_count > 0);
+
+  /* The old instance must not mix cached index data of the old pack files
+   * with the new pack file contents.  It must still be able to commit. */
+  for (rev = 1; rev <= MAX_REV; ++rev)
+    {
+      svn_stringbuf_t *contents;
+
+      svn_pool_clear(iterpool);
+      SVN_ERR(svn_fs_revision_root(&root, old_fs, rev, iterpool));
+      SVN_ERR(svn_test__get_file_contents(root, "foo", &contents, iterpool));
+      SVN_TEST_STRING_ASSERT(contents->data,
+                             get_foo_contents(rev, iterpool));
+    }
+
+  SVN_ERR(svn_fs_begin_txn(&txn, old_fs, MAX_REV, pool));
+  SVN_ERR(svn_fs_txn_root(&root, txn, pool));
+  SVN_ERR(svn_test__set_file_contents(root, "foo",
+                                      get_foo_contents(MAX_REV + 1, pool),
+                                      pool));
+  SVN_ERR(svn_fs_commit_txn(NULL, &rev, txn, pool));
+  SVN_TEST_INT_ASSERT(rev, MAX_REV + 1);
+
+  /* The incremental hotcopy must pick up the rewritten pack files, with
+   * and without comparing checksums. */
+  SVN_ERR(svn_fs_hotcopy4(REPO_NAME, dst_path, FALSE, TRUE, TRUE, 1,
+                          NULL, NULL, NULL, NULL, pool));
+  SVN_ERR(svn_fs_verify(dst_path, NULL, 0, MAX_REV + 1, NULL, NULL, NULL,
+                        NULL, pool));
+
+  SVN_ERR(svn_fs_hotcopy4(REPO_NAME, dst_path, FALSE, TRUE, FALSE, 1,
+                          NULL, NULL, NULL, NULL, pool));
+  SVN_ERR(svn_fs_verify(dst_path, NULL, 0, MAX_REV + 1, NULL, NULL, NULL,
+                        NULL, pool));
+
+  /* Read the destination through disjoint caches. */
+  fs_config = apr_hash_make(pool);
+  svn_hash_sets(fs_config, SVN_FS_CONFIG_FSFS_CACHE_NS,
+                           svn_uuid_generate(pool));
+  SVN_ERR(svn_fs_open2(&fs, dst_path, fs_config, pool, pool));
+  for (rev = 1; rev <= MAX_REV + 1; ++rev)
+    {
+      svn_stringbuf_t *contents;
+
+      svn_pool_clear(iterpool);
+      SVN_ERR(svn_fs_revision_root(&root, fs, rev, iterpool));
+      SVN_ERR(svn_test__get_file_contents(root, "foo", &contents, iterpool));
+      SVN_TEST_STRING_ASSERT(contents->data,
+                             get_foo_contents(rev, iterpool));
+    }
+
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
+#undef REPO_NAME
+#undef SHARD_SIZE
+#undef MAX_REV
+
 
 
 /* The test table.  */
@@ -1943,6 +2553,16 @@ static struct svn_test_descriptor_t test_funcs[] =
                        "pack with limited memory for metadata"),
     SVN_TEST_OPTS_PASS(large_delta_against_plain,
                        "large deltas against PLAIN, issue #4658"),
+    SVN_TEST_OPTS_PASS(read_packed_fs_mmap,
+                       "read from a packed FSFS using memory mapping"),
+    SVN_TEST_OPTS_PASS(redeltify_packed_fs,
+                       "shorten delta chains in a packed FSFS"),
+    SVN_TEST_OPTS_PASS(revprop_index_packed_fs,
+                       "use the revprop index of a packed FSFS"),
+    SVN_TEST_OPTS_PASS(hotcopy_packed_fs_parallel,
+                       "parallel and checksum-based hotcopy of packed FSFS"),
+    SVN_TEST_OPTS_PASS(redeltify_and_hotcopy,
+                       "incremental hotcopy after redeltification"),
     SVN_TEST_NULL
   };
 
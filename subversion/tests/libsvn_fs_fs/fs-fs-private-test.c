@@ -32,9 +32,11 @@
 
 #include "private/svn_string_private.h"
 #include "private/svn_fs_fs_private.h"
+#include "private/svn_fs_private.h"
 #include "private/svn_subr_private.h"
 
 #include "../../libsvn_fs_fs/index.h"
+#include "../../libsvn_fs_fs/mergeinfo-index.h"
 #include "../../libsvn_fs_fs/rep-cache.h"
 #include "../../libsvn_fs/fs-loader.h"
 
@@ -499,8 +501,772 @@ build_rep_cache(const svn_test_opts_t *opts, apr_pool_t *pool)
   return SVN_NO_ERROR;
 }
 
+/* ------------------------------------------------------------------------ */
+
+static svn_error_t *
+build_rep_cache_filter(const svn_test_opts_t *opts, apr_pool_t *pool)
+{
+  svn_fs_t *fs;
+  svn_fs_txn_t *txn;
+  svn_fs_root_t *txn_root;
+  svn_fs_root_t *rev_root;
+  svn_revnum_t rev;
+  svn_checksum_t *checksum;
+  representation_t *rep;
+  svn_stringbuf_t *content;
+  svn_node_kind_t kind;
+  const char *fs_path;
+  svn_fs_fs__ioctl_build_rep_cache_input_t input = {0};
+
+  /* Bail (with success) on known-untestable scenarios */
+  if (strcmp(opts->fs_type, "fsfs") != 0)
+    return svn_error_create(SVN_ERR_TEST_SKIPPED, NULL,
+                            "this will test FSFS repositories only");
+
+  if (opts->server_minor_version && (opts->server_minor_version < 6))
+    return svn_error_create(SVN_ERR_TEST_SKIPPED, NULL,
+                            "pre-1.6 SVN doesn't support FSFS rep-sharing");
+
+  /* Create a filesystem with the Greek tree. */
+  fs_path = "test-repo-build-rep-cache-filter-test";
+  SVN_ERR(svn_test__create_fs2(&fs, fs_path, opts, NULL, pool));
+
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, 0, pool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, pool));
+  SVN_ERR(svn_test__create_greek_tree(txn_root, pool));
+  SVN_ERR(svn_fs_commit_txn(NULL, &rev, txn, pool));
+  SVN_TEST_ASSERT(SVN_IS_VALID_REVNUM(rev));
+
+  /* Build the filter. */
+  SVN_ERR(svn_fs_ioctl(fs, SVN_FS_FS__IOCTL_BUILD_REP_CACHE_FILTER,
+                       NULL, NULL, NULL, NULL, pool, pool));
+
+  /* Commits must keep it up-to-date. */
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, rev, pool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, pool));
+  SVN_ERR(svn_test__set_file_contents(txn_root, "iota",
+                                      "new contents of iota\n", pool));
+  SVN_ERR(svn_fs_commit_txn(NULL, &rev, txn, pool));
+  SVN_TEST_ASSERT(SVN_IS_VALID_REVNUM(rev));
+
+  SVN_ERR(svn_stringbuf_from_file2(&content,
+                                   svn_dirent_join(fs_path,
+                                                   REP_CACHE_FILTER_NAME,
+                                                   pool),
+                                   pool));
+  SVN_TEST_ASSERT(content->len > 128);
+  SVN_TEST_ASSERT(!strncmp(content->data, "SVN-REP-CACHE-FILTER 1 2 ", 25));
+
+  /* Existing reps must be found ... */
+  SVN_ERR(svn_fs_revision_root(&rev_root, fs, rev, pool));
+  SVN_ERR(svn_fs_file_checksum(&checksum, svn_checksum_sha1, rev_root,
+                               "iota", TRUE, pool));
+  SVN_ERR(svn_fs_fs__get_rep_reference(&rep, fs, checksum, pool));
+  SVN_TEST_ASSERT(rep);
+  SVN_TEST_ASSERT(rep->revision == rev);
+
+  /* ... while unknown ones are not. */
+  SVN_ERR(svn_checksum(&checksum, svn_checksum_sha1, "not in the repo", 15,
+                       pool));
+  SVN_ERR(svn_fs_fs__get_rep_reference(&rep, fs, checksum, pool));
+  SVN_TEST_ASSERT(rep == NULL);
+
+  /* Sneak an entry into the rep-cache database that the filter does not
+   * know about.  Lookups must not even see it, i.e. the filter has really
+   * been consulted. */
+  SVN_ERR(svn_fs_revision_root(&rev_root, fs, rev, pool));
+  SVN_ERR(svn_fs_file_checksum(&checksum, svn_checksum_sha1, rev_root,
+                               "iota", TRUE, pool));
+  SVN_ERR(svn_fs_fs__get_rep_reference(&rep, fs, checksum, pool));
+  SVN_ERR(svn_checksum(&checksum, svn_checksum_sha1, "not in the filter", 17,
+                       pool));
+  memcpy(rep->sha1_digest, checksum->digest, sizeof(rep->sha1_digest));
+  SVN_ERR(svn_fs_fs__set_rep_reference(fs, rep, pool));
+
+  SVN_ERR(svn_fs_fs__get_rep_reference(&rep, fs, checksum, pool));
+  SVN_TEST_ASSERT(rep == NULL);
+
+  /* Adding entries outside the commit path must drop the filter, so the
+   * new entry becomes visible. */
+  input.start_rev = 1;
+  input.end_rev = rev;
+  SVN_ERR(svn_fs_ioctl(fs, SVN_FS_FS__IOCTL_BUILD_REP_CACHE,
+                       &input, NULL, NULL, NULL, pool, pool));
+  SVN_ERR(svn_io_check_path(svn_dirent_join(fs_path, REP_CACHE_FILTER_NAME,
+                                            pool),
+                            &kind, pool));
+  SVN_TEST_ASSERT(kind == svn_node_none);
+
+  SVN_ERR(svn_fs_fs__get_rep_reference(&rep, fs, checksum, pool));
+  SVN_TEST_ASSERT(rep);
+  SVN_TEST_ASSERT(rep->revision == rev);
+
+  SVN_ERR(svn_fs_verify(fs_path, NULL, 0, SVN_INVALID_REVNUM,
+                        NULL, NULL, NULL, NULL, pool));
+
+  return SVN_NO_ERROR;
+}
+
 
 
+/* ------------------------------------------------------------------------ */
+
+static svn_error_t *
+apply_texts(const svn_test_opts_t *opts, apr_pool_t *pool)
+{
+  svn_fs_t *fs;
+  svn_fs_txn_t *txn;
+  svn_fs_root_t *txn_root;
+  svn_fs_root_t *rev_root;
+  svn_revnum_t rev;
+  const char *fs_path;
+  svn_stringbuf_t *large = svn_stringbuf_create_empty(pool);
+  apr_array_header_t *texts = apr_array_make(pool, 4, sizeof(void *));
+  int i;
+
+  static const char *paths[] = { "iota", "A/mu", "A/B/lambda", "A/D/gamma" };
+
+  /* Bail (with success) on known-untestable scenarios */
+  if (strcmp(opts->fs_type, "fsfs") != 0)
+    return svn_error_create(SVN_ERR_TEST_SKIPPED, NULL,
+                            "this will test FSFS repositories only");
+
+  /* Create a filesystem with the Greek tree. */
+  fs_path = "test-repo-apply-texts-test";
+  SVN_ERR(svn_test__create_fs2(&fs, fs_path, opts, NULL, pool));
+
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, 0, pool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, pool));
+  SVN_ERR(svn_test__create_greek_tree(txn_root, pool));
+  SVN_ERR(svn_fs_commit_txn(NULL, &rev, txn, pool));
+  SVN_TEST_ASSERT(SVN_IS_VALID_REVNUM(rev));
+
+  /* Something that spans multiple delta windows. */
+  for (i = 0; i < 20000; ++i)
+    svn_stringbuf_appendcstr(large,
+                             apr_psprintf(pool, "This is line %d.\n", i));
+
+  /* Replace all texts in one go.  The last two are identical. */
+  for (i = 0; i < 4; ++i)
+    {
+      svn_fs__text_t *text = apr_pcalloc(pool, sizeof(*text));
+      text->path = paths[i];
+      text->contents = i == 0
+                     ? svn_stringbuf__morph_into_string(large)
+                     : svn_string_createf(pool, "new text %d\n",
+                                          i == 3 ? 2 : i);
+      SVN_ERR(svn_checksum(&text->result_checksum, svn_checksum_md5,
+                           text->contents->data, text->contents->len,
+                           pool));
+
+      APR_ARRAY_PUSH(texts, svn_fs__text_t *) = text;
+    }
+
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, rev, pool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, pool));
+
+  SVN_ERR(svn_fs__apply_texts(txn_root, texts, 4, NULL, NULL, pool));
+  SVN_ERR(svn_fs_commit_txn(NULL, &rev, txn, pool));
+  SVN_TEST_ASSERT(SVN_IS_VALID_REVNUM(rev));
+
+  /* Verify the new contents. */
+  SVN_ERR(svn_fs_revision_root(&rev_root, fs, rev, pool));
+  for (i = 0; i < texts->nelts; ++i)
+    {
+      const svn_fs__text_t *text
+        = APR_ARRAY_IDX(texts, i, const svn_fs__text_t *);
+      svn_stream_t *stream;
+      svn_stringbuf_t *contents;
+
+      SVN_ERR(svn_fs_file_contents(&stream, rev_root, text->path, pool));
+      SVN_ERR(svn_stringbuf_from_stream(&contents, stream, 0, pool));
+      SVN_TEST_STRING_ASSERT(contents->data, text->contents->data);
+    }
+
+  /* The same path may not be modified twice in one batch. */
+  APR_ARRAY_PUSH(texts, svn_fs__text_t *)
+    = APR_ARRAY_IDX(texts, 1, svn_fs__text_t *);
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, rev, pool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, pool));
+  SVN_TEST_ASSERT_ERROR(svn_fs__apply_texts(txn_root, texts, 4, NULL, NULL,
+                                            pool),
+                        SVN_ERR_FS_GENERAL);
+  SVN_ERR(svn_fs_abort_txn(txn, pool));
+
+  SVN_ERR(svn_fs_verify(fs_path, NULL, 0, SVN_INVALID_REVNUM,
+                        NULL, NULL, NULL, NULL, pool));
+
+  return SVN_NO_ERROR;
+}
+
+/* ------------------------------------------------------------------------ */
+
+static svn_error_t *
+bulk_mode(const svn_test_opts_t *opts, apr_pool_t *pool)
+{
+  svn_fs_t *fs;
+  svn_fs_t *other_fs;
+  svn_fs_txn_t *txn;
+  svn_fs_root_t *txn_root;
+  svn_fs_root_t *rev_root;
+  svn_revnum_t rev;
+  svn_checksum_t *checksum;
+  representation_t *rep;
+  svn_boolean_t supported;
+  const char *fs_path;
+
+  /* Bail (with success) on known-untestable scenarios */
+  if (strcmp(opts->fs_type, "fsfs") != 0)
+    return svn_error_create(SVN_ERR_TEST_SKIPPED, NULL,
+                            "this will test FSFS repositories only");
+
+  if (opts->server_minor_version && (opts->server_minor_version < 6))
+    return svn_error_create(SVN_ERR_TEST_SKIPPED, NULL,
+                            "pre-1.6 SVN doesn't support FSFS rep-sharing");
+
+  fs_path = "test-repo-bulk-mode-test";
+  SVN_ERR(svn_test__create_fs2(&fs, fs_path, opts, NULL, pool));
+  SVN_ERR(svn_fs__set_bulk_mode(&supported, fs, TRUE, pool));
+  SVN_TEST_ASSERT(supported);
+
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, 0, pool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, pool));
+  SVN_ERR(svn_test__create_greek_tree(txn_root, pool));
+  SVN_ERR(svn_fs_commit_txn(NULL, &rev, txn, pool));
+  SVN_TEST_ASSERT(SVN_IS_VALID_REVNUM(rev));
+
+  /* The new reps can be shared within this instance but have not been
+   * written to the rep-cache database, yet. */
+  SVN_ERR(svn_fs_revision_root(&rev_root, fs, rev, pool));
+  SVN_ERR(svn_fs_file_checksum(&checksum, svn_checksum_sha1, rev_root,
+                               "iota", TRUE, pool));
+  SVN_ERR(svn_fs_fs__get_rep_reference(&rep, fs, checksum, pool));
+  SVN_TEST_ASSERT(rep);
+
+  SVN_ERR(svn_fs_open2(&other_fs, fs_path, NULL, pool, pool));
+  SVN_ERR(svn_fs_fs__get_rep_reference(&rep, other_fs, checksum, pool));
+  SVN_TEST_ASSERT(rep == NULL);
+
+  /* Leaving bulk mode writes them. */
+  SVN_ERR(svn_fs__set_bulk_mode(&supported, fs, FALSE, pool));
+  SVN_ERR(svn_fs_fs__get_rep_reference(&rep, other_fs, checksum, pool));
+  SVN_TEST_ASSERT(rep);
+  SVN_TEST_ASSERT(rep->revision == rev);
+
+  /* Leaving it again is a no-op. */
+  SVN_ERR(svn_fs__set_bulk_mode(&supported, fs, FALSE, pool));
+
+  SVN_ERR(svn_fs_verify(fs_path, NULL, 0, SVN_INVALID_REVNUM,
+                        NULL, NULL, NULL, NULL, pool));
+
+  return SVN_NO_ERROR;
+}
+
+/* ------------------------------------------------------------------------ */
+
+/* Set *HISTORY to a string listing the history locations of PATH@REV in
+   FS, including copies. */
+static svn_error_t *
+get_history_string(const char **history,
+                   svn_fs_t *fs,
+                   const char *path,
+                   svn_revnum_t rev,
+                   apr_pool_t *pool)
+{
+  svn_stringbuf_t *result = svn_stringbuf_create_empty(pool);
+  svn_fs_root_t *root;
+  svn_fs_history_t *hist;
+
+  SVN_ERR(svn_fs_revision_root(&root, fs, rev, pool));
+  SVN_ERR(svn_fs_node_history2(&hist, root, path, pool, pool));
+  SVN_ERR(svn_fs_history_prev2(&hist, hist, TRUE, pool, pool));
+  while (hist)
+    {
+      const char *hist_path;
+      svn_revnum_t hist_rev;
+
+      SVN_ERR(svn_fs_history_location(&hist_path, &hist_rev, hist, pool));
+      svn_stringbuf_appendcstr(result, apr_psprintf(pool, "%s@%ld ",
+                                                    hist_path, hist_rev));
+      SVN_ERR(svn_fs_history_prev2(&hist, hist, TRUE, pool, pool));
+    }
+
+  *history = result->data;
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+build_path_index(const svn_test_opts_t *opts, apr_pool_t *pool)
+{
+  svn_fs_t *fs;
+  svn_fs_txn_t *txn;
+  svn_fs_root_t *txn_root;
+  svn_fs_root_t *rev_root;
+  svn_revnum_t rev;
+  svn_revnum_t deleted;
+  svn_boolean_t available;
+  svn_fs_t *backup_fs;
+  const char *fs_path;
+  const char *backup_path;
+  const char *history;
+  svn_node_kind_t kind;
+  svn_fs_fs__ioctl_build_path_index_input_t input = { 0 };
+  apr_pool_t *subpool = svn_pool_create(pool);
+  int i;
+
+  static const char *expected[][2] = {
+    { "/B/mu",      "/B/mu@5 /B/mu@4 /B/mu@3 /A/mu@2 /A/mu@1 " },
+    { "/B",         "/B@5 /B@4 /B@3 /A@2 /A@1 " },
+    { "/B/D/gamma", "/B/D/gamma@3 /A/D/gamma@1 " },
+    { "/iota",      "/iota@1 " }
+  };
+
+  /* Bail (with success) on known-untestable scenarios */
+  if (strcmp(opts->fs_type, "fsfs") != 0)
+    return svn_error_create(SVN_ERR_TEST_SKIPPED, NULL,
+                            "this will test FSFS repositories only");
+
+  /* r1: Greek tree. */
+  fs_path = "test-repo-build-path-index-test";
+  SVN_ERR(svn_test__create_fs2(&fs, fs_path, opts, NULL, subpool));
+
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, 0, pool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, pool));
+  SVN_ERR(svn_test__create_greek_tree(txn_root, pool));
+  SVN_ERR(svn_fs_commit_txn(NULL, &rev, txn, pool));
+  SVN_TEST_ASSERT(SVN_IS_VALID_REVNUM(rev));
+
+  /* r2: Modify a file. */
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, rev, pool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, pool));
+  SVN_ERR(svn_test__set_file_contents(txn_root, "A/mu", "r2\n", pool));
+  SVN_ERR(svn_fs_commit_txn(NULL, &rev, txn, pool));
+  SVN_TEST_ASSERT(SVN_IS_VALID_REVNUM(rev));
+
+  /* r3: Copy its parent. */
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, rev, pool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, pool));
+  SVN_ERR(svn_fs_revision_root(&rev_root, fs, rev, pool));
+  SVN_ERR(svn_fs_copy(rev_root, "A", txn_root, "B", pool));
+  SVN_ERR(svn_fs_commit_txn(NULL, &rev, txn, pool));
+  SVN_TEST_ASSERT(SVN_IS_VALID_REVNUM(rev));
+
+  /* r4: Modify the copy. */
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, rev, pool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, pool));
+  SVN_ERR(svn_test__set_file_contents(txn_root, "B/mu", "r4\n", pool));
+  SVN_ERR(svn_fs_commit_txn(NULL, &rev, txn, pool));
+  SVN_TEST_ASSERT(SVN_IS_VALID_REVNUM(rev));
+
+  /* Build the index. */
+  SVN_ERR(svn_fs_ioctl(fs, SVN_FS_FS__IOCTL_BUILD_PATH_INDEX,
+                       &input, NULL, NULL, NULL, pool, pool));
+  SVN_ERR(svn_io_check_path(svn_dirent_join(fs_path, "path-index.db", pool),
+                            &kind, pool));
+  SVN_TEST_ASSERT(kind == svn_node_file);
+
+  /* r5: Commits must keep the index up-to-date. */
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, rev, pool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, pool));
+  SVN_ERR(svn_test__set_file_contents(txn_root, "B/mu", "r5\n", pool));
+  SVN_ERR(svn_fs_commit_txn(NULL, &rev, txn, pool));
+  SVN_TEST_ASSERT(SVN_IS_VALID_REVNUM(rev));
+
+  /* History using the index. */
+  for (i = 0; i < sizeof(expected) / sizeof(expected[0]); ++i)
+    {
+      SVN_ERR(get_history_string(&history, fs, expected[i][0], rev, pool));
+      SVN_TEST_STRING_ASSERT(history, expected[i][1]);
+    }
+
+  /* Take a backup, then r6: Delete a parent directory. */
+  backup_path = "test-repo-build-path-index-test-backup";
+  SVN_ERR(svn_io_remove_dir2(backup_path, TRUE, NULL, NULL, pool));
+  SVN_ERR(svn_fs_hotcopy4(fs_path, backup_path, FALSE, FALSE, FALSE, 1,
+                          NULL, NULL, NULL, NULL, pool));
+  svn_test_add_dir_cleanup(backup_path);
+
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, rev, pool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, pool));
+  SVN_ERR(svn_fs_delete(txn_root, "B/D", pool));
+  SVN_ERR(svn_fs_commit_txn(NULL, &deleted, txn, pool));
+  SVN_TEST_ASSERT(deleted == rev + 1);
+
+  /* Deleted-rev lookups using the index. */
+  SVN_ERR(svn_fs__try_get_deleted_rev(&available, &deleted, fs,
+                                      "B/D/gamma", 3, rev + 1, pool));
+  SVN_TEST_ASSERT(available);
+  SVN_TEST_ASSERT(deleted == rev + 1);
+  SVN_ERR(svn_fs__try_get_deleted_rev(&available, &deleted, fs,
+                                      "/B/mu", 3, rev + 1, pool));
+  SVN_TEST_ASSERT(available);
+  SVN_TEST_ASSERT(deleted == SVN_INVALID_REVNUM);
+
+  /* Incremental hotcopies must bring the index up-to-date as well. */
+  SVN_ERR(svn_fs_hotcopy4(fs_path, backup_path, FALSE, TRUE, FALSE, 1,
+                          NULL, NULL, NULL, NULL, pool));
+  SVN_ERR(svn_fs_open2(&backup_fs, backup_path, NULL, pool, pool));
+  SVN_ERR(svn_fs__try_get_deleted_rev(&available, &deleted, backup_fs,
+                                      "/B/D/gamma", 3, rev + 1, pool));
+  SVN_TEST_ASSERT(available);
+  SVN_TEST_ASSERT(deleted == rev + 1);
+  SVN_ERR(svn_fs_verify(backup_path, NULL, 0, SVN_INVALID_REVNUM,
+                        NULL, NULL, NULL, NULL, pool));
+
+  /* Without the index, the results must be the same.  Close the
+     repository first such that we can remove the database. */
+  svn_pool_destroy(subpool);
+  SVN_ERR(svn_io_remove_file2(svn_dirent_join(fs_path, "path-index.db",
+                                              pool),
+                              FALSE, pool));
+  SVN_ERR(svn_fs_open2(&fs, fs_path, NULL, pool, pool));
+  for (i = 0; i < sizeof(expected) / sizeof(expected[0]); ++i)
+    {
+      SVN_ERR(get_history_string(&history, fs, expected[i][0], rev, pool));
+      SVN_TEST_STRING_ASSERT(history, expected[i][1]);
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* ------------------------------------------------------------------------ */
+
+#define REPO_NAME "test-repo-get-repo-stats-cached-test"
+
+/* Set *STATS to the statistics of FS, using CACHE_PATH and THREAD_COUNT.
+ * Allocate the result in POOL. */
+static svn_error_t *
+get_stats(const svn_fs_fs__stats_t **stats,
+          svn_fs_t *fs,
+          const char *cache_path,
+          int thread_count,
+          apr_pool_t *pool)
+{
+  svn_fs_fs__ioctl_get_stats_input_t input = {0};
+  svn_fs_fs__ioctl_get_stats_output_t *output;
+
+  input.cache_path = cache_path;
+  input.thread_count = thread_count;
+  SVN_ERR(svn_fs_ioctl(fs, SVN_FS_FS__IOCTL_GET_STATS, &input,
+                       (void**)&output, NULL, NULL, pool, pool));
+  *stats = output->stats;
+
+  return SVN_NO_ERROR;
+}
+
+/* Verify that ACTUAL and EXPECTED contain the same information. */
+static svn_error_t *
+compare_stats(const svn_fs_fs__stats_t *actual,
+              const svn_fs_fs__stats_t *expected)
+{
+  apr_size_t i;
+  apr_hash_index_t *hi;
+
+  SVN_TEST_ASSERT(actual->total_size == expected->total_size);
+  SVN_TEST_ASSERT(actual->revision_count == expected->revision_count);
+  SVN_TEST_ASSERT(actual->change_count == expected->change_count);
+  SVN_TEST_ASSERT(actual->change_len == expected->change_len);
+
+  /* All the rep, node and histogram members are plain numbers. */
+  SVN_TEST_ASSERT(memcmp(&actual->total_rep_stats,
+                         &expected->total_rep_stats,
+                         (const char *)&expected->largest_changes
+                           - (const char *)&expected->total_rep_stats)
+                  == 0);
+  SVN_TEST_ASSERT(memcmp(&actual->rep_size_histogram,
+                         &expected->rep_size_histogram,
+                         (const char *)&expected->by_extension
+                           - (const char *)&expected->rep_size_histogram)
+                  == 0);
+
+  SVN_TEST_ASSERT(actual->largest_changes->count
+                  == expected->largest_changes->count);
+  for (i = 0; i < expected->largest_changes->count; ++i)
+    {
+      svn_fs_fs__large_change_info_t *lhs = actual->largest_changes->changes[i];
+      svn_fs_fs__large_change_info_t *rhs
+        = expected->largest_changes->changes[i];
+
+      SVN_TEST_ASSERT(lhs->size == rhs->size);
+      SVN_TEST_ASSERT(lhs->revision == rhs->revision);
+      SVN_TEST_STRING_ASSERT(lhs->path->data, rhs->path->data);
+    }
+
+  SVN_TEST_ASSERT(apr_hash_count(actual->by_extension)
+                  == apr_hash_count(expected->by_extension));
+  for (hi = apr_hash_first(NULL, expected->by_extension);
+       hi;
+       hi = apr_hash_next(hi))
+    {
+      svn_fs_fs__extension_info_t *rhs = apr_hash_this_val(hi);
+      svn_fs_fs__extension_info_t *lhs
+        = svn_hash_gets(actual->by_extension, rhs->extension);
+
+      SVN_TEST_ASSERT(lhs);
+      SVN_TEST_ASSERT(memcmp(&lhs->rep_histogram, &rhs->rep_histogram,
+                             sizeof(lhs->rep_histogram)) == 0);
+      SVN_TEST_ASSERT(memcmp(&lhs->node_histogram, &rhs->node_histogram,
+                             sizeof(lhs->node_histogram)) == 0);
+    }
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+get_repo_stats_cached(const svn_test_opts_t *opts,
+                      apr_pool_t *pool)
+{
+  svn_fs_t *fs;
+  svn_fs_txn_t *txn;
+  svn_fs_root_t *txn_root;
+  svn_revnum_t rev;
+  apr_hash_t *fs_config;
+  const svn_fs_fs__stats_t *expected, *actual;
+  const char *cache_path = REPO_NAME ".stats";
+  svn_node_kind_t kind;
+  apr_pool_t *subpool = svn_pool_create(pool);
+  int i;
+
+  /* Bail (with success) on known-untestable scenarios */
+  if (strcmp(opts->fs_type, "fsfs") != 0)
+    return svn_error_create(SVN_ERR_TEST_SKIPPED, NULL,
+                            "this will test FSFS repositories only");
+
+  /* A few tiny shards, some packed and some not. */
+  fs_config = apr_hash_make(pool);
+  svn_hash_sets(fs_config, SVN_FS_CONFIG_FSFS_SHARD_SIZE, "2");
+  SVN_ERR(svn_test__create_fs2(&fs, REPO_NAME, opts, fs_config, subpool));
+
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, 0, subpool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, subpool));
+  SVN_ERR(svn_test__create_greek_tree(txn_root, subpool));
+  SVN_ERR(svn_fs_commit_txn(NULL, &rev, txn, subpool));
+
+  /* Modify files and re-use contents across shards such that reps get
+   * shared between pack files. */
+  for (i = 0; i < 6; ++i)
+    {
+      SVN_ERR(svn_fs_begin_txn(&txn, fs, rev, subpool));
+      SVN_ERR(svn_fs_txn_root(&txn_root, txn, subpool));
+      SVN_ERR(svn_test__set_file_contents(txn_root,
+                                          i % 2 ? "A/mu" : "A/B/lambda",
+                                          i < 3 ? "shared contents\n"
+                                                : "This is the file.\n",
+                                          subpool));
+      SVN_ERR(svn_fs_commit_txn(NULL, &rev, txn, subpool));
+    }
+
+  svn_pool_destroy(subpool);
+  SVN_ERR(svn_fs_pack(REPO_NAME, NULL, NULL, NULL, NULL, pool));
+  SVN_ERR(svn_fs_open2(&fs, REPO_NAME, NULL, pool, pool));
+
+  /* One more non-packed revision. */
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, rev, pool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, pool));
+  SVN_ERR(svn_test__set_file_contents(txn_root, "iota", "shared contents\n",
+                                      pool));
+  SVN_ERR(svn_fs_commit_txn(NULL, &rev, txn, pool));
+
+  /* Plain old single-threaded run. */
+  SVN_ERR(svn_io_remove_file2(cache_path, TRUE, pool));
+  SVN_ERR(get_stats(&expected, fs, NULL, 1, pool));
+  SVN_TEST_ASSERT(expected->revision_count == 9);
+
+  /* Populate the cache. */
+  SVN_ERR(get_stats(&actual, fs, cache_path, 4, pool));
+  SVN_ERR(compare_stats(actual, expected));
+  SVN_ERR(svn_io_check_path(cache_path, &kind, pool));
+  SVN_TEST_ASSERT(kind == svn_node_file);
+
+  /* Use the cache. */
+  SVN_ERR(get_stats(&actual, fs, cache_path, 4, pool));
+  SVN_ERR(compare_stats(actual, expected));
+  SVN_ERR(get_stats(&actual, fs, cache_path, 1, pool));
+  SVN_ERR(compare_stats(actual, expected));
+
+  return SVN_NO_ERROR;
+}
+
+#undef REPO_NAME
+
+/* ------------------------------------------------------------------------ */
+
+/* Implements svn_fs_mergeinfo_receiver_t, collecting the paths in the
+   svn_stringbuf_t BATON. */
+static svn_error_t *
+collect_mergeinfo_paths(const char *path,
+                        svn_mergeinfo_t mergeinfo,
+                        void *baton,
+                        apr_pool_t *scratch_pool)
+{
+  svn_stringbuf_t *paths = baton;
+  svn_stringbuf_appendcstr(paths, path);
+  svn_stringbuf_appendbyte(paths, ' ');
+
+  return SVN_NO_ERROR;
+}
+
+/* Set *PATHS to a string listing the sub-paths of PATH@REV in FS that
+   have mergeinfo, in the order reported by svn_fs_get_mergeinfo3. */
+static svn_error_t *
+get_descendant_mergeinfo_string(const char **paths,
+                                svn_fs_t *fs,
+                                const char *path,
+                                svn_revnum_t rev,
+                                apr_pool_t *pool)
+{
+  svn_stringbuf_t *result = svn_stringbuf_create_empty(pool);
+  apr_array_header_t *query = apr_array_make(pool, 1, sizeof(const char *));
+  svn_fs_root_t *root;
+
+  APR_ARRAY_PUSH(query, const char *) = path;
+  SVN_ERR(svn_fs_revision_root(&root, fs, rev, pool));
+  SVN_ERR(svn_fs_get_mergeinfo3(root, query, svn_mergeinfo_explicit, TRUE,
+                                FALSE, collect_mergeinfo_paths, result,
+                                pool));
+
+  *paths = result->data;
+  return SVN_NO_ERROR;
+}
+
+/* Set *PATHS to a string listing the sub-paths of PATH@REV in FS that
+   have mergeinfo, according to the mergeinfo index. */
+static svn_error_t *
+get_indexed_mergeinfo_string(const char **paths,
+                             svn_fs_t *fs,
+                             const char *path,
+                             svn_revnum_t rev,
+                             apr_pool_t *pool)
+{
+  svn_stringbuf_t *result = svn_stringbuf_create_empty(pool);
+  apr_array_header_t *indexed;
+  svn_boolean_t available;
+  int i;
+
+  SVN_ERR(svn_fs_fs__mergeinfo_index_get_descendants(&available, &indexed,
+                                                     fs, path, rev,
+                                                     pool, pool));
+  SVN_TEST_ASSERT(available);
+  for (i = 0; i < indexed->nelts; ++i)
+    SVN_ERR(collect_mergeinfo_paths(APR_ARRAY_IDX(indexed, i, const char *),
+                                    NULL, result, pool));
+
+  *paths = result->data;
+  return SVN_NO_ERROR;
+}
+
+#define REPO_NAME "test-repo-build-mergeinfo-index-test"
+
+static svn_error_t *
+build_mergeinfo_index(const svn_test_opts_t *opts, apr_pool_t *pool)
+{
+  svn_fs_t *fs;
+  svn_fs_txn_t *txn;
+  svn_fs_root_t *txn_root;
+  svn_fs_root_t *rev_root;
+  svn_revnum_t rev;
+  const char *paths;
+  svn_string_t *mergeinfo = svn_string_create("/trunk:1", pool);
+  svn_fs_fs__ioctl_build_mergeinfo_index_input_t input = { 0 };
+  apr_pool_t *subpool = svn_pool_create(pool);
+  int i;
+
+  static const struct
+  {
+    const char *path;
+    svn_revnum_t rev;
+    const char *expected;
+  } queries[] = {
+    { "/",  3, "/A/B /A/D/G /X/B /X/D/G " },
+    { "/X", 3, "/X/B /X/D/G " },
+    { "/",  4, "/A/D/G /X/B /X/C " },
+    { "/X", 4, "/X/B /X/C " },
+    { "/A", 4, "/A/D/G " },
+    { "/A/D", 4, "/A/D/G " }
+  };
+
+  /* Bail (with success) on known-untestable scenarios */
+  if (strcmp(opts->fs_type, "fsfs") != 0)
+    return svn_error_create(SVN_ERR_TEST_SKIPPED, NULL,
+                            "this will test FSFS repositories only");
+
+  if (opts->server_minor_version && (opts->server_minor_version < 5))
+    return svn_error_create(SVN_ERR_TEST_SKIPPED, NULL,
+                            "pre-1.5 SVN doesn't track mergeinfo");
+
+  /* r1: Greek tree. */
+  SVN_ERR(svn_test__create_fs2(&fs, REPO_NAME, opts, NULL, subpool));
+
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, 0, pool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, pool));
+  SVN_ERR(svn_test__create_greek_tree(txn_root, pool));
+  SVN_ERR(svn_fs_commit_txn(NULL, &rev, txn, pool));
+  SVN_TEST_ASSERT(SVN_IS_VALID_REVNUM(rev));
+
+  /* r2: Add mergeinfo to two directories. */
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, rev, pool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, pool));
+  SVN_ERR(svn_fs_change_node_prop(txn_root, "A/B", SVN_PROP_MERGEINFO,
+                                  mergeinfo, pool));
+  SVN_ERR(svn_fs_change_node_prop(txn_root, "A/D/G", SVN_PROP_MERGEINFO,
+                                  mergeinfo, pool));
+  SVN_ERR(svn_fs_commit_txn(NULL, &rev, txn, pool));
+  SVN_TEST_ASSERT(SVN_IS_VALID_REVNUM(rev));
+
+  /* r3: Copy their parent. */
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, rev, pool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, pool));
+  SVN_ERR(svn_fs_revision_root(&rev_root, fs, rev, pool));
+  SVN_ERR(svn_fs_copy(rev_root, "A", txn_root, "X", pool));
+  SVN_ERR(svn_fs_commit_txn(NULL, &rev, txn, pool));
+  SVN_TEST_ASSERT(SVN_IS_VALID_REVNUM(rev));
+
+  /* Build the index. */
+  SVN_ERR(svn_fs_ioctl(fs, SVN_FS_FS__IOCTL_BUILD_MERGEINFO_INDEX,
+                       &input, NULL, NULL, NULL, pool, pool));
+
+  /* r4: Commits must keep the index up-to-date. */
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, rev, pool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, pool));
+  SVN_ERR(svn_fs_delete(txn_root, "X/D", pool));
+  SVN_ERR(svn_fs_change_node_prop(txn_root, "X/C", SVN_PROP_MERGEINFO,
+                                  mergeinfo, pool));
+  SVN_ERR(svn_fs_change_node_prop(txn_root, "A/B", SVN_PROP_MERGEINFO,
+                                  NULL, pool));
+  SVN_ERR(svn_fs_commit_txn(NULL, &rev, txn, pool));
+  SVN_TEST_ASSERT(SVN_IS_VALID_REVNUM(rev));
+
+  /* Query the index directly and through the FS API. */
+  for (i = 0; i < sizeof(queries) / sizeof(queries[0]); ++i)
+    {
+      SVN_ERR(get_indexed_mergeinfo_string(&paths, fs, queries[i].path,
+                                           queries[i].rev, pool));
+      SVN_TEST_STRING_ASSERT(paths, queries[i].expected);
+
+      SVN_ERR(get_descendant_mergeinfo_string(&paths, fs, queries[i].path,
+                                              queries[i].rev, pool));
+      SVN_TEST_STRING_ASSERT(paths, queries[i].expected);
+    }
+
+  /* Without the index, the results must be the same.  Close the
+     repository first such that we can remove the database. */
+  svn_pool_destroy(subpool);
+  SVN_ERR(svn_io_remove_file2(svn_dirent_join(REPO_NAME,
+                                              "mergeinfo-index.db", pool),
+                              FALSE, pool));
+  SVN_ERR(svn_fs_open2(&fs, REPO_NAME, NULL, pool, pool));
+  for (i = 0; i < sizeof(queries) / sizeof(queries[0]); ++i)
+    {
+      SVN_ERR(get_descendant_mergeinfo_string(&paths, fs, queries[i].path,
+                                              queries[i].rev, pool));
+      SVN_TEST_STRING_ASSERT(paths, queries[i].expected);
+    }
+
+  return SVN_NO_ERROR;
+}
+
+#undef REPO_NAME
+
 /* The test table.  */
 
 static int max_threads = 0;
@@ -516,6 +1282,18 @@ static struct svn_test_descriptor_t test_funcs[] =
                        "load the P2L index"),
     SVN_TEST_OPTS_PASS(build_rep_cache,
                        "build the representation cache"),
+    SVN_TEST_OPTS_PASS(build_rep_cache_filter,
+                       "build the representation cache filter"),
+    SVN_TEST_OPTS_PASS(apply_texts,
+                       "apply multiple texts concurrently"),
+    SVN_TEST_OPTS_PASS(bulk_mode,
+                       "defer rep-cache updates in bulk mode"),
+    SVN_TEST_OPTS_PASS(build_path_index,
+                       "build the path index"),
+    SVN_TEST_OPTS_PASS(get_repo_stats_cached,
+                       "incremental statistics on a FSFS filesystem"),
+    SVN_TEST_OPTS_PASS(build_mergeinfo_index,
+                       "build the mergeinfo index"),
     SVN_TEST_NULL
   };
 
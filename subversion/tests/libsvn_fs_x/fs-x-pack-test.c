@@ -29,10 +29,12 @@
 #include "../../libsvn_fs_x/fs.h"
 #include "../../libsvn_fs_x/reps.h"
 
+#include "svn_hash.h"
 #include "svn_pools.h"
 #include "svn_props.h"
 #include "svn_fs.h"
 #include "private/svn_string_private.h"
+#include "private/svn_fs_x_private.h"
 
 #include "../svn_test_fs.h"
 
@@ -845,6 +847,324 @@ pack_shard_size_one(const svn_test_opts_t *opts,
 #undef SHARD_SIZE
 #undef MAX_REV
 /* ------------------------------------------------------------------------ */
+#define REPO_NAME "test-repo-fsx-pack-threads"
+#define SHARD_SIZE 8
+#define MAX_REV 7
+
+/* Create a FSX repository at DIR with a single shard of MAX_REV+1
+ * revisions containing many similar file properties and pack it using
+ * THREADS threads.  Return the contents of the pack file in *PACK_FILE.
+ * Use POOL for allocations.
+ */
+static svn_error_t *
+create_pack_with_threads(svn_stringbuf_t **pack_file,
+                         const char *dir,
+                         const svn_test_opts_t *opts,
+                         int threads,
+                         apr_pool_t *pool)
+{
+  svn_fs_t *fs;
+  svn_fs_txn_t *txn;
+  svn_fs_root_t *txn_root;
+  const char *conflict;
+  const char *config;
+  svn_revnum_t rev;
+  apr_pool_t *subpool = svn_pool_create(pool);
+  apr_pool_t *iterpool;
+  int version;
+
+  SVN_ERR(svn_test__create_fs(&fs, dir, opts, subpool));
+  svn_pool_destroy(subpool);
+  subpool = svn_pool_create(pool);
+
+  /* Use small blocks to get many containers. */
+  SVN_ERR(svn_io_read_version_file(&version,
+                                   svn_dirent_join(dir, "format", subpool),
+                                   subpool));
+  SVN_ERR(write_format(dir, version, SHARD_SIZE, subpool));
+  config = apr_psprintf(subpool,
+                        "[" CONFIG_SECTION_IO "]\n"
+                        CONFIG_OPTION_BLOCK_SIZE " = 1\n"
+                        "[" CONFIG_SECTION_PACK "]\n"
+                        CONFIG_OPTION_PACK_THREADS " = %d\n",
+                        threads);
+  SVN_ERR(svn_io_write_atomic2(svn_dirent_join(dir, PATH_CONFIG, subpool),
+                               config, strlen(config), NULL, FALSE,
+                               subpool));
+
+  SVN_ERR(svn_fs_open2(&fs, dir, NULL, subpool, subpool));
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, 0, subpool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, subpool));
+  SVN_ERR(svn_test__create_greek_tree(txn_root, subpool));
+  SVN_ERR(svn_fs_commit_txn(&conflict, &rev, txn, subpool));
+
+  /* Set similar properties on all files in each revision. */
+  iterpool = svn_pool_create(subpool);
+  while (rev < MAX_REV)
+    {
+      const svn_test__tree_entry_t *entry;
+      svn_stringbuf_t *value;
+      int i;
+
+      svn_pool_clear(iterpool);
+      value = svn_stringbuf_create_empty(iterpool);
+      for (i = 0; i < 100; ++i)
+        svn_stringbuf_appendcstr(value,
+                                 apr_psprintf(iterpool, "line %d of r%ld\n",
+                                              i, rev));
+
+      SVN_ERR(svn_fs_begin_txn(&txn, fs, rev, iterpool));
+      SVN_ERR(svn_fs_txn_root(&txn_root, txn, iterpool));
+      for (entry = svn_test__greek_tree_nodes; entry->path; ++entry)
+        if (entry->contents)
+          SVN_ERR(svn_fs_change_node_prop(txn_root, entry->path, "prop",
+                                          svn_string_createf(iterpool,
+                                                             "%s\n%s",
+                                                             entry->path,
+                                                             value->data),
+                                          iterpool));
+
+      SVN_ERR(svn_fs_commit_txn(&conflict, &rev, txn, iterpool));
+      SVN_TEST_ASSERT(SVN_IS_VALID_REVNUM(rev));
+    }
+  svn_pool_destroy(iterpool);
+  svn_pool_destroy(subpool);
+
+  SVN_ERR(svn_fs_pack(dir, NULL, NULL, NULL, NULL, pool));
+  SVN_ERR(svn_stringbuf_from_file2(pack_file,
+                                   svn_dirent_join_many(pool, dir,
+                                                   PATH_REVS_DIR,
+                                                   "0" PATH_EXT_PACKED_SHARD,
+                                                   PATH_PACKED,
+                                                   SVN_VA_NULL),
+                                   pool));
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+pack_with_threads(const svn_test_opts_t *opts,
+                  apr_pool_t *pool)
+{
+  svn_stringbuf_t *single_threaded;
+  svn_stringbuf_t *multi_threaded;
+  svn_fs_t *fs;
+  svn_fs_root_t *root;
+  svn_string_t *value;
+
+  /* Bail (with success) on known-untestable scenarios */
+  if (strcmp(opts->fs_type, "fsx") != 0)
+    return svn_error_create(SVN_ERR_TEST_SKIPPED, NULL,
+                            "this will test FSX repositories only");
+
+  SVN_ERR(create_pack_with_threads(&single_threaded, REPO_NAME "-1", opts,
+                                   1, pool));
+  SVN_ERR(create_pack_with_threads(&multi_threaded, REPO_NAME "-4", opts,
+                                   4, pool));
+
+  /* The number of threads must not change the pack file contents. */
+  SVN_TEST_ASSERT(svn_stringbuf_compare(single_threaded, multi_threaded));
+
+  /* And the containers must be readable. */
+  SVN_ERR(svn_fs_open2(&fs, REPO_NAME "-4", NULL, pool, pool));
+  SVN_ERR(svn_fs_revision_root(&root, fs, MAX_REV, pool));
+  SVN_ERR(svn_fs_node_prop(&value, root, "A/mu", "prop", pool));
+  SVN_TEST_ASSERT(value && strncmp(value->data, "A/mu\n", 5) == 0);
+
+  return SVN_NO_ERROR;
+}
+
+#undef REPO_NAME
+#undef SHARD_SIZE
+#undef MAX_REV
+/* ------------------------------------------------------------------------ */
+#define REPO_NAME "test-repo-fsx-shared-dag-cache"
+#define SHARD_SIZE 2
+#define MAX_REV 5
+static svn_error_t *
+shared_dag_cache(const svn_test_opts_t *opts,
+                 apr_pool_t *pool)
+{
+  svn_fs_t *fs1, *fs2;
+  svn_fs_root_t *root;
+  svn_stringbuf_t *contents;
+  svn_node_kind_t kind;
+  apr_hash_t *fs_config = apr_hash_make(pool);
+  svn_revnum_t rev;
+  apr_pool_t *iterpool = svn_pool_create(pool);
+
+  SVN_ERR(create_packed_filesystem(REPO_NAME, opts, MAX_REV, SHARD_SIZE,
+                                   pool));
+
+  /* Two sessions sharing their DAG lookups. */
+  svn_hash_sets(fs_config, SVN_FS_CONFIG_FSX_SHARED_DAG_CACHE, "1");
+  SVN_ERR(svn_fs_open2(&fs1, REPO_NAME, fs_config, pool, pool));
+  SVN_ERR(svn_fs_open2(&fs2, REPO_NAME, fs_config, pool, pool));
+
+  /* The first session populates the shared cache, the second one will
+     find the nodes in there.  Both must see the right contents. */
+  for (rev = 2; rev <= MAX_REV; ++rev)
+    {
+      svn_pool_clear(iterpool);
+
+      SVN_ERR(svn_fs_revision_root(&root, fs1, rev, iterpool));
+      SVN_ERR(svn_test__get_file_contents(root, "iota", &contents,
+                                          iterpool));
+      SVN_TEST_STRING_ASSERT(contents->data,
+                             get_rev_contents(rev, iterpool));
+
+      SVN_ERR(svn_fs_revision_root(&root, fs2, rev, iterpool));
+      SVN_ERR(svn_test__get_file_contents(root, "iota", &contents,
+                                          iterpool));
+      SVN_TEST_STRING_ASSERT(contents->data,
+                             get_rev_contents(rev, iterpool));
+    }
+
+  /* Lookups of nested and missing paths. */
+  SVN_ERR(svn_fs_revision_root(&root, fs1, MAX_REV, iterpool));
+  SVN_ERR(svn_fs_check_path(&kind, root, "A/D/G/rho", iterpool));
+  SVN_TEST_ASSERT(kind == svn_node_file);
+  SVN_ERR(svn_fs_check_path(&kind, root, "A/D/G/foo", iterpool));
+  SVN_TEST_ASSERT(kind == svn_node_none);
+
+  SVN_ERR(svn_fs_revision_root(&root, fs2, MAX_REV, iterpool));
+  SVN_ERR(svn_fs_check_path(&kind, root, "A/D/G/rho", iterpool));
+  SVN_TEST_ASSERT(kind == svn_node_file);
+  SVN_ERR(svn_test__get_file_contents(root, "A/D/G/rho", &contents,
+                                      iterpool));
+  SVN_TEST_STRING_ASSERT(contents->data, "This is the file 'rho'.\n");
+  SVN_ERR(svn_fs_check_path(&kind, root, "A/D/G/foo", iterpool));
+  SVN_TEST_ASSERT(kind == svn_node_none);
+
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+#undef REPO_NAME
+#undef SHARD_SIZE
+#undef MAX_REV
+/* ------------------------------------------------------------------------ */
+#define REPO_NAME "test-repo-fsx-stats-and-index"
+#define SHARD_SIZE 4
+#define MAX_REV 5
+
+/* Baton type used by collect_index_entry. */
+typedef struct collect_baton_t
+{
+  apr_array_header_t *entries;
+  apr_pool_t *pool;
+} collect_baton_t;
+
+/* Implements svn_fs_x__dump_index_func_t, appending a deep copy of ENTRY
+ * to the collect_baton_t BATON. */
+static svn_error_t *
+collect_index_entry(const svn_fs_x__p2l_entry_t *entry,
+                    void *baton,
+                    apr_pool_t *scratch_pool)
+{
+  collect_baton_t *b = baton;
+  svn_fs_x__p2l_entry_t *copy = apr_pmemdup(b->pool, entry, sizeof(*entry));
+  copy->items = apr_pmemdup(b->pool, entry->items,
+                            entry->item_count * sizeof(*entry->items));
+  APR_ARRAY_PUSH(b->entries, svn_fs_x__p2l_entry_t *) = copy;
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+stats_and_index(const svn_test_opts_t *opts,
+                apr_pool_t *pool)
+{
+  svn_fs_t *fs;
+  svn_fs_root_t *root;
+  svn_stringbuf_t *contents;
+  svn_revnum_t rev;
+  svn_fs_x__ioctl_get_stats_input_t stats_input = {0};
+  svn_fs_x__ioctl_get_stats_output_t *output1, *output4;
+  svn_fs_x__stats_t *stats1, *stats4;
+  svn_fs_x__ioctl_dump_index_input_t dump_input = {0};
+  svn_fs_x__ioctl_load_index_input_t load_input = {0};
+  collect_baton_t baton;
+  int i;
+
+  SVN_ERR(create_packed_filesystem(REPO_NAME, opts, MAX_REV, SHARD_SIZE,
+                                   pool));
+  SVN_ERR(svn_fs_open2(&fs, REPO_NAME, NULL, pool, pool));
+
+  /* Gather statistics sequentially and in parallel. */
+  stats_input.thread_count = 1;
+  SVN_ERR(svn_fs_ioctl(fs, SVN_FS_X__IOCTL_GET_STATS, &stats_input,
+                       (void **)&output1, NULL, NULL, pool, pool));
+  stats_input.thread_count = 4;
+  SVN_ERR(svn_fs_ioctl(fs, SVN_FS_X__IOCTL_GET_STATS, &stats_input,
+                       (void **)&output4, NULL, NULL, pool, pool));
+  stats1 = output1->stats;
+  stats4 = output4->stats;
+
+  /* Both runs must see the same data. */
+  SVN_TEST_ASSERT(stats1->revision_count == MAX_REV + 1);
+  SVN_TEST_ASSERT(stats4->revision_count == stats1->revision_count);
+  SVN_TEST_ASSERT(stats4->total_size == stats1->total_size);
+  SVN_TEST_ASSERT(stats4->change_count == stats1->change_count);
+  SVN_TEST_ASSERT(stats4->file_node_count == stats1->file_node_count);
+  SVN_TEST_ASSERT(stats4->dir_node_count == stats1->dir_node_count);
+  SVN_TEST_ASSERT(stats4->rep_references == stats1->rep_references);
+  SVN_TEST_ASSERT(stats4->container_rep_references
+                  == stats1->container_rep_references);
+  SVN_TEST_ASSERT(stats4->max_chain_len == stats1->max_chain_len);
+
+  /* The packed shards use containers, the rest does not. */
+  SVN_TEST_ASSERT(stats1->reps_containers.total.count > 0);
+  SVN_TEST_ASSERT(stats1->noderevs_containers.noderev_count > 0);
+  SVN_TEST_ASSERT(stats1->changes_containers.list_count > 0);
+  SVN_TEST_ASSERT(stats1->noderevs.count > 0);
+  SVN_TEST_ASSERT(stats1->container_rep_references > 0);
+  SVN_TEST_ASSERT(stats1->container_rep_references
+                  <= stats1->rep_references);
+
+  /* Round-trip the index of the first pack file. */
+  baton.entries = apr_array_make(pool, 16, sizeof(svn_fs_x__p2l_entry_t *));
+  baton.pool = pool;
+  dump_input.revision = 0;
+  dump_input.callback_func = collect_index_entry;
+  dump_input.callback_baton = &baton;
+  SVN_ERR(svn_fs_ioctl(fs, SVN_FS_X__IOCTL_DUMP_INDEX, &dump_input, NULL,
+                       NULL, NULL, pool, pool));
+  SVN_TEST_ASSERT(baton.entries->nelts > 0);
+
+  for (i = 0; i < baton.entries->nelts; ++i)
+    {
+      svn_fs_x__p2l_entry_t *entry
+        = APR_ARRAY_IDX(baton.entries, i, svn_fs_x__p2l_entry_t *);
+      /* Containers (types 8 and above) list all their items. */
+      if (entry->type >= 8)
+        SVN_TEST_ASSERT(entry->item_count >= 1);
+    }
+
+  load_input.revision = 0;
+  load_input.entries = baton.entries;
+  SVN_ERR(svn_fs_ioctl(fs, SVN_FS_X__IOCTL_LOAD_INDEX, &load_input, NULL,
+                       NULL, NULL, pool, pool));
+
+  /* The contents must still be accessible through the new index. */
+  SVN_ERR(svn_fs_open2(&fs, REPO_NAME, NULL, pool, pool));
+  for (rev = 2; rev < SHARD_SIZE; ++rev)
+    {
+      SVN_ERR(svn_fs_revision_root(&root, fs, rev, pool));
+      SVN_ERR(svn_test__get_file_contents(root, "iota", &contents, pool));
+      SVN_TEST_STRING_ASSERT(contents->data, get_rev_contents(rev, pool));
+    }
+
+  SVN_ERR(svn_fs_revision_root(&root, fs, 1, pool));
+  SVN_ERR(svn_test__get_file_contents(root, "A/D/G/rho", &contents, pool));
+  SVN_TEST_STRING_ASSERT(contents->data, "This is the file 'rho'.\n");
+
+  return SVN_NO_ERROR;
+}
+#undef REPO_NAME
+#undef SHARD_SIZE
+#undef MAX_REV
+/* ------------------------------------------------------------------------ */
 #define REPO_NAME "test-repo-fsx-batch-fsync"
 static svn_error_t *
 test_batch_fsync(const svn_test_opts_t *opts,
@@ -963,6 +1283,12 @@ static struct svn_test_descriptor_t test_funcs[] =
                        "test packing with shard size = 1"),
     SVN_TEST_OPTS_PASS(test_batch_fsync,
                        "test batch fsync"),
+    SVN_TEST_OPTS_PASS(pack_with_threads,
+                       "pack output does not depend on thread count"),
+    SVN_TEST_OPTS_PASS(shared_dag_cache,
+                       "process-wide DAG cache"),
+    SVN_TEST_OPTS_PASS(stats_and_index,
+                       "FSX stats and index dump / load"),
     SVN_TEST_NULL
   };
 
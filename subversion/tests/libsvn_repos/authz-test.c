@@ -511,6 +511,98 @@ reposful_reposless_stanzas_inherit(apr_pool_t *pool)
    return SVN_NO_ERROR;
 }
 
+static svn_error_t *
+test_check_access_many(apr_pool_t *pool)
+{
+  const char rules[] =
+    "[/]"                                    NL
+    "* = r"                                  NL
+    ""                                       NL
+    "[/trunk]"                               NL
+    "user1 = rw"                             NL
+    ""                                       NL
+    "[/trunk/secret]"                        NL
+    "* ="                                    NL
+    ""                                       NL
+    "[/trunk/secret/public]"                 NL
+    "user1 = r"                              NL
+    ""                                       NL
+    "[:glob:/branches/*/private]"            NL
+    "* ="                                    NL;
+
+  /* Deliberately not sorted and with shared parents at various depths. */
+  static const char *paths[] = {
+    "/trunk/secret/public/file",
+    "/trunk",
+    "/branches/b1/private/x",
+    "/trunk/secret",
+    "/trunk/src/main.c",
+    "/trunk/secret/public",
+    "/branches/b1/public/x",
+    "/trunk/secret/other",
+    "/",
+    "/trunk/src",
+    "/branches/b2/private",
+    "/trunk/secret/public/sub/file",
+    "/trunk-old/file",
+    NULL
+  };
+  static const char *users[] = { "user1", "user2", NULL };
+  static const svn_repos_authz_access_t required[] = {
+    svn_authz_read,
+    svn_authz_write,
+    svn_authz_read | svn_authz_recursive,
+  };
+
+  svn_stringbuf_t *buf = svn_stringbuf_create(rules, pool);
+  svn_stream_t *stream = svn_stream_from_stringbuf(buf, pool);
+  svn_authz_t *authz;
+  apr_array_header_t *path_list = apr_array_make(pool, 16,
+                                                 sizeof(const char *));
+  apr_array_header_t *granted;
+  int i, k, u;
+
+  SVN_ERR(svn_repos_authz_parse2(&authz, stream, NULL, NULL, NULL,
+                                 pool, pool));
+
+  for (i = 0; paths[i]; ++i)
+    APR_ARRAY_PUSH(path_list, const char *) = paths[i];
+
+  /* The bulk check must give the same results as the individual ones. */
+  for (u = 0; u < 3; ++u)
+    for (k = 0; k < sizeof(required) / sizeof(required[0]); ++k)
+      {
+        SVN_ERR(svn_repos_authz_check_access_many(&granted, authz, "repo",
+                                                  path_list, users[u],
+                                                  required[k], pool, pool));
+        SVN_TEST_INT_ASSERT(granted->nelts, path_list->nelts);
+
+        for (i = 0; i < path_list->nelts; ++i)
+          {
+            svn_boolean_t expected;
+
+            SVN_ERR(svn_repos_authz_check_access(authz, "repo", paths[i],
+                                                 users[u], required[k],
+                                                 &expected, pool));
+            SVN_TEST_ASSERT(APR_ARRAY_IDX(granted, i, svn_boolean_t)
+                            == expected);
+          }
+      }
+
+  /* Spot-check a few results. */
+  SVN_ERR(svn_repos_authz_check_access_many(&granted, authz, "repo",
+                                            path_list, "user1",
+                                            svn_authz_read, pool, pool));
+  SVN_TEST_ASSERT(APR_ARRAY_IDX(granted, 0, svn_boolean_t));
+  SVN_TEST_ASSERT(!APR_ARRAY_IDX(granted, 2, svn_boolean_t));
+  SVN_TEST_ASSERT(!APR_ARRAY_IDX(granted, 3, svn_boolean_t));
+  SVN_TEST_ASSERT(APR_ARRAY_IDX(granted, 6, svn_boolean_t));
+  SVN_TEST_ASSERT(!APR_ARRAY_IDX(granted, 7, svn_boolean_t));
+  SVN_TEST_ASSERT(APR_ARRAY_IDX(granted, 11, svn_boolean_t));
+
+  return SVN_NO_ERROR;
+}
+
 static int max_threads = 4;
 
 static struct svn_test_descriptor_t test_funcs[] =
@@ -524,6 +616,8 @@ static struct svn_test_descriptor_t test_funcs[] =
                    "issue 4741 groups"),
     SVN_TEST_PASS2(reposful_reposless_stanzas_inherit,
                     "[foo:/] inherits [/]"),
+    SVN_TEST_PASS2(test_check_access_many,
+                   "test svn_repos_authz_check_access_many"),
     SVN_TEST_NULL
   };
 
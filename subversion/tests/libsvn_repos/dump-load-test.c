@@ -28,6 +28,7 @@
 #include "svn_error.h"
 #include "svn_fs.h"
 #include "svn_repos.h"
+#include "private/svn_fs_private.h"
 #include "private/svn_repos_private.h"
 
 #include "../svn_test.h"
@@ -76,8 +77,8 @@ test_dump_bad_props(svn_stringbuf_t **dump_data_p,
   SVN_TEST_ASSERT(SVN_IS_VALID_REVNUM(youngest_rev));
 
   /* Test that a dump completes without error. */
-  SVN_ERR(svn_repos_dump_fs4(repos, stream, start_rev, end_rev,
-                             FALSE, FALSE, TRUE, TRUE,
+  SVN_ERR(svn_repos_dump_fs5(repos, stream, start_rev, end_rev,
+                             FALSE, FALSE, TRUE, TRUE, 1,
                              notify_func, notify_baton,
                              NULL, NULL, NULL, NULL,
                              pool));
@@ -120,7 +121,7 @@ test_load_bad_props(svn_stringbuf_t *dump_data,
   svn_revnum_t youngest_rev;
   svn_string_t *loaded_prop_val;
 
-  SVN_ERR(svn_repos_load_fs6(repos, stream,
+  SVN_ERR(svn_repos_load_fs7(repos, stream,
                              SVN_INVALID_REVNUM, SVN_INVALID_REVNUM,
                              svn_repos_load_uuid_default,
                              parent_fspath,
@@ -128,6 +129,7 @@ test_load_bad_props(svn_stringbuf_t *dump_data,
                              validate_props,
                              FALSE /*ignore_dates*/,
                              FALSE /*normalize_props*/,
+                             1 /*thread_count*/, FALSE /*bulk*/,
                              notify_func, notify_baton,
                              NULL, NULL, /*cancellation*/
                              pool));
@@ -273,6 +275,460 @@ test_load_r0_mergeinfo(const svn_test_opts_t *opts,
   return SVN_NO_ERROR;
 }
 
+/* Notification receiver for test_dump_parallel().  Append the dumped
+   revisions to the svn_stringbuf_t BATON. */
+static void
+dump_parallel_notifier(void *baton,
+                       const svn_repos_notify_t *notify,
+                       apr_pool_t *scratch_pool)
+{
+  svn_stringbuf_t *revisions = baton;
+
+  if (notify->action == svn_repos_notify_dump_rev_end)
+    svn_stringbuf_appendcstr(revisions,
+                             apr_psprintf(scratch_pool, "%ld ",
+                                          notify->revision));
+}
+
+/* Dump revisions START_REV to END_REV of REPOS using THREAD_COUNT threads
+   and compare the result with a sequential dump.  INCREMENTAL and
+   USE_DELTAS are passed through to svn_repos_dump_fs5. */
+static svn_error_t *
+compare_parallel_dump(svn_repos_t *repos,
+                      svn_revnum_t start_rev,
+                      svn_revnum_t end_rev,
+                      svn_boolean_t incremental,
+                      svn_boolean_t use_deltas,
+                      int thread_count,
+                      apr_pool_t *pool)
+{
+  svn_stringbuf_t *expected = svn_stringbuf_create_empty(pool);
+  svn_stringbuf_t *actual = svn_stringbuf_create_empty(pool);
+  svn_stringbuf_t *expected_revs = svn_stringbuf_create_empty(pool);
+  svn_stringbuf_t *actual_revs = svn_stringbuf_create_empty(pool);
+
+  SVN_ERR(svn_repos_dump_fs5(repos, svn_stream_from_stringbuf(expected, pool),
+                             start_rev, end_rev, incremental, use_deltas,
+                             TRUE, TRUE, 1,
+                             dump_parallel_notifier, expected_revs,
+                             NULL, NULL, NULL, NULL, pool));
+  SVN_ERR(svn_repos_dump_fs5(repos, svn_stream_from_stringbuf(actual, pool),
+                             start_rev, end_rev, incremental, use_deltas,
+                             TRUE, TRUE, thread_count,
+                             dump_parallel_notifier, actual_revs,
+                             NULL, NULL, NULL, NULL, pool));
+
+  SVN_TEST_ASSERT(svn_stringbuf_compare(expected, actual));
+  SVN_TEST_STRING_ASSERT(actual_revs->data, expected_revs->data);
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+test_dump_parallel(const svn_test_opts_t *opts,
+                   apr_pool_t *pool)
+{
+  svn_repos_t *repos;
+  svn_fs_t *fs;
+  svn_fs_txn_t *txn;
+  svn_fs_root_t *txn_root;
+  svn_revnum_t youngest_rev = 0;
+  apr_pool_t *iterpool = svn_pool_create(pool);
+  int i;
+
+  SVN_ERR(svn_test__create_repos(&repos, "test-repo-dump-parallel",
+                                 opts, pool));
+  fs = svn_repos_fs(repos);
+
+  /* r1: Greek tree.  r2 .. r40: Modify some files. */
+  SVN_ERR(svn_fs_begin_txn2(&txn, fs, youngest_rev, 0, pool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, pool));
+  SVN_ERR(svn_test__create_greek_tree(txn_root, pool));
+  SVN_ERR(svn_repos_fs_commit_txn(NULL, repos, &youngest_rev, txn, pool));
+
+  for (i = 2; i <= 40; ++i)
+    {
+      svn_pool_clear(iterpool);
+
+      SVN_ERR(svn_fs_begin_txn2(&txn, fs, youngest_rev, 0, iterpool));
+      SVN_ERR(svn_fs_txn_root(&txn_root, txn, iterpool));
+      SVN_ERR(svn_test__set_file_contents(txn_root,
+                                          i % 3 ? "A/mu" : "A/D/G/rho",
+                                          apr_psprintf(iterpool,
+                                                       "revision %d\n", i),
+                                          iterpool));
+      if (i % 7 == 0)
+        {
+          svn_fs_root_t *rev_root;
+
+          SVN_ERR(svn_fs_revision_root(&rev_root, fs, youngest_rev,
+                                       iterpool));
+          SVN_ERR(svn_fs_copy(rev_root, "A/B",
+                              txn_root, apr_psprintf(iterpool, "B%d", i),
+                              iterpool));
+        }
+      SVN_ERR(svn_repos_fs_commit_txn(NULL, repos, &youngest_rev, txn,
+                                      iterpool));
+    }
+
+  svn_pool_destroy(iterpool);
+
+  /* Full dumps as well as partial and incremental ones must be identical
+     to what a sequential dump produces. */
+  SVN_ERR(compare_parallel_dump(repos, SVN_INVALID_REVNUM,
+                                SVN_INVALID_REVNUM, FALSE, FALSE, 4, pool));
+  SVN_ERR(compare_parallel_dump(repos, SVN_INVALID_REVNUM,
+                                SVN_INVALID_REVNUM, FALSE, TRUE, 3, pool));
+  SVN_ERR(compare_parallel_dump(repos, 10, 30, FALSE, TRUE, 4, pool));
+  SVN_ERR(compare_parallel_dump(repos, 10, 30, TRUE, TRUE, 2, pool));
+  SVN_ERR(compare_parallel_dump(repos, 40, 40, FALSE, FALSE, 4, pool));
+
+  return SVN_NO_ERROR;
+}
+
+/* Load DUMP_DATA into a new repository named NAME using THREAD_COUNT
+   threads and BULK mode, dump it again without deltas and return that
+   dump in *RESULT. */
+static svn_error_t *
+load_and_dump(svn_stringbuf_t **result,
+              svn_stringbuf_t *dump_data,
+              const char *name,
+              int thread_count,
+              svn_boolean_t bulk,
+              const svn_test_opts_t *opts,
+              apr_pool_t *pool)
+{
+  svn_repos_t *repos;
+
+  SVN_ERR(svn_test__create_repos(&repos, name, opts, pool));
+  SVN_ERR(svn_repos_load_fs7(repos, svn_stream_from_stringbuf(dump_data, pool),
+                             SVN_INVALID_REVNUM, SVN_INVALID_REVNUM,
+                             svn_repos_load_uuid_force, NULL,
+                             FALSE, FALSE, TRUE, FALSE, FALSE,
+                             thread_count, bulk,
+                             NULL, NULL, NULL, NULL, pool));
+
+  *result = svn_stringbuf_create_empty(pool);
+  SVN_ERR(svn_repos_dump_fs5(repos, svn_stream_from_stringbuf(*result, pool),
+                             SVN_INVALID_REVNUM, SVN_INVALID_REVNUM,
+                             FALSE, FALSE, TRUE, TRUE, 1,
+                             NULL, NULL, NULL, NULL, NULL, NULL, pool));
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+test_load_parallel(const svn_test_opts_t *opts,
+                   apr_pool_t *pool)
+{
+  svn_repos_t *repos;
+  svn_fs_t *fs;
+  svn_fs_txn_t *txn;
+  svn_fs_root_t *txn_root;
+  svn_fs_root_t *rev_root;
+  svn_revnum_t youngest_rev = 0;
+  svn_stringbuf_t *dump_data;
+  svn_stringbuf_t *fulltext_dump;
+  svn_stringbuf_t *loaded;
+  svn_stream_t *stream;
+  apr_pool_t *iterpool = svn_pool_create(pool);
+  static const char binary[] = "binary\0with\0nul\r\n";
+  apr_size_t len = sizeof(binary);
+  int i;
+
+  SVN_ERR(svn_test__create_repos(&repos, "test-repo-load-parallel",
+                                 opts, pool));
+  fs = svn_repos_fs(repos);
+
+  /* r1: Greek tree.  r2 .. r30: Modify, replace and delete files,
+     repeating some of the contents. */
+  SVN_ERR(svn_fs_begin_txn2(&txn, fs, youngest_rev, 0, pool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, pool));
+  SVN_ERR(svn_test__create_greek_tree(txn_root, pool));
+  SVN_ERR(svn_repos_fs_commit_txn(NULL, repos, &youngest_rev, txn, pool));
+
+  for (i = 2; i <= 30; ++i)
+    {
+      svn_pool_clear(iterpool);
+
+      SVN_ERR(svn_fs_begin_txn2(&txn, fs, youngest_rev, 0, iterpool));
+      SVN_ERR(svn_fs_txn_root(&txn_root, txn, iterpool));
+      SVN_ERR(svn_fs_revision_root(&rev_root, fs, youngest_rev, iterpool));
+
+      SVN_ERR(svn_test__set_file_contents(txn_root, "A/mu",
+                                          apr_psprintf(iterpool,
+                                                       "revision %d\n",
+                                                       i % 5),
+                                          iterpool));
+      SVN_ERR(svn_test__set_file_contents(txn_root, "A/D/G/rho",
+                                          apr_psprintf(iterpool,
+                                                       "rho %d\n", i),
+                                          iterpool));
+      if (i % 4 == 0)
+        {
+          SVN_ERR(svn_fs_delete(txn_root, "iota", iterpool));
+          SVN_ERR(svn_fs_copy(rev_root, "A/mu", txn_root, "iota",
+                              iterpool));
+        }
+      if (i % 6 == 0)
+        {
+          SVN_ERR(svn_fs_apply_text(&stream, txn_root, "A/B/lambda", NULL,
+                                    iterpool));
+          SVN_ERR(svn_stream_write(stream, binary, &len));
+          SVN_ERR(svn_stream_close(stream));
+        }
+      if (i == 20)
+        SVN_ERR(svn_fs_delete(txn_root, "A/D/H", iterpool));
+
+      SVN_ERR(svn_repos_fs_commit_txn(NULL, repos, &youngest_rev, txn,
+                                      iterpool));
+    }
+
+  svn_pool_destroy(iterpool);
+
+  dump_data = svn_stringbuf_create_empty(pool);
+  SVN_ERR(svn_repos_dump_fs5(repos, svn_stream_from_stringbuf(dump_data,
+                                                              pool),
+                             SVN_INVALID_REVNUM, SVN_INVALID_REVNUM,
+                             FALSE, TRUE, TRUE, TRUE, 1,
+                             NULL, NULL, NULL, NULL, NULL, NULL, pool));
+  fulltext_dump = svn_stringbuf_create_empty(pool);
+  SVN_ERR(svn_repos_dump_fs5(repos, svn_stream_from_stringbuf(fulltext_dump,
+                                                              pool),
+                             SVN_INVALID_REVNUM, SVN_INVALID_REVNUM,
+                             FALSE, FALSE, TRUE, TRUE, 1,
+                             NULL, NULL, NULL, NULL, NULL, NULL, pool));
+
+  /* Whatever the options, the loaded repository must have the same
+     contents as the original one. */
+  SVN_ERR(load_and_dump(&loaded, dump_data, "test-repo-load-parallel-1",
+                        1, FALSE, opts, pool));
+  SVN_TEST_ASSERT(svn_stringbuf_compare(fulltext_dump, loaded));
+
+  SVN_ERR(load_and_dump(&loaded, dump_data, "test-repo-load-parallel-2",
+                        4, FALSE, opts, pool));
+  SVN_TEST_ASSERT(svn_stringbuf_compare(fulltext_dump, loaded));
+
+  SVN_ERR(load_and_dump(&loaded, dump_data, "test-repo-load-parallel-3",
+                        4, TRUE, opts, pool));
+  SVN_TEST_ASSERT(svn_stringbuf_compare(fulltext_dump, loaded));
+
+  SVN_ERR(load_and_dump(&loaded, fulltext_dump, "test-repo-load-parallel-4",
+                        2, TRUE, opts, pool));
+  SVN_TEST_ASSERT(svn_stringbuf_compare(fulltext_dump, loaded));
+
+  return SVN_NO_ERROR;
+}
+
+/* Return TRUE if DATA contains NEEDLE as a contiguous byte sequence. */
+static svn_boolean_t
+contains_bytes(const svn_stringbuf_t *data,
+               const svn_stringbuf_t *needle)
+{
+  apr_size_t i;
+
+  if (needle->len > data->len)
+    return FALSE;
+
+  for (i = 0; i + needle->len <= data->len; ++i)
+    if (memcmp(data->data + i, needle->data, needle->len) == 0)
+      return TRUE;
+
+  return FALSE;
+}
+
+/* Return in *CONTENTS the svndiff data that FS stores for turning
+   SOURCE_REV:PATH into TARGET_REV:PATH, or NULL if the dump code could
+   not pass it through.  SOURCE_REV may be SVN_INVALID_REVNUM for a delta
+   against the empty file. */
+static svn_error_t *
+get_stored_delta(svn_stringbuf_t **contents,
+                 svn_fs_t *fs,
+                 svn_revnum_t source_rev,
+                 svn_revnum_t target_rev,
+                 const char *path,
+                 apr_pool_t *pool)
+{
+  svn_fs_root_t *source_root = NULL;
+  svn_fs_root_t *target_root;
+  svn_stream_t *stream;
+  svn_filesize_t len;
+
+  if (SVN_IS_VALID_REVNUM(source_rev))
+    SVN_ERR(svn_fs_revision_root(&source_root, fs, source_rev, pool));
+  SVN_ERR(svn_fs_revision_root(&target_root, fs, target_rev, pool));
+
+  /* Same limit as MAX_PASS_THROUGH_SVNDIFF_VERSION in dump.c. */
+  SVN_ERR(svn_fs__try_get_stored_delta(&stream, &len, source_root, path,
+                                       target_root, path, 1, pool, pool));
+  if (stream)
+    {
+      SVN_ERR(svn_stringbuf_from_stream(contents, stream, (apr_size_t)len,
+                                        pool));
+      SVN_TEST_ASSERT((*contents)->len == (apr_size_t)len);
+    }
+  else
+    {
+      *contents = NULL;
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Load DUMP_DATA into a new repository named NAME and verify that
+   revision I of it has the same A/mu as revision I + REV_OFFSET of
+   SOURCE_FS, for all revisions from FIRST_REV to LAST_REV of SOURCE_FS. */
+static svn_error_t *
+load_and_compare_mu(svn_stringbuf_t *dump_data,
+                    const char *name,
+                    svn_fs_t *source_fs,
+                    svn_revnum_t first_rev,
+                    svn_revnum_t last_rev,
+                    svn_revnum_t rev_offset,
+                    const svn_test_opts_t *opts,
+                    apr_pool_t *pool)
+{
+  svn_repos_t *repos;
+  svn_fs_t *fs;
+  svn_revnum_t youngest_rev;
+  svn_revnum_t rev;
+  apr_pool_t *iterpool = svn_pool_create(pool);
+
+  SVN_ERR(svn_test__create_repos(&repos, name, opts, pool));
+  SVN_ERR(svn_repos_load_fs7(repos, svn_stream_from_stringbuf(dump_data, pool),
+                             SVN_INVALID_REVNUM, SVN_INVALID_REVNUM,
+                             svn_repos_load_uuid_force, NULL,
+                             FALSE, FALSE, TRUE, FALSE, FALSE, 1, FALSE,
+                             NULL, NULL, NULL, NULL, pool));
+  fs = svn_repos_fs(repos);
+  SVN_ERR(svn_fs_youngest_rev(&youngest_rev, fs, pool));
+  SVN_TEST_ASSERT(youngest_rev == last_rev - rev_offset);
+
+  for (rev = first_rev; rev <= last_rev; ++rev)
+    {
+      svn_fs_root_t *root;
+      svn_stringbuf_t *expected;
+      svn_stringbuf_t *actual;
+
+      svn_pool_clear(iterpool);
+
+      SVN_ERR(svn_fs_revision_root(&root, source_fs, rev, iterpool));
+      SVN_ERR(svn_test__get_file_contents(root, "A/mu", &expected, iterpool));
+      SVN_ERR(svn_fs_revision_root(&root, fs, rev - rev_offset, iterpool));
+      SVN_ERR(svn_test__get_file_contents(root, "A/mu", &actual, iterpool));
+
+      SVN_TEST_ASSERT(svn_stringbuf_compare(expected, actual));
+    }
+
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+test_dump_stored_deltas(const svn_test_opts_t *opts,
+                        apr_pool_t *pool)
+{
+  svn_test_opts_t fsfs_opts = *opts;
+  svn_repos_t *repos;
+  svn_fs_t *fs;
+  svn_fs_txn_t *txn;
+  svn_fs_root_t *txn_root;
+  svn_revnum_t youngest_rev = 0;
+  svn_stringbuf_t *contents;
+  svn_stringbuf_t *dump_data;
+  svn_stringbuf_t *delta;
+  apr_pool_t *iterpool = svn_pool_create(pool);
+  int passed_through = 0;
+  int i;
+
+  if (strcmp(opts->fs_type, "fsfs") != 0)
+    return svn_error_create(SVN_ERR_TEST_SKIPPED, NULL,
+                            "this will test FSFS repositories only");
+
+  /* Stored deltas can only be passed through as long as they use
+     svndiff1 or older, i.e. zlib instead of the LZ4 default of newer
+     formats. */
+  if (!fsfs_opts.server_minor_version || fsfs_opts.server_minor_version > 9)
+    fsfs_opts.server_minor_version = 9;
+
+  SVN_ERR(svn_test__create_repos(&repos, "test-repo-dump-stored-deltas",
+                                 &fsfs_opts, pool));
+  fs = svn_repos_fs(repos);
+
+  /* r1: Greek tree.  r2 .. r10: Grow A/mu by one line each, keeping the
+     delta chain short enough to be linear. */
+  SVN_ERR(svn_fs_begin_txn2(&txn, fs, youngest_rev, 0, pool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, pool));
+  SVN_ERR(svn_test__create_greek_tree(txn_root, pool));
+  SVN_ERR(svn_repos_fs_commit_txn(NULL, repos, &youngest_rev, txn, pool));
+
+  contents = svn_stringbuf_create("This is the file 'mu'.\n", pool);
+  for (i = 2; i <= 10; ++i)
+    {
+      svn_pool_clear(iterpool);
+
+      svn_stringbuf_appendcstr(contents,
+                               apr_psprintf(pool,
+                                            "Line %d of a file that is "
+                                            "long enough to be deltified "
+                                            "against its predecessor.\n",
+                                            i));
+
+      SVN_ERR(svn_fs_begin_txn2(&txn, fs, youngest_rev, 0, iterpool));
+      SVN_ERR(svn_fs_txn_root(&txn_root, txn, iterpool));
+      SVN_ERR(svn_test__set_file_contents(txn_root, "A/mu", contents->data,
+                                          iterpool));
+      SVN_ERR(svn_repos_fs_commit_txn(NULL, repos, &youngest_rev, txn,
+                                      iterpool));
+    }
+
+  /* Full dump with deltas: every stored delta against the previous
+     revision must appear verbatim in the dump. */
+  dump_data = svn_stringbuf_create_empty(pool);
+  SVN_ERR(svn_repos_dump_fs5(repos, svn_stream_from_stringbuf(dump_data,
+                                                              pool),
+                             SVN_INVALID_REVNUM, SVN_INVALID_REVNUM,
+                             FALSE, TRUE, TRUE, TRUE, 1,
+                             NULL, NULL, NULL, NULL, NULL, NULL, pool));
+
+  for (i = 2; i <= 10; ++i)
+    {
+      svn_pool_clear(iterpool);
+
+      SVN_ERR(get_stored_delta(&delta, fs, i - 1, i, "A/mu", iterpool));
+      if (delta)
+        {
+          SVN_TEST_ASSERT(contains_bytes(dump_data, delta));
+          ++passed_through;
+        }
+    }
+  SVN_TEST_ASSERT(passed_through > 0);
+
+  SVN_ERR(load_and_compare_mu(dump_data, "test-repo-dump-stored-deltas-1",
+                              fs, 1, 10, 0, opts, pool));
+
+  /* A partial dump starting at r5 must delta r5 against the empty file,
+     which does not match the stored base.  The dump code has to compute
+     that delta itself and the result must still load correctly. */
+  SVN_ERR(get_stored_delta(&delta, fs, SVN_INVALID_REVNUM, 5, "A/mu",
+                           iterpool));
+  SVN_TEST_ASSERT(delta == NULL);
+
+  dump_data = svn_stringbuf_create_empty(pool);
+  SVN_ERR(svn_repos_dump_fs5(repos, svn_stream_from_stringbuf(dump_data,
+                                                              pool),
+                             5, 10, FALSE, TRUE, TRUE, TRUE, 1,
+                             NULL, NULL, NULL, NULL, NULL, NULL, pool));
+
+  SVN_ERR(load_and_compare_mu(dump_data, "test-repo-dump-stored-deltas-2",
+                              fs, 5, 10, 4, opts, pool));
+
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
 /* The test table.  */
 
 static int max_threads = 4;
@@ -284,6 +740,12 @@ static struct svn_test_descriptor_t test_funcs[] =
                        "test dumping with r0 mergeinfo"),
     SVN_TEST_OPTS_PASS(test_load_r0_mergeinfo,
                        "test loading with r0 mergeinfo"),
+    SVN_TEST_OPTS_PASS(test_dump_parallel,
+                       "test dumping with multiple threads"),
+    SVN_TEST_OPTS_PASS(test_load_parallel,
+                       "test loading with multiple threads"),
+    SVN_TEST_OPTS_PASS(test_dump_stored_deltas,
+                       "test dumping and loading stored deltas"),
     SVN_TEST_NULL
   };
 
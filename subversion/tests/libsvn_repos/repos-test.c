@@ -40,6 +40,7 @@
 #include "svn_sorts.h"
 #include "svn_version.h"
 #include "private/svn_repos_private.h"
+#include "private/svn_sorts_private.h"
 #include "private/svn_dep_compat.h"
 
 /* be able to look into svn_config_t */
@@ -48,6 +49,7 @@
 #include "../svn_test_fs.h"
 
 #include "dir-delta-editor.h"
+#include "test-hook-module.h"
 
 /* Used to terminate lines in large multi-line string literals. */
 #define NL APR_EOL_STR
@@ -3514,6 +3516,186 @@ get_logs(const svn_test_opts_t *opts,
   return SVN_NO_ERROR;
 }
 
+/* Baton for the log_authz_* receivers. */
+typedef struct log_authz_baton_t
+{
+  /* Changed paths of the current revision, as formatted strings. */
+  apr_array_header_t *changes;
+
+  /* The log output so far. */
+  svn_stringbuf_t *output;
+} log_authz_baton_t;
+
+/* Implements svn_repos_path_change_receiver_t. */
+static svn_error_t *
+log_authz_path_receiver(void *baton,
+                        svn_repos_path_change_t *change,
+                        apr_pool_t *scratch_pool)
+{
+  log_authz_baton_t *lb = baton;
+  apr_pool_t *pool = lb->changes->pool;
+
+  APR_ARRAY_PUSH(lb->changes, const char *)
+    = apr_psprintf(pool, "  %d %s %s\n", change->change_kind,
+                   change->path.data,
+                   change->copyfrom_path ? change->copyfrom_path : "-");
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_repos_log_entry_receiver_t.  Append the revision and
+   its changed paths in sorted order to the output. */
+static svn_error_t *
+log_authz_revision_receiver(void *baton,
+                            svn_repos_log_entry_t *log_entry,
+                            apr_pool_t *scratch_pool)
+{
+  log_authz_baton_t *lb = baton;
+  int i;
+
+  svn_stringbuf_appendcstr(lb->output,
+                           apr_psprintf(scratch_pool, "r%ld %u\n",
+                                        log_entry->revision,
+                                        log_entry->revprops
+                                          ? apr_hash_count(log_entry->revprops)
+                                          : 0));
+
+  svn_sort__array(lb->changes, svn_sort_compare_paths);
+  for (i = 0; i < lb->changes->nelts; ++i)
+    svn_stringbuf_appendcstr(lb->output,
+                             APR_ARRAY_IDX(lb->changes, i, const char *));
+  apr_array_clear(lb->changes);
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_repos_authz_func_t by checking read access of user
+   "plato" in the svn_authz_t BATON one path at a time. */
+static svn_error_t *
+log_authz_read_func(svn_boolean_t *allowed,
+                    svn_fs_root_t *root,
+                    const char *path,
+                    void *baton,
+                    apr_pool_t *pool)
+{
+  return svn_error_trace(svn_repos_authz_check_access(baton, NULL, path,
+                                                      "plato",
+                                                      svn_authz_read,
+                                                      allowed, pool));
+}
+
+/* Run a log over all revisions of REPOS with AUTHZ_READ_FUNC and
+   AUTHZ_READ_BATON and return its formatted output in *OUTPUT. */
+static svn_error_t *
+get_authz_log(svn_stringbuf_t **output,
+              svn_repos_t *repos,
+              svn_repos_authz_func_t authz_read_func,
+              void *authz_read_baton,
+              apr_pool_t *pool)
+{
+  log_authz_baton_t lb;
+  svn_revnum_t youngest_rev;
+
+  lb.changes = apr_array_make(pool, 16, sizeof(const char *));
+  lb.output = svn_stringbuf_create_empty(pool);
+
+  SVN_ERR(svn_fs_youngest_rev(&youngest_rev, svn_repos_fs(repos), pool));
+  SVN_ERR(svn_repos_get_logs5(repos, NULL, 1, youngest_rev, 0, FALSE, FALSE,
+                              NULL, authz_read_func, authz_read_baton,
+                              log_authz_path_receiver, &lb,
+                              log_authz_revision_receiver, &lb, pool));
+
+  *output = lb.output;
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+get_logs_authz_many(const svn_test_opts_t *opts,
+                    apr_pool_t *pool)
+{
+  svn_repos_t *repos;
+  svn_fs_t *fs;
+  svn_fs_txn_t *txn;
+  svn_fs_root_t *txn_root;
+  svn_fs_root_t *rev_root;
+  svn_revnum_t youngest_rev = 0;
+  svn_authz_t *authz;
+  svn_repos__authz_read_baton_t read_baton;
+  svn_stringbuf_t *expected;
+  svn_stringbuf_t *actual;
+  int i;
+  const char *contents =
+    "[/]"                                                                    NL
+    "* = r"                                                                  NL
+    ""                                                                       NL
+    "[/A/B]"                                                                 NL
+    "* ="                                                                    NL;
+
+  SVN_ERR(svn_test__create_repos(&repos, "test-repo-get-logs-authz-many",
+                                 opts, pool));
+  fs = svn_repos_fs(repos);
+
+  /* r1: Greek tree. */
+  SVN_ERR(svn_fs_begin_txn2(&txn, fs, youngest_rev, 0, pool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, pool));
+  SVN_ERR(svn_test__create_greek_tree(txn_root, pool));
+  SVN_ERR(svn_repos_fs_commit_txn(NULL, repos, &youngest_rev, txn, pool));
+
+  /* r2: Readable and unreadable changes, plus a copy from an unreadable
+     source. */
+  SVN_ERR(svn_fs_begin_txn2(&txn, fs, youngest_rev, 0, pool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, pool));
+  SVN_ERR(svn_fs_revision_root(&rev_root, fs, youngest_rev, pool));
+  SVN_ERR(svn_test__set_file_contents(txn_root, "A/mu", "r2\n", pool));
+  SVN_ERR(svn_test__set_file_contents(txn_root, "A/B/lambda", "r2\n", pool));
+  SVN_ERR(svn_fs_copy(rev_root, "A/B/E", txn_root, "A/D/E2", pool));
+  SVN_ERR(svn_repos_fs_commit_txn(NULL, repos, &youngest_rev, txn, pool));
+
+  /* r3: Unreadable changes only. */
+  SVN_ERR(svn_fs_begin_txn2(&txn, fs, youngest_rev, 0, pool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, pool));
+  SVN_ERR(svn_test__set_file_contents(txn_root, "A/B/lambda", "r3\n", pool));
+  SVN_ERR(svn_repos_fs_commit_txn(NULL, repos, &youngest_rev, txn, pool));
+
+  /* r4: More changes than get checked in a single batch. */
+  SVN_ERR(svn_fs_begin_txn2(&txn, fs, youngest_rev, 0, pool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, pool));
+  for (i = 0; i < 3000; ++i)
+    {
+      const char *path = apr_psprintf(pool, "A/%s/f%d",
+                                      i % 2 ? "B" : "D", i);
+
+      SVN_ERR(svn_fs_make_file(txn_root, path, pool));
+      SVN_ERR(svn_test__set_file_contents(txn_root, path, "new\n", pool));
+    }
+  SVN_ERR(svn_repos_fs_commit_txn(NULL, repos, &youngest_rev, txn, pool));
+
+  SVN_ERR(authz_get_handle(&authz, contents, FALSE, pool));
+  read_baton.authz = authz;
+  read_baton.repos_name = NULL;
+  read_baton.user = "plato";
+
+  /* Checking the changed paths in bulk must give the same log as checking
+     them one by one. */
+  SVN_ERR(get_authz_log(&expected, repos, log_authz_read_func, authz,
+                        pool));
+  SVN_ERR(get_authz_log(&actual, repos, svn_repos__authz_read_func,
+                        &read_baton, pool));
+  SVN_TEST_STRING_ASSERT(actual->data, expected->data);
+
+  /* Nothing in /A/B is visible, neither as path nor as copy source. */
+  SVN_TEST_ASSERT(strstr(actual->data, " /A/mu -\n"));
+  SVN_TEST_ASSERT(strstr(actual->data, " /A/D/E2 -\n"));
+  SVN_TEST_ASSERT(strstr(actual->data, " /A/D/f2998 -\n"));
+  SVN_TEST_ASSERT(!strstr(actual->data, "/A/B/"));
+
+  /* r3 is not readable at all, so its revprops must be hidden. */
+  SVN_TEST_ASSERT(strstr(actual->data, "r3 0\nr4 "));
+
+  return SVN_NO_ERROR;
+}
+
+
 
 /* Tests for svn_repos_get_file_revsN() */
 
@@ -4460,14 +4642,1033 @@ test_list(const svn_test_opts_t *opts,
   patterns = apr_array_make(pool, 1, sizeof(const char *));
   APR_ARRAY_PUSH(patterns, const char *) = "*a*";
   SVN_ERR(svn_fs_revision_root(&rev_root, fs, youngest_rev, pool));
-  SVN_ERR(svn_repos_list(rev_root, "/A", patterns, svn_depth_infinity, FALSE,
-                         NULL, NULL, list_callback, &counter, NULL, NULL,
-                         pool));
+  SVN_ERR(svn_repos_list2(rev_root, "/A", patterns, svn_depth_infinity,
+                          SVN_DIRENT_ALL, 1, NULL, NULL, list_callback,
+                          &counter, NULL, NULL, pool));
   SVN_TEST_ASSERT(counter == 7);
 
   return SVN_NO_ERROR;
 }
 
+/* Implements svn_repos_dirent_receiver_t.  Append PATH to the
+   svn_stringbuf_t BATON and check that only the size has been filled
+   in. */
+static svn_error_t *
+list_size_callback(const char *path,
+                   svn_dirent_t *dirent,
+                   void *baton,
+                   apr_pool_t *pool)
+{
+  svn_stringbuf_t *paths = baton;
+
+  if (dirent->kind == svn_node_file)
+    SVN_TEST_ASSERT(dirent->size > 0);
+  else
+    SVN_TEST_ASSERT(dirent->size == SVN_INVALID_FILESIZE);
+  SVN_TEST_ASSERT(dirent->last_author == NULL);
+
+  svn_stringbuf_appendcstr(paths, path);
+  svn_stringbuf_appendbyte(paths, '|');
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+test_list_concurrently(const svn_test_opts_t *opts,
+                       apr_pool_t *pool)
+{
+  svn_repos_t *repos;
+  svn_fs_t *fs;
+  svn_fs_txn_t *txn;
+  svn_fs_root_t *txn_root, *rev_root;
+  svn_revnum_t youngest_rev;
+  svn_stringbuf_t *sequential = svn_stringbuf_create_empty(pool);
+  svn_stringbuf_t *concurrent = svn_stringbuf_create_empty(pool);
+  struct authz_read_baton_t arb;
+  apr_array_header_t *patterns;
+
+  SVN_ERR(svn_test__create_repos(&repos, "test-repo-list-concurrently",
+                                 opts, pool));
+  fs = svn_repos_fs(repos);
+
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, 0, pool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, pool));
+  SVN_ERR(svn_test__create_greek_tree(txn_root, pool));
+  SVN_ERR(svn_repos_fs_commit_txn(NULL, repos, &youngest_rev, txn, pool));
+  SVN_ERR(svn_fs_revision_root(&rev_root, fs, youngest_rev, pool));
+
+  /* Sequential and concurrent listings must be identical, including the
+     effects of authz. */
+  arb.paths = apr_hash_make(pool);
+  arb.pool = pool;
+  arb.deny = "/A/D";
+
+  SVN_ERR(svn_repos_list2(rev_root, "/", NULL, svn_depth_infinity,
+                          SVN_DIRENT_SIZE, 1, authz_read_func, &arb,
+                          list_size_callback, sequential, NULL, NULL,
+                          pool));
+  SVN_ERR(svn_repos_list2(rev_root, "/", NULL, svn_depth_infinity,
+                          SVN_DIRENT_SIZE, 4, authz_read_func, &arb,
+                          list_size_callback, concurrent, NULL, NULL,
+                          pool));
+  SVN_TEST_STRING_ASSERT(sequential->data,
+                         "/|/A|/A/B|/A/B/E|/A/B/E/alpha|/A/B/E/beta|/A/B/F|"
+                         "/A/B/lambda|/A/C|/A/mu|/iota|");
+  SVN_TEST_STRING_ASSERT(concurrent->data, sequential->data);
+
+  /* The same with patterns and in a txn root. */
+  svn_stringbuf_setempty(sequential);
+  svn_stringbuf_setempty(concurrent);
+  patterns = apr_array_make(pool, 1, sizeof(const char *));
+  APR_ARRAY_PUSH(patterns, const char *) = "*a*";
+
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, youngest_rev, pool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, pool));
+  SVN_ERR(svn_repos_list2(txn_root, "/A", patterns, svn_depth_infinity,
+                          SVN_DIRENT_SIZE, 1, NULL, NULL,
+                          list_size_callback, sequential, NULL, NULL,
+                          pool));
+  SVN_ERR(svn_repos_list2(txn_root, "/A", patterns, svn_depth_infinity,
+                          SVN_DIRENT_SIZE, 4, NULL, NULL,
+                          list_size_callback, concurrent, NULL, NULL,
+                          pool));
+  SVN_TEST_STRING_ASSERT(sequential->data,
+                         "/A|/A/B/E/alpha|/A/B/E/beta|/A/B/lambda|"
+                         "/A/D/G/tau|/A/D/H/omega|/A/D/gamma|");
+  SVN_TEST_STRING_ASSERT(concurrent->data, sequential->data);
+
+  return svn_error_trace(svn_fs_abort_txn(txn, pool));
+}
+
+/* Baton for blame_callback. */
+typedef struct blame_baton_t
+{
+  apr_array_header_t *revs;
+  svn_stringbuf_t *text;
+} blame_baton_t;
+
+/* Implements svn_repos_blame_receiver_t.  Record REVISION and LINE in
+   the blame_baton_t BATON. */
+static svn_error_t *
+blame_callback(void *baton,
+               apr_int64_t line_no,
+               svn_revnum_t revision,
+               apr_hash_t *rev_props,
+               const svn_string_t *line,
+               apr_pool_t *scratch_pool)
+{
+  blame_baton_t *b = baton;
+
+  SVN_TEST_ASSERT(line_no == b->revs->nelts);
+  SVN_TEST_ASSERT(SVN_IS_VALID_REVNUM(revision) == (rev_props != NULL));
+  if (rev_props)
+    SVN_TEST_ASSERT(svn_hash_gets(rev_props, SVN_PROP_REVISION_DATE));
+
+  APR_ARRAY_PUSH(b->revs, svn_revnum_t) = revision;
+  svn_stringbuf_appendbytes(b->text, line->data, line->len);
+  svn_stringbuf_appendbyte(b->text, '|');
+
+  return SVN_NO_ERROR;
+}
+
+/* Run svn_repos_blame on PATH in REPOS from START to END, using
+   DIFF_OPTIONS.  Verify that the lines reported are EXPECTED_TEXT, with
+   lines separated by '|', and that they are attributed to the
+   EXPECTED_REVS, terminated by -2. */
+static svn_error_t *
+check_blame(svn_repos_t *repos,
+            const char *path,
+            svn_revnum_t start,
+            svn_revnum_t end,
+            const svn_diff_file_options_t *diff_options,
+            const char *expected_text,
+            const svn_revnum_t *expected_revs,
+            apr_pool_t *pool)
+{
+  blame_baton_t b;
+  int i;
+
+  b.revs = apr_array_make(pool, 4, sizeof(svn_revnum_t));
+  b.text = svn_stringbuf_create_empty(pool);
+
+  SVN_ERR(svn_repos_blame(repos, path, start, end, diff_options, 0,
+                          NULL, NULL, blame_callback, &b, NULL, NULL, pool));
+
+  SVN_TEST_STRING_ASSERT(b.text->data, expected_text);
+  for (i = 0; expected_revs[i] != -2; ++i)
+    {
+      SVN_TEST_ASSERT(i < b.revs->nelts);
+      SVN_TEST_ASSERT(APR_ARRAY_IDX(b.revs, i, svn_revnum_t)
+                      == expected_revs[i]);
+    }
+  SVN_TEST_ASSERT(i == b.revs->nelts);
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+test_blame(const svn_test_opts_t *opts,
+           apr_pool_t *pool)
+{
+  svn_repos_t *repos;
+  svn_fs_t *fs;
+  svn_fs_txn_t *txn;
+  svn_fs_root_t *txn_root;
+  svn_revnum_t youngest_rev = 0;
+  svn_diff_file_options_t *diff_options;
+  blame_baton_t b;
+  static const char *contents[] = {
+    "alpha\nbeta\ngamma\n",                   /* r1: initial */
+    "alpha\nBETA\ngamma\ndelta\n",           /* r2: change, append */
+    NULL,                                      /* r3: prop change */
+    "alpha\nBETA\r\ngamma  \ndelta\n",        /* r4: whitespace, eol */
+    "zero\nalpha\ngamma  \ndelta\n",           /* r5: insert, delete */
+  };
+  static const svn_revnum_t all_revs[]
+    = { 5, 1, 4, 2, -2 };
+  static const svn_revnum_t ignore_ws_revs[]
+    = { 5, 1, 1, 2, -2 };
+  static const svn_revnum_t from_r2_revs[]
+    = { 5, SVN_INVALID_REVNUM, 4, 2, -2 };
+  static const svn_revnum_t r4_revs[]
+    = { SVN_INVALID_REVNUM, 4, 4, SVN_INVALID_REVNUM, -2 };
+  int i;
+
+  SVN_ERR(svn_test__create_repos(&repos, "test-repo-blame", opts, pool));
+  fs = svn_repos_fs(repos);
+
+  for (i = 0; i < sizeof(contents) / sizeof(contents[0]); ++i)
+    {
+      SVN_ERR(svn_fs_begin_txn2(&txn, fs, youngest_rev, 0, pool));
+      SVN_ERR(svn_fs_txn_root(&txn_root, txn, pool));
+      if (i == 0)
+        SVN_ERR(svn_fs_make_file(txn_root, "iota", pool));
+      if (contents[i])
+        SVN_ERR(svn_test__set_file_contents(txn_root, "iota", contents[i],
+                                            pool));
+      else
+        SVN_ERR(svn_fs_change_node_prop(txn_root, "iota", "prop",
+                                        svn_string_create("value", pool),
+                                        pool));
+      SVN_ERR(svn_repos_fs_commit_txn(NULL, repos, &youngest_rev, txn,
+                                      pool));
+    }
+
+  SVN_ERR(check_blame(repos, "/iota", 0, youngest_rev, NULL,
+                      "zero|alpha|gamma  |delta|", all_revs, pool));
+
+  /* Line endings are being normalized in the reported lines but
+     EOL changes still count as modifications. */
+  SVN_ERR(check_blame(repos, "/iota", 4, 4, NULL,
+                      "alpha|BETA|gamma  |delta|", r4_revs, pool));
+
+  /* Ignoring whitespace attributes "gamma" to r1. */
+  diff_options = svn_diff_file_options_create(pool);
+  diff_options->ignore_space = svn_diff_file_ignore_space_all;
+  SVN_ERR(check_blame(repos, "/iota", 1, youngest_rev, diff_options,
+                      "zero|alpha|gamma  |delta|", ignore_ws_revs, pool));
+
+  /* Lines that already existed before the start revision are not
+     attributed to any revision. */
+  SVN_ERR(check_blame(repos, "/iota", 2, youngest_rev, NULL,
+                      "zero|alpha|gamma  |delta|", from_r2_revs, pool));
+
+  /* The size limit applies to all revisions.  r5 has 25 bytes, while
+     r4 has 26. */
+  b.revs = apr_array_make(pool, 4, sizeof(svn_revnum_t));
+  b.text = svn_stringbuf_create_empty(pool);
+  SVN_TEST_ASSERT_ERROR(svn_repos_blame(repos, "/iota", 0, youngest_rev,
+                                        NULL, 24, NULL, NULL,
+                                        blame_callback, &b, NULL, NULL,
+                                        pool),
+                        SVN_ERR_UNSUPPORTED_FEATURE);
+  SVN_TEST_ASSERT_ERROR(svn_repos_blame(repos, "/iota", 0, youngest_rev,
+                                        NULL, 25, NULL, NULL,
+                                        blame_callback, &b, NULL, NULL,
+                                        pool),
+                        SVN_ERR_UNSUPPORTED_FEATURE);
+  SVN_TEST_ASSERT(b.revs->nelts == 0);
+  SVN_ERR(svn_repos_blame(repos, "/iota", 0, youngest_rev, NULL, 26,
+                          NULL, NULL, blame_callback, &b, NULL, NULL,
+                          pool));
+  SVN_TEST_INT_ASSERT(b.revs->nelts, 4);
+
+  /* Binary files are rejected, just like in client-side blames. */
+  SVN_ERR(svn_fs_begin_txn2(&txn, fs, youngest_rev, 0, pool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, pool));
+  SVN_ERR(svn_fs_change_node_prop(txn_root, "iota", SVN_PROP_MIME_TYPE,
+                                  svn_string_create("application/x-foo",
+                                                    pool),
+                                  pool));
+  SVN_ERR(svn_repos_fs_commit_txn(NULL, repos, &youngest_rev, txn, pool));
+  SVN_TEST_ASSERT_ERROR(svn_repos_blame(repos, "/iota", 0, youngest_rev,
+                                        NULL, 0, NULL, NULL,
+                                        blame_callback, &b, NULL, NULL,
+                                        pool),
+                        SVN_ERR_CLIENT_IS_BINARY_FILE);
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+test_hook_module_load_failure(const svn_test_opts_t *opts,
+                              apr_pool_t *pool)
+{
+  svn_repos_t *repos;
+  svn_fs_txn_t *txn;
+  svn_fs_root_t *root;
+  svn_revnum_t new_rev;
+  const char *module;
+
+#if !APR_HAS_DSO
+  return svn_error_create(SVN_ERR_TEST_SKIPPED, NULL,
+                          "hook modules require DSO support");
+#endif
+
+  SVN_ERR(svn_test__create_repos(&repos, "test-repo-hook-module-failure",
+                                 opts, pool));
+
+  /* Something that is not a loadable module must block the commit
+     instead of being silently ignored. */
+  module = apr_pstrcat(pool, svn_repos_pre_commit_hook(repos, pool),
+                       SVN_REPOS_HOOK_MODULE_EXT, SVN_VA_NULL);
+  SVN_ERR(svn_io_file_create(module, "not a module", pool));
+
+  SVN_ERR(svn_repos_fs_begin_txn_for_commit2(&txn, repos, 0,
+                                             apr_hash_make(pool), pool));
+  SVN_ERR(svn_fs_txn_root(&root, txn, pool));
+  SVN_ERR(svn_fs_make_dir(root, "/whatever", pool));
+  SVN_TEST_ASSERT_ERROR(svn_repos_fs_commit_txn(NULL, repos, &new_rev, txn,
+                                                pool),
+                        SVN_ERR_REPOS_HOOK_FAILURE);
+
+  /* Without the module, the commit goes through. */
+  SVN_ERR(svn_io_remove_file2(module, FALSE, pool));
+  SVN_ERR(svn_repos_fs_commit_txn(NULL, repos, &new_rev, txn, pool));
+  SVN_TEST_ASSERT(new_rev == 1);
+
+  return SVN_NO_ERROR;
+}
+
+/* Set *MODULE_PATH to the test hook module built from test-hook-module.c,
+   or to NULL if it cannot be found.  Depending on the build system, it
+   lives next to the test program or in libtool's .libs directory. */
+static svn_error_t *
+find_test_hook_module(const char **module_path,
+                      apr_pool_t *pool)
+{
+  static const char *dirs[] = { ".libs", ".", NULL };
+  static const char *prefixes[] = { "lib", "", NULL };
+  static const char *exts[] = { ".so", ".dylib", ".dll", NULL };
+  int d, p, e;
+
+  for (d = 0; dirs[d]; ++d)
+    for (p = 0; prefixes[p]; ++p)
+      for (e = 0; exts[e]; ++e)
+        {
+          svn_node_kind_t kind;
+          const char *path
+            = svn_dirent_join(dirs[d],
+                              apr_pstrcat(pool, prefixes[p],
+                                          TEST_HOOK_MODULE_NAME, exts[e],
+                                          SVN_VA_NULL),
+                              pool);
+
+          SVN_ERR(svn_io_check_resolved_path(path, &kind, pool));
+          if (kind == svn_node_file)
+            {
+              *module_path = path;
+              return SVN_NO_ERROR;
+            }
+        }
+
+  *module_path = NULL;
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+test_hook_module(const svn_test_opts_t *opts,
+                 apr_pool_t *pool)
+{
+  svn_repos_t *repos;
+  svn_fs_txn_t *txn;
+  svn_fs_root_t *root;
+  svn_revnum_t new_rev;
+  const char *module_path;
+  apr_hash_t *revprops;
+  svn_error_t *err;
+
+#if !APR_HAS_DSO
+  return svn_error_create(SVN_ERR_TEST_SKIPPED, NULL,
+                          "hook modules require DSO support");
+#endif
+
+  SVN_ERR(find_test_hook_module(&module_path, pool));
+  if (!module_path)
+    return svn_error_create(SVN_ERR_TEST_SKIPPED, NULL,
+                            "the test hook module has not been built "
+                            "as a shared library");
+
+  SVN_ERR(svn_test__create_repos(&repos, "test-repo-hook-module",
+                                 opts, pool));
+
+  /* Install the same module as start-commit and pre-commit hook. */
+  SVN_ERR(svn_io_copy_file(module_path,
+                           apr_pstrcat(pool,
+                                       svn_repos_start_commit_hook(repos,
+                                                                   pool),
+                                       SVN_REPOS_HOOK_MODULE_EXT,
+                                       SVN_VA_NULL),
+                           FALSE, pool));
+  SVN_ERR(svn_io_copy_file(module_path,
+                           apr_pstrcat(pool,
+                                       svn_repos_pre_commit_hook(repos,
+                                                                 pool),
+                                       SVN_REPOS_HOOK_MODULE_EXT,
+                                       SVN_VA_NULL),
+                           FALSE, pool));
+
+  /* The start-commit hook rejects this user. */
+  revprops = apr_hash_make(pool);
+  svn_hash_sets(revprops, SVN_PROP_REVISION_AUTHOR,
+                svn_string_create(TEST_HOOK_MODULE_BAD_USER, pool));
+  err = svn_repos_fs_begin_txn_for_commit2(&txn, repos, 0, revprops, pool);
+  SVN_TEST_ASSERT(err && err->apr_err == SVN_ERR_REPOS_HOOK_FAILURE);
+  SVN_TEST_ASSERT(svn_error_find_cause(err,
+                                       TEST_HOOK_MODULE_START_COMMIT_ERR));
+  svn_error_clear(err);
+
+  /* Other users may start a commit, but the pre-commit hook rejects
+     the forbidden path. */
+  svn_hash_sets(revprops, SVN_PROP_REVISION_AUTHOR,
+                svn_string_create("jrandom", pool));
+  SVN_ERR(svn_repos_fs_begin_txn_for_commit2(&txn, repos, 0, revprops,
+                                             pool));
+  SVN_ERR(svn_fs_txn_root(&root, txn, pool));
+  SVN_ERR(svn_fs_make_dir(root, TEST_HOOK_MODULE_BAD_PATH, pool));
+  err = svn_repos_fs_commit_txn(NULL, repos, &new_rev, txn, pool);
+  SVN_TEST_ASSERT(err && err->apr_err == SVN_ERR_REPOS_HOOK_FAILURE);
+  SVN_TEST_ASSERT(svn_error_find_cause(err, TEST_HOOK_MODULE_PRE_COMMIT_ERR));
+  svn_error_clear(err);
+  SVN_ERR(svn_fs_abort_txn(txn, pool));
+
+  /* Anything else gets through both hooks. */
+  SVN_ERR(svn_repos_fs_begin_txn_for_commit2(&txn, repos, 0, revprops,
+                                             pool));
+  SVN_ERR(svn_fs_txn_root(&root, txn, pool));
+  SVN_ERR(svn_fs_make_dir(root, "/allowed", pool));
+  SVN_ERR(svn_repos_fs_commit_txn(NULL, repos, &new_rev, txn, pool));
+  SVN_TEST_ASSERT(new_rev == 1);
+
+  return SVN_NO_ERROR;
+}
+
+/* The r2 tree created by create_cache_test_repos(). */
+static svn_test__tree_entry_t cache_test_r2_entries[] = {
+  { "iota",        "Changed file 'iota'.\n" },
+  { "A",           0 },
+  { "A/mu",        "This is the file 'mu'.\n" },
+  { "A/B",         0 },
+  { "A/B/bar",     "New file 'bar'.\n" },
+  { "A/B/lambda",  "This is the file 'lambda'.\n" },
+  { "A/B/E",       0 },
+  { "A/B/E/alpha", "This is the file 'alpha'.\n" },
+  { "A/B/E/beta",  "This is the file 'beta'.\n" },
+  { "A/B/F",       0 },
+  { "A/C",         0 },
+  { "A/D",         0 },
+  { "A/D/gamma",   "This is the file 'gamma'.\n" },
+  { "A/D/G",       0 },
+  { "A/D/G/pi",    "This is the file 'pi'.\n" },
+  { "A/D/G/rho",   "This is the file 'rho'.\n" },
+  { "A/D/G/tau",   "This is the file 'tau'.\n" }
+};
+
+/* Create a repository NAME with the greek tree in r1 and some changes
+   to it in r2.  Return it in *REPOS_P. */
+static svn_error_t *
+create_cache_test_repos(svn_repos_t **repos_p,
+                        const char *name,
+                        const svn_test_opts_t *opts,
+                        apr_pool_t *pool)
+{
+  svn_repos_t *repos;
+  svn_fs_t *fs;
+  svn_fs_txn_t *txn;
+  svn_fs_root_t *txn_root;
+  svn_revnum_t youngest_rev;
+  apr_pool_t *subpool = svn_pool_create(pool);
+
+  SVN_ERR(svn_test__create_repos(&repos, name, opts, pool));
+  fs = svn_repos_fs(repos);
+
+  /* r1: the greek tree; r2: some changes. */
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, 0, subpool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, subpool));
+  SVN_ERR(svn_test__create_greek_tree(txn_root, subpool));
+  SVN_ERR(svn_repos_fs_commit_txn(NULL, repos, &youngest_rev, txn, subpool));
+  svn_pool_clear(subpool);
+
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, youngest_rev, subpool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, subpool));
+  {
+    static svn_test__txn_script_command_t script_entries[] = {
+      { 'e', "iota",      "Changed file 'iota'.\n" },
+      { 'a', "A/B/bar",   "New file 'bar'.\n" },
+      { 'd', "A/D/H",     NULL }
+    };
+    SVN_ERR(svn_test__txn_script_exec(txn_root, script_entries,
+                                      sizeof(script_entries)/
+                                       sizeof(script_entries[0]),
+                                      subpool));
+  }
+  SVN_ERR(svn_repos_fs_commit_txn(NULL, repos, &youngest_rev, txn, subpool));
+  SVN_TEST_ASSERT(youngest_rev == 2);
+  svn_pool_destroy(subpool);
+
+  *repos_p = repos;
+
+  return SVN_NO_ERROR;
+}
+
+/* Edit baton of the tracing editor used by check_cached_report(). */
+typedef struct trace_edit_baton_t
+{
+  /* The editor that we forward all calls to. */
+  const svn_delta_editor_t *editor;
+  void *edit_baton;
+
+  /* All calls made so far, one per line. */
+  svn_stringbuf_t *trace;
+} trace_edit_baton_t;
+
+/* Directory and file baton of the tracing editor. */
+typedef struct trace_node_baton_t
+{
+  trace_edit_baton_t *eb;
+  void *wrapped_baton;
+} trace_node_baton_t;
+
+/* Append the call described by FMT to the trace in EB. */
+static void
+trace_call(trace_edit_baton_t *eb,
+           apr_pool_t *scratch_pool,
+           const char *fmt,
+           ...)
+{
+  va_list ap;
+
+  va_start(ap, fmt);
+  svn_stringbuf_appendcstr(eb->trace, apr_pvsprintf(scratch_pool, fmt, ap));
+  va_end(ap);
+  svn_stringbuf_appendbyte(eb->trace, '\n');
+}
+
+/* Return a new node baton for WRAPPED_BATON in EB. */
+static trace_node_baton_t *
+make_trace_node_baton(trace_edit_baton_t *eb,
+                      void *wrapped_baton,
+                      apr_pool_t *result_pool)
+{
+  trace_node_baton_t *nb = apr_palloc(result_pool, sizeof(*nb));
+  nb->eb = eb;
+  nb->wrapped_baton = wrapped_baton;
+
+  return nb;
+}
+
+static svn_error_t *
+trace_set_target_revision(void *edit_baton,
+                          svn_revnum_t target_revision,
+                          apr_pool_t *pool)
+{
+  trace_edit_baton_t *eb = edit_baton;
+
+  trace_call(eb, pool, "set_target_revision %ld", target_revision);
+  return eb->editor->set_target_revision(eb->edit_baton, target_revision,
+                                         pool);
+}
+
+static svn_error_t *
+trace_open_root(void *edit_baton,
+                svn_revnum_t base_revision,
+                apr_pool_t *dir_pool,
+                void **root_baton)
+{
+  trace_edit_baton_t *eb = edit_baton;
+  void *wrapped_baton;
+
+  trace_call(eb, dir_pool, "open_root %ld", base_revision);
+  SVN_ERR(eb->editor->open_root(eb->edit_baton, base_revision, dir_pool,
+                                &wrapped_baton));
+  *root_baton = make_trace_node_baton(eb, wrapped_baton, dir_pool);
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+trace_delete_entry(const char *path,
+                   svn_revnum_t revision,
+                   void *parent_baton,
+                   apr_pool_t *pool)
+{
+  trace_node_baton_t *pb = parent_baton;
+
+  trace_call(pb->eb, pool, "delete_entry %s %ld", path, revision);
+  return pb->eb->editor->delete_entry(path, revision, pb->wrapped_baton,
+                                      pool);
+}
+
+static svn_error_t *
+trace_add_directory(const char *path,
+                    void *parent_baton,
+                    const char *copyfrom_path,
+                    svn_revnum_t copyfrom_revision,
+                    apr_pool_t *dir_pool,
+                    void **child_baton)
+{
+  trace_node_baton_t *pb = parent_baton;
+  void *wrapped_baton;
+
+  trace_call(pb->eb, dir_pool, "add_directory %s %s %ld", path,
+             copyfrom_path ? copyfrom_path : "-", copyfrom_revision);
+  SVN_ERR(pb->eb->editor->add_directory(path, pb->wrapped_baton,
+                                        copyfrom_path, copyfrom_revision,
+                                        dir_pool, &wrapped_baton));
+  *child_baton = make_trace_node_baton(pb->eb, wrapped_baton, dir_pool);
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+trace_open_directory(const char *path,
+                     void *parent_baton,
+                     svn_revnum_t base_revision,
+                     apr_pool_t *dir_pool,
+                     void **child_baton)
+{
+  trace_node_baton_t *pb = parent_baton;
+  void *wrapped_baton;
+
+  trace_call(pb->eb, dir_pool, "open_directory %s %ld", path,
+             base_revision);
+  SVN_ERR(pb->eb->editor->open_directory(path, pb->wrapped_baton,
+                                         base_revision, dir_pool,
+                                         &wrapped_baton));
+  *child_baton = make_trace_node_baton(pb->eb, wrapped_baton, dir_pool);
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+trace_change_dir_prop(void *dir_baton,
+                      const char *name,
+                      const svn_string_t *value,
+                      apr_pool_t *pool)
+{
+  trace_node_baton_t *db = dir_baton;
+
+  trace_call(db->eb, pool, "change_dir_prop %s %s", name,
+             value ? value->data : "-");
+  return db->eb->editor->change_dir_prop(db->wrapped_baton, name, value,
+                                         pool);
+}
+
+static svn_error_t *
+trace_close_directory(void *dir_baton,
+                      apr_pool_t *pool)
+{
+  trace_node_baton_t *db = dir_baton;
+
+  trace_call(db->eb, pool, "close_directory");
+  return db->eb->editor->close_directory(db->wrapped_baton, pool);
+}
+
+static svn_error_t *
+trace_add_file(const char *path,
+               void *parent_baton,
+               const char *copyfrom_path,
+               svn_revnum_t copyfrom_revision,
+               apr_pool_t *file_pool,
+               void **file_baton)
+{
+  trace_node_baton_t *pb = parent_baton;
+  void *wrapped_baton;
+
+  trace_call(pb->eb, file_pool, "add_file %s %s %ld", path,
+             copyfrom_path ? copyfrom_path : "-", copyfrom_revision);
+  SVN_ERR(pb->eb->editor->add_file(path, pb->wrapped_baton, copyfrom_path,
+                                   copyfrom_revision, file_pool,
+                                   &wrapped_baton));
+  *file_baton = make_trace_node_baton(pb->eb, wrapped_baton, file_pool);
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+trace_open_file(const char *path,
+                void *parent_baton,
+                svn_revnum_t base_revision,
+                apr_pool_t *file_pool,
+                void **file_baton)
+{
+  trace_node_baton_t *pb = parent_baton;
+  void *wrapped_baton;
+
+  trace_call(pb->eb, file_pool, "open_file %s %ld", path, base_revision);
+  SVN_ERR(pb->eb->editor->open_file(path, pb->wrapped_baton, base_revision,
+                                    file_pool, &wrapped_baton));
+  *file_baton = make_trace_node_baton(pb->eb, wrapped_baton, file_pool);
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+trace_apply_textdelta(void *file_baton,
+                      const char *base_checksum,
+                      apr_pool_t *pool,
+                      svn_txdelta_window_handler_t *handler,
+                      void **handler_baton)
+{
+  trace_node_baton_t *fb = file_baton;
+
+  trace_call(fb->eb, pool, "apply_textdelta %s",
+             base_checksum ? base_checksum : "-");
+  return fb->eb->editor->apply_textdelta(fb->wrapped_baton, base_checksum,
+                                         pool, handler, handler_baton);
+}
+
+static svn_error_t *
+trace_change_file_prop(void *file_baton,
+                       const char *name,
+                       const svn_string_t *value,
+                       apr_pool_t *pool)
+{
+  trace_node_baton_t *fb = file_baton;
+
+  trace_call(fb->eb, pool, "change_file_prop %s %s", name,
+             value ? value->data : "-");
+  return fb->eb->editor->change_file_prop(fb->wrapped_baton, name, value,
+                                          pool);
+}
+
+static svn_error_t *
+trace_close_file(void *file_baton,
+                 const char *text_checksum,
+                 apr_pool_t *pool)
+{
+  trace_node_baton_t *fb = file_baton;
+
+  trace_call(fb->eb, pool, "close_file %s",
+             text_checksum ? text_checksum : "-");
+  return fb->eb->editor->close_file(fb->wrapped_baton, text_checksum, pool);
+}
+
+static svn_error_t *
+trace_close_edit(void *edit_baton,
+                 apr_pool_t *pool)
+{
+  trace_edit_baton_t *eb = edit_baton;
+
+  trace_call(eb, pool, "close_edit");
+  return eb->editor->close_edit(eb->edit_baton, pool);
+}
+
+/* Return an editor in *EDITOR / *EDIT_BATON that appends a line for
+   every call to TRACE and forwards it to WRAPPED_EDITOR /
+   WRAPPED_BATON.  Allocate the editor in POOL. */
+static void
+get_trace_editor(const svn_delta_editor_t **editor,
+                 void **edit_baton,
+                 svn_stringbuf_t *trace,
+                 const svn_delta_editor_t *wrapped_editor,
+                 void *wrapped_baton,
+                 apr_pool_t *pool)
+{
+  svn_delta_editor_t *e = svn_delta_default_editor(pool);
+  trace_edit_baton_t *eb = apr_palloc(pool, sizeof(*eb));
+
+  eb->editor = wrapped_editor;
+  eb->edit_baton = wrapped_baton;
+  eb->trace = trace;
+
+  e->set_target_revision = trace_set_target_revision;
+  e->open_root = trace_open_root;
+  e->delete_entry = trace_delete_entry;
+  e->add_directory = trace_add_directory;
+  e->open_directory = trace_open_directory;
+  e->change_dir_prop = trace_change_dir_prop;
+  e->close_directory = trace_close_directory;
+  e->add_file = trace_add_file;
+  e->open_file = trace_open_file;
+  e->apply_textdelta = trace_apply_textdelta;
+  e->change_file_prop = trace_change_file_prop;
+  e->close_file = trace_close_file;
+  e->close_edit = trace_close_edit;
+
+  *editor = e;
+  *edit_baton = eb;
+}
+
+/* An svn_repos_authz_func_t granting access to everything and counting
+   the calls in the int pointed to by BATON. */
+static svn_error_t *
+counting_authz_read_func(svn_boolean_t *allowed,
+                         svn_fs_root_t *root,
+                         const char *path,
+                         void *baton,
+                         apr_pool_t *pool)
+{
+  int *calls = baton;
+
+  ++*calls;
+  *allowed = TRUE;
+
+  return SVN_NO_ERROR;
+}
+
+/* Run an update report from r1 to r2 of REPOS into a new txn and check
+   that the result matches the r2 tree created by
+   create_cache_test_repos().  Set *TRACE to the editor calls made and
+   *AUTHZ_CALLS to the number of paths that had to be checked against
+   authz, i.e. 0 if the drive got replayed from the cache.  Use a
+   different cache key if IGNORE_ANCESTRY is set.  Allocate *TRACE in
+   POOL. */
+static svn_error_t *
+check_cached_report(svn_stringbuf_t **trace,
+                    int *authz_calls,
+                    svn_repos_t *repos,
+                    svn_boolean_t ignore_ancestry,
+                    apr_pool_t *pool)
+{
+  svn_fs_t *fs = svn_repos_fs(repos);
+  svn_fs_txn_t *txn;
+  svn_fs_root_t *txn_root;
+  const svn_delta_editor_t *editor;
+  void *edit_baton, *report_baton;
+
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, 1, pool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, pool));
+  SVN_ERR(dir_delta_get_editor(&editor, &edit_baton, fs,
+                               txn_root, "", pool));
+
+  *trace = svn_stringbuf_create_empty(pool);
+  get_trace_editor(&editor, &edit_baton, *trace, editor, edit_baton, pool);
+
+  *authz_calls = 0;
+  SVN_ERR(svn_repos_begin_report3(&report_baton, 2, repos, "/", "", NULL,
+                                  TRUE, svn_depth_infinity, ignore_ancestry,
+                                  FALSE, editor, edit_baton,
+                                  counting_authz_read_func, authz_calls, 0,
+                                  pool));
+  svn_repos__report_set_authz_fingerprint(report_baton, "everything");
+  SVN_ERR(svn_repos_set_path3(report_baton, "", 1, svn_depth_infinity,
+                              FALSE, NULL, pool));
+  SVN_ERR(svn_repos_finish_report(report_baton, pool));
+
+  SVN_ERR(svn_test__validate_tree(txn_root, cache_test_r2_entries,
+                                  sizeof(cache_test_r2_entries)/
+                                   sizeof(cache_test_r2_entries[0]),
+                                  pool));
+
+  return svn_error_trace(svn_fs_abort_txn(txn, pool));
+}
+
+/* Set *ENTRIES to the number of entries in the report cache at
+   CACHE_DIR and *SIZE to their total size. */
+static svn_error_t *
+get_report_cache_usage(int *entries,
+                       svn_filesize_t *size,
+                       const char *cache_dir,
+                       apr_pool_t *pool)
+{
+  apr_hash_t *dirents;
+  apr_hash_index_t *hi;
+
+  *entries = 0;
+  *size = 0;
+
+  SVN_ERR(svn_io_get_dirents3(&dirents, cache_dir, FALSE, pool, pool));
+  for (hi = apr_hash_first(pool, dirents); hi; hi = apr_hash_next(hi))
+    {
+      const svn_io_dirent2_t *dirent = apr_hash_this_val(hi);
+
+      if (strcmp(apr_hash_this_key(hi), "generation") != 0)
+        {
+          ++*entries;
+          *size += dirent->filesize;
+        }
+    }
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+test_report_cache(const svn_test_opts_t *opts,
+                  apr_pool_t *pool)
+{
+  svn_repos_t *repos;
+  const char *cache_dir;
+  svn_stringbuf_t *trace, *cached_trace;
+  int authz_calls, entries;
+  svn_filesize_t size;
+
+  SVN_ERR(create_cache_test_repos(&repos, "test-repo-report-cache",
+                                  opts, pool));
+  cache_dir = svn_dirent_join(svn_repos_path(repos, pool), "report-cache",
+                              pool);
+
+  svn_repos__enable_report_cache(repos, 0x100000);
+
+  /* The first report gets recorded ... */
+  SVN_ERR(check_cached_report(&trace, &authz_calls, repos, FALSE, pool));
+  SVN_TEST_ASSERT(authz_calls > 0);
+
+  SVN_ERR(get_report_cache_usage(&entries, &size, cache_dir, pool));
+  SVN_TEST_INT_ASSERT(entries, 1);
+
+  /* ... and the identical one replayed with the same editor calls,
+     without looking at the repository. */
+  SVN_ERR(check_cached_report(&cached_trace, &authz_calls, repos, FALSE,
+                              pool));
+  SVN_TEST_INT_ASSERT(authz_calls, 0);
+  SVN_TEST_STRING_ASSERT(cached_trace->data, trace->data);
+
+  /* Changing the author of a revision invalidates the cache. */
+  SVN_ERR(svn_repos_fs_change_rev_prop4(repos, 2, NULL,
+                                        SVN_PROP_REVISION_AUTHOR, NULL,
+                                        svn_string_create("someone", pool),
+                                        FALSE, FALSE, NULL, NULL, pool));
+  SVN_ERR(get_report_cache_usage(&entries, &size, cache_dir, pool));
+  SVN_TEST_INT_ASSERT(entries, 0);
+
+  SVN_ERR(check_cached_report(&trace, &authz_calls, repos, FALSE, pool));
+  SVN_TEST_ASSERT(authz_calls > 0);
+  SVN_TEST_ASSERT(strstr(trace->data, "someone"));
+
+  /* So does a bypassing change, as done by 'svnadmin load-revprops'. */
+  {
+    svn_stream_t *dumpstream;
+    svn_stringbuf_t *dump = svn_stringbuf_create_empty(pool);
+
+    svn_stringbuf_appendcstr(dump,
+                             "SVN-fs-dump-format-version: 3\n\n"
+                             "Revision-number: 2\n"
+                             "Prop-content-length: 36\n"
+                             "Content-length: 36\n\n"
+                             "K 10\nsvn:author\nV 5\nother\n"
+                             "PROPS-END\n\n");
+    dumpstream = svn_stream_from_stringbuf(dump, pool);
+    SVN_ERR(svn_repos_load_fs_revprops(repos, dumpstream, 2, 2, FALSE,
+                                       TRUE, FALSE, NULL, NULL, NULL, NULL,
+                                       pool));
+  }
+  SVN_ERR(get_report_cache_usage(&entries, &size, cache_dir, pool));
+  SVN_TEST_INT_ASSERT(entries, 0);
+
+  SVN_ERR(check_cached_report(&trace, &authz_calls, repos, FALSE, pool));
+  SVN_TEST_ASSERT(authz_calls > 0);
+  SVN_TEST_ASSERT(strstr(trace->data, "other"));
+
+  /* Entries from a different generation, e.g. recorded while the cache
+     got cleared, are not used. */
+  SVN_ERR(svn_io_write_atomic2(svn_dirent_join(cache_dir, "generation",
+                                               pool),
+                               "changed", 7, NULL, FALSE, pool));
+  SVN_ERR(check_cached_report(&trace, &authz_calls, repos, FALSE, pool));
+  SVN_TEST_ASSERT(authz_calls > 0);
+  SVN_ERR(check_cached_report(&trace, &authz_calls, repos, FALSE, pool));
+  SVN_TEST_INT_ASSERT(authz_calls, 0);
+
+  /* The least recently used entry makes room for new ones. */
+  SVN_ERR(get_report_cache_usage(&entries, &size, cache_dir, pool));
+  SVN_TEST_INT_ASSERT(entries, 1);
+  svn_repos__enable_report_cache(repos, (apr_uint64_t)(size + size / 2));
+
+  SVN_ERR(check_cached_report(&trace, &authz_calls, repos, TRUE, pool));
+  SVN_TEST_ASSERT(authz_calls > 0);
+  SVN_ERR(get_report_cache_usage(&entries, &size, cache_dir, pool));
+  SVN_TEST_INT_ASSERT(entries, 1);
+
+  SVN_ERR(check_cached_report(&trace, &authz_calls, repos, TRUE, pool));
+  SVN_TEST_INT_ASSERT(authz_calls, 0);
+  SVN_ERR(check_cached_report(&trace, &authz_calls, repos, FALSE, pool));
+  SVN_TEST_ASSERT(authz_calls > 0);
+
+  return SVN_NO_ERROR;
+}
+
+/* Replay r2 of REPOS into a new txn based on r1 and check that the
+   result matches the r2 tree created by create_cache_test_repos(). */
+static svn_error_t *
+check_cached_replay(svn_repos_t *repos,
+                    apr_pool_t *pool)
+{
+  svn_fs_t *fs = svn_repos_fs(repos);
+  svn_fs_txn_t *txn;
+  svn_fs_root_t *txn_root;
+  const svn_delta_editor_t *editor;
+  void *edit_baton;
+
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, 1, pool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, pool));
+  SVN_ERR(dir_delta_get_editor(&editor, &edit_baton, fs,
+                               txn_root, "", pool));
+
+  SVN_ERR(svn_repos__replay_cached(repos, 2, "", 0, TRUE,
+                                   editor, edit_baton, NULL, NULL, NULL,
+                                   pool));
+  SVN_ERR(editor->close_edit(edit_baton, pool));
+
+  SVN_ERR(svn_test__validate_tree(txn_root, cache_test_r2_entries,
+                                  sizeof(cache_test_r2_entries)/
+                                   sizeof(cache_test_r2_entries[0]),
+                                  pool));
+
+  return svn_error_trace(svn_fs_abort_txn(txn, pool));
+}
+
+static svn_error_t *
+test_replay_cache(const svn_test_opts_t *opts,
+                  apr_pool_t *pool)
+{
+  svn_repos_t *repos;
+  const char *cache_dir;
+  apr_hash_t *dirents;
+  svn_node_kind_t kind;
+  apr_pool_t *subpool = svn_pool_create(pool);
+
+  SVN_ERR(create_cache_test_repos(&repos, "test-repo-replay-cache",
+                                  opts, pool));
+  cache_dir = svn_dirent_join(svn_repos_path(repos, pool), "replay-cache",
+                              pool);
+
+  /* Nothing gets cached unless enabled. */
+  SVN_ERR(check_cached_replay(repos, subpool));
+  svn_pool_clear(subpool);
+
+  SVN_ERR(svn_io_check_path(cache_dir, &kind, pool));
+  SVN_TEST_ASSERT(kind == svn_node_none);
+
+  svn_repos__enable_replay_cache(repos, 0x100000);
+
+  /* The first replay gets recorded ... */
+  SVN_ERR(check_cached_replay(repos, subpool));
+  svn_pool_clear(subpool);
+
+  SVN_ERR(svn_io_get_dirents3(&dirents, cache_dir, TRUE, pool, pool));
+  SVN_TEST_ASSERT(apr_hash_count(dirents) == 1);
+
+  /* ... and the identical one replayed with the same result. */
+  SVN_ERR(check_cached_replay(repos, subpool));
+  svn_pool_destroy(subpool);
+
+  SVN_ERR(svn_io_get_dirents3(&dirents, cache_dir, TRUE, pool, pool));
+  SVN_TEST_ASSERT(apr_hash_count(dirents) == 1);
+
+  return SVN_NO_ERROR;
+}
+
 /* The test table.  */
 
 static int max_threads = 4;
@@ -4507,6 +5708,8 @@ static struct svn_test_descriptor_t test_funcs[] =
                        "test if revprops are validated by repos"),
     SVN_TEST_OPTS_PASS(get_logs,
                        "test svn_repos_get_logs ranges and limits"),
+    SVN_TEST_OPTS_PASS(get_logs_authz_many,
+                       "test svn_repos_get_logs checking authz in bulk"),
     SVN_TEST_OPTS_PASS(test_get_file_revs,
                        "test svn_repos_get_file_revsN"),
     SVN_TEST_OPTS_PASS(issue_4060,
@@ -4539,6 +5742,18 @@ static struct svn_test_descriptor_t test_funcs[] =
                    "optional authz wildcard performance test"),
     SVN_TEST_OPTS_PASS(test_list,
                        "test svn_repos_list"),
+    SVN_TEST_OPTS_PASS(test_list_concurrently,
+                       "test svn_repos_list2 with multiple threads"),
+    SVN_TEST_OPTS_PASS(test_blame,
+                       "test svn_repos_blame"),
+    SVN_TEST_OPTS_PASS(test_hook_module_load_failure,
+                       "test failing to load a hook module"),
+    SVN_TEST_OPTS_PASS(test_hook_module,
+                       "test start-commit and pre-commit hook modules"),
+    SVN_TEST_OPTS_PASS(test_report_cache,
+                       "test caching update report editor drives"),
+    SVN_TEST_OPTS_PASS(test_replay_cache,
+                       "test caching replayed revisions"),
     SVN_TEST_NULL
   };
 
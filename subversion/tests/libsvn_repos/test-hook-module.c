@@ -0,0 +1,89 @@
+/* test-hook-module.c --- an in-process hook module for repos-test
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+/* This module gets installed as start-commit and pre-commit hook by
+ * test_hook_module() in repos-test.c.  Its start-commit hook rejects
+ * commits by TEST_HOOK_MODULE_BAD_USER and its pre-commit hook rejects
+ * commits that add TEST_HOOK_MODULE_BAD_PATH. */
+
+#include <string.h>
+
+#include "svn_error.h"
+#include "svn_fs.h"
+#include "svn_repos.h"
+
+#include "test-hook-module.h"
+
+/* Implements svn_repos_hook_module_t.start_commit. */
+static svn_error_t *
+start_commit(svn_repos_t *repos,
+             const char *user,
+             const apr_array_header_t *capabilities,
+             const char *txn_name,
+             apr_pool_t *scratch_pool)
+{
+  if (user && strcmp(user, TEST_HOOK_MODULE_BAD_USER) == 0)
+    return svn_error_createf(TEST_HOOK_MODULE_START_COMMIT_ERR, NULL,
+                             "User '%s' may not commit", user);
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_repos_hook_module_t.pre_commit. */
+static svn_error_t *
+pre_commit(svn_repos_t *repos,
+           svn_fs_txn_t *txn,
+           svn_fs_root_t *txn_root,
+           apr_hash_t *lock_tokens,
+           apr_pool_t *scratch_pool)
+{
+  svn_node_kind_t kind;
+
+  SVN_ERR(svn_fs_check_path(&kind, txn_root, TEST_HOOK_MODULE_BAD_PATH,
+                            scratch_pool));
+  if (kind != svn_node_none)
+    return svn_error_createf(TEST_HOOK_MODULE_PRE_COMMIT_ERR, NULL,
+                             "'%s' may not be committed",
+                             TEST_HOOK_MODULE_BAD_PATH);
+
+  return SVN_NO_ERROR;
+}
+
+static const svn_repos_hook_module_t hook_module =
+  {
+    SVN_REPOS_HOOK_MODULE_ABI_VERSION,
+    sizeof(svn_repos_hook_module_t),
+    start_commit,
+    pre_commit,
+    NULL
+  };
+
+#ifdef WIN32
+__declspec(dllexport)
+#endif
+svn_error_t *
+svn_repos_hook_module_init(const svn_repos_hook_module_t **module,
+                           apr_pool_t *pool)
+{
+  *module = &hook_module;
+  return SVN_NO_ERROR;
+}
@@ -0,0 +1,42 @@
+/* test-hook-module.h --- shared definitions of test-hook-module.c and
+ *                        repos-test.c
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+#ifndef SVN_TEST_HOOK_MODULE_H
+#define SVN_TEST_HOOK_MODULE_H
+
+/* Base name of the test hook module as built by the build system.
+   Depending on the platform and build system, it may or may not be
+   prefixed by "lib" and get various extensions. */
+#define TEST_HOOK_MODULE_NAME "svn_test_hook_module-1"
+
+/* The start-commit hook of the module rejects commits by this user
+   with TEST_HOOK_MODULE_START_COMMIT_ERR. */
+#define TEST_HOOK_MODULE_BAD_USER "intruder"
+#define TEST_HOOK_MODULE_START_COMMIT_ERR SVN_ERR_AUTHZ_UNWRITABLE
+
+/* The pre-commit hook of the module rejects transactions that contain
+   this path with TEST_HOOK_MODULE_PRE_COMMIT_ERR. */
+#define TEST_HOOK_MODULE_BAD_PATH "/forbidden"
+#define TEST_HOOK_MODULE_PRE_COMMIT_ERR SVN_ERR_FS_CONFLICT
+
+#endif /* SVN_TEST_HOOK_MODULE_H */
@@ -227,6 +227,115 @@ test_membuffer_cache_basic(apr_pool_t *pool)
   return basic_cache_test(cache, FALSE, pool);
 }
 
+/* Store and fetch a batch of revnums in CACHE.  One key will not be
+ * found, one key will be NULL. */
+static svn_error_t *
+batch_cache_test(svn_cache__t *cache,
+                 apr_pool_t *pool)
+{
+  apr_array_header_t *keys = apr_array_make(pool, 12, sizeof(const char *));
+  svn_revnum_t revs[10];
+  void *values[12];
+  svn_boolean_t found[12];
+  apr_pool_t *subpool = svn_pool_create(pool);
+  int i;
+
+  for (i = 0; i < 10; ++i)
+    {
+      revs[i] = 10 * i;
+      APR_ARRAY_PUSH(keys, const char *) = apr_psprintf(pool, "key %d", i);
+      values[i] = &revs[i];
+    }
+
+  SVN_ERR(svn_cache__set_many(cache, keys, values, subpool));
+  svn_pool_clear(subpool);
+
+  APR_ARRAY_PUSH(keys, const char *) = "not there";
+  APR_ARRAY_PUSH(keys, const char *) = NULL;
+
+  SVN_ERR(svn_cache__get_many(values, found, cache, keys, subpool));
+  for (i = 0; i < 10; ++i)
+    {
+      SVN_TEST_ASSERT(found[i]);
+      SVN_TEST_ASSERT(*(svn_revnum_t *)values[i] == 10 * i);
+    }
+
+  SVN_TEST_ASSERT(!found[10] && values[10] == NULL);
+  SVN_TEST_ASSERT(!found[11] && values[11] == NULL);
+
+  svn_pool_destroy(subpool);
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+test_inprocess_cache_batch(apr_pool_t *pool)
+{
+  svn_cache__t *cache;
+
+  SVN_ERR(svn_cache__create_inprocess(&cache,
+                                      serialize_revnum,
+                                      deserialize_revnum,
+                                      APR_HASH_KEY_STRING,
+                                      4,
+                                      4,
+                                      TRUE,
+                                      "",
+                                      pool));
+
+  return batch_cache_test(cache, pool);
+}
+
+static svn_error_t *
+test_memcache_batch(const svn_test_opts_t *opts,
+                    apr_pool_t *pool)
+{
+  svn_cache__t *cache;
+  svn_memcache_t *memcache = NULL;
+  const char *prefix = apr_psprintf(pool,
+                                    "test_memcache_batch-%" APR_TIME_T_FMT,
+                                    apr_time_now());
+
+  SVN_ERR(create_memcache(&memcache, opts, pool, pool));
+  if (! memcache)
+    return svn_error_create(SVN_ERR_TEST_SKIPPED, NULL,
+                            "not configured to use memcached");
+
+  SVN_ERR(svn_cache__create_memcache(&cache,
+                                    memcache,
+                                    serialize_revnum,
+                                    deserialize_revnum,
+                                    APR_HASH_KEY_STRING,
+                                    prefix,
+                                    pool));
+
+  return batch_cache_test(cache, pool);
+}
+
+static svn_error_t *
+test_membuffer_cache_batch(apr_pool_t *pool)
+{
+  svn_cache__t *cache;
+  svn_membuffer_t *membuffer;
+
+  /* Use multiple segments such that the batch gets split. */
+  SVN_ERR(svn_cache__membuffer_cache_create(&membuffer, 1024*1024, 0, 4,
+                                            TRUE, TRUE, pool));
+
+  SVN_ERR(svn_cache__create_membuffer_cache(&cache,
+                                            membuffer,
+                                            serialize_revnum,
+                                            deserialize_revnum,
+                                            APR_HASH_KEY_STRING,
+                                            "cache:",
+                                            SVN_CACHE__MEMBUFFER_DEFAULT_PRIORITY,
+                                            TRUE,
+                                            FALSE,
+                                            pool, pool));
+
+  return batch_cache_test(cache, pool);
+}
+
 /* Implements svn_cache__deserialize_func_t */
 static svn_error_t *
 raise_error_deserialize_func(void **out,
@@ -616,6 +725,12 @@ static struct svn_test_descriptor_t test_funcs[] =
                    "test membuffer cache with unaligned string keys"),
     SVN_TEST_PASS2(test_membuffer_unaligned_fixed_keys,
                    "test membuffer cache with unaligned fixed keys"),
+    SVN_TEST_PASS2(test_inprocess_cache_batch,
+                   "batch access to inprocess svn_cache"),
+    SVN_TEST_OPTS_PASS(test_memcache_batch,
+                       "batch access to memcache svn_cache"),
+    SVN_TEST_PASS2(test_membuffer_cache_batch,
+                   "batch access to membuffer svn_cache"),
     SVN_TEST_NULL
   };
 